@@ -0,0 +1,149 @@
+#!/usr/bin/python3
+# -*- coding: utf-8 -*-
+
+# This file is part of CliFM
+
+# Microbenchmark driver for clifm's hot paths. Run me via 'make benchmark'
+# (or directly: ./benchmark.py --bin /path/to/clifm).
+#
+# Fixture directory trees of parameterized sizes (see --sizes) are generated
+# under a temporary root, and the binary is timed end-to-end with
+# --list-and-quit against each of them. This exercises, per run: config and
+# jump database load (init), parse_input_str() (command line processing),
+# list_dir() (the bulk of the work, including stat(2) and sorting via
+# entrycmp()), and the columned/long-view printers. Several --sort values are
+# measured separately to expose entrycmp() differences (name, size, mtime,
+# and version sort), plus an empty-directory run as the startup baseline.
+#
+# Reported figures: mean wall time per run, ns per listed entry (startup
+# baseline subtracted), and max RSS of the child as a coarse allocation
+# proxy. Timings are wall-clock: run on an idle machine and compare numbers
+# only across runs of this same script on the same machine.
+
+import argparse
+import os
+import resource
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+# (label, extra command line arguments)
+# Sort numbers match the SNAME/STSIZE/SMTIME/SVER macros in src/helpers.h
+BENCHES = [
+    ("list (sort=name)", ["--sort=1"]),
+    ("list (sort=size)", ["--sort=2"]),
+    ("list (sort=mtime)", ["--sort=6"]),
+    ("list (sort=version)", ["--sort=7"]),
+    ("list long view", ["--sort=1", "-l"]),
+]
+
+
+def gen_fixture(root, size):
+    """Generate a mixed fixture tree with SIZE entries: ~70% regular files
+    (some with multi-digit suffixes to stress version sort), ~20%
+    directories, ~10% symlinks."""
+    path = os.path.join(root, "tree_%d" % size)
+    os.mkdir(path)
+    nfiles = (size * 7) // 10
+    ndirs = (size * 2) // 10
+    nlinks = size - nfiles - ndirs
+    for i in range(nfiles):
+        with open(os.path.join(path, "file-%d.txt" % i), "w") as f:
+            f.write("x" * (i % 512))
+    for i in range(ndirs):
+        os.mkdir(os.path.join(path, "dir-%d" % i))
+    for i in range(nlinks):
+        os.symlink("file-%d.txt" % i, os.path.join(path, "link-%d" % i))
+    return path
+
+
+def run_once(cmd, env):
+    """Run CMD once attached to a pseudo-terminal (clifm skips the actual
+    listing when not run from a tty) and return (wall_ns, max_rss_kb of
+    children so far)."""
+    master, slave = os.openpty()
+    start = time.perf_counter_ns()
+    proc = subprocess.Popen(cmd, env=env, stdin=slave, stdout=slave,
+                            stderr=slave)
+    os.close(slave)
+    while True:  # Drain the pty so the child never blocks on a full buffer
+        try:
+            if not os.read(master, 65536):
+                break
+        except OSError:  # EIO: child closed its end
+            break
+    ret = proc.wait()
+    end = time.perf_counter_ns()
+    os.close(master)
+    if ret != 0:
+        sys.exit("benchmark: '%s' exited with status %d" % (" ".join(cmd), ret))
+    return end - start, resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+
+
+def bench(binary, args, target, env, runs):
+    cmd = [binary, "--list-and-quit", "--no-colors"] + args + [target]
+    run_once(cmd, env)  # Warm up caches (and the jump database)
+    times = []
+    rss = 0
+    for _ in range(runs):
+        t, rss = run_once(cmd, env)
+        times.append(t)
+    return statistics.mean(times), rss
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Benchmark clifm's listing hot paths against "
+        "generated fixture trees")
+    parser.add_argument("--bin", default="./clifm",
+                        help="clifm binary to benchmark (default: ./clifm)")
+    parser.add_argument("--sizes", default="100,1000,10000",
+                        help="comma-separated fixture sizes "
+                        "(default: 100,1000,10000)")
+    parser.add_argument("--runs", type=int, default=5,
+                        help="timed runs per benchmark (default: 5)")
+    parser.add_argument("--keep", action="store_true",
+                        help="do not remove the generated fixture trees")
+    opts = parser.parse_args()
+
+    binary = os.path.abspath(opts.bin)
+    if not os.access(binary, os.X_OK):
+        sys.exit("benchmark: %s: No such executable (build first, or pass "
+                 "--bin)" % opts.bin)
+    sizes = [int(s) for s in opts.sizes.split(",") if s]
+
+    root = tempfile.mkdtemp(prefix="clifm-bench-")
+    home = os.path.join(root, "home")
+    os.mkdir(home)
+    # Isolated HOME so a fresh config/jumpdb is generated and the user's
+    # real configuration does not skew results
+    env = dict(os.environ, HOME=home, TERM="xterm")
+
+    try:
+        empty = os.path.join(root, "empty")
+        os.mkdir(empty)
+        base, _ = bench(binary, ["--sort=1"], empty, env, opts.runs)
+        print("startup baseline (empty dir): %.2f ms" % (base / 1e6))
+        print()
+        print("%-22s %8s %12s %12s %10s" %
+              ("benchmark", "entries", "mean (ms)", "ns/entry", "rss (kb)"))
+        for size in sizes:
+            tree = gen_fixture(root, size)
+            for label, args in BENCHES:
+                mean, rss = bench(binary, args, tree, env, opts.runs)
+                per_entry = max(mean - base, 0) / size
+                print("%-22s %8d %12.2f %12.0f %10d" %
+                      (label, size, mean / 1e6, per_entry, rss))
+            print()
+    finally:
+        if opts.keep:
+            print("Fixture trees kept in %s" % root)
+        else:
+            shutil.rmtree(root, ignore_errors=True)
+
+
+if __name__ == "__main__":
+    main()
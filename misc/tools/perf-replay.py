@@ -0,0 +1,338 @@
+#!/usr/bin/python3
+# -*- coding: utf-8 -*-
+
+# This file is part of CliFM
+
+# Session replay harness for interactive latency regressions. Run me via
+# 'make perf-replay' (or directly: ./perf-replay.py replay --bin ./clifm).
+#
+# Two modes:
+#
+#   record  Run clifm on a pseudo-terminal wired to your real terminal and
+#           log every keystroke chunk, with its timing, to a session file
+#           (one JSON object per line). --snapshot copies the working
+#           directory next to the session file, so the session replays
+#           against the exact tree it was recorded against.
+#
+#   replay  Feed a recorded session (or, with no --session, a built-in
+#           synthetic one against a generated fixture tree) to the binary
+#           headlessly, measuring, per keystroke chunk, the time from
+#           writing it to the pty until the output stream settles: this
+#           covers echo, syntax highlight, and the suggestion for plain
+#           keystrokes, and command execution plus the refreshed listing
+#           for chunks carrying Enter. Reported figures: mean/p50/p99 per
+#           class (keystrokes vs. commands), plus the binary's own
+#           per-phase breakdown ('perf' command: dir scan, sorting,
+#           printing, suggestions, tab completion, command execution),
+#           which the harness enables on startup.
+#
+# Timings are wall-clock: run on an idle machine and compare numbers only
+# across runs of this same script on the same machine. To gate a release,
+# record a handful of representative sessions once, keep them (with their
+# snapshots) in version control or a shared location, and replay them
+# against both the previous and the candidate binary.
+
+import argparse
+import json
+import os
+import re
+import select
+import shutil
+import statistics
+import sys
+import tempfile
+import time
+
+ANSI = re.compile(rb"\x1b[\[\]][0-9;?]*[a-zA-Z]?")
+CPR_QUERY = b"\x1b[6n"  # Cursor position request: must be answered
+CPR_REPLY = b"\x1b[24;1R"
+
+# Replay settle detection: a chunk's latency is the time from writing it
+# until no new output arrives for SETTLE_S (capped at TIMEOUT_S).
+SETTLE_S = 0.025
+TIMEOUT_S = 2.0
+
+
+def gen_fixture(root, size):
+    """Generate a fixture tree with SIZE entries: ~70% regular files, ~20%
+    directories, ~10% symlinks (same shape as benchmark.py)."""
+    path = os.path.join(root, "tree_%d" % size)
+    os.mkdir(path)
+    nfiles = (size * 7) // 10
+    ndirs = (size * 2) // 10
+    nlinks = size - nfiles - ndirs
+    for i in range(nfiles):
+        with open(os.path.join(path, "file-%d.txt" % i), "w") as f:
+            f.write("x" * (i % 512))
+    for i in range(ndirs):
+        os.mkdir(os.path.join(path, "dir-%d" % i))
+    for i in range(nlinks):
+        os.symlink("file-%d.txt" % i, os.path.join(path, "link-%d" % i))
+    return path
+
+
+def synthetic_session():
+    """Built-in session: per-keystroke typing (suggestions), TAB
+    completion, directory changes, re-sorting, and refreshes."""
+    events = []
+    t = 0.0
+
+    def key(data, dt=0.12):
+        nonlocal t
+        t += dt
+        events.append({"t": round(t, 3), "data": data})
+
+    for ch in "file-1":  # One suggestion check per keystroke
+        key(ch)
+    key("\t")            # TAB completion over the matches
+    key("\x15", 0.3)     # Ctrl-U: clear the line
+    for ch in "cd dir-5":
+        key(ch)
+    key("\r", 0.3)       # Chdir + full listing
+    key("cd ..")
+    key("\r", 0.3)
+    key("st 2")          # Re-sort by size
+    key("\r", 0.3)
+    key("st 1")
+    key("\r", 0.3)
+    for _ in range(3):   # Listing refreshes
+        key("rf")
+        key("\r", 0.3)
+    return events
+
+
+def spawn(binary, directory, env):
+    """Start BINARY on a new pty listing DIRECTORY. Return (pid, fd)."""
+    pid, fd = os.forkpty()
+    if pid == 0:
+        os.environ.update(env)
+        os.execv(binary, [binary, "--no-pager", directory])
+    return pid, fd
+
+
+def pump(fd, out, timeout):
+    """Read whatever arrives on FD within TIMEOUT, answering cursor
+    position queries. Return the number of bytes read (0 on timeout)."""
+    r, _, _ = select.select([fd], [], [], timeout)
+    if not r:
+        return 0
+    try:
+        data = os.read(fd, 65536)
+    except OSError:  # EIO: child closed its end
+        return 0
+    out.append(data)
+    if CPR_QUERY in data:
+        os.write(fd, CPR_REPLY)
+    return len(data)
+
+
+def settle(fd, out, settle_s=SETTLE_S, timeout_s=TIMEOUT_S):
+    """Wait until FD has been silent for SETTLE_S seconds and return the
+    time of the last received byte (or None if nothing arrived)."""
+    deadline = time.perf_counter() + timeout_s
+    last = None
+    while time.perf_counter() < deadline:
+        if pump(fd, out, settle_s) == 0:
+            break
+        last = time.perf_counter()
+    return last
+
+
+def send_and_settle(fd, data, out):
+    """Write DATA to FD and return the observed latency in seconds."""
+    start = time.perf_counter()
+    os.write(fd, data)
+    last = settle(fd, out)
+    return (last - start) if last is not None else 0.0
+
+
+def percentile(sorted_vals, pct):
+    return sorted_vals[(len(sorted_vals) - 1) * pct // 100]
+
+
+def report(label, vals):
+    if not vals:
+        return
+    vals = sorted(vals)
+    print("%-12s %8d %12.2f %12.2f %12.2f" %
+          (label, len(vals), statistics.mean(vals) * 1e3,
+           percentile(vals, 50) * 1e3, percentile(vals, 99) * 1e3))
+
+
+def run_replay(opts):
+    binary = os.path.abspath(opts.bin)
+    if not os.access(binary, os.X_OK):
+        sys.exit("perf-replay: %s: No such executable (build first, or "
+                 "pass --bin)" % opts.bin)
+
+    tmp = tempfile.mkdtemp(prefix="clifm-replay-")
+    directory = opts.dir
+    events = None
+
+    if opts.session:
+        with open(opts.session) as f:
+            header = json.loads(f.readline())
+            events = [json.loads(line) for line in f if line.strip()]
+        # Prefer the snapshot taken at record time, then --dir, then the
+        # directory the session was recorded in
+        snap = os.path.splitext(opts.session)[0] + ".fixture"
+        if not directory:
+            directory = snap if os.path.isdir(snap) else header.get("dir")
+        if not directory or not os.path.isdir(directory):
+            sys.exit("perf-replay: no fixture directory for this session "
+                     "(pass --dir)")
+    else:
+        if not directory:
+            directory = gen_fixture(tmp, opts.size)
+        events = synthetic_session()
+
+    home = os.path.join(tmp, "home")
+    os.mkdir(home)
+    # Isolated HOME so a fresh config/jumpdb is generated and the user's
+    # real configuration does not skew results
+    env = {"HOME": home, "TERM": "xterm"}
+
+    pid, fd = spawn(binary, directory, env)
+    out = []
+    try:
+        settle(fd, out, settle_s=0.2, timeout_s=10.0)  # Startup + listing
+        send_and_settle(fd, b"perf on\r", out)  # Per-phase instrumentation
+
+        key_lat, cmd_lat = [], []
+        prev_t = 0.0
+        for ev in events:
+            if opts.speed > 0:  # Honor the recorded inter-key delays
+                gap = (ev["t"] - prev_t) / opts.speed
+                prev_t = ev["t"]
+                if gap > 0:
+                    time.sleep(min(gap, 2.0))
+            data = ev["data"].encode("utf-8", "surrogateescape")
+            lat = send_and_settle(fd, data, out)
+            (cmd_lat if b"\r" in data else key_lat).append(lat)
+
+        out = []  # Keep only the perf table output
+        send_and_settle(fd, b"perf\r", out)
+        settle(fd, out, settle_s=0.2)
+        table = ANSI.sub(b"", b"".join(out)).decode("utf-8", "replace")
+
+        print("session: %s (%d events), fixture: %s" %
+              (opts.session or "builtin synthetic", len(events), directory))
+        print()
+        print("%-12s %8s %12s %12s %12s" %
+              ("class", "events", "mean (ms)", "p50 (ms)", "p99 (ms)"))
+        report("keystroke", key_lat)
+        report("command", cmd_lat)
+        print()
+        print("Per-phase breakdown (perf command):")
+        in_table = False
+        for line in table.splitlines():
+            line = line.strip("\r")
+            if line.lstrip().startswith("Phase"):
+                in_table = True
+            elif in_table and len(line.split()) < 7:
+                break  # Prompt redraw: past the table
+            if in_table:
+                print("  " + line)
+    finally:
+        try:
+            os.write(fd, b"\x15q\r")
+            settle(fd, out, timeout_s=1.0)
+            os.close(fd)
+            os.waitpid(pid, 0)
+        except OSError:
+            pass
+        shutil.rmtree(tmp, ignore_errors=True)
+
+
+def run_record(opts):
+    import termios
+    import tty
+
+    if not sys.stdin.isatty():
+        sys.exit("perf-replay: record mode needs a terminal")
+
+    binary = os.path.abspath(opts.bin)
+    directory = os.path.abspath(opts.dir or os.getcwd())
+
+    if opts.snapshot:
+        snap = os.path.splitext(opts.out)[0] + ".fixture"
+        if not os.path.isdir(snap):
+            shutil.copytree(directory, snap, symlinks=True)
+
+    pid, fd = spawn(binary, directory, dict(os.environ, TERM="xterm"))
+    log = open(opts.out, "w")
+    log.write(json.dumps({"version": 1, "dir": directory}) + "\n")
+
+    old = termios.tcgetattr(sys.stdin)
+    tty.setraw(sys.stdin.fileno())
+    start = time.perf_counter()
+    try:
+        while True:
+            r, _, _ = select.select([fd, sys.stdin], [], [])
+            if fd in r:
+                try:
+                    data = os.read(fd, 65536)
+                except OSError:
+                    break
+                if not data:
+                    break
+                os.write(sys.stdout.fileno(), data)
+            if sys.stdin in r:
+                data = os.read(sys.stdin.fileno(), 1024)
+                if not data:
+                    break
+                log.write(json.dumps(
+                    {"t": round(time.perf_counter() - start, 3),
+                     "data": data.decode("utf-8", "surrogateescape")}) + "\n")
+                os.write(fd, data)
+    finally:
+        termios.tcsetattr(sys.stdin, termios.TCSADRAIN, old)
+        log.close()
+        try:
+            os.close(fd)
+            os.waitpid(pid, 0)
+        except OSError:
+            pass
+    print("perf-replay: session saved to %s" % opts.out)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Record clifm sessions and replay them headlessly, "
+        "reporting per-keystroke and per-command latency percentiles")
+    sub = parser.add_subparsers(dest="mode")
+
+    rec = sub.add_parser("record", help="record an interactive session")
+    rec.add_argument("--bin", default="./clifm")
+    rec.add_argument("--dir", help="directory to start in (default: cwd)")
+    rec.add_argument("--out", default="session.json",
+                     help="session file to write (default: session.json)")
+    rec.add_argument("--snapshot", action="store_true",
+                     help="copy the start directory next to the session "
+                     "file, to replay against the exact same tree")
+
+    rep = sub.add_parser("replay", help="replay a session headlessly")
+    rep.add_argument("--bin", default="./clifm")
+    rep.add_argument("--session", help="session file to replay (default: "
+                     "a built-in synthetic session)")
+    rep.add_argument("--dir", help="fixture directory (default: the "
+                     "session's snapshot, or a generated tree)")
+    rep.add_argument("--size", type=int, default=1000,
+                     help="generated fixture size for the built-in "
+                     "session (default: 1000)")
+    rep.add_argument("--speed", type=float, default=0,
+                     help="replay speed factor honoring recorded delays "
+                     "(default: 0, as fast as output settles)")
+
+    argv = sys.argv[1:]
+    if argv[:1] not in (["record"], ["replay"]):
+        argv = ["replay"] + argv  # Default mode
+    opts = parser.parse_args(argv)
+    if opts.mode == "record":
+        run_record(opts)
+    else:
+        run_replay(opts)
+
+
+if __name__ == "__main__":
+    main()
@@ -26,8 +26,13 @@
 #include "helpers.h"
 
 #include <errno.h>
+#include <fcntl.h>    /* open */
+#include <signal.h>   /* signal */
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>   /* fork, execvp, dup2, sysconf */
+#include <sys/mman.h> /* mmap (arc_list_zip()) */
+#include <sys/wait.h> /* waitpid */
 #include <readline/readline.h>
 
 #if defined(_NO_MAGIC) && !defined(_BE_POSIX)
@@ -58,6 +63,154 @@
 #define OP_ISO    1
 #define OP_OTHERS 0
 
+/* Cap for the number of concurrent extraction processes. */
+#define ARC_MAX_PROCS 16
+
+/* Return the number of extraction processes to run concurrently: the number
+ * of available CPU cores, capped to ARC_MAX_PROCS. */
+static size_t
+arc_get_procs(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	const long procs = sysconf(_SC_NPROCESSORS_ONLN);
+	if (procs < 1)
+		return 1;
+
+	return (size_t)procs > ARC_MAX_PROCS ? ARC_MAX_PROCS : (size_t)procs;
+#else
+	return 1;
+#endif /* _SC_NPROCESSORS_ONLN */
+}
+
+/* Run one instance of BASE_CMD (BASE_N strings) per file in FILES (FILES_N
+ * names), appending the corresponding file name to the command, with up to
+ * as many concurrent processes as CPU cores (extracting multiple archives
+ * is mostly CPU-bound decompression, so independent archives are spread
+ * across cores instead of being processed one after the other).
+ *
+ * Children's stdout is redirected to /dev/null to keep concurrent output
+ * from interleaving (stderr is preserved); a progress counter is printed
+ * as each process finishes, and failed files are reported at the end.
+ * Returns zero if every process succeeded, or one otherwise. */
+static int
+arc_run_parallel(char *const base_cmd[], const size_t base_n,
+	char **files, const size_t files_n, const char *msg)
+{
+	const size_t max_procs = arc_get_procs();
+	const size_t nprocs = files_n < max_procs ? files_n : max_procs;
+
+	pid_t *pids = xnmalloc(files_n, sizeof(pid_t));
+	int *codes = xnmalloc(files_n, sizeof(int));
+	char **cmd = xnmalloc(base_n + 2, sizeof(char *));
+
+	size_t i;
+	for (i = 0; i < files_n; i++) {
+		pids[i] = -1;
+		codes[i] = -1;
+	}
+
+	for (i = 0; i < base_n; i++)
+		cmd[i] = base_cmd[i];
+	cmd[base_n + 1] = (char *)NULL;
+
+	size_t next = 0, running = 0, done = 0;
+
+	while (next < files_n || running > 0) {
+		while (running < nprocs && next < files_n) {
+			const pid_t pid = fork();
+
+			if (pid == -1) {
+				if (running > 0) /* Retry once a slot is free. */
+					break;
+				/* No process to wait for: give up on this file. */
+				xerror("archiver: fork: %s\n", strerror(errno));
+				codes[next] = errno;
+				next++;
+				done++;
+				continue;
+			}
+
+			if (pid == 0) {
+				/* Reenable signals for the child, in case they were
+				 * disabled for the parent. */
+				signal(SIGHUP,  SIG_DFL);
+				signal(SIGINT,  SIG_DFL);
+				signal(SIGQUIT, SIG_DFL);
+				signal(SIGTERM, SIG_DFL);
+				signal(SIGTSTP, SIG_IGN);
+
+				const int fd = open(_PATH_DEVNULL, O_WRONLY, 0200);
+				if (fd != -1) {
+					dup2(fd, STDOUT_FILENO);
+					close(fd);
+				}
+
+				cmd[base_n] = files[next];
+				execvp(cmd[0], cmd);
+
+				if (errno == ENOENT) {
+					xerror("archiver: %s: %s\n", cmd[0], NOTFOUND_MSG);
+					_exit(E_NOTFOUND); /* 127, as required by exit(1p). */
+				}
+
+				xerror("archiver: %s: %s\n", cmd[0], strerror(errno));
+				_exit(errno == EACCES || errno == ENOEXEC ? E_NOEXEC : errno);
+			}
+
+			pids[next] = pid;
+			next++;
+			running++;
+		}
+
+		if (running == 0)
+			continue;
+
+		int status = 0;
+		const pid_t pid = waitpid(-1, &status, 0);
+		if (pid == -1) {
+			if (errno == EINTR)
+				continue;
+			break;
+		}
+
+		for (i = 0; i < next; i++) {
+			if (pids[i] == pid)
+				break;
+		}
+
+		if (i == next) /* Not ours (e.g. a finished background job). */
+			continue;
+
+		pids[i] = -1;
+		codes[i] = get_exit_code(status, EXEC_FG_PROC);
+		running--;
+		done++;
+
+		printf(_("\rarchiver: %s... %zu/%zu"), msg, done, files_n);
+		fflush(stdout);
+	}
+
+	putchar('\r');
+	ERASE_TO_RIGHT;
+	fflush(stdout);
+
+	int exit_status = FUNC_SUCCESS;
+	for (i = 0; i < files_n; i++) {
+		if (codes[i] == 0)
+			continue;
+
+		exit_status = FUNC_FAILURE;
+		xerror(_("archiver: '%s': Command exited with code %d\n"),
+			files[i], codes[i]);
+	}
+
+	free(pids);
+	free(codes);
+	free(cmd);
+
+	return exit_status;
+}
+
 static char *
 ask_user_for_path(void)
 {
@@ -726,12 +879,13 @@ zstandard(char *in_file, char *out_file, const char mode, const char op)
 	}
 
 	if (mode == 'c') {
+		/* -T0: compress using all available CPU cores. */
 		if (out_file) {
-			char *cmd[] = {"zstd", "-zo", out_file, deq_file, NULL};
+			char *cmd[] = {"zstd", "-T0", "-zo", out_file, deq_file, NULL};
 			if (launch_execv(cmd, FOREGROUND, E_NOFLAG) != FUNC_SUCCESS)
 				exit_status = FUNC_FAILURE;
 		} else {
-			char *cmd[] = {"zstd", "-z", deq_file, NULL};
+			char *cmd[] = {"zstd", "-T0", "-z", deq_file, NULL};
 
 			if (launch_execv(cmd, FOREGROUND, E_NOFLAG) != FUNC_SUCCESS)
 				exit_status = FUNC_FAILURE;
@@ -838,9 +992,89 @@ compress_zstandard(char *name, char **args)
 	return exit_status;
 }
 
+/* Return the multithreaded compression program matching the extension of
+ * the archive name NAME ("zstd -T0" for .tar.zst/.tzst, "pigz" for
+ * .tar.gz/.tgz), provided both tar(1) and the compressor are available
+ * and there is more than one CPU core, or NULL otherwise. */
+static const char *
+get_mt_compress_program(const char *name)
+{
+	const size_t len = strlen(name);
+	const char *prog = (char *)NULL;
+	const char *bin = (char *)NULL;
+
+	if ((len > 8 && strcmp(name + len - 8, ".tar.zst") == 0)
+	|| (len > 5 && strcmp(name + len - 5, ".tzst") == 0)) {
+		prog = "zstd -T0";
+		bin = "zstd";
+	} else if ((len > 7 && strcmp(name + len - 7, ".tar.gz") == 0)
+	|| (len > 4 && strcmp(name + len - 4, ".tgz") == 0)) {
+		prog = "pigz"; /* Parallel gzip (defaults to all CPU cores). */
+		bin = "pigz";
+	}
+
+	if (!prog || arc_get_procs() < 2)
+		return (char *)NULL;
+
+	char *p = get_cmd_path(bin);
+	if (!p)
+		return (char *)NULL;
+	free(p);
+
+	p = get_cmd_path("tar");
+	if (!p)
+		return (char *)NULL;
+	free(p);
+
+	return prog;
+}
+
+/* Archive the files in ARGS into NAME running tar(1) with the
+ * multithreaded compressor PROG, so that compression is not serialized
+ * through a single gzip/zstd thread as with atool(1). */
+static int
+compress_mt_tar(char **args, char *name, const char *prog)
+{
+	size_t n = 0, i;
+	for (i = 1; args[i]; i++);
+
+	char **tcmd = xnmalloc(6 + i + 1, sizeof(char *));
+	tcmd[0] = savestring("tar", 3);
+	tcmd[1] = savestring("--use-compress-program", 22);
+	tcmd[2] = savestring(prog, strlen(prog));
+	tcmd[3] = savestring("-cf", 3);
+	tcmd[4] = savestring(name, strlen(name));
+	tcmd[5] = savestring("--", 2);
+	n += 6;
+
+	for (i = 1; args[i]; i++) {
+		char *p = unescape_str(args[i], 0);
+		if (!p)
+			continue;
+		tcmd[n] = savestring(p, strlen(p));
+		free(p);
+		n++;
+	}
+	tcmd[n] = (char *)NULL;
+
+	const int ret = launch_execv(tcmd, FOREGROUND, E_NOFLAG);
+
+	for (i = 0; tcmd[i]; i++)
+		free(tcmd[i]);
+	free(tcmd);
+
+	return ret;
+}
+
 static int
 compress_others(char **args, char *name)
 {
+	/* Prefer a multithreaded compressor whenever one matching the target
+	 * format is installed. */
+	const char *mt_prog = get_mt_compress_program(name);
+	if (mt_prog)
+		return compress_mt_tar(args, name, mt_prog);
+
 	size_t n = 0, i;
 	for (i = 1; args[i]; i++);
 
@@ -885,6 +1119,15 @@ compress_files(char **args)
 
 	/* # ZSTANDARD # */
 	if (ret && strcmp(ret, ".zst") == 0) {
+		/* A tarball (.tar.zst) is a job for tar(1), not for zstd alone
+		 * (which cannot archive directories nor multiple files). */
+		const char *mt_prog = get_mt_compress_program(name);
+		if (mt_prog) {
+			exit_status = compress_mt_tar(args, name, mt_prog);
+			free(name);
+			return exit_status;
+		}
+
 		exit_status = compress_zstandard(name, args);
 		free(name);
 		return exit_status;
@@ -1012,6 +1255,30 @@ decompress_zstandard(char **args)
 	if (sel_op == 0) /* quit */
 		return FUNC_SUCCESS;
 
+	/* Extraction and testing of multiple files are independent operations:
+	 * run them concurrently, one zstd(1) process per file ('i' is kept
+	 * serial, since its whole point is the printed output). */
+	if ((sel_op == 'e' || sel_op == 't') && arc_get_procs() >= 2) {
+		char **files = xnmalloc(files_num, sizeof(char *));
+		size_t n = 0;
+
+		for (i = 1; args[i]; i++) {
+			char *deq = unescape_str(args[i], 0);
+			files[n] = deq ? deq : savestring(args[i], strlen(args[i]));
+			n++;
+		}
+
+		char *const cmd[] = {"zstd", sel_op == 'e' ? "-d" : "-t"};
+		exit_status = arc_run_parallel(cmd, 2, files, n, sel_op == 'e'
+			? _("Extracting files") : _("Testing files"));
+
+		for (i = 0; i < n; i++)
+			free(files[i]);
+		free(files);
+
+		return exit_status;
+	}
+
 	for (i = 1; args[i]; i++) {
 		if (zstandard(args[i], NULL, 'd', sel_op) != FUNC_SUCCESS)
 			exit_status = FUNC_FAILURE;
@@ -1020,6 +1287,279 @@ decompress_zstandard(char **args)
 	return exit_status;
 }
 
+/* Native archive listers.
+ *
+ * Uncompressed tar(5) and zip archives carry their own index: tar
+ * headers can be read sequentially, skipping file data via lseek(2),
+ * and zip stores a central directory at the end of the file. For these
+ * two formats we list entries directly, without spawning an external
+ * process and without ever decompressing file data. Everything else
+ * (compressed tarballs, exotic formats) still goes through atool(1). */
+
+#define TAR_BLK_SIZE 512
+/* Size cap for in-memory metadata blocks (long names, pax headers) */
+#define TAR_META_MAX (1024 * 1024)
+
+/* Decode a numeric tar header field (octal ASCII, or base-256 for the
+ * GNU large-file extension). */
+static long long
+tar_field_num(const char *field, const size_t len)
+{
+	if (*field & 0x80) { /* Base-256 */
+		long long val = (unsigned char)*field & 0x7f;
+		size_t i;
+		for (i = 1; i < len; i++)
+			val = (val << 8) | (unsigned char)field[i];
+		return val;
+	}
+
+	char buf[32];
+	const size_t l = len < sizeof(buf) - 1 ? len : sizeof(buf) - 1;
+	memcpy(buf, field, l);
+	buf[l] = '\0';
+
+	return strtoll(buf, NULL, 8);
+}
+
+/* List the contents of the uncompressed tar file FD by walking its
+ * headers, seeking over file data. Returns FUNC_SUCCESS if the whole
+ * archive was listed, or FUNC_FAILURE otherwise (in which case the
+ * caller falls back to atool(1)). */
+static int
+arc_list_tar(const int fd)
+{
+	char blk[TAR_BLK_SIZE];
+	char *longname = (char *)NULL;
+
+	while (read(fd, blk, sizeof(blk)) == (ssize_t)sizeof(blk)) {
+		if (*blk == '\0') /* Empty block: end of archive */
+			break;
+
+		if (strncmp(blk + 257, "ustar", 5) != 0) { /* Corrupt/old format */
+			free(longname);
+			return FUNC_FAILURE;
+		}
+
+		const char type = blk[156];
+		long long size = tar_field_num(blk + 124, 12);
+		if (size < 0) {
+			free(longname);
+			return FUNC_FAILURE;
+		}
+
+		/* Metadata blocks (GNU long names, pax extended headers) are
+		 * read into memory, and their size comes straight from the
+		 * archive: a name or pax record set legitimately fits well
+		 * under this cap, so anything bigger is a corrupt (or
+		 * malicious) archive. */
+		if ((type == 'L' || type == 'x' || type == 'g')
+		&& size > TAR_META_MAX) {
+			free(longname);
+			return FUNC_FAILURE;
+		}
+
+		if (type == 'L') { /* GNU long name: data blocks hold the name */
+			free(longname);
+			longname = xnmalloc((size_t)size + 1, sizeof(char));
+			if (read(fd, longname, (size_t)size) != (ssize_t)size) {
+				free(longname);
+				return FUNC_FAILURE;
+			}
+			longname[size] = '\0';
+			/* Skip padding up to the next block boundary */
+			lseek(fd, ((size + TAR_BLK_SIZE - 1) / TAR_BLK_SIZE)
+				* TAR_BLK_SIZE - size, SEEK_CUR);
+			continue;
+		}
+
+		if (type == 'x' || type == 'g') {
+			/* Pax extended header: the data blocks hold records of the
+			 * form "<len> <key>=<value>\n", LEN being the decimal
+			 * length of the whole record. A 'path' record carries the
+			 * full name of the next entry when it does not fit the
+			 * 100-byte ustar name field (pax is bsdtar's default
+			 * format). */
+			char *ext = xnmalloc((size_t)size + 1, sizeof(char));
+			if (read(fd, ext, (size_t)size) != (ssize_t)size) {
+				free(ext);
+				free(longname);
+				return FUNC_FAILURE;
+			}
+			ext[size] = '\0';
+
+			char *p = ext;
+			while (p < ext + size) {
+				char *endp = (char *)NULL;
+				const long long rlen = strtoll(p, &endp, 10);
+				if (rlen <= 0 || !endp || *endp != ' '
+				|| p + rlen > ext + size)
+					break; /* Malformed record */
+
+				if (strncmp(endp + 1, "path=", 5) == 0
+				&& p + rlen - 1 > endp + 6) {
+					if (type == 'g') {
+						/* A global default path applies to every
+						 * following entry: too exotic to second-guess.
+						 * Leave this archive to atool(1). */
+						free(ext);
+						free(longname);
+						return FUNC_FAILURE;
+					}
+					const size_t vlen =
+						(size_t)(p + rlen - 1 - (endp + 6));
+					free(longname);
+					longname = xnmalloc(vlen + 1, sizeof(char));
+					memcpy(longname, endp + 6, vlen);
+					longname[vlen] = '\0';
+				}
+
+				p += rlen;
+			}
+
+			free(ext);
+			lseek(fd, ((size + TAR_BLK_SIZE - 1) / TAR_BLK_SIZE)
+				* TAR_BLK_SIZE - size, SEEK_CUR);
+			continue;
+		}
+
+		if (longname) {
+			puts(longname);
+			free(longname);
+			longname = (char *)NULL;
+		} else {
+			blk[155] = '\0'; /* Ensure name is NUL-terminated */
+			if (blk[345]) { /* POSIX prefix field */
+				char name[257];
+				blk[500] = '\0';
+				snprintf(name, sizeof(name), "%.155s/%.100s",
+					blk + 345, blk);
+				puts(name);
+			} else {
+				printf("%.100s\n", blk);
+			}
+		}
+
+		/* Skip file data (padded to a whole number of blocks) */
+		const long long blocks = (size + TAR_BLK_SIZE - 1) / TAR_BLK_SIZE;
+		if (lseek(fd, blocks * TAR_BLK_SIZE, SEEK_CUR) == (off_t)-1) {
+			free(longname);
+			return FUNC_FAILURE;
+		}
+	}
+
+	free(longname);
+	return FUNC_SUCCESS;
+}
+
+static uint32_t
+zip_le32(const unsigned char *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8)
+		| ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t
+zip_le16(const unsigned char *p)
+{
+	return (uint16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+}
+
+#define ZIP_EOCD_SIG  0x06054b50 /* End of central directory */
+#define ZIP_CDIR_SIG  0x02014b50 /* Central directory file header */
+#define ZIP_EOCD_SIZE 22
+/* EOCD record plus the maximum comment length */
+#define ZIP_EOCD_SEARCH (ZIP_EOCD_SIZE + 0xffff)
+
+/* List the contents of the zip file FD (FSIZE bytes) by walking its
+ * central directory via mmap(2). Returns FUNC_SUCCESS if the whole
+ * archive was listed, or FUNC_FAILURE otherwise. */
+static int
+arc_list_zip(const int fd, const off_t fsize)
+{
+	if (fsize < ZIP_EOCD_SIZE)
+		return FUNC_FAILURE;
+
+	unsigned char *map = mmap(NULL, (size_t)fsize, PROT_READ,
+		MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED)
+		return FUNC_FAILURE;
+
+	/* Locate the end-of-central-directory record: scan backwards over
+	 * the trailing archive comment (at most 64KiB). */
+	off_t eocd = -1;
+	const off_t stop = fsize > ZIP_EOCD_SEARCH ? fsize - ZIP_EOCD_SEARCH : 0;
+	off_t i = fsize - ZIP_EOCD_SIZE;
+	for (; i >= stop; i--) {
+		if (zip_le32(map + i) == ZIP_EOCD_SIG) {
+			eocd = i;
+			break;
+		}
+	}
+
+	if (eocd == -1) {
+		munmap(map, (size_t)fsize);
+		return FUNC_FAILURE;
+	}
+
+	const uint16_t entries = zip_le16(map + eocd + 10);
+	const uint32_t cd_off = zip_le32(map + eocd + 16);
+	if (entries == 0xffff || cd_off == 0xffffffff /* Zip64 */
+	|| (off_t)cd_off >= fsize) {
+		munmap(map, (size_t)fsize);
+		return FUNC_FAILURE;
+	}
+
+	off_t p = (off_t)cd_off;
+	uint16_t n;
+	for (n = 0; n < entries; n++) {
+		if (p + 46 > fsize || zip_le32(map + p) != ZIP_CDIR_SIG)
+			break;
+
+		const uint16_t name_len = zip_le16(map + p + 28);
+		const uint16_t extra_len = zip_le16(map + p + 30);
+		const uint16_t comment_len = zip_le16(map + p + 32);
+
+		if (p + 46 + (off_t)name_len > fsize)
+			break;
+
+		printf("%.*s\n", (int)name_len, map + p + 46);
+		p += 46 + name_len + extra_len + comment_len;
+	}
+
+	munmap(map, (size_t)fsize);
+	return n == entries ? FUNC_SUCCESS : FUNC_FAILURE;
+}
+
+/* List the contents of the archive FILE using the native readers.
+ * Returns FUNC_SUCCESS if FILE was listed, or FUNC_FAILURE if its
+ * format is not natively supported (compressed tarballs need a
+ * decompressor, so they are left to atool(1)). */
+static int
+arc_list_native(const char *file)
+{
+	const int fd = open(file, O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+		return FUNC_FAILURE;
+
+	int ret = FUNC_FAILURE;
+	unsigned char magic[262];
+	const ssize_t len = read(fd, magic, sizeof(magic));
+
+	if (len >= 4 && magic[0] == 'P' && magic[1] == 'K'
+	&& ((magic[2] == 3 && magic[3] == 4)
+	|| (magic[2] == 5 && magic[3] == 6))) {
+		const off_t fsize = lseek(fd, 0, SEEK_END);
+		if (fsize != (off_t)-1)
+			ret = arc_list_zip(fd, fsize);
+	} else if (len >= 262 && strncmp((char *)magic + 257, "ustar", 5) == 0) {
+		if (lseek(fd, 0, SEEK_SET) != (off_t)-1)
+			ret = arc_list_tar(fd);
+	}
+
+	close(fd);
+	return ret;
+}
+
 static int
 list_others(char **args)
 {
@@ -1029,6 +1569,9 @@ list_others(char **args)
 	for (i = 1; args[i]; i++) {
 		printf(_("%s%sFile%s: %s\n"), (i > 1) ? "\n" : "", BOLD, df_c, args[i]);
 
+		if (arc_list_native(args[i]) == FUNC_SUCCESS)
+			continue;
+
 		char *cmd[] = {"atool", "-l", args[i], NULL};
 		if (launch_execv(cmd, FOREGROUND, E_NOFLAG) != FUNC_SUCCESS)
 			exit_status = FUNC_FAILURE;
@@ -1070,6 +1613,15 @@ extract_others(char **args)
 
 	for (i = 1; args[i]; i++);
 
+	/* Multiple archives are independent of each other: extract them
+	 * concurrently (one atool(1) process per archive) instead of letting
+	 * a single atool process take them one by one. */
+	if (i - 1 >= 2 && arc_get_procs() >= 2) {
+		char *const cmd[] = {"atool", "-x", "-e"};
+		return arc_run_parallel(cmd, 3, args + 1, i - 1,
+			_("Extracting archives"));
+	}
+
 	/* Construct the cmd */
 	tcmd = xnmalloc(3 + i + 1, sizeof(char *));
 	tcmd[0] = savestring("atool", 5);
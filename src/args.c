@@ -155,6 +155,8 @@
 #define LOPT_PTIME_STYLE            277
 #define LOPT_COLOR_LNK_AS_TARGET    278
 #define LOPT_PAGER_VIEW             279
+#define LOPT_BATCH                  280
+#define LOPT_IPC                    281
 
 /* Link long (--option) and short options (-o) for the getopt_long function. */
 static struct option const longopts[] = {
@@ -198,6 +200,7 @@ static struct option const longopts[] = {
 	{"sort", required_argument, 0, 'z'},
 
 	/* Only-long options */
+	{"batch", no_argument, 0, LOPT_BATCH},
 	{"bell", required_argument, 0, LOPT_BELL},
 	{"case-sens-dirjump", no_argument, 0, LOPT_CASE_SENS_DIRJUMP},
 	{"case-sens-path-comp", no_argument, 0, LOPT_CASE_SENS_PATH_COMP},
@@ -217,6 +220,7 @@ static struct option const longopts[] = {
 	{"fzftab", no_argument, 0, LOPT_FZFTAB},
 	{"fzytab", no_argument, 0, LOPT_FZYTAB}, // legacy: replaced by fnftab
 	{"icons", no_argument, 0, LOPT_ICONS},
+	{"ipc", no_argument, 0, LOPT_IPC},
 	{"icons-use-file-color", no_argument, 0, LOPT_ICONS_USE_FILE_COLOR},
 	{"int-vars", no_argument, 0, LOPT_INT_VARS},
 	{"list-and-quit", no_argument, 0, LOPT_LIST_AND_QUIT},
@@ -1541,6 +1545,10 @@ parse_cmdline_args(const int argc, char **argv)
 		case 'z': set_sort(optarg); break;
 
 		/* Only-long options */
+		case LOPT_BATCH:
+			xargs.batch = 1; break;
+		case LOPT_IPC:
+			xargs.ipc = 1; break;
 		case LOPT_BELL:
 			set_bell_style(optarg); break;
 		case LOPT_CASE_SENS_DIRJUMP:
@@ -24,15 +24,25 @@
 
 #include "helpers.h"
 
+#include <fnmatch.h>
 #include <stdio.h>
 #include <string.h>
 #include <readline/tilde.h>
 
 #include "aux.h"
+#include "checks.h" /* check_glob_char() */
 #include "colors.h"
 #include "sanitize.h"
 #include "spawn.h"
 
+/* How an autocmd pattern is matched against the current directory. Set
+ * at parse time by precompile_autocmd_pattern(). */
+#define ACM_WS      0 /* Workspace number (@wsN) */
+#define ACM_PREFIX  1 /* Literal prefix (pattern ending in "**") */
+#define ACM_LITERAL 2 /* Plain text: direct string comparison */
+#define ACM_FNMATCH 3 /* Glob expression: fnmatch(3) against the cwd */
+#define ACM_GLOB_FS 4 /* Brace expression: glob(3) (scans the filesystem) */
+
 /* The opts struct contains option values previous to any autocommand call */
 void
 reset_opts(void)
@@ -61,81 +71,60 @@ check_autocmds(void)
 	int found = 0;
 
 	for (i = 0; i < autocmds_n; i++) {
-		if (!autocmds[i].pattern)
+		if (!autocmds[i].pattern || !autocmds[i].xpattern)
 			continue;
 
-		int rev = 0;
-		char *p = autocmds[i].pattern;
-		if (*p == '!') {
-			++p;
-			rev = 1;
-		}
+		found = 0;
 
-		/* Check workspaces (@wsN)*/
-		if (*autocmds[i].pattern == '@' && autocmds[i].pattern[1] == 'w'
-		&& autocmds[i].pattern[2] == 's' && autocmds[i].pattern[3]
-		/* char '1' - 48 (or '0') == int 1 */
-		&& autocmds[i].pattern[3] - 48 == cur_ws + 1) {
-			found = 1;
-			goto RUN_AUTOCMD;
-		}
+		switch (autocmds[i].match_type) {
+		case ACM_WS:
+			found = (autocmds[i].ws == cur_ws + 1);
+			break;
 
-		/* Double asterisk: match everything starting with PATTERN
-		 * (less double asterisk itself and ending slash)*/
-		size_t plen = strlen(p), n = 0;
-		if (!rev && plen >= 3 && p[plen - 1] == '*' && p[plen - 2] == '*') {
-			n = 2;
-			if (p[plen - 3] == '/')
-				n++;
-
-			if (*p == '~') {
-				p[plen - n] = '\0';
-				char *path = tilde_expand(p);
-				if (!path)
-					continue;
-
-				p[plen - n] = (n == 2 ? '*' : '/');
-				const size_t tlen = strlen(path);
-				const int ret = strncmp(path, workspaces[cur_ws].path, tlen);
-				free(path);
-
-				if (ret == 0) {
-					found = 1;
-					goto RUN_AUTOCMD;
-				}
+		case ACM_PREFIX:
+			/* If XLEN == 0 we have "/\**", that is, match everything:
+			 * no need to perform any check. */
+			found = (autocmds[i].xlen == 0 || strncmp(autocmds[i].xpattern,
+				workspaces[cur_ws].path, autocmds[i].xlen) == 0);
+			break;
+
+		case ACM_LITERAL:
+			found = (*autocmds[i].xpattern == *workspaces[cur_ws].path
+				&& strcmp(autocmds[i].xpattern,
+				workspaces[cur_ws].path) == 0);
+			break;
 
-			} else { /* We have an absolute path */
-				/* If (plen - n) == 0 we have "/\**", that is, match everything:
-				 * no need to perform any check. */
-				if (plen - n == 0 || strncmp(autocmds[i].pattern,
-				workspaces[cur_ws].path, plen - n) == 0) {
+		case ACM_FNMATCH:
+			/* FNM_PATHNAME | FNM_PERIOD == glob(3) matching semantics */
+			found = (fnmatch(autocmds[i].xpattern, workspaces[cur_ws].path,
+				FNM_PATHNAME | FNM_PERIOD) == 0);
+			break;
+
+		case ACM_GLOB_FS: /* fallthrough */
+		default: {
+			glob_t g;
+			const int ret = glob(autocmds[i].xpattern, GLOB_NOSORT
+			| GLOB_NOCHECK | GLOB_TILDE | GLOB_BRACE, NULL, &g);
+
+			if (ret != FUNC_SUCCESS) {
+				globfree(&g);
+				continue;
+			}
+
+			size_t j;
+			for (j = 0; j < g.gl_pathc; j++) {
+				if (*workspaces[cur_ws].path == *g.gl_pathv[j]
+				&& strcmp(workspaces[cur_ws].path, g.gl_pathv[j]) == 0) {
 					found = 1;
-					goto RUN_AUTOCMD;
+					break;
 				}
 			}
-		}
-
-		/* Glob expression or plain text for PATTERN */
-		glob_t g;
-		const int ret = glob(p, GLOB_NOSORT | GLOB_NOCHECK | GLOB_TILDE
-		| GLOB_BRACE, NULL, &g);
-
-		if (ret != FUNC_SUCCESS) {
 			globfree(&g);
-			continue;
+			break;
 		}
-
-		size_t j;
-		for (j = 0; j < g.gl_pathc; j++) {
-			if (*workspaces[cur_ws].path == *g.gl_pathv[j]
-			&& strcmp(workspaces[cur_ws].path, g.gl_pathv[j]) == 0) {
-				found = 1;
-				break;
-			}
 		}
-		globfree(&g);
 
-		if (rev == 0) {
+		if (autocmds[i].neg == 0) {
 			if (found == 0)
 				continue;
 		} else {
@@ -143,7 +132,6 @@ check_autocmds(void)
 				continue;
 		}
 
-RUN_AUTOCMD:
 		if (autocmd_set == 0) {
 			/* Backup current options, only if there was no autocmd for
 			 * this directory */
@@ -291,6 +279,79 @@ init_autocmd_opts(void)
 	autocmds[autocmds_n].sort_reverse = conf.sort_reverse;
 }
 
+/* Classify the autocmd pattern and leave a ready-to-match copy in the
+ * XPATTERN field, so that check_autocmds(), run on every directory change,
+ * resolves most patterns with a plain string comparison (or fnmatch(3)),
+ * instead of expanding tildes and scanning the filesystem via glob(3)
+ * over and over for patterns that never change. */
+static void
+precompile_autocmd_pattern(struct autocmds_t *a)
+{
+	char *p = a->pattern;
+
+	a->xpattern = (char *)NULL;
+	a->xlen = 0;
+	a->neg = 0;
+	a->ws = -1;
+
+	/* Workspace pattern (@wsN) */
+	if (*p == '@' && p[1] == 'w' && p[2] == 's' && p[3]) {
+		a->match_type = ACM_WS;
+		a->ws = p[3] - 48; /* char '1' - 48 (or '0') == int 1 */
+		a->xpattern = savestring(p, strlen(p));
+		return;
+	}
+
+	if (*p == '!') {
+		p++;
+		a->neg = 1;
+	}
+
+	const size_t plen = strlen(p);
+
+	/* Double asterisk: match everything starting with PATTERN
+	 * (less double asterisk itself and ending slash) */
+	if (a->neg == 0 && plen >= 3 && p[plen - 1] == '*' && p[plen - 2] == '*') {
+		size_t n = 2;
+		if (p[plen - 3] == '/')
+			n++;
+
+		if (*p == '~') {
+			const char c = p[plen - n];
+			p[plen - n] = '\0';
+			char *path = tilde_expand(p);
+			p[plen - n] = c;
+
+			if (path) {
+				a->match_type = ACM_PREFIX;
+				a->xpattern = path;
+				a->xlen = strlen(path);
+				return;
+			}
+			/* Expansion error: fall back to the glob checks below */
+		} else {
+			a->match_type = ACM_PREFIX;
+			a->xpattern = savestring(p, plen - n);
+			a->xlen = plen - n;
+			return;
+		}
+	}
+
+	/* Glob expression or plain text for PATTERN */
+	char *exp = *p == '~' ? tilde_expand(p) : (char *)NULL;
+	a->xpattern = exp ? exp : savestring(p, plen);
+	a->xlen = strlen(a->xpattern);
+
+	if (strchr(a->xpattern, '{'))
+		/* fnmatch(3) performs no brace expansion: keep the glob(3) call
+		 * for this (unusual) kind of pattern. */
+		a->match_type = ACM_GLOB_FS;
+	else if (check_glob_char(a->xpattern, GLOB_ONLY) == 1)
+		a->match_type = ACM_FNMATCH;
+	else
+		a->match_type = ACM_LITERAL;
+}
+
 /* Take an autocmd line (from the config file) and store parameters
  * in a struct. */
 void
@@ -311,6 +372,7 @@ parse_autocmd_line(char *cmd, const size_t buflen)
 
 	autocmds = xnrealloc(autocmds, autocmds_n + 1, sizeof(struct autocmds_t));
 	autocmds[autocmds_n].pattern = savestring(cmd, strnlen(cmd, buflen));
+	precompile_autocmd_pattern(&autocmds[autocmds_n]);
 
 	init_autocmd_opts();
 
@@ -34,8 +34,10 @@
 # include <attr.h> /* getattrat, nvlist_lookup_uint64_array, nvlist_free */
 #endif /* __sun && ST_BTIME */
 #include <errno.h>
+#include <pthread.h> /* xstatvfs() background refresh */
 #include <stdio.h>
 #include <string.h>
+#include <sys/statvfs.h> /* xstatvfs() */
 #include <termios.h>
 #include <unistd.h>
 #include <time.h>
@@ -82,6 +84,257 @@ xregerror(const char *cmd_name, const char *pattern, const int errcode,
 	free(buf);
 }
 
+/* A small process-wide lstat(2) cache. While suggesting and completing,
+ * the same candidate paths get stat'ed several times within a single
+ * keystroke (suggestions, tab completion, and completion colors each ask
+ * on their own). On network filesystems each of these calls is a round
+ * trip. Results (failures included) are cached until the next generation:
+ * the cache is invalidated whenever the files list is reloaded or a
+ * command is executed (see stat_cache_invalidate()). */
+#define STAT_CACHE_SIZE 64 /* Must be a power of 2 */
+
+struct stat_cache_t {
+	char *path;
+	struct stat attr;
+	size_t gen;
+	int ret;
+};
+
+static struct stat_cache_t stat_cache[STAT_CACHE_SIZE];
+static size_t stat_cache_gen = 1;
+
+static void svfs_cache_invalidate(void);
+
+/* Drop all cached stat results (cheap: just bump the generation), and mark
+ * cached statvfs results as stale (they are refreshed in the background). */
+void
+stat_cache_invalidate(void)
+{
+	stat_cache_gen++;
+	svfs_cache_invalidate();
+}
+
+/* Release the memory used by the stat cache (at exit). */
+void
+stat_cache_free(void)
+{
+	size_t i;
+	for (i = 0; i < STAT_CACHE_SIZE; i++) {
+		free(stat_cache[i].path);
+		stat_cache[i].path = (char *)NULL;
+	}
+}
+
+/* Same as lstat(2), but serve repeated requests for PATH from the cache
+ * while the current generation lasts. On a cached failure -1 is returned,
+ * but errno is not set. */
+int
+xlstat_cached(const char *path, struct stat *attr)
+{
+	if (!path || !*path)
+		return lstat(path, attr);
+
+	struct stat_cache_t *e =
+		&stat_cache[hashme(path, 1) & (STAT_CACHE_SIZE - 1)];
+
+	if (e->path && e->gen == stat_cache_gen && strcmp(e->path, path) == 0) {
+		if (e->ret == -1)
+			return (-1);
+		*attr = e->attr;
+		return 0;
+	}
+
+	const int ret = lstat(path, attr);
+
+	free(e->path);
+	e->path = savestring(path, strlen(path));
+	e->gen = stat_cache_gen;
+	e->ret = ret;
+	if (ret != -1)
+		e->attr = *attr;
+
+	return ret;
+}
+
+/* A per-filesystem statvfs(2) cache with a short TTL, refreshed in the
+ * background. statvfs() against a hung network mount (autofs/NFS) can
+ * block indefinitely, and print_disk_usage() in listing.c runs on every
+ * listing: serving a slightly stale figure from the cache keeps the UI
+ * thread from ever issuing a blocking statvfs call. Only the very first
+ * lookup of a filesystem waits for the result, and only for a short grace
+ * period, after which it is abandoned to the background. */
+#define SVFS_CACHE_SIZE 16
+#define SVFS_CACHE_TTL  10  /* Seconds */
+#define SVFS_FIRST_WAIT 500 /* Milliseconds to wait for a first lookup */
+
+struct svfs_cache_t {
+	char *path; /* Directory the entry was resolved from */
+	struct statvfs st;
+	time_t ts;  /* Time the entry was last refreshed */
+	dev_t dev;
+	int valid;
+	int refreshing; /* A background refresh is in flight */
+};
+
+static struct svfs_cache_t svfs_cache[SVFS_CACHE_SIZE];
+static pthread_mutex_t svfs_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t svfs_cond = PTHREAD_COND_INITIALIZER;
+
+static void *
+svfs_refresh_worker(void *arg)
+{
+	struct svfs_cache_t *e = (struct svfs_cache_t *)arg;
+	struct statvfs st;
+
+	/* E->path is neither freed nor modified while E->refreshing is set. */
+	const int ret = statvfs(e->path, &st);
+
+	pthread_mutex_lock(&svfs_lock);
+	if (ret == 0) {
+		e->st = st;
+		e->valid = 1;
+	}
+	e->ts = time(NULL);
+	e->refreshing = 0;
+	pthread_cond_broadcast(&svfs_cond);
+	pthread_mutex_unlock(&svfs_lock);
+
+	return NULL;
+}
+
+/* Launch a detached background refresh for the cache entry E (which must
+ * be marked as refreshing by the caller). Return 0 on success. */
+static int
+svfs_refresh_start(struct svfs_cache_t *e)
+{
+	pthread_t tid;
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+	const int ret = pthread_create(&tid, &attr, svfs_refresh_worker, e);
+	pthread_attr_destroy(&attr);
+
+	if (ret != 0)
+		e->refreshing = 0;
+
+	return ret;
+}
+
+/* Mark all statvfs cache entries as stale, so that the next lookup serves
+ * the cached value and triggers a background refresh. */
+static void
+svfs_cache_invalidate(void)
+{
+	pthread_mutex_lock(&svfs_lock);
+	size_t i;
+	for (i = 0; i < SVFS_CACHE_SIZE; i++)
+		svfs_cache[i].ts = 0;
+	pthread_mutex_unlock(&svfs_lock);
+}
+
+/* Same as statvfs(2), but keyed by filesystem (st_dev) and served from the
+ * cache whenever possible: a stale entry is returned immediately and
+ * refreshed in the background. On failure -1 is returned and errno is set
+ * (EAGAIN if the result is simply not available yet). */
+int
+xstatvfs(const char *path, struct statvfs *buf)
+{
+	if (!path || !*path) {
+		errno = ENOENT;
+		return (-1);
+	}
+
+	struct stat a;
+	if (stat(path, &a) == -1)
+		return (-1);
+
+	pthread_mutex_lock(&svfs_lock);
+
+	size_t i;
+	struct svfs_cache_t *e = (struct svfs_cache_t *)NULL;
+	struct svfs_cache_t *spare = (struct svfs_cache_t *)NULL;
+	for (i = 0; i < SVFS_CACHE_SIZE; i++) {
+		if (svfs_cache[i].path && svfs_cache[i].dev == a.st_dev) {
+			e = &svfs_cache[i];
+			break;
+		}
+		/* Remember the oldest reusable slot in case this is a new entry. */
+		if (svfs_cache[i].refreshing == 0
+		&& (!spare || !svfs_cache[i].path || (spare->path
+		&& svfs_cache[i].ts < spare->ts)))
+			spare = &svfs_cache[i];
+	}
+
+	if (e) {
+		const int stale = (time(NULL) - e->ts >= SVFS_CACHE_TTL);
+		if (e->valid == 1) {
+			*buf = e->st;
+			if (stale == 1 && e->refreshing == 0) {
+				e->refreshing = 1;
+				svfs_refresh_start(e);
+			}
+			pthread_mutex_unlock(&svfs_lock);
+			return 0;
+		}
+
+		/* No usable data (first fetch still running, or it failed). */
+		if (e->refreshing == 0 && stale == 1) {
+			e->refreshing = 1;
+			svfs_refresh_start(e);
+		}
+		pthread_mutex_unlock(&svfs_lock);
+		errno = EAGAIN;
+		return (-1);
+	}
+
+	if (!spare) { /* All slots busy refreshing: do not block. */
+		pthread_mutex_unlock(&svfs_lock);
+		errno = EAGAIN;
+		return (-1);
+	}
+
+	/* First lookup of this filesystem. */
+	free(spare->path);
+	spare->path = savestring(path, strlen(path));
+	spare->dev = a.st_dev;
+	spare->valid = 0;
+	spare->ts = 0;
+	spare->refreshing = 1;
+
+	if (svfs_refresh_start(spare) != 0) {
+		/* Cannot spawn a thread: fall back to a synchronous call. */
+		pthread_mutex_unlock(&svfs_lock);
+		return statvfs(path, buf);
+	}
+
+	/* Give the very first lookup a short grace period: on a healthy
+	 * filesystem statvfs() returns instantly; on a hung mount we give
+	 * up and let the worker fill the cache whenever it completes. */
+	struct timespec ts;
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_sec += SVFS_FIRST_WAIT / 1000;
+	ts.tv_nsec += (SVFS_FIRST_WAIT % 1000) * 1000000L;
+	if (ts.tv_nsec >= 1000000000L) {
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000L;
+	}
+
+	while (spare->refreshing == 1) {
+		if (pthread_cond_timedwait(&svfs_cond, &svfs_lock, &ts) != 0)
+			break;
+	}
+
+	if (spare->valid == 1) {
+		*buf = spare->st;
+		pthread_mutex_unlock(&svfs_lock);
+		return 0;
+	}
+
+	pthread_mutex_unlock(&svfs_lock);
+	errno = EAGAIN;
+	return (-1);
+}
+
 /* Generate a hash of the string STR (case sensitively if CASE_SENTITIVE is
  * set to 1).
  * Based on the sdbm algorithm (see http://www.cse.yorku.ca/~oz/hash.html),
@@ -701,6 +954,90 @@ open_fread(const char *name, int *fd)
 	return fp;
 }
 
+/* Read the regular file FD into a single NUL-terminated heap buffer
+ * (one read(2) for the whole file instead of one getline(3)/fgets(3)
+ * call per line). Returns the buffer, or NULL on error. */
+char *
+load_file_to_buf(const int fd)
+{
+	struct stat a;
+	if (fstat(fd, &a) == -1 || !S_ISREG(a.st_mode) || a.st_size < 0)
+		return (char *)NULL;
+
+	const size_t size = (size_t)a.st_size;
+	char *buf = xnmalloc(size + 1, sizeof(char));
+
+	size_t total = 0;
+	while (total < size) {
+		const ssize_t n = read(fd, buf + total, size - total);
+		if (n == -1 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			break;
+		total += (size_t)n;
+	}
+
+	buf[total] = '\0';
+	return buf;
+}
+
+/* In-place line iterator for buffers returned by load_file_to_buf().
+ * *BUFP points to the current position in the buffer: the terminating
+ * newline of the current line, if any, is replaced by a NUL byte, and
+ * *BUFP is advanced to the next line. Returns the current line (setting
+ * *LINE_LEN to its length), or NULL at the end of the buffer. */
+char *
+get_buf_line(char **bufp, size_t *line_len)
+{
+	char *line = *bufp;
+	if (!line || !*line)
+		return (char *)NULL;
+
+	char *nl = strchr(line, '\n');
+	if (nl) {
+		*nl = '\0';
+		*line_len = (size_t)(nl - line);
+		*bufp = nl + 1;
+	} else {
+		*line_len = strlen(line);
+		*bufp = line + *line_len;
+	}
+
+	return line;
+}
+
+/* Look up the keyword NAME (NAME_LEN bytes long, not necessarily
+ * NUL-terminated, pointing into a writable buffer) in the keyword table
+ * KWS (terminated by an entry whose name is NULL). Each keyword's hash
+ * is computed once, on the table's first use, so that lines are matched
+ * by hash instead of by one string comparison per keyword.
+ * Returns the index of the matching entry, or -1 if NAME is not in the
+ * table. */
+int
+lookup_keyword(struct keyword_t *kws, char *name, const size_t name_len)
+{
+	size_t i;
+	if (kws[0].hash == 0) {
+		for (i = 0; kws[i].name; i++)
+			kws[i].hash = hashme(kws[i].name, 1);
+	}
+
+	const char c = name[name_len];
+	name[name_len] = '\0';
+	const size_t h = hashme(name, 1);
+
+	int ret = -1;
+	for (i = 0; kws[i].name; i++) {
+		if (kws[i].hash == h && strcmp(kws[i].name, name) == 0) {
+			ret = (int)i;
+			break;
+		}
+	}
+
+	name[name_len] = c;
+	return ret;
+}
+
 /* Create a file for writing (truncating it to zero length if it already exists,
  * and with permissions 600).
  * Return a file stream associated to the file named NAME and update FD to hold
@@ -973,6 +1310,80 @@ get_cmd_path(const char *cmd)
 	return (char *)NULL;
 }
 
+/* Format SIZE as a human-readable number into BUF (of BUFSIZE bytes),
+ * storing the chosen unit character in UNIT and returning the number of
+ * bytes written. The unit is picked from a table of precomputed
+ * thresholds (no division loop), and the value is rounded exactly to at
+ * most two decimals (omitted when the size is an exact multiple of the
+ * unit), so that the expensive float path of snprintf(3) is never taken.
+ * This is the formatting kernel behind both construct_human_size() and
+ * the per-entry size rendering of the file list (listing.c). */
+size_t
+format_human_size(char *buf, const size_t bufsize, const off_t size,
+	char *unit)
+{
+	/* A 63-bit file size cannot go past exabytes, so seven thresholds
+	 * cover the whole off_t range (R and Q stay out of reach). */
+	static const char *const u = "BKMGTPEZYRQ";
+	static off_t thr[7];
+	static off_t thr_base = 0;
+
+	const off_t base = xargs.si == 1 ? 1000 : 1024;
+	if (thr_base != base) {
+		off_t t = base;
+		size_t i;
+		for (i = 0; i < 7; i++) {
+			thr[i] = t;
+			/* Zero marks units out of the off_t range. */
+			t = (t <= (off_t)(LLONG_MAX / base)) ? t * base : 0;
+		}
+		thr_base = base;
+	}
+
+	size_t n = 0;
+	while (n < 7 && thr[n] != 0 && size >= thr[n])
+		n++;
+
+	*unit = u[n];
+
+	if (n == 0) { /* Plain bytes */
+		if (size >= 0) {
+			const char *s = xitoa((long long)size);
+			size_t len = strlen(s);
+			if (len >= bufsize)
+				len = bufsize - 1;
+			memcpy(buf, s, len);
+			buf[len] = '\0';
+			return len;
+		}
+
+		const int ret = snprintf(buf, bufsize, "%jd", (intmax_t)size);
+		return ret > 0 ? (size_t)ret : 0;
+	}
+
+	const off_t d = thr[n - 1];
+	const off_t whole = size / d;
+	const off_t rem = size - (whole * d);
+
+	int ret;
+	if (rem == 0) {
+		ret = snprintf(buf, bufsize, "%jd", (intmax_t)whole);
+	} else {
+		/* Exact two-decimal rounding of REM / D: a long double mantissa
+		 * keeps the product exact across the realistic size range. */
+		int frac =
+			(int)(((long double)rem * 100.0L / (long double)d) + 0.5L);
+		off_t w = whole;
+		if (frac >= 100) {
+			w++;
+			frac = 0;
+		}
+		ret = snprintf(buf, bufsize, "%jd.%02d", (intmax_t)w, frac);
+	}
+
+	return ret > 0 ? (size_t)ret : 0;
+}
+
 /* Convert SIZE to human readable form (at most 2 decimal places).
  * Returns a pointer to a string of at most MAX_UNIT_SIZE.
  * We follow here the du(1) notation: K, M, G... for powers of 1024
@@ -982,31 +1393,12 @@ construct_human_size(const off_t size)
 {
 	static char str[MAX_HUMAN_SIZE + 2];
 
-	const float base = xargs.si == 1 ? 1000 : 1024;
-	static float mult_factor = 0;
-	if (mult_factor == 0)
-		mult_factor = 1.0f / base;
+	char unit;
+	const size_t len =
+		format_human_size(str, MAX_HUMAN_SIZE, size, &unit);
 
-	size_t n = 0;
-	float s = (float)size;
-
-	while (s >= base) {
-		s = s * mult_factor; /* == (s = s / base), but faster */
-		++n;
-	}
-
-	const int x = (int)s;
-	/* If (s == 0 || s - (float)x == 0), then S has no reminder (zero)
-	 * We don't want to print the reminder when it is zero.
-	 *
-	 * R: Ronnabyte, Q: Quettabyte. It's highly unlikely to have files of
-	 * such huge sizes (and even less) in the near future, but anyway... */
-	static const char *const u = "BKMGTPEZYRQ";
-	snprintf(str, sizeof(str), "%.*f %c%s",
-		(s == 0.00f || s - (float)x == 0.00f) ? 0 : 2,
-		(double)s,
-		u[n],
-		u[n] != 'B' ? (xargs.si == 1 ? "B" : "iB") : "");
+	snprintf(str + len, sizeof(str) - len, " %c%s", unit,
+		unit != 'B' ? (xargs.si == 1 ? "B" : "iB") : "");
 
 	return str;
 }
@@ -1043,12 +1435,34 @@ get_link_ref(const char *link)
 char *
 xitoa(long long n)
 {
+	/* All two-digit decimal values: two digits are emitted per division,
+	 * halving the divisions per number. */
+	static const char *const digit_pairs =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+
 	if (n == 0)
 		return "0";
 
 	static char buf[32] = {0};
 	long long i = 30;
 
+	while (n >= 100 && i > 1) {
+		const long long rem = n - ((n / 100) * 100);
+		n /= 100;
+		buf[i] = digit_pairs[rem * 2 + 1];
+		buf[i - 1] = digit_pairs[rem * 2];
+		i -= 2;
+	}
+
 	while (n > 0 && i > 0) {
 		long long rem = n / 10;
 		buf[i] = (char)('0' + (n - (rem * 10)));
@@ -26,6 +26,7 @@
 #define AUX_H
 
 #include <time.h>
+#include <sys/statvfs.h> /* xstatvfs() */
 #include "mem.h"
 
 #ifdef RL_READLINE_VERSION
@@ -34,10 +35,19 @@
 # endif /* RL_READLINE_VERSION >= 0x0801 */
 #endif /* RL_READLINE_VERSION */
 
+/* An entry in a config file keyword table (see lookup_keyword()). HASH
+ * is filled on the table's first use: initialize it to zero. */
+struct keyword_t {
+	const char *name;
+	size_t hash;
+};
+
 __BEGIN_DECLS
 
 char *abbreviate_file_name(char *str);
 char *construct_human_size(const off_t size);
+size_t format_human_size(char *buf, const size_t bufsize, const off_t size,
+	char *unit);
 filesn_t count_dir(const char *dir, const int pop);
 
 char from_hex(char c);
@@ -48,12 +58,15 @@ size_t hashme(const char *str, const int case_sensitive);
 #if defined(__sun) && defined(ST_BTIME)
 struct timespec get_birthtime(const char *filename);
 #endif /* __sun && ST_BTIME */
+char *get_buf_line(char **bufp, size_t *line_len);
 char *get_cmd_path(const char *cmd);
 int  get_rgb(char *hex, int *attr, int *r, int *g, int *b);
 void clear_term_img(void);
 mode_t get_dt(const mode_t mode);
 int  get_link_ref(const char *link);
 char *hex2rgb(char *hex);
+char *load_file_to_buf(const int fd);
+int  lookup_keyword(struct keyword_t *kws, char *name, const size_t name_len);
 char *normalize_path(char *src, const size_t src_len);
 FILE *open_fread(const char *name, int *fd);
 FILE *open_fwrite(const char *name, int *fd);
@@ -62,6 +75,8 @@ void press_any_key_to_continue(const int init_newline);
 int  read_octal(char *str);
 void rl_ring_bell(void);
 void set_fzf_preview_border_type(void);
+void stat_cache_free(void);
+void stat_cache_invalidate(void);
 int  should_expand_eln(const char *text);
 char *url_encode(char *str);
 char *url_decode(char *str);
@@ -69,6 +84,8 @@ filesn_t xatof(const char *s);
 int  xatoi(const char *s);
 char *xitoa(long long n);
 char xgetchar(void);
+int  xlstat_cached(const char *path, struct stat *attr);
+int  xstatvfs(const char *path, struct statvfs *buf);
 int  xmkdir(char *dir, const mode_t mode);
 ssize_t xreadlink(const int fd, char *restrict path, char *restrict buf,
 	const size_t bufsize);
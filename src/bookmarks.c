@@ -37,13 +37,116 @@
 #include "init.h" /* load_bookmarks() */
 #include "messages.h" /* STEALTH_DISABLED */
 #include "misc.h" /* err(), xerror() */
+#include "candidates.h" /* candidates_invalidate() */
 #include "listing.h" /* reload_dirlist() */
 #include "readline.h" /* rl_no_hist() */
 #include "spawn.h" /* launch_execv() */
 
+/* Hash indices over the bookmarks array, keyed by shortcut and by name,
+ * so that resolving a bookmark probes a single bucket instead of walking
+ * the whole array (scripted setups easily carry hundreds of bookmarks).
+ * BUCKETS maps a bucket to the 1-based position of its first entry in
+ * the bookmarks array (0 = empty), and NEXT chains entries sharing a
+ * bucket in array order. Lazily (re)built by bm_lookup(): any change to
+ * the bookmarks array goes through free_bookmarks(), which marks the
+ * indices dirty. */
+struct bm_index_t {
+	size_t *buckets;
+	size_t *next;
+	size_t size; /* Number of buckets (a power of two) */
+};
+
+static struct bm_index_t bm_sc_index;
+static struct bm_index_t bm_name_index;
+static int bm_index_dirty = 1;
+
+static void
+free_bm_index(struct bm_index_t *idx)
+{
+	free(idx->buckets);
+	free(idx->next);
+	idx->buckets = idx->next = (size_t *)NULL;
+	idx->size = 0;
+}
+
+static void
+build_bm_index(struct bm_index_t *idx, const int shortcut)
+{
+	idx->size = 1;
+	while (idx->size < bm_n * 2)
+		idx->size <<= 1;
+
+	idx->buckets = xcalloc(idx->size, sizeof(size_t));
+	idx->next = xcalloc(bm_n, sizeof(size_t));
+
+	/* Insert at the bucket head in reverse order, so that chains are
+	 * traversed in array order: on (invalid, hand-edited) duplicates the
+	 * first entry wins, just as with a linear scan. */
+	size_t i = bm_n;
+	while (i-- > 0) {
+		const char *key = shortcut == 1
+			? bookmarks[i].shortcut : bookmarks[i].name;
+		if (!key || !*key)
+			continue;
+
+		const size_t b = hashme(key, 1) & (idx->size - 1);
+		idx->next[i] = idx->buckets[b];
+		idx->buckets[b] = i + 1;
+	}
+}
+
+static int
+bm_index_lookup(const struct bm_index_t *idx, const char *key,
+	const int shortcut)
+{
+	if (!idx->buckets)
+		return (-1);
+
+	size_t e = idx->buckets[hashme(key, 1) & (idx->size - 1)];
+	while (e != 0) {
+		const size_t i = e - 1;
+		const char *k = shortcut == 1
+			? bookmarks[i].shortcut : bookmarks[i].name;
+		if (k && *key == *k && strcmp(key, k) == 0)
+			return (int)i;
+		e = idx->next[i];
+	}
+
+	return (-1);
+}
+
+/* Return the index in the bookmarks array of the bookmark whose shortcut
+ * or name is KEY, or -1 if there is no such bookmark. As with the linear
+ * scan this replaces, the entry with the lowest index wins when KEY is
+ * the shortcut of one bookmark and the name of another. */
+static int
+bm_lookup(const char *key)
+{
+	if (bm_n == 0 || !bookmarks || !key)
+		return (-1);
+
+	if (bm_index_dirty == 1) {
+		free_bm_index(&bm_sc_index);
+		free_bm_index(&bm_name_index);
+		build_bm_index(&bm_sc_index, 1);
+		build_bm_index(&bm_name_index, 0);
+		bm_index_dirty = 0;
+	}
+
+	const int sc = bm_index_lookup(&bm_sc_index, key, 1);
+	const int name = bm_index_lookup(&bm_name_index, key, 0);
+
+	if (sc == -1 || (name != -1 && name < sc))
+		return name;
+	return sc;
+}
+
 void
 free_bookmarks(void)
 {
+	bm_index_dirty = 1;
+	candidates_invalidate(CAND_BOOKMARKS);
+
 	if (bm_n == 0)
 		return;
 
@@ -260,18 +363,13 @@ get_bm_path(char *arg)
 	char *name = remove_quotes(arg);
 
 	/* If string, check shortcuts and names */
-	size_t i;
-	for (i = 0; i < bm_n; i++) {
-		if ((bookmarks[i].shortcut && *name == *bookmarks[i].shortcut
-		&& strcmp(name, bookmarks[i].shortcut) == 0)
-		|| (bookmarks[i].name && *name == *bookmarks[i].name
-		&& strcmp(name, bookmarks[i].name) == 0)) {
-			if (bookmarks[i].path)
-				return bookmarks[i].path;
-
-			xerror(_("'%s': Invalid bookmark\n"), name);
-			return (char *)NULL;
-		}
+	const int i = bm_lookup(name);
+	if (i != -1) {
+		if (bookmarks[i].path)
+			return bookmarks[i].path;
+
+		xerror(_("'%s': Invalid bookmark\n"), name);
+		return (char *)NULL;
 	}
 
 	xerror(_("'%s': No such bookmark\n"), name);
@@ -358,15 +456,8 @@ bm_open(char **cmd)
 	if (!p)
 		p = cmd[1];
 
-	size_t i;
-	for (i = 0; i < bm_n; i++) {
-		if (!(bookmarks[i].shortcut && *p == *bookmarks[i].shortcut
-		&& strcmp(p, bookmarks[i].shortcut) == 0)
-
-		&& !(bookmarks[i].name && *p == *bookmarks[i].name
-		&& strcmp(p, bookmarks[i].name) == 0))
-			continue;
-
+	const int i = bm_lookup(p);
+	if (i != -1) {
 		if (!bookmarks[i].path) {
 			xerror(_("'%s': Invalid bookmark\n"), p);
 			goto END;
@@ -32,6 +32,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <fcntl.h>
+#include <pthread.h> /* parallel apply stage (see apply_renames_parallel()) */
+#include <time.h> /* nanosleep(2) (progress report) */
 #include <unistd.h>
 #include <sys/stat.h>
 #include <errno.h>
@@ -250,43 +252,276 @@ check_line_mismatch(FILE *fp, const size_t total)
 	return FUNC_SUCCESS;
 }
 
+/* Apply stage
+ *
+ * Renames used to be applied one rename(2) at a time while reading the
+ * edited temporary file back. The file is now parsed into an array of
+ * (old name, new name) pairs first, which allows checking up front
+ * whether any new name is also some other pair's old name (a chain,
+ * swap, or cycle, whose outcome depends on the order renames are
+ * applied in). If there is no such ordering conflict -- the common
+ * case -- the renames are independent of each other and are applied by
+ * a pool of worker threads, a big win for large batches on high-latency
+ * file systems (CIFS, NFS). Conflicting batches take the sequential
+ * path, in file order, just as before. */
+
+#define BULK_PAR_MIN_PAIRS 64 /* Only parallelize batches this big */
+#define BULK_MAX_THREADS   16
+#define BULK_PROGRESS_NSEC 100000000 /* Progress report interval (100ms) */
+
+struct bulk_pair_t {
+	char *old_name;
+	char *new_name;
+	int status; /* -1: pending; 0: renamed; >0: errno */
+	int pad;
+};
+
+struct bulk_worker_t {
+	struct bulk_pair_t *pairs;
+	size_t n;
+	size_t id;
+	size_t nthreads;
+	volatile size_t done; /* Renames applied so far (progress report) */
+	volatile int finished;
+	int pad;
+};
+
 static int
-rename_bulk_files(char **args, FILE *fp, int *is_cwd, size_t *renamed,
-	const size_t modified)
+bulk_get_threads(void)
 {
-	size_t i = 1;
-	int exit_status = FUNC_SUCCESS;
+#ifdef _SC_NPROCESSORS_ONLN
+	const long p = sysconf(_SC_NPROCESSORS_ONLN);
+	if (p <= 1)
+		return 1;
+	return p > BULK_MAX_THREADS ? BULK_MAX_THREADS : (int)p;
+#else
+	return 1;
+#endif /* _SC_NPROCESSORS_ONLN */
+}
+
+/* Parse the edited temporary file FP into an array of rename pairs
+ * (lines are paired with ARGS entries by position, exactly as the
+ * sequential loop used to do), skipping unmodified names. Returns the
+ * number of pairs stored in *PAIRS. */
+static size_t
+parse_bulk_pairs(char **args, FILE *fp, struct bulk_pair_t **pairs)
+{
+	size_t i = 1, n = 0;
 	char line[PATH_MAX + 1]; *line = '\0';
 
+	*pairs = xnmalloc(args_n + 1, sizeof(struct bulk_pair_t));
+
 	while (fgets(line, (int)sizeof(line), fp)) {
 		if (!*line || *line == '\n' || IS_BR_COMMENT(line))
 			continue;
 
-		if (!args[i])
-			goto CONT;
+		if (!args[i]) {
+			i++;
+			continue;
+		}
 
-		const size_t len = strlen(line);
-		if (line[len - 1] == '\n')
+		size_t len = strlen(line);
+		if (len > 0 && line[len - 1] == '\n') {
 			line[len - 1] = '\0';
+			len--;
+		}
 
-		if (strcmp(args[i], line) == 0)
-			goto CONT;
+		/* Some renameat(2) implementations (DragonFly) do not like the
+		 * new name to end with a slash (in case of renaming dirs). */
+		if (len > 1 && line[len - 1] == '/') {
+			line[len - 1] = '\0';
+			len--;
+		}
 
-		const int ret = rename_file(args[i], line);
-		if (ret != 0) {
-			exit_status = ret;
-			goto CONT;
+		if (strcmp(args[i], line) != 0) {
+			(*pairs)[n].old_name = args[i];
+			(*pairs)[n].new_name = savestring(line, len);
+			(*pairs)[n].status = -1;
+			n++;
 		}
 
-		if (*is_cwd == 0 && (is_file_in_cwd(args[i])
-		|| is_file_in_cwd(line)))
-			*is_cwd = 1;
+		i++;
+	}
 
-		(*renamed)++;
+	return n;
+}
 
-CONT:
-		i++;
+static int
+hash_qsort_cmp(const void *a, const void *b)
+{
+	const size_t ha = *(const size_t *)a;
+	const size_t hb = *(const size_t *)b;
+
+	return ha > hb ? 1 : (ha < hb ? -1 : 0);
+}
+
+/* Return 1 if the outcome of the batch depends on the order renames are
+ * applied in: some new name is also some other pair's old name (chains,
+ * swaps, cycles), or two pairs share the same new name. Comparisons are
+ * done on name hashes: a collision at worst reports a false conflict,
+ * falling back to the sequential path. */
+static int
+bulk_order_conflicts(const struct bulk_pair_t *pairs, const size_t n)
+{
+	size_t i;
+	int conflicts = 0;
+	size_t *hashes = xnmalloc(n * 2, sizeof(size_t));
+
+	for (i = 0; i < n; i++)
+		hashes[i] = hashme(pairs[i].old_name, 1);
+	qsort(hashes, n, sizeof(size_t), hash_qsort_cmp);
+
+	size_t *new_hashes = hashes + n;
+	for (i = 0; i < n; i++) {
+		new_hashes[i] = hashme(pairs[i].new_name, 1);
+		if (bsearch(&new_hashes[i], hashes, n, sizeof(size_t),
+		hash_qsort_cmp)) {
+			conflicts = 1;
+			goto END;
+		}
+	}
+
+	qsort(new_hashes, n, sizeof(size_t), hash_qsort_cmp);
+	for (i = 1; i < n; i++) {
+		if (new_hashes[i] == new_hashes[i - 1]) {
+			conflicts = 1;
+			break;
+		}
+	}
+
+END:
+	free(hashes);
+	return conflicts;
+}
+
+/* Apply the pending renames at indices ID, ID + NTHREADS, ... of the
+ * pairs array. Errors are only recorded here (STATUS): the main thread
+ * reports them once all workers are done. */
+static void *
+bulk_rename_worker(void *arg)
+{
+	struct bulk_worker_t *w = (struct bulk_worker_t *)arg;
+
+	for (size_t i = w->id; i < w->n; i += w->nthreads) {
+		struct bulk_pair_t *p = &w->pairs[i];
+		p->status = renameat(XAT_FDCWD, p->old_name, XAT_FDCWD,
+			p->new_name) == 0 ? 0 : errno;
+		w->done++;
+	}
+
+	w->finished = 1;
+	return NULL;
+}
+
+/* Apply the renames in PAIRS via a pool of worker threads, reporting
+ * progress while they run. Pairs the workers could not handle (thread
+ * creation failure, cross-device renames) are retried sequentially
+ * afterwards via rename_file(). Returns zero on success, or the error
+ * code of the last failed rename. */
+static int
+apply_renames_parallel(struct bulk_pair_t *pairs, const size_t n)
+{
+	const int nthreads = bulk_get_threads();
+	pthread_t threads[BULK_MAX_THREADS];
+	struct bulk_worker_t workers[BULK_MAX_THREADS];
+	int started = 0;
+
+	for (int t = 0; t < nthreads; t++) {
+		workers[t] = (struct bulk_worker_t){ .pairs = pairs, .n = n,
+			.id = (size_t)t, .nthreads = (size_t)nthreads };
+		if (pthread_create(&threads[t], NULL, bulk_rename_worker,
+		&workers[t]) != 0)
+			break;
+		started++;
+	}
+
+	while (started > 0) {
+		int running = 0;
+		size_t done = 0;
+
+		for (int t = 0; t < started; t++) {
+			running += (workers[t].finished == 0);
+			done += workers[t].done;
+		}
+
+		printf(_("\rbr: Renaming files... %zu/%zu"), done, n);
+		fflush(stdout);
+
+		if (running == 0)
+			break;
+
+		struct timespec ts = {0, BULK_PROGRESS_NSEC};
+		nanosleep(&ts, NULL);
+	}
+
+	for (int t = 0; t < started; t++)
+		pthread_join(threads[t], NULL);
+
+	if (started > 0) {
+		putchar('\r');
+		ERASE_TO_RIGHT;
+	}
+
+	int exit_status = FUNC_SUCCESS;
+
+	for (size_t i = 0; i < n; i++) {
+		struct bulk_pair_t *p = &pairs[i];
+
+		if (p->status == -1 || p->status == EXDEV) {
+			/* Not attempted (no worker), or needs mv(1): rename_file()
+			 * handles (and reports) both. */
+			p->status = rename_file(p->old_name, p->new_name);
+		} else if (p->status > 0) {
+			xerror(_("br: Cannot rename '%s' to '%s': %s\n"),
+				p->old_name, p->new_name, strerror(p->status));
+		}
+
+		if (p->status != 0)
+			exit_status = p->status;
+	}
+
+	return exit_status;
+}
+
+static int
+apply_renames_seq(struct bulk_pair_t *pairs, const size_t n)
+{
+	int exit_status = FUNC_SUCCESS;
+
+	for (size_t i = 0; i < n; i++) {
+		pairs[i].status = rename_file(pairs[i].old_name, pairs[i].new_name);
+		if (pairs[i].status != 0)
+			exit_status = pairs[i].status;
+	}
+
+	return exit_status;
+}
+
+static int
+rename_bulk_files(char **args, FILE *fp, int *is_cwd, size_t *renamed,
+	const size_t modified)
+{
+	struct bulk_pair_t *pairs = (struct bulk_pair_t *)NULL;
+	const size_t n = parse_bulk_pairs(args, fp, &pairs);
+
+	int exit_status = FUNC_SUCCESS;
+
+	if (n >= BULK_PAR_MIN_PAIRS && bulk_get_threads() > 1
+	&& bulk_order_conflicts(pairs, n) == 0)
+		exit_status = apply_renames_parallel(pairs, n);
+	else
+		exit_status = apply_renames_seq(pairs, n);
+
+	for (size_t i = 0; i < n; i++) {
+		if (pairs[i].status == 0) {
+			(*renamed)++;
+			if (*is_cwd == 0 && (is_file_in_cwd(pairs[i].old_name)
+			|| is_file_in_cwd(pairs[i].new_name)))
+				*is_cwd = 1;
+		}
+		free(pairs[i].new_name);
 	}
+	free(pairs);
 
 	if (conf.autols == 1 && exit_status != 0 && modified > 1)
 		press_any_key_to_continue(0);
@@ -0,0 +1,224 @@
+/* candidates.c -- unified completion/suggestion candidate provider */
+
+/*
+ * This file is part of CliFM
+ *
+ * Copyright (C) 2016-2024, L. Abramovich <leo.clifm@outlook.com>
+ * All rights reserved.
+
+ * CliFM is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * CliFM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+*/
+
+/* Both the suggestions system (suggestions.c) and TAB completion
+ * (tabcomp.c/readline.c) enumerate the same candidate names: bookmarks,
+ * color schemes, profiles, prompts, remotes, and tags. Each consumer used
+ * to walk the source arrays on its own, duplicating the enumeration logic
+ * and rebuilding the same set twice per keystroke/TAB. This module serves
+ * both from a single, generation-stamped cache per domain: the flattened
+ * name vector is built once and reused until the underlying source
+ * changes (loaders call candidates_invalidate(); as a safety net, the
+ * source array pointer and count are also compared on every lookup). */
+
+#include "helpers.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "aux.h"
+#include "candidates.h"
+
+struct cand_set_t {
+	char **names;     /* Flattened, NULL-terminated name vector (copies) */
+	size_t n;         /* Number of names in the vector */
+	size_t gen;       /* Bumped by candidates_invalidate() */
+	size_t built_gen; /* Generation the cache was last built at */
+	void *src;        /* Source array address at build time */
+	size_t src_n;     /* Source entry count at build time */
+};
+
+static struct cand_set_t cand_sets[CAND_DOMAINS_N];
+
+/* Return the source array address and entry count for DOMAIN, so that a
+ * reallocated/reloaded source is detected even without an explicit
+ * invalidation. */
+static void
+get_source_sig(const int domain, void **src, size_t *src_n)
+{
+	switch (domain) {
+	case CAND_BOOKMARKS: *src = bookmarks; *src_n = bm_n; break;
+	case CAND_CSCHEMES: *src = color_schemes; *src_n = cschemes_n; break;
+#ifndef _NO_PROFILES
+	case CAND_PROFILES: *src = profile_names; *src_n = 0; break;
+#endif /* !_NO_PROFILES */
+	case CAND_PROMPTS: *src = prompts; *src_n = prompts_n; break;
+	case CAND_REMOTES: *src = remotes; *src_n = 0; break;
+#ifndef _NO_TAGS
+	case CAND_TAGS: *src = tags; *src_n = tags_n; break;
+#endif /* !_NO_TAGS */
+	default: *src = NULL; *src_n = 0; break;
+	}
+}
+
+static void
+free_cand_names(struct cand_set_t *s)
+{
+	size_t i;
+	for (i = 0; i < s->n; i++)
+		free(s->names[i]);
+	free(s->names);
+	s->names = (char **)NULL;
+	s->n = 0;
+}
+
+/* Append NAME to the candidate set S (capacity managed by the caller's
+ * count: the vector is built in one go, so we just grow linearly). */
+static void
+add_cand_name(struct cand_set_t *s, size_t *cap, const char *name)
+{
+	if (!name || !*name)
+		return;
+
+	if (s->n + 2 > *cap) {
+		*cap = *cap == 0 ? 16 : *cap * 2;
+		s->names = xnrealloc(s->names, *cap, sizeof(char *));
+	}
+
+	s->names[s->n] = savestring(name, strlen(name));
+	s->n++;
+	s->names[s->n] = (char *)NULL;
+}
+
+/* Flatten the source array of DOMAIN into the candidate set S. */
+static void
+build_cand_set(const int domain, struct cand_set_t *s)
+{
+	size_t cap = 0, i;
+
+	switch (domain) {
+	case CAND_BOOKMARKS:
+		for (i = 0; bookmarks && i < bm_n; i++)
+			add_cand_name(s, &cap, bookmarks[i].name);
+		break;
+
+	case CAND_CSCHEMES:
+		for (i = 0; color_schemes && color_schemes[i]; i++)
+			add_cand_name(s, &cap, color_schemes[i]);
+		break;
+
+#ifndef _NO_PROFILES
+	case CAND_PROFILES:
+		for (i = 0; profile_names && profile_names[i]; i++)
+			add_cand_name(s, &cap, profile_names[i]);
+		break;
+#endif /* !_NO_PROFILES */
+
+	case CAND_PROMPTS:
+		for (i = 0; prompts && i < prompts_n; i++)
+			add_cand_name(s, &cap, prompts[i].name);
+		break;
+
+	case CAND_REMOTES:
+		for (i = 0; remotes && remotes[i].name; i++)
+			add_cand_name(s, &cap, remotes[i].name);
+		break;
+
+#ifndef _NO_TAGS
+	case CAND_TAGS:
+		for (i = 0; tags && tags[i]; i++)
+			add_cand_name(s, &cap, tags[i]);
+		break;
+#endif /* !_NO_TAGS */
+
+	default: break;
+	}
+}
+
+/* Return the cached candidate vector for DOMAIN (NULL-terminated),
+ * rebuilding it first if the domain was invalidated or the source array
+ * changed. N, if not NULL, is set to the number of candidates. The
+ * returned vector is owned by the provider: consumers must copy whatever
+ * they need to keep. */
+char **
+candidates_get(const int domain, size_t *n)
+{
+	if (domain < 0 || domain >= CAND_DOMAINS_N)
+		return (char **)NULL;
+
+	struct cand_set_t *s = &cand_sets[domain];
+
+	void *src = NULL;
+	size_t src_n = 0;
+	get_source_sig(domain, &src, &src_n);
+
+	if (!s->names || s->built_gen != s->gen || s->src != src
+	|| s->src_n != src_n) {
+		free_cand_names(s);
+		build_cand_set(domain, s);
+		s->built_gen = s->gen;
+		s->src = src;
+		s->src_n = src_n;
+	}
+
+	if (n)
+		*n = s->n;
+	return s->names;
+}
+
+/* Return the next candidate in DOMAIN whose first LEN bytes match WORD
+ * (case insensitively if CASE_SENS is zero), or NULL if there is none
+ * (left). STATE keeps the scan position across calls: initialize it to
+ * zero to start a new scan. If LEN is zero every candidate matches. */
+char *
+candidates_next(const int domain, const char *word, const size_t len,
+	const int case_sens, size_t *state)
+{
+	size_t n = 0;
+	char **v = candidates_get(domain, &n);
+	if (!v || !word)
+		return (char *)NULL;
+
+	while (*state < n) {
+		char *name = v[(*state)++];
+		if (len == 0)
+			return name;
+
+		if (case_sens == 1
+		? (*name == *word && strncmp(name, word, len) == 0)
+		: (TOUPPER(*name) == TOUPPER(*word)
+		&& strncasecmp(name, word, len) == 0))
+			return name;
+	}
+
+	return (char *)NULL;
+}
+
+/* Mark the candidate set of DOMAIN as stale (rebuilt on next lookup).
+ * Called by the loaders/reloaders of the underlying sources. */
+void
+candidates_invalidate(const int domain)
+{
+	if (domain >= 0 && domain < CAND_DOMAINS_N)
+		cand_sets[domain].gen++;
+}
+
+/* Release all cached candidate sets (at exit). */
+void
+candidates_free(void)
+{
+	size_t i;
+	for (i = 0; i < CAND_DOMAINS_N; i++)
+		free_cand_names(&cand_sets[i]);
+}
@@ -0,0 +1,47 @@
+/* candidates.h */
+
+/*
+ * This file is part of CliFM
+ *
+ * Copyright (C) 2016-2024, L. Abramovich <leo.clifm@outlook.com>
+ * All rights reserved.
+
+ * CliFM is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * CliFM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+*/
+
+#ifndef CANDIDATES_H
+#define CANDIDATES_H
+
+/* Candidate domains served by the provider */
+#define CAND_BOOKMARKS 0
+#define CAND_CSCHEMES  1
+#define CAND_PROFILES  2
+#define CAND_PROMPTS   3
+#define CAND_REMOTES   4
+#define CAND_TAGS      5
+#define CAND_DOMAINS_N 6
+
+__BEGIN_DECLS
+
+char **candidates_get(const int domain, size_t *n);
+char *candidates_next(const int domain, const char *word, const size_t len,
+	const int case_sens, size_t *state);
+void candidates_invalidate(const int domain);
+void candidates_free(void);
+
+__END_DECLS
+
+#endif /* CANDIDATES_H */
@@ -26,6 +26,7 @@
 
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h> /* qsort(3) */
 #include <string.h>
 #include <unistd.h>
 
@@ -36,6 +37,7 @@
 #endif /* HAVE_FILE_ATTRS */
 
 #include "aux.h"
+#include "init.h" /* alias_lookup() */
 #include "misc.h"
 #include "term_info.h"
 
@@ -504,26 +506,67 @@ contains_digit(const char *str)
 	return (-1);
 }
 
-/* Return 1 if CMD is found in CMDS_LIST or zero otherwise. */
 static int
-find_cmd(const struct cmdslist_t *cmds_list, const size_t list_size, char *cmd)
+cmp_cmds_ptr(const void *a, const void *b)
 {
-	int found = 0, i = (int)list_size;
-	int c = -1, d = contains_digit(cmd);
+	return strcmp((*(const struct cmdslist_t * const *)a)->name,
+		(*(const struct cmdslist_t * const *)b)->name);
+}
+
+/* Return an array of pointers to the N entries of CMDS_LIST, sorted by
+ * command name, for use by cmds_bsearch(). The command lists are static,
+ * so each caller builds its sorted view only once. */
+static const struct cmdslist_t **
+sort_cmds_list(const struct cmdslist_t *cmds_list, const size_t n)
+{
+	const struct cmdslist_t **sorted = xnmalloc(n, sizeof(*sorted));
+
+	size_t i;
+	for (i = 0; i < n; i++)
+		sorted[i] = &cmds_list[i];
+
+	qsort(sorted, n, sizeof(*sorted), cmp_cmds_ptr);
+	return sorted;
+}
+
+/* Return 1 if CMD is found in the name-sorted command list SORTED
+ * (of LIST_SIZE entries), or zero otherwise. */
+static int
+cmds_bsearch(const struct cmdslist_t **sorted, const size_t list_size,
+	const char *cmd)
+{
+	size_t lo = 0, hi = list_size;
+
+	while (lo < hi) {
+		const size_t mid = lo + ((hi - lo) >> 1);
+		const int cmp = strcmp(cmd, sorted[mid]->name);
+
+		if (cmp == 0)
+			return 1;
+		if (cmp < 0)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return 0;
+}
+
+/* Return 1 if CMD is found in the name-sorted command list SORTED or
+ * zero otherwise. Fused parameters (e.g. "o12") are stripped before
+ * the search. */
+static int
+find_cmd(const struct cmdslist_t **sorted, const size_t list_size, char *cmd)
+{
+	int c = -1;
+	const int d = contains_digit(cmd);
 
 	if (d != -1) {
 		c = cmd[d];
 		cmd[d] = '\0';
 	}
 
-	const size_t cmd_len = strlen(cmd);
-	while (--i >= 0) {
-		if (*cmd == *cmds_list[i].name && cmd_len == cmds_list[i].len
-		&& strcmp(cmd, cmds_list[i].name) == 0) {
-			found = 1;
-			break;
-		}
-	}
+	const int found = cmds_bsearch(sorted, list_size, cmd);
 
 	if (d != -1)
 		cmd[d] = (char)c;
@@ -552,7 +595,16 @@ is_action_name(const char *s)
 int
 is_internal_c(char *restrict cmd)
 {
-	if (find_cmd(internal_cmds, internal_cmds_n, cmd))
+	static const struct cmdslist_t **sorted = NULL;
+	static size_t n = 0;
+
+	if (!sorted) {
+		while (internal_cmds[n].name)
+			n++;
+		sorted = sort_cmds_list(internal_cmds, n);
+	}
+
+	if (find_cmd(sorted, n, cmd))
 		return 1;
 
 	/* Check for the search and history functions as well */
@@ -617,14 +669,18 @@ is_internal(char *restrict cmd)
 		{"te", 2},
 		{"v", 1},
 		{"vv", 2},
+		{"vf", 2},
+		{"verify", 6},
 		{NULL, 0}
 	};
 
-	static size_t i = 0;
-	if (i == 0)
-		i = (sizeof(int_cmds) / sizeof(struct cmdslist_t)) - 1;
+	static const struct cmdslist_t **sorted = NULL;
+	static const size_t n = (sizeof(int_cmds) / sizeof(struct cmdslist_t)) - 1;
+
+	if (!sorted)
+		sorted = sort_cmds_list(int_cmds, n);
 
-	if (find_cmd(int_cmds, i, cmd))
+	if (find_cmd(sorted, n, cmd))
 		return 1;
 
 	/* Check for the search function as well */
@@ -705,26 +761,21 @@ is_internal_f(const char *restrict cmd)
 		{"tl", 2},
 		{"v", 1},
 		{"vv", 2},
+		{"vf", 2},
+		{"verify", 6},
 		{"ws", 2},
 		{"x", 1},
 		{"X", 1},
 		{NULL, 0}
 	};
 
-	static int n = 0;
-	if (n == 0)
-		n = (int)(sizeof(int_cmds) / sizeof(struct cmdslist_t)) - 1;
-	const size_t cmd_len = strlen(cmd);
+	static const struct cmdslist_t **sorted = NULL;
+	static const size_t n = (sizeof(int_cmds) / sizeof(struct cmdslist_t)) - 1;
 
-	int i = n;
-	while (--i >= 0) {
-		if (*cmd == *int_cmds[i].name && cmd_len == int_cmds[i].len
-		&& strcmp(cmd, int_cmds[i].name) == 0) {
-			return 1;
-		}
-	}
+	if (!sorted)
+		sorted = sort_cmds_list(int_cmds, n);
 
-	return 0;
+	return cmds_bsearch(sorted, n, cmd);
 }
 
 /* Return one if STR is a command in PATH or zero if not. */
@@ -805,45 +856,35 @@ check_for_alias(char **args)
 			return (char **)NULL;
 	}
 
-	int i = (int)aliases_n;
-
-	while (--i >= 0) {
-		if (!aliases[i].name || !aliases[i].cmd || !*aliases[i].name
-		|| !*aliases[i].cmd)
-			continue;
-
-		if (*aliases[i].name != *args[0]
-		|| strcmp(args[0], aliases[i].name) != 0)
-			continue;
+	const int i = alias_lookup(args[0]);
+	if (i == -1 || !aliases[i].cmd || !*aliases[i].cmd)
+		return (char **)NULL;
 
-		args_n = 0; /* Reset args_n to be used by parse_input_str() */
+	args_n = 0; /* Reset args_n to be used by parse_input_str() */
 
-		char **alias_comm = parse_input_str(aliases[i].cmd);
-		if (!alias_comm) {
-			flags |= FAILED_ALIAS; /* Prevent exec_cmd() from being executed */
-			return (char **)NULL;
-		}
+	char **alias_comm = parse_input_str(aliases[i].cmd);
+	if (!alias_comm) {
+		flags |= FAILED_ALIAS; /* Prevent exec_cmd() from being executed */
+		return (char **)NULL;
+	}
 
-		size_t j;
-		/* Add input parameters, if any, to alias_comm */
-		if (args[1]) {
-			for (j = 1; args[j]; j++) {
-				alias_comm = xnrealloc(alias_comm,
-				    ++args_n + 2, sizeof(char *));
-				alias_comm[args_n] = savestring(args[j], strlen(args[j]));
-			}
+	size_t j;
+	/* Add input parameters, if any, to alias_comm */
+	if (args[1]) {
+		for (j = 1; args[j]; j++) {
+			alias_comm = xnrealloc(alias_comm,
+			    ++args_n + 2, sizeof(char *));
+			alias_comm[args_n] = savestring(args[j], strlen(args[j]));
 		}
-
-		alias_comm[args_n + 1] = (char *)NULL;
-
-		/* Free original command */
-		for (j = 0; args[j]; j++)
-			free(args[j]);
-		free(args);
-		return alias_comm;
 	}
 
-	return (char **)NULL;
+	alias_comm[args_n + 1] = (char *)NULL;
+
+	/* Free original command */
+	for (j = 0; args[j]; j++)
+		free(args[j]);
+	free(args);
+	return alias_comm;
 }
 
 /* Keep only the last MAX records in FILE.
@@ -0,0 +1,517 @@
+/* checksum.c -- the verify command (file integrity checks) */
+
+/*
+ * This file is part of CliFM
+ *
+ * Copyright (C) 2016-2024, L. Abramovich <leo.clifm@outlook.com>
+ * All rights reserved.
+
+ * CliFM is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * CliFM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+*/
+
+#include "helpers.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "aux.h" /* construct_human_size() */
+#include "checksum.h"
+#include "messages.h" /* VERIFY_USAGE */
+#include "misc.h" /* xerror() */
+#include "strings.h" /* unescape_str() */
+
+/* Number of hashing threads and size of the read buffer each of them
+ * reuses across files. */
+#define VERIFY_THREADS  4
+#define VERIFY_BUF_SIZE (256 * 1024)
+
+#define SHA256_DIGEST_LEN 32
+
+/* SHA-256, as specified by FIPS 180-4. A portable implementation is kept
+ * in-tree instead of linking a crypto library: hashing here is bound by
+ * disk reads, not by the compression function. */
+struct sha256_t {
+	uint32_t state[8];
+	uint64_t len;
+	unsigned char buf[64];
+	size_t buflen;
+};
+
+static const uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define SHA256_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void
+sha256_init(struct sha256_t *ctx)
+{
+	ctx->state[0] = 0x6a09e667; ctx->state[1] = 0xbb67ae85;
+	ctx->state[2] = 0x3c6ef372; ctx->state[3] = 0xa54ff53a;
+	ctx->state[4] = 0x510e527f; ctx->state[5] = 0x9b05688c;
+	ctx->state[6] = 0x1f83d9ab; ctx->state[7] = 0x5be0cd19;
+	ctx->len = 0;
+	ctx->buflen = 0;
+}
+
+static void
+sha256_block(struct sha256_t *ctx, const unsigned char *p)
+{
+	uint32_t w[64];
+	uint32_t a, b, c, d, e, f, g, h;
+	size_t i;
+
+	for (i = 0; i < 16; i++) {
+		w[i] = ((uint32_t)p[i * 4] << 24) | ((uint32_t)p[i * 4 + 1] << 16)
+			| ((uint32_t)p[i * 4 + 2] << 8) | (uint32_t)p[i * 4 + 3];
+	}
+
+	for (i = 16; i < 64; i++) {
+		const uint32_t s0 = SHA256_ROTR(w[i - 15], 7)
+			^ SHA256_ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+		const uint32_t s1 = SHA256_ROTR(w[i - 2], 17)
+			^ SHA256_ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+		w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+	}
+
+	a = ctx->state[0]; b = ctx->state[1]; c = ctx->state[2];
+	d = ctx->state[3]; e = ctx->state[4]; f = ctx->state[5];
+	g = ctx->state[6]; h = ctx->state[7];
+
+	for (i = 0; i < 64; i++) {
+		const uint32_t s1 = SHA256_ROTR(e, 6) ^ SHA256_ROTR(e, 11)
+			^ SHA256_ROTR(e, 25);
+		const uint32_t ch = (e & f) ^ (~e & g);
+		const uint32_t t1 = h + s1 + ch + sha256_k[i] + w[i];
+		const uint32_t s0 = SHA256_ROTR(a, 2) ^ SHA256_ROTR(a, 13)
+			^ SHA256_ROTR(a, 22);
+		const uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+		const uint32_t t2 = s0 + maj;
+
+		h = g; g = f; f = e; e = d + t1;
+		d = c; c = b; b = a; a = t1 + t2;
+	}
+
+	ctx->state[0] += a; ctx->state[1] += b; ctx->state[2] += c;
+	ctx->state[3] += d; ctx->state[4] += e; ctx->state[5] += f;
+	ctx->state[6] += g; ctx->state[7] += h;
+}
+
+static void
+sha256_update(struct sha256_t *ctx, const unsigned char *data, size_t len)
+{
+	ctx->len += len;
+
+	if (ctx->buflen > 0) {
+		const size_t need = 64 - ctx->buflen;
+		const size_t take = len < need ? len : need;
+		memcpy(ctx->buf + ctx->buflen, data, take);
+		ctx->buflen += take;
+		data += take;
+		len -= take;
+
+		if (ctx->buflen < 64)
+			return;
+
+		sha256_block(ctx, ctx->buf);
+		ctx->buflen = 0;
+	}
+
+	while (len >= 64) {
+		sha256_block(ctx, data);
+		data += 64;
+		len -= 64;
+	}
+
+	if (len > 0) {
+		memcpy(ctx->buf, data, len);
+		ctx->buflen = len;
+	}
+}
+
+static void
+sha256_final(struct sha256_t *ctx, unsigned char *digest)
+{
+	const uint64_t bits = ctx->len * 8;
+	static const unsigned char pad[64] = {0x80};
+	const size_t padlen = (ctx->buflen < 56)
+		? 56 - ctx->buflen : 120 - ctx->buflen;
+
+	sha256_update(ctx, pad, padlen);
+
+	unsigned char lenbuf[8];
+	size_t i;
+	for (i = 0; i < 8; i++)
+		lenbuf[i] = (unsigned char)(bits >> (56 - i * 8));
+	sha256_update(ctx, lenbuf, 8);
+
+	for (i = 0; i < 8; i++) {
+		digest[i * 4] = (unsigned char)(ctx->state[i] >> 24);
+		digest[i * 4 + 1] = (unsigned char)(ctx->state[i] >> 16);
+		digest[i * 4 + 2] = (unsigned char)(ctx->state[i] >> 8);
+		digest[i * 4 + 3] = (unsigned char)(ctx->state[i]);
+	}
+}
+
+/* Hash the file FILE into DIGEST using the caller-provided read buffer
+ * BUF (of VERIFY_BUF_SIZE bytes), adding the amount of hashed data to
+ * BYTES. Returns 0 on success or the appropriate errno in case of error. */
+static int
+hash_file(const char *file, unsigned char *digest, unsigned char *buf,
+	off_t *bytes)
+{
+	const int fd = open(file, O_RDONLY | O_CLOEXEC);
+	if (fd == -1)
+		return errno;
+
+	struct sha256_t ctx;
+	sha256_init(&ctx);
+
+	ssize_t n;
+	while ((n = read(fd, buf, VERIFY_BUF_SIZE)) > 0) {
+		sha256_update(&ctx, buf, (size_t)n);
+		*bytes += (off_t)n;
+	}
+
+	const int ret = n == -1 ? errno : 0;
+	close(fd);
+
+	if (ret != 0)
+		return ret;
+
+	sha256_final(&ctx, digest);
+	return 0;
+}
+
+/* A single verification job: hash SRC, and, in compare mode, also DST. */
+struct verify_job_t {
+	char *src;
+	char *dst;
+	off_t bytes;
+	int src_err; /* errno, or 0 */
+	int dst_err;
+	unsigned char src_hash[SHA256_DIGEST_LEN];
+	unsigned char dst_hash[SHA256_DIGEST_LEN];
+};
+
+struct verify_pool_t {
+	struct verify_job_t *jobs;
+	size_t jobs_n;
+	size_t next; /* Index of the next unclaimed job (under LOCK) */
+	pthread_mutex_t lock;
+};
+
+static void *
+verify_worker(void *arg)
+{
+	struct verify_pool_t *pool = (struct verify_pool_t *)arg;
+	unsigned char *buf = xnmalloc(VERIFY_BUF_SIZE, sizeof(unsigned char));
+
+	while (1) {
+		pthread_mutex_lock(&pool->lock);
+		const size_t i = pool->next;
+		pool->next++;
+		pthread_mutex_unlock(&pool->lock);
+
+		if (i >= pool->jobs_n)
+			break;
+
+		struct verify_job_t *job = &pool->jobs[i];
+		job->src_err = hash_file(job->src, job->src_hash, buf, &job->bytes);
+		if (job->dst) {
+			job->dst_err =
+				hash_file(job->dst, job->dst_hash, buf, &job->bytes);
+		}
+	}
+
+	free(buf);
+	return NULL;
+}
+
+/* Run the JOBS_N jobs in JOBS on a small thread pool (one file per
+ * worker at a time, claimed from a shared counter). */
+static void
+run_verify_jobs(struct verify_job_t *jobs, const size_t jobs_n)
+{
+	struct verify_pool_t pool;
+	pool.jobs = jobs;
+	pool.jobs_n = jobs_n;
+	pool.next = 0;
+	pthread_mutex_init(&pool.lock, NULL);
+
+	pthread_t threads[VERIFY_THREADS];
+	size_t nthreads = 0;
+
+	size_t t;
+	for (t = 0; t < VERIFY_THREADS && t < jobs_n; t++) {
+		if (pthread_create(&threads[t], NULL, verify_worker, &pool) != 0)
+			break;
+		nthreads++;
+	}
+
+	if (nthreads == 0) /* Thread creation failed: run serially. */
+		verify_worker(&pool);
+
+	for (t = 0; t < nthreads; t++)
+		pthread_join(threads[t], NULL);
+
+	pthread_mutex_destroy(&pool.lock);
+}
+
+static void
+print_hex_digest(const unsigned char *digest)
+{
+	size_t i;
+	for (i = 0; i < SHA256_DIGEST_LEN; i++)
+		printf("%02x", digest[i]);
+}
+
+/* Append a job for SRC (and DST, if not NULL) to the JOBS array
+ * (holding *JOBS_N entries). */
+static struct verify_job_t *
+add_verify_job(struct verify_job_t *jobs, size_t *jobs_n, const char *src,
+	const char *dst)
+{
+	jobs = xnrealloc(jobs, *jobs_n + 1, sizeof(struct verify_job_t));
+	jobs[*jobs_n].src = savestring(src, strlen(src));
+	jobs[*jobs_n].dst = dst ? savestring(dst, strlen(dst)) : (char *)NULL;
+	jobs[*jobs_n].bytes = 0;
+	jobs[*jobs_n].src_err = 0;
+	jobs[*jobs_n].dst_err = 0;
+	(*jobs_n)++;
+
+	return jobs;
+}
+
+/* Recursively add one compare job per regular file under the source
+ * directory SRC, pairing it with its counterpart under DST. */
+static struct verify_job_t *
+add_tree_jobs(struct verify_job_t *jobs, size_t *jobs_n, const char *src,
+	const char *dst)
+{
+	DIR *dir = opendir(src);
+	if (!dir) {
+		xerror("verify: '%s': %s\n", src, strerror(errno));
+		return jobs;
+	}
+
+	const struct dirent *ent;
+	while ((ent = readdir(dir)) != NULL) {
+		if (SELFORPARENT(ent->d_name))
+			continue;
+
+		char sbuf[PATH_MAX + 1];
+		char dbuf[PATH_MAX + 1];
+		snprintf(sbuf, sizeof(sbuf), "%s/%s", src, ent->d_name);
+		snprintf(dbuf, sizeof(dbuf), "%s/%s", dst, ent->d_name);
+
+		struct stat a;
+		if (lstat(sbuf, &a) == -1)
+			continue;
+
+		if (S_ISDIR(a.st_mode))
+			jobs = add_tree_jobs(jobs, jobs_n, sbuf, dbuf);
+		else if (S_ISREG(a.st_mode))
+			jobs = add_verify_job(jobs, jobs_n, sbuf, dbuf);
+	}
+
+	closedir(dir);
+	return jobs;
+}
+
+/* Print a per-second throughput figure for BYTES bytes hashed in SECS
+ * seconds. */
+static void
+print_throughput(const off_t bytes, const double secs)
+{
+	if (secs <= 0.0)
+		return;
+
+	const char *size = construct_human_size((off_t)((double)bytes / secs));
+	printf(_("verify: %zu byte(s) hashed in %.1fs (%s/s)\n"),
+		(size_t)bytes, secs, size ? size : "?");
+}
+
+static double
+timespec_diff(const struct timespec *start, const struct timespec *end)
+{
+	return (double)(end->tv_sec - start->tv_sec)
+		+ (double)(end->tv_nsec - start->tv_nsec) / 1000000000.0;
+}
+
+/* Compare the directories SRC and DST: every regular file under SRC is
+ * hashed together with its counterpart under DST, and mismatches and
+ * missing files are reported. Returns FUNC_SUCCESS if the trees match. */
+static int
+verify_trees(const char *src, const char *dst)
+{
+	struct verify_job_t *jobs = (struct verify_job_t *)NULL;
+	size_t jobs_n = 0;
+
+	jobs = add_tree_jobs(jobs, &jobs_n, src, dst);
+	if (jobs_n == 0) {
+		printf(_("verify: '%s': No regular files to compare\n"), src);
+		free(jobs);
+		return FUNC_SUCCESS;
+	}
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	run_verify_jobs(jobs, jobs_n);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	size_t matched = 0, mismatched = 0, missing = 0, errors = 0;
+	off_t bytes = 0;
+
+	size_t i;
+	for (i = 0; i < jobs_n; i++) {
+		bytes += jobs[i].bytes;
+
+		if (jobs[i].src_err != 0) {
+			xerror("verify: '%s': %s\n", jobs[i].src,
+				strerror(jobs[i].src_err));
+			errors++;
+		} else if (jobs[i].dst_err == ENOENT) {
+			printf(_("MISSING %s\n"), jobs[i].dst);
+			missing++;
+		} else if (jobs[i].dst_err != 0) {
+			xerror("verify: '%s': %s\n", jobs[i].dst,
+				strerror(jobs[i].dst_err));
+			errors++;
+		} else if (memcmp(jobs[i].src_hash, jobs[i].dst_hash,
+		SHA256_DIGEST_LEN) != 0) {
+			printf(_("FAILED  %s\n"), jobs[i].dst);
+			mismatched++;
+		} else {
+			matched++;
+		}
+
+		free(jobs[i].src);
+		free(jobs[i].dst);
+	}
+
+	free(jobs);
+
+	printf(_("verify: %zu file(s) compared: %zu OK, %zu mismatched, "
+		"%zu missing, %zu error(s)\n"), jobs_n, matched, mismatched,
+		missing, errors);
+	print_throughput(bytes, timespec_diff(&start, &end));
+
+	return (mismatched + missing + errors) == 0
+		? FUNC_SUCCESS : FUNC_FAILURE;
+}
+
+/* Hash each file in ARGS (N names) and print the digests in input order
+ * (sha256sum(1) format). */
+static int
+verify_list(char **args, const size_t n)
+{
+	struct verify_job_t *jobs = (struct verify_job_t *)NULL;
+	size_t jobs_n = 0;
+
+	size_t i;
+	for (i = 0; i < n; i++)
+		jobs = add_verify_job(jobs, &jobs_n, args[i], NULL);
+
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	run_verify_jobs(jobs, jobs_n);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	int exit_status = FUNC_SUCCESS;
+	off_t bytes = 0;
+
+	for (i = 0; i < jobs_n; i++) {
+		bytes += jobs[i].bytes;
+
+		if (jobs[i].src_err != 0) {
+			xerror("verify: '%s': %s\n", jobs[i].src,
+				strerror(jobs[i].src_err));
+			exit_status = FUNC_FAILURE;
+		} else {
+			print_hex_digest(jobs[i].src_hash);
+			printf("  %s\n", jobs[i].src);
+		}
+
+		free(jobs[i].src);
+	}
+
+	free(jobs);
+
+	if (jobs_n > 1)
+		print_throughput(bytes, timespec_diff(&start, &end));
+
+	return exit_status;
+}
+
+/* Handle the verify command: print SHA-256 digests for the files passed
+ * via ARGS, or, if passed exactly two directories, compare both trees. */
+int
+verify_files(char **args)
+{
+	if (!args || !args[1] || IS_HELP(args[1])) {
+		puts(_(VERIFY_USAGE));
+		return FUNC_SUCCESS;
+	}
+
+	size_t n = 0;
+	size_t i;
+	for (i = 1; args[i]; i++) {
+		if (strchr(args[i], '\\')) {
+			char *deq = unescape_str(args[i], 0);
+			if (deq) {
+				free(args[i]);
+				args[i] = deq;
+			}
+		}
+
+		const size_t len = strlen(args[i]);
+		if (len > 1 && args[i][len - 1] == '/')
+			args[i][len - 1] = '\0';
+
+		n++;
+	}
+
+	if (n == 2) {
+		struct stat a, b;
+		if (stat(args[1], &a) == 0 && S_ISDIR(a.st_mode)
+		&& stat(args[2], &b) == 0 && S_ISDIR(b.st_mode))
+			return verify_trees(args[1], args[2]);
+	}
+
+	return verify_list(args + 1, n);
+}
@@ -30,9 +30,7 @@
 #endif /* __linux__ */
 #include <errno.h>
 #include <string.h>
-#ifndef CLIFM_SUCKLESS
-# include <strings.h> /* str(n)casecmp() */
-#endif /* CLIFM_SUCKLESS */
+#include <strings.h> /* str(n)casecmp() */
 
 /* Only used to check the readline version */
 #ifdef __OpenBSD__
@@ -44,6 +42,7 @@
 
 #include "aux.h"
 #include "checks.h"
+#include "candidates.h" /* candidates_invalidate() */
 #include "colors.h"
 #include "config.h" /* set_div_line() */
 #include "file_operations.h"
@@ -418,18 +417,13 @@ get_regfile_color(const char *filename, const struct stat *attr, size_t *is_ext)
 	if (!ext)
 		return color ? color : fi_c;
 
-	size_t color_len = 0;
-	char *extcolor = get_ext_color(ext, &color_len);
-	if (!extcolor || color_len == 0 || color_len + 4 > sizeof(tmp_color))
+	size_t esc_len = 0;
+	char *extcolor = get_ext_color_esc(ext, &esc_len);
+	if (!extcolor)
 		return color ? color : fi_c;
 
-	*tmp_color = '\x1b'; tmp_color[1] = '[';
-	memcpy(tmp_color + 2, extcolor, color_len);
-	tmp_color[color_len + 2] = 'm';
-	tmp_color[color_len + 3] = '\0';
-
-	*is_ext = color_len + 3;
-	return tmp_color;
+	*is_ext = esc_len;
+	return extcolor;
 }
 
 /* Retrieve the color corresponding to dir FILENAME with mode MODE.
@@ -683,96 +677,104 @@ END:
 }
 #endif /* !CLIFM_SUCKLESS */
 
-/* Look for the hash HASH in the hash table for file name extensions.
- * Return a pointer to the corresponding color if found, or NULL. */
-static char *
-check_ext_hash(const size_t hash, size_t *val_len)
+/* Hash index over the ext_colors array, built once by
+ * build_ext_color_index() after the color scheme is parsed, so that
+ * get_ext_color() resolves an extension in O(1) instead of scanning the
+ * whole array once per file listed. EXT_COLOR_INDEX maps a bucket to
+ * the 1-based index of its first entry in ext_colors (0 = empty), and
+ * EXT_COLOR_NEXT chains entries sharing a bucket. */
+static size_t *ext_color_index = (size_t *)NULL;
+static size_t *ext_color_next = (size_t *)NULL;
+static size_t ext_color_index_size = 0;
+
+static void
+free_ext_color_index(void)
 {
-	size_t i;
-	for (i = 0; i < ext_colors_n; i++) {
-		if (!ext_colors[i].name || !ext_colors[i].value
-		|| hash != ext_colors[i].hash)
-			continue;
+	free(ext_color_index);
+	free(ext_color_next);
+	ext_color_index = ext_color_next = (size_t *)NULL;
+	ext_color_index_size = 0;
+}
 
-		if (val_len)
-			*val_len = ext_colors[i].value_len;
+static void
+build_ext_color_index(void)
+{
+	free_ext_color_index();
 
-		return ext_colors[i].value;
-	}
+	if (ext_colors_n == 0)
+		return;
 
-	return (char *)NULL;
-}
+	ext_color_index_size = 1;
+	while (ext_color_index_size < ext_colors_n * 2)
+		ext_color_index_size <<= 1;
 
+	ext_color_index = xcalloc(ext_color_index_size, sizeof(size_t));
+	ext_color_next = xcalloc(ext_colors_n, sizeof(size_t));
 
-/* Return the color code associated to the file extension EXT, updating
- * VAL_LEN, if not NULL, to the length of this color code. */
-static char *
-check_ext_string(const char *ext, size_t *val_len)
-{
-	/* Hold extension names. NAME_MAX should be enough: no file name should
-	 * go beyond NAME_MAX, so it's pretty safe to assume that no file extension
-	 * will be larger than this. */
-	static char tmp_ext[NAME_MAX];
-	char *ptr = tmp_ext;
-
-	int i;
-	for (i = 0; i < NAME_MAX && ext[i]; i++) {
-		if (ext[i] >= 'A' && ext[i] <= 'Z')
-			tmp_ext[i] = ext[i] + ' '; /* Tolower */
-		else
-			tmp_ext[i] = ext[i];
+	/* Walk the array backwards so that, among duplicated extensions, the
+	 * first defined one ends up first in its bucket chain. */
+	size_t i = ext_colors_n;
+	while (i-- > 0) {
+		const size_t b = ext_colors[i].hash & (ext_color_index_size - 1);
+		ext_color_next[i] = ext_color_index[b];
+		ext_color_index[b] = i + 1;
 	}
-	tmp_ext[i] = '\0';
-
-	const size_t len = (size_t)i;
-
-	i = (int)ext_colors_n;
-	while (--i >= 0) {
-		if (!ext_colors[i].name || !*ext_colors[i].name
-		|| ext_colors[i].len != len || *ptr != *ext_colors[i].name)
-			continue;
+}
 
-		char *p = ptr + 1, *q = ext_colors[i].name + 1;
+/* Returns a pointer to the corresponding color code for the file
+ * extension EXT (updating VAL_LEN, if not NULL, to the length of this
+ * code). Lookup is a single probe into the extensions hash index; hash
+ * collisions are resolved comparing the extension itself, so the result
+ * is always exact. */
+static struct ext_t *
+ext_color_lookup(const char *ext)
+{
+	if (!ext || !*ext || !*(++ext) || ext_colors_n == 0
+	|| !ext_color_index)
+		return (struct ext_t *)NULL;
 
-		size_t match = 1;
-		while (*p) {
-			if (*p != *q) {
-				match = 0;
-				break;
-			}
-			p++;
-			q++;
-		}
+	const size_t hash = hashme(ext, 0);
+	size_t i = ext_color_index[hash & (ext_color_index_size - 1)];
 
-		if (match == 0 || *q != '\0')
-			continue;
+	while (i != 0) {
+		struct ext_t *e = &ext_colors[i - 1];
 
-		if (val_len)
-			*val_len = ext_colors[i].value_len;
+		if (e->hash == hash && e->name && e->value
+		&& strcasecmp(e->name, ext) == 0)
+			return e;
 
-		return ext_colors[i].value;
+		i = ext_color_next[i - 1];
 	}
 
-	return (char *)NULL;
+	return (struct ext_t *)NULL;
 }
 
-/* Returns a pointer to the corresponding color code for the file
- * extension EXT (updating VAL_LEN to the length of this code).
- * The hash table is checked first if we have no hashes conflict. Otherwise,
- * a regular string comparison is performed to resolve it. */
 char *
 get_ext_color(const char *ext, size_t *val_len)
 {
-	if (!ext || !*ext || !*(++ext) || ext_colors_n == 0)
+	struct ext_t *e = ext_color_lookup(ext);
+	if (!e)
 		return (char *)NULL;
 
-	/* If the hash field at index 0 of the ext_colors struct is set to zero,
-	 * we have hash conflicts, in which case we fallback to regular string
-	 * comparison. */
-	if (ext_colors[0].hash != 0)
-		return check_ext_hash(hashme(ext, 0), val_len);
+	if (val_len)
+		*val_len = e->value_len;
+	return e->value;
+}
+
+/* Same as get_ext_color(), but returning the interned full escape
+ * sequence ("\x1b[CODEm"). The returned pointer is canonical: it stays
+ * valid until the color scheme is reloaded, so per-entry consumers can
+ * store it instead of building their own copy. */
+char *
+get_ext_color_esc(const char *ext, size_t *esc_len)
+{
+	struct ext_t *e = ext_color_lookup(ext);
+	if (!e)
+		return (char *)NULL;
 
-	return check_ext_string(ext, val_len);
+	if (esc_len)
+		*esc_len = e->esc_len;
+	return e->esc;
 }
 
 #ifndef CLIFM_SUCKLESS
@@ -1564,6 +1566,15 @@ store_extension_line(const char *line)
 	if (xargs.no_bold == 1)
 		remove_bold_attr(ext_colors[ext_colors_n].value);
 
+	/* Intern the full escape sequence too: per-entry consumers (the
+	 * listing, suggestions) store this canonical pointer instead of
+	 * building their own wrapped copy once per file. */
+	const size_t esc_len = strlen(ext_colors[ext_colors_n].value) + 3;
+	ext_colors[ext_colors_n].esc = xnmalloc(esc_len + 1, sizeof(char));
+	snprintf(ext_colors[ext_colors_n].esc, esc_len + 1, "\x1b[%sm",
+		ext_colors[ext_colors_n].value);
+	ext_colors[ext_colors_n].esc_len = esc_len;
+
 	*q = '=';
 	ext_colors_n++;
 
@@ -1573,77 +1584,52 @@ store_extension_line(const char *line)
 static void
 free_extension_colors(void)
 {
+	/* Stashed directory lists hold canonical pointers into this table:
+	 * drop them before the table goes away. The current list is rebuilt
+	 * right after a scheme change (see reload_dirlist() in
+	 * set_colors()). */
+	dircache_drop();
+
 	int i = (int)ext_colors_n;
 	while (--i >= 0) {
 		free(ext_colors[i].name);
 		free(ext_colors[i].value);
+		free(ext_colors[i].esc);
 	}
 	free(ext_colors);
 	ext_colors = (struct ext_t *)NULL;
 	ext_colors_n = 0;
-}
-
-/* Make sure hashes for file name extensions do not conflict.
- * If they do, the hash field at index zero (of the ext_colors struct) is set
- * to 0 to indicate that we have hash conflicts (in which case regular string
- * comparison must be used instead). */
-static void
-check_ext_color_hash_conflicts(void)
-{
-	size_t i, j;
-
-	for (i = 0; i < ext_colors_n; i++) {
-		for (j = i + 1; j < ext_colors_n; j++) {
-			if (ext_colors[i].hash == ext_colors[j].hash) {
-				ext_colors[0].hash = 0;
-				return;
-			}
-		}
-	}
+	free_ext_color_index();
 }
 
 static void
 split_extension_colors(char *extcolors)
 {
-	char *p = extcolors, *buf = (char *)NULL;
-	size_t len = 0;
-	int eol = 0;
-
 	free_extension_colors();
 
-	while (eol == 0) {
-		switch (*p) {
+	/* A single token buffer sized upfront: EXTCOLORS may be a string
+	 * literal (the built-in defaults), so it cannot be split in place. */
+	char *buf = xnmalloc(strlen(extcolors) + 1, sizeof(char));
 
-		case '\0': /* fallthrough */
-		case '\n': /* fallthrough */
-		case ':':
-			if (!buf || !*buf) {
-				eol = 1;
-				break;
-			}
-
-			buf[len] = '\0';
-			if (store_extension_line(buf) == FUNC_SUCCESS)
-				*buf = '\0';
-
-			if (!*p)
-				eol = 1;
-			len = 0;
+	char *p = extcolors;
+	while (*p) {
+		size_t len = 0;
+		while (*p && *p != ':' && *p != '\n') {
+			buf[len] = *p;
+			len++;
 			p++;
+		}
 
+		if (len == 0) /* Empty entry: stop processing, as always. */
 			break;
 
-		default:
-			buf = xnrealloc(buf, len + 2, sizeof(char));
-			buf[len] = *p;
-			len++;
+		buf[len] = '\0';
+		store_extension_line(buf);
+
+		if (*p)
 			p++;
-			break;
-		}
 	}
 
-	p = (char *)NULL;
-
 	free(buf);
 
 	if (ext_colors) {
@@ -1655,7 +1641,7 @@ split_extension_colors(char *extcolors)
 		ext_colors[ext_colors_n].value_len = 0;
 
 		ext_colors[ext_colors_n].hash = 0;
-		check_ext_color_hash_conflicts();
+		build_ext_color_index();
 	}
 }
 
@@ -2290,6 +2276,56 @@ set_cs_dir_icon_color(char *line, const ssize_t line_len)
 }
 #endif /* !_NO_ICONS */
 
+/* Write the path to the file of the color scheme COLORSCHEME into BUF
+ * (of SIZE bytes): the local colors directory first, and, if not found
+ * there, the system data directory. */
+static void
+get_colorscheme_file(const char *colorscheme, char *buf, const size_t size)
+{
+	*buf = '\0';
+	if (config_ok == 1 && colors_dir) {
+		snprintf(buf, size, "%s/%s.clifm", colors_dir,
+			colorscheme ? colorscheme : "default"); /* NOLINT */
+	}
+
+	/* If not in local dir, check system data dir as well */
+	struct stat attr;
+	if (data_dir && (!*buf || stat(buf, &attr) == -1)) {
+		snprintf(buf, size, "%s/%s/colors/%s.clifm", data_dir,
+			PROGRAM_NAME, colorscheme ? colorscheme : "default");
+	}
+}
+
+/* The color scheme file last parsed by set_colors(), together with its
+ * modification time: if neither changed, a config reload skips the whole
+ * parse (splitting a large scheme takes by far the biggest share of a
+ * reload). Wiped by invalidate_cscheme_cache() whenever colors are reset
+ * behind set_colors()'s back. */
+static char loaded_cs_file[PATH_MAX + 1];
+static time_t loaded_cs_mtime = (time_t)-1;
+
+void
+invalidate_cscheme_cache(void)
+{
+	*loaded_cs_file = '\0';
+	loaded_cs_mtime = (time_t)-1;
+}
+
+/* Return 1 if any environment variable overriding color definitions is
+ * set, in which case the parsed-scheme cache does not apply. */
+static int
+env_colors_set(void)
+{
+	const char *f = getenv("CLIFM_FILE_COLORS");
+	const char *e = getenv("CLIFM_EXT_COLORS");
+	const char *i = getenv("CLIFM_IFACE_COLORS");
+	const char *d = getenv("CLIFM_DATE_SHADES");
+	const char *s = getenv("CLIFM_SIZE_SHADES");
+
+	return (xargs.lscolors == 1 || (f && *f) || (e && *e) || (i && *i)
+		|| (d && *d) || (s && *s));
+}
+
 /* Get color lines from the configuration file */
 static int
 read_color_scheme_file(const char *colorscheme, char **filecolors,
@@ -2301,20 +2337,8 @@ read_color_scheme_file(const char *colorscheme, char **filecolors,
 	init_defs();
 
 	char colorscheme_file[PATH_MAX + 1];
-	*colorscheme_file = '\0';
-	if (config_ok == 1 && colors_dir) {
-		snprintf(colorscheme_file, sizeof(colorscheme_file), "%s/%s.clifm",
-			colors_dir, colorscheme ? colorscheme : "default"); /* NOLINT */
-	}
-
-	/* If not in local dir, check system data dir as well */
-	struct stat attr;
-	if (data_dir && (!*colorscheme_file
-	|| stat(colorscheme_file, &attr) == -1)) {
-		snprintf(colorscheme_file, sizeof(colorscheme_file),
-			"%s/%s/colors/%s.clifm", data_dir, PROGRAM_NAME, colorscheme
-			? colorscheme : "default");
-	}
+	get_colorscheme_file(colorscheme, colorscheme_file,
+		sizeof(colorscheme_file));
 
 	FILE *fp_colors = fopen(colorscheme_file, "r");
 	if (!fp_colors) {
@@ -2442,43 +2466,36 @@ read_color_scheme_file(const char *colorscheme, char **filecolors,
 static void
 split_color_line(char *line, const int type)
 {
-	/* Split the colors line into substrings (one per color) */
-	char *p = line, *buf = (char *)NULL, **colors = (char **)NULL;
-	size_t len = 0, words = 0;
-	int eol = 0;
-
-	while (eol == 0) {
-		switch (*p) {
+	/* Split the colors line into substrings (one per color). A single
+	 * token buffer is sized upfront: no token can be longer than the
+	 * whole line. */
+	char *buf = xnmalloc(strlen(line) + 1, sizeof(char));
+	char **colors = (char **)NULL;
+	size_t words = 0;
+	int started = 0; /* Splitting starts at the first non-separator char */
+
+	char *p = line;
+	while (1) {
+		size_t len = 0;
+		while (*p && *p != ':' && *p != '\n') {
+			buf[len] = *p;
+			len++;
+			p++;
+			started = 1;
+		}
+		buf[len] = '\0';
 
-		case '\0': /* fallthrough */
-		case '\n': /* fallthrough */
-		case ':':
-			if (!buf)
-				break;
-			buf[len] = '\0';
+		if (started == 1) {
 			colors = xnrealloc(colors, words + 1, sizeof(char *));
 			colors[words] = savestring(buf, len);
 			words++;
-			*buf = '\0';
-
-			if (!*p)
-				eol = 1;
+		}
 
-			len = 0;
-			p++;
+		if (!*p)
 			break;
-
-		default:
-			buf = xnrealloc(buf, len + 2, sizeof(char));
-			buf[len] = *p;
-			len++;
-			p++;
-			break;
-		}
+		p++;
 	}
 
-	p = (char *)NULL;
-
 	free(buf);
 
 	if (!colors)
@@ -2618,6 +2635,27 @@ set_colors(const char *colorscheme, const int check_env)
 		 *extcolors = (char *)NULL,
 	     *ifacecolors = (char *)NULL;
 
+	int ret = FUNC_SUCCESS;
+	if (colorscheme && *colorscheme && color_schemes)
+		ret = get_cur_colorscheme(colorscheme);
+
+#ifndef CLIFM_SUCKLESS
+	/* If the scheme file last parsed is requested again and has not been
+	 * modified, the current color state already matches it: nothing to do.
+	 * This makes config reloads near-instant when only unrelated options
+	 * changed. Environment color overrides bypass the cache. */
+	if (ret == FUNC_SUCCESS && xargs.stealth_mode != 1 && config_ok != 0
+	&& *loaded_cs_file && env_colors_set() == 0) {
+		char cs_file[PATH_MAX + 1];
+		get_colorscheme_file(cur_cscheme, cs_file, sizeof(cs_file));
+
+		struct stat attr;
+		if (strcmp(cs_file, loaded_cs_file) == 0
+		&& stat(cs_file, &attr) != -1 && attr.st_mtime == loaded_cs_mtime)
+			return FUNC_SUCCESS;
+	}
+#endif /* !CLIFM_SUCKLESS */
+
 	date_shades.type = SHADE_TYPE_UNSET;
 	size_shades.type = SHADE_TYPE_UNSET;
 
@@ -2625,10 +2663,6 @@ set_colors(const char *colorscheme, const int check_env)
 	*dir_ico_c = '\0';
 #endif /* !_NO_ICONS */
 
-	int ret = FUNC_SUCCESS;
-	if (colorscheme && *colorscheme && color_schemes)
-		ret = get_cur_colorscheme(colorscheme);
-
 	/* CHECK_ENV is true only when this function is called from
 	 * check_colors() (config.c) */
 	if (ret == FUNC_SUCCESS && check_env == 1)
@@ -2640,8 +2674,17 @@ set_colors(const char *colorscheme, const int check_env)
 		if (read_color_scheme_file(cur_cscheme, &filecolors,
 		&extcolors, &ifacecolors, check_env) == FUNC_FAILURE) {
 			clear_defs();
+			invalidate_cscheme_cache();
 			return FUNC_FAILURE;
 		}
+
+		/* Record the parsed file for the next call. */
+		struct stat attr;
+		get_colorscheme_file(cur_cscheme, loaded_cs_file,
+			sizeof(loaded_cs_file));
+		loaded_cs_mtime = (env_colors_set() == 0
+			&& stat(loaded_cs_file, &attr) != -1)
+			? attr.st_mtime : (time_t)-1;
 	}
 #endif /* CLIFM_SUCKLESS */
 	/* Split the color lines into substrings (one per color) */
@@ -2860,6 +2903,8 @@ is_duplicate_colorscheme_name(const char *name, const size_t total)
 size_t
 get_colorschemes(void)
 {
+	candidates_invalidate(CAND_CSCHEMES);
+
 	struct stat attr;
 	int schemes_total = 0;
 	struct dirent *ent;
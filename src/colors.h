@@ -44,6 +44,7 @@ __BEGIN_DECLS
 
 void color_codes(void);
 void colors_list(char *ent, const int eln, const int pad, const int new_line);
+void invalidate_cscheme_cache(void);
 int  cschemes_function(char **args);
 #ifndef CLIFM_SUCKLESS
 size_t get_colorschemes(void);
@@ -51,6 +52,7 @@ size_t get_colorschemes(void);
 char *get_dir_color(const char *filename, const mode_t mode,
 	const nlink_t links, const filesn_t count);
 char *get_ext_color(const char *ext, size_t *val_len);
+char *get_ext_color_esc(const char *ext, size_t *esc_len);
 char *get_file_color(const char *filename, const struct stat *attr);
 char *get_regfile_color(const char *filename, const struct stat *attr,
 	size_t *is_ext);
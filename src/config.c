@@ -37,6 +37,7 @@
 #include "colors.h"
 #include "config.h"
 #include "file_operations.h"
+#include "history.h" /* flush_cmdhist */
 #include "init.h"
 #include "listing.h"
 #include "messages.h"
@@ -135,6 +136,7 @@ get_tab_comp_mode_str(void)
 	case FZF_TAB: xstrsncpy(s, "fzf", 4); break;
 	case FNF_TAB: xstrsncpy(s, "fnf", 4); break;
 	case SMENU_TAB: xstrsncpy(s, "smenu", 6); break;
+	case INT_TAB: xstrsncpy(s, "internal", 9); break;
 	case STD_TAB: xstrsncpy(s, "standard", 9); break;
 // 	default: free(s); s = (char *)NULL; break;
 /* The default case is not needed: all cases for TABMODE are covered */
@@ -212,6 +214,10 @@ dump_config(void)
 	print_config_value("ApparentSize", &conf.apparent_size, &n,
 		DUMP_CONFIG_BOOL);
 
+	n = DEF_APPROX_DIR_SIZE;
+	print_config_value("ApproxDirSize", &conf.approx_dir_size, &n,
+		DUMP_CONFIG_BOOL);
+
 	n = DEF_AUTOCD;
 	print_config_value("Autocd", &conf.autocd, &n, DUMP_CONFIG_BOOL);
 
@@ -227,6 +233,10 @@ dump_config(void)
 		DUMP_CONFIG_BOOL);
 #endif /* !_NO_SUGGESTIONS */
 
+	n = DEF_BIG_DIR_THRESHOLD;
+	print_config_value("BigDirThreshold", &conf.big_dir_threshold, &n,
+		DUMP_CONFIG_INT);
+
 	n = DEF_CASE_SENS_DIRJUMP;
 	print_config_value("CaseSensitiveDirjump", &conf.case_sens_dirjump,
 		&n, DUMP_CONFIG_BOOL);
@@ -1573,8 +1583,9 @@ create_main_config_file(char *file)
 		"# Fuzzy matching algorithm: 1 (faster, non-Unicode), 2 (slower, Unicode)\n\
 ;FuzzyAlgorithm=%d\n\n"
 
-		"# TAB completion mode: 'standard', 'fzf', 'fnf', or 'smenu'. Defaults to\n\
-# 'fzf' if the binary is found in PATH. Otherwise, the standard mode is used.\n\
+		"# TAB completion mode: 'standard', 'fzf', 'fnf', 'smenu', or 'internal'\n\
+# (a built-in fuzzy finder requiring no external binary). Defaults to 'fzf'\n\
+# if the binary is found in PATH. Otherwise, the standard mode is used.\n\
 ;TabCompletionMode=\n\n"
 
 		"# File previews for TAB completion (fzf mode only). Possible values:\n\
@@ -1616,7 +1627,11 @@ create_main_config_file(char *file)
 # Print files apparent size instead of actual device usage\n\
 ;ApparentSize=%s\n\
 # If running in long view, print directories total size\n\
-;FullDirSize=%s\n\n\
+;FullDirSize=%s\n\
+# If FullDirSize is enabled, estimate directory sizes by sampling a bounded\n\
+# number of subdirectories (estimates are marked with a tilde, e.g. \"~4.2G\",\n\
+# and refined in the background)\n\
+;ApproxDirSize=%s\n\n\
 # Log errors and warnings\n\
 ;LogMsgs=%s\n\
 # Log commands entered in the command line\n\
@@ -1661,6 +1676,7 @@ create_main_config_file(char *file)
 		DEF_PROP_FIELDS_GAP,
 		DEF_APPARENT_SIZE == 1 ? "true" : "false",
 		DEF_FULL_DIR_SIZE == 1 ? "true" : "false",
+		DEF_APPROX_DIR_SIZE == 1 ? "true" : "false",
 		DEF_LOG_MSGS == 1 ? "true" : "false",
 		DEF_LOG_CMDS == 1 ? "true" : "false",
 		DEF_MIN_NAME_TRIM,
@@ -1740,6 +1756,13 @@ create_main_config_file(char *file)
 # ignored as well, so that the color per extension feature is disabled.\n\
 ;LightMode=%s\n\n"
 
+	    "# Above this number of files in a directory, automatically switch the\n\
+# listing to light mode and disable the files counter and icons for that\n\
+# directory (with hysteresis: the full listing comes back only once the\n\
+# count drops well below the threshold). Set to 0 to never degrade.\n\
+# For a manual, per-directory version of this, see the 'autocmd' keyword.\n\
+;BigDirThreshold=%d\n\n"
+
 	    "# If running with colors, append directory indicator\n\
 # to directories. If running without colors (via the --no-color option),\n\
 # append file type indicator at the end of file names.\n\
@@ -1811,6 +1834,7 @@ create_main_config_file(char *file)
 ;TrimNames=%s\n\n",
 
 		DEF_LIGHT_MODE == 1 ? "true" : "false",
+		DEF_BIG_DIR_THRESHOLD,
 		DEF_CLASSIFY == 1 ? "true" : "false",
 		DEF_COLOR_LNK_AS_TARGET == 1 ? "true" : "false",
 		DEF_SHARE_SELBOX == 1 ? "true" : "false",
@@ -2771,6 +2795,8 @@ set_tabcomp_mode(const char *line)
 		fzftab = 1; tabmode = FNF_TAB;
 	} else if (strncmp(tmp, "smenu", 5) == 0) {
 		fzftab = 1; tabmode = SMENU_TAB;
+	} else if (strncmp(tmp, "internal", 8) == 0) {
+		fzftab = 1; tabmode = INT_TAB;
 	}
 }
 #endif /* !_NO_FZF */
@@ -2892,6 +2918,275 @@ set_sort_name(char *line)
 	}
 }
 
+/* ---- Config file keyword dispatch ----
+ * read_config() used to match every line of the config file against
+ * each option keyword in turn with an strncmp() chain. Keywords are
+ * now resolved with a single hash table lookup. */
+
+enum config_opt {
+	CFG_APPARENT_SIZE,
+	CFG_APPROX_DIR_SIZE,
+	CFG_AUTOCMD,
+	CFG_AUTOCD,
+	CFG_AUTOLS,
+	CFG_AUTO_OPEN,
+#ifndef _NO_SUGGESTIONS
+	CFG_AUTO_SUGGESTIONS,
+#endif /* !_NO_SUGGESTIONS */
+	CFG_BIG_DIR_THRESHOLD,
+	CFG_CASE_SENS_DIRJUMP,
+	CFG_CASE_SENS_SEARCH,
+	CFG_CASE_SENS_LIST,
+	CFG_CASE_SENS_PATH_COMP,
+	CFG_CD_ON_QUIT,
+	CFG_CLASSIFY,
+	CFG_CLEAR_SCREEN,
+	CFG_COLOR_LNK_AS_TARGET,
+	CFG_COLOR_SCHEME,
+	CFG_CP_CMD,
+	CFG_DESKTOP_NOTIFICATIONS,
+	CFG_DIRHIST_MAP,
+	CFG_DIRHIST_IGNORE,
+	CFG_DISK_USAGE,
+	CFG_DIVIDING_LINE,
+	CFG_EXTERNAL_COMMANDS,
+	CFG_FILES_COUNTER,
+	CFG_FILTER,
+	CFG_FULL_DIR_SIZE,
+	CFG_FUZZY_ALGORITHM,
+	CFG_FUZZY_MATCHING,
+	CFG_FZF_PREVIEW,
+	CFG_HIST_IGNORE,
+#ifndef _NO_ICONS
+	CFG_ICONS,
+#endif /* !_NO_ICONS */
+	CFG_LIGHT_MODE,
+	CFG_LIST_DIRS_FIRST,
+	CFG_LISTING_MODE,
+	CFG_LONG_VIEW_MODE,
+	CFG_LOGS,
+	CFG_LOG_MSGS,
+	CFG_LOG_CMDS,
+	CFG_MAX_DIRHIST,
+	CFG_MAX_FILENAME_LEN,
+	CFG_MAX_HISTORY,
+	CFG_MAX_JUMP_TOTAL_RANK,
+	CFG_MAX_LOG,
+	CFG_MAX_PATH,
+	CFG_MAX_PRINTSELFILES,
+	CFG_MIN_FILENAME_TRIM,
+	CFG_MIN_JUMP_RANK,
+	CFG_MV_CMD,
+	CFG_OPENER,
+	CFG_PAGER,
+	CFG_PAGER_VIEW,
+	CFG_PRINT_SELFILES,
+	CFG_PRIVATE_WS_SETTINGS,
+	CFG_PROP_FIELDS,
+	CFG_PROP_FIELDS_GAP,
+	CFG_PTIME_STYLE,
+	CFG_PURGE_JUMPDB,
+	CFG_QUOTING_STYLE,
+	CFG_READ_AUTOCMD_FILES,
+	CFG_READ_DOTHIDDEN,
+	CFG_READONLY,
+	CFG_RESTORE_LAST_PATH,
+	CFG_RL_EDIT_MODE,
+	CFG_RM_FORCE,
+	CFG_SEARCH_STRATEGY,
+	CFG_SHARE_SELBOX,
+	CFG_SHOW_HIDDEN_FILES,
+	CFG_SKIP_NON_ALNUM_PREFIX,
+	CFG_SORT,
+	CFG_SORT_REVERSE,
+	CFG_SPLASH_SCREEN,
+	CFG_STARTING_PATH,
+#ifndef _NO_SUGGESTIONS
+	CFG_SUGGEST_CMD_DESC,
+	CFG_SUGGEST_FILETYPE_COLOR,
+	CFG_SUGGESTION_STRATEGY,
+#endif /* !_NO_SUGGESTIONS */
+#ifndef _NO_HIGHLIGHT
+	CFG_SYNTAX_HIGHLIGHTING,
+#endif /* !_NO_HIGHLIGHT */
+#ifndef _NO_FZF
+	CFG_TAB_COMPLETION_MODE,
+#endif /* !_NO_FZF */
+	CFG_TERMINAL_CMD,
+	CFG_TIME_STYLE,
+	CFG_TIPS,
+#ifndef _NO_TRASH
+	CFG_TRASH_AS_RM,
+#endif /* !_NO_TRASH */
+	CFG_TRIM_NAMES,
+	CFG_UNICODE,
+	CFG_UMASK,
+	CFG_WELCOME_MESSAGE,
+	CFG_WELCOME_MESSAGE_STR,
+	CFG_WORKSPACE_NAMES,
+};
+
+static const struct config_kw_t {
+	const char *name;
+	int opt; /* enum config_opt */
+} config_kw[] = {
+	{"ApparentSize", CFG_APPARENT_SIZE},
+	{"ApproxDirSize", CFG_APPROX_DIR_SIZE},
+	{"autocmd", CFG_AUTOCMD},
+	{"Autocd", CFG_AUTOCD},
+	{"AutoLs", CFG_AUTOLS},
+	{"AutoOpen", CFG_AUTO_OPEN},
+#ifndef _NO_SUGGESTIONS
+	{"AutoSuggestions", CFG_AUTO_SUGGESTIONS},
+#endif /* !_NO_SUGGESTIONS */
+	{"BigDirThreshold", CFG_BIG_DIR_THRESHOLD},
+	{"CaseSensitiveDirJump", CFG_CASE_SENS_DIRJUMP},
+	{"CaseSensitiveSearch", CFG_CASE_SENS_SEARCH},
+	{"CaseSensitiveList", CFG_CASE_SENS_LIST},
+	{"CaseSensitivePathComp", CFG_CASE_SENS_PATH_COMP},
+	{"CdOnQuit", CFG_CD_ON_QUIT},
+	{"Classify", CFG_CLASSIFY},
+	{"ClearScreen", CFG_CLEAR_SCREEN},
+	{"ColorLinksAsTarget", CFG_COLOR_LNK_AS_TARGET},
+	{"ColorScheme", CFG_COLOR_SCHEME},
+	{"cpCmd", CFG_CP_CMD},
+	{"DesktopNotifications", CFG_DESKTOP_NOTIFICATIONS},
+	{"DirhistMap", CFG_DIRHIST_MAP},
+	{"DirhistIgnore", CFG_DIRHIST_IGNORE},
+	{"DiskUsage", CFG_DISK_USAGE},
+	{"DividingLine", CFG_DIVIDING_LINE},
+	{"ExternalCommands", CFG_EXTERNAL_COMMANDS},
+	{"FilesCounter", CFG_FILES_COUNTER},
+	{"Filter", CFG_FILTER},
+	{"FullDirSize", CFG_FULL_DIR_SIZE},
+	{"FuzzyAlgorithm", CFG_FUZZY_ALGORITHM},
+	{"FuzzyMatching", CFG_FUZZY_MATCHING},
+	{"FzfPreview", CFG_FZF_PREVIEW},
+	{"HistIgnore", CFG_HIST_IGNORE},
+#ifndef _NO_ICONS
+	{"Icons", CFG_ICONS},
+#endif /* !_NO_ICONS */
+	{"LightMode", CFG_LIGHT_MODE},
+	{"ListDirsFirst", CFG_LIST_DIRS_FIRST},
+	{"ListingMode", CFG_LISTING_MODE},
+	{"LongViewMode", CFG_LONG_VIEW_MODE},
+	{"Logs", CFG_LOGS}, /* Deprecated */
+	{"LogMsgs", CFG_LOG_MSGS},
+	{"LogCmds", CFG_LOG_CMDS},
+	{"MaxDirhist", CFG_MAX_DIRHIST},
+	{"MaxFilenameLen", CFG_MAX_FILENAME_LEN},
+	{"MaxHistory", CFG_MAX_HISTORY},
+	{"MaxJumpTotalRank", CFG_MAX_JUMP_TOTAL_RANK},
+	{"MaxLog", CFG_MAX_LOG},
+	{"MaxPath", CFG_MAX_PATH},
+	{"MaxPrintSelfiles", CFG_MAX_PRINTSELFILES},
+	{"MinFilenameTrim", CFG_MIN_FILENAME_TRIM},
+	{"MinJumpRank", CFG_MIN_JUMP_RANK},
+	{"mvCmd", CFG_MV_CMD},
+	{"Opener", CFG_OPENER},
+	{"Pager", CFG_PAGER},
+	{"PagerView", CFG_PAGER_VIEW},
+	{"PrintSelfiles", CFG_PRINT_SELFILES},
+	{"PrivateWorkspaceSettings", CFG_PRIVATE_WS_SETTINGS},
+	{"PropFields", CFG_PROP_FIELDS},
+	{"PropFieldsGap", CFG_PROP_FIELDS_GAP},
+	{"PTimeStyle", CFG_PTIME_STYLE},
+	{"PurgeJumpDB", CFG_PURGE_JUMPDB},
+	{"QuotingStyle", CFG_QUOTING_STYLE},
+	{"ReadAutocmdFiles", CFG_READ_AUTOCMD_FILES},
+	{"ReadDotHidden", CFG_READ_DOTHIDDEN},
+	{"Readonly", CFG_READONLY},
+	{"RestoreLastPath", CFG_RESTORE_LAST_PATH},
+	{"RlEditMode", CFG_RL_EDIT_MODE},
+	{"rmForce", CFG_RM_FORCE},
+	{"SearchStrategy", CFG_SEARCH_STRATEGY},
+	{"ShareSelbox", CFG_SHARE_SELBOX},
+	{"ShowHiddenFiles", CFG_SHOW_HIDDEN_FILES},
+	{"SkipNonAlnumPrefix", CFG_SKIP_NON_ALNUM_PREFIX},
+	{"Sort", CFG_SORT},
+	{"SortReverse", CFG_SORT_REVERSE},
+	{"SplashScreen", CFG_SPLASH_SCREEN},
+	{"StartingPath", CFG_STARTING_PATH},
+#ifndef _NO_SUGGESTIONS
+	{"SuggestCmdDesc", CFG_SUGGEST_CMD_DESC},
+	{"SuggestFiletypeColor", CFG_SUGGEST_FILETYPE_COLOR},
+	{"SuggestionStrategy", CFG_SUGGESTION_STRATEGY},
+#endif /* !_NO_SUGGESTIONS */
+#ifndef _NO_HIGHLIGHT
+	{"SyntaxHighlighting", CFG_SYNTAX_HIGHLIGHTING},
+#endif /* !_NO_HIGHLIGHT */
+#ifndef _NO_FZF
+	{"TabCompletionMode", CFG_TAB_COMPLETION_MODE},
+#endif /* !_NO_FZF */
+	{"TerminalCmd", CFG_TERMINAL_CMD},
+	{"TimeStyle", CFG_TIME_STYLE},
+	{"Tips", CFG_TIPS},
+#ifndef _NO_TRASH
+	{"TrashAsRm", CFG_TRASH_AS_RM},
+#endif /* !_NO_TRASH */
+	{"TrimNames", CFG_TRIM_NAMES},
+	{"Unicode", CFG_UNICODE},
+	{"Umask", CFG_UMASK},
+	{"WelcomeMessage", CFG_WELCOME_MESSAGE},
+	{"WelcomeMessageStr", CFG_WELCOME_MESSAGE_STR},
+	{"WorkspaceNames", CFG_WORKSPACE_NAMES},
+	{NULL, -1},
+};
+
+/* Hash index over CONFIG_KW: CONFIG_KW_MAP[H] holds the index of the
+ * entry in CONFIG_KW whose name hashes to H, or -1. Collisions are
+ * resolved by linear probing (the table is several times larger than
+ * the keyword set, so probe chains are short). */
+#define CONFIG_KW_MAP_SIZE 512
+static int config_kw_map[CONFIG_KW_MAP_SIZE];
+static int config_kw_map_ready = 0;
+
+static void
+build_config_kw_map(void)
+{
+	size_t i;
+	for (i = 0; i < CONFIG_KW_MAP_SIZE; i++)
+		config_kw_map[i] = -1;
+
+	for (i = 0; config_kw[i].name; i++) {
+		size_t h = hashme(config_kw[i].name, 1) % CONFIG_KW_MAP_SIZE;
+		while (config_kw_map[h] != -1)
+			h = (h + 1) % CONFIG_KW_MAP_SIZE;
+		config_kw_map[h] = (int)i;
+	}
+
+	config_kw_map_ready = 1;
+}
+
+/* Return the option ID (enum config_opt) of the keyword NAME (NAME_LEN
+ * bytes long), or -1 if NAME is not a config option keyword.
+ * NAME points into a writable buffer and is not NUL-terminated: it is
+ * terminated temporarily to reuse hashme() and strcmp(). */
+static int
+lookup_config_opt(char *name, const size_t name_len)
+{
+	if (config_kw_map_ready == 0)
+		build_config_kw_map();
+
+	const char c = name[name_len];
+	name[name_len] = '\0';
+
+	int ret = -1;
+	size_t h = hashme(name, 1) % CONFIG_KW_MAP_SIZE;
+
+	while (config_kw_map[h] != -1) {
+		const struct config_kw_t *k = &config_kw[config_kw_map[h]];
+		if (*k->name == *name && strcmp(k->name, name) == 0) {
+			ret = k->opt;
+			break;
+		}
+		h = (h + 1) % CONFIG_KW_MAP_SIZE;
+	}
+
+	name[name_len] = c;
+	return ret;
+}
+
 /* Read the main configuration file and set options accordingly */
 static void
 read_config(void)
@@ -2912,471 +3207,541 @@ read_config(void)
 	int ret = -1;
 	conf.max_name_len = DEF_MAX_NAME_LEN;
 	*div_line = *DEF_DIV_LINE;
-	/* The longest possible line in the config file is StartingPath="PATH" */
-	char line[PATH_MAX + 16]; *line = '\0';
 
 	if (xargs.prop_fields_str != 1)
 		*prop_fields_str = '\0';
 
-	while (fgets(line, (int)sizeof(line), config_fp)) {
+	char *buf = load_file_to_buf(fd);
+	fclose(config_fp);
+
+	char *p = buf;
+	char *line;
+	size_t line_len;
+
+	while ((line = get_buf_line(&p, &line_len))) {
 		if (*line < 'A' || *line > 'z')
 			continue;
 
-		if (xargs.apparent_size == UNSET && *line == 'A'
-		&& strncmp(line, "ApparentSize=", 13) == 0) {
-			set_config_bool_value(line + 13, &conf.apparent_size);
-		}
+		/* The option keyword is the text before '=' ("autocmd" is
+		 * followed by a space instead). */
+		const size_t kw_len = strcspn(line, "= ");
+		if (!line[kw_len])
+			continue;
 
-		else if (*line == 'a' && strncmp(line, "autocmd ", 8) == 0) {
-			parse_autocmd_line(line + 8, sizeof(line) - 8);
-		}
+		const int opt = lookup_config_opt(line, kw_len);
+		if (opt == -1
+		|| line[kw_len] != (opt == CFG_AUTOCMD ? ' ' : '='))
+			continue;
 
-		else if (xargs.autocd == UNSET && *line == 'A'
-		&& strncmp(line, "Autocd=", 7) == 0) {
-			set_config_bool_value(line + 7, &conf.autocd);
-		}
+		char *val = line + kw_len + 1;
 
-		else if (xargs.autols == UNSET && *line == 'A'
-		&& strncmp(line, "AutoLs=", 7) == 0) {
-			set_config_bool_value(line + 7, &conf.autols);
-		}
+		switch (opt) {
+		case CFG_APPARENT_SIZE:
+			if (xargs.apparent_size != UNSET)
+				break;
+			set_config_bool_value(val, &conf.apparent_size);
+			break;
 
-		else if (xargs.auto_open == UNSET && *line == 'A'
-		&& strncmp(line, "AutoOpen=", 9) == 0) {
-			set_config_bool_value(line + 9, &conf.auto_open);
-		}
+		case CFG_APPROX_DIR_SIZE:
+			set_config_bool_value(val, &conf.approx_dir_size);
+			break;
+
+		case CFG_AUTOCMD:
+			parse_autocmd_line(val, line_len - kw_len);
+			break;
+
+		case CFG_AUTOCD:
+			if (xargs.autocd != UNSET)
+				break;
+			set_config_bool_value(val, &conf.autocd);
+			break;
+
+		case CFG_AUTOLS:
+			if (xargs.autols != UNSET)
+				break;
+			set_config_bool_value(val, &conf.autols);
+			break;
+
+		case CFG_AUTO_OPEN:
+			if (xargs.auto_open != UNSET)
+				break;
+			set_config_bool_value(val, &conf.auto_open);
+			break;
 
 #ifndef _NO_SUGGESTIONS
-		else if (xargs.suggestions == UNSET && *line == 'A'
-		&& strncmp(line, "AutoSuggestions=", 16) == 0) {
-			set_config_bool_value(line + 16, &conf.suggestions);
-		}
+		case CFG_AUTO_SUGGESTIONS:
+			if (xargs.suggestions != UNSET)
+				break;
+			set_config_bool_value(val, &conf.suggestions);
+			break;
+
 #endif /* !_NO_SUGGESTIONS */
+		case CFG_BIG_DIR_THRESHOLD:
+			set_config_int_value(val, &conf.big_dir_threshold, 0, INT_MAX);
+			break;
 
-		else if (xargs.case_sens_dirjump == UNSET && *line == 'C'
-		&& strncmp(line, "CaseSensitiveDirJump=", 21) == 0) {
-			set_config_bool_value(line + 21, &conf.case_sens_dirjump);
-		}
+		case CFG_CASE_SENS_DIRJUMP:
+			if (xargs.case_sens_dirjump != UNSET)
+				break;
+			set_config_bool_value(val, &conf.case_sens_dirjump);
+			break;
 
-		else if (*line == 'C'
-		&& strncmp(line, "CaseSensitiveSearch=", 20) == 0) {
-			set_config_bool_value(line + 20, &conf.case_sens_search);
-		}
+		case CFG_CASE_SENS_SEARCH:
+			set_config_bool_value(val, &conf.case_sens_search);
+			break;
 
-		else if (xargs.case_sens_list == UNSET && *line == 'C'
-		&& strncmp(line, "CaseSensitiveList=", 18) == 0) {
-			set_config_bool_value(line + 18, &conf.case_sens_list);
-		}
+		case CFG_CASE_SENS_LIST:
+			if (xargs.case_sens_list != UNSET)
+				break;
+			set_config_bool_value(val, &conf.case_sens_list);
+			break;
 
-		else if (xargs.case_sens_path_comp == UNSET && *line == 'C'
-		&& strncmp(line, "CaseSensitivePathComp=", 22) == 0) {
-			set_config_bool_value(line + 22, &conf.case_sens_path_comp);
-		}
+		case CFG_CASE_SENS_PATH_COMP:
+			if (xargs.case_sens_path_comp != UNSET)
+				break;
+			set_config_bool_value(val, &conf.case_sens_path_comp);
+			break;
 
-		else if (xargs.cd_on_quit == UNSET && *line == 'C'
-		&& strncmp(line, "CdOnQuit=", 9) == 0) {
-			set_config_bool_value(line + 9, &conf.cd_on_quit);
-		}
+		case CFG_CD_ON_QUIT:
+			if (xargs.cd_on_quit != UNSET)
+				break;
+			set_config_bool_value(val, &conf.cd_on_quit);
+			break;
 
-		else if (xargs.classify == UNSET && *line == 'C'
-		&& strncmp(line, "Classify=", 9) == 0) {
-			set_config_bool_value(line + 9, &conf.classify);
-		}
+		case CFG_CLASSIFY:
+			if (xargs.classify != UNSET)
+				break;
+			set_config_bool_value(val, &conf.classify);
+			break;
 
-		else if (xargs.clear_screen == UNSET && *line == 'C'
-		&& strncmp(line, "ClearScreen=", 12) == 0) {
-			set_config_bool_value(line + 12, &conf.clear_screen);
-		}
+		case CFG_CLEAR_SCREEN:
+			if (xargs.clear_screen != UNSET)
+				break;
+			set_config_bool_value(val, &conf.clear_screen);
+			break;
 
-		else if (xargs.color_lnk_as_target == UNSET && *line == 'C'
-		&& strncmp(line, "ColorLinksAsTarget=", 19) == 0) {
-			set_config_bool_value(line + 19, &conf.color_lnk_as_target);
-		}
+		case CFG_COLOR_LNK_AS_TARGET:
+			if (xargs.color_lnk_as_target != UNSET)
+				break;
+			set_config_bool_value(val, &conf.color_lnk_as_target);
+			break;
 
-		else if (!conf.usr_cscheme && *line == 'C'
-		&& strncmp(line, "ColorScheme=", 12) == 0) {
-			set_colorscheme(line + 12);
-		}
+		case CFG_COLOR_SCHEME:
+			if (conf.usr_cscheme)
+				break;
+			set_colorscheme(val);
+			break;
 
-		else if (*line == 'c' && strncmp(line, "cpCmd=", 6) == 0) {
-			set_config_int_value(line + 6, &conf.cp_cmd,
-				0, CP_CMD_AVAILABLE - 1);
-		}
+		case CFG_CP_CMD:
+			set_config_int_value(val, &conf.cp_cmd, 0, CP_CMD_AVAILABLE - 1);
+			break;
 
-		else if (xargs.desktop_notifications == UNSET && *line == 'D'
-		&& strncmp(line, "DesktopNotifications=", 21) == 0) {
-			set_config_bool_value(line + 21, &conf.desktop_notifications);
-		}
+		case CFG_DESKTOP_NOTIFICATIONS:
+			if (xargs.desktop_notifications != UNSET)
+				break;
+			set_config_bool_value(val, &conf.desktop_notifications);
+			break;
 
-		else if (xargs.dirmap == UNSET && *line == 'D'
-		&& strncmp(line, "DirhistMap=", 11) == 0) {
-			set_config_bool_value(line + 11, &conf.dirhist_map);
-		}
+		case CFG_DIRHIST_MAP:
+			if (xargs.dirmap != UNSET)
+				break;
+			set_config_bool_value(val, &conf.dirhist_map);
+			break;
 
-		else if (*line == 'D' && strncmp(line, "DirhistIgnore=", 14) == 0) {
-			set_dirhistignore_pattern(line + 14);
-		}
+		case CFG_DIRHIST_IGNORE:
+			set_dirhistignore_pattern(val);
+			break;
 
-		else if (xargs.disk_usage == UNSET && *line == 'D'
-		&& strncmp(line, "DiskUsage=", 10) == 0) {
-			set_config_bool_value(line + 10, &conf.disk_usage);
-		}
+		case CFG_DISK_USAGE:
+			if (xargs.disk_usage != UNSET)
+				break;
+			set_config_bool_value(val, &conf.disk_usage);
+			break;
 
-		else if (*line == 'D' && strncmp(line, "DividingLine=", 13) == 0) {
-			set_div_line(line + 13);
-		}
+		case CFG_DIVIDING_LINE:
+			set_div_line(val);
+			break;
 
-		else if (xargs.ext == UNSET && *line == 'E'
-		&& strncmp(line, "ExternalCommands=", 17) == 0) {
-			set_config_bool_value(line + 17, &conf.ext_cmd_ok);
-		}
+		case CFG_EXTERNAL_COMMANDS:
+			if (xargs.ext != UNSET)
+				break;
+			set_config_bool_value(val, &conf.ext_cmd_ok);
+			break;
 
-		else if (xargs.files_counter == UNSET && *line == 'F'
-		&& strncmp(line, "FilesCounter=", 13) == 0) {
-			set_config_bool_value(line + 13, &conf.files_counter);
-		}
+		case CFG_FILES_COUNTER:
+			if (xargs.files_counter != UNSET)
+				break;
+			set_config_bool_value(val, &conf.files_counter);
+			break;
 
-		else if (!filter.str && *line == 'F'
-		&& strncmp(line, "Filter=", 7) == 0) {
-			if (set_files_filter(line) == -1)
-				continue;
-		}
+		case CFG_FILTER:
+			if (filter.str)
+				break;
+			set_files_filter(line);
+			break;
 
-		else if (xargs.full_dir_size == UNSET && *line == 'F'
-		&& strncmp(line, "FullDirSize=", 12) == 0) {
-			set_config_bool_value(line + 12, &conf.full_dir_size);
-		}
+		case CFG_FULL_DIR_SIZE:
+			if (xargs.full_dir_size != UNSET)
+				break;
+			set_config_bool_value(val, &conf.full_dir_size);
+			break;
 
-		else if (xargs.fuzzy_match_algo == UNSET && *line == 'F'
-		&& strncmp(line, "FuzzyAlgorithm=", 15) == 0) {
-			set_config_int_value(line + 15, &conf.fuzzy_match_algo,
+		case CFG_FUZZY_ALGORITHM:
+			if (xargs.fuzzy_match_algo != UNSET)
+				break;
+			set_config_int_value(val, &conf.fuzzy_match_algo,
 				1, FUZZY_ALGO_MAX);
-		}
+			break;
 
-		else if (xargs.fuzzy_match == UNSET && *line == 'F'
-		&& strncmp(line, "FuzzyMatching=", 14) == 0) {
-			set_config_bool_value(line + 14, &conf.fuzzy_match);
-		}
+		case CFG_FUZZY_MATCHING:
+			if (xargs.fuzzy_match != UNSET)
+				break;
+			set_config_bool_value(val, &conf.fuzzy_match);
+			break;
 
-		else if (xargs.fzf_preview == UNSET && *line == 'F'
-		&& strncmp(line, "FzfPreview=", 11) == 0) {
-			if (set_fzf_preview_value(line, &conf.fzf_preview) == -1)
-				continue;
-		}
+		case CFG_FZF_PREVIEW:
+			if (xargs.fzf_preview != UNSET)
+				break;
+			set_fzf_preview_value(line, &conf.fzf_preview);
+			break;
 
-		else if (*line == 'H' && strncmp(line, "HistIgnore=", 11) == 0) {
-			set_histignore_pattern(line + 11);
-		}
+		case CFG_HIST_IGNORE:
+			set_histignore_pattern(val);
+			break;
 
 #ifndef _NO_ICONS
-		else if (xargs.icons == UNSET && *line == 'I'
-		&& strncmp(line, "Icons=", 6) == 0) {
-			set_config_bool_value(line + 6, &conf.icons);
-		}
-#endif /* !_NO_ICONS */
+		case CFG_ICONS:
+			if (xargs.icons != UNSET)
+				break;
+			set_config_bool_value(val, &conf.icons);
+			break;
 
-		else if (xargs.light == UNSET && *line == 'L'
-		&& strncmp(line, "LightMode=", 10) == 0) {
-			set_config_bool_value(line + 10, &conf.light_mode);
-		}
+#endif /* !_NO_ICONS */
+		case CFG_LIGHT_MODE:
+			if (xargs.light != UNSET)
+				break;
+			set_config_bool_value(val, &conf.light_mode);
+			break;
 
-		else if (xargs.dirs_first == UNSET && *line == 'L'
-		&& strncmp(line, "ListDirsFirst=", 14) == 0) {
-			set_config_bool_value(line + 14, &conf.list_dirs_first);
-		}
+		case CFG_LIST_DIRS_FIRST:
+			if (xargs.dirs_first != UNSET)
+				break;
+			set_config_bool_value(val, &conf.list_dirs_first);
+			break;
 
-		else if (xargs.horizontal_list == UNSET && *line == 'L'
-		&& strncmp(line, "ListingMode=", 12) == 0) {
+		case CFG_LISTING_MODE:
+			if (xargs.horizontal_list != UNSET)
+				break;
 			set_listing_mode(line);
-		}
+			break;
 
-		else if (xargs.longview == UNSET && *line == 'L'
-		&& strncmp(line, "LongViewMode=", 13) == 0) {
-			set_config_bool_value(line + 13, &conf.long_view);
-		}
+		case CFG_LONG_VIEW_MODE:
+			if (xargs.longview != UNSET)
+				break;
+			set_config_bool_value(val, &conf.long_view);
+			break;
 
-		////////// DEPRECATED!!
-		else if (*line == 'L' && strncmp(line, "Logs=", 5) == 0) {
-			set_config_bool_value(line + 5, &conf.log_msgs);
-		}
-		//////////
+		case CFG_LOGS:
+			set_config_bool_value(val, &conf.log_msgs);
+			break;
 
-		else if (*line == 'L' && strncmp(line, "LogMsgs=", 8) == 0) {
-			set_config_bool_value(line + 8, &conf.log_msgs);
-		}
+		case CFG_LOG_MSGS:
+			set_config_bool_value(val, &conf.log_msgs);
+			break;
 
-		else if (*line == 'L' && strncmp(line, "LogCmds=", 8) == 0) {
-			set_config_bool_value(line + 8, &conf.log_cmds);
-		}
+		case CFG_LOG_CMDS:
+			set_config_bool_value(val, &conf.log_cmds);
+			break;
 
-		else if (xargs.max_dirhist == UNSET && *line == 'M'
-		&& strncmp(line, "MaxDirhist=", 11) == 0) {
-			set_config_int_value(line + 11, &conf.max_dirhist, 0, INT_MAX);
-		}
+		case CFG_MAX_DIRHIST:
+			if (xargs.max_dirhist != UNSET)
+				break;
+			set_config_int_value(val, &conf.max_dirhist, 0, INT_MAX);
+			break;
 
-		else if (*line == 'M' && strncmp(line, "MaxFilenameLen=", 15) == 0) {
-			set_config_int_value(line + 15, &conf.max_name_len, 1, INT_MAX);
-		}
+		case CFG_MAX_FILENAME_LEN:
+			set_config_int_value(val, &conf.max_name_len, 1, INT_MAX);
+			break;
 
-		else if (*line == 'M' && strncmp(line, "MaxHistory=", 11) == 0) {
-			set_config_int_value(line + 11, &conf.max_hist, 1, INT_MAX);
-		}
+		case CFG_MAX_HISTORY:
+			set_config_int_value(val, &conf.max_hist, 1, INT_MAX);
+			break;
 
-		else if (*line == 'M' && strncmp(line, "MaxJumpTotalRank=", 17) == 0) {
-			set_config_int_value(line + 17, &conf.max_jump_total_rank,
-				1, INT_MAX);
-		}
+		case CFG_MAX_JUMP_TOTAL_RANK:
+			set_config_int_value(val, &conf.max_jump_total_rank, 1, INT_MAX);
+			break;
 
-		else if (*line == 'M' && strncmp(line, "MaxLog=", 7) == 0) {
-			set_config_int_value(line + 7, &conf.max_log, 1, INT_MAX);
-		}
+		case CFG_MAX_LOG:
+			set_config_int_value(val, &conf.max_log, 1, INT_MAX);
+			break;
 
-		else if (xargs.max_path == UNSET && *line == 'M'
-		&& strncmp(line, "MaxPath=", 8) == 0) {
-			set_config_int_value(line + 8, &conf.max_path, 1, INT_MAX);
-		}
+		case CFG_MAX_PATH:
+			if (xargs.max_path != UNSET)
+				break;
+			set_config_int_value(val, &conf.max_path, 1, INT_MAX);
+			break;
 
-		else if (*line == 'M' && strncmp(line, "MaxPrintSelfiles=", 17) == 0) {
-			set_config_int_value(line + 17, &conf.max_printselfiles,
-				-1, INT_MAX);
-		}
+		case CFG_MAX_PRINTSELFILES:
+			set_config_int_value(val, &conf.max_printselfiles, -1, INT_MAX);
+			break;
 
-		else if (*line == 'M' && strncmp(line, "MinFilenameTrim=", 16) == 0) {
-			set_config_int_value(line + 16, &conf.min_name_trim, 1, INT_MAX);
-		}
+		case CFG_MIN_FILENAME_TRIM:
+			set_config_int_value(val, &conf.min_name_trim, 1, INT_MAX);
+			break;
 
-		else if (*line == 'M' && strncmp(line, "MinJumpRank=", 12) == 0) {
-			set_config_int_value(line + 12, &conf.min_jump_rank, -1, INT_MAX);
-		}
+		case CFG_MIN_JUMP_RANK:
+			set_config_int_value(val, &conf.min_jump_rank, -1, INT_MAX);
+			break;
 
-		else if (*line == 'm' && strncmp(line, "mvCmd=", 6) == 0) {
-			set_config_int_value(line + 6, &conf.mv_cmd,
-				0, MV_CMD_AVAILABLE - 1);
-		}
+		case CFG_MV_CMD:
+			set_config_int_value(val, &conf.mv_cmd, 0, MV_CMD_AVAILABLE - 1);
+			break;
 
-		else if (!conf.opener && *line == 'O'
-		&& strncmp(line, "Opener=", 7) == 0) {
-			char *tmp = get_line_value(line + 7);
+		case CFG_OPENER: {
+			if (conf.opener)
+				break;
+			char *tmp = get_line_value(val);
 			if (!tmp)
-				continue;
+				break;
 			free(conf.opener);
 			conf.opener = savestring(tmp, strlen(tmp));
+			break;
 		}
 
-		else if (xargs.pager == UNSET && *line == 'P'
-		&& strncmp(line, "Pager=", 6) == 0) {
-			set_pager_value(line + 6, &conf.pager, sizeof(line) - 6);
-		}
+		case CFG_PAGER:
+			if (xargs.pager != UNSET)
+				break;
+			set_pager_value(val, &conf.pager, line_len - kw_len);
+			break;
 
-		else if (xargs.pager_view == UNSET && *line == 'P'
-		&& strncmp(line, "PagerView=", 10) == 0) {
-			set_pager_view_value(line + 10);
-		}
+		case CFG_PAGER_VIEW:
+			if (xargs.pager_view != UNSET)
+				break;
+			set_pager_view_value(val);
+			break;
 
-		else if (xargs.printsel == UNSET && *line == 'P'
-		&& strncmp(line, "PrintSelfiles=", 14) == 0) {
-			set_config_bool_value(line + 14, &conf.print_selfiles);
-		}
+		case CFG_PRINT_SELFILES:
+			if (xargs.printsel != UNSET)
+				break;
+			set_config_bool_value(val, &conf.print_selfiles);
+			break;
 
-		else if (*line == 'P'
-		&& strncmp(line, "PrivateWorkspaceSettings=", 25) == 0) {
-			set_config_bool_value(line + 25, &conf.private_ws_settings);
-		}
+		case CFG_PRIVATE_WS_SETTINGS:
+			set_config_bool_value(val, &conf.private_ws_settings);
+			break;
 
-		else if (!*prop_fields_str && *line == 'P'
-		&& strncmp(line, "PropFields=", 11) == 0) {
-			char *tmp = get_line_value(line + 11);
+		case CFG_PROP_FIELDS: {
+			if (*prop_fields_str)
+				break;
+			char *tmp = get_line_value(val);
 			if (tmp)
 				xstrsncpy(prop_fields_str, tmp, sizeof(prop_fields_str));
+			break;
 		}
 
-		else if (*line == 'P' && strncmp(line, "PropFieldsGap=", 14) == 0) {
-			set_config_int_value(line + 14, &conf.prop_fields_gap, 1, 2);
-		}
+		case CFG_PROP_FIELDS_GAP:
+			set_config_int_value(val, &conf.prop_fields_gap, 1, 2);
+			break;
 
-		else if (xargs.ptime_style == UNSET && *line == 'P'
-		&& strncmp(line, "PTimeStyle=", 11) == 0) {
-			set_time_style(line + 11, &conf.ptime_str, 1);
-		}
+		case CFG_PTIME_STYLE:
+			if (xargs.ptime_style != UNSET)
+				break;
+			set_time_style(val, &conf.ptime_str, 1);
+			break;
 
-		else if (*line == 'P' && strncmp(line, "PurgeJumpDB=", 12) == 0) {
-			set_config_bool_value(line + 12, &conf.purge_jumpdb);
-		}
+		case CFG_PURGE_JUMPDB:
+			set_config_bool_value(val, &conf.purge_jumpdb);
+			break;
 
-		else if (*line == 'Q' && strncmp(line, "QuotingStyle=", 13) == 0) {
-			set_quoting_style(line + 13);
-		}
+		case CFG_QUOTING_STYLE:
+			set_quoting_style(val);
+			break;
 
-		else if (*line == 'R' && strncmp(line, "ReadAutocmdFiles=", 17) == 0) {
-			set_config_bool_value(line + 17, &conf.read_autocmd_files);
-		}
+		case CFG_READ_AUTOCMD_FILES:
+			set_config_bool_value(val, &conf.read_autocmd_files);
+			break;
 
-		else if (*line == 'R' && strncmp(line, "ReadDotHidden=", 14) == 0) {
-			set_config_bool_value(line + 14, &conf.read_dothidden);
-		}
+		case CFG_READ_DOTHIDDEN:
+			set_config_bool_value(val, &conf.read_dothidden);
+			break;
 
-		else if (xargs.readonly == UNSET && *line == 'R'
-		&& strncmp(line, "Readonly=", 9) == 0) {
-			set_config_bool_value(line + 9, &conf.readonly);
-		}
+		case CFG_READONLY:
+			if (xargs.readonly != UNSET)
+				break;
+			set_config_bool_value(val, &conf.readonly);
+			break;
 
-		else if (xargs.restore_last_path == UNSET && *line == 'R'
-		&& strncmp(line, "RestoreLastPath=", 16) == 0) {
-			set_config_bool_value(line + 16, &conf.restore_last_path);
-		}
+		case CFG_RESTORE_LAST_PATH:
+			if (xargs.restore_last_path != UNSET)
+				break;
+			set_config_bool_value(val, &conf.restore_last_path);
+			break;
 
-		else if (*line == 'R' && strncmp(line, "RlEditMode=", 11) == 0) {
-			if (*(line + 11) == '0')
+		case CFG_RL_EDIT_MODE:
+			if (*val == '0')
 				rl_vi_editing_mode(1, 0);
 			else
 				rl_emacs_editing_mode(1, 0);
-		}
+			break;
 
-		else if (*line == 'r' && strncmp(line, "rmForce=", 8) == 0) {
-			set_config_bool_value(line + 8, &conf.rm_force);
-		}
+		case CFG_RM_FORCE:
+			set_config_bool_value(val, &conf.rm_force);
+			break;
 
-		else if (*line == 'S' && strncmp(line, "SearchStrategy=", 15) == 0) {
-			set_search_strategy(line + 15);
-		}
+		case CFG_SEARCH_STRATEGY:
+			set_search_strategy(val);
+			break;
 
-		else if (xargs.share_selbox == UNSET && *line == 'S'
-		&& strncmp(line, "ShareSelbox=", 12) == 0) {
-			set_config_bool_value(line + 12, &conf.share_selbox);
-		}
+		case CFG_SHARE_SELBOX:
+			if (xargs.share_selbox != UNSET)
+				break;
+			set_config_bool_value(val, &conf.share_selbox);
+			break;
 
-		else if (xargs.hidden == UNSET && *line == 'S'
-		&& strncmp(line, "ShowHiddenFiles=", 16) == 0) {
-			set_config_bool_value(line + 16, &conf.show_hidden);
-		}
+		case CFG_SHOW_HIDDEN_FILES:
+			if (xargs.hidden != UNSET)
+				break;
+			set_config_bool_value(val, &conf.show_hidden);
+			break;
 
-		else if (*line == 'S'
-		&& strncmp(line, "SkipNonAlnumPrefix=", 19) == 0) {
-			set_config_bool_value(line + 19, &conf.skip_non_alnum_prefix);
-		}
+		case CFG_SKIP_NON_ALNUM_PREFIX:
+			set_config_bool_value(val, &conf.skip_non_alnum_prefix);
+			break;
 
-		else if (xargs.sort == UNSET && *line == 'S'
-		&& strncmp(line, "Sort=", 5) == 0) {
-			if (!IS_DIGIT(line[5]))
-				set_sort_name(line + 5);
+		case CFG_SORT:
+			if (xargs.sort != UNSET)
+				break;
+			if (!IS_DIGIT(*val))
+				set_sort_name(val);
 			else
-				set_config_int_value(line + 5, &conf.sort, 0, SORT_TYPES);
-		}
+				set_config_int_value(val, &conf.sort, 0, SORT_TYPES);
+			break;
 
-		else if (xargs.sort_reverse == UNSET && *line == 'S'
-		&& strncmp(line, "SortReverse=", 12) == 0) {
-			set_config_bool_value(line + 12, &conf.sort_reverse);
-		}
+		case CFG_SORT_REVERSE:
+			if (xargs.sort_reverse != UNSET)
+				break;
+			set_config_bool_value(val, &conf.sort_reverse);
+			break;
 
-		else if (xargs.splash == UNSET && *line == 'S'
-		&& strncmp(line, "SplashScreen=", 13) == 0) {
-			set_config_bool_value(line + 13, &conf.splash_screen);
-		}
+		case CFG_SPLASH_SCREEN:
+			if (xargs.splash != UNSET)
+				break;
+			set_config_bool_value(val, &conf.splash_screen);
+			break;
 
-		else if (xargs.path == UNSET && cur_ws == UNSET && *line == 'S'
-		&& strncmp(line, "StartingPath=", 13) == 0) {
-			set_starting_path(line + 13);
-		}
+		case CFG_STARTING_PATH:
+			if (xargs.path != UNSET || cur_ws != UNSET)
+				break;
+			set_starting_path(val);
+			break;
 
 #ifndef _NO_SUGGESTIONS
-		else if (*line == 'S' && strncmp(line, "SuggestCmdDesc=", 15) == 0) {
-			set_config_bool_value(line + 15, &conf.cmd_desc_sug);
-		}
+		case CFG_SUGGEST_CMD_DESC:
+			set_config_bool_value(val, &conf.cmd_desc_sug);
+			break;
 
-		else if (*line == 'S'
-		&& strncmp(line, "SuggestFiletypeColor=", 21) == 0) {
-			set_config_bool_value(line + 21, &conf.suggest_filetype_color);
-		}
+		case CFG_SUGGEST_FILETYPE_COLOR:
+			set_config_bool_value(val, &conf.suggest_filetype_color);
+			break;
 
-		else if (*line == 'S'
-		&& strncmp(line, "SuggestionStrategy=", 19) == 0) {
-			set_sug_strat(line + 19);
-		}
-#endif /* !_NO_SUGGESTIONS */
+		case CFG_SUGGESTION_STRATEGY:
+			set_sug_strat(val);
+			break;
 
+#endif /* !_NO_SUGGESTIONS */
 #ifndef _NO_HIGHLIGHT
-		else if (xargs.highlight == UNSET && *line == 'S'
-		&& strncmp(line, "SyntaxHighlighting=", 19) == 0) {
-			set_config_bool_value(line + 19, &conf.highlight);
-		}
-#endif /* !_NO_HIGHLIGHT */
+		case CFG_SYNTAX_HIGHLIGHTING:
+			if (xargs.highlight != UNSET)
+				break;
+			set_config_bool_value(val, &conf.highlight);
+			break;
 
+#endif /* !_NO_HIGHLIGHT */
 #ifndef _NO_FZF
-		else if (xargs.fzftab == UNSET
-		&& xargs.fnftab == UNSET && xargs.smenutab == UNSET
-		&& *line == 'T' && strncmp(line, "TabCompletionMode=", 18) == 0) {
-			set_tabcomp_mode(line + 18);
-		}
-#endif /* !_NO_FZF */
-
-		else if (*line == 'T' && strncmp(line, "TerminalCmd=", 12) == 0) {
-			char *opt = line + 12;
-			if (!*opt)
-				continue;
+		case CFG_TAB_COMPLETION_MODE:
+			if (xargs.fzftab != UNSET || xargs.fnftab != UNSET
+			|| xargs.smenutab != UNSET)
+				break;
+			set_tabcomp_mode(val);
+			break;
 
-			char *tmp = remove_quotes(opt);
+#endif /* !_NO_FZF */
+		case CFG_TERMINAL_CMD: {
+			if (!*val)
+				break;
+			char *tmp = remove_quotes(val);
 			if (!tmp)
-				continue;
-
+				break;
 			free(conf.term);
 			conf.term = savestring(tmp, strlen(tmp));
+			break;
 		}
 
-		else if (xargs.time_style == UNSET && *line == 'T'
-		&& strncmp(line, "TimeStyle=", 10) == 0) {
-			set_time_style(line + 10, &conf.time_str, 0);
-		}
+		case CFG_TIME_STYLE:
+			if (xargs.time_style != UNSET)
+				break;
+			set_time_style(val, &conf.time_str, 0);
+			break;
 
-		else if (xargs.tips == UNSET && *line == 'T'
-		&& strncmp(line, "Tips=", 5) == 0) {
-			set_config_bool_value(line + 5, &conf.tips);
-		}
+		case CFG_TIPS:
+			if (xargs.tips != UNSET)
+				break;
+			set_config_bool_value(val, &conf.tips);
+			break;
 
 #ifndef _NO_TRASH
-		else if (xargs.trasrm == UNSET && *line == 'T'
-		&& strncmp(line, "TrashAsRm=", 10) == 0) {
-			set_config_bool_value(line + 10, &conf.tr_as_rm);
-		}
-#endif /* !_NO_TRASH */
+		case CFG_TRASH_AS_RM:
+			if (xargs.trasrm != UNSET)
+				break;
+			set_config_bool_value(val, &conf.tr_as_rm);
+			break;
 
-		else if (xargs.trim_names == UNSET && *line == 'T'
-		&& strncmp(line, "TrimNames=", 10) == 0) {
-			set_config_bool_value(line + 10, &conf.trim_names);
-		}
+#endif /* !_NO_TRASH */
+		case CFG_TRIM_NAMES:
+			if (xargs.trim_names != UNSET)
+				break;
+			set_config_bool_value(val, &conf.trim_names);
+			break;
 
-		else if (*line == 'U' && strncmp(line, "Unicode=", 8) == 0) {
-			set_config_bool_value(line + 8, &conf.unicode);
-		}
+		case CFG_UNICODE:
+			set_config_bool_value(val, &conf.unicode);
+			break;
 
-		else if (xargs.secure_env != 1 && xargs.secure_env_full != 1
-		&& *line == 'U' && strncmp(line, "Umask=", 6) == 0) {
+		case CFG_UMASK: {
+			if (xargs.secure_env == 1 || xargs.secure_env_full == 1)
+				break;
 			unsigned int opt_num = MAX_UMASK + 1;
-			ret = sscanf(line + 6, "%o\n", &opt_num);
+			ret = sscanf(val, "%o\n", &opt_num);
 			if (ret == -1 || opt_num > MAX_UMASK)
-				continue;
+				break;
 			umask((mode_t)opt_num);
+			break;
 		}
 
-		else if (xargs.welcome_message == UNSET && *line == 'W'
-			&& strncmp(line, "WelcomeMessage=", 15) == 0) {
-			set_config_bool_value(line + 15, &conf.welcome_message);
-		}
+		case CFG_WELCOME_MESSAGE:
+			if (xargs.welcome_message != UNSET)
+				break;
+			set_config_bool_value(val, &conf.welcome_message);
+			break;
 
-		else if (*line == 'W' && strncmp(line, "WelcomeMessageStr=", 18) == 0) {
-			char *tmp = get_line_value(line + 18);
+		case CFG_WELCOME_MESSAGE_STR: {
+			char *tmp = get_line_value(val);
 			if (!tmp)
-				continue;
+				break;
 			free(conf.welcome_message_str);
 			conf.welcome_message_str = savestring(tmp, strlen(tmp));
+			break;
 		}
 
-		else {
-			if (*line == 'W' && strncmp(line, "WorkspaceNames=", 15) == 0)
-				set_workspace_names(line + 15);
+		case CFG_WORKSPACE_NAMES:
+			set_workspace_names(val);
+			break;
+
+		default: break;
 		}
 	}
 
-	fclose(config_fp);
+	free(buf);
 
 	if (xargs.disk_usage_analyzer == 1) {
 		conf.sort = STSIZE;
@@ -3394,6 +3759,7 @@ read_config(void)
 			filter.str = (char *)NULL;
 			regfree(&regex_exp);
 		}
+		set_filter_literal();
 	}
 
 	return;
@@ -3447,6 +3813,7 @@ check_colors(void)
 
 	reset_filetype_colors();
 	reset_iface_colors();
+	invalidate_cscheme_cache();
 	cur_color = tx_c;
 }
 
@@ -3593,6 +3960,10 @@ set_trash_dirs(void)
 static void
 undef_config_file_names(void)
 {
+	/* The history file is about to be forgotten (e.g., profile switch):
+	 * write out whatever is pending first. */
+	flush_cmdhist();
+
 	free(config_dir_gral); config_dir_gral = (char *)NULL;
 	free(config_dir); config_dir = (char *)NULL;
 	free(tags_dir); tags_dir = (char *)NULL;
@@ -3601,6 +3972,7 @@ undef_config_file_names(void)
 	free(plugins_dir); plugins_dir = (char *)NULL;
 	free(dirhist_file); dirhist_file = (char *)NULL;
 	free(bm_file); bm_file = (char *)NULL;
+	close_log_streams();
 	free(msgs_log_file); msgs_log_file = (char *)NULL;
 	free(cmds_log_file); cmds_log_file = (char *)NULL;
 	free(hist_file); hist_file = (char *)NULL;
@@ -3700,6 +4072,7 @@ free_regex_filters(void)
 		filter.str = (char *)NULL;
 		filter.rev = 0;
 		filter.type = FILTER_NONE;
+		set_filter_literal();
 	}
 
 	if (conf.histignore_regex) {
@@ -3736,6 +4109,7 @@ reset_variables(void)
 #endif /* !_NO_TRASH */
 
 	free(bm_file);
+	close_log_streams();
 	free(msgs_log_file);
 	free(cmds_log_file);
 	bm_file = msgs_log_file = cmds_log_file = (char *)NULL;
@@ -3924,6 +4298,7 @@ reload_config(void)
 
 	dirhist_total_index = 0;
 	prompt_cmds_n = 0;
+	dirhist_index_invalidate();
 
 	get_aliases();
 	get_prompt_cmds();
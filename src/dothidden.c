@@ -33,11 +33,65 @@
 #include <stdio.h>  /* fgets, fopen, fclose, fseek */
 #include <string.h> /* strcmp, strlen */
 
-#include "aux.h"       /* xnmalloc, open_fread */
+#include "aux.h"       /* xnmalloc, open_fread, hashme */
 #include "checks.h"    /* check_glob_char */
 #include "dothidden.h" /* dothidden_t, DOTHIDDEN_FILE */
 #include "strings.h"   /* savestring */
 
+/* Cache of the most recently parsed .hidden list, keyed by the file's
+ * device, inode, modification time, and size, so that refreshing a
+ * directory does not re-read and re-parse the same file. Lists containing
+ * wildcards are never cached: their expansion depends on the directory
+ * contents, not only on the .hidden file itself.
+ * A hash set over the names (DH_SET slots hold index + 1 into the list,
+ * zero meaning a free slot) replaces the linear scan in
+ * check_dothidden() by a constant time lookup. The set is built for the
+ * last loaded list, cached or not (DH_SET_OWNER tells which one). */
+static struct dothidden_t *dh_cache = (struct dothidden_t *)NULL;
+static struct dothidden_t *dh_set_owner = (struct dothidden_t *)NULL;
+static size_t *dh_set = (size_t *)NULL;
+static size_t dh_set_cap = 0;
+static dev_t dh_dev = 0;
+static ino_t dh_ino = 0;
+static time_t dh_mtime = 0;
+static off_t dh_size = 0;
+
+/* Free the dot-hidden list H (list entries plus the list itself). */
+static void
+free_dh_list(struct dothidden_t *h)
+{
+	size_t i;
+	for (i = 0; h[i].name; i++)
+		free(h[i].name);
+
+	free(h);
+}
+
+/* Build the hash set over the names in the list H. */
+static void
+build_dh_set(struct dothidden_t *h)
+{
+	size_t n = 0;
+	while (h[n].name)
+		n++;
+
+	dh_set_cap = 32;
+	while (dh_set_cap < n * 2)
+		dh_set_cap <<= 1;
+
+	free(dh_set);
+	dh_set = xcalloc(dh_set_cap, sizeof(size_t));
+	dh_set_owner = h;
+
+	size_t i;
+	for (i = 0; i < n; i++) {
+		size_t s = hashme(h[i].name, 1) & (dh_set_cap - 1);
+		while (dh_set[s] != 0)
+			s = (s + 1) & (dh_set_cap - 1);
+		dh_set[s] = i + 1;
+	}
+}
+
 /* Read .hidden file in the current directory and return a struct containing
  * the names of the files listed in it, expanding wildacards, if any.
  * Empty lines and lines containing a slash are ignored.
@@ -51,9 +105,20 @@ load_dothidden(void)
 	struct stat a;
 
 	if (lstat(DOTHIDDEN_FILE, &a) == -1 || !S_ISREG(a.st_mode)
-	|| a.st_size == 0 || !(fp = open_fread(DOTHIDDEN_FILE, &fd)))
+	|| a.st_size == 0)
+		return h;
+
+	if (dh_cache && a.st_dev == dh_dev && a.st_ino == dh_ino
+	&& a.st_mtime == dh_mtime && a.st_size == dh_size) {
+		if (dh_set_owner != dh_cache)
+			build_dh_set(dh_cache);
+		return dh_cache;
+	}
+
+	if (!(fp = open_fread(DOTHIDDEN_FILE, &fd)))
 		return h;
 
+	int globs_found = 0;
 	char line[NAME_MAX + 1];
 	size_t lines = 0;
 	while (fgets(line, 2, fp) != NULL)
@@ -87,6 +152,7 @@ load_dothidden(void)
 		}
 
 		/* We have wildcards. Expand it. */
+		globs_found = 1;
 		glob_t gbuf;
 		if (glob(line, GLOB_BRACE, NULL, &gbuf) != 0) {
 			globfree(&gbuf);
@@ -116,6 +182,19 @@ load_dothidden(void)
 	h[counter].len = 0;
 
 	fclose(fp);
+
+	build_dh_set(h);
+
+	if (globs_found == 0) {
+		if (dh_cache)
+			free_dh_list(dh_cache);
+		dh_cache = h;
+		dh_dev = a.st_dev;
+		dh_ino = a.st_ino;
+		dh_mtime = a.st_mtime;
+		dh_size = a.st_size;
+	}
+
 	return h;
 }
 
@@ -130,6 +209,19 @@ check_dothidden(const char *restrict name, struct dothidden_t **h)
 	const size_t namelen = strlen(name);
 	size_t i;
 
+	if (*h == dh_set_owner && dh_set) {
+		size_t s = hashme(name, 1) & (dh_set_cap - 1);
+		while (dh_set[s] != 0) {
+			const struct dothidden_t *e = &(*h)[dh_set[s] - 1];
+			if (*name == *e->name && namelen == e->len
+			&& strcmp(name, e->name) == 0)
+				return 1;
+			s = (s + 1) & (dh_set_cap - 1);
+		}
+
+		return 0;
+	}
+
 	for (i = 0; (*h)[i].name; i++) {
 		if (*name == *(*h)[i].name && namelen == (*h)[i].len
 		&& strcmp(name, (*h)[i].name) == 0)
@@ -139,16 +231,26 @@ check_dothidden(const char *restrict name, struct dothidden_t **h)
 	return 0;
 }
 
-/* Free the dothidden_t struct H */
+/* Free the dothidden_t struct H, unless it is held by the cache, in
+ * which case it is kept for the next listing. */
 void
 free_dothidden(struct dothidden_t **h)
 {
 	if (!*h)
 		return;
 
-	size_t i;
-	for (i = 0; (*h)[i].name; i++)
-		free((*h)[i].name);
+	if (*h == dh_cache) {
+		*h = (struct dothidden_t *)NULL;
+		return;
+	}
+
+	if (*h == dh_set_owner) {
+		free(dh_set);
+		dh_set = (size_t *)NULL;
+		dh_set_cap = 0;
+		dh_set_owner = (struct dothidden_t *)NULL;
+	}
 
-	free(*h);
+	free_dh_list(*h);
+	*h = (struct dothidden_t *)NULL;
 }
@@ -48,6 +48,7 @@ typedef char *rl_cpvfunc_t;
 #include "aux.h"
 #include "bookmarks.h"
 #include "checks.h"
+#include "checksum.h"
 #include "colors.h"
 #include "config.h"
 #include "exec.h"
@@ -67,6 +68,7 @@ typedef char *rl_cpvfunc_t;
 # include "name_cleaner.h"
 #endif /* !_NO_BLEACH */
 #include "navigation.h"
+#include "perf.h"
 #ifndef _NO_PROFILES
 # include "profiles.h"
 #endif /* !_NO_PROFILES */
@@ -2059,6 +2061,74 @@ toggle_follow_links(const char *arg)
 	return FUNC_SUCCESS;
 }
 
+/* Fast path for pure-ELN input lines (e.g. "12"), by far the most frequent
+ * command in interactive sessions: resolve the ELN directly to the
+ * corresponding file_info entry and autocd/auto-open it, bypassing the
+ * input parser entirely (no allocations, and no stat(2) calls besides the
+ * single one performed by open_function() itself).
+ * Return -1 if STR is not a pure ELN, or cannot be safely handled here, in
+ * which case the caller must take the regular parsing path. Otherwise, the
+ * return value is the exit status of the executed command. */
+int
+eln_fast_open(char *str)
+{
+	if (!str || !*str || *str == '0' || files <= 0 || rl_dispatching == 1
+	|| (conf.autocd == 0 && conf.auto_open == 0))
+		return (-1);
+
+	filesn_t n = 0;
+	const char *p = str;
+	while (*p >= '0' && *p <= '9' && n <= files) {
+		n = (n * 10) + (*p - '0');
+		p++;
+	}
+
+	/* Accept only digits matching an ELN, plus at most a trailing slash. */
+	if (n < 1 || n > files || (*p != '\0' && (*p != '/' || p[1] != '\0')))
+		return (-1);
+
+	const filesn_t j = n - 1;
+	if (!file_info[j].name
+	/* Backslashes would be wrongly unescaped by open_function(). */
+	|| strchr(file_info[j].name, '\\'))
+		return (-1);
+
+	/* A number could still name an alias or an action: let the regular
+	 * path resolve those (both lists are almost always tiny). */
+	size_t i;
+	for (i = 0; i < aliases_n; i++)
+		if (aliases[i].name && strcmp(str, aliases[i].name) == 0)
+			return (-1);
+	for (i = 0; i < actions_n; i++)
+		if (usr_actions[i].name && strcmp(str, usr_actions[i].name) == 0)
+			return (-1);
+
+	const int is_dir = (file_info[j].dir == 1 || file_info[j].type == DT_DIR);
+	if (is_dir == 1 && conf.autocd == 0)
+		return (-1);
+	if (is_dir == 0 && (*p == '/' || conf.auto_open == 0
+	|| (file_info[j].type != DT_REG && file_info[j].type != DT_LNK)))
+		return (-1);
+
+	/* Same housekeeping as exec_cmd() */
+	if (zombies > 0)
+		check_zombies();
+	fputs(df_c, stdout);
+	stat_cache_invalidate();
+
+	perf_begin(PERF_EXEC);
+	int ret;
+	if (is_dir == 1) {
+		ret = cd_function(file_info[j].name, CD_PRINT_ERROR);
+	} else {
+		char *cmd[] = {"open", file_info[j].name, NULL};
+		ret = open_function(cmd);
+	}
+	perf_end(PERF_EXEC);
+
+	return (exit_code = ret);
+}
+
 /* Take the command entered by the user, already splitted into substrings
  * by parse_input_str(), and call the corresponding function. Return zero
  * in case of success and one in case of error
@@ -2068,13 +2138,16 @@ toggle_follow_links(const char *arg)
  * This will be the value returned by this function. Used by the \z
  * escape code in the prompt to print the exit status of the last
  * executed command */
-int
-exec_cmd(char **comm)
+static int
+exec_cmd_int(char **comm)
 {
 	if (zombies > 0)
 		check_zombies();
 	fputs(df_c, stdout);
 
+	/* The command may create/remove files: drop cached stat results. */
+	stat_cache_invalidate();
+
 	if (conf.readonly == 1 && is_write_cmd(
 	((*comm[0] == 's' && strcmp(comm[0] + 1, "udo") == 0)
 	|| (*comm[0] == 'd' && strcmp(comm[0] + 1, "oas") == 0))
@@ -2383,6 +2456,11 @@ exec_cmd(char **comm)
 #endif /* !_NO_BLEACH */
 	}
 
+	/*   ############# FILE VERIFICATION ##############    */
+	else if (*comm[0] == 'v' && ((comm[0][1] == 'f' && !comm[0][2])
+	|| strcmp(comm[0], "verify") == 0))
+		exit_code = verify_files(comm);
+
 	/*   ################ ARCHIVER ##################     */
 	else if (*comm[0] == 'a' && ((comm[0][1] == 'c' || comm[0][1] == 'd')
 	&& !comm[0][2])) {
@@ -2409,6 +2487,12 @@ exec_cmd(char **comm)
 	else if (*comm[0] == 's' && strcmp(comm[0], "stats") == 0)
 		return (exit_code = print_stats());
 
+	else if (*comm[0] == 'p' && strcmp(comm[0], "perf") == 0)
+		return (exit_code = perf_function(comm + 1));
+
+	else if (*comm[0] == 'm' && strcmp(comm[0], "mem") == 0)
+		return (exit_code = mem_function(comm + 1));
+
 	else if (*comm[0] == 'f' && ((comm[0][1] == 't' && !comm[0][2])
 	|| strcmp(comm[0], "filter") == 0))
 		return (exit_code = filter_function(comm[1]));
@@ -2654,6 +2738,18 @@ CHECK_EVENTS:
 	return exit_code;
 }
 
+/* Wrapper around exec_cmd_int(): account the time taken to dispatch and
+ * run the command whenever 'perf' instrumentation is enabled. */
+int
+exec_cmd(char **comm)
+{
+	perf_begin(PERF_EXEC);
+	const int ret = exec_cmd_int(comm);
+	perf_end(PERF_EXEC);
+
+	return ret;
+}
+
 static inline void
 run_chained_cmd(char **cmd, size_t *err_code)
 {
@@ -27,6 +27,7 @@
 
 __BEGIN_DECLS
 
+int  eln_fast_open(char *str);
 int  exec_cmd(char **comm);
 void exec_chained_cmds(char *cmd);
 void exec_profile(void);
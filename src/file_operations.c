@@ -24,15 +24,31 @@
 
 #include "helpers.h"
 
+#include <dirent.h> /* removal engine scan (see rme_scan_dir()) */
 #include <errno.h>
+#include <fcntl.h> /* unlinkat(2) */
+#include <pthread.h> /* parallel unlink phase (see remove_files_engine()) */
 #include <stdio.h>
 #include <string.h>
+#include <time.h> /* clock_gettime(2), copy engine progress/throughput */
 #include <unistd.h>
 #include <readline/readline.h>
 #ifdef __TINYC__
 # undef CHAR_MAX /* Silence redefinition error */
 #endif /* __TINYC__ */
 
+#if defined(__linux__) && !defined(_BE_POSIX)
+# if !defined(__GLIBC__) || (__GLIBC__ > 2 \
+|| (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+#  define CPE_COPY_FILE_RANGE /* copy_file_range(2): glibc >= 2.27 */
+# endif /* !__GLIBC__ || __GLIBC__ >= 2.27 */
+# include <sys/ioctl.h>
+# ifdef __TINYC__
+#  undef SYNC_FILE_RANGE_WRITE_AND_WAIT /* Silence redefinition error */
+# endif /* __TINYC__ */
+# include <linux/fs.h> /* FICLONE (reflink copies) */
+#endif /* __linux__ && !_BE_POSIX */
+
 #include "aux.h"
 #include "checks.h"
 #include "colors.h"
@@ -1325,6 +1341,480 @@ cwd_has_sel_files(void)
 	return 0;
 }
 
+/* Number of worker threads for the parallel engines below (copy and
+ * removal), capped at MAX. */
+static int
+fop_get_threads(const int max)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	const long p = sysconf(_SC_NPROCESSORS_ONLN);
+	if (p <= 1)
+		return 1;
+	return p > max ? max : (int)p;
+#else
+	UNUSED(max);
+	return 1;
+#endif /* _SC_NPROCESSORS_ONLN */
+}
+
+/* Copy engine
+ *
+ * Copies used to go entirely through cp(1): one process copying one file
+ * at a time, so that large trees move at a fraction of what the disks
+ * can actually deliver. The engine below scans the sources up front,
+ * recreates the directory skeleton, and then copies regular files from a
+ * pool of worker threads: each file is first reflinked (FICLONE) where
+ * the file system supports it, then moved via copy_file_range(2), and
+ * finally via a plain read/write loop with a reused per-worker buffer,
+ * each stage taking over where the previous one is not available.
+ *
+ * The engine only engages for the stock cp command (people who picked
+ * advcp/wcp/rsync chose those tools deliberately), only when no
+ * destination file exists (so that cp's -i prompting and directory merge
+ * semantics are never bypassed), and only for batches big enough to be
+ * worth it. Everything else, including any batch whose scan phase hits
+ * an error, falls back to cp(1), which implements the full semantics
+ * and properly reports the error. */
+
+#define CP_ENGINE_MIN_ENTRIES 64
+#define CP_ENGINE_MIN_BYTES   (64 * 1024 * 1024)
+#define CP_MAX_THREADS        16
+#define CPE_BUF_SIZE          (1024 * 1024) /* Read/write fallback buffer */
+#define CPE_PROGRESS_NSEC     100000000 /* Progress report interval (100ms) */
+
+/* Nano-second timestamps (as in properties.c) */
+#if defined(__NetBSD__) || defined(__APPLE__)
+# define CPE_ATIM st_atimespec
+# define CPE_MTIM st_mtimespec
+#else
+# define CPE_ATIM st_atim
+# define CPE_MTIM st_mtim
+#endif /* __NetBSD__ || __APPLE__ */
+
+struct cpe_t {
+	char **src;      /* Regular files to copy */
+	char **dst;
+	char **dirs_src; /* Dirs, pre-order (ancestors before descendants) */
+	char **dirs_dst;
+	char **lnks_src; /* Symlinks (recreated, not followed, as cp -R) */
+	char **lnks_dst;
+	size_t files_n, files_cap;
+	size_t dirs_n, dirs_cap;
+	size_t lnks_n, lnks_cap;
+	off_t total_bytes;
+};
+
+struct cpe_worker_t {
+	struct cpe_t *c;
+	size_t id;
+	size_t nthreads;
+	volatile size_t done;
+	volatile size_t fails;
+	volatile int finished;
+	int pad;
+};
+
+/* Append the SRC/DST pair to the parallel arrays SRCS/DSTS (N entries,
+ * CAP allocated), growing them as needed. */
+static void
+cpe_add(char ***srcs, char ***dsts, size_t *n, size_t *cap,
+	const char *src, const char *dst)
+{
+	if (*n >= *cap) {
+		*cap = *cap == 0 ? 128 : *cap * 2;
+		*srcs = xnrealloc(*srcs, *cap, sizeof(char *));
+		*dsts = xnrealloc(*dsts, *cap, sizeof(char *));
+	}
+
+	(*srcs)[*n] = savestring(src, strlen(src));
+	(*dsts)[*n] = savestring(dst, strlen(dst));
+	(*n)++;
+}
+
+static void
+cpe_free(struct cpe_t *c)
+{
+	size_t i;
+
+	for (i = 0; i < c->files_n; i++) {
+		free(c->src[i]);
+		free(c->dst[i]);
+	}
+	free(c->src);
+	free(c->dst);
+
+	for (i = 0; i < c->dirs_n; i++) {
+		free(c->dirs_src[i]);
+		free(c->dirs_dst[i]);
+	}
+	free(c->dirs_src);
+	free(c->dirs_dst);
+
+	for (i = 0; i < c->lnks_n; i++) {
+		free(c->lnks_src[i]);
+		free(c->lnks_dst[i]);
+	}
+	free(c->lnks_src);
+	free(c->lnks_dst);
+
+	*c = (struct cpe_t){0};
+}
+
+/* Record the copy SRC -> DST into C, descending into directories.
+ * Returns FUNC_FAILURE as soon as anything the engine does not handle
+ * shows up (existing destination, special file, unreadable entry): the
+ * caller falls back to cp(1). */
+static int
+cpe_scan(struct cpe_t *c, const char *src, const char *dst)
+{
+	struct stat a, b;
+	if (lstat(src, &a) == -1 || lstat(dst, &b) != -1)
+		return FUNC_FAILURE;
+
+	if (S_ISLNK(a.st_mode)) {
+		cpe_add(&c->lnks_src, &c->lnks_dst, &c->lnks_n, &c->lnks_cap,
+			src, dst);
+		return FUNC_SUCCESS;
+	}
+
+	if (S_ISREG(a.st_mode)) {
+		cpe_add(&c->src, &c->dst, &c->files_n, &c->files_cap, src, dst);
+		c->total_bytes += a.st_size;
+		return FUNC_SUCCESS;
+	}
+
+	if (!S_ISDIR(a.st_mode)) /* Sockets, FIFOs, devices: cp(1)'s business */
+		return FUNC_FAILURE;
+
+	cpe_add(&c->dirs_src, &c->dirs_dst, &c->dirs_n, &c->dirs_cap, src, dst);
+
+	DIR *dir = opendir(src);
+	if (!dir)
+		return FUNC_FAILURE;
+
+	const struct dirent *ent;
+	int ret = FUNC_SUCCESS;
+
+	while (ret == FUNC_SUCCESS && (ent = readdir(dir))) {
+		if (SELFORPARENT(ent->d_name))
+			continue;
+
+		char *s = xnmalloc(strlen(src) + strlen(ent->d_name) + 2,
+			sizeof(char));
+		sprintf(s, "%s/%s", src, ent->d_name); /* NOLINT */
+		char *d = xnmalloc(strlen(dst) + strlen(ent->d_name) + 2,
+			sizeof(char));
+		sprintf(d, "%s/%s", dst, ent->d_name); /* NOLINT */
+
+		ret = cpe_scan(c, s, d);
+
+		free(s);
+		free(d);
+	}
+
+	closedir(dir);
+	return ret;
+}
+
+/* Copy the regular file SRC to DST (which must not exist), preserving
+ * mode, timestamps, and (best-effort) ownership, as cp -p does. BUF is
+ * the caller's CPE_BUF_SIZE-byte buffer for the read/write fallback. */
+static int
+cpe_copy_file(const char *src, const char *dst, char *buf)
+{
+	struct stat a;
+	const int sfd = open(src, O_RDONLY);
+	if (sfd == -1)
+		return FUNC_FAILURE;
+
+	if (fstat(sfd, &a) == -1) {
+		close(sfd);
+		return FUNC_FAILURE;
+	}
+
+	const int dfd = open(dst, O_WRONLY | O_CREAT | O_EXCL, a.st_mode & 0777);
+	if (dfd == -1) {
+		close(sfd);
+		return FUNC_FAILURE;
+	}
+
+	int ok = 1;
+	off_t left = a.st_size;
+
+#ifdef FICLONE
+	if (left > 0 && ioctl(dfd, FICLONE, sfd) == 0)
+		left = 0; /* Reflinked: no data to move at all */
+#endif /* FICLONE */
+
+#ifdef CPE_COPY_FILE_RANGE
+	while (left > 0) {
+		const ssize_t w = copy_file_range(sfd, NULL, dfd, NULL,
+			(size_t)left, 0);
+		if (w <= 0) /* Unsupported here: the read/write loop takes over */
+			break;
+		left -= (off_t)w;
+	}
+#endif /* CPE_COPY_FILE_RANGE */
+
+	while (left > 0) {
+		const ssize_t r = read(sfd, buf, CPE_BUF_SIZE);
+		if (r <= 0) {
+			ok = 0;
+			break;
+		}
+
+		ssize_t off = 0;
+		while (off < r) {
+			const ssize_t w = write(dfd, buf + off, (size_t)(r - off));
+			if (w <= 0) {
+				ok = 0;
+				break;
+			}
+			off += w;
+		}
+
+		if (off < r)
+			break;
+		left -= (off_t)r;
+	}
+
+	if (ok == 1) {
+		/* open(2) filters the mode through the umask: restore it in full */
+		fchmod(dfd, a.st_mode & 07777);
+		if (fchown(dfd, a.st_uid, a.st_gid) == -1) {
+			/* Ownership is best-effort, just as with cp -p */
+		}
+		const struct timespec ts[2] = { a.CPE_ATIM, a.CPE_MTIM };
+		futimens(dfd, ts);
+	}
+
+	close(sfd);
+	close(dfd);
+	return ok == 1 ? FUNC_SUCCESS : FUNC_FAILURE;
+}
+
+/* Copy the regular files at indices ID, ID + NTHREADS, ... Errors are
+ * only counted here (no stdio from threads): they are reported once the
+ * pool is joined. */
+static void *
+cpe_worker(void *arg)
+{
+	struct cpe_worker_t *w = (struct cpe_worker_t *)arg;
+	const struct cpe_t *c = w->c;
+	char *buf = xnmalloc(CPE_BUF_SIZE, sizeof(char));
+
+	for (size_t i = w->id; i < c->files_n; i += w->nthreads) {
+		if (cpe_copy_file(c->src[i], c->dst[i], buf) != FUNC_SUCCESS)
+			w->fails++;
+		w->done++;
+	}
+
+	free(buf);
+	w->finished = 1;
+	return NULL;
+}
+
+/* Run the copy phase of the engine: fan the files in C out to a pool of
+ * NTHREADS workers, reporting progress while they run. Returns the
+ * number of files that could not be copied. */
+static size_t
+cpe_copy_parallel(struct cpe_t *c, const int nthreads)
+{
+	pthread_t threads[CP_MAX_THREADS];
+	struct cpe_worker_t workers[CP_MAX_THREADS];
+	int started = 0;
+
+	for (int t = 0; t < nthreads; t++) {
+		workers[t] = (struct cpe_worker_t){ .c = c, .id = (size_t)t,
+			.nthreads = (size_t)nthreads };
+		if (pthread_create(&threads[t], NULL, cpe_worker,
+		&workers[t]) != 0)
+			break;
+		started++;
+	}
+
+	while (started > 0) {
+		int running = 0;
+		size_t done = 0;
+
+		for (int t = 0; t < started; t++) {
+			running += (workers[t].finished == 0);
+			done += workers[t].done;
+		}
+
+		printf(_("\rc: Copying files... %zu/%zu"), done, c->files_n);
+		fflush(stdout);
+
+		if (running == 0)
+			break;
+
+		struct timespec ts = {0, CPE_PROGRESS_NSEC};
+		nanosleep(&ts, NULL);
+	}
+
+	size_t fails = 0;
+
+	for (int t = 0; t < started; t++) {
+		pthread_join(threads[t], NULL);
+		fails += workers[t].fails;
+	}
+
+	if (started > 0) {
+		putchar('\r');
+		ERASE_TO_RIGHT;
+		fflush(stdout);
+	}
+
+	if (started > 0 && started < nthreads) {
+		/* Cover the indices of the workers that never started. */
+		for (int t = started; t < nthreads; t++) {
+			workers[t] = (struct cpe_worker_t){ .c = c, .id = (size_t)t,
+				.nthreads = (size_t)nthreads };
+			cpe_worker(&workers[t]);
+			fails += workers[t].fails;
+		}
+	} else if (started == 0) { /* No worker at all: copy serially */
+		workers[0] = (struct cpe_worker_t){ .c = c, .id = 0, .nthreads = 1 };
+		cpe_worker(&workers[0]);
+		fails = workers[0].fails;
+	}
+
+	return fails;
+}
+
+/* Copy the NSRCS files in SRCS into DEST in parallel. If the batch does
+ * not qualify (see the engine comment above), *ENGAGED is set to zero
+ * and nothing is copied: the caller should run cp(1) instead. Returns
+ * zero if every file was copied, or FUNC_FAILURE otherwise. */
+static int
+copy_files_engine(char **srcs, const size_t nsrcs, const char *dest,
+	int *engaged)
+{
+	struct cpe_t c = {0};
+	struct stat a;
+	size_t i;
+
+	*engaged = 0;
+
+	const int nthreads = fop_get_threads(CP_MAX_THREADS);
+	if (nthreads < 2 || nsrcs == 0)
+		return FUNC_FAILURE;
+
+	const int dest_is_dir = (stat(dest, &a) != -1 && S_ISDIR(a.st_mode));
+	if (dest_is_dir == 0 && (nsrcs > 1 || lstat(dest, &a) != -1))
+		return FUNC_FAILURE;
+
+	for (i = 0; i < nsrcs; i++) {
+		int ret;
+
+		if (dest_is_dir == 1) {
+			char *s = savestring(srcs[i], strlen(srcs[i]));
+			size_t l = strlen(s);
+			while (l > 1 && s[l - 1] == '/')
+				s[--l] = '\0';
+
+			const char *base = strrchr(s, '/');
+			base = base ? base + 1 : s;
+			if (*base == '\0' || SELFORPARENT(base)) {
+				free(s);
+				cpe_free(&c);
+				return FUNC_FAILURE;
+			}
+
+			char *d = xnmalloc(strlen(dest) + strlen(base) + 2,
+				sizeof(char));
+			sprintf(d, "%s/%s", dest, base); /* NOLINT */
+			ret = cpe_scan(&c, s, d);
+			free(s);
+			free(d);
+		} else {
+			ret = cpe_scan(&c, srcs[i], dest);
+		}
+
+		if (ret != FUNC_SUCCESS) {
+			cpe_free(&c);
+			return FUNC_FAILURE;
+		}
+	}
+
+	if (c.files_n + c.dirs_n + c.lnks_n < CP_ENGINE_MIN_ENTRIES
+	&& c.total_bytes < (off_t)CP_ENGINE_MIN_BYTES) {
+		cpe_free(&c);
+		return FUNC_FAILURE;
+	}
+
+	*engaged = 1;
+
+	struct timespec ts_start, ts_end;
+	clock_gettime(CLOCK_MONOTONIC, &ts_start);
+
+	size_t fails = 0;
+
+	/* Recreate the directory skeleton (ancestors first) */
+	for (i = 0; i < c.dirs_n; i++) {
+		if (lstat(c.dirs_src[i], &a) == -1
+		|| mkdir(c.dirs_dst[i], a.st_mode & 07777) == -1)
+			fails++;
+	}
+
+	for (i = 0; i < c.lnks_n; i++) {
+		char target[PATH_MAX + 1];
+		const ssize_t l = readlink(c.lnks_src[i], target,
+			sizeof(target) - 1);
+		if (l == -1) {
+			fails++;
+			continue;
+		}
+		target[l] = '\0';
+		if (symlink(target, c.lnks_dst[i]) == -1)
+			fails++;
+	}
+
+	fails += cpe_copy_parallel(&c, nthreads);
+
+	/* Restore directory timestamps deepest-first, so that fixing a dir
+	 * does not disturb its already fixed subdirectories. */
+	for (i = c.dirs_n; i-- > 0;) {
+		if (lstat(c.dirs_src[i], &a) == -1)
+			continue;
+		if (chown(c.dirs_dst[i], a.st_uid, a.st_gid) == -1) {
+			/* Best-effort, as with cp -p */
+		}
+		const struct timespec dts[2] = { a.CPE_ATIM, a.CPE_MTIM };
+		utimensat(XAT_FDCWD, c.dirs_dst[i], dts, 0);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &ts_end);
+	const double secs = (double)(ts_end.tv_sec - ts_start.tv_sec)
+		+ (double)(ts_end.tv_nsec - ts_start.tv_nsec) / 1e9;
+
+	char size_str[MAX_HUMAN_SIZE + 2];
+	xstrsncpy(size_str, construct_human_size(c.total_bytes),
+		sizeof(size_str));
+	printf(_("c: %zu file(s) copied: %s in %.1fs (%s/s)\n"),
+		c.files_n - (fails > c.files_n ? c.files_n : fails), size_str,
+		secs, construct_human_size(secs > 0.001
+			? (off_t)((double)c.total_bytes / secs) : c.total_bytes));
+
+	if (fails > 0)
+		xerror(_("c: %zu file(s) could not be copied\n"), fails);
+
+	cpe_free(&c);
+	return fails == 0 ? FUNC_SUCCESS : FUNC_FAILURE;
+}
+
+/* Return 1 if the cp(1) command line TCMD (N fields) is a stock cp
+ * invocation the copy engine understands: 'cp' itself (not advcp/wcp/
+ * rsync), its default parameters, end of options, and at least one
+ * source plus a destination. */
+static int
+is_engine_cp_cmd(char **tcmd, const size_t n)
+{
+	return (n >= 5 && strcmp(tcmd[0], "cp") == 0
+		&& (strcmp(tcmd[1], "-iRp") == 0 || strcmp(tcmd[1], "-Rp") == 0)
+		&& strcmp(tcmd[2], "--") == 0);
+}
+
 /* Run CMD (either cp(1) or mv(1)) via execv().
  * skip_force is true (1) when the -f,--force parameter has been provided to
  * either 'c' or 'm' commands: it intructs cp/mv to run non-interactivelly
@@ -1427,7 +1917,15 @@ run_cp_mv_cmd(char **cmd, const int skip_force)
 	}
 
 	tcmd[n] = (char *)NULL;
-	const int ret = launch_execv(tcmd, FOREGROUND, E_NOFLAG);
+
+	int engaged = 0;
+	int ret = FUNC_FAILURE;
+
+	if (is_engine_cp_cmd(tcmd, n) == 1)
+		ret = copy_files_engine(tcmd + 3, n - 4, tcmd[n - 1], &engaged);
+
+	if (engaged == 0)
+		ret = launch_execv(tcmd, FOREGROUND, E_NOFLAG);
 
 	for (i = 0; i < n; i++)
 		free(tcmd[i]);
@@ -1516,7 +2014,14 @@ cp_mv_file(char **args, const int copy_and_rename, const int force)
 
 	tcmd[n] = (char *)NULL;
 
-	const int ret = launch_execv(tcmd, FOREGROUND, E_NOFLAG);
+	int engaged = 0;
+	int ret = FUNC_FAILURE;
+
+	if (copy_and_rename == 0 && is_engine_cp_cmd(tcmd, n) == 1)
+		ret = copy_files_engine(tcmd + 3, n - 4, tcmd[n - 1], &engaged);
+
+	if (engaged == 0)
+		ret = launch_execv(tcmd, FOREGROUND, E_NOFLAG);
 
 	for (i = 0; tcmd[i]; i++)
 		free(tcmd[i]);
@@ -1661,6 +2166,267 @@ fill_rm_info_struct(char **filename, struct stat *a)
 	return info;
 }
 
+/* Removal engine
+ *
+ * Large removals used to go entirely through rm(1), which unlinks one
+ * file at a time: clearing huge directories (say, a 500k-file cache
+ * selected via 'rr') takes ages, most of it spent waiting on serial
+ * unlink(2) round-trips. The engine below scans the files to be removed
+ * up front (directories in pre-order, entry names grouped by parent
+ * directory), unlinks the entries from a pool of worker threads (via
+ * unlinkat(2) against a single descriptor per directory), and finally
+ * removes the emptied directories deepest-first. Small batches, and
+ * batches whose scan hits any error, still go through rm(1). */
+
+#define RM_ENGINE_MIN_ENTRIES 512
+#define RM_MAX_THREADS        16
+
+/* Parent index of entries given as full paths (unlinked relative to CWD) */
+#define RME_NO_PARENT ((size_t)-1)
+
+struct rme_t {
+	char **dirs;    /* Dir paths, pre-order (ancestors before descendants) */
+	char **names;   /* Entry names, grouped by parent directory */
+	size_t *parents; /* Index into DIRS of each entry's parent dir */
+	size_t dirs_n;
+	size_t dirs_cap;
+	size_t names_n;
+	size_t names_cap;
+};
+
+struct rme_worker_t {
+	struct rme_t *r;
+	size_t id;
+	size_t nthreads;
+	volatile size_t fails;
+};
+
+static void
+rme_free(struct rme_t *r)
+{
+	size_t i;
+
+	for (i = 0; i < r->dirs_n; i++)
+		free(r->dirs[i]);
+	free(r->dirs);
+
+	for (i = 0; i < r->names_n; i++)
+		free(r->names[i]);
+	free(r->names);
+	free(r->parents);
+
+	*r = (struct rme_t){0};
+}
+
+static void
+rme_add_name(struct rme_t *r, const char *name, const size_t parent)
+{
+	if (r->names_n >= r->names_cap) {
+		r->names_cap = r->names_cap == 0 ? 1024 : r->names_cap * 2;
+		r->names = xnrealloc(r->names, r->names_cap, sizeof(char *));
+		r->parents = xnrealloc(r->parents, r->names_cap, sizeof(size_t));
+	}
+
+	r->names[r->names_n] = savestring(name, strlen(name));
+	r->parents[r->names_n] = parent;
+	r->names_n++;
+}
+
+static size_t
+rme_add_dir(struct rme_t *r, const char *path)
+{
+	if (r->dirs_n >= r->dirs_cap) {
+		r->dirs_cap = r->dirs_cap == 0 ? 128 : r->dirs_cap * 2;
+		r->dirs = xnrealloc(r->dirs, r->dirs_cap, sizeof(char *));
+	}
+
+	r->dirs[r->dirs_n] = savestring(path, strlen(path));
+	return r->dirs_n++;
+}
+
+/* Scan the directory PATH recursively, recording subdirectories (in
+ * pre-order) and entry names into R. Returns FUNC_FAILURE on the first
+ * error: the caller falls back to rm(1), which will run into (and
+ * properly report) the same error. */
+static int
+rme_scan_dir(struct rme_t *r, const char *path)
+{
+	const size_t parent = rme_add_dir(r, path);
+
+	DIR *dir = opendir(path);
+	if (!dir)
+		return FUNC_FAILURE;
+
+	const struct dirent *ent;
+	int ret = FUNC_SUCCESS;
+
+	while (ret == FUNC_SUCCESS && (ent = readdir(dir))) {
+		if (SELFORPARENT(ent->d_name))
+			continue;
+
+		int is_dir;
+#ifdef _DIRENT_HAVE_D_TYPE
+		if (ent->d_type != DT_UNKNOWN) {
+			is_dir = (ent->d_type == DT_DIR);
+		} else
+#endif /* _DIRENT_HAVE_D_TYPE */
+		{
+			struct stat a;
+			char p[PATH_MAX + 1];
+			snprintf(p, sizeof(p), "%s/%s", path, ent->d_name);
+			if (lstat(p, &a) == -1) {
+				ret = FUNC_FAILURE;
+				break;
+			}
+			is_dir = (S_ISDIR(a.st_mode));
+		}
+
+		if (is_dir == 1) {
+			char *p = xnmalloc(strlen(path) + strlen(ent->d_name) + 2,
+				sizeof(char));
+			sprintf(p, "%s/%s", path, ent->d_name); /* NOLINT */
+			ret = rme_scan_dir(r, p);
+			free(p);
+		} else {
+			rme_add_name(r, ent->d_name, parent);
+		}
+	}
+
+	closedir(dir);
+	return ret;
+}
+
+/* Unlink the entries at indices ID, ID + NTHREADS, ... of the names
+ * array. Entries are grouped by parent directory, so each worker opens
+ * each directory at most once and batches its unlinkat(2) calls against
+ * that single descriptor. Errors are only counted here: this engine is
+ * the moral equivalent of 'rm -rf', which reports but does not stop
+ * either. */
+static void *
+rme_worker(void *arg)
+{
+	struct rme_worker_t *w = (struct rme_worker_t *)arg;
+	const struct rme_t *r = w->r;
+	size_t cur_parent = RME_NO_PARENT;
+	int dirfd = -1;
+
+	for (size_t i = w->id; i < r->names_n; i += w->nthreads) {
+		const size_t parent = r->parents[i];
+
+		if (parent == RME_NO_PARENT) { /* Full path: unlink from CWD */
+			if (unlinkat(XAT_FDCWD, r->names[i], 0) == -1)
+				w->fails++;
+			continue;
+		}
+
+		if (parent != cur_parent || dirfd == -1) {
+			if (dirfd != -1)
+				close(dirfd);
+			dirfd = open(r->dirs[parent], O_RDONLY | O_DIRECTORY);
+			cur_parent = parent;
+		}
+
+		if (dirfd == -1 || unlinkat(dirfd, r->names[i], 0) == -1)
+			w->fails++;
+	}
+
+	if (dirfd != -1)
+		close(dirfd);
+
+	return NULL;
+}
+
+/* Remove the files in FILES (no trailing NULL check: NFILES entries)
+ * in parallel. If the batch is too small to be worth it, or the scan
+ * phase fails, *ENGAGED is set to zero and nothing is removed: the
+ * caller should run rm(1) instead. Returns zero if every file was
+ * removed, or FUNC_FAILURE otherwise. */
+static int
+remove_files_engine(char **files, const size_t nfiles, int *engaged)
+{
+	struct rme_t r = {0};
+	struct stat a;
+	size_t i;
+
+	*engaged = 0;
+
+	const int nthreads = fop_get_threads(RM_MAX_THREADS);
+	if (nthreads < 2)
+		return FUNC_FAILURE;
+
+	for (i = 0; i < nfiles; i++) {
+		if (lstat(files[i], &a) == -1)
+			continue; /* Already reported by the caller */
+
+		if (S_ISDIR(a.st_mode)) {
+			if (rme_scan_dir(&r, files[i]) != FUNC_SUCCESS) {
+				rme_free(&r);
+				return FUNC_FAILURE;
+			}
+		} else {
+			rme_add_name(&r, files[i], RME_NO_PARENT);
+		}
+	}
+
+	if (r.names_n + r.dirs_n < RM_ENGINE_MIN_ENTRIES) {
+		rme_free(&r);
+		return FUNC_FAILURE;
+	}
+
+	*engaged = 1;
+
+	pthread_t threads[RM_MAX_THREADS];
+	struct rme_worker_t workers[RM_MAX_THREADS];
+	int started = 0;
+
+	for (int t = 0; t < nthreads; t++) {
+		workers[t] = (struct rme_worker_t){ .r = &r, .id = (size_t)t,
+			.nthreads = (size_t)nthreads };
+		if (pthread_create(&threads[t], NULL, rme_worker,
+		&workers[t]) != 0)
+			break;
+		started++;
+	}
+
+	size_t fails = 0;
+
+	if (started > 0) {
+		for (int t = 0; t < started; t++) {
+			pthread_join(threads[t], NULL);
+			fails += workers[t].fails;
+		}
+
+		if (started < nthreads) {
+			/* Cover the indices of the workers that never started. */
+			for (int t = started; t < nthreads; t++) {
+				workers[t] = (struct rme_worker_t){ .r = &r,
+					.id = (size_t)t, .nthreads = (size_t)nthreads };
+				rme_worker(&workers[t]);
+				fails += workers[t].fails;
+			}
+		}
+	} else { /* No worker at all: unlink serially */
+		workers[0] = (struct rme_worker_t){ .r = &r, .id = 0, .nthreads = 1 };
+		rme_worker(&workers[0]);
+		fails = workers[0].fails;
+	}
+
+	/* Directories are listed ancestors-first: removing them backwards
+	 * tears the tree down deepest-first. */
+	for (i = r.dirs_n; i-- > 0;) {
+		if (rmdir(r.dirs[i]) == -1) {
+			xerror("r: rmdir: '%s': %s\n", r.dirs[i], strerror(errno));
+			fails++;
+		}
+	}
+
+	if (fails > 0)
+		xerror(_("r: %zu file(s) could not be removed\n"), fails);
+
+	rme_free(&r);
+	return fails == 0 ? FUNC_SUCCESS : FUNC_FAILURE;
+}
+
 int
 remove_files(char **args)
 {
@@ -1745,7 +2511,11 @@ remove_files(char **args)
 	rm_cmd[1] = have_dirs >= 1 ? "-rf" : "-f";
 	rm_cmd[2] = "--";
 
-	exit_status = launch_execv(rm_cmd, FOREGROUND, E_NOFLAG);
+	int engine_engaged = 0;
+	exit_status = remove_files_engine(rm_cmd + 3, (size_t)j - 3,
+		&engine_engaged);
+	if (engine_engaged == 0)
+		exit_status = launch_execv(rm_cmd, FOREGROUND, E_NOFLAG);
 	if (exit_status != FUNC_SUCCESS) {
 #ifndef BSD_KQUEUE
 		if (num > 1 && conf.autols == 1) /* Only if we have multiple files */
@@ -1886,13 +2656,20 @@ batch_link(char **args)
 		char *tmp = xnmalloc(tmp_len, sizeof(char));
 		xstrsncpy(tmp, basename, tmp_len);
 
+		/* Attempt the link directly and suffix the name only on EEXIST,
+		 * instead of probing each candidate with lstat(2) first: one
+		 * syscall per created link in the common case, which matters
+		 * when symlinking thousands of selected files. */
+		errno = 0;
 		size_t suffix = 1;
-		while (lstat(tmp, &a) != -1) {
+		while (symlinkat(filename, XAT_FDCWD, tmp) == -1
+		&& errno == EEXIST) {
 			snprintf(tmp, tmp_len, "%s-%zu", basename, suffix);
 			suffix++;
+			errno = 0;
 		}
 
-		if (symlinkat(filename, XAT_FDCWD, tmp) == -1) {
+		if (errno != 0) {
 			exit_status = errno;
 			xerror(_("bl: Cannot create symbolic link '%s': %s\n"),
 				tmp, strerror(errno));
@@ -25,18 +25,128 @@
 #include "helpers.h"
 
 #if defined(LINUX_FSINFO)
+# include <fcntl.h> /* open(2), used by the mount table cache */
+# include <poll.h> /* poll(2), used by mount_table_changed() */
 # include <stdio.h> /* fclose(3), fgets(3) */
 # include <string.h> /* strnlen(3), strncmp(3) */
 # include <mntent.h> /* xxxmntent(), used by get_remote_fs_name() */
+# include <unistd.h> /* close(2) */
 # include <sys/statfs.h> /* statfs(2) */
 # include <sys/sysmacros.h> /* major() and minor(), used by get_dev_name() */
 # include "aux.h" /* open_fread() */
+# include "init.h" /* get_ext_mountpoints() */
 # include "linuxfs.h" /* FS_MAGIC macros for file system types */
+# include "strings.h" /* savestring() */
 #elif defined(HAVE_STATFS)
 # include <sys/mount.h> /* statfs(2) */
 #endif /* __linux__ */
 
 #if defined(LINUX_FSINFO)
+/* Mount table cache
+ *
+ * Device and file system names are resolved against the mount table,
+ * and some of these lookups run on every listing (see print_disk_usage()
+ * in listing.c). Since mounts rarely change, the parsed table is cached
+ * in memory and lookups are answered from the cache; the kernel reports
+ * mount table changes via poll(2) on /proc/self/mountinfo, and only then
+ * is the table re-parsed. */
+
+struct mnt_cache_t {
+	char *mnt_dir;
+	char *mnt_fsname;
+	size_t dir_len;
+};
+
+static struct mnt_cache_t *mnt_cache = (struct mnt_cache_t *)NULL;
+static size_t mnt_cache_n = 0;
+static int mountinfo_fd = -1;
+static int mnt_cache_ok = 0;
+
+/* Cache for get_dev_name(): one entry per device ID seen so far.
+ * Flushed together with the mount table cache. */
+struct dev_cache_t {
+	dev_t dev;
+	char name[NAME_MAX];
+};
+
+static struct dev_cache_t *dev_cache = (struct dev_cache_t *)NULL;
+static size_t dev_cache_n = 0;
+
+/* Return 1 if the mount table changed since the last check (or was never
+ * loaded) and 0 otherwise. An open file descriptor on /proc/self/mountinfo
+ * reports POLLERR/POLLPRI whenever a file system is (un)mounted; it is
+ * reopened after each event to re-arm the notification. */
+static int
+mount_table_changed(void)
+{
+	if (mountinfo_fd == -1) {
+		mountinfo_fd = open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+		if (mountinfo_fd == -1) /* No procfs: always re-parse */
+			return 1;
+		return (mnt_cache_ok == 0);
+	}
+
+	struct pollfd pfd = {0};
+	pfd.fd = mountinfo_fd;
+	pfd.events = POLLPRI;
+
+	if (poll(&pfd, 1, 0) <= 0)
+		return (mnt_cache_ok == 0);
+
+	if (pfd.revents & (POLLERR | POLLPRI)) {
+		close(mountinfo_fd);
+		mountinfo_fd = -1;
+		mount_table_changed(); /* Reopen to re-arm the notification */
+		return 1;
+	}
+
+	return (mnt_cache_ok == 0);
+}
+
+static void
+load_mnt_cache(void)
+{
+	size_t i;
+	for (i = 0; i < mnt_cache_n; i++) {
+		free(mnt_cache[i].mnt_dir);
+		free(mnt_cache[i].mnt_fsname);
+	}
+	mnt_cache_n = 0;
+
+	dev_cache_n = 0; /* Device names may have changed too */
+
+	FILE *fp = setmntent("/proc/self/mounts", "r");
+	if (!fp)
+		return;
+
+	struct mntent *ent;
+	while ((ent = getmntent(fp)) != NULL) {
+		mnt_cache = xnrealloc(mnt_cache, mnt_cache_n + 1,
+			sizeof(struct mnt_cache_t));
+		mnt_cache[mnt_cache_n].mnt_dir =
+			savestring(ent->mnt_dir, strlen(ent->mnt_dir));
+		mnt_cache[mnt_cache_n].mnt_fsname =
+			savestring(ent->mnt_fsname, strlen(ent->mnt_fsname));
+		mnt_cache[mnt_cache_n].dir_len = strlen(ent->mnt_dir);
+		mnt_cache_n++;
+	}
+
+	endmntent(fp);
+	mnt_cache_ok = 1;
+}
+
+/* Re-parse mount information if the kernel reported a change (keeping the
+ * list of mounted ext file systems in sync as well). */
+static void
+refresh_mnt_cache(void)
+{
+	if (mount_table_changed() == 0)
+		return;
+
+	load_mnt_cache();
+	get_ext_mountpoints();
+}
+
 /* Given an ext file system, tell whether it is version 2, 3, or 4.
  * Returns a pointer to a constant string with the proper name. If none is
  * found a generic "ext2/3/4" is returned.
@@ -85,6 +195,8 @@ get_ext_fs_type(const char *file)
 char *
 get_fs_type_name(const char *file, int *remote)
 {
+	refresh_mnt_cache(); /* Keep ext_mnt in sync with the mount table */
+
 	struct statfs a;
 	if (statfs(file, &a) == -1)
 		return "?";
@@ -225,6 +337,19 @@ get_fs_type_name(const char *file, int *remote)
 	}
 }
 
+/* Return 1 if the file FILE sits on a remote (network) file system, or
+ * 0 otherwise (including on error). */
+int
+is_remote_fs(const char *file)
+{
+	int remote = 0;
+
+	if (file && *file)
+		get_fs_type_name(file, &remote);
+
+	return remote;
+}
+
 /* Return a pointer to the name of the device to which the file FILE belongs
  * (ex: "/dev/sda2" or "//192.168.10.27/share").
  *
@@ -234,28 +359,23 @@ get_fs_type_name(const char *file, int *remote)
 char *
 get_dev_name_mntent(const char *file)
 {
-	FILE *fp = setmntent("/proc/self/mounts", "r");
-	if (!fp)
-		return DEV_NO_NAME;
+	refresh_mnt_cache();
 
 	size_t mnt_longest = 0;
 	static char name[PATH_MAX + 1]; *name = '\0';
-	struct mntent *ent;
 
-	while ((ent = getmntent(fp)) != NULL) {
-		char *ptr = strstr(file, ent->mnt_dir);
+	size_t i;
+	for (i = 0; i < mnt_cache_n; i++) {
+		char *ptr = strstr(file, mnt_cache[i].mnt_dir);
 		if (!ptr || ptr != file)
 			continue;
 
-		const size_t l = strlen(ent->mnt_dir);
-		if (l > mnt_longest) {
-			mnt_longest = l;
-			xstrsncpy(name, ent->mnt_fsname, sizeof(name));
+		if (mnt_cache[i].dir_len > mnt_longest) {
+			mnt_longest = mnt_cache[i].dir_len;
+			xstrsncpy(name, mnt_cache[i].mnt_fsname, sizeof(name));
 		}
 	}
 
-	endmntent(fp);
-
 	return (!*name ? DEV_NO_NAME : name);
 }
 
@@ -267,6 +387,14 @@ get_dev_name(const dev_t dev)
 	if (maj == 0) /* special devices (tmp, dev, sys, proc, etc) */
 		return DEV_NO_NAME;
 
+	refresh_mnt_cache();
+
+	size_t i;
+	for (i = 0; i < dev_cache_n; i++) {
+		if (dev_cache[i].dev == dev)
+			return dev_cache[i].name;
+	}
+
 	const unsigned int min = minor(dev);
 
 	char dev_path[PATH_MAX + 1];
@@ -293,7 +421,17 @@ get_dev_name(const dev_t dev)
 
 	fclose(fp);
 
-	return (!*name ? DEV_NO_NAME : name);
+	if (!*name)
+		return DEV_NO_NAME;
+
+	dev_cache = xnrealloc(dev_cache, dev_cache_n + 1,
+		sizeof(struct dev_cache_t));
+	dev_cache[dev_cache_n].dev = dev;
+	xstrsncpy(dev_cache[dev_cache_n].name, name,
+		sizeof(dev_cache[dev_cache_n].name));
+	dev_cache_n++;
+
+	return dev_cache[dev_cache_n - 1].name;
 }
 
 #elif defined(HAVE_STATFS)
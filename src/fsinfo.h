@@ -29,6 +29,7 @@ __BEGIN_DECLS
 
 #if defined(LINUX_FSINFO)
 char *get_fs_type_name(const char *file, int *remote);
+int is_remote_fs(const char *file);
 char *get_dev_name(const dev_t dev);
 char *get_dev_name_mntent(const char *file);
 #elif defined(HAVE_STATFS)
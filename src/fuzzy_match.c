@@ -34,6 +34,12 @@
 
 #include <string.h>
 
+#if defined(__SSE2__)
+# include <emmintrin.h> /* SSE2 intrinsics (fuzzy_prescreen()) */
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+# include <arm_neon.h> /* NEON intrinsics (fuzzy_prescreen()) */
+#endif /* __SSE2__ */
+
 #include "fuzzy_match.h"
 #include "utf8.h"
 
@@ -97,6 +103,144 @@ contains_utf8(const char *s)
 	return 0;
 }
 
+#if defined(__SSE2__)
+/* Return a pointer to the first occurrence of either C1 or C2 in the
+ * string S, or NULL if none is found, comparing 16 bytes per iteration.
+ * The terminating NUL is detected in the same chunk, so no previous
+ * strlen() call is needed. Reads past the NUL never cross a page
+ * boundary: once S is 16-byte aligned, aligned loads stay within the
+ * current page. */
+static const char *
+simd_chr2(const char *s, const char c1, const char c2)
+{
+	for (; ((uintptr_t)s & 15) != 0; s++) {
+		if (*s == c1 || *s == c2)
+			return s;
+		if (!*s)
+			return (const char *)NULL;
+	}
+
+	const __m128i vz = _mm_setzero_si128();
+	const __m128i v1 = _mm_set1_epi8(c1);
+	const __m128i v2 = _mm_set1_epi8(c2);
+
+	for (;; s += 16) {
+		const __m128i chunk = _mm_load_si128((const __m128i *)s);
+		const unsigned int mc = (unsigned int)_mm_movemask_epi8(
+			_mm_or_si128(_mm_cmpeq_epi8(chunk, v1),
+			_mm_cmpeq_epi8(chunk, v2)));
+		const unsigned int mz = (unsigned int)_mm_movemask_epi8(
+			_mm_cmpeq_epi8(chunk, vz));
+
+		if ((mc | mz) == 0)
+			continue;
+
+		const unsigned int cpos = mc ? (unsigned int)__builtin_ctz(mc) : 16;
+		const unsigned int zpos = mz ? (unsigned int)__builtin_ctz(mz) : 16;
+		return cpos < zpos ? s + cpos : (const char *)NULL;
+	}
+}
+
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+/* NEON counterpart of the SSE2 simd_chr2() above. */
+static const char *
+simd_chr2(const char *s, const char c1, const char c2)
+{
+	for (; ((uintptr_t)s & 15) != 0; s++) {
+		if (*s == c1 || *s == c2)
+			return s;
+		if (!*s)
+			return (const char *)NULL;
+	}
+
+	const uint8x16_t v1 = vdupq_n_u8((uint8_t)c1);
+	const uint8x16_t v2 = vdupq_n_u8((uint8_t)c2);
+
+	for (;; s += 16) {
+		const uint8x16_t chunk = vld1q_u8((const uint8_t *)s);
+		const uint8x16_t eqc =
+			vorrq_u8(vceqq_u8(chunk, v1), vceqq_u8(chunk, v2));
+		const uint8x16_t eqz = vceqq_u8(chunk, vdupq_n_u8(0));
+
+		if (vmaxvq_u8(vorrq_u8(eqc, eqz)) == 0)
+			continue;
+
+		/* Hit in this chunk: resolve the exact position byte by byte. */
+		for (size_t i = 0; i < 16; i++) {
+			if (s[i] == c1 || s[i] == c2)
+				return s + i;
+			if (!s[i])
+				return (const char *)NULL;
+		}
+	}
+}
+#endif /* __SSE2__ */
+
+/* Pre-screen the candidate S2 against the pattern S1 before running the
+ * full scorer: since a fuzzy match requires every pattern character to
+ * appear in the candidate (in order), a candidate missing any pattern
+ * byte can be rejected without scoring it at all.
+ *
+ * The first pattern byte is located with a vectorized scan when SSE2 or
+ * NEON is available (this is where most failing candidates bail out);
+ * the remaining bytes are checked against a 256-bit presence bitmap of
+ * the candidate bytes following that first hit.
+ *
+ * Byte-level reasoning is only valid for ASCII patterns (case-folding
+ * multi-byte characters changes their bytes), so non-ASCII patterns are
+ * reported as possible matches and left entirely to the scorer.
+ *
+ * Returns 0 if S2 cannot match S1, or 1 if it might. */
+static int
+fuzzy_prescreen(const char *s1, const char *s2)
+{
+	const int cs = conf.case_sens_path_comp;
+
+	const char c1 = *s1;
+	const char c2 = cs == 1 ? *s1 : (char)TOUPPER(*s1);
+	if ((unsigned char)c1 >= 0x80)
+		return 1;
+
+#if defined(__SSE2__) || (defined(__ARM_NEON) && defined(__aarch64__))
+	const char *m = simd_chr2(s2, cs == 1 ? c1 : (char)TOLOWER(c1), c2);
+#else
+	const char *m = s2;
+	const char lc = cs == 1 ? c1 : (char)TOLOWER(c1);
+	while (*m && *m != lc && *m != c2)
+		m++;
+	if (!*m)
+		m = (const char *)NULL;
+#endif /* __SSE2__ || __ARM_NEON */
+
+	if (!m)
+		return 0;
+
+	if (!*(s1 + 1))
+		return 1;
+
+	/* Presence bitmap of the candidate bytes after the first hit: the
+	 * remaining pattern bytes must all appear there. */
+	uint64_t map[4] = {0};
+	for (const char *p = m + 1; *p; p++) {
+		const unsigned char b = (unsigned char)*p;
+		map[b >> 6] |= (uint64_t)1 << (b & 63);
+	}
+
+	for (const char *p = s1 + 1; *p; p++) {
+		const unsigned char b = (unsigned char)*p;
+		if (b >= 0x80)
+			return 1;
+
+		const unsigned char lb = cs == 1 ? b : (unsigned char)TOLOWER(b);
+		const unsigned char ub = cs == 1 ? b : (unsigned char)TOUPPER(b);
+		if ((map[lb >> 6] & ((uint64_t)1 << (lb & 63))) == 0
+		&& (map[ub >> 6] & ((uint64_t)1 << (ub & 63))) == 0)
+			return 0;
+	}
+
+	return 1;
+}
+
 /* Same as fuzzy_match(), but:
  * 1: Not Unicode aware
  * 2: Much faster */
@@ -185,6 +329,9 @@ fuzzy_match(char *s1, char *s2, const size_t s1_len, const int type)
 			return 0;
 	}
 
+	if (fuzzy_prescreen(s1, s2) == 0)
+		return 0;
+
 	if (type == FUZZY_FILES_ASCII || conf.fuzzy_match_algo == 1)
 		return fuzzy_match_v1(s1, s2, s1_len);
 
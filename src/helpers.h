@@ -1069,9 +1069,11 @@ struct config_t {
 	char *fzftab_options;
 
 	int apparent_size;
+	int approx_dir_size;
 	int auto_open;
 	int autocd;
 	int autols;
+	int big_dir_threshold;
 	int case_sens_dirjump;
 	int case_sens_path_comp;
 	int case_sens_search;
@@ -1155,6 +1157,14 @@ extern struct config_t conf;
 /* Store information about the current files filter */
 struct filter_t {
 	char *str;
+	/* Literal fast path: when STR contains no regex metacharacters
+	 * (anchors and escaped metacharacters allowed), LITERAL holds the
+	 * plain substring to match, avoiding regexec(3) per listed file.
+	 * See set_filter_literal() in misc.c. */
+	char *literal;
+	size_t literal_len;
+	int anchor_start; /* STR begins with '^' */
+	int anchor_end;   /* STR ends with '$' */
 	int rev;
 	int type;
 	int env;
@@ -1225,6 +1235,7 @@ struct jump_t {
 	time_t last_visit;
 	int keep;
 	int rank;
+	int rank_gen; /* Rank cache generation (see jump_rank() in jump.c) */
 };
 
 extern struct jump_t *jump_db;
@@ -1273,6 +1284,10 @@ struct fileinfo {
 	char *icon;
 	char *icon_color;
 	char *name;
+	char *sext;  /* Cached extension sort key (see init_sort_keys()) */
+	char *sname; /* Cached name sort key (see init_sort_keys()) */
+	char *fname; /* Case-folded NAME: case insensitive sort/completion */
+	char *time_str; /* Rendered long-view timestamp (see construct_timestamp()) */
 	filesn_t filesn;
 	blkcnt_t blocks;
 	size_t len;    /* File name len (columns needed to display file name) */
@@ -1294,8 +1309,10 @@ struct fileinfo {
 	int sel;
 	int xattr;
 	int du_status; /* Exit status of du(1) for dir full sizes */
+	int du_approx; /* Size is a sampling estimate (ApproxDirSize) */
 	int utf8;      /* Name contains at least one UTF-8 character */
 	int stat_err;  /* stat(2) failed for this entry */
+	int icon_set;  /* Icon already resolved (see resolve_entry_icon()) */
 #if defined(__FreeBSD__) || defined(__NetBSD__) || defined(__OpenBSD__) \
 || defined(__APPLE__) || defined(__sun) || defined(__HAIKU__) \
 || (defined(__arm__) && !defined(__ANDROID__))
@@ -1332,8 +1349,13 @@ extern struct devino_t *sel_devino;
 
 struct autocmds_t {
 	char *pattern;
+	char *xpattern; /* Precompiled form of PATTERN (see autocmds.c) */
 	char *color_scheme;
 	char *cmd;
+	size_t xlen;    /* Length of XPATTERN */
+	int match_type; /* How XPATTERN is matched (ACM_* in autocmds.c) */
+	int neg;        /* PATTERN is negated ('!') */
+	int ws;         /* Workspace number (ACM_WS patterns) */
 	int long_view;
 	int light_mode;
 	int files_counter;
@@ -1378,6 +1400,7 @@ struct param_t {
 	int auto_open;
 	int autocd;
 	int autols;
+	int batch;
 	int bell_style;
 	int bm_file;
 	int case_sens_dirjump;
@@ -1424,6 +1447,7 @@ struct param_t {
 #endif /* !_NO_ICONS */
 	int icons_use_file_color;
 	int int_vars;
+	int ipc;
 	int list_and_quit;
 	int light;
 	int longview;
@@ -1654,8 +1678,10 @@ extern struct paths_t *paths;
 struct ext_t {
 	char  *name;
 	char  *value;
+	char  *esc; /* VALUE as a full escape sequence ("\x1b[VALUEm") */
 	size_t len; /* Name length */
 	size_t value_len;
+	size_t esc_len;
 	size_t hash;
 };
 extern struct ext_t *ext_colors;
@@ -1686,7 +1712,8 @@ enum tab_mode {
 	STD_TAB =   0,
 	FZF_TAB =   1,
 	FNF_TAB =   2,
-	SMENU_TAB = 3
+	SMENU_TAB = 3,
+	INT_TAB =   4 /* Built-in fuzzy finder (no external binary needed) */
 };
 
 extern enum tab_mode tabmode;
@@ -25,6 +25,7 @@
 #include "helpers.h"
 
 #include <stdio.h>
+#include <string.h>
 #ifdef __OpenBSD__
 typedef char *rl_cpvfunc_t;
 #include <ereadline/readline/readline.h>
@@ -32,12 +33,36 @@ typedef char *rl_cpvfunc_t;
 #include <readline/readline.h>
 #endif /* __OpenBSD__ */
 
+#include "aux.h" /* xnrealloc() */
 #include "checks.h"
 
 /* Macros for single and double quotes */
 #define Q_SINGLE 0
 #define Q_DOUBLE 1
 
+/* Snapshot of the input line as painted by the last recolorize_line()
+ * call, plus the color each byte was painted with. Used to detect edits
+ * whose repaint reduces to a single readline redisplay (see
+ * recolorize_incremental()). */
+static char *painted_line = (char *)NULL;
+static char **painted_colors = (char **)NULL;
+static size_t painted_len = 0;
+static size_t painted_cap = 0;
+
+static void
+painted_cache_resize(const size_t len)
+{
+	if (len + 1 <= painted_cap)
+		return;
+
+	const size_t old_cap = painted_cap;
+	painted_cap = len + 1;
+	painted_line = xnrealloc(painted_line, painted_cap, sizeof(char));
+	painted_colors = xnrealloc(painted_colors, painted_cap, sizeof(char *));
+	memset(painted_colors + old_cap, 0,
+		(painted_cap - old_cap) * sizeof(char *));
+}
+
 /* Change the color of the word _LAST_WORD, at offset OFFSET, to COLOR
  * in the current input string */
 /*void
@@ -230,6 +255,82 @@ END:
 	return cl;
 }
 
+/* Try to repaint the last edit with a single redisplay. This is possible
+ * for single-byte edits at the cursor whenever every byte from START
+ * onward resolves to one single color, matching the color the rest of
+ * the line is already painted with: whether the terminal shifts the tail
+ * in place (ICH/DCH) or readline rewrites it with the color set here,
+ * the screen ends up correct. This covers the common cases (typing at
+ * the end of the line, or inside a quoted string) without rewriting the
+ * whole remaining line on each keystroke, which floods slow terminals.
+ * Returns 1 if the repaint was performed, or 0 if the full recolor loop
+ * is required. */
+static int
+recolorize_incremental(const int start, const int bk_point)
+{
+	if (wrong_cmd == 1 || painted_len == 0 || rl_end <= 0
+	|| start < 0 || start >= rl_end)
+		return 0;
+
+	const size_t len = (size_t)rl_end;
+
+	/* Only single-byte edits are handled here. */
+	if (len != painted_len + 1 && len + 1 != painted_len)
+		return 0;
+
+	/* The text before START must be unchanged. */
+	if (start > 0 && memcmp(rl_line_buffer, painted_line, (size_t)start) != 0)
+		return 0;
+
+	/* Simulate the colors the recolor loop would assign from START
+	 * onward (replicating its view of the line: the recolored segment is
+	 * highlighted as a standalone string), and bail out unless they all
+	 * resolve to one single color. */
+	char *const entry_color = cur_color;
+	const int entry_point = rl_point;
+	char *cl = (char *)NULL;
+	size_t i;
+
+	for (i = (size_t)start; i < len; i++) {
+		rl_point = (int)i;
+		char *c = rl_highlight(rl_line_buffer + start,
+			i - (size_t)start, INFORM_COLOR);
+		cur_color = c;
+
+		if (!c || (cl && c != cl)) {
+			cur_color = entry_color;
+			rl_point = entry_point;
+			return 0;
+		}
+		cl = c;
+	}
+
+	rl_point = entry_point;
+
+	/* The already painted tail must be in that same color too. */
+	for (i = (size_t)start; i < painted_len; i++) {
+		if (painted_colors[i] != cl) {
+			cur_color = entry_color;
+			return 0;
+		}
+	}
+
+	if (cl != entry_color)
+		fputs(cl, stdout);
+	cur_color = cl;
+
+	rl_point = bk_point;
+	rl_redisplay();
+
+	painted_cache_resize(len);
+	memcpy(painted_line, rl_line_buffer, len);
+	for (i = (size_t)start; i < len; i++)
+		painted_colors[i] = cl;
+	painted_len = len;
+
+	return 1;
+}
+
 /* Recolorize current input line starting from rl_point */
 void
 recolorize_line(void)
@@ -260,12 +361,21 @@ recolorize_line(void)
 		fputs(cl, stdout);
 
 	if (rl_point == 0 && rl_end == 0) {
+		painted_len = 0;
 		UNHIDE_CURSOR;
 		return;
 	}
 
 	int end_bk = rl_end;
 	int start = rl_point > 0 ? rl_point - 1 : 0;
+
+	if (recolorize_incremental(start, bk_point) == 1) {
+		UNHIDE_CURSOR;
+		return;
+	}
+
+	painted_cache_resize((size_t)end_bk);
+
 	char *ss = rl_copy_text(start, rl_end);
 	rl_delete_text(start, rl_end);
 	rl_point = rl_end = start;
@@ -285,6 +395,7 @@ recolorize_line(void)
 	char t[PATH_MAX + 1];
 	for (;ss[i]; i++) {
 		rl_highlight(ss, i, SET_COLOR);
+		painted_colors[start + (int)i] = cur_color;
 		/* Redisplay the current char with the appropriate color */
 		if ((signed char)ss[i] < 0) {
 			t[l] = ss[i];
@@ -306,5 +417,12 @@ recolorize_line(void)
 EXIT:
 	free(ss);
 	rl_point = bk_point;
+
+	/* Keep the painted-line cache in sync with what is now on the
+	 * screen (see recolorize_incremental()). */
+	painted_cache_resize((size_t)rl_end);
+	memcpy(painted_line, rl_line_buffer, (size_t)rl_end);
+	painted_len = (size_t)rl_end;
+
 	UNHIDE_CURSOR;
 }
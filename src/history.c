@@ -25,9 +25,12 @@
 #include "helpers.h"
 
 #include <errno.h>
+#include <fcntl.h>    /* open */
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h> /* mmap, munmap */
 #include <time.h>
+#include <unistd.h>   /* close */
 #include <readline/history.h>
 
 #include "aux.h"
@@ -40,6 +43,147 @@
 #include "readline.h" /* rl_get_y_or_n */
 #include "spawn.h"
 
+/* The history file is loaded through a private, writable mapping: line
+ * terminators are replaced by NUL bytes in the mapping (the file itself
+ * is untouched) and each entry in the history array points directly into
+ * it, so that no per-line copies are made. The mapping stays alive for
+ * the lifetime of the array (see free_history()). */
+static char *hist_map = (char *)NULL;
+static size_t hist_map_len = 0;
+
+/* Prefix index over the history array
+ *
+ * check_history() (the per-keystroke history suggestion in
+ * suggestions.c) used to scan the whole array newest to oldest on every
+ * keystroke. The index buckets entries by case-folded first character
+ * (HIST_HEADS1, consulted for one-character queries) and by a hash of
+ * the first two case-folded characters (HIST_HEADS2, for everything
+ * longer), chaining same-bucket entries newest first, so a lookup walks
+ * only the entries sharing the query's first characters. Heads and
+ * links store 1-based entry indices (0 = end of chain). The index is
+ * rebuilt after a history (re)load and extended in place by
+ * add_to_cmdhist(). */
+
+#define HIST_IDX_BUCKETS 1024 /* Power of two */
+
+static int *hist_next1 = (int *)NULL;
+static int *hist_next2 = (int *)NULL;
+static size_t hist_idx_cap = 0;
+static int hist_heads1[256];
+static int hist_heads2[HIST_IDX_BUCKETS];
+
+static size_t
+hist_pair_bucket(const unsigned char c1, const unsigned char c2)
+{
+	return ((size_t)c1 * 131 + c2) & (HIST_IDX_BUCKETS - 1);
+}
+
+/* Link the history entry at index I into the index chains. */
+static void
+hist_index_add(const size_t i)
+{
+	if (i + 1 > hist_idx_cap) {
+		hist_idx_cap = hist_idx_cap == 0 ? 512 : hist_idx_cap * 2;
+		if (hist_idx_cap < i + 1)
+			hist_idx_cap = i + 1;
+		hist_next1 = xnrealloc(hist_next1, hist_idx_cap, sizeof(int));
+		hist_next2 = xnrealloc(hist_next2, hist_idx_cap, sizeof(int));
+	}
+
+	const char *cmd = history[i].cmd;
+	if (!cmd || !*cmd)
+		return;
+
+	const unsigned char c1 = (unsigned char)TOUPPER(*cmd);
+	hist_next1[i] = hist_heads1[c1];
+	hist_heads1[c1] = (int)i + 1;
+
+	if (!cmd[1])
+		return;
+
+	const size_t b =
+		hist_pair_bucket(c1, (unsigned char)TOUPPER(cmd[1]));
+	hist_next2[i] = hist_heads2[b];
+	hist_heads2[b] = (int)i + 1;
+}
+
+static void
+hist_index_build(void)
+{
+	memset(hist_heads1, 0, sizeof(hist_heads1));
+	memset(hist_heads2, 0, sizeof(hist_heads2));
+
+	size_t i;
+	for (i = 0; i < current_hist_n; i++)
+		hist_index_add(i);
+}
+
+static void
+hist_index_free(void)
+{
+	free(hist_next1);
+	free(hist_next2);
+	hist_next1 = hist_next2 = (int *)NULL;
+	hist_idx_cap = 0;
+	memset(hist_heads1, 0, sizeof(hist_heads1));
+	memset(hist_heads2, 0, sizeof(hist_heads2));
+}
+
+/* Return the most recent history entry whose first LEN bytes match STR
+ * (per the history suggestions comparison rules), or NULL if there is
+ * none. */
+struct history_t *
+history_prefix_find(const char *str, const size_t len)
+{
+	if (!history || current_hist_n == 0 || !str || !*str || len == 0)
+		return (struct history_t *)NULL;
+
+	const unsigned char c1 = (unsigned char)TOUPPER(*str);
+	const int *next;
+	int i;
+
+	if (len == 1) {
+		i = hist_heads1[c1];
+		next = hist_next1;
+	} else {
+		i = hist_heads2[hist_pair_bucket(c1,
+			(unsigned char)TOUPPER(str[1])) ];
+		next = hist_next2;
+	}
+
+	while (i != 0) {
+		struct history_t *h = &history[i - 1];
+
+		if (h->cmd
+		&& (conf.case_sens_path_comp ? strncmp(str, h->cmd, len)
+		: strncasecmp(str, h->cmd, len)) == 0)
+			return h;
+
+		i = next[i - 1];
+	}
+
+	return (struct history_t *)NULL;
+}
+
+/* Number of commands not yet written to the history file. The commands
+ * themselves are kept in readline's history list: we just count them and
+ * write them out in a single batch (see flush_cmdhist()). */
+static size_t hist_pending = 0;
+#define HIST_PENDING_MAX 25
+
+/* Write not-yet-saved commands (if any) to the history file. */
+void
+flush_cmdhist(void)
+{
+	if (hist_pending == 0)
+		return;
+
+	if (config_ok == 1 && hist_status == 1 && hist_file)
+		append_history((int)hist_pending, hist_file);
+
+	hist_pending = 0;
+}
+
 /* Return a string with the current date.
  * Used to compose log entries. */
 static char *
@@ -81,6 +225,43 @@ print_logs(const int flag)
 	return FUNC_SUCCESS;
 }
 
+/* Persistent append streams for the command and message log files.
+ * Opened on first write and kept open for the rest of the session, so
+ * that logging a command costs a single write instead of an
+ * open/append/close cycle. Streams are flushed after each line, keeping
+ * appended lines immediately visible to other instances sharing the
+ * file. close_log_streams() must be called whenever the log files are
+ * removed, truncated, or their paths change (e.g. on profile switch). */
+static FILE *cmds_log_fp = (FILE *)NULL;
+static FILE *msgs_log_fp = (FILE *)NULL;
+
+/* Return the persistent append stream cached in *CACHED, opening FILE
+ * if not open yet. Returns NULL in case of error. */
+static FILE *
+get_log_stream(const char *file, FILE **cached)
+{
+	if (!*cached)
+		*cached = open_fappend(file);
+
+	return *cached;
+}
+
+/* Close the persistent log streams. They will be reopened (against the
+ * current log file paths) by the next logged command/message. */
+void
+close_log_streams(void)
+{
+	if (cmds_log_fp) {
+		fclose(cmds_log_fp);
+		cmds_log_fp = (FILE *)NULL;
+	}
+
+	if (msgs_log_fp) {
+		fclose(msgs_log_fp);
+		msgs_log_fp = (FILE *)NULL;
+	}
+}
+
 static int
 gen_file(char *file)
 {
@@ -107,6 +288,8 @@ clear_logs(const int flag)
 	if (!file || !*file)
 		return FUNC_SUCCESS;
 
+	close_log_streams();
+
 	if (remove(file) == -1) {
 		xerror("log: '%s': %s\n", file, strerror(errno));
 		return errno;
@@ -156,7 +339,7 @@ log_cmd(void)
 	last_cmd = (char *)NULL;
 
 	/* Write the log into LOG_FILE */
-	FILE *log_fp = open_fappend(cmds_log_file);
+	FILE *log_fp = get_log_stream(cmds_log_file, &cmds_log_fp);
 	if (!log_fp) {
 		err('e', PRINT_PROMPT, "log: '%s': %s\n", cmds_log_file, strerror(errno));
 		free(full_log);
@@ -165,7 +348,7 @@ log_cmd(void)
 
 	fputs(full_log, log_fp);
 	free(full_log);
-	fclose(log_fp);
+	fflush(log_fp);
 
 	return FUNC_SUCCESS;
 }
@@ -174,7 +357,7 @@ log_cmd(void)
 static void
 write_msg_into_logfile(const char *_msg)
 {
-	FILE *fp = open_fappend(msgs_log_file);
+	FILE *fp = get_log_stream(msgs_log_file, &msgs_log_fp);
 	if (!fp) {
 		/* Do not log this error: We might enter into an infinite loop
 		 * trying to access a file that cannot be accessed. Just warn the user
@@ -187,7 +370,7 @@ write_msg_into_logfile(const char *_msg)
 
 	char *date = get_date();
 	fprintf(fp, "[%s] %s", date ? date : "unknown", _msg);
-	fclose(fp);
+	fflush(fp);
 	free(date);
 }
 
@@ -199,6 +382,12 @@ send_desktop_notification(char *msg)
 	if (!msg || !*msg)
 		return;
 
+	/* The first notification is run in the foreground to check that a
+	 * notification daemon is actually reachable. Once verified, further
+	 * notifications are detached, so the prompt does not wait for the
+	 * notifier process to complete. */
+	static int noti_bg = 0;
+
 	char type[12];
 	*type = '\0';
 
@@ -244,7 +433,7 @@ send_desktop_notification(char *msg)
 
 #if defined(__HAIKU__)
 	char *cmd[] = {"notify", "--type", type, "--title", PROGRAM_NAME, p, NULL};
-	ret = launch_execv(cmd, FOREGROUND, E_MUTE);
+	ret = launch_execv(cmd, noti_bg == 1 ? BACKGROUND : FOREGROUND, E_MUTE);
 #elif defined(__APPLE__)
 	size_t msg_len = strlen(msg) + strlen(type)
 		+ (sizeof(PROGRAM_NAME) - 1) + 60;
@@ -253,15 +442,19 @@ send_desktop_notification(char *msg)
 		"'display notification \"%s\" subtitle \"%s\" with title \"%s\"'",
 		msg, type, PROGRAM_NAME);
 	char *cmd[] = {"osascript", "-e", tmp_msg, NULL};
-	ret = launch_execv(cmd, FOREGROUND, E_MUTE);
+	ret = launch_execv(cmd, noti_bg == 1 ? BACKGROUND : FOREGROUND, E_MUTE);
 	free(tmp_msg);
 #else
 	char *cmd[] = {"notify-send", "-u", type, PROGRAM_NAME, p, NULL};
-	ret = launch_execv(cmd, FOREGROUND, E_MUTE);
+	ret = launch_execv(cmd, noti_bg == 1 ? BACKGROUND : FOREGROUND, E_MUTE);
 #endif /* __HAIKU__ */
 
-	if (ret == FUNC_SUCCESS)
+	if (ret == FUNC_SUCCESS) {
+		noti_bg = 1;
 		return;
+	}
+
+	noti_bg = 0;
 
 	/* Error: warn and print the original message */
 	xerror(_("%s: Notification daemon error: %s\n"
@@ -323,6 +516,124 @@ log_msg(char *_msg, const int print_prompt, const int logme,
 	write_msg_into_logfile(_msg);
 }
 
+/* Hash index over the directory history: maps a path to its most recent
+ * position in old_pwd. Every visit appends an entry, and only
+ * consecutive duplicates are skipped when the history file is truncated,
+ * so a long session accumulates the same directories over and over; the
+ * index lets the linear consumers (the suggestions engine, the dirhist
+ * tab completions, and the jump database sync) process each unique path
+ * once, at its most recent position. Open addressing with linear
+ * probing. Slots whose old_pwd entry was later deleted (first byte set
+ * to KEY_ESC: see navigation.c) just fail the string comparison and act
+ * as tombstones. */
+
+struct dirhist_idx_t {
+	size_t hash;
+	int pos; /* Position in old_pwd, or -1 for a free slot */
+	int pad0;
+};
+
+static struct dirhist_idx_t *dirhist_idx = (struct dirhist_idx_t *)NULL;
+static size_t dirhist_idx_cap = 0; /* Allocated slots (a power of two) */
+static size_t dirhist_idx_used = 0;
+static int dirhist_idx_dirty = 1;
+
+/* Mark the index as stale: it will be rebuilt on the next lookup.
+ * Called whenever old_pwd entries are freed or replaced wholesale
+ * (dirhist load/clear, profile switch). */
+void
+dirhist_index_invalidate(void)
+{
+	dirhist_idx_dirty = 1;
+}
+
+static void
+dirhist_index_insert(const size_t hash, const int pos)
+{
+	size_t i = hash & (dirhist_idx_cap - 1);
+
+	while (dirhist_idx[i].pos != -1) {
+		if (dirhist_idx[i].hash == hash && old_pwd[dirhist_idx[i].pos]
+		&& strcmp(old_pwd[dirhist_idx[i].pos], old_pwd[pos]) == 0) {
+			dirhist_idx[i].pos = pos; /* New latest occurrence */
+			return;
+		}
+		i = (i + 1) & (dirhist_idx_cap - 1);
+	}
+
+	dirhist_idx[i].hash = hash;
+	dirhist_idx[i].pos = pos;
+	dirhist_idx_used++;
+}
+
+static void
+dirhist_index_rebuild(void)
+{
+	size_t cap = 64;
+	while (cap < (size_t)(dirhist_total_index + 1) * 2)
+		cap <<= 1;
+
+	if (cap != dirhist_idx_cap) {
+		free(dirhist_idx);
+		dirhist_idx = xnmalloc(cap, sizeof(struct dirhist_idx_t));
+		dirhist_idx_cap = cap;
+	}
+
+	size_t i;
+	for (i = 0; i < dirhist_idx_cap; i++)
+		dirhist_idx[i].pos = -1;
+	dirhist_idx_used = 0;
+
+	int j;
+	for (j = 0; j < dirhist_total_index; j++) {
+		if (old_pwd[j] && *old_pwd[j] && *old_pwd[j] != KEY_ESC)
+			dirhist_index_insert(hashme(old_pwd[j], 1), j);
+	}
+
+	dirhist_idx_dirty = 0;
+}
+
+/* Record the entry just added at position POS by add_to_dirhist(). */
+static void
+dirhist_index_add(const int pos)
+{
+	if (dirhist_idx_dirty == 1)
+		return; /* The whole index is rebuilt on the next lookup */
+
+	if ((dirhist_idx_used + 1) * 2 > dirhist_idx_cap) {
+		dirhist_idx_dirty = 1; /* Table full: grow via a full rebuild */
+		return;
+	}
+
+	dirhist_index_insert(hashme(old_pwd[pos], 1), pos);
+}
+
+/* Return the most recent position of PATH in old_pwd, or -1 if PATH is
+ * not indexed. A consumer scanning the whole history can thus process
+ * each unique path exactly once: an entry whose position does not match
+ * is a duplicate of a more recent visit. */
+int
+dirhist_index_latest(const char *path)
+{
+	if (dirhist_idx_dirty == 1)
+		dirhist_index_rebuild();
+
+	if (dirhist_idx_used == 0)
+		return (-1);
+
+	const size_t hash = hashme(path, 1);
+	size_t i = hash & (dirhist_idx_cap - 1);
+
+	while (dirhist_idx[i].pos != -1) {
+		if (dirhist_idx[i].hash == hash && old_pwd[dirhist_idx[i].pos]
+		&& strcmp(old_pwd[dirhist_idx[i].pos], path) == 0)
+			return dirhist_idx[i].pos;
+		i = (i + 1) & (dirhist_idx_cap - 1);
+	}
+
+	return (-1);
+}
+
 static void
 append_to_dirhist_file(const char *dir_path)
 {
@@ -358,6 +669,7 @@ add_to_dirhist(const char *dir_path)
 
 		dirhist_cur_index = dirhist_total_index;
 		old_pwd[dirhist_total_index] = savestring(dir_path, strlen(dir_path));
+		dirhist_index_add(dirhist_total_index);
 
 		append_to_dirhist_file(dir_path);
 
@@ -373,10 +685,12 @@ add_to_dirhist(const char *dir_path)
 		old_pwd[dirhist_total_index] = savestring(
 		    old_pwd[dirhist_cur_index],
 		    strlen(old_pwd[dirhist_cur_index]));
+		dirhist_index_add(dirhist_total_index);
 		dirhist_total_index++;
 
 		dirhist_cur_index = dirhist_total_index;
 		old_pwd[dirhist_total_index] = savestring(dir_path, strlen(dir_path));
+		dirhist_index_add(dirhist_total_index);
 		dirhist_total_index++;
 
 		old_pwd[dirhist_total_index] = (char *)NULL;
@@ -386,6 +700,9 @@ add_to_dirhist(const char *dir_path)
 static int
 reload_history(void)
 {
+	/* Whatever is pending belongs to the history being discarded. */
+	hist_pending = 0;
+
 	clear_history();
 	read_history(hist_file);
 	history_truncate_file(hist_file, conf.max_hist);
@@ -399,6 +716,9 @@ reload_history(void)
 static int
 edit_history(char **args)
 {
+	/* Let the user edit the complete history. */
+	flush_cmdhist();
+
 	struct stat attr;
 	if (stat(hist_file, &attr) == -1) {
 		xerror("history: '%s': %s\n", hist_file, strerror(errno));
@@ -564,50 +884,193 @@ history_function(char **args)
 	return FUNC_SUCCESS;
 }
 
+/* Free the history array. Entries loaded from the history file point
+ * into the mapped file and own no heap memory: free only those added at
+ * runtime by add_to_cmdhist(). */
+void
+free_history(void)
+{
+	if (history) {
+		size_t i;
+		for (i = 0; history[i].cmd; i++) {
+			if (!hist_map || history[i].cmd < hist_map
+			|| history[i].cmd >= hist_map + hist_map_len)
+				free(history[i].cmd);
+		}
+
+		free(history);
+		history = (struct history_t *)NULL;
+	}
+
+	hist_index_free();
+	current_hist_n = 0;
+
+	if (hist_map) {
+		munmap(hist_map, hist_map_len);
+		hist_map = (char *)NULL;
+		hist_map_len = 0;
+	}
+}
+
+/* Move the current history state (the entries array plus the mapping of
+ * the history file it points into) into HS, leaving the in-memory history
+ * empty. Pending appends are flushed first, so the on-disk file stays
+ * complete for non-resident loads. Used to keep profile state resident
+ * across profile switches (see profiles.c). */
+void
+hist_state_stash(struct hist_state_t *hs)
+{
+	flush_cmdhist();
+
+	hs->entries = history;
+	hs->map = hist_map;
+	hs->map_len = hist_map_len;
+	hs->n = current_hist_n;
+	hs->index = curhistindex;
+
+	history = (struct history_t *)NULL;
+	hist_map = (char *)NULL;
+	hist_map_len = 0;
+	current_hist_n = 0;
+	curhistindex = 0;
+}
+
+/* Move the history state stored in HS (see hist_state_stash()) back into
+ * the history globals and rebuild readline's history list from it, instead
+ * of re-reading and re-parsing the history file. HS is emptied. */
+void
+hist_state_restore(struct hist_state_t *hs)
+{
+	free_history();
+	clear_history(); /* This is for readline */
+
+	history = hs->entries;
+	hist_map = hs->map;
+	hist_map_len = hs->map_len;
+	current_hist_n = hs->n;
+	curhistindex = hs->index;
+
+	size_t i;
+	for (i = 0; i < current_hist_n; i++)
+		add_history(history[i].cmd);
+
+	hist_index_build();
+
+	memset(hs, '\0', sizeof(*hs));
+}
+
+/* Free the history state stored in HS (same logic as free_history(),
+ * applied to a stashed copy instead of the globals). */
+void
+hist_state_free(struct hist_state_t *hs)
+{
+	if (hs->entries) {
+		size_t i;
+		for (i = 0; hs->entries[i].cmd; i++) {
+			if (!hs->map || hs->entries[i].cmd < hs->map
+			|| hs->entries[i].cmd >= hs->map + hs->map_len)
+				free(hs->entries[i].cmd);
+		}
+
+		free(hs->entries);
+	}
+
+	if (hs->map)
+		munmap(hs->map, hs->map_len);
+
+	memset(hs, '\0', sizeof(*hs));
+}
+
 int
 get_history(void)
 {
 	if (config_ok == 0 || !hist_file) return FUNC_FAILURE;
 
-	if (current_hist_n == 0) { /* Coming from main() */
-		history = xcalloc(1, sizeof(struct history_t));
-	} else { /* Only true when comming from 'history clear' */
-		size_t i;
-		for (i = 0; history[i].cmd; i++)
-			free(history[i].cmd);
-		history = xnrealloc(history, 1, sizeof(struct history_t));
-		current_hist_n = 0;
+	free_history();
+	history = xcalloc(1, sizeof(struct history_t));
+	curhistindex = 0;
+
+	struct stat attr;
+	const int fd = open(hist_file, O_RDONLY);
+	if (fd == -1 || fstat(fd, &attr) == -1) {
+		err('e', PRINT_PROMPT, "history: '%s': %s\n", hist_file,
+			strerror(errno));
+		if (fd != -1)
+			close(fd);
+		return FUNC_FAILURE;
 	}
 
-	FILE *hist_fp = fopen(hist_file, "r");
-	if (!hist_fp) {
-		err('e', PRINT_PROMPT, "history: '%s': %s\n", hist_file, strerror(errno));
+	if (attr.st_size == 0) { /* Empty file: nothing to load. */
+		close(fd);
+		return FUNC_SUCCESS;
+	}
+
+	char *map = mmap(NULL, (size_t)attr.st_size, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		err('e', PRINT_PROMPT, "history: '%s': %s\n", hist_file,
+			strerror(errno));
 		return FUNC_FAILURE;
 	}
 
-	size_t line_size = 0;
-	char *line_buff = (char *)NULL;
-	ssize_t line_len = 0;
+	hist_map = map;
+	hist_map_len = (size_t)attr.st_size;
+
+	/* One entry per line is an upper bound: empty and timestamp lines
+	 * take no entry. */
+	size_t lines = 0;
+	char *p = map, *end = map + hist_map_len;
+	while (p < end && (p = memchr(p, '\n', (size_t)(end - p)))) {
+		lines++;
+		p++;
+	}
+
+	/* Plus one for a possible last line lacking a newline, one for the
+	 * terminating sentinel. */
+	history = xnrealloc(history, lines + 2, sizeof(struct history_t));
+
 	time_t tdate = -1;
+	char *line = map;
+
+	while (line < end) {
+		char *nl = memchr(line, '\n', (size_t)(end - line));
+		size_t line_len;
+		char *cmd;
+
+		if (nl) {
+			*nl = '\0'; /* Patched in the mapping only. */
+			line_len = (size_t)(nl - line);
+			cmd = line;
+			line = nl + 1;
+		} else {
+			/* Last line lacks a newline: there might be no room in the
+			 * mapping for the terminating NUL byte, so take a copy. */
+			line_len = (size_t)(end - line);
+			cmd = savestring(line, line_len);
+			line = end;
+		}
+
+		const int mapped = (nl != NULL);
 
-	while ((line_len = getline(&line_buff, &line_size, hist_fp)) > 0) {
-		line_buff[line_len - 1] = '\0';
-		if (!*line_buff)
+		if (line_len == 0) {
+			if (mapped == 0)
+				free(cmd);
 			continue;
+		}
 
 		/* Store the command timestamp and continue: the next line is
 		 * the cmd itself. */
-		if (*line_buff == history_comment_char && *(line_buff + 1)
-		&& is_number(line_buff + 1)) {
-			int d = atoi(line_buff + 1);
+		if (*cmd == history_comment_char && cmd[1] && is_number(cmd + 1)) {
+			int d = atoi(cmd + 1);
 			tdate = d == INT_MIN ? -1 : (time_t)d;
+			if (mapped == 0)
+				free(cmd);
 			continue;
 		}
 
-		history = xnrealloc(history, current_hist_n + 2,
-			sizeof(struct history_t));
-		history[current_hist_n].cmd = savestring(line_buff, (size_t)line_len);
-		history[current_hist_n].len = (size_t)line_len;
+		history[current_hist_n].cmd = cmd;
+		history[current_hist_n].len = line_len;
 		history[current_hist_n].date = tdate;
 		tdate = -1;
 		current_hist_n++;
@@ -617,8 +1080,7 @@ get_history(void)
 	history[current_hist_n].cmd = (char *)NULL;
 	history[current_hist_n].len = 0;
 	history[current_hist_n].date = -1;
-	free(line_buff);
-	fclose(hist_fp);
+	hist_index_build();
 	return FUNC_SUCCESS;
 }
 
@@ -641,8 +1103,11 @@ add_to_cmdhist(char *cmd)
 	/* For readline */
 	add_history(cmd);
 
-	if (config_ok == 1 && hist_status == 1 && hist_file)
-		append_history(1, hist_file);
+	/* Appends to the history file are batched: just count the new entry
+	 * and flush once enough of them piled up. */
+	hist_pending++;
+	if (hist_pending >= HIST_PENDING_MAX)
+		flush_cmdhist();
 
 	/* For us */
 	/* Add the new input to the history array */
@@ -652,6 +1117,7 @@ add_to_cmdhist(char *cmd)
 	history[current_hist_n].cmd = savestring(cmd, cmd_len);
 	history[current_hist_n].len = cmd_len;
 	history[current_hist_n].date = tdate;
+	hist_index_add(current_hist_n);
 	current_hist_n++;
 	history[current_hist_n].cmd = (char *)NULL;
 	history[current_hist_n].len = 0;
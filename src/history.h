@@ -33,12 +33,31 @@
 #define MSG_LOGS 1
 #define CMD_LOGS 0
 
+/* Parsed command history state of a profile, kept resident in memory
+ * across profile switches (see profiles.c). */
+struct hist_state_t {
+	struct history_t *entries;
+	char *map;      /* Mapping of the history file (entries point into it) */
+	size_t map_len;
+	size_t n;       /* Number of entries (current_hist_n) */
+	size_t index;   /* Current history index (curhistindex) */
+};
+
 __BEGIN_DECLS
 
 void add_to_cmdhist(char *cmd);
 void add_to_dirhist(const char *dir_path);
+void dirhist_index_invalidate(void);
+int  dirhist_index_latest(const char *path);
 int  clear_logs(const int flag);
+void close_log_streams(void);
+void flush_cmdhist(void);
+void free_history(void);
+struct history_t *history_prefix_find(const char *str, const size_t len);
 int  get_history(void);
+void hist_state_free(struct hist_state_t *hs);
+void hist_state_restore(struct hist_state_t *hs);
+void hist_state_stash(struct hist_state_t *hs);
 int  history_function(char **args);
 int  log_cmd(void);
 void log_msg(char *_msg, const int print_prompt, const int logme,
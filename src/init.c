@@ -27,9 +27,12 @@
 #include <errno.h>
 #include <grp.h> /* getgrouplist(), getgrent(), setgrent(), endgrent() */
 #include <pwd.h> /* getpwent(), setpwent(), endpwent() */
+#include <pthread.h> /* startup stages (start_init_stages()) */
+#include <fcntl.h> /* open(2) (load_jumpdb_bin()) */
 #include <signal.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/mman.h> /* mmap(2) (load_jumpdb_bin()) */
 #include <termios.h>
 #include <time.h>
 #include <unistd.h>
@@ -57,13 +60,19 @@
 #include "aux.h"
 #include "checks.h" /* truncate_file(), is_number() */
 #include "config.h"
+#include "history.h" /* dirhist_index_latest() */
 #include "jump.h" /* add_to_jumpdb() */
 #include "misc.h"
 #include "navigation.h"
+#include "remotes.h" /* probe_remotes() */
 #include "sanitize.h"
 #include "selection.h"
+#include "snapshot.h" /* snapshot_restored(), snapshot_stamp() */
 #include "sort.h"
 #include "spawn.h"
+#ifndef _NO_SUGGESTIONS
+# include "suggestions.h" /* update_cmds_index() */
+#endif /* !_NO_SUGGESTIONS */
 
 /* We need this for get_user_groups() */
 #if !defined(NGROUPS_MAX)
@@ -198,6 +207,7 @@ init_conf_struct(void)
 	conf.ext_cmd_ok = UNSET;
 	conf.files_counter = UNSET;
 	conf.follow_symlinks_long = DEF_FOLLOW_SYMLINKS_LONG;
+	conf.approx_dir_size = UNSET;
 	conf.full_dir_size = UNSET;
 	conf.fuzzy_match = UNSET;
 	conf.fuzzy_match_algo = UNSET;
@@ -212,6 +222,7 @@ init_conf_struct(void)
 #else
 	conf.icons = 0;
 #endif /* !_NO_ICONS */
+	conf.big_dir_threshold = UNSET;
 	conf.light_mode = UNSET;
 	conf.list_dirs_first = UNSET;
 	conf.listing_mode = UNSET;
@@ -544,6 +555,7 @@ int
 init_history(void)
 {
 	/* Shrink the log and the directory history files */
+	close_log_streams();
 	if (msgs_log_file)
 		truncate_file(msgs_log_file, conf.max_log, 0);
 	if (cmds_log_file)
@@ -989,32 +1001,168 @@ sync_jumpdb_with_dirhist(void)
 	if (!old_pwd)
 		return;
 
-	int i = dirhist_total_index;
-	size_t j = 0;
+	/* Checking every dirhist entry against every jump entry is quadratic
+	 * (and the dirhist may hold thousands of entries, most of them
+	 * duplicated visits). Probe a hash set over the jump database paths
+	 * instead, and let each unique dirhist path be checked only once. */
+	size_t cap = 64;
+	while (cap < (jump_n + 1) * 2)
+		cap <<= 1;
+
+	/* Each slot holds a jump_db position + 1 (zero means a free slot). */
+	size_t *jump_set = xcalloc(cap, sizeof(size_t));
+
+	size_t j;
+	for (j = 0; j < jump_n; j++) {
+		if (!jump_db[j].path || !*jump_db[j].path)
+			continue;
+
+		size_t s = hashme(jump_db[j].path, 1) & (cap - 1);
+		while (jump_set[s] != 0
+		&& strcmp(jump_db[jump_set[s] - 1].path, jump_db[j].path) != 0)
+			s = (s + 1) & (cap - 1);
 
+		if (jump_set[s] == 0)
+			jump_set[s] = j + 1;
+	}
+
+	int i = dirhist_total_index;
 	while (--i >= 0) {
 		if (!old_pwd[i] || !*old_pwd[i])
 			continue;
 
-		const size_t old_pwd_len = strlen(old_pwd[i]);
+		if (dirhist_index_latest(old_pwd[i]) > i)
+			continue; /* Duplicate of a more recent visit */
 
-		int found = 0;
-		for (j = 0; j < jump_n; j++) {
-			if (!jump_db[j].path || !*jump_db[j].path
-			|| old_pwd[i][1] != jump_db[j].path[1]
-			|| old_pwd_len != jump_db[j].len
-			|| old_pwd[i][old_pwd_len - 1] != jump_db[j].path[jump_db[j].len - 1])
-				continue;
+		size_t s = hashme(old_pwd[i], 1) & (cap - 1);
+		while (jump_set[s] != 0
+		&& strcmp(jump_db[jump_set[s] - 1].path, old_pwd[i]) != 0)
+			s = (s + 1) & (cap - 1);
+
+		if (jump_set[s] == 0)
+			add_to_jumpdb(old_pwd[i]);
+	}
+
+	free(jump_set);
+}
+
+/* Load the binary jump database FILE (see jump.h for the format) by
+ * mapping it read-only into memory. Records beyond the entry count
+ * declared in the header are incremental appends made at visit time
+ * (jump.c:append_jumpdb_bin()) and are merged into their base entries.
+ * Return FUNC_SUCCESS if the database was loaded, or FUNC_FAILURE to let
+ * the caller fall back to the text database. */
+static int
+load_jumpdb_bin(const char *file)
+{
+	const int fd = open(file, O_RDONLY);
+	if (fd == -1)
+		return FUNC_FAILURE;
 
-			if (strcmp(old_pwd[i] + 1, jump_db[j].path + 1) == 0) {
-				found = 1;
-				break;
+	struct stat a;
+	if (fstat(fd, &a) == -1
+	|| a.st_size < (off_t)sizeof(struct jumpdb_bin_hdr_t)) {
+		close(fd);
+		return FUNC_FAILURE;
+	}
+
+	const size_t map_len = (size_t)a.st_size;
+	char *map = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return FUNC_FAILURE;
+
+	/* Record fields are memcpy'ed into local structs: entries start at
+	 * arbitrary offsets (paths have variable lengths), so they cannot be
+	 * dereferenced in place. */
+	struct jumpdb_bin_hdr_t hdr;
+	memcpy(&hdr, map, sizeof(hdr));
+
+	if (memcmp(hdr.magic, JUMPDB_BIN_MAGIC, sizeof(hdr.magic)) != 0
+	|| hdr.version != JUMPDB_BIN_VERSION) {
+		munmap(map, map_len);
+		return FUNC_FAILURE;
+	}
+
+	jump_total_rank = (int)hdr.total_rank;
+
+	size_t capacity = (size_t)hdr.entries + 2;
+	jump_db = xnmalloc(capacity, sizeof(struct jump_t));
+
+	const char *p = map + sizeof(hdr);
+	const char *end = map + map_len;
+	size_t rec = 0;
+
+	while (p + sizeof(struct jumpdb_bin_entry_t) <= end) {
+		struct jumpdb_bin_entry_t e;
+		memcpy(&e, p, sizeof(e));
+		p += sizeof(e);
+
+		if (e.path_len == 0 || (size_t)(end - p) < (size_t)e.path_len + 1
+		|| p[e.path_len] != '\0')
+			break; /* Truncated or corrupted tail: stop here. */
+
+		const char *path = p;
+		p += e.path_len + 1;
+		rec++;
+
+		if (rec > (size_t)hdr.entries) {
+			/* Incremental append: merge it into its base entry. */
+			size_t j = jump_n;
+			int found = 0;
+			while (j-- > 0) {
+				if (jump_db[j].len == e.path_len && jump_db[j].path
+				&& strcmp(jump_db[j].path, path) == 0) {
+					jump_db[j].visits += (size_t)e.visits;
+					if ((time_t)e.last_visit > jump_db[j].last_visit)
+						jump_db[j].last_visit = (time_t)e.last_visit;
+					found = 1;
+					break;
+				}
 			}
+			if (found == 1)
+				continue;
 		}
 
-		if (found == 0)
-			add_to_jumpdb(old_pwd[i]);
+		/* Purge the database from non-existent directories. */
+		if (conf.purge_jumpdb == 1 && access(path, F_OK) == -1)
+			continue;
+
+		if (jump_n + 2 > capacity) {
+			capacity += 32;
+			jump_db = xnrealloc(jump_db, capacity, sizeof(struct jump_t));
+		}
+
+		jump_db[jump_n].visits = (size_t)e.visits;
+		jump_db[jump_n].first_visit = (time_t)e.first_visit;
+		jump_db[jump_n].last_visit = (time_t)e.last_visit;
+		jump_db[jump_n].keep = (int)e.keep;
+		jump_db[jump_n].rank = 0;
+		jump_db[jump_n].rank_gen = 0;
+		jump_db[jump_n].len = e.path_len;
+		jump_db[jump_n].path = savestring(path, e.path_len);
+		jump_n++;
 	}
+
+	munmap(map, map_len);
+
+	if (jump_n == 0) {
+		free(jump_db);
+		jump_db = (struct jump_t *)NULL;
+		return FUNC_FAILURE;
+	}
+
+	jump_db[jump_n].path = (char *)NULL;
+	jump_db[jump_n].len = 0;
+	jump_db[jump_n].rank = 0;
+	jump_db[jump_n].rank_gen = 0;
+	jump_db[jump_n].keep = 0;
+	jump_db[jump_n].visits = 0;
+	jump_db[jump_n].first_visit = -1;
+
+	sync_jumpdb_with_dirhist();
+
+	return FUNC_SUCCESS;
 }
 
 /* Reconstruct the jump database from the database file. */
@@ -1024,6 +1172,17 @@ load_jumpdb(void)
 	if (xargs.no_dirjump == 1 || config_ok == 0 || !config_dir)
 		return;
 
+	/* Try the binary database first. The text file is kept as the
+	 * import/export format for 'j --edit'. */
+	char *bin_file = xnmalloc(config_dir_len + 16, sizeof(char));
+	snprintf(bin_file, config_dir_len + 16, "%s/jump.clifm%s",
+		config_dir, JUMPDB_BIN_SUFFIX);
+	const int bin_ok = load_jumpdb_bin(bin_file);
+	free(bin_file);
+
+	if (bin_ok == FUNC_SUCCESS)
+		return;
+
 	char *jump_file = xnmalloc(config_dir_len + 12, sizeof(char));
 	snprintf(jump_file, config_dir_len + 12, "%s/jump.clifm", config_dir);
 
@@ -1137,6 +1296,7 @@ load_jumpdb(void)
 
 		jump_db[jump_n].keep = keep;
 		jump_db[jump_n].rank = 0;
+		jump_db[jump_n].rank_gen = 0;
 		jump_db[jump_n].len = strlen(tmpc);
 		jump_db[jump_n].path = savestring(tmpc, jump_db[jump_n].len);
 		jump_n++;
@@ -1155,6 +1315,7 @@ load_jumpdb(void)
 	jump_db[jump_n].path = (char *)NULL;
 	jump_db[jump_n].len = 0;
 	jump_db[jump_n].rank = 0;
+	jump_db[jump_n].rank_gen = 0;
 	jump_db[jump_n].keep = 0;
 	jump_db[jump_n].visits = 0;
 	jump_db[jump_n].first_visit = -1;
@@ -1177,6 +1338,9 @@ save_bm_path(char *file)
 int
 load_bookmarks(void)
 {
+	if (snapshot_restored(SNAP_BOOKMARKS))
+		return FUNC_SUCCESS;
+
 	if (create_bm_file() == FUNC_FAILURE)
 		return FUNC_FAILURE;
 
@@ -1296,6 +1460,7 @@ load_bookmarks(void)
 
 	free(line);
 	fclose(fp);
+	snapshot_stamp(SNAP_BOOKMARKS, bm_file);
 
 	if (bm_n == 0) {
 		free(bookmarks);
@@ -1317,6 +1482,9 @@ load_actions(void)
 	if (config_ok == 0 || !actions_file)
 		return FUNC_FAILURE;
 
+	if (snapshot_restored(SNAP_ACTIONS))
+		return FUNC_SUCCESS;
+
 	/* Free the actions struct array */
 	if (actions_n > 0) {
 		int i = (int)actions_n;
@@ -1336,18 +1504,18 @@ load_actions(void)
 	if (!fp)
 		return FUNC_FAILURE;
 
-	size_t line_size = 0;
-	char *line = (char *)NULL;
-	ssize_t line_len = 0;
+	char *buf = load_file_to_buf(fd);
+	fclose(fp);
 
-	while ((line_len = getline(&line, &line_size, fp)) > 0) {
-		if (!line || !*line || *line == '#' || *line == '\n')
+	char *p = buf;
+	char *line;
+	size_t line_len;
+
+	while ((line = get_buf_line(&p, &line_len))) {
+		if (!*line || *line == '#')
 			continue;
-		if (line[line_len - 1] == '\n')
-			line[line_len - 1] = '\0';
 
-		char *tmp = (char *)NULL;
-		tmp = strrchr(line, '=');
+		char *tmp = strrchr(line, '=');
 		if (!tmp)
 			continue;
 
@@ -1360,8 +1528,8 @@ load_actions(void)
 		actions_n++;
 	}
 
-	free(line);
-	fclose(fp);
+	free(buf);
+	snapshot_stamp(SNAP_ACTIONS, actions_file);
 	return FUNC_SUCCESS;
 }
 
@@ -1378,6 +1546,21 @@ reset_remotes_values(const size_t i)
 	remotes[i].mounted = 0;
 }
 
+/* Keywords recognized in a remotes file section. The IDs are indexes
+ * into REMOTES_KWS, as returned by lookup_keyword(). */
+enum remotes_opt { RMT_COMMENT, RMT_MOUNTPOINT, RMT_MOUNT_CMD,
+	RMT_UNMOUNT_CMD, RMT_AUTO_UNMOUNT, RMT_AUTO_MOUNT };
+
+static struct keyword_t remotes_kws[] = {
+	{"Comment", 0},
+	{"Mountpoint", 0},
+	{"MountCmd", 0},
+	{"UnmountCmd", 0},
+	{"AutoUnmount", 0},
+	{"AutoMount", 0},
+	{NULL, 0},
+};
+
 /* Load remotes information from REMOTES_FILE. */
 int
 load_remotes(void)
@@ -1396,11 +1579,15 @@ load_remotes(void)
 	remotes = xnmalloc(n + 1, sizeof(struct remote_t));
 	reset_remotes_values(n);
 
-	size_t line_sz = 0;
-	char *line = (char *)NULL;
+	char *buf = load_file_to_buf(fd);
+	fclose(fp);
 
-	while (getline(&line, &line_sz, fp) > 0) {
-		if (!*line || *line == '#' || *line == '\n')
+	char *p = buf;
+	char *line;
+	size_t line_len;
+
+	while ((line = get_buf_line(&p, &line_len))) {
+		if (!*line || *line == '#')
 			continue;
 		if (*line == '[') {
 			if (remotes[n].name)
@@ -1427,28 +1614,32 @@ load_remotes(void)
 		if (!remotes[n].name)
 			continue;
 
-		char *ret = strchr(line, '=');
-		if (!ret)
+		const size_t key_len = strcspn(line, "=");
+		if (!line[key_len])
 			continue;
-		if (!*(++ret))
+
+		char *ret = line + key_len + 1;
+		if (!*ret)
 			continue;
 
 		size_t ret_len = strlen(ret);
-		if (ret_len > 0 && ret[ret_len - 1] == '\n') {
-			ret_len--;
-			ret[ret_len] = '\0';
-		}
+
+		const int kw = lookup_keyword(remotes_kws, line, key_len);
+		if (kw == -1)
+			continue;
 
 		char *deq_str = remove_quotes(ret);
 		if (deq_str)
 			ret = deq_str;
 
-		if (strncmp(line, "Comment=", 8) == 0) {
+		switch (kw) {
+		case RMT_COMMENT:
 			remotes[n].desc = xnrealloc(remotes[n].desc,
 				ret_len + 1, sizeof(char));
 			xstrsncpy(remotes[n].desc, ret, ret_len + 1);
+			break;
 
-		} else if (strncmp(line, "Mountpoint=", 11) == 0) {
+		case RMT_MOUNTPOINT: {
 			char *tmp = (char *)NULL;
 			if (*ret == '~')
 				tmp = tilde_expand(ret);
@@ -1457,10 +1648,10 @@ load_remotes(void)
 				mnt_len + 1, sizeof(char));
 			xstrsncpy(remotes[n].mountpoint, tmp ? tmp : ret, mnt_len + 1);
 			free(tmp);
-			if (count_dir(remotes[n].mountpoint, CPOP) > 2)
-				remotes[n].mounted = 1;
+			break;
+		}
 
-		} else if (strncmp(line, "MountCmd=", 9) == 0) {
+		case RMT_MOUNT_CMD: {
 			int replaced = 0;
 			if (remotes[n].mountpoint) {
 				char *rep = replace_substr(ret, "%m", remotes[n].mountpoint);
@@ -1479,8 +1670,10 @@ load_remotes(void)
 					ret_len + 1, sizeof(char));
 				xstrsncpy(remotes[n].mount_cmd, ret, ret_len + 1);
 			}
+			break;
+		}
 
-		} else if (strncmp(line, "UnmountCmd=", 11) == 0) {
+		case RMT_UNMOUNT_CMD: {
 			int replaced = 0;
 			if (remotes[n].mountpoint) {
 				char *rep = replace_substr(ret, "%m", remotes[n].mountpoint);
@@ -1499,21 +1692,24 @@ load_remotes(void)
 					ret_len + 1, sizeof(char));
 				xstrsncpy(remotes[n].unmount_cmd, ret, ret_len + 1);
 			}
+			break;
+		}
 
-		} else if (strncmp(line, "AutoUnmount=", 12) == 0) {
+		case RMT_AUTO_UNMOUNT:
 			if (strcmp(ret, "true") == 0)
 				remotes[n].auto_unmount = 1;
+			break;
 
-		} else {
-			if (strncmp(line, "AutoMount=", 10) == 0) {
-				if (strcmp(ret, "true") == 0)
-					remotes[n].auto_mount = 1;
-			}
+		case RMT_AUTO_MOUNT:
+			if (strcmp(ret, "true") == 0)
+				remotes[n].auto_mount = 1;
+			break;
+
+		default: break;
 		}
 	}
 
-	free(line);
-	fclose(fp);
+	free(buf);
 
 	if (remotes[n].name) {
 		++n;
@@ -1521,6 +1717,9 @@ load_remotes(void)
 	}
 
 	remotes_n = n;
+	/* Probe mountpoints asynchronously: a dead remote mount must not
+	 * block startup until the kernel times out. */
+	probe_remotes();
 	return FUNC_SUCCESS;
 }
 
@@ -1567,10 +1766,29 @@ ERROR:
 	return (char *)NULL;
 }
 
+/* Keywords recognized in a prompts file section. The IDs are indexes
+ * into PROMPTS_KWS, as returned by lookup_keyword(). */
+enum prompts_opt { PMT_NOTIFICATIONS, PMT_REGULAR, PMT_ENABLE_WARNING,
+	PMT_WARNING };
+
+static struct keyword_t prompts_kws[] = {
+	{"Notifications", 0},
+	{"RegularPrompt", 0},
+	{"EnableWarningPrompt", 0},
+	{"WarningPrompt", 0},
+	{NULL, 0},
+};
+
 /* Load prompts from PROMPTS_FILE. */
 int
 load_prompts(void)
 {
+	if (snapshot_restored(SNAP_PROMPTS)) {
+		if (conf.encoded_prompt)
+			expand_prompt_name(conf.encoded_prompt);
+		return FUNC_SUCCESS;
+	}
+
 	free_prompts();
 	free(prompts_file);
 	prompts_file = set_prompts_file();
@@ -1588,10 +1806,14 @@ load_prompts(void)
 	prompts = xnmalloc(n + 1, sizeof(struct prompts_t));
 	unset_prompt_values(n);
 
-	size_t line_sz = 0;
-	char *line = (char *)NULL;
+	char *buf = load_file_to_buf(fd);
+	fclose(fp);
+
+	char *p = buf;
+	char *line;
+	size_t line_len;
 
-	while (getline(&line, &line_sz, fp) > 0) {
+	while ((line = get_buf_line(&p, &line_len))) {
 		if (SKIP_LINE(*line))
 			continue;
 
@@ -1620,17 +1842,21 @@ load_prompts(void)
 		if (!prompts[n].name)
 			continue;
 
-		char *ret = strchr(line, '=');
-		if (!ret || !*(++ret))
+		const size_t key_len = strcspn(line, "=");
+		if (!line[key_len])
+			continue;
+
+		char *ret = line + key_len + 1;
+		if (!*ret)
 			continue;
 
 		size_t ret_len = strlen(ret);
-		if (ret_len > 0 && ret[ret_len - 1] == '\n') {
-			ret_len--;
-			ret[ret_len] = '\0';
-		}
 
-		if (*line == 'N' && strncmp(line, "Notifications=", 14) == 0) {
+		const int kw = lookup_keyword(prompts_kws, line, key_len);
+		if (kw == -1)
+			continue;
+
+		if (kw == PMT_NOTIFICATIONS) {
 			if (*ret == 't' && strcmp(ret, "true") == 0)
 				prompts[n].notifications = 1;
 			else if (*ret == 'f' && strcmp(ret, "false") == 0)
@@ -1644,32 +1870,33 @@ load_prompts(void)
 		if (deq_str)
 			ret = deq_str;
 
-		if (strncmp(line, "RegularPrompt=", 14) == 0) {
+		switch (kw) {
+		case PMT_REGULAR:
 			prompts[n].regular = xnrealloc(prompts[n].regular,
 				ret_len + 1, sizeof(char));
 			xstrsncpy(prompts[n].regular, ret, ret_len + 1);
-			continue;
-		}
+			break;
 
-		if (strncmp(line, "EnableWarningPrompt=", 20) == 0) {
+		case PMT_ENABLE_WARNING:
 			if (*ret == 't' && strcmp(ret, "true") == 0)
 				prompts[n].warning_prompt_enabled = 1;
 			else if (*ret == 'f' && strcmp(ret, "false") == 0)
 				prompts[n].warning_prompt_enabled = 0;
 			else
 				prompts[n].warning_prompt_enabled = DEF_WARNING_PROMPT;
-			continue;
-		}
+			break;
 
-		if (strncmp(line, "WarningPrompt=", 14) == 0) {
+		case PMT_WARNING:
 			prompts[n].warning = xnrealloc(prompts[n].warning,
 				ret_len + 1, sizeof(char));
 			xstrsncpy(prompts[n].warning, ret, ret_len + 1);
+			break;
+
+		default: break;
 		}
 	}
 
-	free(line);
-	fclose(fp);
+	free(buf);
 
 	if (prompts[n].name) {
 		++n;
@@ -1677,6 +1904,7 @@ load_prompts(void)
 	}
 
 	prompts_n = n;
+	snapshot_stamp(SNAP_PROMPTS, prompts_file);
 
 	if (conf.encoded_prompt)
 		expand_prompt_name(conf.encoded_prompt);
@@ -1691,6 +1919,7 @@ unset_xargs(void)
 	xargs.auto_open = UNSET;
 	xargs.autocd = UNSET;
 	xargs.autols= UNSET;
+	xargs.batch = UNSET;
 	xargs.bell_style = UNSET;
 	xargs.bm_file = UNSET;
 	xargs.case_sens_dirjump = UNSET;
@@ -1737,6 +1966,7 @@ unset_xargs(void)
 	xargs.icons_use_file_color = UNSET;
 #endif /* !_NO_ICONS */
 	xargs.int_vars = UNSET;
+	xargs.ipc = UNSET;
 	xargs.light = UNSET;
 	xargs.list_and_quit = UNSET;
 	xargs.longview = UNSET;
@@ -1818,6 +2048,10 @@ void
 init_shell(void)
 {
 	if (isatty(STDIN_FILENO) == 0) { /* Shell is not interactive */
+		/* In batch mode stdin is the command stream, not a list of
+		 * file names to be handled via a virtual directory. */
+		if (xargs.batch == 1)
+			return;
 		errno = 0;
 		exit_code = handle_stdin();
 		return;
@@ -1894,6 +2128,7 @@ get_sel_files(void)
 		return FUNC_FAILURE;
 
 	struct stat a;
+	size_t del_records = 0;
 	/* Since this file contains only paths, PATH_MAX should be enough. */
 	char line[PATH_MAX + 1]; *line = '\0';
 	while (fgets(line, (int)sizeof(line), fp) != NULL) {
@@ -1912,6 +2147,23 @@ get_sel_files(void)
 			line[len] = '\0';
 		}
 
+		if (*line == '#' && line[1] == '-' && line[2]) {
+			/* A removal record appended by save_sel(): deselect the
+			 * matching entry loaded above. Records are bounded by the
+			 * log compaction threshold, so a backward scan is fine. */
+			del_records++;
+			filesn_t j = (filesn_t)sel_n;
+			while (--j >= 0) {
+				if (sel_elements[j].name
+				&& strcmp(sel_elements[j].name, line + 2) == 0) {
+					free(sel_elements[j].name);
+					sel_elements[j].name = (char *)NULL;
+					break;
+				}
+			}
+			continue;
+		}
+
 		if (!*line || *line == '#' || len == 0)
 			continue;
 
@@ -1933,6 +2185,26 @@ get_sel_files(void)
 	}
 
 	fclose(fp);
+
+	if (del_records > 0 && sel_n > 0) {
+		/* Compact the entries cleared by removal records. */
+		size_t j, k = 0;
+		for (j = 0; j < sel_n; j++) {
+			if (!sel_elements[j].name)
+				continue;
+			if (k != j) {
+				sel_elements[k] = sel_elements[j];
+				sel_devino[k] = sel_devino[j];
+			}
+			k++;
+		}
+		sel_n = k;
+		sel_elements[sel_n].name = (char *)NULL;
+		sel_elements[sel_n].size = (off_t)UNSET;
+	}
+
+	sel_log_sync(del_records);
+
 	/* If previous and current amount of sel files don't match (mostly
 	 * because some selected files were removed), recreate the selections
 	 * file to reflect current state. */
@@ -2279,6 +2551,228 @@ skip_this_path(char *name)
 	return 0;
 }
 
+/* A persistent cache of command names found in PATH directories.
+ *
+ * Scanning every directory in PATH (get_path_programs()) involves a
+ * scandir(3) call per directory, each one sorting hundreds or thousands
+ * of entries. Since PATH directories rarely change, we persist the
+ * scanned names, together with each directory's modification time, in a
+ * cache file (cmdscache.clifm in the configuration directory), so that
+ * both warm startups and reload_binaries() (exec.c) only rescan those
+ * directories whose modification time actually changed. */
+#define CMDS_CACHE_VERSION 1
+
+struct cmds_cache_dir_t {
+	char *path;     /* The PATH directory these names belong to. */
+	char **names;   /* Command names, in the order they are consumed. */
+	size_t names_n;
+	size_t names_cap;
+	time_t mtime;   /* The directory's mtime at scan time. */
+};
+
+static struct cmds_cache_dir_t *cmds_cache = (struct cmds_cache_dir_t *)NULL;
+static size_t cmds_cache_n = 0;
+static int cmds_cache_ok = 0;     /* Caching enabled and cache loaded. */
+static int cmds_cache_loaded = 0;
+static int cmds_cache_dirty = 0;  /* Some directory was rescanned. */
+
+/* Return the name of the commands cache file, or NULL if caching is
+ * disabled (no config dir, stealth mode, or a sanitized environment). */
+static char *
+get_cmds_cache_file(void)
+{
+	if (!config_dir || !*config_dir || xargs.stealth_mode == 1
+	|| xargs.secure_env == 1 || xargs.secure_env_full == 1)
+		return (char *)NULL;
+
+	const size_t len = config_dir_len + 17;
+	char *file = xnmalloc(len, sizeof(char));
+	snprintf(file, len, "%s/cmdscache.clifm", config_dir);
+
+	return file;
+}
+
+void
+free_cmds_cache(void)
+{
+	size_t i, j;
+	for (i = 0; i < cmds_cache_n; i++) {
+		for (j = 0; j < cmds_cache[i].names_n; j++)
+			free(cmds_cache[i].names[j]);
+		free(cmds_cache[i].names);
+		free(cmds_cache[i].path);
+	}
+
+	free(cmds_cache);
+	cmds_cache = (struct cmds_cache_dir_t *)NULL;
+	cmds_cache_n = 0;
+	cmds_cache_ok = cmds_cache_loaded = cmds_cache_dirty = 0;
+}
+
+/* Return the cache entry for the directory DIR, provided its cached
+ * modification time matches MTIME, or NULL otherwise. */
+static struct cmds_cache_dir_t *
+cmds_cache_lookup(const char *dir, const time_t mtime)
+{
+	if (cmds_cache_ok == 0 || mtime == 0)
+		return (struct cmds_cache_dir_t *)NULL;
+
+	size_t i;
+	for (i = 0; i < cmds_cache_n; i++) {
+		if (cmds_cache[i].mtime == mtime
+		&& strcmp(cmds_cache[i].path, dir) == 0)
+			return &cmds_cache[i];
+	}
+
+	return (struct cmds_cache_dir_t *)NULL;
+}
+
+/* Replace (or create) the cache entry for the directory DIR with the
+ * names list NAMES (NAMES_N entries, ownership is transferred to the
+ * cache) and the modification time MTIME. */
+static void
+cmds_cache_update(const char *dir, const time_t mtime, char **names,
+	const size_t names_n)
+{
+	size_t i;
+	for (i = 0; i < cmds_cache_n; i++) {
+		if (strcmp(cmds_cache[i].path, dir) == 0)
+			break;
+	}
+
+	if (i == cmds_cache_n) { /* New entry */
+		cmds_cache = xnrealloc(cmds_cache, cmds_cache_n + 1,
+			sizeof(struct cmds_cache_dir_t));
+		cmds_cache[i].path = savestring(dir, strlen(dir));
+		cmds_cache_n++;
+	} else {
+		size_t j;
+		for (j = 0; j < cmds_cache[i].names_n; j++)
+			free(cmds_cache[i].names[j]);
+		free(cmds_cache[i].names);
+	}
+
+	cmds_cache[i].names = names;
+	cmds_cache[i].names_n = names_n;
+	cmds_cache[i].names_cap = names_n;
+	cmds_cache[i].mtime = mtime;
+	cmds_cache_dirty = 1;
+}
+
+/* Load the commands cache file into the cmds_cache array. The cache is
+ * discarded as a whole if the header (version plus light mode, which
+ * changes the scandir(3) filter) does not match. */
+static void
+load_cmds_cache(void)
+{
+	cmds_cache_loaded = 1;
+
+	char *cache_file = get_cmds_cache_file();
+	if (!cache_file)
+		return;
+
+	cmds_cache_ok = 1;
+
+	int fd = 0;
+	FILE *fp = open_fread(cache_file, &fd);
+	free(cache_file);
+	if (!fp) /* No cache file yet: scan everything and create it. */
+		return;
+
+	size_t line_size = 0;
+	char *line = (char *)NULL;
+	ssize_t line_len = getline(&line, &line_size, fp);
+
+	char header[NAME_MAX];
+	snprintf(header, sizeof(header), "#clifm-cmds-cache:%d:%d\n",
+		CMDS_CACHE_VERSION, conf.light_mode);
+
+	if (line_len <= 0 || strcmp(line, header) != 0) {
+		free(line);
+		fclose(fp);
+		return;
+	}
+
+	struct cmds_cache_dir_t *cur = (struct cmds_cache_dir_t *)NULL;
+
+	/* Each entry is a "*MTIME:DIR" line followed by one name per line. */
+	while ((line_len = getline(&line, &line_size, fp)) > 0) {
+		if (line[line_len - 1] == '\n')
+			line[--line_len] = '\0';
+
+		if (!*line)
+			continue;
+
+		if (*line == '*') {
+			char *p = strchr(line + 1, ':');
+			if (!p || !p[1]) {
+				cur = (struct cmds_cache_dir_t *)NULL;
+				continue;
+			}
+
+			*p = '\0';
+			cmds_cache = xnrealloc(cmds_cache, cmds_cache_n + 1,
+				sizeof(struct cmds_cache_dir_t));
+			cur = &cmds_cache[cmds_cache_n];
+			cmds_cache_n++;
+
+			cur->path = savestring(p + 1, strlen(p + 1));
+			cur->mtime = (time_t)strtoll(line + 1, NULL, 10);
+			cur->names = (char **)NULL;
+			cur->names_n = cur->names_cap = 0;
+			continue;
+		}
+
+		if (!cur)
+			continue;
+
+		if (cur->names_n >= cur->names_cap) {
+			cur->names_cap = cur->names_cap == 0 ? 64 : cur->names_cap * 2;
+			cur->names = xnrealloc(cur->names, cur->names_cap,
+				sizeof(char *));
+		}
+
+		cur->names[cur->names_n] = savestring(line, (size_t)line_len);
+		cur->names_n++;
+	}
+
+	free(line);
+	fclose(fp);
+}
+
+/* Write the cmds_cache array to the commands cache file. */
+static void
+save_cmds_cache(void)
+{
+	char *cache_file = get_cmds_cache_file();
+	if (!cache_file)
+		return;
+
+	int fd = 0;
+	FILE *fp = open_fwrite(cache_file, &fd);
+	if (!fp) {
+		err('w', PRINT_PROMPT, "%s: '%s': %s\n", PROGRAM_NAME,
+			cache_file, strerror(errno));
+		free(cache_file);
+		return;
+	}
+	free(cache_file);
+
+	fprintf(fp, "#clifm-cmds-cache:%d:%d\n", CMDS_CACHE_VERSION,
+		conf.light_mode);
+
+	size_t i, j;
+	for (i = 0; i < cmds_cache_n; i++) {
+		fprintf(fp, "*%lld:%s\n", (long long)cmds_cache[i].mtime,
+			cmds_cache[i].path);
+		for (j = 0; j < cmds_cache[i].names_n; j++)
+			fprintf(fp, "%s\n", cmds_cache[i].names[j]);
+	}
+
+	fclose(fp);
+	cmds_cache_dirty = 0;
+}
+
 /* Get the list of files in PATH, plus CliFM internal commands, aliases, and
  * action names, and store them into an array (bin_commands) to be read by
  * my_rl_completion(). */
@@ -2291,23 +2785,39 @@ get_path_programs(void)
 	int i, l = 0, total_cmd = 0;
 	int *cmd_n = (int *)0;
 	struct dirent ***commands_bin = (struct dirent ***)NULL;
+	struct cmds_cache_dir_t **cached = (struct cmds_cache_dir_t **)NULL;
 
 	if (conf.ext_cmd_ok == 1) {
+		if (cmds_cache_loaded == 0)
+			load_cmds_cache();
+
 		/* NOTE: xchdir() is only required by skip_nonexec() */
 		char tmp[PATH_MAX + 1] = "";
 		char *cwd = get_cwd(tmp, sizeof(tmp), 0);
 
 		commands_bin = xnmalloc(path_n, sizeof(struct dirent));
 		cmd_n = xnmalloc(path_n, sizeof(int));
+		cached = xnmalloc(path_n, sizeof(struct cmds_cache_dir_t *));
 
 		i = (int)path_n;
 		while (--i >= 0) {
 			cmd_n[i] = 0;
 			commands_bin[i] = (struct dirent **)NULL;
+			cached[i] = (struct cmds_cache_dir_t *)NULL;
 
 			if (!paths[i].path || !*paths[i].path
-			|| skip_this_path(paths[i].path) == 1
-			|| xchdir(paths[i].path, NO_TITLE) == -1)
+			|| skip_this_path(paths[i].path) == 1)
+				continue;
+
+			/* Reuse the cached names list if the directory's modification
+			 * time is unchanged: no need to rescan it. */
+			cached[i] = cmds_cache_lookup(paths[i].path, paths[i].mtime);
+			if (cached[i]) {
+				total_cmd += (int)cached[i]->names_n;
+				continue;
+			}
+
+			if (xchdir(paths[i].path, NO_TITLE) == -1)
 				continue;
 
 			cmd_n[i] = scandir(paths[i].path, &commands_bin[i],
@@ -2365,9 +2875,27 @@ get_path_programs(void)
 		/* And finally, add commands in PATH */
 		i = (int)path_n;
 		while (--i >= 0) {
+			if (cached && cached[i]) {
+				/* Replay the cached names list for this directory. */
+				const struct cmds_cache_dir_t *c = cached[i];
+				size_t k;
+				for (k = 0; k < c->names_n; k++) {
+					bin_commands[l] = savestring(c->names[k],
+						strlen(c->names[k]));
+					l++;
+				}
+				continue;
+			}
+
 			if (cmd_n[i] <= 0 || !commands_bin[i])
 				continue;
 
+			/* Record the accepted names to refresh this directory's
+			 * cache entry. */
+			const int record = (cmds_cache_ok == 1 && paths[i].mtime != 0);
+			char **new_names = (char **)NULL;
+			size_t new_n = 0, new_cap = 0;
+
 			int j = cmd_n[i];
 			while (--j >= 0) {
 #ifdef _DIRENT_HAVE_D_TYPE
@@ -2388,18 +2916,99 @@ get_path_programs(void)
 #endif /* __CYGWIN__ */
 				bin_commands[l] = savestring(commands_bin[i][j]->d_name,
 					strlen(commands_bin[i][j]->d_name));
+				if (record == 1) {
+					if (new_n >= new_cap) {
+						new_cap = new_cap == 0 ? 64 : new_cap * 2;
+						new_names = xnrealloc(new_names, new_cap,
+							sizeof(char *));
+					}
+					new_names[new_n] = savestring(bin_commands[l],
+						strlen(bin_commands[l]));
+					new_n++;
+				}
 				l++;
 				free(commands_bin[i][j]);
 			}
 
 			free(commands_bin[i]);
+
+			if (record == 1)
+				cmds_cache_update(paths[i].path, paths[i].mtime,
+					new_names, new_n);
 		}
 	}
 
 	free(commands_bin);
 	free(cmd_n);
+	free(cached);
 	path_progsn = (size_t)l;
 	bin_commands[l] = (char *)NULL;
+
+	if (cmds_cache_dirty == 1)
+		save_cmds_cache();
+
+#ifndef _NO_SUGGESTIONS
+	update_cmds_index();
+#endif /* !_NO_SUGGESTIONS */
+}
+
+/* Hash index over alias names, so that alias resolution on every input
+ * line probes a single bucket instead of walking the whole array.
+ * BUCKETS maps a bucket to the 1-based position of its alias in the
+ * aliases array (0 = empty) and NEXT chains bucket collisions. Built by
+ * get_aliases(), through which every change to the array goes (names
+ * are unique: see alias_exists()). */
+static size_t *alias_buckets = (size_t *)NULL;
+static size_t *alias_chain = (size_t *)NULL;
+static size_t alias_buckets_n = 0;
+
+static void
+build_alias_index(void)
+{
+	free(alias_buckets);
+	free(alias_chain);
+	alias_buckets = alias_chain = (size_t *)NULL;
+	alias_buckets_n = 0;
+
+	if (aliases_n == 0)
+		return;
+
+	alias_buckets_n = 1;
+	while (alias_buckets_n < aliases_n * 2)
+		alias_buckets_n <<= 1;
+
+	alias_buckets = xcalloc(alias_buckets_n, sizeof(size_t));
+	alias_chain = xcalloc(aliases_n, sizeof(size_t));
+
+	size_t i;
+	for (i = 0; i < aliases_n; i++) {
+		if (!aliases[i].name || !*aliases[i].name)
+			continue;
+
+		const size_t b = hashme(aliases[i].name, 1) & (alias_buckets_n - 1);
+		alias_chain[i] = alias_buckets[b];
+		alias_buckets[b] = i + 1;
+	}
+}
+
+/* Return the index in the aliases array of the alias named NAME, or -1
+ * if there is no such alias (exact, case sensitive match). */
+int
+alias_lookup(const char *name)
+{
+	if (!alias_buckets || !name || !*name)
+		return (-1);
+
+	size_t e = alias_buckets[hashme(name, 1) & (alias_buckets_n - 1)];
+	while (e != 0) {
+		const size_t i = e - 1;
+		if (aliases[i].name && *name == *aliases[i].name
+		&& strcmp(name, aliases[i].name) == 0)
+			return (int)i;
+		e = alias_chain[i];
+	}
+
+	return (-1);
 }
 
 static void
@@ -2494,6 +3103,8 @@ get_aliases(void)
 
 	free(line);
 	fclose(fp);
+
+	build_alias_index();
 }
 
 static void
@@ -2553,6 +3164,7 @@ load_dirhist(void)
 	old_pwd[dirhist_total_index] = (char *)NULL;
 	free(line);
 	dirhist_cur_index = dirhist_total_index - 1;
+	dirhist_index_invalidate();
 	return FUNC_SUCCESS;
 }
 
@@ -2605,6 +3217,99 @@ get_prompt_cmds(void)
 	fclose(fp);
 }
 
+/* Startup stages.
+ *
+ * The directory history, bookmarks, tags, jump database, and prompt
+ * commands loaders are independent file parses, each one writing to its
+ * own global data: instead of running them serially before the first
+ * prompt, main() starts them on worker threads right after the initial
+ * files listing (start_init_stages()) and joins them once the shell and
+ * readline are initialized (join_init_stages()), just before any of the
+ * loaded data is first consumed. With a single CPU core, or if a thread
+ * cannot be created, stages simply run serially. */
+static void
+init_stage_dirhist(void)
+{
+	load_dirhist();
+}
+
+static void
+init_stage_bookmarks(void)
+{
+	load_bookmarks();
+}
+
+static void
+init_stage_tags(void)
+{
+	load_tags();
+}
+
+static void
+init_stage_jumpdb(void)
+{
+	load_jumpdb();
+}
+
+static void
+init_stage_prompt_cmds(void)
+{
+	get_prompt_cmds();
+}
+
+static void (*const init_stages[])(void) = {
+	init_stage_dirhist,
+	init_stage_bookmarks,
+	init_stage_tags,
+	init_stage_jumpdb,
+	init_stage_prompt_cmds,
+};
+
+#define INIT_STAGES_N (sizeof(init_stages) / sizeof(init_stages[0]))
+
+static pthread_t init_stage_threads[INIT_STAGES_N];
+static int init_stage_started[INIT_STAGES_N];
+
+static void *
+init_stage_thread(void *arg)
+{
+	void (*const *func)(void) = (void (*const *)(void))arg;
+	(*func)();
+	return (void *)NULL;
+}
+
+void
+start_init_stages(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	const long procs = sysconf(_SC_NPROCESSORS_ONLN);
+#else
+	const long procs = 1;
+#endif /* _SC_NPROCESSORS_ONLN */
+
+	size_t i;
+	for (i = 0; i < INIT_STAGES_N; i++) {
+		init_stage_started[i] = (procs >= 2
+			&& pthread_create(&init_stage_threads[i], NULL,
+				init_stage_thread, (void *)&init_stages[i]) == 0);
+
+		if (init_stage_started[i] == 0)
+			init_stages[i]();
+	}
+}
+
+void
+join_init_stages(void)
+{
+	size_t i;
+	for (i = 0; i < INIT_STAGES_N; i++) {
+		if (init_stage_started[i] == 1) {
+			pthread_join(init_stage_threads[i], NULL);
+			init_stage_started[i] = 0;
+		}
+	}
+}
+
 /* Get the length of the current time format.
  * We need this to construct the time string in case of invalid timestamp (0),
  * and to calculate the space left to print file names in long view. */
@@ -2862,6 +3567,9 @@ check_options(void)
 			conf.apparent_size = xargs.apparent_size;
 	}
 
+	if (conf.approx_dir_size == UNSET)
+		conf.approx_dir_size = DEF_APPROX_DIR_SIZE;
+
 	if (conf.full_dir_size == UNSET) {
 		if (xargs.full_dir_size == UNSET)
 			conf.full_dir_size = DEF_FULL_DIR_SIZE;
@@ -3125,6 +3833,9 @@ check_options(void)
 	if (conf.log_cmds == UNSET)
 		conf.log_cmds = DEF_LOG_CMDS;
 
+	if (conf.big_dir_threshold == UNSET)
+		conf.big_dir_threshold = DEF_BIG_DIR_THRESHOLD;
+
 	if (conf.light_mode == UNSET) {
 		if (xargs.light == UNSET)
 			conf.light_mode = DEF_LIGHT_MODE;
@@ -30,11 +30,13 @@ __BEGIN_DECLS
 int  backup_argv(const int argc, char **argv);
 void check_env_filter(void);
 void check_options(void);
+int alias_lookup(const char *name);
 void get_aliases(void);
 size_t get_cdpath(void);
 #ifdef LINUX_FSINFO
 void get_ext_mountpoints(void);
 #endif /* LINUX_FSINFO */
+void free_cmds_cache(void);
 int  get_home(void);
 int  get_last_path(void);
 size_t get_path_env(const int check_timestamps);
@@ -49,6 +51,7 @@ int  init_history(void);
 void init_shell(void);
 int  init_workspaces(void);
 void init_workspaces_opts(void);
+void join_init_stages(void);
 int  load_actions(void);
 int  load_bookmarks(void);
 int  load_dirhist(void);
@@ -59,6 +62,7 @@ int  load_remotes(void);
 void load_tags(void);
 int  restore_shell(void);
 void set_prop_fields(const char *line);
+void start_init_stages(void);
 void unset_xargs(void);
 
 __END_DECLS
@@ -0,0 +1,381 @@
+/* ipc.c */
+
+/* DESCRIPTION: Unix-socket query interface for external integrations
+ * (started via --ipc). Status bars and tmux scripts used to spawn a
+ * fresh clifm process, or re-read and parse the selections file, every
+ * time they wanted the current state of a running session. The running
+ * instance now listens on a per-process socket (path exported as
+ * CLIFM_IPC_SOCKET) and answers three single-line queries -- "ls",
+ * "sel", and "ws" (or "all" for the three at once) -- with one line of
+ * JSON each, served from in-process snapshots.
+ *
+ * The snapshots are plain strings rebuilt by the main thread whenever
+ * the corresponding state changes (end of list_dir() for the listing
+ * and workspaces, save_sel() for the selection) and swapped in under a
+ * mutex, so the listener thread never touches file_info, sel_elements,
+ * or workspaces directly and a query costs one accept(2), one read(2),
+ * and one write(2). */
+
+/*
+ * This file is part of CliFM
+ *
+ * Copyright (C) 2016-2024, L. Abramovich <leo.clifm@outlook.com>
+ * All rights reserved.
+
+ * CliFM is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * CliFM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+*/
+
+#include "helpers.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>      /* snprintf */
+#include <string.h>     /* memset, strcmp */
+#include <sys/socket.h> /* socket(2), bind(2), listen(2), accept(2) */
+#include <sys/time.h>   /* struct timeval (socket timeouts) */
+#include <sys/un.h>     /* struct sockaddr_un */
+#include <unistd.h>     /* read(2), write(2), close(2), unlink(2) */
+
+#include "aux.h"  /* xnmalloc, xnrealloc */
+#include "ipc.h"
+#include "misc.h" /* err */
+#include "strings.h" /* savestring, xstrsncpy */
+
+/* Listening socket; -1 while the server is not running. */
+static int ipc_fd = -1;
+static char ipc_sock_path[PATH_MAX];
+static pthread_t ipc_thread;
+
+/* Snapshot strings served to clients, guarded by IPC_LOCK. They are
+ * built by the main thread (ipc_update_listing()/ipc_update_sel()) and
+ * only read by the listener thread. */
+static pthread_mutex_t ipc_lock = PTHREAD_MUTEX_INITIALIZER;
+static char *ipc_ls_buf = (char *)NULL;
+static char *ipc_sel_buf = (char *)NULL;
+static char *ipc_ws_buf = (char *)NULL;
+
+/* Growable string used to build snapshots and responses. */
+struct ipc_str_t {
+	char *buf;
+	size_t len;
+	size_t cap;
+};
+
+static void
+ipc_str_grow(struct ipc_str_t *s, const size_t extra)
+{
+	if (s->len + extra + 1 <= s->cap)
+		return;
+
+	s->cap = s->cap == 0 ? 1024 : s->cap;
+	while (s->len + extra + 1 > s->cap)
+		s->cap *= 2;
+
+	s->buf = xnrealloc(s->buf, s->cap, sizeof(char));
+}
+
+static void
+ipc_str_append(struct ipc_str_t *s, const char *str)
+{
+	const size_t len = strlen(str);
+	ipc_str_grow(s, len);
+	memcpy(s->buf + s->len, str, len + 1);
+	s->len += len;
+}
+
+/* Append STR to S as a JSON string literal (quoted and escaped). */
+static void
+ipc_str_append_json(struct ipc_str_t *s, const char *str)
+{
+	ipc_str_grow(s, 2);
+	s->buf[s->len] = '"';
+	s->len++;
+
+	for (; *str; str++) {
+		const unsigned char c = (unsigned char)*str;
+		if (c == '"' || c == '\\') {
+			ipc_str_grow(s, 2);
+			s->buf[s->len] = '\\';
+			s->buf[s->len + 1] = (char)c;
+			s->len += 2;
+		} else if (c < 0x20) {
+			char esc[8];
+			snprintf(esc, sizeof(esc), "\\u%04x", (unsigned int)c);
+			ipc_str_append(s, esc);
+		} else {
+			ipc_str_grow(s, 1);
+			s->buf[s->len] = (char)c;
+			s->len++;
+		}
+	}
+
+	ipc_str_grow(s, 1);
+	s->buf[s->len] = '"';
+	s->len++;
+	s->buf[s->len] = '\0';
+}
+
+/* Swap a freshly built snapshot into *DST under the lock. */
+static void
+ipc_publish(char **dst, struct ipc_str_t *s)
+{
+	pthread_mutex_lock(&ipc_lock);
+	free(*dst);
+	*dst = s->buf;
+	pthread_mutex_unlock(&ipc_lock);
+}
+
+/* Rebuild the listing and workspaces snapshots from the current file
+ * list. Called by the main thread at the end of list_dir(). */
+void
+ipc_update_listing(void)
+{
+	if (ipc_fd == -1)
+		return;
+
+	struct ipc_str_t s = {0};
+	char n[128];
+
+	ipc_str_append(&s, "{\"cwd\":");
+	ipc_str_append_json(&s, (workspaces && workspaces[cur_ws].path)
+		? workspaces[cur_ws].path : "");
+	snprintf(n, sizeof(n), ",\"files\":%jd,\"entries\":[", (intmax_t)files);
+	ipc_str_append(&s, n);
+
+	filesn_t i;
+	for (i = 0; i < files; i++) {
+		if (i > 0)
+			ipc_str_append(&s, ",");
+		ipc_str_append(&s, "{\"name\":");
+		ipc_str_append_json(&s, file_info[i].name);
+		snprintf(n, sizeof(n), ",\"dir\":%d,\"sel\":%d}",
+			file_info[i].dir, file_info[i].sel);
+		ipc_str_append(&s, n);
+	}
+
+	ipc_str_append(&s, "]}\n");
+	ipc_publish(&ipc_ls_buf, &s);
+
+	/* Workspace state changes through the same code path (list_dir()
+	 * runs after every workspace/directory switch): refresh it here. */
+	struct ipc_str_t w = {0};
+	snprintf(n, sizeof(n), "{\"current\":%d,\"workspaces\":[", cur_ws + 1);
+	ipc_str_append(&w, n);
+
+	int j, first = 1;
+	for (j = 0; j < MAX_WS; j++) {
+		if (!workspaces || !workspaces[j].path)
+			continue;
+		if (first == 0)
+			ipc_str_append(&w, ",");
+		first = 0;
+		snprintf(n, sizeof(n), "{\"num\":%d,\"path\":", j + 1);
+		ipc_str_append(&w, n);
+		ipc_str_append_json(&w, workspaces[j].path);
+		if (workspaces[j].name) {
+			ipc_str_append(&w, ",\"name\":");
+			ipc_str_append_json(&w, workspaces[j].name);
+		}
+		ipc_str_append(&w, "}");
+	}
+
+	ipc_str_append(&w, "]}\n");
+	ipc_publish(&ipc_ws_buf, &w);
+}
+
+/* Rebuild the selection snapshot. Called by the main thread whenever
+ * the selection is saved (see save_sel()). */
+void
+ipc_update_sel(void)
+{
+	if (ipc_fd == -1)
+		return;
+
+	struct ipc_str_t s = {0};
+	char n[128];
+
+	snprintf(n, sizeof(n), "{\"count\":%zu,\"files\":[", sel_n);
+	ipc_str_append(&s, n);
+
+	size_t i;
+	for (i = 0; i < sel_n; i++) {
+		if (i > 0)
+			ipc_str_append(&s, ",");
+		ipc_str_append_json(&s, sel_elements[i].name);
+	}
+
+	ipc_str_append(&s, "]}\n");
+	ipc_publish(&ipc_sel_buf, &s);
+}
+
+/* Write the snapshot *SRC (or an empty JSON object if it was never
+ * built) to the client socket FD. The snapshot is copied under the
+ * lock and written outside of it: a client that never reads its socket
+ * can stall these writes (until its send timeout expires), but never
+ * the main thread's ipc_publish(). */
+static void
+ipc_send(const int fd, char **src)
+{
+	pthread_mutex_lock(&ipc_lock);
+	const char *snap = *src ? *src : "{}\n";
+	const size_t len = strlen(snap);
+	char *buf = savestring(snap, len);
+	pthread_mutex_unlock(&ipc_lock);
+
+	size_t off = 0;
+	while (off < len) {
+		const ssize_t n = write(fd, buf + off, len - off);
+		if (n <= 0)
+			break;
+		off += (size_t)n;
+	}
+
+	free(buf);
+}
+
+/* Serve a single client: read one query line and answer it. */
+static void
+ipc_serve_client(const int fd)
+{
+	/* A stalled (or malicious) client must never wedge the listener:
+	 * bound both the query read and the response writes. */
+	struct timeval tv = {5, 0};
+	setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+	setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+	char req[64];
+	const ssize_t n = read(fd, req, sizeof(req) - 1);
+	if (n <= 0) {
+		close(fd);
+		return;
+	}
+
+	req[n] = '\0';
+	char *p = strpbrk(req, "\r\n");
+	if (p)
+		*p = '\0';
+
+	if (strcmp(req, "ls") == 0) {
+		ipc_send(fd, &ipc_ls_buf);
+	} else if (strcmp(req, "sel") == 0) {
+		ipc_send(fd, &ipc_sel_buf);
+	} else if (strcmp(req, "ws") == 0) {
+		ipc_send(fd, &ipc_ws_buf);
+	} else if (strcmp(req, "all") == 0) {
+		ipc_send(fd, &ipc_ls_buf);
+		ipc_send(fd, &ipc_sel_buf);
+		ipc_send(fd, &ipc_ws_buf);
+	} else {
+		const char *e = "{\"error\":\"unknown query\"}\n";
+		if (write(fd, e, strlen(e)) == -1) {}
+	}
+
+	close(fd);
+}
+
+static void *
+ipc_server_thread(void *arg)
+{
+	UNUSED(arg);
+
+	while (1) {
+		const int fd = accept(ipc_fd, NULL, NULL);
+		if (fd == -1) {
+			if (errno == EINTR)
+				continue;
+			break; /* The socket was closed by ipc_stop() */
+		}
+
+		ipc_serve_client(fd);
+	}
+
+	return NULL;
+}
+
+/* Create the listening socket and start the server thread. The socket
+ * lives in the temporary directory, named after the process ID, and its
+ * path is exported as CLIFM_IPC_SOCKET for child processes (plugins,
+ * subshells). Returns FUNC_SUCCESS or FUNC_FAILURE. */
+int
+ipc_start(void)
+{
+	if (ipc_fd != -1 || !tmp_dir)
+		return FUNC_FAILURE;
+
+	snprintf(ipc_sock_path, sizeof(ipc_sock_path), "%s/ipc.%d.sock",
+		tmp_dir, (int)getpid());
+
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(ipc_sock_path) >= sizeof(addr.sun_path)) {
+		err('w', PRINT_PROMPT, _("%s: ipc: '%s': Socket path too long\n"),
+			PROGRAM_NAME, ipc_sock_path);
+		return FUNC_FAILURE;
+	}
+	xstrsncpy(addr.sun_path, ipc_sock_path, sizeof(addr.sun_path));
+
+	const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd == -1) {
+		err('w', PRINT_PROMPT, _("%s: ipc: socket: %s\n"),
+			PROGRAM_NAME, strerror(errno));
+		return FUNC_FAILURE;
+	}
+
+	unlink(ipc_sock_path); /* In case a stale socket survived */
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) == -1
+	|| listen(fd, 8) == -1) {
+		err('w', PRINT_PROMPT, _("%s: ipc: '%s': %s\n"),
+			PROGRAM_NAME, ipc_sock_path, strerror(errno));
+		close(fd);
+		return FUNC_FAILURE;
+	}
+
+	ipc_fd = fd;
+
+	if (pthread_create(&ipc_thread, NULL, ipc_server_thread, NULL) != 0) {
+		err('w', PRINT_PROMPT, _("%s: ipc: Cannot create server thread\n"),
+			PROGRAM_NAME);
+		close(fd);
+		unlink(ipc_sock_path);
+		ipc_fd = -1;
+		return FUNC_FAILURE;
+	}
+
+	setenv("CLIFM_IPC_SOCKET", ipc_sock_path, 1);
+	return FUNC_SUCCESS;
+}
+
+/* Close the socket and remove it from the filesystem. Called from
+ * free_stuff() at exit. */
+void
+ipc_stop(void)
+{
+	if (ipc_fd == -1)
+		return;
+
+	const int fd = ipc_fd;
+	ipc_fd = -1;
+	close(fd); /* Makes the server thread's accept(2) fail and return */
+	unlink(ipc_sock_path);
+	unsetenv("CLIFM_IPC_SOCKET");
+
+	pthread_mutex_lock(&ipc_lock);
+	free(ipc_ls_buf); ipc_ls_buf = (char *)NULL;
+	free(ipc_sel_buf); ipc_sel_buf = (char *)NULL;
+	free(ipc_ws_buf); ipc_ws_buf = (char *)NULL;
+	pthread_mutex_unlock(&ipc_lock);
+}
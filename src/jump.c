@@ -24,7 +24,9 @@
 
 #include "helpers.h"
 
+#include <dirent.h> /* suggestion prefetch (see prefetch_dir()) */
 #include <errno.h>
+#include <pthread.h> /* suggestion prefetch (see prefetch_dir()) */
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -40,6 +42,7 @@
 #include "colors.h" /* get_dir_color() */
 #include "file_operations.h"
 #include "init.h"
+#include "jump.h" /* binary database format (jumpdb_bin_*) */
 #include "messages.h"
 #include "misc.h"
 #include "navigation.h"
@@ -65,10 +68,7 @@
 struct jump_entry_t {
 	char *match;
 	char *needle;
-	size_t keep;
-	size_t visits;
-	time_t first;
-	time_t last;
+	int dbi; /* Index of this match in jump_db */
 };
 
 #define FIRST_SEGMENT (1 << 0)
@@ -109,6 +109,18 @@ calculate_base_credit(const int days_since_first, const int hours_since_last,
 	return rank;
 }
 
+/* Bonus credit for the query string QUERY matching the basename of the
+ * path ENTRY. */
+static int
+calculate_basename_bonus(const char *entry, const char *query)
+{
+	char *tmp = query ? strrchr(entry, '/') : (char *)NULL;
+	if (tmp && *(++tmp) && strstr(tmp, query))
+		return BASENAME_BONUS;
+
+	return 0;
+}
+
 /* Calculate bonus credit for the entry ENTRY.
  * Matches in directory basename, bookmarked and pinned directories,
  * just as directories currently in a workspace, have bonus credit. */
@@ -118,13 +130,7 @@ calculate_bonus_credit(const char *entry, const char *query, int *keep)
 	if (!entry || !*entry)
 		return 0;
 
-	int bonus = 0;
-
-	char *tmp = query ? strrchr(entry, '/') : (char *)NULL;
-	if (tmp && *(++tmp)) {
-		if (strstr(tmp, query))
-			bonus += BASENAME_BONUS;
-	}
+	int bonus = calculate_basename_bonus(entry, query);
 
 	int i = (int)bm_n;
 	while (--i >= 0) {
@@ -184,6 +190,89 @@ rank_entry(const int i, const time_t now, int *days_since_first,
 	return rank;
 }
 
+/* An entry's rank is a function of the current hour (time decay buckets
+ * are hour-grained at their finest) and of the bookmarks/pinned/workspace
+ * context, both of which change far less often than ranks are queried:
+ * the suggestions system ranks every match on each keystroke. Cache the
+ * query-independent rank of each entry and recompute it only when that
+ * context changes, tracked with a generation counter. */
+static int jump_rank_gen = 0; /* 0 = no entry cached yet */
+static time_t jump_rank_hour = -1;
+static struct bookmarks_t *jump_rank_bms = (struct bookmarks_t *)NULL;
+static size_t jump_rank_bm_n = 0;
+static char *jump_rank_pin = (char *)NULL;
+static char jump_rank_cwd[PATH_MAX + 1];
+
+/* Bump the rank cache generation if anything rank_entry() depends on
+ * changed since the last call: the hour, the bookmarks array (reloads
+ * reallocate it), the pinned directory, or the current workspace path. */
+static void
+jump_rank_tick(const time_t now)
+{
+	const char *cwd = (workspaces && cur_ws >= 0 && workspaces[cur_ws].path)
+		? workspaces[cur_ws].path : "";
+
+	if (now / 3600 == jump_rank_hour && bookmarks == jump_rank_bms
+	&& bm_n == jump_rank_bm_n && pinned_dir == jump_rank_pin
+	&& strcmp(cwd, jump_rank_cwd) == 0)
+		return;
+
+	jump_rank_gen++;
+	jump_rank_hour = now / 3600;
+	jump_rank_bms = bookmarks;
+	jump_rank_bm_n = bm_n;
+	jump_rank_pin = pinned_dir;
+	xstrsncpy(jump_rank_cwd, cwd, sizeof(jump_rank_cwd));
+}
+
+/* Return the (query-independent) rank of the jump database entry I,
+ * computing it only if not cached for the current generation. */
+static int
+jump_rank(const int i, const time_t now)
+{
+	jump_rank_tick(now);
+
+	if (jump_db[i].rank_gen == jump_rank_gen)
+		return jump_db[i].rank;
+
+	int days_since_first = 0, hours_since_last = 0;
+	const int rank = rank_entry(i, now, &days_since_first, &hours_since_last);
+	UNUSED(days_since_first); UNUSED(hours_since_last);
+
+	jump_db[i].rank = rank;
+	jump_db[i].rank_gen = jump_rank_gen;
+	return rank;
+}
+
+/* Forget entries ranked below MinJumpRank automatically, at most once
+ * per hour, so that an old database stays small without waiting for a
+ * manual 'j --purge' (still available). As in purge_low_ranked_entries(),
+ * entries marked keep (recently visited, bookmarked, pinned, active in
+ * a workspace, or permanent) are never touched. */
+#define JUMP_COMPACT_INTERVAL 3600 /* Seconds */
+
+static void
+compact_jumpdb(const time_t now)
+{
+	static time_t last_compact = (time_t)0;
+
+	if (conf.min_jump_rank <= 0 || jump_n == 0
+	|| now - last_compact < JUMP_COMPACT_INTERVAL)
+		return;
+
+	last_compact = now;
+
+	int i = (int)jump_n;
+	while (--i >= 0) {
+		if (!IS_VALID_JUMP_ENTRY(i))
+			continue;
+
+		const int rank = jump_rank(i, now);
+		if (jump_db[i].keep == 0 && rank < conf.min_jump_rank)
+			jump_db[i].rank = JUMP_ENTRY_PURGED;
+	}
+}
+
 static void
 free_jump_database(void)
 {
@@ -197,6 +286,45 @@ free_jump_database(void)
 	jump_n = 0;
 }
 
+/* Append the just-created entry J to the binary jump database, so that
+ * new directories survive an abnormal exit without rewriting the whole
+ * file. Appended records are merged back at load time (load_jumpdb()).
+ * No-op if the binary database does not exist yet: save_jumpdb() creates
+ * it at exit. */
+static void
+append_jumpdb_bin(const struct jump_t *j)
+{
+	if (xargs.no_dirjump == 1 || config_ok == 0 || !config_dir)
+		return;
+
+	char bin_file[PATH_MAX + 1];
+	snprintf(bin_file, sizeof(bin_file), "%s/jump.clifm%s",
+		config_dir, JUMPDB_BIN_SUFFIX);
+
+	const int fd = open(bin_file, O_WRONLY | O_APPEND);
+	if (fd == -1)
+		return;
+
+	const struct jumpdb_bin_entry_t e = {
+		.visits = (uint64_t)j->visits,
+		.first_visit = (int64_t)j->first_visit,
+		.last_visit = (int64_t)j->last_visit,
+		.keep = (int32_t)j->keep,
+		.path_len = (uint32_t)j->len };
+
+	/* Write the whole record with a single write(2) call, so that
+	 * another running instance cannot interleave a record of its own. */
+	const size_t rec_len = sizeof(e) + j->len + 1;
+	char *rec = xnmalloc(rec_len, sizeof(char));
+	memcpy(rec, &e, sizeof(e));
+	memcpy(rec + sizeof(e), j->path, j->len + 1);
+
+	if (write(fd, rec, rec_len) == -1) { /* Nothing we can do about it */ }
+
+	free(rec);
+	close(fd);
+}
+
 static int
 add_new_jump_entry(const char *dir, const size_t dir_len)
 {
@@ -206,15 +334,18 @@ add_new_jump_entry(const char *dir, const size_t dir_len)
 	jump_db[jump_n].first_visit = now;
 	jump_db[jump_n].last_visit = now;
 	jump_db[jump_n].rank = 0;
+	jump_db[jump_n].rank_gen = 0;
 	jump_db[jump_n].keep = 0;
 	jump_db[jump_n].len = dir_len;
 	jump_db[jump_n].path = savestring(dir, dir_len);
+	append_jumpdb_bin(&jump_db[jump_n]);
 	jump_n++;
 
 	jump_db[jump_n].path = (char *)NULL;
 	jump_db[jump_n].len = 0;
 	jump_db[jump_n].visits = 0;
 	jump_db[jump_n].rank = 0;
+	jump_db[jump_n].rank_gen = 0;
 	jump_db[jump_n].keep = 0;
 	jump_db[jump_n].first_visit = -1;
 	jump_db[jump_n].last_visit = -1;
@@ -252,30 +383,32 @@ add_to_jumpdb(char *dir)
 		if (strcmp(jump_db[i].path, dir) == 0) {
 			jump_db[i].visits++;
 			jump_db[i].last_visit = time(NULL);
+			jump_db[i].rank_gen = 0;
 			new_entry = 0;
 			break;
 		}
 	}
 
+	compact_jumpdb(time(NULL));
+
 	if (new_entry == 0)
 		return FUNC_SUCCESS;
 
 	return add_new_jump_entry(dir, dir_len);
 }
 
-/* Store the jump database into a file. */
-void
-save_jumpdb(void)
+/* Write the jump database to FILE. If BIN is 1, use the binary format
+ * described in jump.h (loaded via mmap(2) at startup); otherwise use the
+ * text format, kept as the editable export for 'j --edit'. */
+static void
+dump_jumpdb(const char *file, const int bin)
 {
 	if (xargs.no_dirjump == 1 || config_ok == 0 || !config_dir || !jump_db
 	|| jump_n == 0)
 		return;
 
-	char jump_file[PATH_MAX + 1];
-	snprintf(jump_file, sizeof(jump_file), "%s/jump.clifm", config_dir);
-
 	int fd = 0;
-	FILE *fp = open_fwrite(jump_file, &fd);
+	FILE *fp = open_fwrite(file, &fd);
 	if (!fp)
 		return;
 
@@ -296,11 +429,25 @@ save_jumpdb(void)
 		total_rank += rank;
 	}
 
+	/* The rank field was overwritten (and may be divided below): force
+	 * the rank cache to recompute on next use. */
+	jump_rank_hour = -1;
+
 	/* Once we have the total rank, check if we need to reduce ranks,
 	 * and then write entries into the database. */
 	if (total_rank > conf.max_jump_total_rank && conf.max_jump_total_rank > 0)
 		reduce = (total_rank / conf.max_jump_total_rank) + 1;
 
+	struct jumpdb_bin_hdr_t hdr;
+	uint32_t entries = 0;
+
+	if (bin == 1) {
+		/* Write a placeholder header first: the final entry count is only
+		 * known after the forget/reduce pass below. */
+		memset(&hdr, 0, sizeof(hdr));
+		fwrite(&hdr, sizeof(hdr), 1, fp);
+	}
+
 	char perm_chr_str[2] = "";
 
 	for (i = 0; i < (int)jump_n; i++) {
@@ -319,6 +466,19 @@ save_jumpdb(void)
 			continue;
 		}
 
+		if (bin == 1) {
+			const struct jumpdb_bin_entry_t e = {
+				.visits = (uint64_t)jump_db[i].visits,
+				.first_visit = (int64_t)jump_db[i].first_visit,
+				.last_visit = (int64_t)jump_db[i].last_visit,
+				.keep = (int32_t)jump_db[i].keep,
+				.path_len = (uint32_t)jump_db[i].len };
+			fwrite(&e, sizeof(e), 1, fp);
+			fwrite(jump_db[i].path, jump_db[i].len + 1, 1, fp);
+			entries++;
+			continue;
+		}
+
 		perm_chr_str[0] = jump_db[i].keep == JUMP_ENTRY_PERMANENT
 			? JUMP_ENTRY_PERMANENT_CHR : '\0';
 		fprintf(fp, "%s%zu:%jd:%jd:%s\n",
@@ -327,10 +487,34 @@ save_jumpdb(void)
 			(intmax_t)jump_db[i].last_visit, jump_db[i].path);
 	}
 
-	fprintf(fp, "@%d\n", total_rank);
+	if (bin == 1) {
+		memcpy(hdr.magic, JUMPDB_BIN_MAGIC, sizeof(hdr.magic));
+		hdr.version = JUMPDB_BIN_VERSION;
+		hdr.entries = entries;
+		hdr.total_rank = (int64_t)total_rank;
+		fseek(fp, 0L, SEEK_SET);
+		fwrite(&hdr, sizeof(hdr), 1, fp);
+	} else {
+		fprintf(fp, "@%d\n", total_rank);
+	}
+
 	fclose(fp);
 }
 
+/* Store the jump database into the binary database file. */
+void
+save_jumpdb(void)
+{
+	if (config_ok == 0 || !config_dir)
+		return;
+
+	char bin_file[PATH_MAX + 1];
+	snprintf(bin_file, sizeof(bin_file), "%s/jump.clifm%s",
+		config_dir, JUMPDB_BIN_SUFFIX);
+
+	dump_jumpdb(bin_file, 1);
+}
+
 int
 edit_jumpdb(char *app)
 {
@@ -339,11 +523,12 @@ edit_jumpdb(char *app)
 		return FUNC_FAILURE;
 	}
 
-	save_jumpdb();
-
 	char jump_file[PATH_MAX + 1];
 	snprintf(jump_file, sizeof(jump_file), "%s/jump.clifm", config_dir);
 
+	/* Export the current database to the editable text format. */
+	dump_jumpdb(jump_file, 0);
+
 	struct stat attr;
 	if (stat(jump_file, &attr) == -1) {
 		xerror("jump: '%s': %s\n", jump_file, strerror(errno));
@@ -376,10 +561,83 @@ edit_jumpdb(char *app)
 	if (jump_db)
 		free_jump_database();
 
+	/* Import the edited text file and regenerate the binary database. */
+	char bin_file[PATH_MAX + 1];
+	snprintf(bin_file, sizeof(bin_file), "%s/jump.clifm%s",
+		config_dir, JUMPDB_BIN_SUFFIX);
+	unlink(bin_file);
+
 	load_jumpdb();
+	save_jumpdb();
 	return FUNC_SUCCESS;
 }
 
+/* Read at most this many entries from a prefetched directory. Keeps the
+ * cost of a mispredicted suggestion small. */
+#define PREFETCH_MAX_ENTRIES 2048
+
+static volatile int prefetch_busy = 0;
+static char prefetch_last[PATH_MAX + 1];
+
+/* Scan the directory whose name was passed as ARG (heap allocated, freed
+ * here), lstat'ing up to PREFETCH_MAX_ENTRIES of its entries. Results are
+ * discarded: the point is to pull the directory and its inodes into the
+ * kernel caches, so that, should the user accept the suggestion, the
+ * actual listing runs against warm caches. */
+static void *
+prefetch_worker(void *arg)
+{
+	char *path = (char *)arg;
+	DIR *dir = opendir(path);
+
+	if (dir) {
+		char buf[PATH_MAX + NAME_MAX + 2];
+		struct stat a;
+		struct dirent *ent;
+		size_t n = 0;
+
+		while (n++ < PREFETCH_MAX_ENTRIES && (ent = readdir(dir))) {
+			if (SELFORPARENT(ent->d_name))
+				continue;
+			snprintf(buf, sizeof(buf), "%s/%s", path, ent->d_name);
+			lstat(buf, &a);
+		}
+
+		closedir(dir);
+	}
+
+	free(path);
+	prefetch_busy = 0;
+	return (void *)NULL;
+}
+
+/* Speculatively warm up the directory PATH, displayed as a suggestion
+ * and likely to be listed next. The scan runs on a detached thread (at
+ * most one at a time) so the prompt is never delayed. */
+static void
+prefetch_dir(const char *path)
+{
+	if (!path || !*path || prefetch_busy == 1
+	|| strcmp(path, prefetch_last) == 0
+	|| (workspaces && cur_ws >= 0 && workspaces[cur_ws].path
+	&& strcmp(path, workspaces[cur_ws].path) == 0))
+		return;
+
+	xstrsncpy(prefetch_last, path, sizeof(prefetch_last));
+
+	char *p = savestring(path, strlen(path));
+	pthread_t tid;
+
+	prefetch_busy = 1;
+	if (pthread_create(&tid, NULL, prefetch_worker, p) != 0) {
+		prefetch_busy = 0;
+		free(p);
+		return;
+	}
+
+	pthread_detach(tid);
+}
+
 /* Save jump entry into the suggestions buffer. */
 static int
 save_jump_suggestion(char *str)
@@ -399,6 +657,8 @@ save_jump_suggestion(char *str)
 	else
 		xstrsncpy(jump_suggestion, str, jump_sug_len);
 
+	prefetch_dir(str);
+
 	return FUNC_SUCCESS;
 }
 
@@ -772,20 +1032,8 @@ static inline int
 rank_tmp_entry(const struct jump_entry_t *entry, const time_t now,
 	const int reduce, const char *query)
 {
-	/* 86400 = 60 secs / 60 misc / 24 hours */
-	const int days_since_first = (int)(now - entry->first) / 86400;
-	/* 3600 = 60 secs / 60 mins */
-	const int hours_since_last = (int)(now - entry->last) / 3600;
-
-	int keep = 0;
-	int rank = calculate_base_credit(days_since_first, hours_since_last,
-		(int)entry->visits, &keep);
-
-	rank += calculate_bonus_credit(entry->match, query, &keep);
-	if (entry->keep == JUMP_ENTRY_PERMANENT)
-		rank += PERMANENT_BONUS;
-
-	UNUSED(keep);
+	int rank = jump_rank(entry->dbi, now)
+		+ calculate_basename_bonus(entry->match, query);
 
 	if (reduce > 0) {
 		const int tmp_rank = rank;
@@ -917,12 +1165,9 @@ dirjump(char **args, const int mode)
 				if (exclude == 1)
 					continue;
 
-				entry[match].visits = jump_db[j].visits;
-				entry[match].first = jump_db[j].first_visit;
-				entry[match].last = jump_db[j].last_visit;
 				entry[match].needle = needle;
 				entry[match].match = jump_db[j].path;
-				entry[match].keep = (size_t)jump_db[j].keep;
+				entry[match].dbi = j;
 				match++;
 			}
 		}
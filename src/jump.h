@@ -25,6 +25,38 @@
 #ifndef JUMP_H
 #define JUMP_H
 
+#include <stdint.h> /* fixed-width integer types */
+
+/* Binary on-disk format of the jump database (jump.clifm.bin)
+ *
+ * The file starts with a jumpdb_bin_hdr_t struct, followed by one record
+ * per entry: a jumpdb_bin_entry_t struct plus PATH_LEN path bytes and a
+ * terminating NUL. The first ENTRIES records are written by save_jumpdb()
+ * at exit; records beyond that count are incremental appends made at
+ * visit time (add_to_jumpdb()), and are merged back at load time.
+ * The text database (jump.clifm) is kept only as the import/export format
+ * for 'j --edit'. */
+
+#define JUMPDB_BIN_SUFFIX  ".bin"
+#define JUMPDB_BIN_MAGIC   "CLIFMJDB"
+#define JUMPDB_BIN_VERSION 1
+
+struct jumpdb_bin_hdr_t {
+	char magic[8];
+	uint32_t version;
+	uint32_t entries;
+	int64_t total_rank;
+};
+
+/* Fixed part of an on-disk entry, followed by PATH_LEN + 1 path bytes. */
+struct jumpdb_bin_entry_t {
+	uint64_t visits;
+	int64_t first_visit;
+	int64_t last_visit;
+	int32_t keep;
+	uint32_t path_len;
+};
+
 __BEGIN_DECLS
 
 int  add_to_jumpdb(char *dir);
@@ -58,6 +58,7 @@ typedef char *rl_cpvfunc_t;
 #include "profiles.h"
 #include "prompt.h"
 #include "readline.h"
+#include "snapshot.h"
 #include "spawn.h"
 #include "tabcomp.h" /* tab_complete() */
 
@@ -232,13 +233,59 @@ kbinds_function(char **args)
 	return FUNC_FAILURE;
 }
 
+/* Index over the kbinds array, sorted by function name, so that
+ * find_key() resolves via binary search instead of a linear scan:
+ * readline_kbinds() (called at startup and on every resource reload)
+ * performs one lookup per keybinding, making the setup quadratic in the
+ * amount of bindings with linear lookups. The index holds array
+ * positions (not pointers: the kbinds array is reallocated while
+ * loading), and is rebuilt lazily after each load_keybinds() run.
+ * Per-keystroke dispatch itself is already constant: sequences are
+ * handed to readline's keymap once, via rl_bind_keyseq(3). */
+static size_t *kbinds_index = (size_t *)NULL;
+static int kbinds_index_ok = 0;
+
+static int
+kbinds_index_cmp(const void *a, const void *b)
+{
+	const size_t pa = *(const size_t *)a;
+	const size_t pb = *(const size_t *)b;
+
+	const int ret = strcmp(kbinds[pa].function, kbinds[pb].function);
+	if (ret != 0)
+		return ret;
+
+	/* Duplicated function names: keep file order (find_key() returns
+	 * the last one, just as the old backwards linear scan did). */
+	return pa > pb ? 1 : (pa < pb ? -1 : 0);
+}
+
+static void
+build_kbinds_index(void)
+{
+	free(kbinds_index);
+	kbinds_index = xnmalloc(kbinds_n, sizeof(size_t));
+
+	size_t i;
+	for (i = 0; i < kbinds_n; i++)
+		kbinds_index[i] = i;
+
+	qsort(kbinds_index, kbinds_n, sizeof(size_t), kbinds_index_cmp);
+	kbinds_index_ok = 1;
+}
+
 /* Store keybinds from the keybinds file into a struct */
 int
 load_keybinds(void)
 {
+	kbinds_index_ok = 0;
+
 	if (config_ok == 0 || !kbinds_file)
 		return FUNC_FAILURE;
 
+	if (snapshot_restored(SNAP_KEYBINDS))
+		return FUNC_SUCCESS;
+
 	/* Free the keybinds struct array */
 	if (kbinds_n > 0) {
 		int i = (int)kbinds_n;
@@ -254,23 +301,23 @@ load_keybinds(void)
 	}
 
 	/* Open the keybinds file */
-	FILE *fp = fopen(kbinds_file, "r");
+	int fd;
+	FILE *fp = open_fread(kbinds_file, &fd);
 	if (!fp)
 		return FUNC_FAILURE;
 
-	size_t line_size = 0;
-	char *line = (char *)NULL;
-	ssize_t line_len = 0;
+	char *buf = load_file_to_buf(fd);
+	fclose(fp);
 
-	while ((line_len = getline(&line, &line_size, fp)) > 0) {
-		if (!line || !*line || *line == '#' || *line == '\n')
-			continue;
+	char *p = buf;
+	char *line;
+	size_t line_len;
 
-		if (line[line_len - 1] == '\n')
-			line[line_len - 1] = '\0';
+	while ((line = get_buf_line(&p, &line_len))) {
+		if (!*line || *line == '#')
+			continue;
 
-		char *tmp = (char *)NULL;
-		tmp = strchr(line, ':');
+		char *tmp = strchr(line, ':');
 		if (!tmp || !*(tmp + 1))
 			continue;
 
@@ -285,8 +332,8 @@ load_keybinds(void)
 		kbinds_n++;
 	}
 
-	fclose(fp);
-	free(line);
+	free(buf);
+	snapshot_stamp(SNAP_KEYBINDS, kbinds_file);
 	return FUNC_SUCCESS;
 }
 
@@ -402,12 +449,26 @@ find_key(char *function)
 	if (!kbinds_n)
 		return (char *)NULL;
 
-	int n = (int)kbinds_n;
-	while (--n >= 0) {
-		if (*function != *kbinds[n].function)
-			continue;
-		if (strcmp(function, kbinds[n].function) == 0)
-			return kbinds[n].key;
+	if (kbinds_index_ok == 0)
+		build_kbinds_index();
+
+	size_t low = 0, high = kbinds_n;
+	while (low < high) {
+		const size_t mid = low + ((high - low) / 2);
+		const int ret = strcmp(function, kbinds[kbinds_index[mid]].function);
+
+		if (ret == 0) {
+			size_t m = mid;
+			while (m + 1 < kbinds_n && strcmp(function,
+			kbinds[kbinds_index[m + 1]].function) == 0)
+				m++; /* Duplicates: return the last one (file order) */
+			return kbinds[kbinds_index[m]].key;
+		}
+
+		if (ret < 0)
+			high = mid;
+		else
+			low = mid + 1;
 	}
 
 	return (char *)NULL;
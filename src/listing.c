@@ -28,7 +28,14 @@
 #include <sys/statvfs.h>
 #include <unistd.h> /* open(2), readlinkat(2) */
 #include <errno.h>
+#include <fcntl.h> /* O_RDONLY, O_DIRECTORY (update_dirlist()) */
+#include <pthread.h> /* parallel stat phase (see pstat_run()) */
 #include <string.h>
+#if defined(__linux__)
+# include <stdint.h>      /* uint64_t (see struct xdirent64_t) */
+# include <sys/syscall.h> /* SYS_getdents64 (see dirscan_next()) */
+#endif /* __linux__ */
+#include <time.h> /* clock_gettime(2) (see print_scan_preview()) */
 #if defined(__OpenBSD__)
 # include <strings.h>
 # include <inttypes.h> /* uintmax_t */
@@ -83,16 +90,25 @@
 #include "checks.h"
 #include "colors.h"
 #include "dothidden.h" /* load_dothidden, check_dothidden, free_dothidden */
+#include "ipc.h" /* ipc_update_listing() */
 #ifndef _NO_ICONS
 # include "icons.h"
 #endif /* !_NO_ICONS */
 #include "messages.h"
 #include "misc.h"
+#include "obuf.h"       /* obuf_printf(), obuf_flush() */
+#include "perf.h"       /* perf_begin(), perf_end() */
 #include "properties.h" /* print_analysis_stats() */
 #include "long_view.h"  /* print_entry_props() */
 #include "sanitize.h"
+#include "selection.h" /* is_file_selected() */
 #include "sort.h"
 #include "spawn.h"
+#include "strings.h" /* SWAR macros (is_utf8_name()) */
+#ifndef _NO_SUGGESTIONS
+# include "suggestions.h" /* invalidate_fnames_index() */
+#endif /* !_NO_SUGGESTIONS */
+#include "tabcomp.h"   /* flush_tab_comp_cache() */
 #include "xdu.h"        /* dir_size() */
 
 /* In case we want to try some faster printf implementation */
@@ -102,7 +118,10 @@
 #else
 # define xprintf printf
 #endif // _PALAND_PRINTF */
-#define xprintf printf
+/* The entry printers compose into the output buffer (obuf.c), flushed
+ * with a few writev(2) calls once the list (or the current pager page)
+ * is complete, instead of emitting one write(2) per line. */
+#define xprintf obuf_printf
 
 /* Macros for run_dir_cmd function */
 #define AUTOCMD_DIR_IN  0
@@ -119,6 +138,102 @@ static int dir_out = 0;
 static int pager_quit = 0;
 static int pager_help = 0;
 static int long_view_bk = UNSET;
+/* At least one file in the current list has extended attributes. Set by
+ * list_dir()/update_dirlist(), and consumed by print_long_mode(). */
+static int have_xattr_bk = 0;
+
+#if defined(LINUX_FILE_XATTRS)
+/* Devices whose filesystem does not support extended attributes
+ * (listxattr(2) failed with ENOTSUP). Once a device is recorded here, no
+ * further xattr syscalls are issued for files on it: the first file listed
+ * on such a filesystem answers for the entire device. */
+#define XATTR_UNSUP_MAX 64
+static dev_t xattr_unsup_devs[XATTR_UNSUP_MAX];
+static size_t xattr_unsup_n = 0;
+
+static int
+dev_supports_xattr(const dev_t dev)
+{
+	size_t i;
+	for (i = 0; i < xattr_unsup_n; i++) {
+		if (xattr_unsup_devs[i] == dev)
+			return 0;
+	}
+
+	return 1;
+}
+
+static void
+set_dev_xattr_unsup(const dev_t dev)
+{
+	if (xattr_unsup_n < XATTR_UNSUP_MAX)
+		xattr_unsup_devs[xattr_unsup_n++] = dev;
+}
+#endif /* LINUX_FILE_XATTRS */
+/* Files excluded from the last listing (filters, hidden files). Consumed
+ * by the incremental refresh path (see redisplay_dirlist()). */
+static filesn_t excluded_files_bk = 0;
+
+/* Differential redraw (see dirlist_patch_selection()).
+ *
+ * While the columned listers print, we record the screen cell (row and
+ * column slot) each entry went to. When only selection marks change
+ * (sel/desel), the affected cells are re-emitted in place with cursor
+ * addressing instead of reprinting the entire list: toggling the mark
+ * never changes a cell's width, so a cell can be patched without
+ * disturbing its neighbors. The map is only valid when the listing
+ * started at the top of a cleared screen and the screen has not
+ * scrolled since (checked via a cursor position report at patch time:
+ * once the screen scrolls the cursor is pinned to the last line). */
+struct dmg_cell_t {
+	filesn_t entry;
+	int row; /* Screen row, 0-based */
+	int col; /* Column slot (the x position is COL * (LONGEST + 1)) */
+};
+
+static struct dmg_cell_t *dmg_cells = (struct dmg_cell_t *)NULL;
+static filesn_t dmg_cells_n = 0;
+static filesn_t dmg_cells_cap = 0;
+static int dmg_track = 0; /* Record cells during the current listing */
+static int dmg_valid = 0; /* The map matches what is on the screen */
+static int dmg_pad = 0;   /* ELN pad the listing was printed with */
+
+static void
+dmg_track_start(const int pad)
+{
+	dmg_valid = 0;
+	dmg_cells_n = 0;
+
+	dmg_track = (conf.clear_screen == 1 && xargs.list_and_quit != 1
+		&& term_caps.home == 1 && term_caps.req_cur_pos == 1
+		&& conf.pager != 1
+		&& (conf.pager <= 1 || files < (filesn_t)conf.pager));
+	dmg_pad = pad;
+}
+
+static void
+dmg_track_stop(void)
+{
+	if (dmg_track == 1) {
+		dmg_track = 0;
+		dmg_valid = 1;
+	}
+}
+
+static void
+dmg_record(const filesn_t entry, const int row, const int col)
+{
+	if (dmg_cells_n == dmg_cells_cap) {
+		dmg_cells_cap = dmg_cells_cap == 0 ? ENTRY_N : dmg_cells_cap * 2;
+		dmg_cells = xnrealloc(dmg_cells, (size_t)dmg_cells_cap,
+			sizeof(struct dmg_cell_t));
+	}
+
+	dmg_cells[dmg_cells_n].entry = entry;
+	dmg_cells[dmg_cells_n].row = row;
+	dmg_cells[dmg_cells_n].col = col;
+	dmg_cells_n++;
+}
 
 struct checks_t {
 	int autocmd_files;
@@ -129,24 +244,1465 @@ struct checks_t {
 	int filter_type;
 	int icons_use_file_color;
 	int id_names;
+	int lazy_icons;
 	int lnk_char;
 	int min_name_trim;
 	int xattr;
 };
 
-static struct checks_t checks;
+static struct checks_t checks;
+
+static int redisplay_dirlist(void);
+
+/* Struct to store information about trimmed file names. Used only when
+ * Unicode is disabled */
+struct trim_t {
+	int state;
+	int a; /* trimmed char */
+	int b; /* char next to trimmed char */
+	int pad;
+	size_t len; /* Lenght of file name before trimming */
+};
+
+static struct trim_t trim;
+
+/* Per-listing string arena
+ *
+ * The strings held by the file_info array (file names and extension
+ * colors) are not malloc'ed individually: they are carved from a bump
+ * arena, and the whole arena is recycled when the list is dropped. On
+ * big directories this removes hundreds of thousands of malloc/free
+ * pairs per navigation, the hottest path in the program.
+ *
+ * Each listing owns its arena: free_dirlist() either hands it over to
+ * the directory cache together with the list, or resets it and keeps it
+ * around for the next listing to reuse. */
+
+#define FIARENA_BLOCK_SIZE (64 * 1024)
+
+struct fiarena_blk_t {
+	char *buf;
+	size_t size;
+	size_t len;
+	struct fiarena_blk_t *next;
+};
+
+struct fiarena_t {
+	struct fiarena_blk_t *head;
+	struct fiarena_blk_t *cur;
+};
+
+/* The arena backing the strings of the current file_info array. */
+static struct fiarena_t *fi_arena = (struct fiarena_t *)NULL;
+/* An empty arena kept around for the next listing to reuse. */
+static struct fiarena_t *fi_arena_spare = (struct fiarena_t *)NULL;
+
+static struct fiarena_blk_t *
+fiarena_new_blk(const size_t min_size)
+{
+	struct fiarena_blk_t *b = xnmalloc(1, sizeof(struct fiarena_blk_t));
+
+	b->size = min_size > FIARENA_BLOCK_SIZE ? min_size : FIARENA_BLOCK_SIZE;
+	b->buf = xnmalloc(b->size, sizeof(char));
+	b->len = 0;
+	b->next = (struct fiarena_blk_t *)NULL;
+
+	return b;
+}
+
+/* Return SIZE bytes carved from the current listing's arena, creating
+ * (or recycling) the arena if this is the first allocation. */
+static void *
+fiarena_alloc(const size_t size)
+{
+	if (!fi_arena) {
+		if (fi_arena_spare) {
+			fi_arena = fi_arena_spare;
+			fi_arena_spare = (struct fiarena_t *)NULL;
+		} else {
+			fi_arena = xnmalloc(1, sizeof(struct fiarena_t));
+			fi_arena->head = fi_arena->cur = fiarena_new_blk(size);
+		}
+	}
+
+	struct fiarena_blk_t *b = fi_arena->cur;
+	if (b->size - b->len < size) {
+		b->next = fiarena_new_blk(size);
+		b = fi_arena->cur = b->next;
+	}
+
+	char *p = b->buf + b->len;
+	b->len += size;
+
+	return p;
+}
+
+/* The arena counterpart of savestring(): STR is copied into the current
+ * listing's arena instead of its own heap block. Strings are dropped
+ * together with the listing: never store them beyond it. */
+char *
+fiarena_savestring(const char *str, const size_t len)
+{
+	char *p = fiarena_alloc(len + 1);
+
+	memcpy(p, str, len);
+	p[len] = '\0';
+
+	return p;
+}
+
+static void
+fiarena_destroy(struct fiarena_t *a)
+{
+	if (!a)
+		return;
+
+	struct fiarena_blk_t *b = a->head;
+	while (b) {
+		struct fiarena_blk_t *next = b->next;
+		free(b->buf);
+		free(b);
+		b = next;
+	}
+
+	free(a);
+}
+
+/* Empty the arena A, keeping only its first block for reuse. */
+static void
+fiarena_reset(struct fiarena_t *a)
+{
+	struct fiarena_blk_t *b = a->head->next;
+	while (b) {
+		struct fiarena_blk_t *next = b->next;
+		free(b->buf);
+		free(b);
+		b = next;
+	}
+
+	a->head->len = 0;
+	a->head->next = (struct fiarena_blk_t *)NULL;
+	a->cur = a->head;
+}
+
+/* Dispose of the arena A: recycle it as the spare arena, or destroy it
+ * if a spare is already available. */
+static void
+fiarena_release(struct fiarena_t *a)
+{
+	if (!a)
+		return;
+
+	if (!fi_arena_spare) {
+		fiarena_reset(a);
+		fi_arena_spare = a;
+	} else {
+		fiarena_destroy(a);
+	}
+}
+
+/* Raw directory scanner
+ *
+ * On Linux, directory entries are read via getdents64(2) in large batches
+ * into a single reusable buffer, instead of one readdir(3) call per entry:
+ * this skips libc's per-entry bookkeeping and halves the function call
+ * count on huge directories. Everywhere else (and if the raw read fails,
+ * e.g. on an exotic file system) we fall back to plain readdir(3).
+ * Entry names returned by dirscan_next() are only valid until the next
+ * call: callers must copy them. */
+
+#if defined(__linux__) && defined(SYS_getdents64)
+# define HAVE_GETDENTS64
+#endif /* __linux__ && SYS_getdents64 */
+
+#define DIRSCAN_BUF_SIZE (1024 * 1024)
+
+struct dirscan_t {
+	DIR *dir; /* readdir(3) fallback */
+#ifdef HAVE_GETDENTS64
+	int fd;
+	int use_raw;
+	ssize_t len; /* Bytes in the current batch */
+	size_t off;  /* Read offset into the current batch */
+	int read_any;
+	int pad0;
+#endif /* HAVE_GETDENTS64 */
+};
+
+#ifdef HAVE_GETDENTS64
+/* Kernel dirent record layout (see getdents(2)) */
+struct xdirent64_t {
+	uint64_t       d_ino;
+	int64_t        d_off;
+	unsigned short d_reclen;
+	unsigned char  d_type;
+	char           d_name[];
+};
+
+/* Batch buffer, allocated once and reused by every scan */
+static char *dirscan_buf = (char *)NULL;
+#endif /* HAVE_GETDENTS64 */
+
+static void
+dirscan_init(struct dirscan_t *ds, DIR *dir)
+{
+	ds->dir = dir;
+#ifdef HAVE_GETDENTS64
+	ds->fd = dirfd(dir);
+	ds->use_raw = (ds->fd != -1);
+	ds->len = 0;
+	ds->off = 0;
+	ds->read_any = 0;
+
+	if (ds->use_raw == 1 && !dirscan_buf)
+		dirscan_buf = xnmalloc(DIRSCAN_BUF_SIZE, sizeof(char));
+#endif /* HAVE_GETDENTS64 */
+}
+
+/* Return the name of the next directory entry, or NULL at end of
+ * directory. DTYPE is set to the entry's DT_* type (DT_UNKNOWN if the
+ * file system does not provide it) and INO to its inode number. */
+static const char *
+dirscan_next(struct dirscan_t *ds, unsigned char *dtype, ino_t *ino)
+{
+#ifdef HAVE_GETDENTS64
+	if (ds->use_raw == 1) {
+		if (ds->off >= (size_t)ds->len) {
+			ds->len = syscall(SYS_getdents64, ds->fd, dirscan_buf,
+				DIRSCAN_BUF_SIZE);
+			if (ds->len == 0)
+				return (char *)NULL;
+			if (ds->len < 0) { /* The raw read failed: fall back */
+				ds->use_raw = 0;
+				/* If entries were already consumed, readdir(3) picks up
+				 * from the shared file offset: no duplicates. */
+				if (ds->read_any == 1)
+					return (char *)NULL;
+				goto FALLBACK;
+			}
+			ds->off = 0;
+			ds->read_any = 1;
+		}
+
+		const struct xdirent64_t *d =
+			(const struct xdirent64_t *)(dirscan_buf + ds->off);
+		ds->off += d->d_reclen;
+		*dtype = d->d_type;
+		*ino = (ino_t)d->d_ino;
+		return d->d_name;
+	}
+
+FALLBACK:;
+#endif /* HAVE_GETDENTS64 */
+	const struct dirent *ent = readdir(ds->dir);
+	if (!ent)
+		return (char *)NULL;
+
+#ifdef _DIRENT_HAVE_D_TYPE
+	*dtype = ent->d_type;
+#else
+	*dtype = DT_UNKNOWN;
+#endif /* _DIRENT_HAVE_D_TYPE */
+	*ino = ent->d_ino;
+	return ent->d_name;
+}
+
+/* Selective statx(2)
+ *
+ * When available, file metadata is gathered via statx(2) instead of
+ * fstatat(2), requesting only the fields the current listing actually
+ * needs (see set_statx_mask()), and passing AT_STATX_DONT_SYNC: on
+ * network file systems (most notably NFS) this allows the kernel to
+ * answer from cached attributes instead of forcing a server round-trip
+ * per file, which otherwise dominates listing latency. On local file
+ * systems the flag is a no-op. */
+
+#ifdef LINUX_STATX
+/* Field mask for the current listing configuration, computed once per
+ * listing by set_statx_mask(). */
+static unsigned int statx_mask = STATX_BASIC_STATS;
+/* Set to 1 if statx(2) is not supported (e.g. pre-4.11 kernel) */
+static int statx_unsupported = 0;
+
+static void
+set_statx_mask(void)
+{
+	/* Type, mode, and hard links drive file classification and the type
+	 * filters; uid/gid drive ownership checks (colors and long view);
+	 * inode (plus device) is matched against the selection box; size and
+	 * blocks drive file colors (empty files), size sorting, and the long
+	 * view size field. */
+	statx_mask = STATX_TYPE | STATX_MODE | STATX_NLINK | STATX_UID
+		| STATX_GID | STATX_INO | STATX_SIZE | STATX_BLOCKS;
+
+	/* Timestamps are only consumed by time sorts and the long view time
+	 * field (birth time is retrieved separately: see
+	 * load_file_gral_info()). */
+	if (conf.sort == SATIME)
+		statx_mask |= STATX_ATIME;
+	if (conf.sort == SCTIME)
+		statx_mask |= STATX_CTIME;
+	if (conf.sort == SMTIME)
+		statx_mask |= STATX_MTIME;
+
+	if (conf.long_view == 1) {
+		switch (prop_fields.time) {
+		case PROP_TIME_ACCESS: statx_mask |= STATX_ATIME; break;
+		case PROP_TIME_CHANGE: statx_mask |= STATX_CTIME; break;
+		case PROP_TIME_BIRTH: break;
+		default: statx_mask |= STATX_MTIME; break;
+		}
+	}
+
+	/* The full-dir-size (xdu) and files-counter (dcnt) caches are keyed
+	 * by mtime: a zeroed timestamp would make every directory look
+	 * permanently unchanged. */
+	if (conf.full_dir_size == 1 || conf.files_counter == 1)
+		statx_mask |= STATX_MTIME;
+}
+
+static void
+statx_to_stat(const struct statx *stx, struct stat *sb)
+{
+	*sb = (struct stat){0};
+	sb->st_dev = makedev(stx->stx_dev_major, stx->stx_dev_minor);
+	sb->st_ino = (ino_t)stx->stx_ino;
+	sb->st_mode = (mode_t)stx->stx_mode;
+	sb->st_nlink = (nlink_t)stx->stx_nlink;
+	sb->st_uid = stx->stx_uid;
+	sb->st_gid = stx->stx_gid;
+	sb->st_rdev = makedev(stx->stx_rdev_major, stx->stx_rdev_minor);
+	sb->st_size = (off_t)stx->stx_size;
+	sb->st_blksize = (blksize_t)stx->stx_blksize;
+	sb->st_blocks = (blkcnt_t)stx->stx_blocks;
+	sb->st_atime = (time_t)stx->stx_atime.tv_sec;
+	sb->st_ctime = (time_t)stx->stx_ctime.tv_sec;
+	sb->st_mtime = (time_t)stx->stx_mtime.tv_sec;
+}
+#endif /* LINUX_STATX */
+
+/* Drop-in replacement for fstatat(2) used by the listing stat loops:
+ * use statx(2) with a minimal field mask when possible. */
+static int
+xfstatat(const int fd, const char *file, struct stat *sb, const int flag)
+{
+#ifdef LINUX_STATX
+	if (statx_unsupported == 0) {
+		struct statx stx;
+		if (statx(fd, file, flag | AT_STATX_DONT_SYNC,
+		statx_mask, &stx) == 0) {
+			statx_to_stat(&stx, sb);
+			return 0;
+		}
+
+		if (errno != ENOSYS && errno != EINVAL)
+			return -1; /* A real lookup error */
+
+		statx_unsupported = 1; /* Fall back to fstatat(2) for good */
+	}
+#endif /* LINUX_STATX */
+
+	return fstatat(fd, file, sb, flag);
+}
+
+/* Parallel stat phase
+ *
+ * On large directories (most notably on network file systems, where each
+ * stat(2) call pays a full round-trip), the serial lstat(2) loop in
+ * list_dir() dominates listing time. To mitigate this, we first gather all
+ * directory entries (names only), and then fill the corresponding stat
+ * structs using a small pool of worker threads, each one handling a strided
+ * slice of the entries list (no locking needed). The main listing loop then
+ * consumes the pre-computed results instead of issuing one stat(2) call per
+ * entry.
+ *
+ * The parallel path is only taken for directories with at least
+ * PSTAT_MIN_ENTRIES entries on multi-core machines: for small directories
+ * the thread setup cost exceeds the gain, in which case we fall back to
+ * the traditional serial stat loop. */
+
+/* Do not parallelize directories smaller than this. */
+#define PSTAT_MIN_ENTRIES 512
+/* Hard limit for the amount of stat worker threads. */
+#define PSTAT_MAX_THREADS 16
+
+struct pstat_t {
+	char **names;       /* Gathered entry names (allocated) */
+	struct stat *attrs; /* Stat result per entry (parallel phase only) */
+	uint8_t *errs;      /* Per-entry stat error flag (parallel phase only) */
+	filesn_t n;         /* Number of gathered entries */
+	size_t capacity;    /* Allocated slots in the names array */
+};
+
+struct pstat_worker_t {
+	struct pstat_t *ps;
+	int fd;        /* File descriptor of the listed directory */
+	int stat_flag; /* Flags to be passed to fstatat(2) */
+	int id;        /* Worker index (defines this worker's stride) */
+	int nthreads;  /* Total amount of workers */
+};
+
+/* Stat every entry whose index I satisfies I % NTHREADS == ID, storing
+ * results in the attrs/errs arrays of the pstat struct. */
+static void *
+pstat_worker(void *arg)
+{
+	struct pstat_worker_t *w = (struct pstat_worker_t *)arg;
+	struct pstat_t *ps = w->ps;
+
+	for (filesn_t i = w->id; i < ps->n; i += w->nthreads) {
+		ps->errs[i] = (xfstatat(w->fd, ps->names[i], &ps->attrs[i],
+			w->stat_flag) == -1);
+	}
+
+	return NULL;
+}
+
+/* Return the number of stat worker threads to be used, based on the
+ * amount of available processors (1 means "do not parallelize").
+ * Shared with the other parallel phases (directory sizes, and the
+ * parallel sort in sort.c). */
+int
+pstat_get_threads(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	const long p = sysconf(_SC_NPROCESSORS_ONLN);
+	if (p <= 1)
+		return 1;
+	return p > PSTAT_MAX_THREADS ? PSTAT_MAX_THREADS : (int)p;
+#else
+	return 1;
+#endif /* _SC_NPROCESSORS_ONLN */
+}
+
+/* Streaming preview for big directories
+ *
+ * list_dir() reads, stats, and sorts the whole directory before printing
+ * a single line, so entering a huge (or slow, e.g. NFS) directory blanks
+ * the UI for as long as the scan takes. If just reading the entry names
+ * (pstat_collect()) took longer than PREVIEW_COLLECT_NSEC, stat'ing,
+ * processing, and sorting them will take at least as long: print a first
+ * screenful of names right away (unsorted and uncolored: we know nothing
+ * about these files yet), and erase it once the full list is ready.
+ * Only when the pager is enabled: without it the final listing scrolls
+ * the preview away anyway. */
+#define PREVIEW_COLLECT_NSEC 100000000 /* 100ms */
+
+/* Print up to a screenful of raw entry names from PST as a scan preview.
+ * Returns the number of lines printed (0: no preview). */
+static int
+print_scan_preview(const struct pstat_t *pst)
+{
+	const int max_lines = term_lines > 2 ? term_lines - 2 : 0;
+	const int max_len = term_cols > 1 ? term_cols - 1 : 1;
+	int lines = 0;
+
+	for (filesn_t i = 0; i < pst->n && lines < max_lines; i++) {
+		const char *name = pst->names[i];
+		if (SELFORPARENT(name)
+		|| (*name == '.' && conf.show_hidden == 0))
+			continue;
+
+		/* Truncate to the terminal width to keep names to one line each
+		 * (a name has at least as many bytes as display columns). Do not
+		 * break an UTF-8 character in the middle. */
+		int len = (int)strnlen(name, (size_t)max_len);
+		while (len > 0 && len == max_len
+		&& (name[len] & 0xc0) == 0x80) /* Continuation byte */
+			len--;
+
+		printf("%.*s\n", len, name);
+		lines++;
+	}
+
+	if (lines == 0)
+		return 0;
+
+	fputs(_("Scanning... "), stdout);
+	fflush(stdout);
+	return lines + 1; /* Plus the "Scanning..." line */
+}
+
+static void
+erase_scan_preview(const int lines)
+{
+	putchar('\r');
+	MOVE_CURSOR_UP(lines - 1); /* The last line has no newline */
+	ERASE_TO_RIGHT_AND_BELOW;
+	fflush(stdout);
+}
+
+/* Gather the names of all entries in the directory DIR into PS->NAMES.
+ * Name-independent filtering/processing is deferred to the main listing
+ * loop, which runs over the gathered list. */
+static void
+pstat_collect(DIR *dir, struct pstat_t *ps)
+{
+	struct dirscan_t dscan;
+	unsigned char dtype = DT_UNKNOWN;
+	ino_t ino = 0;
+	const char *name;
+
+	dirscan_init(&dscan, dir);
+
+	errno = 0;
+	while ((name = dirscan_next(&dscan, &dtype, &ino))) {
+		if (ps->n >= (filesn_t)ps->capacity) {
+			ps->capacity += ENTRY_N * 8;
+			ps->names = xnrealloc(ps->names, ps->capacity, sizeof(char *));
+		}
+		ps->names[ps->n] = fiarena_savestring(name, strlen(name));
+		ps->n++;
+	}
+}
+
+/* Run the parallel stat phase over the entries gathered in PS, provided
+ * the directory is big enough and we have more than one processor.
+ * If the parallel phase is skipped (or thread creation fails), PS->ATTRS
+ * stays NULL and the caller stats entries serially, just as before. */
+static void
+pstat_run(struct pstat_t *ps, const int fd, const int stat_flag)
+{
+	const int nthreads = pstat_get_threads();
+	if (ps->n < PSTAT_MIN_ENTRIES || nthreads < 2)
+		return;
+
+	ps->attrs = xnmalloc((size_t)ps->n, sizeof(struct stat));
+	ps->errs = xnmalloc((size_t)ps->n, sizeof(uint8_t));
+
+	pthread_t threads[PSTAT_MAX_THREADS];
+	struct pstat_worker_t workers[PSTAT_MAX_THREADS];
+	int started = 0;
+
+	for (int t = 0; t < nthreads; t++) {
+		workers[t] = (struct pstat_worker_t){ .ps = ps, .fd = fd,
+			.stat_flag = stat_flag, .id = t, .nthreads = nthreads };
+		if (pthread_create(&threads[t], NULL, pstat_worker,
+		&workers[t]) != 0)
+			break;
+		started++;
+	}
+
+	if (started == 0) { /* Fall back to the serial stat loop */
+		free(ps->attrs); ps->attrs = (struct stat *)NULL;
+		free(ps->errs); ps->errs = (uint8_t *)NULL;
+		return;
+	}
+
+	if (started < nthreads) {
+		/* Some workers could not be launched: process their slices in
+		 * the current thread. */
+		for (int t = started; t < nthreads; t++)
+			pstat_worker(&workers[t]);
+	}
+
+	for (int t = 0; t < started; t++)
+		pthread_join(threads[t], NULL);
+}
+
+/* Free the pstat struct PS once the listing loop is done. */
+static void
+pstat_free(struct pstat_t *ps)
+{
+	/* The names themselves live in the listing arena: they are either
+	 * owned by the file list by now or reclaimed with the arena. */
+	free(ps->names);
+	free(ps->attrs);
+	free(ps->errs);
+	*ps = (struct pstat_t){0};
+}
+
+/* Deferred directory full sizes (FullDirSize)
+ *
+ * Computing directory sizes serially, one du(1)-like traversal per entry
+ * while scanning, dominates the listing time of directories with big
+ * subtrees. Instead of computing sizes in the scan loop, directories
+ * whose size is not in the xdu cache (see xdu.c) are queued here, and
+ * the whole queue is run through a pool of worker threads before the
+ * sort/display phase. Results are recorded in the cache keyed by
+ * device/inode/mtime, so revisiting unchanged directories costs
+ * nothing. */
+
+struct xdu_pending_t {
+	filesn_t idx; /* Index of the entry in file_info */
+	dev_t dev;    /* Cache key of the queued directory */
+	ino_t ino;
+	time_t mtime;
+};
+
+static struct xdu_pending_t *xdu_pending = (struct xdu_pending_t *)NULL;
+static filesn_t xdu_pending_n = 0;
+static size_t xdu_pending_cap = 0;
+
+#ifndef USE_DU1
+static pthread_mutex_t xdu_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static filesn_t xdu_queue_next = 0;
+#endif /* !USE_DU1 */
+
+static void
+xdu_pending_add(const filesn_t idx, const struct stat *attr)
+{
+	if ((size_t)xdu_pending_n >= xdu_pending_cap) {
+		xdu_pending_cap += ENTRY_N;
+		xdu_pending = xnrealloc(xdu_pending, xdu_pending_cap,
+			sizeof(struct xdu_pending_t));
+	}
+
+	xdu_pending[xdu_pending_n].idx = idx;
+	xdu_pending[xdu_pending_n].dev = attr->st_dev;
+	xdu_pending[xdu_pending_n].ino = attr->st_ino;
+	xdu_pending[xdu_pending_n].mtime = attr->st_mtime;
+	xdu_pending_n++;
+}
+
+/* Compute the size of a single queued directory and record the result
+ * in both the corresponding file_info entry and the xdu cache. */
+static void
+xdu_run_entry(const struct xdu_pending_t *p)
+{
+	int status = 0;
+	int approx = 0;
+	off_t size;
+
+	if (conf.approx_dir_size == 1)
+		size = dir_size_estimate(file_info[p->idx].name, 1, &status, &approx);
+	else
+		size = dir_size(file_info[p->idx].name, 1, &status);
+
+	file_info[p->idx].size = size;
+	file_info[p->idx].du_status = status;
+	file_info[p->idx].du_approx = approx;
+	xdu_cache_put(p->dev, p->ino, p->mtime, size, status, approx);
+}
+
+#ifndef USE_DU1
+/* Traversals are heavy and uneven (a single huge subtree can take longer
+ * than all the others together), so workers pull entries from a shared
+ * queue instead of using fixed slices. */
+static void *
+xdu_worker(void *arg)
+{
+	(void)arg;
+
+	while (1) {
+		pthread_mutex_lock(&xdu_queue_lock);
+		const filesn_t q = xdu_queue_next++;
+		pthread_mutex_unlock(&xdu_queue_lock);
+
+		if (q >= xdu_pending_n)
+			break;
+
+		xdu_run_entry(&xdu_pending[q]);
+	}
+
+	return NULL;
+}
+#endif /* !USE_DU1 */
+
+#ifndef USE_DU1
+/* Background refinement of approximate directory sizes.
+ *
+ * When ApproxDirSize is enabled the listing only pays for the sampling
+ * traversal; the exact sizes are then computed here, off the main
+ * thread, and recorded in the xdu cache, where they replace the
+ * estimates the next time the directory is listed. */
+
+struct xdu_refine_item_t {
+	char *path; /* Absolute: the worker outlives the current listing */
+	dev_t dev;
+	ino_t ino;
+	time_t mtime;
+};
+
+struct xdu_refine_t {
+	struct xdu_refine_item_t *items;
+	size_t n;
+};
+
+static pthread_mutex_t xdu_refine_lock = PTHREAD_MUTEX_INITIALIZER;
+static int xdu_refine_running = 0;
+
+static void *
+xdu_refine_worker(void *arg)
+{
+	struct xdu_refine_t *r = (struct xdu_refine_t *)arg;
+
+	for (size_t i = 0; i < r->n; i++) {
+		int status = 0;
+		const off_t size = dir_size(r->items[i].path, 1, &status);
+		xdu_cache_put(r->items[i].dev, r->items[i].ino,
+			r->items[i].mtime, size, status, 0);
+		free(r->items[i].path);
+	}
+
+	free(r->items);
+	free(r);
+
+	pthread_mutex_lock(&xdu_refine_lock);
+	xdu_refine_running = 0;
+	pthread_mutex_unlock(&xdu_refine_lock);
+
+	return NULL;
+}
+
+/* Queue every entry left approximate by the current pass for exact
+ * recomputation in a detached background thread. A single refinement
+ * pass runs at a time: if one is already running, this listing's
+ * estimates just wait for the next one. */
+static void
+xdu_refine_start(void)
+{
+	pthread_mutex_lock(&xdu_refine_lock);
+	const int busy = xdu_refine_running;
+	if (busy == 0)
+		xdu_refine_running = 1;
+	pthread_mutex_unlock(&xdu_refine_lock);
+
+	if (busy == 1 || !workspaces[cur_ws].path)
+		return;
+
+	struct xdu_refine_t *r = xnmalloc(1, sizeof(struct xdu_refine_t));
+	r->items = xnmalloc((size_t)xdu_pending_n,
+		sizeof(struct xdu_refine_item_t));
+	r->n = 0;
+
+	const char *cwd = workspaces[cur_ws].path;
+	const size_t cwd_len = strlen(cwd);
+
+	for (filesn_t i = 0; i < xdu_pending_n; i++) {
+		const struct xdu_pending_t *p = &xdu_pending[i];
+		if (file_info[p->idx].du_approx != 1)
+			continue;
+
+		const size_t len = cwd_len + strlen(file_info[p->idx].name) + 2;
+		char *path = xnmalloc(len, sizeof(char));
+		snprintf(path, len, "%s/%s", cwd, file_info[p->idx].name);
+
+		r->items[r->n].path = path;
+		r->items[r->n].dev = p->dev;
+		r->items[r->n].ino = p->ino;
+		r->items[r->n].mtime = p->mtime;
+		r->n++;
+	}
+
+	int started = 0;
+	if (r->n > 0) {
+		pthread_t t;
+		pthread_attr_t attr;
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+		started = (pthread_create(&t, &attr, xdu_refine_worker, r) == 0);
+		pthread_attr_destroy(&attr);
+	}
+
+	if (started == 0) {
+		for (size_t i = 0; i < r->n; i++)
+			free(r->items[i].path);
+		free(r->items);
+		free(r);
+
+		pthread_mutex_lock(&xdu_refine_lock);
+		xdu_refine_running = 0;
+		pthread_mutex_unlock(&xdu_refine_lock);
+	}
+}
+#endif /* !USE_DU1 */
+
+/* Resolve every queued directory size. Called once the scan loop is
+ * done, and before the sort/display phase (sizes take part in both). */
+static void
+xdu_run_pending(void)
+{
+	if (xdu_pending_n == 0)
+		return;
+
+#ifdef USE_DU1
+	if (conf.approx_dir_size == 1) {
+		/* Estimates use the native sampling traversal: no du(1) here.
+		 * NOTE: Without worker threads (du builds redirect stdout and
+		 * cannot run concurrently) there is no background refinement
+		 * either: estimates stand until the directory changes. */
+		for (filesn_t i = 0; i < xdu_pending_n; i++)
+			xdu_run_entry(&xdu_pending[i]);
+
+		free(xdu_pending);
+		xdu_pending = (struct xdu_pending_t *)NULL;
+		xdu_pending_n = 0;
+		xdu_pending_cap = 0;
+		return;
+	}
+
+	/* Spawning du(1) once per directory pays the fork/exec cost for
+	 * every entry. Batch the whole queue into a single invocation
+	 * instead ("du -s -- DIR1 DIR2 ..."): one exec per listing. */
+	char **dirs = xnmalloc((size_t)xdu_pending_n, sizeof(char *));
+	off_t *sizes = xnmalloc((size_t)xdu_pending_n, sizeof(off_t));
+
+	for (filesn_t i = 0; i < xdu_pending_n; i++)
+		dirs[i] = file_info[xdu_pending[i].idx].name;
+
+	if (dir_sizes(dirs, (size_t)xdu_pending_n, sizes) == FUNC_SUCCESS) {
+		for (filesn_t i = 0; i < xdu_pending_n; i++) {
+			const struct xdu_pending_t *p = &xdu_pending[i];
+			file_info[p->idx].size = sizes[i];
+			file_info[p->idx].du_status = 0;
+			xdu_cache_put(p->dev, p->ino, p->mtime, sizes[i], 0, 0);
+		}
+	} else {
+		/* The batch failed somewhere, but du's exit code cannot be
+		 * attributed to a specific directory: recompute one by one to
+		 * get accurate per-entry exit codes.
+		 * NOTE: dir_size() redirects stdout to capture du(1) output: it
+		 * cannot run concurrently. */
+		for (filesn_t i = 0; i < xdu_pending_n; i++)
+			xdu_run_entry(&xdu_pending[i]);
+	}
+
+	free(dirs);
+	free(sizes);
+#else
+	int nthreads = pstat_get_threads();
+	if (nthreads > (int)xdu_pending_n)
+		nthreads = (int)xdu_pending_n;
+
+	xdu_queue_next = 0;
+
+	pthread_t threads[PSTAT_MAX_THREADS];
+	int started = 0;
+
+	for (int t = 0; t < nthreads - 1; t++) {
+		if (pthread_create(&threads[t], NULL, xdu_worker, NULL) != 0)
+			break;
+		started++;
+	}
+
+	/* The current thread works the queue too (and picks up the whole
+	 * queue by itself if no worker could be launched). */
+	xdu_worker(NULL);
+
+	for (int t = 0; t < started; t++)
+		pthread_join(threads[t], NULL);
+
+	if (conf.approx_dir_size == 1)
+		xdu_refine_start();
+#endif /* USE_DU1 */
+
+	free(xdu_pending);
+	xdu_pending = (struct xdu_pending_t *)NULL;
+	xdu_pending_n = 0;
+	xdu_pending_cap = 0;
+}
+
+/* Deferred subdirectory file counts (FilesCounter)
+ *
+ * With the files counter enabled, load_dir_info() used to run
+ * count_dir() -- an opendir/readdir(3) pass -- serially for every
+ * listed subdirectory. Counts are now served from a small cache keyed
+ * by device/inode/mtime, so unchanged directories cost nothing on a
+ * refresh, and cache misses are queued and counted by a pool of worker
+ * threads before the sort/display phase. A directory's color (and its
+ * lock icon) depends on the count, so queued entries get their color
+ * resolved once the counting pass is done. */
+
+#define DCNT_CACHE_SIZE 1024 /* Must be a power of two */
+
+struct dcnt_cache_t {
+	dev_t dev;
+	ino_t ino;
+	time_t mtime;
+	filesn_t count;
+	int used;
+};
+
+static struct dcnt_cache_t dcnt_cache[DCNT_CACHE_SIZE];
+static pthread_mutex_t dcnt_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+struct dcnt_pending_t {
+	filesn_t idx;  /* Index of the entry in file_info */
+	dev_t dev;     /* Cache key of the queued directory */
+	ino_t ino;
+	time_t mtime;
+	mode_t mode;   /* To resolve the directory color after counting */
+	int daccess;
+};
+
+static struct dcnt_pending_t *dcnt_pending = (struct dcnt_pending_t *)NULL;
+static filesn_t dcnt_pending_n = 0;
+static size_t dcnt_pending_cap = 0;
+
+static pthread_mutex_t dcnt_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static filesn_t dcnt_queue_next = 0;
+
+/* Look up the files count of the directory identified by DEV, INO, and
+ * MTIME. If found, set COUNT to the cached value and return
+ * FUNC_SUCCESS. Otherwise, return FUNC_FAILURE. */
+static int
+dcnt_cache_get(const dev_t dev, const ino_t ino, const time_t mtime,
+	filesn_t *count)
+{
+	struct dcnt_cache_t *e =
+		&dcnt_cache[((size_t)ino ^ (size_t)dev) & (DCNT_CACHE_SIZE - 1)];
+	int found = 0;
+
+	pthread_mutex_lock(&dcnt_cache_lock);
+	if (e->used == 1 && e->dev == dev && e->ino == ino
+	&& e->mtime == mtime) {
+		*count = e->count;
+		found = 1;
+	}
+	pthread_mutex_unlock(&dcnt_cache_lock);
+
+	return found == 1 ? FUNC_SUCCESS : FUNC_FAILURE;
+}
+
+/* Record the files count COUNT of the directory identified by DEV, INO,
+ * and MTIME. */
+static void
+dcnt_cache_put(const dev_t dev, const ino_t ino, const time_t mtime,
+	const filesn_t count)
+{
+	struct dcnt_cache_t *e =
+		&dcnt_cache[((size_t)ino ^ (size_t)dev) & (DCNT_CACHE_SIZE - 1)];
+
+	pthread_mutex_lock(&dcnt_cache_lock);
+	e->dev = dev;
+	e->ino = ino;
+	e->mtime = mtime;
+	e->count = count;
+	e->used = 1;
+	pthread_mutex_unlock(&dcnt_cache_lock);
+}
+
+static void
+dcnt_pending_add(const filesn_t idx, const struct stat *attr,
+	const int daccess)
+{
+	if ((size_t)dcnt_pending_n >= dcnt_pending_cap) {
+		dcnt_pending_cap += ENTRY_N;
+		dcnt_pending = xnrealloc(dcnt_pending, dcnt_pending_cap,
+			sizeof(struct dcnt_pending_t));
+	}
+
+	dcnt_pending[dcnt_pending_n].idx = idx;
+	dcnt_pending[dcnt_pending_n].dev = attr->st_dev;
+	dcnt_pending[dcnt_pending_n].ino = attr->st_ino;
+	dcnt_pending[dcnt_pending_n].mtime = attr->st_mtime;
+	dcnt_pending[dcnt_pending_n].mode = attr->st_mode;
+	dcnt_pending[dcnt_pending_n].daccess = daccess;
+	dcnt_pending_n++;
+}
+
+static void *
+dcnt_worker(void *arg)
+{
+	(void)arg;
+
+	while (1) {
+		pthread_mutex_lock(&dcnt_queue_lock);
+		const filesn_t q = dcnt_queue_next++;
+		pthread_mutex_unlock(&dcnt_queue_lock);
+
+		if (q >= dcnt_pending_n)
+			break;
+
+		const struct dcnt_pending_t *p = &dcnt_pending[q];
+		const filesn_t count =
+			count_dir(file_info[p->idx].name, NO_CPOP) - 2;
+
+		file_info[p->idx].filesn = count;
+		dcnt_cache_put(p->dev, p->ino, p->mtime, count);
+	}
+
+	return NULL;
+}
+
+/* Resolve the color (and icon) of the queued directory entry at P, now
+ * that its files count is known. This is the deferred tail of
+ * load_dir_info(). */
+static void
+dcnt_apply_entry(const struct dcnt_pending_t *p)
+{
+	const filesn_t n = p->idx;
+
+	if (p->daccess == 0 || file_info[n].filesn < 0) {
+		file_info[n].color = nd_c;
+#ifndef _NO_ICONS
+		file_info[n].icon = ICON_LOCK;
+		file_info[n].icon_color = YELLOW;
+#endif /* !_NO_ICONS */
+	} else {
+		file_info[n].color = (p->mode & S_ISVTX)
+			? ((p->mode & S_IWOTH) ? tw_c : st_c)
+			: ((p->mode & S_IWOTH) ? ow_c
+			: (file_info[n].filesn == 0 ? ed_c : di_c));
+	}
+
+	if (file_info[n].color == tw_c) {
+		stats.other_writable++;
+		stats.sticky++;
+	} else if (file_info[n].color == ow_c) {
+		stats.other_writable++;
+	} else if (file_info[n].color == st_c) {
+		stats.sticky++;
+	}
+}
+
+/* Run the queued directory counts through the worker pool, and resolve
+ * the deferred colors and statistics. */
+static void
+dcnt_run_pending(void)
+{
+	if (dcnt_pending_n == 0)
+		return;
+
+	int nthreads = pstat_get_threads();
+	if (nthreads > (int)dcnt_pending_n)
+		nthreads = (int)dcnt_pending_n;
+
+	dcnt_queue_next = 0;
+
+	pthread_t threads[PSTAT_MAX_THREADS];
+	int started = 0;
+
+	for (int t = 0; t < nthreads - 1; t++) {
+		if (pthread_create(&threads[t], NULL, dcnt_worker, NULL) != 0)
+			break;
+		started++;
+	}
+
+	/* The current thread works the queue too (and picks up the whole
+	 * queue by itself if no worker could be launched). */
+	dcnt_worker(NULL);
+
+	for (int t = 0; t < started; t++)
+		pthread_join(threads[t], NULL);
+
+	for (filesn_t i = 0; i < dcnt_pending_n; i++)
+		dcnt_apply_entry(&dcnt_pending[i]);
+
+	free(dcnt_pending);
+	dcnt_pending = (struct dcnt_pending_t *)NULL;
+	dcnt_pending_n = 0;
+	dcnt_pending_cap = 0;
+}
+
+/* Symlink target cache
+ *
+ * Resolving a listed symlink costs a following stat of its target
+ * (colors, broken-link detection) plus, with ColorLinksAsTarget, a
+ * readlink(2) -- two extra syscalls per entry, paid again on every
+ * rescan of a directory full of symlinks. Both results are cached here,
+ * keyed by the identity (device/inode/mtime) of the symlink itself: a
+ * link cannot change its target without being recreated, which gives it
+ * a new identity. The target, however, can change behind an unchanged
+ * link, so the whole cache is dropped whenever the current directory is
+ * explicitly reloaded (see reload_dirlist()): a refresh is the request
+ * to re-check. */
+
+#define LNK_CACHE_SIZE 1024 /* Must be a power of two */
+
+struct lnk_cache_t {
+	char *target;      /* readlink(2) result (NULL: not gathered) */
+	struct stat tstat; /* Stat of the link target (following) */
+	dev_t dev;         /* Identity of the symlink itself */
+	ino_t ino;
+	time_t mtime;
+	size_t gen;
+	int stat_err;      /* Stat of the target failed (broken link) */
+	int used;
+};
+
+static struct lnk_cache_t lnk_cache[LNK_CACHE_SIZE];
+static size_t lnk_cache_gen = 1;
+
+static struct lnk_cache_t *
+lnk_cache_slot(const dev_t dev, const ino_t ino)
+{
+	return &lnk_cache[((size_t)ino ^ (size_t)dev) & (LNK_CACHE_SIZE - 1)];
+}
+
+/* Return the cached resolution of the symlink whose own stat info is A,
+ * or NULL if not cached (or cached under an older generation). */
+static struct lnk_cache_t *
+lnk_cache_get(const struct stat *a)
+{
+	struct lnk_cache_t *e = lnk_cache_slot(a->st_dev, a->st_ino);
+
+	if (e->used == 1 && e->gen == lnk_cache_gen && e->dev == a->st_dev
+	&& e->ino == a->st_ino && e->mtime == a->st_mtime)
+		return e;
+
+	return (struct lnk_cache_t *)NULL;
+}
+
+/* Record the resolution of the symlink whose own stat info is A: TSTAT
+ * and TARGET as gathered (either may be NULL), STAT_ERR set if the
+ * target could not be stat'd. */
+static void
+lnk_cache_put(const struct stat *a, const struct stat *tstat,
+	const int stat_err, const char *target)
+{
+	struct lnk_cache_t *e = lnk_cache_slot(a->st_dev, a->st_ino);
+
+	free(e->target);
+	e->target = target ? savestring(target, strlen(target)) : (char *)NULL;
+	if (tstat)
+		e->tstat = *tstat;
+	e->stat_err = stat_err;
+	e->dev = a->st_dev;
+	e->ino = a->st_ino;
+	e->mtime = a->st_mtime;
+	e->gen = lnk_cache_gen;
+	e->used = 1;
+}
+
+/* Forget all cached symlink resolutions: their targets may have changed
+ * behind the unchanged links. */
+static void
+lnk_cache_invalidate(void)
+{
+	lnk_cache_gen++;
+}
+
+/* Sort generation tracking. DIRLIST_GEN is bumped whenever the entries
+ * of file_info change (a rescan, an incremental patch, a cache swap),
+ * and record_sort() captures, together with the generation, the
+ * parameters the list was last sorted under. dirlist_sorted() then tells
+ * the redisplay paths (e.g. a terminal resize) whether the list is
+ * already in the required order, so that the sort pass can be skipped
+ * when neither the file set nor the sort settings changed. */
+static size_t dirlist_gen = 0;
+static size_t sorted_gen = (size_t)-1;
+static int sorted_method = -1;
+static int sorted_reverse = -1;
+static int sorted_dirs_first = -1;
+static int sorted_light = -1;
+static filesn_t sorted_max_files = -2;
+
+static void
+record_sort(void)
+{
+	sorted_gen = dirlist_gen;
+	sorted_method = conf.sort;
+	sorted_reverse = conf.sort_reverse;
+	sorted_dirs_first = conf.list_dirs_first;
+	sorted_light = conf.light_mode;
+	sorted_max_files = max_files;
+}
+
+static int
+dirlist_sorted(void)
+{
+	return (sorted_gen == dirlist_gen && sorted_method == conf.sort
+		&& sorted_reverse == conf.sort_reverse
+		&& sorted_dirs_first == conf.list_dirs_first
+		&& sorted_light == conf.light_mode
+		&& sorted_max_files == max_files);
+}
+
+/* Directory listing cache
+ *
+ * Navigating back and forth between two large directories (e.g. via the
+ * b/f dirhist commands) re-runs the whole list_dir() pipeline each time.
+ * We keep a small LRU cache of fully-built file_info arrays keyed by
+ * device/inode/mtime: revisiting an unchanged directory swaps the cached
+ * array back in and goes straight to the display phase, instead of
+ * re-reading and re-stating every entry.
+ *
+ * A cached list is only reused if the listing parameters under which it
+ * was built (the checks_t struct, color scheme, selection count, etc.)
+ * still apply: otherwise the slot is dropped and the directory rescanned.
+ * Note that, just like mtime-based tools, this cannot detect changes that
+ * do not touch the directory itself (e.g. chmod on a contained file while
+ * away from the directory). */
+
+#define DIRCACHE_SLOTS 8
+
+/* Listing parameters the cached entries were built under. Plain values
+ * only: slots are compared with memcmp(3). */
+struct dircache_params_t {
+	struct checks_t checks;
+	char *cscheme;    /* Address of the current color scheme name */
+	char *filter_str; /* Address of the current filter string */
+	size_t seln;      /* Amount of selected files */
+	filesn_t max_files;
+	int long_view;
+	int show_hidden;
+	int only_dirs;
+	int icons;
+	int colorize;
+	int files_counter;
+	int follow_links;
+	int follow_links_long;
+	int sort;
+	int sort_reverse;
+	int dirs_first;
+};
+
+struct dircache_t {
+	struct fileinfo *file_info;
+	struct fiarena_t *arena; /* Arena holding the list's strings */
+	struct stats_t stats;
+	struct dircache_params_t params;
+	filesn_t files;
+	filesn_t excluded;
+	dev_t dev;
+	ino_t ino;
+	time_t mtime;
+	size_t stamp; /* LRU: last time this slot was stored/used */
+	size_t longest;    /* Column layout the list was printed with */
+	size_t longest_fc; /* (see get_longest_filename()) */
+	int layout_pad;    /* ELN pad the layout was computed for (-1: none) */
+	int layout_cols;   /* Terminal width the layout was computed for */
+	int have_xattr;
+	int used;
+};
+
+static struct dircache_t dircache[DIRCACHE_SLOTS];
+static size_t dircache_stamp = 0;
+
+/* ELN pad and terminal width the current values of longest/longest_fc
+ * were computed for (-1 if no layout has been computed for the current
+ * list; in long view, longest is clamped to the terminal width during
+ * the print run). Stashed and restored with the list, so that
+ * redisplay_dirlist() can skip the layout pass when an unchanged list
+ * is swapped back in under the same pad and width. */
+static int cur_layout_pad = -1;
+static int cur_layout_cols = -1;
+static int restored_layout_pad = -1;
+static int restored_layout_cols = -1;
+
+/* Identity of the currently listed directory, recorded by list_dir()
+ * before scanning. Used by dircache_stash() to key the stashed list. */
+static struct {
+	dev_t dev;
+	ino_t ino;
+	time_t mtime;
+	int valid;
+} dircache_cur;
+
+/* Parameters the current list was built under, captured together with
+ * dircache_cur: settings may change before the list is stashed (e.g.
+ * per-workspace options applied on a workspace switch), and the stashed
+ * copy must be keyed by the values used to build it. */
+static struct dircache_params_t dircache_cur_params;
+
+static int
+dircache_enabled(void)
+{
+	return (conf.autols == 1 && conf.light_mode == 0 && virtual_dir == 0
+		&& xargs.disk_usage_analyzer != 1 && xargs.list_and_quit != 1);
+}
+
+static void
+dircache_get_params(struct dircache_params_t *p)
+{
+	*p = (struct dircache_params_t){0};
+	p->checks = checks;
+	p->cscheme = cur_cscheme;
+	p->filter_str = filter.str;
+	p->seln = sel_n;
+	p->max_files = max_files;
+	p->long_view = conf.long_view;
+	p->show_hidden = conf.show_hidden;
+	p->only_dirs = conf.only_dirs;
+	p->icons = conf.icons;
+	p->colorize = conf.colorize;
+	p->files_counter = conf.files_counter;
+	p->follow_links = follow_symlinks;
+	p->follow_links_long = conf.follow_symlinks_long;
+	p->sort = conf.sort;
+	p->sort_reverse = conf.sort_reverse;
+	p->dirs_first = conf.list_dirs_first;
+}
+
+/* Free the file_info array held by the cache slot D. */
+static void
+dircache_free_slot(struct dircache_t *d)
+{
+	if (d->used == 0)
+		return;
+
+	free(d->file_info);
+	fiarena_release(d->arena);
+	*d = (struct dircache_t){0};
+}
+
+/* Record the identity of the directory we are about to list, so that
+ * dircache_stash() can key the list once we leave it. */
+static void
+dircache_record_cur(void)
+{
+	dircache_cur.valid = 0;
+
+	struct stat a;
+	if (dircache_enabled() == 0 || !workspaces[cur_ws].path
+	|| stat(workspaces[cur_ws].path, &a) == -1 || !S_ISDIR(a.st_mode))
+		return;
+
+	dircache_cur.dev = a.st_dev;
+	dircache_cur.ino = a.st_ino;
+	dircache_cur.mtime = a.st_mtime;
+	dircache_cur.valid = 1;
+	dircache_get_params(&dircache_cur_params);
+}
+
+/* Stash the current file list into the cache instead of freeing it.
+ * Return FUNC_SUCCESS if the list was taken over by the cache, or
+ * FUNC_FAILURE if the caller must free it as usual. */
+static int
+dircache_stash(void)
+{
+	if (dircache_cur.valid == 0 || dircache_enabled() == 0
+	|| !file_info || files <= 0)
+		return FUNC_FAILURE;
+
+	/* Reuse the slot already holding this directory, or else the least
+	 * recently used one. */
+	struct dircache_t *d = &dircache[0];
+	for (size_t i = 0; i < DIRCACHE_SLOTS; i++) {
+		if (dircache[i].used == 1 && dircache[i].dev == dircache_cur.dev
+		&& dircache[i].ino == dircache_cur.ino) {
+			d = &dircache[i];
+			break;
+		}
+		if (dircache[i].used == 0 || dircache[i].stamp < d->stamp)
+			d = &dircache[i];
+	}
+
+	dircache_free_slot(d);
+
+	d->file_info = file_info;
+	d->arena = fi_arena; /* The list's strings go with it. */
+	fi_arena = (struct fiarena_t *)NULL;
+	d->files = files;
+	d->stats = stats;
+	d->excluded = excluded_files_bk;
+	d->have_xattr = have_xattr_bk;
+	d->longest = longest;
+	d->longest_fc = longest_fc;
+	d->layout_pad = cur_layout_pad;
+	d->layout_cols = cur_layout_cols;
+	d->dev = dircache_cur.dev;
+	d->ino = dircache_cur.ino;
+	d->mtime = dircache_cur.mtime;
+	d->params = dircache_cur_params;
+	d->stamp = ++dircache_stamp;
+	d->used = 1;
+
+	dircache_cur.valid = 0;
+
+	return FUNC_SUCCESS;
+}
+
+/* Look up the current directory in the cache and, on a hit, swap the
+ * cached file list back in. Return FUNC_SUCCESS on a hit (the caller can
+ * go straight to the display phase) or FUNC_FAILURE on a miss. */
+static int
+dircache_restore(void)
+{
+	dircache_record_cur();
+
+	if (dircache_cur.valid == 0)
+		return FUNC_FAILURE;
+
+	struct dircache_t *d = (struct dircache_t *)NULL;
+	for (size_t i = 0; i < DIRCACHE_SLOTS; i++) {
+		if (dircache[i].used == 1 && dircache[i].dev == dircache_cur.dev
+		&& dircache[i].ino == dircache_cur.ino) {
+			d = &dircache[i];
+			break;
+		}
+	}
+
+	if (!d)
+		return FUNC_FAILURE;
+
+	struct dircache_params_t params;
+	dircache_get_params(&params);
+
+	if (d->mtime != dircache_cur.mtime
+	|| memcmp(&params, &d->params, sizeof(params)) != 0) {
+		/* The directory (or the way we list it) changed: rescan. */
+		dircache_free_slot(d);
+		return FUNC_FAILURE;
+	}
+
+	/* Ownership moves back to the listing: empty the slot without
+	 * freeing. */
+	file_info = d->file_info;
+	fiarena_release(fi_arena); /* Just in case: should be NULL here. */
+	fi_arena = d->arena;
+	files = d->files;
+	stats = d->stats;
+	excluded_files_bk = d->excluded;
+	have_xattr_bk = d->have_xattr;
+	longest = d->longest;
+	longest_fc = d->longest_fc;
+	cur_layout_pad = restored_layout_pad = d->layout_pad;
+	cur_layout_cols = restored_layout_cols = d->layout_cols;
+	*d = (struct dircache_t){0};
+
+	/* The cached copy only matched because it was built (and sorted)
+	 * under the current listing parameters. */
+	dirlist_gen++;
+	record_sort();
 
-/* Struct to store information about trimmed file names. Used only when
- * Unicode is disabled */
-struct trim_t {
-	int state;
-	int a; /* trimmed char */
-	int b; /* char next to trimmed char */
-	int pad;
-	size_t len; /* Lenght of file name before trimming */
-};
+	return FUNC_SUCCESS;
+}
 
-static struct trim_t trim;
+/* Drop the cache slot (if any) for the currently listed directory, and
+ * forget its identity, so that the next list_dir() performs a full scan.
+ * Used by reload_dirlist(): a reload request means our copy is stale. */
+static void
+dircache_invalidate_cur(void)
+{
+	if (dircache_cur.valid == 0)
+		return;
+
+	for (size_t i = 0; i < DIRCACHE_SLOTS; i++) {
+		if (dircache[i].used == 1 && dircache[i].dev == dircache_cur.dev
+		&& dircache[i].ino == dircache_cur.ino) {
+			dircache_free_slot(&dircache[i]);
+			break;
+		}
+	}
+
+	dircache_cur.valid = 0;
+}
+
+/* Drop every stashed directory list, keeping the current one. Used
+ * when interned data the stashed entries point to (e.g. extension
+ * colors, see free_extension_colors() in colors.c) is about to be
+ * freed. */
+void
+dircache_drop(void)
+{
+	for (size_t i = 0; i < DIRCACHE_SLOTS; i++)
+		dircache_free_slot(&dircache[i]);
+
+	dircache_cur.valid = 0;
+}
+
+/* Free all cached directory listings. Called at exit. */
+void
+free_dircache(void)
+{
+	for (size_t i = 0; i < DIRCACHE_SLOTS; i++)
+		dircache_free_slot(&dircache[i]);
+
+	dircache_cur.valid = 0;
+
+	fiarena_destroy(fi_arena_spare);
+	fi_arena_spare = (struct fiarena_t *)NULL;
+	fiarena_destroy(fi_arena);
+	fi_arena = (struct fiarena_t *)NULL;
+
+	for (size_t i = 0; i < LNK_CACHE_SIZE; i++) {
+		free(lnk_cache[i].target);
+		lnk_cache[i] = (struct lnk_cache_t){0};
+	}
+}
 
 /* Struct to store information about file names to be trimmed (Unicode) */
 struct wtrim_t {
@@ -187,6 +1743,16 @@ init_checks_struct(void)
 #endif /* !_NO_ICONS */
 
 	checks.id_names = (conf.long_view == 1 && prop_fields.ids == PROP_ID_NAME);
+
+	/* If the pager might kick in, icon resolution is deferred until the
+	 * entry is actually printed (see resolve_entry_icon()). */
+	checks.lazy_icons =
+#ifndef _NO_ICONS
+		(conf.icons == 1 && conf.pager != 0 && conf.light_mode == 0);
+#else
+		0;
+#endif /* !_NO_ICONS */
+
 	checks.lnk_char = (conf.color_lnk_as_target == 1 && follow_symlinks == 1
 		&& conf.icons == 0 && conf.light_mode == 0);
 	checks.min_name_trim = (conf.long_view == 1 && conf.max_name_len != UNSET
@@ -194,7 +1760,95 @@ init_checks_struct(void)
 	checks.xattr = (conf.long_view == 1 && prop_fields.xattr == 1);
 }
 
+/* Automatic per-directory degradation (BigDirThreshold): above the
+ * configured number of entries, the listing switches to light mode and
+ * drops the files counter and icons, restoring the user's settings as
+ * soon as the directory is left or, with hysteresis, once the entry
+ * count falls well below the threshold. */
+static int bigdir_active = 0;
+static int bigdir_bk_light_mode = 0;
+static int bigdir_bk_files_counter = 0;
+static int bigdir_bk_icons = 0;
+
+/* Apply the degraded listing profile on top of the current settings
+ * (including whatever the autocmds engine set for this directory). */
+static void
+bigdir_engage(void)
+{
+	bigdir_bk_light_mode = conf.light_mode;
+	bigdir_bk_files_counter = conf.files_counter;
+	bigdir_bk_icons = conf.icons;
+	conf.light_mode = 1;
+	conf.files_counter = 0;
+	conf.icons = 0;
+	bigdir_active = 1;
+}
+
+/* Restore the settings in place before bigdir_engage(). */
+static void
+bigdir_disengage(void)
+{
+	conf.light_mode = bigdir_bk_light_mode;
+	conf.files_counter = bigdir_bk_files_counter;
+	conf.icons = bigdir_bk_icons;
+	bigdir_active = 0;
+}
+
 #if !defined(_NO_ICONS)
+/* Hash indices over the static icon tables (icons.h), so that icon
+ * resolution probes a single bucket instead of scanning a whole hashes
+ * array per file listed. BUCKETS maps a bucket to the 1-based index of
+ * its first entry in the corresponding table (0 = empty), and NEXT
+ * chains entries sharing a bucket. */
+struct icon_index_t {
+	size_t *buckets;
+	size_t *next;
+	size_t size; /* Number of buckets (a power of two) */
+};
+
+static struct icon_index_t name_icons_index;
+static struct icon_index_t dir_icons_index;
+static struct icon_index_t ext_icons_index;
+
+static void
+build_icon_index(struct icon_index_t *idx, const size_t *hashes,
+	const size_t n)
+{
+	idx->size = 1;
+	while (idx->size < n * 2)
+		idx->size <<= 1;
+
+	idx->buckets = xcalloc(idx->size, sizeof(size_t));
+	idx->next = xcalloc(n, sizeof(size_t));
+
+	/* Entries are pushed to the head of their bucket chain: walking the
+	 * table forward leaves the last defined entry first, just as the
+	 * backwards linear scans used to find it first. */
+	size_t i;
+	for (i = 0; i < n; i++) {
+		const size_t b = hashes[i] & (idx->size - 1);
+		idx->next[i] = idx->buckets[b];
+		idx->buckets[b] = i + 1;
+	}
+}
+
+/* Return the index into the icon table indexed by IDX (with hashes
+ * HASHES) whose entry matches HASH, or -1 if none does. */
+static int
+icon_index_lookup(const struct icon_index_t *idx, const size_t *hashes,
+	const size_t hash)
+{
+	size_t i = idx->buckets[hash & (idx->size - 1)];
+
+	while (i != 0) {
+		if (hashes[i - 1] == hash)
+			return (int)(i - 1);
+		i = idx->next[i - 1];
+	}
+
+	return (-1);
+}
+
 static void
 set_icon_names_hashes(void)
 {
@@ -203,6 +1857,9 @@ set_icon_names_hashes(void)
 
 	while (--i >= 0)
 		name_icons_hashes[i] = hashme(icon_filenames[i].name, 0);
+
+	build_icon_index(&name_icons_index, name_icons_hashes,
+		sizeof(icon_filenames) / sizeof(struct icons_t));
 }
 
 static void
@@ -213,6 +1870,9 @@ set_dir_names_hashes(void)
 
 	while (--i >= 0)
 		dir_icons_hashes[i] = hashme(icon_dirnames[i].name, 0);
+
+	build_icon_index(&dir_icons_index, dir_icons_hashes,
+		sizeof(icon_dirnames) / sizeof(struct icons_t));
 }
 
 static void
@@ -223,6 +1883,9 @@ set_ext_names_hashes(void)
 
 	while (--i >= 0)
 		ext_icons_hashes[i] = hashme(icon_ext[i].name, 0);
+
+	build_icon_index(&ext_icons_index, ext_icons_hashes,
+		sizeof(icon_ext) / sizeof(struct icons_t));
 }
 
 void
@@ -232,6 +1895,21 @@ init_icons_hashes(void)
 	set_dir_names_hashes();
 	set_ext_names_hashes();
 }
+
+void
+free_icons_hashes(void)
+{
+	free(name_icons_hashes);
+	free(dir_icons_hashes);
+	free(ext_icons_hashes);
+	name_icons_hashes = dir_icons_hashes = ext_icons_hashes = (size_t *)NULL;
+
+	free(name_icons_index.buckets); free(name_icons_index.next);
+	free(dir_icons_index.buckets); free(dir_icons_index.next);
+	free(ext_icons_index.buckets); free(ext_icons_index.next);
+	name_icons_index = dir_icons_index = ext_icons_index =
+		(struct icon_index_t){0};
+}
 #endif /* !_NO_ICONS */
 
 #if defined(TOURBIN_QSORT)
@@ -258,24 +1936,38 @@ static uint8_t
 is_utf8_name(const char *restrict name, size_t *restrict bytes)
 {
 	uint8_t is_utf8 = 0;
-	const char *start = name;
-
-	while (*name) {
-#if !defined(CHAR_MIN) || CHAR_MIN >= 0 /* char is unsigned (PowerPC/ARM) */
-		if (*name >= 0xC0 || *name < ' ')
-#else /* char is signed (X86) */
-		/* If UTF-8 char, the first byte is >= 0xC0, whose decimal
-		 * value is 192, which is bigger than CHAR_MAX if char is signed,
-		 * becoming thus a negative value. In this way, the above two-steps
-		 * check can be written using a single comparison. */
-		if (*name < ' ')
-#endif /* CHAR_MIN >= 0 */
+	const char *s = name;
+
+	/* A control char (< 0x20) or a byte with the high bit set (the first
+	 * byte of a UTF-8 sequence is >= 0xc0, continuation bytes are >= 0x80)
+	 * makes the name non-ASCII. Names are mostly plain ASCII, so the bulk
+	 * of the scan runs one word (eight bytes) at a time via the SWAR
+	 * macros (strings.h). The byte loops handle the unaligned head (word
+	 * reads must not cross a page boundary) and the word holding the
+	 * terminating NUL. */
+	for (; ((uintptr_t)s % sizeof(uint64_t)) != 0 && *s; s++) {
+		if ((unsigned char)*s < 0x20 || (unsigned char)*s >= 0x80)
 			is_utf8 = 1;
+	}
 
-		name++;
+	if (*s != '\0') {
+		uint64_t w;
+		for (;;) {
+			memcpy(&w, s, sizeof(w)); /* A single aligned load */
+			if (SWAR_HASZERO(w))
+				break;
+			if (SWAR_HASLESS(w, 0x20) || SWAR_HASHIGH(w))
+				is_utf8 = 1;
+			s += sizeof(w);
+		}
+
+		for (; *s; s++) {
+			if ((unsigned char)*s < 0x20 || (unsigned char)*s >= 0x80)
+				is_utf8 = 1;
+		}
 	}
 
-	*bytes = (size_t)(name - start);
+	*bytes = (size_t)(s - name);
 	return is_utf8;
 }
 
@@ -374,8 +2066,11 @@ print_disk_usage(void)
 		return;
 
 	struct statvfs a;
-	if (statvfs(workspaces[cur_ws].path, &a) != FUNC_SUCCESS) {
-		err('w', PRINT_PROMPT, "statvfs: %s\n", strerror(errno));
+	/* Cached, background-refreshed: never blocks on a hung network mount
+	 * (except, briefly, for the first visit to a filesystem). */
+	if (xstatvfs(workspaces[cur_ws].path, &a) != FUNC_SUCCESS) {
+		if (errno != EAGAIN) /* EAGAIN: result not available yet */
+			err('w', PRINT_PROMPT, "statvfs: %s\n", strerror(errno));
 		return;
 	}
 
@@ -482,12 +2177,9 @@ get_name_icon(const filesn_t n)
 
 	const size_t nhash = hashme(file_info[n].name, 0);
 
-	/* This division will be replaced by a constant integer at compile
-	 * time, so that it won't even be executed at runtime. */
-	int i = (int)(sizeof(icon_filenames) / sizeof(struct icons_t));
-	while (--i >= 0) {
-		if (nhash != name_icons_hashes[i])
-			continue;
+	const int i = icon_index_lookup(&name_icons_index,
+		name_icons_hashes, nhash);
+	if (i != -1) {
 		file_info[n].icon = icon_filenames[i].icon;
 		file_info[n].icon_color = icon_filenames[i].color;
 		return 1;
@@ -510,13 +2202,11 @@ get_dir_icon(const filesn_t n)
 
 	const size_t dhash = hashme(file_info[n].name, 0);
 
-	int i = (int)(sizeof(icon_dirnames) / sizeof(struct icons_t));
-	while (--i >= 0) {
-		if (dhash != dir_icons_hashes[i])
-			continue;
+	const int i = icon_index_lookup(&dir_icons_index,
+		dir_icons_hashes, dhash);
+	if (i != -1) {
 		file_info[n].icon = icon_dirnames[i].icon;
 		file_info[n].icon_color = icon_dirnames[i].color;
-		break;
 	}
 }
 
@@ -537,16 +2227,51 @@ get_ext_icon(const char *restrict ext, const filesn_t n)
 
 	const size_t ehash = hashme(ext, 0);
 
-	int i = (int)(sizeof(icon_ext) / sizeof(struct icons_t));
-	while (--i >= 0) {
-		if (ehash != ext_icons_hashes[i])
-			continue;
-
+	const int i = icon_index_lookup(&ext_icons_index,
+		ext_icons_hashes, ehash);
+	if (i != -1) {
 		file_info[n].icon = icon_ext[i].icon;
 		file_info[n].icon_color = icon_ext[i].color;
-		break;
 	}
 }
+
+/* Resolve the icon for the entry file_info[N], whose resolution was
+ * deferred at list time (checks.lazy_icons): this way, entries never
+ * displayed because the user quitted the pager skip the icon tables
+ * lookups altogether.
+ * Only directories and regular files look up the icon tables: the
+ * remaining file types get their icons at list time (they're cheap). */
+void
+resolve_entry_icon(const filesn_t n)
+{
+	if (checks.lazy_icons == 0 || file_info[n].icon_set == 1)
+		return;
+
+	file_info[n].icon_set = 1;
+
+	if (file_info[n].dir == 1) {
+		/* Unaccessible directories already got ICON_LOCK. */
+		if (file_info[n].color == nd_c)
+			return;
+
+		get_dir_icon(n);
+
+		if (*dir_ico_c)	/* If set from the color scheme file */
+			file_info[n].icon_color = dir_ico_c;
+	} else if (file_info[n].type == DT_REG) {
+		/* Temp files (bk_c) take neither name nor extension icons. */
+		if (file_info[n].color == bk_c)
+			return;
+
+		if (get_name_icon(n) == 0 && file_info[n].ext_name)
+			get_ext_icon(file_info[n].ext_name, n);
+	} else {
+		return;
+	}
+
+	if (checks.icons_use_file_color == 1)
+		file_info[n].icon_color = file_info[n].color;
+}
 #endif /* _NO_ICONS */
 
 static void
@@ -641,15 +2366,92 @@ post_listing(DIR *dir, const int reset_pager, const filesn_t excluded_files)
 		print_reload_msg(_("Showing %jd/%jd files\n"),
 			(intmax_t)files, (intmax_t)(files + excluded_files));
 
+	ipc_update_listing();
+
 	return FUNC_SUCCESS;
 }
 
+/* Redraw previously printed pages from the captured row cache (see the
+ * obuf_capture functions in obuf.c): rows are copied from memory, not
+ * re-formatted. Entered from the pager prompt on Up arrow, Page Up, or
+ * 'b'; returns once the user pages forward back to the current (last)
+ * page, after redrawing it, so the caller can reissue the pager
+ * prompt. */
+static void
+pager_back_view(void)
+{
+	const size_t total = obuf_capture_lines();
+	const size_t page = term_lines > 2 ? (size_t)term_lines - 2 : 1;
+
+	if (total <= page)
+		return; /* Nothing before the current screen */
+
+	const size_t max_back = (total - 1) / page;
+	size_t back = 1;
+
+	for (;;) {
+		/* Page BACK (0 = the current page) ends at line END (clamped so
+		 * the oldest page is always full). */
+		size_t end = back * page < total ? total - back * page : page;
+		if (end < page)
+			end = page;
+
+		CLEAR;
+		size_t i;
+		for (i = end - page; i < end; i++)
+			printf("%s\n", obuf_capture_line(i));
+
+		if (back == 0)
+			return;
+
+		fputs(PAGER_LABEL, stdout);
+		fflush(stdout);
+
+		switch (xgetchar()) {
+		/* Arrow and page keys arrive as escape sequences one byte at a
+		 * time: the prefix bytes are ignored, and the keys are told
+		 * apart by their middle byte ('A'/'B' for arrows, '5'/'6' for
+		 * Page Up/Down, whose final '~' is ignored too). */
+		case 27: /* fallthrough */ /* ESC */
+		case 91: /* fallthrough */ /* '[' */
+		case 126: /* '~' */
+			break;
+
+		/* One page back */
+		case 65: /* fallthrough */ /* Up arrow */
+		case 53: /* fallthrough */ /* Page Up */
+		case 'b':
+			if (back < max_back)
+				back++;
+			break;
+
+		/* Leave the back view on the current page */
+		case 'q': /* fallthrough */
+		case 'Q': /* fallthrough */
+		case 'c': /* fallthrough */
+		case 'p':
+			back = 0;
+			break;
+
+		/* Any other key: one page forward */
+		default:
+			back--;
+			break;
+		}
+
+		putchar('\r');
+		ERASE_TO_RIGHT;
+	}
+}
+
 /* A basic pager for directories containing large amount of files.
- * What's missing? It only goes downwards. To go backwards, use the
- * terminal scrollback function */
+ * To go backwards, press Up arrow, Page Up, or 'b' at the prompt
+ * (previous pages are redrawn from the captured row cache). */
 static int
 run_pager(const int columns_n, int *reset_pager, filesn_t *i, size_t *counter)
 {
+	/* The current page must hit the screen before we prompt for a key */
+	obuf_flush();
 	fputs(PAGER_LABEL, stdout);
 
 	switch (xgetchar()) {
@@ -665,13 +2467,24 @@ run_pager(const int columns_n, int *reset_pager, filesn_t *i, size_t *counter)
 		*counter = 0;
 		break;
 
+	/* Go back one page, redrawing previous pages from the row cache.
+	 * Page Up is identified by its middle byte; the final '~' of its
+	 * sequence is consumed at the back view prompt. */
+	case 65: /* fallthrough */ /* Up arrow */
+	case 53: /* fallthrough */ /* Page Up */
+	case 'b':
+		pager_back_view();
+		putchar('\r');
+		ERASE_TO_RIGHT;
+		return (-1);
+
 	/* h: Print pager help */
 	case '?': /* fallthrough */
 	case 'h': {
 		CLEAR;
 
 		fputs(_(PAGER_HELP), stdout);
-		int l = (int)term_lines - 6;
+		int l = (int)term_lines - 7;
 		MOVE_CURSOR_DOWN(l);
 		fputs(PAGER_LABEL, stdout);
 
@@ -865,6 +2678,9 @@ get_longest_filename(const filesn_t n, const size_t pad)
 		if ((int)longest_fc < 0)
 			longest_fc = 0;
 	}
+
+	cur_layout_pad = (int)pad;
+	cur_layout_cols = (int)term_cols;
 }
 
 /* Set a few extra properties needed for long view mode */
@@ -894,8 +2710,13 @@ set_long_attribs(const filesn_t n, const struct stat *attr)
 
 	if (conf.full_dir_size == 1 && file_info[n].dir == 1
 	&& file_info[n].type == DT_DIR) {
-		file_info[n].size = dir_size(file_info[n].name, 1,
-			&file_info[n].du_status);
+		/* Served from the xdu cache if we already computed this
+		 * directory; queued for the worker pool otherwise (see
+		 * xdu_run_pending()). */
+		if (xdu_cache_get(attr->st_dev, attr->st_ino, attr->st_mtime,
+		&file_info[n].size, &file_info[n].du_status,
+		&file_info[n].du_approx) != FUNC_SUCCESS)
+			xdu_pending_add(n, attr);
 	} else {
 		file_info[n].size = FILE_SIZE_PTR(attr);
 	}
@@ -992,7 +2813,7 @@ compute_maxes(void)
 	 * we need to make room for the du error char (!). */
 	i = files;
 	while (--i >= 0) {
-		if (file_info[i].du_status == 0)
+		if (file_info[i].du_status == 0 && file_info[i].du_approx == 0)
 			continue;
 
 		const int t = prop_fields.size == PROP_SIZE_BYTES
@@ -1008,12 +2829,45 @@ compute_maxes(void)
 	return maxes;
 }
 
+/* Render ELN number N, space-padded to PAD columns, into a static
+ * buffer. The buffer always holds the previously rendered number, so
+ * the common case -- the next row of the same listing -- is a ripple
+ * increment of the trailing digits instead of a full printf(3)-style
+ * conversion per entry. Out-of-sequence requests (the vertical layout
+ * jumps by columns, the first row of a new listing) fall back to a
+ * full conversion. PAD never exceeds the digits of the listed files
+ * count, so the increment cannot overflow the padded field. */
+static const char *
+get_eln_str(const filesn_t n, const int pad)
+{
+	static char buf[32];
+	static filesn_t cur = 0;
+	static int cur_pad = 0;
+
+	if (n == cur + 1 && pad == cur_pad && cur > 0) {
+		char *p = buf + pad - 1;
+		while (p >= buf && *p == '9')
+			*p-- = '0';
+		if (p >= buf)
+			*p = (*p == ' ') ? '1' : (char)(*p + 1);
+	} else {
+		snprintf(buf, sizeof(buf), "%*jd", pad, (intmax_t)n);
+	}
+
+	cur = n;
+	cur_pad = pad;
+	return buf;
+}
+
 static void
 print_long_mode(size_t *counter, int *reset_pager, const int pad,
 	int have_xattr)
 {
 	struct maxes_t maxes = compute_maxes();
 
+	/* Colors and configuration may have changed since the last listing. */
+	reset_long_view_memo();
+
 	if (prop_fields.xattr == 0)
 		have_xattr = 0;
 
@@ -1033,7 +2887,10 @@ print_long_mode(size_t *counter, int *reset_pager, const int pad,
 		space_left = (int)longest;
 
 	maxes.name = space_left + (conf.icons == 1 ? 3 : 0);
+	dmg_valid = 0; /* Long view cells are not tracked */
 	pager_quit = pager_help = 0;
+	if (conf.pager == 1 || (conf.pager > 1 && files >= (filesn_t)conf.pager))
+		obuf_capture_start();
 
 	filesn_t i, k = files;
 	for (i = 0; i < k; i++) {
@@ -1063,16 +2920,22 @@ print_long_mode(size_t *counter, int *reset_pager, const int pad,
 		char *ind_chr_color = get_ind_char(i, &ind_chr);
 
 		if (conf.no_eln == 0) {
-			printf("%s%*jd%s%s%c%s", el_c, pad, (intmax_t)i + 1, df_c,
+			xprintf("%s%s%s%s%c%s", el_c, get_eln_str(i + 1, pad), df_c,
 				ind_chr_color, ind_chr, df_c);
 		} else {
-			printf("%s%c%s", ind_chr_color, ind_chr, df_c);
+			xprintf("%s%c%s", ind_chr_color, ind_chr, df_c);
 		}
 
 		/* Print the remaining part of the entry. */
+#ifndef _NO_ICONS
+		resolve_entry_icon(i);
+#endif /* !_NO_ICONS */
 		print_entry_props(&file_info[i], &maxes, have_xattr);
 	}
 
+	obuf_flush();
+	obuf_capture_stop();
+
 	if (pager_quit == 1)
 		printf("... (%zd/%zd)\n", i, files);
 }
@@ -1182,11 +3045,16 @@ construct_filename(const filesn_t i, struct wtrim_t *wtrim,
 
 		wtrim->diff = u8truncstr(name_buf, (size_t)trim_len);
 	} else {
-		/* If not UTF-8, let's avoid u8truncstr(). It's a bit faster this way. */
-		const char c = name[trim_len];
-		name[trim_len] = '\0';
-		mbstowcs((wchar_t *)name_buf, name, NAME_MAX + 1);
-		name[trim_len] = c;
+		/* Not UTF-8, i.e. printable ASCII: truncation falls on a byte
+		 * boundary and every char is one column wide. Widen the prefix
+		 * directly into the buffer (the printing functions expect a
+		 * wide string), skipping the locale machinery (mbstowcs(3))
+		 * entirely. */
+		wchar_t *ws = (wchar_t *)name_buf;
+		int j;
+		for (j = 0; j < trim_len; j++)
+			ws[j] = (wchar_t)(unsigned char)name[j];
+		ws[trim_len] = L'\0';
 	}
 
 	file_info[i].len = (size_t)max_namelen;
@@ -1204,6 +3072,12 @@ print_entry_color(int *ind_char, const filesn_t i, const int pad,
 	*ind_char = 0;
 	const char *end_color = file_info[i].dir == 1 ? fc_c : df_c;
 
+#ifndef _NO_ICONS
+	/* Before construct_filename(), which overwrites ext_name when
+	 * trimming file name extensions. */
+	resolve_entry_icon(i);
+#endif /* !_NO_ICONS */
+
 	struct wtrim_t wtrim = (struct wtrim_t){0};
 	const char *n = construct_filename(i, &wtrim, max_namelen);
 
@@ -1232,8 +3106,8 @@ print_entry_color(int *ind_char, const filesn_t i, const int pad,
 			}
 		} else {
 			if (wtrim.type > 0) {
-				xprintf("%s%*jd%s%s%c%s%s%s %s%ls%s\x1b[0m%s%c\x1b[0m%s%s%s",
-					el_c, pad, (intmax_t)i + 1, df_c, ind_chr_color, ind_chr,
+				xprintf("%s%s%s%s%c%s%s%s %s%ls%s\x1b[0m%s%c\x1b[0m%s%s%s",
+					el_c, get_eln_str(i + 1, pad), df_c, ind_chr_color, ind_chr,
 					df_c, file_info[i].icon_color, file_info[i].icon,
 					file_info[i].color, (wchar_t *)n, trim_diff,
 					tt_c, TRIMFILE_CHR,
@@ -1241,7 +3115,7 @@ print_entry_color(int *ind_char, const filesn_t i, const int pad,
 					wtrim.type == TRIM_EXT ? file_info[i].ext_name : "",
 					end_color);
 			} else {
-				xprintf("%s%*jd%s%s%c%s%s%s %s%s%s", el_c, pad, (intmax_t)i + 1,
+				xprintf("%s%s%s%s%c%s%s%s %s%s%s", el_c, get_eln_str(i + 1, pad),
 					df_c, ind_chr_color, ind_chr, df_c,
 					file_info[i].icon_color, file_info[i].icon,
 					file_info[i].color, n, end_color);
@@ -1266,8 +3140,8 @@ print_entry_color(int *ind_char, const filesn_t i, const int pad,
 			}
 		} else {
 			if (wtrim.type > 0) {
-				xprintf("%s%*jd%s%s%c%s%s%ls%s\x1b[0m%s%c\x1b[0m%s%s%s",
-					el_c, pad, (intmax_t)i + 1, df_c, ind_chr_color,
+				xprintf("%s%s%s%s%c%s%s%ls%s\x1b[0m%s%c\x1b[0m%s%s%s",
+					el_c, get_eln_str(i + 1, pad), df_c, ind_chr_color,
 					ind_chr,
 					df_c, file_info[i].color, (wchar_t *)n,
 					trim_diff, tt_c, TRIMFILE_CHR,
@@ -1275,7 +3149,7 @@ print_entry_color(int *ind_char, const filesn_t i, const int pad,
 					wtrim.type == TRIM_EXT ? file_info[i].ext_name : "",
 					end_color);
 			} else {
-				xprintf("%s%*jd%s%s%c%s%s%s%s", el_c, pad, (intmax_t)i + 1,
+				xprintf("%s%s%s%s%c%s%s%s%s", el_c, get_eln_str(i + 1, pad),
 					df_c, ind_chr_color, ind_chr, df_c,
 					file_info[i].color, n, end_color);
 			}
@@ -1288,16 +3162,16 @@ print_entry_color(int *ind_char, const filesn_t i, const int pad,
 		case DT_DIR: /* fallthrough */
 		case DT_LNK:
 			if (file_info[i].dir == 1)
-				putchar(DIR_CHR);
+				obuf_putc(DIR_CHR);
 			if (file_info[i].filesn > 0 && conf.files_counter == 1)
-				fputs(xitoa(file_info[i].filesn), stdout);
+				obuf_puts(xitoa(file_info[i].filesn));
 			break;
 		default: break;
 		}
 	}
 
 	if (end_color == fc_c)
-		fputs(df_c, stdout);
+		obuf_puts(df_c);
 
 	free(wtrim.wname);
 }
@@ -1306,6 +3180,12 @@ static void
 print_entry_nocolor(int *ind_char, const filesn_t i, const int pad,
 	const int max_namelen)
 {
+#ifndef _NO_ICONS
+	/* Before construct_filename(), which overwrites ext_name when
+	 * trimming file name extensions. */
+	resolve_entry_icon(i);
+#endif /* !_NO_ICONS */
+
 	struct wtrim_t wtrim = (struct wtrim_t){0};
 	const char *n = construct_filename(i, &wtrim, max_namelen);
 
@@ -1324,12 +3204,12 @@ print_entry_nocolor(int *ind_char, const filesn_t i, const int pad,
 			}
 		} else {
 			if (wtrim.type > 0) {
-				xprintf("%s%*jd%s%c%s %ls%s%c%s", el_c, pad, (intmax_t)i + 1,
+				xprintf("%s%s%s%c%s %ls%s%c%s", el_c, get_eln_str(i + 1, pad),
 					df_c, file_info[i].sel ? SELFILE_CHR : ' ',
 					file_info[i].icon, (wchar_t *)n, trim_diff, TRIMFILE_CHR,
 					wtrim.type == TRIM_EXT ? file_info[i].ext_name : "");
 			} else {
-				xprintf("%s%*jd%s%c%s %s", el_c, pad, (intmax_t)i + 1, df_c,
+				xprintf("%s%s%s%c%s %s", el_c, get_eln_str(i + 1, pad), df_c,
 					file_info[i].sel ? SELFILE_CHR : ' ', file_info[i].icon, n);
 			}
 		}
@@ -1346,12 +3226,12 @@ print_entry_nocolor(int *ind_char, const filesn_t i, const int pad,
 			}
 		} else {
 			if (wtrim.type > 0) {
-				xprintf("%s%*jd%s%c%ls%s%c%s", el_c, pad, (intmax_t)i + 1, df_c,
+				xprintf("%s%s%s%c%ls%s%c%s", el_c, get_eln_str(i + 1, pad), df_c,
 					file_info[i].sel ? SELFILE_CHR : ' ', (wchar_t *)n,
 					trim_diff, TRIMFILE_CHR, wtrim.type == TRIM_EXT
 					? file_info[i].ext_name : "");
 			} else {
-				xprintf("%s%*jd%s%c%s", el_c, pad, (intmax_t)i + 1, df_c,
+				xprintf("%s%s%s%c%s", el_c, get_eln_str(i + 1, pad), df_c,
 					file_info[i].sel ? SELFILE_CHR : ' ', n);
 			}
 		}
@@ -1362,43 +3242,43 @@ print_entry_nocolor(int *ind_char, const filesn_t i, const int pad,
 		switch (file_info[i].type) {
 		case DT_DIR:
 			*ind_char = 0;
-			putchar(DIR_CHR);
+			obuf_putc(DIR_CHR);
 			if (file_info[i].filesn > 0 && conf.files_counter == 1)
-				fputs(xitoa(file_info[i].filesn), stdout);
+				obuf_puts(xitoa(file_info[i].filesn));
 			break;
 
 		case DT_LNK:
 			if (file_info[i].color == or_c) {
-				putchar(BRK_LNK_CHR);
+				obuf_putc(BRK_LNK_CHR);
 			} else if (file_info[i].dir) {
 				*ind_char = 0;
-				putchar(DIR_CHR);
+				obuf_putc(DIR_CHR);
 				if (file_info[i].filesn > 0 && conf.files_counter == 1)
-					fputs(xitoa(file_info[i].filesn), stdout);
+					obuf_puts(xitoa(file_info[i].filesn));
 			} else {
-				putchar(LINK_CHR);
+				obuf_putc(LINK_CHR);
 			}
 			break;
 
 		case DT_REG:
 			if (file_info[i].exec == 1)
-				putchar(EXEC_CHR);
+				obuf_putc(EXEC_CHR);
 			else
 				*ind_char = 0;
 			break;
 
-		case DT_BLK: putchar(BLK_CHR); break;
-		case DT_CHR: putchar(CHR_CHR); break;
+		case DT_BLK: obuf_putc(BLK_CHR); break;
+		case DT_CHR: obuf_putc(CHR_CHR); break;
 #ifdef SOLARIS_DOORS
-		case DT_DOOR: putchar(DOOR_CHR); break;
+		case DT_DOOR: obuf_putc(DOOR_CHR); break;
 //		case DT_PORT: break;
 #endif /* SOLARIS_DOORS */
-		case DT_FIFO: putchar(FIFO_CHR); break;
-		case DT_SOCK: putchar(SOCK_CHR); break;
+		case DT_FIFO: obuf_putc(FIFO_CHR); break;
+		case DT_SOCK: obuf_putc(SOCK_CHR); break;
 #ifdef S_IFWHT
-		case DT_WHT: putchar(WHT_CHR); break;
+		case DT_WHT: obuf_putc(WHT_CHR); break;
 #endif /* S_IFWHT */
-		case DT_UNKNOWN: putchar(UNK_CHR); break;
+		case DT_UNKNOWN: obuf_putc(UNK_CHR); break;
 		default: *ind_char = 0;
 		}
 	}
@@ -1438,15 +3318,15 @@ print_entry_color_light(int *ind_char, const filesn_t i,
 			}
 		} else {
 			if (wtrim.type > 0) {
-				xprintf("%s%*jd%s %s%s %s%ls%s\x1b[0m%s%c\x1b[0m%s%s%s",
-					el_c, pad, (intmax_t)i + 1, df_c, file_info[i].icon_color,
+				xprintf("%s%s%s %s%s %s%ls%s\x1b[0m%s%c\x1b[0m%s%s%s",
+					el_c, get_eln_str(i + 1, pad), df_c, file_info[i].icon_color,
 					file_info[i].icon, file_info[i].color, (wchar_t *)n,
 					trim_diff, tt_c, TRIMFILE_CHR,
 					wtrim.type == TRIM_EXT ? file_info[i].color : "",
 					wtrim.type == TRIM_EXT ? file_info[i].ext_name : "",
 					end_color);
 			} else {
-				xprintf("%s%*jd%s %s%s %s%s%s", el_c, pad, (intmax_t)i + 1,
+				xprintf("%s%s%s %s%s %s%s%s", el_c, get_eln_str(i + 1, pad),
 					df_c, file_info[i].icon_color, file_info[i].icon,
 					file_info[i].color, n, end_color);
 			}
@@ -1467,27 +3347,27 @@ print_entry_color_light(int *ind_char, const filesn_t i,
 			}
 		} else {
 			if (wtrim.type > 0) {
-				xprintf("%s%*jd%s %s%ls%s\x1b[0m%s%c\x1b[0m%s%s%s",
-					el_c, pad, (intmax_t)i + 1, df_c, file_info[i].color,
+				xprintf("%s%s%s %s%ls%s\x1b[0m%s%c\x1b[0m%s%s%s",
+					el_c, get_eln_str(i + 1, pad), df_c, file_info[i].color,
 					(wchar_t *)n, trim_diff, tt_c, TRIMFILE_CHR,
 					wtrim.type == TRIM_EXT ? file_info[i].color : "",
 					wtrim.type == TRIM_EXT ? file_info[i].ext_name : "",
 					end_color);
 			} else {
-				xprintf("%s%*jd%s %s%s%s", el_c, pad, (intmax_t)i + 1, df_c,
+				xprintf("%s%s%s %s%s%s", el_c, get_eln_str(i + 1, pad), df_c,
 					file_info[i].color, n, end_color);
 			}
 		}
 	}
 
 	if (file_info[i].dir == 1 && conf.classify == 1) {
-		putchar(DIR_CHR);
+		obuf_putc(DIR_CHR);
 		if (file_info[i].filesn > 0 && conf.files_counter == 1)
-			fputs(xitoa(file_info[i].filesn), stdout);
+			obuf_puts(xitoa(file_info[i].filesn));
 	}
 
 	if (end_color == fc_c)
-		fputs(df_c, stdout);
+		obuf_puts(df_c);
 
 	free(wtrim.wname);
 }
@@ -1513,12 +3393,12 @@ print_entry_nocolor_light(int *ind_char, const filesn_t i,
 			}
 		} else {
 			if (wtrim.type > 0) {
-				xprintf("%s%*jd%s %s %ls%s%c%s", el_c, pad, (intmax_t)i + 1,
+				xprintf("%s%s%s %s %ls%s%c%s", el_c, get_eln_str(i + 1, pad),
 					df_c, file_info[i].icon, (wchar_t *)n, trim_diff,
 					TRIMFILE_CHR, wtrim.type == TRIM_EXT
 					? file_info[i].ext_name : "");
 			} else {
-				xprintf("%s%*jd%s %s %s", el_c, pad, (intmax_t)i + 1, df_c,
+				xprintf("%s%s%s %s %s", el_c, get_eln_str(i + 1, pad), df_c,
 					file_info[i].icon, n);
 			}
 		}
@@ -1530,15 +3410,15 @@ print_entry_nocolor_light(int *ind_char, const filesn_t i,
 				xprintf("%ls%s%c%s", (wchar_t *)n, trim_diff, TRIMFILE_CHR,
 					wtrim.type == TRIM_EXT ? file_info[i].ext_name : "");
 			} else {
-				fputs(file_info[i].name, stdout);
+				obuf_puts(file_info[i].name);
 			}
 		} else {
 			if (wtrim.type > 0) {
-				xprintf("%s%*jd%s %ls%s%c%s", el_c, pad, (intmax_t)i + 1, df_c,
+				xprintf("%s%s%s %ls%s%c%s", el_c, get_eln_str(i + 1, pad), df_c,
 					(wchar_t *)n, trim_diff, TRIMFILE_CHR,
 					wtrim.type == TRIM_EXT ? file_info[i].ext_name : "");
 			} else {
-				xprintf("%s%*jd%s %s", el_c, pad, (intmax_t)i + 1, df_c, n);
+				xprintf("%s%s%s %s", el_c, get_eln_str(i + 1, pad), df_c, n);
 			}
 		}
 	}
@@ -1547,24 +3427,24 @@ print_entry_nocolor_light(int *ind_char, const filesn_t i,
 		switch (file_info[i].type) {
 		case DT_DIR:
 			*ind_char = 0;
-			putchar(DIR_CHR);
+			obuf_putc(DIR_CHR);
 			if (file_info[i].filesn > 0 && conf.files_counter == 1)
-				fputs(xitoa(file_info[i].filesn), stdout);
+				obuf_puts(xitoa(file_info[i].filesn));
 			break;
 
-		case DT_BLK: putchar(BLK_CHR); break;
-		case DT_CHR: putchar(CHR_CHR); break;
+		case DT_BLK: obuf_putc(BLK_CHR); break;
+		case DT_CHR: obuf_putc(CHR_CHR); break;
 #ifdef SOLARIS_DOORS
-		case DT_DOOR: putchar(DOOR_CHR); break;
+		case DT_DOOR: obuf_putc(DOOR_CHR); break;
 //		case DT_DOOR: break;
 #endif /* SOLARIS_DOORS */
-		case DT_FIFO: putchar(FIFO_CHR); break;
-		case DT_LNK: putchar(LINK_CHR); break;
-		case DT_SOCK: putchar(SOCK_CHR); break;
+		case DT_FIFO: obuf_putc(FIFO_CHR); break;
+		case DT_LNK: obuf_putc(LINK_CHR); break;
+		case DT_SOCK: obuf_putc(SOCK_CHR); break;
 #ifdef S_IFWHT
-		case DT_WHT: putchar(WHT_CHR); break;
+		case DT_WHT: obuf_putc(WHT_CHR); break;
 #endif /* S_IFWHT */
-		case DT_UNKNOWN: putchar(UNKNOWN_CHR); break;
+		case DT_UNKNOWN: obuf_putc(UNKNOWN_CHR); break;
 		default: *ind_char = 0; break;
 		}
 	}
@@ -1597,9 +3477,9 @@ pad_filename(const int ind_char, const filesn_t i, const int pad,
 	if (termcap_move_right == 0) {
 		int j = diff + 1;
 		while (--j >= 0)
-			putchar(' ');
+			obuf_putc(' ');
 	} else {
-		MOVE_CURSOR_RIGHT(diff + 1);
+		obuf_printf("\x1b[%dC", diff + 1); /* MOVE_CURSOR_RIGHT */
 	}
 }
 
@@ -1629,9 +3509,9 @@ pad_filename_light(const int ind_char, const filesn_t i, const int pad,
 	if (termcap_move_right == 0) {
 		int j = diff + 1;
 		while(--j >= 0)
-			putchar(' ');
+			obuf_putc(' ');
 	} else {
-		MOVE_CURSOR_RIGHT(diff + 1);
+		obuf_printf("\x1b[%dC", diff + 1); /* MOVE_CURSOR_RIGHT */
 	}
 }
 
@@ -1666,7 +3546,10 @@ list_files_horizontal(size_t *counter, int *reset_pager,
 	int last_column = 0;
 	int blc = last_column;
 
+	dmg_track_start(pad);
 	pager_quit = pager_help = 0;
+	if (conf.pager == 1 || (conf.pager > 1 && files >= (filesn_t)conf.pager))
+		obuf_capture_start();
 
 	for (i = 0; i < nn; i++) {
 		/* If current entry is in the last column, we need to print a new line char */
@@ -1721,15 +3604,24 @@ list_files_horizontal(size_t *counter, int *reset_pager,
 
 		print_entry_function(&ind_char, i, pad, max_namelen);
 
+		if (dmg_track == 1)
+			dmg_record(i, (int)(i / (filesn_t)columns_n),
+				(int)(i % (filesn_t)columns_n));
+
 		if (last_column == 0)
 			pad_filename_function(ind_char, i, pad, termcap_move_right);
 		else
-			putchar('\n');
+			obuf_putc('\n');
 	}
 
 END:
 	if (last_column == 0)
-		putchar('\n');
+		obuf_putc('\n');
+
+	obuf_flush();
+	obuf_capture_stop();
+	dmg_track_stop();
+
 	if (pager_quit == 1)
 		printf("... (%zd/%zd)\n", i, files);
 }
@@ -1779,7 +3671,10 @@ list_files_vertical(size_t *counter, int *reset_pager,
 	filesn_t xx = 0; // Current line number
 	filesn_t i = 0; // Index of the current entry being analyzed
 
+	dmg_track_start(pad);
 	pager_quit = pager_help = 0;
+	if (conf.pager == 1 || (conf.pager > 1 && files >= (filesn_t)conf.pager))
+		obuf_capture_start();
 
 	for ( ; ; i++) {
 		/* Copy current values to restore them if necessary: done to
@@ -1815,7 +3710,7 @@ list_files_vertical(size_t *counter, int *reset_pager,
 				 * 1 file  3 file3  5 file5
 				 * 2 file2 4 file4  HERE
 				 * ... */
-				putchar('\n');
+				obuf_putc('\n');
 			continue;
 		}
 
@@ -1870,6 +3765,9 @@ list_files_vertical(size_t *counter, int *reset_pager,
 
 		print_entry_function(&ind_char, x, pad, max_namelen);
 
+		if (dmg_track == 1)
+			dmg_record(x, (int)(xx - 1), (int)(cc - 1));
+
 		if (last_column == 0)
 			pad_filename_function(ind_char, x, pad, termcap_move_right);
 		else
@@ -1877,16 +3775,116 @@ list_files_vertical(size_t *counter, int *reset_pager,
 			 * 1 file  3 file3  5 file5HERE
 			 * 2 file2 4 file4  6 file6HERE
 			 * ... */
-			putchar('\n');
+			obuf_putc('\n');
 	}
 
 END:
 	if (last_column == 0)
-		putchar('\n');
+		obuf_putc('\n');
+
+	obuf_flush();
+	obuf_capture_stop();
+	dmg_track_stop();
+
 	if (pager_quit == 1)
 		printf("... (%zd/%zd)\n", i, files);
 }
 
+/* Return 1 if the file at index I (in the directory DIR, whose length
+ * is DIR_LEN) is currently selected, or 0 otherwise. Unlike the .sel
+ * field, which reflects the state at listing time, this checks the
+ * current selection list. */
+static int
+dmg_entry_selected(const filesn_t i, const char *dir, const size_t dir_len)
+{
+	size_t j;
+	for (j = 0; j < sel_n; j++) {
+		const char *s = sel_elements[j].name;
+		if (!s || strncmp(s, dir, dir_len) != 0 || s[dir_len] != '/')
+			continue;
+		if (strcmp(s + dir_len + 1, file_info[i].name) == 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+/* Differential redraw after a selection change.
+ *
+ * Re-emit, in place, only the cells of entries whose selection mark
+ * changed, instead of rebuilding and reprinting the entire list (a
+ * full reprint after each 'sel' is painfully slow over high-latency
+ * connections). Toggling the mark never changes a cell's width, so a
+ * cell can be overwritten without disturbing its neighbors.
+ *
+ * Returns FUNC_SUCCESS if the screen was patched, or FUNC_FAILURE if
+ * the cell map cannot be trusted (long view, pager, scrolled screen),
+ * in which case the caller should fall back to reload_dirlist(). */
+int
+dirlist_patch_selection(void)
+{
+	if (dmg_valid == 0 || dmg_cells_n == 0 || files <= 0
+	|| !workspaces[cur_ws].path)
+		return FUNC_FAILURE;
+
+	/* Recomputing flags costs SEL_N comparisons per visible entry:
+	 * past some point the full reprint is cheaper. */
+	if (sel_n > 512)
+		return FUNC_FAILURE;
+
+	/* If the screen scrolled since the listing was printed, the
+	 * recorded rows no longer match screen rows. Scrolling only
+	 * happens when writing on the last line, and leaves the cursor
+	 * pinned there, so a cursor position report detects it. */
+	int ccol = 0, crow = 0;
+	if (get_cursor_position(&ccol, &crow) != FUNC_SUCCESS
+	|| crow >= term_lines)
+		return FUNC_FAILURE;
+
+	const char *dir = workspaces[cur_ws].path;
+	size_t dir_len = strlen(dir);
+	if (dir_len == 1 && *dir == '/')
+		dir_len = 0;
+
+	void (*print_entry_function)(int *, const filesn_t, const int, const int);
+	if (conf.colorize == 1)
+		print_entry_function = conf.light_mode == 1
+			? print_entry_color_light : print_entry_color;
+	else
+		print_entry_function = conf.light_mode == 1
+			? print_entry_nocolor_light : print_entry_nocolor;
+
+	const int int_longest_fc = (int)longest_fc;
+	filesn_t c;
+
+	for (c = 0; c < dmg_cells_n; c++) {
+		const filesn_t i = dmg_cells[c].entry;
+		if (i >= files || !file_info[i].name)
+			return FUNC_FAILURE; /* Stale map */
+
+		const int new_sel = dmg_entry_selected(i, dir, dir_len);
+		if (new_sel == file_info[i].sel)
+			continue;
+
+		file_info[i].sel = new_sel;
+
+		/* Move to the entry's cell and re-emit it */
+		xprintf("\x1b[%d;%dH", dmg_cells[c].row + 1,
+			dmg_cells[c].col * ((int)longest + 1) + 1);
+
+		int ind_char = (conf.classify != 0);
+		const int fc = file_info[i].dir != 1 ? int_longest_fc : 0;
+		print_entry_function(&ind_char, i, dmg_pad,
+			conf.max_name_len + fc);
+	}
+
+	/* Put the cursor back and flush the whole patch in one pass */
+	xprintf("\x1b[%d;%dH", crow, ccol);
+	obuf_flush();
+
+	return FUNC_SUCCESS;
+}
+
 /* Execute commands in either AUTOCMD_DIR_IN_FILE or AUTOCMD_DIR_OUT_FILE files.
  * MODE (either AUTOCMD_DIR_IN or AUTOCMD_DIR_OUT) tells the function
  * whether to check for AUTOCMD_DIR_IN_FILE or AUTOCMD_DIR_OUT_FILE files.
@@ -2011,6 +4009,33 @@ exclude_file_type_light(const unsigned char type)
 		return filter.rev == 1 ? FUNC_FAILURE : FUNC_SUCCESS;
 }
 
+/* Return 1 if the file name NAME matches the current name filter, and 0
+ * otherwise. Plain substring filters are matched directly (see
+ * set_filter_literal() in misc.c); everything else goes through the
+ * regex compiled when the filter was set. */
+static int
+filter_name_match(const char *name)
+{
+	if (!filter.literal)
+		return (regexec(&regex_exp, name, 0, NULL, 0) == 0);
+
+	if (filter.anchor_start == 1) {
+		if (strncmp(name, filter.literal, filter.literal_len) != 0)
+			return 0;
+		return (filter.anchor_end == 0
+			|| name[filter.literal_len] == '\0');
+	}
+
+	if (filter.anchor_end == 1) {
+		const size_t nlen = strlen(name);
+		return (nlen >= filter.literal_len
+			&& memcmp(name + nlen - filter.literal_len,
+			filter.literal, filter.literal_len) == 0);
+	}
+
+	return (strstr(name, filter.literal) != NULL);
+}
+
 /* Returns FUNC_SUCCESS if the file with mode MODE and LINKS number
  * of links must be excluded from the files list, or FUNC_FAILURE. */
 static int
@@ -2076,27 +4101,46 @@ init_fileinfo(const filesn_t n)
 	file_info[n].size =  1;
 }
 
+/* The sys_users/sys_groups arrays (init.c) are unsorted: resolving an id
+ * means a linear walk, repeated for every single file. A small
+ * direct-mapped cache in front of the walk makes the repeated lookups
+ * (most files in a directory belong to just a few owners) cost a single
+ * comparison. Entries point into the arrays, which live until exit. */
+#define ID_CACHE_SIZE 64 /* Must be a power of two */
+static struct groups_t *uid_cache[ID_CACHE_SIZE];
+static struct groups_t *gid_cache[ID_CACHE_SIZE];
+
+static struct groups_t *
+id_lookup(struct groups_t *list, struct groups_t **cache, const gid_t id)
+{
+	struct groups_t **slot = &cache[(size_t)id & (ID_CACHE_SIZE - 1)];
+	if (*slot && (*slot)->id == id)
+		return *slot;
+
+	size_t i;
+	for (i = 0; list[i].name; i++) {
+		if (list[i].id == id)
+			return (*slot = &list[i]);
+	}
+
+	return (struct groups_t *)NULL;
+}
+
 static inline void
 get_id_names(const filesn_t n)
 {
-	size_t i;
+	struct groups_t *e;
 
-	if (sys_users) {
-		for (i = 0; sys_users[i].name; i++) {
-			if (file_info[n].uid != sys_users[i].id)
-				continue;
-			file_info[n].uid_i.name = sys_users[i].name;
-			file_info[n].uid_i.namlen = sys_users[i].namlen;
-		}
+	if (sys_users
+	&& (e = id_lookup(sys_users, uid_cache, file_info[n].uid)) != NULL) {
+		file_info[n].uid_i.name = e->name;
+		file_info[n].uid_i.namlen = e->namlen;
 	}
 
-	if (sys_groups) {
-		for (i = 0; sys_groups[i].name; i++) {
-			if (file_info[n].gid != sys_groups[i].id)
-				continue;
-			file_info[n].gid_i.name = sys_groups[i].name;
-			file_info[n].gid_i.namlen = sys_groups[i].namlen;
-		}
+	if (sys_groups
+	&& (e = id_lookup(sys_groups, gid_cache, file_info[n].gid)) != NULL) {
+		file_info[n].gid_i.name = e->name;
+		file_info[n].gid_i.namlen = e->namlen;
 	}
 }
 
@@ -2107,47 +4151,24 @@ get_id_names(const filesn_t n)
 static void
 construct_human_sizes(void)
 {
-	const off_t ibase = xargs.si == 1 ? 1000 : 1024;
-	const float base = (float)ibase;
-	/* R: Ronnabyte, Q: Quettabyte. It's highly unlikely to have files of
-	 * such huge sizes (and even less) in the near future, but anyway... */
-	static const char *const u = "BKMGTPEZYRQ";
-	static float mult_factor = 0;
-	if (mult_factor == 0)
-		mult_factor = 1.0f / base;
-
 	filesn_t i = files;
 	while (--i >= 0) {
-		if (file_info[i].size < ibase) {
-			const int ret = snprintf(file_info[i].human_size.str,
-				MAX_HUMAN_SIZE, "%jd", (intmax_t)file_info[i].size);
-			file_info[i].human_size.len = ret > 0 ? (size_t)ret : 0;
-			file_info[i].human_size.unit = 'B';
-			continue;
-		}
-
-		size_t n = 0;
-		float s = (float)file_info[i].size;
-
-		while (s >= base) {
-			s = s * mult_factor; /* == (s = s / base), but faster */
-			++n;
-		}
-
-		const int x = (int)s;
-		/* If (s == 0 || s - (float)x == 0), then S has no reminder (zero).
-		 * We don't want to print the reminder when it is zero. */
-		const int ret =
-			snprintf(file_info[i].human_size.str, MAX_HUMAN_SIZE, "%.*f",
-				(s == 0.00f || s - (float)x == 0.00f) ? 0 : 2,
-				(double)s);
-
-		/* + 1 to take the size prefix (B, K, M, etc) into account */
-		file_info[i].human_size.len = ret > 0 ? (size_t)ret : 0;
+		char unit;
+		file_info[i].human_size.len = format_human_size(
+			file_info[i].human_size.str, MAX_HUMAN_SIZE,
+			file_info[i].size, &unit);
 		/* Let's follow du(1) in using 'k' (lowercase) instead of 'K'
 		 * (uppercase) when using powers of 1000 (--si). */
-		file_info[i].human_size.unit = (xargs.si == 1 && u[n] == 'K')
-			? 'k' : u[n];
+		file_info[i].human_size.unit = (xargs.si == 1 && unit == 'K')
+			? 'k' : unit;
+
+		if (file_info[i].du_approx == 1) {
+			/* Mark sampling estimates: "~4.2G" */
+			char *hs = file_info[i].human_size.str;
+			memmove(hs + 1, hs, file_info[i].human_size.len + 1);
+			*hs = '~';
+			file_info[i].human_size.len++;
+		}
 	}
 }
 
@@ -2167,7 +4188,10 @@ list_dir_light(void)
 		? load_dothidden() : NULL;
 
 	DIR *dir;
-	struct dirent *ent;
+	struct dirscan_t dscan;
+	unsigned char edtype = DT_UNKNOWN;
+	ino_t edino = 0;
+	const char *ename;
 	int reset_pager = 0;
 	filesn_t excluded_files = 0;
 	int close_dir = 1;
@@ -2193,13 +4217,16 @@ list_dir_light(void)
 
 	errno = 0;
 	longest = 0;
+	cur_layout_pad = cur_layout_cols = -1;
 	filesn_t n = 0, count = 0;
 	size_t total_dents = 0;
 
 	file_info = xnmalloc(ENTRY_N + 2, sizeof(struct fileinfo));
 
-	while ((ent = readdir(dir))) {
-		const char *ename = ent->d_name;
+	dirscan_init(&dscan, dir);
+
+	perf_begin(PERF_LIST_SCAN);
+	while ((ename = dirscan_next(&dscan, &edtype, &edino))) {
 		/* Skip self and parent directories */
 		if (SELFORPARENT(ename))
 			continue;
@@ -2210,7 +4237,7 @@ list_dir_light(void)
 
 		/* Skip files according to a regex filter */
 		if (checks.filter_name == 1) {
-			if (regexec(&regex_exp, ename, 0, NULL, 0) == FUNC_SUCCESS) {
+			if (filter_name_match(ename) == 1) {
 				if (filter.rev == 1) {
 					excluded_files++;
 					continue;
@@ -2235,28 +4262,24 @@ list_dir_light(void)
 			continue;
 		}
 
-#ifndef _DIRENT_HAVE_D_TYPE
-		struct stat attr;
-		if (lstat(ename, &attr) == -1)
-			continue;
-		if (conf.only_dirs == 1 && !S_ISDIR(attr.st_mode))
-#else
-		if (conf.only_dirs == 1 && ent->d_type != DT_DIR)
-#endif /* !_DIRENT_HAVE_D_TYPE */
-		{
+		/* If the file system does not provide d_type, resolve it via
+		 * lstat(2). Otherwise d_type alone answers the type checks
+		 * below, and no stat call is needed at all. */
+		if (edtype == DT_UNKNOWN) {
+			struct stat attr;
+			if (lstat(ename, &attr) == -1)
+				continue;
+			edtype = (unsigned char)get_dt(attr.st_mode);
+		}
+
+		if (conf.only_dirs == 1 && edtype != DT_DIR) {
 			excluded_files++;
 			continue;
 		}
 
 		/* Filter files according to file type */
 		if (checks.filter_type == 1
-#ifndef _DIRENT_HAVE_D_TYPE
-		&& exclude_file_type_light((unsigned char)get_dt(attr.st_mode))
-		== FUNC_SUCCESS)
-#else
-		&& exclude_file_type_light(ent->d_type) == FUNC_SUCCESS)
-#endif /* !_DIRENT_HAVE_D_TYPE */
-		{
+		&& exclude_file_type_light(edtype) == FUNC_SUCCESS) {
 			excluded_files++;
 			continue;
 		}
@@ -2271,31 +4294,19 @@ list_dir_light(void)
 		init_fileinfo(n);
 
 		file_info[n].utf8 = is_utf8_name(ename, &file_info[n].bytes);
-		file_info[n].name = xnmalloc(file_info[n].bytes + 1, sizeof(char));
+		file_info[n].name = fiarena_alloc(file_info[n].bytes + 1);
 		memcpy(file_info[n].name, ename, file_info[n].bytes + 1);
 		file_info[n].len = (file_info[n].utf8 == 0)
 			? file_info[n].bytes : wc_xstrlen(ename);
 
 		/* ################  */
-#ifndef _DIRENT_HAVE_D_TYPE
-		file_info[n].type = get_dt(attr.st_mode);
-#else
-		/* If type is unknown, we might be facing a file system not
-		 * supporting d_type, for example, loop devices. In this case,
-		 * try falling back to lstat(2). */
-		if (ent->d_type == DT_UNKNOWN) {
-			struct stat a;
-			if (lstat(ename, &a) == -1)
-				continue;
-			file_info[n].type = get_dt(a.st_mode);
-		} else {
-			file_info[n].type = ent->d_type;
-		}
-#endif /* !_DIRENT_HAVE_D_TYPE */
+		/* DT_UNKNOWN (e.g. a file system not supporting d_type, like
+		 * loop devices) was already resolved via lstat(2) above. */
+		file_info[n].type = edtype;
 
 		file_info[n].dir = (file_info[n].type == DT_DIR);
 		file_info[n].symlink = (file_info[n].type == DT_LNK);
-		file_info[n].inode = ent->d_ino;
+		file_info[n].inode = edino;
 
 		switch (file_info[n].type) {
 		case DT_DIR:
@@ -2365,24 +4376,15 @@ list_dir_light(void)
 #endif /* !_NO_ICONS */
 
 		if (conf.long_view == 1) {
-#ifndef _DIRENT_HAVE_D_TYPE
-			set_long_attribs(n, &attr);
-#else
 			struct stat a;
 			if (lstat(file_info[n].name, &a) != -1)
 				set_long_attribs(n, &a);
 			else
 				file_info[n].stat_err = 1;
-#endif /* !_DIRENT_HAVE_D_TYPE */
 			if (prop_fields.ids == PROP_ID_NAME && file_info[n].stat_err == 0)
 				get_id_names(n);
 		}
 
-		if (xargs.disk_usage_analyzer == 1) {
-			get_largest(n, &largest_size, &largest_name,
-				&largest_color, &total_size);
-		}
-
 		n++;
 		if (n > FILESN_MAX - 1) {
 			err('w', PRINT_PROMPT, _("%s: Integer overflow detected "
@@ -2396,6 +4398,24 @@ list_dir_light(void)
 	file_info[n].name = (char *)NULL;
 	files = n;
 
+	/* Already listing in light mode, but the directory is big enough to
+	 * degrade anyway: drop the files counter and icons for the next
+	 * listings of this directory (this pass already paid for them). */
+	if (conf.big_dir_threshold > 0 && bigdir_active == 0
+	&& n >= (filesn_t)conf.big_dir_threshold)
+		bigdir_engage();
+
+	/* Resolve the directory sizes queued during the scan (FullDirSize) */
+	xdu_run_pending();
+	dcnt_run_pending();
+	perf_end(PERF_LIST_SCAN);
+
+	if (xargs.disk_usage_analyzer == 1) {
+		for (filesn_t j = 0; j < n; j++)
+			get_largest(j, &largest_size, &largest_name,
+				&largest_color, &total_size);
+	}
+
 	if (hidden_list)
 		free_dothidden(&hidden_list);
 
@@ -2414,8 +4434,22 @@ list_dir_light(void)
 	const int pad = (max_files != UNSET && files > (filesn_t)max_files)
 		? DIGINUM(max_files) : DIGINUM(files);
 
-	if (conf.sort != SNONE)
-		ENTSORT(file_info, (size_t)n, entrycmp);
+	dirlist_gen++;
+
+	if (conf.sort != SNONE) {
+		perf_begin(PERF_LIST_SORT);
+		init_sort_keys(file_info, n);
+		if ((max_files == UNSET
+		|| topk_sort(file_info, n, (filesn_t)max_files) == FUNC_FAILURE)
+		&& dirs_first_sort(file_info, n) == FUNC_FAILURE
+		&& name_radix_sort(file_info, n) == FUNC_FAILURE
+		&& entry_ptr_sort(file_info, n) == FUNC_FAILURE)
+			ENTSORT(file_info, (size_t)n, entrycmp);
+		perf_end(PERF_LIST_SORT);
+		record_sort();
+	}
+
+	perf_begin(PERF_LIST_PRINT);
 
 	size_t counter = 0;
 	size_t columns_n = 1;
@@ -2448,6 +4482,8 @@ list_dir_light(void)
 		list_files_horizontal(&counter, &reset_pager, pad, columns_n);
 
 END:
+	perf_end(PERF_LIST_PRINT);
+	excluded_files_bk = excluded_files;
 	exit_code =
 		post_listing(close_dir == 1 ? dir : NULL, reset_pager, excluded_files);
 
@@ -2480,24 +4516,11 @@ check_seltag(const dev_t dev, const ino_t ino, const nlink_t links,
 	if (sel_n == 0 || !sel_devino)
 		return 0;
 
-	filesn_t j = (filesn_t)sel_n;
-	while (--j >= 0) {
-		if (sel_devino[j].dev != dev || sel_devino[j].ino != ino)
-			continue;
-		/* Only check hardlinks in case of regular files */
-		if (file_info[index].type != DT_DIR && links > 1) {
-			const char *p = strrchr(sel_elements[j].name, '/');
-			if (!p || !*(++p))
-				continue;
-			if (*p == *file_info[index].name
-			&& strcmp(p, file_info[index].name) == 0)
-				return 1;
-		} else {
-			return 1;
-		}
-	}
+	/* Only check hardlink names in case of regular files */
+	const char *name = (file_info[index].type != DT_DIR && links > 1)
+		? file_info[index].name : NULL;
 
-	return 0;
+	return is_file_selected(dev, ino, name);
 }
 
 /* Get the color of a link target NAME, whose file attributes are ATTR,
@@ -2533,9 +4556,10 @@ get_link_target_color(const char *name, const struct stat *attr,
 			return;
 		}
 
-		if (clen > 0) { /* We have an extension color */
-			file_info[i].ext_color = savestring(color, clen);
-			file_info[i].color = file_info[i].ext_color;
+		if (clen > 0) {
+			/* An extension color: COLOR is the interned escape
+			 * sequence (see get_ext_color_esc()), stored as is. */
+			file_info[i].ext_color = file_info[i].color = color;
 		} else {
 			file_info[i].color = color;
 		}
@@ -2606,8 +4630,13 @@ load_file_gral_info(const struct stat *a, const filesn_t n)
 
 #if defined(LINUX_FILE_XATTRS)
 	if (file_info[n].type != DT_LNK && (checks.xattr == 1 || check_cap == 1)
-	&& listxattr(file_info[n].name, NULL, 0) > 0)
-		file_info[n].xattr = 1;
+	&& dev_supports_xattr(a->st_dev) == 1) {
+		const ssize_t xret = listxattr(file_info[n].name, NULL, 0);
+		if (xret > 0)
+			file_info[n].xattr = 1;
+		else if (xret == -1 && errno == ENOTSUP)
+			set_dev_xattr_unsup(a->st_dev);
+	}
 #endif /* LINUX_FILE_XATTRS */
 
 	time_t btime = (time_t)-1;
@@ -2650,7 +4679,7 @@ static inline void
 load_dir_info(const struct stat *a, const filesn_t n)
 {
 #ifndef _NO_ICONS
-	if (conf.icons == 1) {
+	if (conf.icons == 1 && checks.lazy_icons == 0) {
 		get_dir_icon(n);
 
 		if (*dir_ico_c)	/* If set from the color scheme file */
@@ -2661,8 +4690,20 @@ load_dir_info(const struct stat *a, const filesn_t n)
 	const int daccess = (a &&
 		check_file_access(a->st_mode, a->st_uid, a->st_gid) == 1);
 
-	file_info[n].filesn = (checks.files_counter == 1
-		? (count_dir(file_info[n].name, NO_CPOP) - 2) : 1);
+	if (checks.files_counter == 1 && a) {
+		if (dcnt_cache_get(a->st_dev, a->st_ino, a->st_mtime,
+		&file_info[n].filesn) != FUNC_SUCCESS) {
+			/* Counted by the worker pool before the display phase
+			 * (see dcnt_run_pending()), which also resolves the color
+			 * and the statistics below. */
+			file_info[n].filesn = 1;
+			dcnt_pending_add(n, a, daccess);
+			return;
+		}
+	} else {
+		file_info[n].filesn = (checks.files_counter == 1
+			? (count_dir(file_info[n].name, NO_CPOP) - 2) : 1);
+	}
 
 	if (daccess == 0 || file_info[n].filesn < 0) {
 		file_info[n].color = nd_c;
@@ -2691,7 +4732,7 @@ load_dir_info(const struct stat *a, const filesn_t n)
 }
 
 static inline void
-load_link_info(const int fd, const filesn_t n)
+load_link_info(const int fd, const filesn_t n, const struct stat *a)
 {
 #ifndef _NO_ICONS
 	file_info[n].icon = ICON_LINK;
@@ -2703,32 +4744,63 @@ load_link_info(const int fd, const filesn_t n)
 	}
 
 	struct stat attrl;
-	if (fstatat(fd, file_info[n].name, &attrl, 0) == -1) {
-		file_info[n].color = or_c;
-		file_info[n].xattr = 0;
-		stats.broken_link++;
-		return;
-	}
-
-	/* We only need the symlink target name provided the target
-	 * is not a directory, because get_link_target_color() will
-	 * check the file name extension. get_dir_color() only needs
-	 * this name to run count_dir(), but we have already executed
-	 * this function. */
 	static char tmp[PATH_MAX + 1]; *tmp = '\0';
-	const ssize_t ret =
-		(conf.color_lnk_as_target == 1 && !S_ISDIR(attrl.st_mode))
-		? readlinkat(XAT_FDCWD, file_info[n].name, tmp, sizeof(tmp) - 1)
-		: 0;
-	if (ret > 0)
-		tmp[ret] = '\0';
+	const struct lnk_cache_t *c = a ? lnk_cache_get(a) : NULL;
+
+	if (c) {
+		if (c->stat_err == 1) {
+			file_info[n].color = or_c;
+			file_info[n].xattr = 0;
+			stats.broken_link++;
+			return;
+		}
+
+		attrl = c->tstat;
+		if (c->target)
+			xstrsncpy(tmp, c->target, sizeof(tmp));
+	} else {
+		if (xfstatat(fd, file_info[n].name, &attrl, 0) == -1) {
+			if (a)
+				lnk_cache_put(a, NULL, 1, NULL);
+			file_info[n].color = or_c;
+			file_info[n].xattr = 0;
+			stats.broken_link++;
+			return;
+		}
+
+		/* We only need the symlink target name provided the target
+		 * is not a directory, because get_link_target_color() will
+		 * check the file name extension. get_dir_color() only needs
+		 * this name to run count_dir(), but we have already executed
+		 * this function. */
+		const ssize_t ret =
+			(conf.color_lnk_as_target == 1 && !S_ISDIR(attrl.st_mode))
+			? readlinkat(XAT_FDCWD, file_info[n].name, tmp, sizeof(tmp) - 1)
+			: 0;
+		if (ret > 0)
+			tmp[ret] = '\0';
+
+		if (a)
+			lnk_cache_put(a, &attrl, 0, *tmp ? tmp : NULL);
+	}
 
 	const char *lname = *tmp ? tmp : file_info[n].name;
 
 	if (S_ISDIR(attrl.st_mode)) {
 		file_info[n].dir = 1;
-		file_info[n].filesn = conf.files_counter == 1
-			? (count_dir(file_info[n].name, NO_CPOP) - 2) : 1;
+		if (conf.files_counter == 1) {
+			/* The key is the target's identity: the count is shared
+			 * with the directory itself if also listed. */
+			if (dcnt_cache_get(attrl.st_dev, attrl.st_ino,
+			attrl.st_mtime, &file_info[n].filesn) != FUNC_SUCCESS) {
+				file_info[n].filesn =
+					count_dir(file_info[n].name, NO_CPOP) - 2;
+				dcnt_cache_put(attrl.st_dev, attrl.st_ino,
+					attrl.st_mtime, file_info[n].filesn);
+			}
+		} else {
+			file_info[n].filesn = 1;
+		}
 
 		const filesn_t dfiles = (conf.files_counter == 1)
 			? (file_info[n].filesn == 2 ? 3
@@ -2831,7 +4903,7 @@ load_regfile_info(const struct stat *a, const filesn_t n)
 	 * 2. extension
 	 * 3. file type */
 	/* Check icons for specific file names */
-	const int name_icon_found = (conf.icons == 1)
+	const int name_icon_found = (conf.icons == 1 && checks.lazy_icons == 0)
 		? get_name_icon(n) : 0;
 #endif /* !_NO_ICONS */
 
@@ -2844,21 +4916,65 @@ load_regfile_info(const struct stat *a, const filesn_t n)
 
 	file_info[n].ext_name = ext;
 #ifndef _NO_ICONS
-	if (name_icon_found == 0 && conf.icons == 1)
+	if (name_icon_found == 0 && conf.icons == 1 && checks.lazy_icons == 0)
 		get_ext_icon(ext, n);
 #endif /* !_NO_ICONS */
 
-	size_t color_len = 0;
-	const char *extcolor = get_ext_color(ext, &color_len);
+	char *extcolor = get_ext_color_esc(ext, NULL);
 	if (!extcolor)
 		return;
 
-	char *t = xnmalloc(color_len + 4, sizeof(char));
-	*t = '\x1b'; t[1] = '[';
-	memcpy(t + 2, extcolor, color_len);
-	t[color_len + 2] = 'm';
-	t[color_len + 3] = '\0';
-	file_info[n].ext_color = file_info[n].color = t;
+	/* Interned: canonical pointer, no per-entry copy. */
+	file_info[n].ext_color = file_info[n].color = extcolor;
+}
+
+/* Load type-specific information (colors, icons, counters, long view
+ * attributes) for the entry at index N, whose stat info is ATTR (taken as
+ * valid only if STAT_OK is 1). FD is the file descriptor of the listed
+ * directory. This is the tail of the per-entry work performed by the
+ * gathering loop of list_dir(), shared with the incremental refresh path
+ * (update_dirlist()). */
+static void
+load_entry_info(const int fd, const struct stat *attr, const int stat_ok,
+	const filesn_t n)
+{
+	if (stat_ok == 1) {
+		load_file_gral_info(attr, n);
+		if (file_info[n].xattr == 1)
+			have_xattr_bk = 1;
+	} else {
+		file_info[n].type = DT_UNKNOWN;
+		stats.unknown++;
+	}
+
+	file_info[n].dir = (file_info[n].type == DT_DIR);
+	file_info[n].symlink = (file_info[n].type == DT_LNK);
+
+	switch (file_info[n].type) {
+	case DT_DIR: load_dir_info(stat_ok == 1 ? attr : NULL, n); break;
+	case DT_LNK: load_link_info(fd, n, stat_ok == 1 ? attr : NULL); break;
+	case DT_REG: load_regfile_info(stat_ok == 1 ? attr : NULL, n); break;
+
+	/* For the time being, we have no specific colors for DT_ARCH1,
+	 * DT_ARCH2, and DT_WHT. */
+	case DT_SOCK: file_info[n].color = so_c; break;
+	case DT_FIFO: file_info[n].color = pi_c; break;
+	case DT_BLK: file_info[n].color = bd_c; break;
+	case DT_CHR: file_info[n].color = cd_c; break;
+#ifdef SOLARIS_DOORS
+	case DT_DOOR: file_info[n].color = oo_c; break;
+	case DT_PORT: file_info[n].color = oo_c; break;
+#endif /* SOLARIS_DOORS */
+	case DT_UNKNOWN: file_info[n].color = no_c; break;
+	default: file_info[n].color = df_c; break;
+	}
+
+#ifndef _NO_ICONS
+	if (checks.icons_use_file_color == 1)
+		file_info[n].icon_color = file_info[n].color;
+#endif /* !_NO_ICONS */
+	if (conf.long_view == 1 && stat_ok == 1)
+		set_long_attribs(n, attr);
 }
 
 static int
@@ -2870,7 +4986,7 @@ vt_stat(const int fd, char *restrict path, struct stat *attr)
 	if (xreadlink(fd, path, buf, sizeof(buf)) == -1)
 		return (-1);
 
-	if (!*buf || fstatat(fd, buf, attr, AT_SYMLINK_NOFOLLOW) == -1)
+	if (!*buf || xfstatat(fd, buf, attr, AT_SYMLINK_NOFOLLOW) == -1)
 		return (-1);
 
 	return 0;
@@ -2893,6 +5009,11 @@ list_dir(void)
 	if (xargs.list_and_quit != 1)
 		HIDE_CURSOR;
 
+	/* Restore the pre-degradation settings first, so that the autocmds
+	 * revert below sees the values it backed up. */
+	if (bigdir_active == 1 && dir_changed == 1)
+		bigdir_disengage();
+
 	if (autocmds_n > 0 && dir_changed == 1) {
 		if (autocmd_set == 1)
 			revert_autocmd_opts();
@@ -2934,25 +5055,59 @@ list_dir(void)
 	/* Reset the stats struct */
 	stats = (struct stats_t){0};
 
+	/* Hysteresis: drop the degraded profile only once the entry count of
+	 * the previous listing falls well below the threshold, to avoid
+	 * flapping around the boundary. */
+	if (bigdir_active == 1 && dir_changed == 0 && conf.big_dir_threshold > 0
+	&& files < (filesn_t)(conf.big_dir_threshold
+	- conf.big_dir_threshold / 4))
+		bigdir_disengage();
+
 	init_checks_struct();
 
+#ifdef LINUX_STATX
+	set_statx_mask();
+#endif /* LINUX_STATX */
+
 	if (conf.long_view == 1)
 		props_now = time(NULL);
 
+	/* Revisiting an unchanged directory: swap the cached file list back
+	 * in and go straight to the display phase. */
+	if (dircache_restore() == FUNC_SUCCESS) {
+		if (xargs.disk_usage_analyzer == 1 || (conf.long_view == 1
+		&& conf.full_dir_size == 1)) {
+			fputs("\r            \r", stdout); /* Erase the "Scanning..." message */
+			fflush(stdout);
+		}
+		exit_code = redisplay_dirlist();
+		return exit_code;
+	}
+
 	if (conf.light_mode == 1)
 		return list_dir_light();
 
+#ifdef LINUX_FSINFO
+	/* On a remote file system every lstat(2) in the scan below blocks on
+	 * the network in turn: take the light path instead, where names come
+	 * straight from the directory stream and are rendered immediately,
+	 * and stat-derived data is resolved on demand, as in regular light
+	 * mode. */
+	if (workspaces[cur_ws].path
+	&& is_remote_fs(workspaces[cur_ws].path) == 1)
+		return list_dir_light();
+#endif /* LINUX_FSINFO */
+
 	struct dothidden_t *hidden_list =
 		(conf.read_dothidden == 1 && conf.show_hidden == 0)
 		? load_dothidden() : NULL;
 
 	DIR *dir;
-	struct dirent *ent;
 	struct stat attr;
 	int reset_pager = 0;
 	filesn_t excluded_files = 0;
 	int close_dir = 1;
-	int have_xattr = 0;
+	have_xattr_bk = 0;
 
 	/* A few variables for the disk usage analyzer mode */
 	off_t largest_size = 0, total_size = 0;
@@ -2980,6 +5135,7 @@ list_dir(void)
 
 	errno = 0;
 	longest = 0;
+	cur_layout_pad = cur_layout_cols = -1;
 	filesn_t n = 0, count = 0;
 	size_t total_dents = 0;
 
@@ -2989,8 +5145,45 @@ list_dir(void)
 		(follow_symlinks == 1 && conf.long_view == 1
 		&& conf.follow_symlinks_long == 1) ? 0 : AT_SYMLINK_NOFOLLOW;
 
-	while ((ent = readdir(dir))) {
-		const char *ename = ent->d_name;
+	/* Gather all directory entries first, and then stat them in parallel
+	 * (skipped for small directories and for virtual directories, whose
+	 * entries are resolved via vt_stat() instead of fstatat(2)). */
+	struct pstat_t pst = {0};
+	struct timespec cstart, cend;
+	perf_begin(PERF_LIST_SCAN);
+	clock_gettime(CLOCK_MONOTONIC, &cstart);
+	pstat_collect(dir, &pst);
+	clock_gettime(CLOCK_MONOTONIC, &cend);
+
+	if (conf.big_dir_threshold > 0 && bigdir_active == 0
+	&& pst.n >= (filesn_t)conf.big_dir_threshold) {
+		/* Too many entries: restart this listing in light mode, with the
+		 * files counter and icons disabled. Only the name-gathering pass
+		 * is repeated; the stat phase has not run yet. */
+		bigdir_engage();
+		init_checks_struct();
+		pstat_free(&pst);
+		free(file_info);
+		file_info = (struct fileinfo *)NULL;
+		closedir(dir);
+		if (hidden_list)
+			free_dothidden(&hidden_list);
+		perf_end(PERF_LIST_SCAN);
+		return list_dir_light();
+	}
+
+	/* The scan is going to take a while: show something right away. */
+	int preview_lines = 0;
+	if (conf.pager != 0 && xargs.list_and_quit != 1
+	&& (cend.tv_sec - cstart.tv_sec) * 1000000000LL
+	+ (cend.tv_nsec - cstart.tv_nsec) >= PREVIEW_COLLECT_NSEC)
+		preview_lines = print_scan_preview(&pst);
+
+	if (virtual_dir == 0)
+		pstat_run(&pst, fd, stat_flag);
+
+	for (filesn_t pi = 0; pi < pst.n; pi++) {
+		const char *ename = pst.names[pi];
 		/* Skip self and parent directories */
 		if (SELFORPARENT(ename))
 			continue;
@@ -3001,7 +5194,7 @@ list_dir(void)
 
 		/* Filter files according to a regex filter */
 		if (checks.filter_name == 1) {
-			if (regexec(&regex_exp, ename, 0, NULL, 0) == FUNC_SUCCESS) {
+			if (filter_name_match(ename) == 1) {
 				if (filter.rev == 1) {
 					excluded_files++;
 					continue;
@@ -3028,9 +5221,16 @@ list_dir(void)
 
 		init_fileinfo(n);
 
-		const int stat_ok =
-			((virtual_dir == 1 ? vt_stat(fd, ent->d_name, &attr)
-			: fstatat(fd, ename, &attr, stat_flag)) == 0);
+		int stat_ok;
+		if (pst.attrs) { /* Results pre-computed by the parallel phase */
+			stat_ok = (pst.errs[pi] == 0);
+			if (stat_ok == 1)
+				attr = pst.attrs[pi];
+		} else {
+			stat_ok =
+				((virtual_dir == 1 ? vt_stat(fd, pst.names[pi], &attr)
+				: xfstatat(fd, ename, &attr, stat_flag)) == 0);
+		}
 
 		if (stat_ok == 0) {
 			if (virtual_dir == 1)
@@ -3079,54 +5279,15 @@ list_dir(void)
 		 * names are far more common than UTF-8 names. */
 		file_info[n].utf8 = is_utf8_name(ename, &file_info[n].bytes);
 
-		file_info[n].name = xnmalloc(file_info[n].bytes + 1, sizeof(char));
-		memcpy(file_info[n].name, ename, file_info[n].bytes + 1);
+		/* The gathered name buffer lives in the listing arena and is
+		 * exactly bytes + 1 long: just point to it. */
+		file_info[n].name = pst.names[pi];
 
 		/* Columns needed to display file name */
 		file_info[n].len = file_info[n].utf8 == 0
 			? file_info[n].bytes : wc_xstrlen(ename);
 
-		if (stat_ok == 1) {
-			load_file_gral_info(&attr, n);
-			if (file_info[n].xattr == 1)
-				have_xattr = 1;
-		} else {
-			file_info[n].type = DT_UNKNOWN;
-			stats.unknown++;
-		}
-
-		file_info[n].dir = (file_info[n].type == DT_DIR);
-		file_info[n].symlink = (file_info[n].type == DT_LNK);
-
-		switch (file_info[n].type) {
-		case DT_DIR: load_dir_info(stat_ok == 1 ? &attr : NULL, n); break;
-		case DT_LNK: load_link_info(fd, n); break;
-		case DT_REG: load_regfile_info(stat_ok == 1 ? &attr : NULL, n); break;
-
-		/* For the time being, we have no specific colors for DT_ARCH1,
-		 * DT_ARCH2, and DT_WHT. */
-		case DT_SOCK: file_info[n].color = so_c; break;
-		case DT_FIFO: file_info[n].color = pi_c; break;
-		case DT_BLK: file_info[n].color = bd_c; break;
-		case DT_CHR: file_info[n].color = cd_c; break;
-#ifdef SOLARIS_DOORS
-		case DT_DOOR: file_info[n].color = oo_c; break;
-		case DT_PORT: file_info[n].color = oo_c; break;
-#endif /* SOLARIS_DOORS */
-		case DT_UNKNOWN: file_info[n].color = no_c; break;
-		default: file_info[n].color = df_c; break;
-		}
-
-#ifndef _NO_ICONS
-		if (checks.icons_use_file_color == 1)
-			file_info[n].icon_color = file_info[n].color;
-#endif /* !_NO_ICONS */
-		if (conf.long_view == 1 && stat_ok == 1)
-			set_long_attribs(n, &attr);
-
-		if (xargs.disk_usage_analyzer == 1)
-			get_largest(n, &largest_size, &largest_name,
-				&largest_color, &total_size);
+		load_entry_info(fd, &attr, stat_ok, n);
 
 		n++;
 		if (n > FILESN_MAX - 1) {
@@ -3138,6 +5299,23 @@ list_dir(void)
 		count++;
 	}
 
+	/* Release stat results and whatever names were not consumed by the
+	 * loop (i.e. excluded entries). */
+	pstat_free(&pst);
+
+	/* Resolve the directory sizes queued during the scan (FullDirSize).
+	 * Sizes must be known before sorting/displaying the list, and before
+	 * looking for the largest file in disk usage analyzer mode. */
+	xdu_run_pending();
+	dcnt_run_pending();
+	perf_end(PERF_LIST_SCAN);
+
+	if (xargs.disk_usage_analyzer == 1) {
+		for (filesn_t j = 0; j < n; j++)
+			get_largest(j, &largest_size, &largest_name,
+				&largest_color, &total_size);
+	}
+
 	if (hidden_list)
 		free_dothidden(&hidden_list);
 
@@ -3160,6 +5338,8 @@ list_dir(void)
 	}
 
 	if (n == 0) {
+		if (preview_lines > 0)
+			erase_scan_preview(preview_lines);
 		printf("%s. ..%s\n", di_c, df_c);
 		free(file_info);
 		goto END;
@@ -3172,13 +5352,27 @@ list_dir(void)
 		 * #    SORT FILES ACCORDING TO SORT METHOD    #
 		 * ############################################# */
 
-	if (conf.sort != SNONE)
-		ENTSORT(file_info, (size_t)n, entrycmp);
+	dirlist_gen++;
+
+	if (conf.sort != SNONE) {
+		perf_begin(PERF_LIST_SORT);
+		init_sort_keys(file_info, n);
+		if ((max_files == UNSET
+		|| topk_sort(file_info, n, (filesn_t)max_files) == FUNC_FAILURE)
+		&& dirs_first_sort(file_info, n) == FUNC_FAILURE
+		&& name_radix_sort(file_info, n) == FUNC_FAILURE
+		&& entry_ptr_sort(file_info, n) == FUNC_FAILURE)
+			ENTSORT(file_info, (size_t)n, entrycmp);
+		perf_end(PERF_LIST_SORT);
+		record_sort();
+	}
 
 		/* ##########################################
 		 * #    GET INFO TO PRINT COLUMNED OUTPUT   #
 		 * ########################################## */
 
+	perf_begin(PERF_LIST_PRINT);
+
 	size_t counter = 0;
 	size_t columns_n = 1;
 
@@ -3186,6 +5380,10 @@ list_dir(void)
 	if (conf.columned == 1 || conf.long_view == 1)
 		get_longest_filename(n, (size_t)pad);
 
+	/* The full sorted list is ready: replace the preview with it. */
+	if (preview_lines > 0)
+		erase_scan_preview(preview_lines);
+
 				/* ########################
 				 * #    LONG VIEW MODE    #
 				 * ######################## */
@@ -3193,7 +5391,7 @@ list_dir(void)
 	if (conf.long_view == 1) {
 		if (prop_fields.size == PROP_SIZE_HUMAN)
 			construct_human_sizes();
-		print_long_mode(&counter, &reset_pager, pad, have_xattr);
+		print_long_mode(&counter, &reset_pager, pad, have_xattr_bk);
 		goto END;
 	}
 
@@ -3214,6 +5412,8 @@ list_dir(void)
 				 * ######################### */
 
 END:
+	perf_end(PERF_LIST_PRINT);
+	excluded_files_bk = excluded_files;
 	exit_code =
 		post_listing(close_dir == 1 ? dir : NULL, reset_pager, excluded_files);
 
@@ -3231,25 +5431,384 @@ END:
 	return exit_code;
 }
 
+/* Incremental refresh
+ *
+ * When the file system monitor reports a small batch of changes in the
+ * current directory, re-running the whole list_dir() pipeline re-reads and
+ * re-stats every single entry, even though only a few of them changed.
+ * update_dirlist() instead applies adds/removes/updates to the existing
+ * file_info array in place, touching only the changed entries, and then
+ * re-sorts and re-prints the list. If the current listing mode carries
+ * state we cannot patch reliably (filters, light mode, virtual dirs, etc.),
+ * it refuses, and the caller falls back to a full reload. */
+
+/* Max amount of changed entries applied incrementally: beyond this, a
+ * full rescan is no more expensive than patching. */
+#define DIRLIST_UPDATE_MAX 64
+
+/* Recompute the stats struct from the current file_info array. Used after
+ * an incremental update, where per-entry counters cannot be simply
+ * incremented (updated entries would be counted twice). */
+static void
+recount_stats(void)
+{
+	/* File capabilities are counted by get_regfile_color() during the
+	 * full scan and cannot be re-derived from the file_info array. The
+	 * hidden counter includes dot files excluded from the listing, which
+	 * are equally not re-derivable: update_dirlist() adjusts it by delta
+	 * instead. Keep the last known values: the next full listing corrects
+	 * them. */
+	const size_t caps = stats.caps;
+	const size_t hidden = stats.hidden;
+	stats = (struct stats_t){0};
+	stats.caps = caps;
+	stats.hidden = hidden;
+
+	filesn_t i = files;
+	while (--i >= 0) {
+		switch (file_info[i].type) {
+		case DT_REG:
+			stats.reg++;
+			if (file_info[i].exec == 1) stats.exec++;
+			if (file_info[i].linkn > 1) stats.multi_link++;
+			if (file_info[i].mode & S_ISUID) stats.suid++;
+			if (file_info[i].mode & S_ISGID) stats.sgid++;
+			break;
+		case DT_DIR:
+			stats.dir++;
+			if (file_info[i].mode & S_IWOTH) stats.other_writable++;
+			if (file_info[i].mode & S_ISVTX) stats.sticky++;
+			break;
+		case DT_LNK:
+			stats.link++;
+			if (file_info[i].color == or_c) stats.broken_link++;
+			break;
+		case DT_FIFO: stats.fifo++; break;
+		case DT_SOCK: stats.socket++; break;
+		case DT_BLK: stats.block_dev++; break;
+		case DT_CHR: stats.char_dev++; break;
+#ifdef SOLARIS_DOORS
+		case DT_DOOR: stats.door++; break;
+		case DT_PORT: stats.port++; break;
+#endif /* SOLARIS_DOORS */
+		case DT_UNKNOWN: stats.unknown++; break;
+		default: break;
+		}
+
+		if (file_info[i].xattr == 1) stats.extended++;
+		if (file_info[i].stat_err == 1) stats.unstat++;
+	}
+}
+
+/* Re-sort and re-print the current file list without rescanning the
+ * directory. This is the display phase of list_dir(), run over an
+ * incrementally patched file_info array. */
+static int
+redisplay_dirlist(void)
+{
+	if (conf.clear_screen == 1)
+		{ CLEAR; fflush(stdout); }
+
+	if (xargs.list_and_quit != 1)
+		HIDE_CURSOR;
+
+	if (conf.unicode == 0) {
+		trim.state = trim.a = trim.b = 0;
+		trim.len = 0;
+	}
+
+	get_term_size();
+
+	int reset_pager = 0;
+
+	/* An unchanged list swapped back from the cache carries the layout
+	 * it was printed with: if the ELN pad and the terminal width are
+	 * still the same, longest/longest_fc hold and the layout pass can
+	 * be skipped. */
+	const int cached_pad = restored_layout_pad;
+	const int cached_cols = restored_layout_cols;
+	restored_layout_pad = restored_layout_cols = -1;
+
+	if (files == 0) {
+		longest = 0;
+		printf("%s. ..%s\n", di_c, df_c);
+		return post_listing(NULL, reset_pager, excluded_files_bk);
+	}
+
+	const int pad = (max_files != UNSET && files > (filesn_t)max_files)
+		? DIGINUM(max_files) : DIGINUM(files);
+
+	const int reuse_layout = (cached_pad != -1 && cached_pad == pad
+		&& cached_cols == (int)term_cols);
+
+	if (reuse_layout == 0)
+		longest = 0;
+
+	if (conf.sort != SNONE && dirlist_sorted() == 0) {
+		init_sort_keys(file_info, files);
+		if ((max_files == UNSET
+		|| topk_sort(file_info, files, (filesn_t)max_files) == FUNC_FAILURE)
+		&& dirs_first_sort(file_info, files) == FUNC_FAILURE
+		&& name_radix_sort(file_info, files) == FUNC_FAILURE
+		&& entry_ptr_sort(file_info, files) == FUNC_FAILURE)
+			ENTSORT(file_info, (size_t)files, entrycmp);
+		record_sort();
+	}
+
+	size_t counter = 0;
+
+	if ((conf.columned == 1 || conf.long_view == 1) && reuse_layout == 0)
+		get_longest_filename(files, (size_t)pad);
+
+	if (conf.long_view == 1) {
+		if (prop_fields.size == PROP_SIZE_HUMAN)
+			construct_human_sizes();
+		print_long_mode(&counter, &reset_pager, pad, have_xattr_bk);
+	} else {
+		const size_t columns_n = conf.columned == 0 ? 1 : get_columns();
+		if (conf.listing_mode == VERTLIST)
+			list_files_vertical(&counter, &reset_pager, pad, columns_n);
+		else
+			list_files_horizontal(&counter, &reset_pager, pad, columns_n);
+	}
+
+	return post_listing(NULL, reset_pager, excluded_files_bk);
+}
+
+/* Remove the entry at index J from the file list, preserving the
+ * trailing NULL sentinel. */
+static void
+remove_dirlist_entry(const filesn_t j)
+{
+	/* The entry's strings live in the listing arena: they are reclaimed
+	 * when the whole list is dropped. */
+
+	/* Move up the remaining entries, including the sentinel. */
+	memmove(&file_info[j], &file_info[j + 1],
+		(size_t)(files - j) * sizeof(struct fileinfo));
+	files--;
+}
+
+/* Apply NAMES_N file name changes (NAMES) to the current file list in
+ * place: new files are appended, gone files are removed, and the rest is
+ * re-stated and rebuilt, leaving all other entries untouched. The list is
+ * then re-sorted and re-printed.
+ * Return FUNC_SUCCESS if the changes were applied, or FUNC_FAILURE if the
+ * current listing carries state we cannot patch reliably, in which case
+ * the caller must perform a full reload instead. */
+int
+update_dirlist(char **names, const size_t names_n)
+{
+	if (!file_info || names_n == 0 || names_n > DIRLIST_UPDATE_MAX)
+		return FUNC_FAILURE;
+
+	/* Bail out whenever the listing depends on more than the raw directory
+	 * contents: these modes either exclude entries (so that an event name
+	 * cannot be mapped to a list slot) or recompute global state we cannot
+	 * patch (e.g. disk usage totals). */
+	if (conf.light_mode == 1 || virtual_dir == 1 || conf.only_dirs == 1
+	|| (conf.read_dothidden == 1 && conf.show_hidden == 0)
+	|| checks.filter_name == 1 || checks.filter_type == 1
+	|| xargs.disk_usage_analyzer == 1)
+		return FUNC_FAILURE;
+
+	const int fd = open(workspaces[cur_ws].path, O_RDONLY | O_DIRECTORY);
+	if (fd == -1)
+		return FUNC_FAILURE;
+
+	const int stat_flag =
+		(follow_symlinks == 1 && conf.long_view == 1
+		&& conf.follow_symlinks_long == 1) ? 0 : AT_SYMLINK_NOFOLLOW;
+
+	if (conf.long_view == 1)
+		props_now = time(NULL);
+
+	size_t changes = 0;
+
+	for (size_t i = 0; i < names_n; i++) {
+		const char *ename = names[i];
+		if (!ename || !*ename || SELFORPARENT(ename))
+			continue;
+
+		/* Hidden files are not listed: nothing to patch. The hidden
+		 * files counter may drift a bit until the next full listing. */
+		if (*ename == '.' && conf.show_hidden == 0)
+			continue;
+
+		/* Look up the event name in the current list. */
+		filesn_t j = files;
+		while (--j >= 0) {
+			if (*file_info[j].name == *ename
+			&& strcmp(file_info[j].name, ename) == 0)
+				break;
+		}
+
+		struct stat attr;
+		if (xfstatat(fd, ename, &attr, stat_flag) == -1) {
+			if (j >= 0) { /* Gone: remove it from the list. */
+				if (*ename == '.' && stats.hidden > 0)
+					stats.hidden--;
+				remove_dirlist_entry(j);
+				changes++;
+			}
+			continue;
+		}
+
+		if (j >= 0) { /* Known file: rebuild the entry in place. */
+			char *name_bk = file_info[j].name;
+			const size_t bytes_bk = file_info[j].bytes;
+			const size_t len_bk = file_info[j].len;
+			const int utf8_bk = file_info[j].utf8;
+
+			init_fileinfo(j);
+			file_info[j].name = name_bk;
+			file_info[j].bytes = bytes_bk;
+			file_info[j].len = len_bk;
+			file_info[j].utf8 = utf8_bk;
+		} else { /* New file: append a new entry. */
+			file_info = xnrealloc(file_info, (size_t)files + 2,
+				sizeof(struct fileinfo));
+			j = files;
+			init_fileinfo(j);
+			file_info[j].utf8 = is_utf8_name(ename, &file_info[j].bytes);
+			file_info[j].name = fiarena_savestring(ename,
+				file_info[j].bytes);
+			file_info[j].len = file_info[j].utf8 == 0
+				? file_info[j].bytes : wc_xstrlen(ename);
+			files++;
+			file_info[files].name = (char *)NULL;
+			if (*ename == '.')
+				stats.hidden++;
+		}
+
+		load_entry_info(fd, &attr, 1, j);
+		changes++;
+	}
+
+	close(fd);
+
+	if (changes == 0)
+		/* Nothing changed on our side (e.g. a file created and removed
+		 * before we could stat it). Keep the screen as is. */
+		return FUNC_SUCCESS;
+
+	/* New directories may have queued their full size (FullDirSize) */
+	xdu_run_pending();
+	dcnt_run_pending();
+
+	dirlist_gen++;
+	recount_stats();
+	redisplay_dirlist();
+
+#ifndef _NO_SUGGESTIONS
+	invalidate_fnames_index();
+#endif /* !_NO_SUGGESTIONS */
+	flush_tab_comp_cache();
+	flush_regex_cache();
+
+	/* The directory changed on disk: re-record its identity so the
+	 * patched list can be stashed and reused under the new mtime. */
+	dircache_record_cur();
+
+	return FUNC_SUCCESS;
+}
+
+/* Reverse the current file list in place and re-print it, without
+ * rescanning the directory or running a sort. entrycmp() negates its
+ * whole result (directories-first included) when sort_reverse is set,
+ * so the reversed array is exactly the order a full re-sort would
+ * produce -- in O(n) instead of O(n log n), with no syscalls.
+ * Called by the 'st rev' toggle after flipping conf.sort_reverse.
+ * Return FUNC_SUCCESS if the list was reversed and re-printed, or
+ * FUNC_FAILURE if the caller must fall back to a full re-sort (no list
+ * to reverse, unsorted listing, or a list truncated by max_files, where
+ * only the displayed head is in order). */
+int
+reverse_dirlist(void)
+{
+	if (conf.autols == 0 || !file_info || files <= 0)
+		return FUNC_FAILURE;
+
+	if (conf.sort == SNONE
+	|| (max_files != UNSET && files > (filesn_t)max_files))
+		return FUNC_FAILURE;
+
+	filesn_t i = 0, j = files - 1;
+	while (i < j) {
+		const struct fileinfo tmp = file_info[i];
+		file_info[i] = file_info[j];
+		file_info[j] = tmp;
+		i++;
+		j--;
+	}
+
+	dirlist_gen++;
+	record_sort();
+
+	/* If this list is later stashed, it must be keyed by the order it
+	 * now holds. */
+	dircache_cur_params.sort_reverse = conf.sort_reverse;
+
+	sort_switch = 1;
+	redisplay_dirlist();
+	sort_switch = 0;
+
+	return FUNC_SUCCESS;
+}
+
 void
 free_dirlist(void)
 {
+#ifndef _NO_SUGGESTIONS
+	invalidate_fnames_index();
+#endif /* !_NO_SUGGESTIONS */
+	flush_tab_comp_cache();
+	flush_regex_cache();
+	stat_cache_invalidate();
+
 	if (!file_info || files == 0)
 		return;
 
-	filesn_t i = files;
-	while (--i >= 0) {
-		free(file_info[i].name);
-		free(file_info[i].ext_color);
+	/* Hand the list over to the directory cache whenever possible. */
+	if (dircache_stash() == FUNC_SUCCESS) {
+		file_info = (struct fileinfo *)NULL;
+		return;
 	}
 
 	free(file_info);
 	file_info = (struct fileinfo *)NULL;
+
+	/* Recycle the arena holding the list's strings for the next
+	 * listing, instead of freeing anything. */
+	fiarena_release(fi_arena);
+	fi_arena = (struct fiarena_t *)NULL;
 }
 
 void
 reload_dirlist(void)
 {
+#ifdef RUN_CMD
+	if (cmd_line_cmd)
+		return;
+#endif /* RUN_CMD */
+
+	/* A reload request means our copy of this directory is stale. */
+	dircache_invalidate_cur();
+	lnk_cache_invalidate();
+	free_dirlist();
+	const int bk = exit_code;
+	list_dir();
+	exit_code = bk;
+}
+
+/* Relist after changing to another directory (cd, b/f, workspace
+ * switching). Unlike reload_dirlist(), the list of the directory being
+ * left is not stale -- we just moved away -- so it is handed over to the
+ * directory cache (via free_dirlist()), and the new directory is served
+ * from the cache if an up-to-date copy of it is stored. */
+void
+switch_dirlist(void)
+{
 #ifdef RUN_CMD
 	if (cmd_line_cmd)
 		return;
@@ -3274,3 +5833,29 @@ refresh_screen(void)
 	reload_dirlist();
 	conf.clear_screen = bk;
 }
+
+/* Redraw the current list after a terminal resize. The directory
+ * contents have not changed -- only the geometry -- so only the layout
+ * and print passes are re-run over the existing file_info array,
+ * instead of rescanning the directory. */
+void
+resize_dirlist(void)
+{
+#ifdef RUN_CMD
+	if (cmd_line_cmd)
+		return;
+#endif /* RUN_CMD */
+
+	if (conf.autols == 0 || !file_info || files <= 0) {
+		refresh_screen();
+		return;
+	}
+
+	const int cs_bk = conf.clear_screen;
+	conf.clear_screen = 1;
+	const int bk = exit_code;
+	redisplay_dirlist();
+	exit_code = bk;
+	conf.clear_screen = cs_bk;
+}
+
@@ -29,11 +29,22 @@ __BEGIN_DECLS
 
 void free_dirlist(void);
 int  list_dir(void);
+int  dirlist_patch_selection(void);
+int  pstat_get_threads(void);
 void reload_dirlist(void);
+int  reverse_dirlist(void);
+void switch_dirlist(void);
+char *fiarena_savestring(const char *str, const size_t len);
 void refresh_screen(void);
+void resize_dirlist(void);
+int  update_dirlist(char **names, const size_t names_n);
+void dircache_drop(void);
+void free_dircache(void);
 
 #ifndef _NO_ICONS
 void init_icons_hashes(void);
+void free_icons_hashes(void);
+void resolve_entry_icon(const filesn_t n);
 #endif /* !_NO_ICONS */
 
 __END_DECLS
@@ -31,7 +31,9 @@
 #include "aux.h"    /* xitoa() */
 #include "checks.h" /* check_file_access() */
 #include "colors.h" /* remove_bold_attr() */
+#include "listing.h" /* fiarena_savestring() */
 #include "misc.h"   /* gen_diff_str() */
+#include "obuf.h"   /* obuf_printf(), obuf_puts(), obuf_putc() */
 #include "properties.h"
 
 /* These macros define the max length for each properties field.
@@ -62,6 +64,57 @@
 /* File allocated blocks */
 #define BLK_STR_LEN   ((MAX_COLOR * 2) + 32)
 
+/* Most entries in a directory share a handful of mode/owner/size
+ * combinations, and the constructed strings are written into static
+ * buffers (print_entry_props()) that survive across calls: remember the
+ * inputs the last string was built from and rebuild only when they
+ * change. The memos are valid for a single listing (colors and
+ * configuration may change in between): print_long_mode() (listing.c)
+ * invalidates them, via reset_long_view_memo(), before each run. */
+
+static struct perms_memo_t {
+	mode_t mode;
+	char file_type;
+	int valid;
+} perms_memo;
+
+static struct size_memo_t {
+	off_t size;
+	mode_t mode;
+	int dir;
+	int du_status;
+	int du_approx;
+	int stat_err;
+	int file_perm;
+	int size_max;
+	int valid;
+} size_memo;
+
+static struct id_memo_t {
+	uid_t uid;
+	gid_t gid;
+	int file_perm;
+	int stat_err;
+	int valid;
+} id_memo;
+
+/* Defined right before print_entry_props(), below. */
+static void compile_prop_fields_plan(void);
+static char pf_plan_src[PROP_FIELDS_SIZE + 1];
+
+void
+reset_long_view_memo(void)
+{
+	perms_memo.valid = 0;
+	size_memo.valid = 0;
+	id_memo.valid = 0;
+
+	/* Recompile the PropFields plan if the layout changed (the 'pf'
+	 * command or a config reload). */
+	if (strcmp(pf_plan_src, prop_fields_str) != 0)
+		compile_prop_fields_plan();
+}
+
 static char *
 get_ext_info_long(const char *name, const size_t name_len, int *trim,
 	size_t *ext_len)
@@ -185,7 +238,9 @@ construct_and_print_filename(const struct fileinfo *props,
 	static char trim_s[2] = {0};
 	*trim_s = trim > 0 ? TRIMFILE_CHR : 0;
 
-	printf("%s%s%s%s%s%ls%s%s%-*s%s\x1b[0m%s%s\x1b[0m%s%s%s  ",
+	/* The whole entry is composed into the output buffer (obuf.c) and
+	 * flushed to the screen by print_long_mode() (listing.c) */
+	obuf_printf("%s%s%s%s%s%ls%s%s%-*s%s\x1b[0m%s%s\x1b[0m%s%s%s  ",
 		(conf.colorize == 1 && conf.icons == 1) ? props->icon_color : "",
 		conf.icons == 1 ? props->icon : "", conf.icons == 1 ? " " : "", df_c,
 
@@ -207,6 +262,18 @@ construct_file_size(const struct fileinfo *props, char *size_str,
 		return;
 	}
 
+	if (size_memo.valid == 1 && size_memo.size == props->size
+	&& size_memo.mode == props->mode && size_memo.dir == props->dir
+	&& size_memo.du_status == props->du_status
+	&& size_memo.du_approx == props->du_approx
+	&& size_memo.stat_err == props->stat_err
+	&& size_memo.file_perm == file_perm && size_memo.size_max == size_max)
+		return; /* SIZE_STR already holds the right string */
+
+	size_memo = (struct size_memo_t){props->size, props->mode, props->dir,
+		props->du_status, props->du_approx, props->stat_err, file_perm,
+		size_max, 1};
+
 	if (props->stat_err == 1) {
 		snprintf(size_str, SIZE_STR_LEN, "%*s", size_max
 			+ (prop_fields.size == PROP_SIZE_HUMAN), UNKNOWN_STR);
@@ -237,10 +304,11 @@ construct_file_size(const struct fileinfo *props, char *size_str,
 	}
 
 	if (prop_fields.size != PROP_SIZE_HUMAN) {
+		const char mark = props->du_status != 0 ? DU_ERR_CHAR
+			: (props->du_approx == 1 ? '~' : 0);
 		snprintf(size_str, SIZE_STR_LEN, "%s%*jd%s%c", csize,
-			(props->du_status != 0 && size_max > 0) ? size_max - 1 : size_max,
-			(intmax_t)size, df_c,
-			props->du_status != 0 ? DU_ERR_CHAR : 0);
+			(mark != 0 && size_max > 0) ? size_max - 1 : size_max,
+			(intmax_t)size, df_c, mark);
 		return;
 	}
 
@@ -260,6 +328,14 @@ static void
 construct_file_perms(const mode_t mode, char *perm_str, const char file_type,
 	const char *ctype)
 {
+	/* CTYPE is determined by FILE_TYPE (set_file_type_and_color()), so
+	 * the pair (mode, file_type) covers every input. */
+	if (perms_memo.valid == 1 && perms_memo.mode == mode
+	&& perms_memo.file_type == file_type)
+		return; /* PERM_STR already holds the right string */
+
+	perms_memo = (struct perms_memo_t){mode, file_type, 1};
+
 	static char tmp_ctype[MAX_COLOR + 1];
 	xstrsncpy(tmp_ctype, (file_type == UNK_PCHR ? df_c : ctype),
 		sizeof(tmp_ctype));
@@ -282,8 +358,17 @@ construct_file_perms(const mode_t mode, char *perm_str, const char file_type,
 }
 
 static void
-construct_timestamp(char *time_str, const struct fileinfo *props)
+construct_timestamp(char *time_str, struct fileinfo *props)
 {
+	/* Pager repaints in long view re-enter this function for the same
+	 * entries: reuse the string rendered on the first paint (stored in
+	 * the listing's arena and dropped with it). Relative times ("5 min")
+	 * decay with the clock and are always rebuilt. */
+	if (props->time_str && conf.relative_time == 0) {
+		xstrsncpy(time_str, props->time_str, TIME_STR_LEN);
+		return;
+	}
+
 	const time_t t = props->ltime;
 
 	/* Let's construct the color for the current timestamp. */
@@ -338,12 +423,25 @@ construct_timestamp(char *time_str, const struct fileinfo *props)
 
 	snprintf(time_str, TIME_STR_LEN, "%s%s%s", cdate, *file_time
 		? file_time : UNKNOWN_STR, df_c);
+
+	if (conf.relative_time == 0)
+		props->time_str = fiarena_savestring(time_str, strlen(time_str));
 }
 
 static void
 construct_id_field(const struct fileinfo *props, char *id_str,
 	const struct maxes_t *maxes, const int file_perm)
 {
+	/* The printed names are a function of the ids (see get_id_names(),
+	 * in listing.c). */
+	if (id_memo.valid == 1 && id_memo.uid == props->uid
+	&& id_memo.gid == props->gid && id_memo.file_perm == file_perm
+	&& id_memo.stat_err == props->stat_err)
+		return; /* ID_STR already holds the right string */
+
+	id_memo = (struct id_memo_t){props->uid, props->gid, file_perm,
+		props->stat_err, 1};
+
 	const char *id_color =
 		(file_perm == 1 && conf.colorize == 1) ? dg_c : df_c;
 
@@ -484,99 +582,194 @@ construct_blocks_str(const struct fileinfo *props, char *blk_str, const int max)
  * This function is called by list_dir(), in listing.c, for each file name
  * in the current directory when running in long view mode (after
  * printing the corresponding ELN). */
-int
-print_entry_props(const struct fileinfo *props, const struct maxes_t *maxes,
-	const int have_xattr)
-{
-	char file_type = 0; /* File type indicator */
-	char *ctype = dn_c; /* Color for file type indicator */
+/* The active PropFields layout, compiled once per listing (see
+ * compile_prop_fields_plan()) into an ordered array of field formatters,
+ * so printing an entry is a tight loop over formatter pointers instead
+ * of re-branching on the PropFields string per field per file.
+ *
+ * Each formatter constructs its field into a static buffer (reusing the
+ * previous contents via the memos above when its inputs did not change)
+ * and hands it to the output buffer. */
 
-	set_file_type_and_color(props, &file_type, &ctype);
-	const int file_perm =
-		check_file_access(props->mode, props->uid, props->gid);
+struct pf_ctx_t {
+	struct fileinfo *props;
+	const struct maxes_t *maxes;
+	char *ctype;     /* Color for file type indicator */
+	int file_perm;
+	int have_xattr;
+	char file_type;  /* File type indicator */
+};
 
-	/* Let's compose each properties field individually to be able to
-	 * print only the desired ones. This is specified via the PropFields
-	 * option in the config file. */
+typedef void (*pf_formatter_t)(struct pf_ctx_t *ctx);
 
-	construct_and_print_filename(props, maxes->name);
+static void
+pf_fmt_perms(struct pf_ctx_t *ctx)
+{
+	static char perm_str[PERM_STR_LEN];
+	construct_file_perms(ctx->props->mode, perm_str, ctx->file_type,
+		ctx->ctype);
+	obuf_puts(perm_str);
 
-	static char perm_str[PERM_STR_LEN]; *perm_str = '\0';
-	if (prop_fields.perm != 0)
-		construct_file_perms(props->mode, perm_str, file_type, ctype);
+	/* We only need a single character to print the xattributes indicator,
+	 * which would be normally printed like this:
+	 * printf("%c", x ? 'x' : 0);
+	 * However, some terminals, like 'cons25', print the 0 above graphically,
+	 * as a space, which is not what we want here. To fix this, let's
+	 * construct this char as a string. */
+	if (ctx->have_xattr == 1) {
+		static char xattr_str[2] = {0};
+		*xattr_str = ctx->props->xattr == 1 ? XATTR_CHAR : ' ';
+		obuf_puts(xattr_str);
+	}
+}
 
-	static char time_str[TIME_STR_LEN]; *time_str = '\0';
-	if (prop_fields.time != 0)
-		construct_timestamp(time_str, props);
+static void
+pf_fmt_time(struct pf_ctx_t *ctx)
+{
+	static char time_str[TIME_STR_LEN];
+	*time_str = '\0';
+	construct_timestamp(time_str, ctx->props);
+	obuf_puts(time_str);
+}
 
-	static char size_str[SIZE_STR_LEN]; *size_str = '\0';
-	if (prop_fields.size != 0)
-		construct_file_size(props, size_str, maxes->size, file_perm);
+static void
+pf_fmt_size(struct pf_ctx_t *ctx)
+{
+	static char size_str[SIZE_STR_LEN];
+	construct_file_size(ctx->props, size_str, ctx->maxes->size,
+		ctx->file_perm);
+	obuf_puts(size_str);
+}
 
-	static char id_str[ID_STR_LEN]; *id_str = '\0';
-	if (prop_fields.ids != 0)
-		construct_id_field(props, id_str, maxes, file_perm);
+static void
+pf_fmt_ids(struct pf_ctx_t *ctx)
+{
+	static char id_str[ID_STR_LEN];
+	construct_id_field(ctx->props, id_str, ctx->maxes, ctx->file_perm);
+	obuf_puts(id_str);
+}
 
-	static char links_str[LINKS_STR_LEN]; *links_str = '\0';
-	if (prop_fields.links != 0)
-		construct_links_str(props, links_str, maxes->links);
+static void
+pf_fmt_links(struct pf_ctx_t *ctx)
+{
+	static char links_str[LINKS_STR_LEN];
+	*links_str = '\0';
+	construct_links_str(ctx->props, links_str, ctx->maxes->links);
+	if (*links_str)
+		obuf_puts(links_str);
+}
 
-	static char ino_str[INO_STR_LEN]; *ino_str = '\0';
-	if (prop_fields.inode != 0)
-		construct_inode_num(props, ino_str, maxes->inode);
+static void
+pf_fmt_inode(struct pf_ctx_t *ctx)
+{
+	static char ino_str[INO_STR_LEN];
+	*ino_str = '\0';
+	construct_inode_num(ctx->props, ino_str, ctx->maxes->inode);
+	if (*ino_str)
+		obuf_puts(ino_str);
+}
 
-	static char blocks_str[BLK_STR_LEN]; *blocks_str = '\0';
-	if (prop_fields.blocks != 0)
-		construct_blocks_str(props, blocks_str, maxes->blocks);
+static void
+pf_fmt_blocks(struct pf_ctx_t *ctx)
+{
+	static char blocks_str[BLK_STR_LEN];
+	*blocks_str = '\0';
+	construct_blocks_str(ctx->props, blocks_str, ctx->maxes->blocks);
+	if (*blocks_str)
+		obuf_puts(blocks_str);
+}
 
-	static char fc_str[FC_STR_LEN]; *fc_str = '\0';
+static void
+pf_fmt_counter(struct pf_ctx_t *ctx)
+{
+	static char fc_str[FC_STR_LEN];
+	*fc_str = '\0';
 	/* FC_MAX is zero if there are no subdirs in the current dir */
-	if (prop_fields.counter != 0 && conf.files_counter != 0
-	&& maxes->files_counter != 0)
-		construct_files_counter(props, fc_str, maxes->files_counter);
+	if (conf.files_counter != 0 && ctx->maxes->files_counter != 0)
+		construct_files_counter(ctx->props, fc_str,
+			ctx->maxes->files_counter);
+	obuf_puts(fc_str);
+}
 
-	/* We only need a single character to print the xattributes indicator,
-	 * which would be normally printed like this:
-	 * printf("%c", x ? 'x' : 0);
-	 * However, some terminals, like 'cons25', print the 0 above graphically,
-	 * as a space, which is not what we want here. To fix this, let's
-	 * construct this char as a string. */
-	static char xattr_str[2] = {0};
-	*xattr_str = have_xattr == 1 ? (props->xattr == 1 ? XATTR_CHAR : ' ') : 0;
+static struct pf_step_t {
+	pf_formatter_t fmt;
+	int gap_after;
+} pf_plan[PROP_FIELDS_SIZE];
+static size_t pf_plan_n = 0;
+static char pf_plan_src[PROP_FIELDS_SIZE + 1];
 
-	/* Print stuff */
-	for (size_t i = 0; i < PROP_FIELDS_SIZE && prop_fields_str[i]; i++) {
-		int print_space = prop_fields_str[i + 1] ? 1 : 0;
+/* Map each char of the PropFields string (prop_fields_str, parsed by
+ * set_prop_fields() in init.c) to its field formatter, in order. A gap
+ * follows every recognized field but the last. */
+static void
+compile_prop_fields_plan(void)
+{
+	xstrsncpy(pf_plan_src, prop_fields_str, sizeof(pf_plan_src));
+	pf_plan_n = 0;
+
+	size_t i;
+	for (i = 0; i < PROP_FIELDS_SIZE && prop_fields_str[i]; i++) {
+		pf_formatter_t fmt = NULL;
 
 		switch (prop_fields_str[i]) {
-		case 'B': if (*blocks_str) fputs(blocks_str, stdout); break;
-		case 'f': fputs(fc_str, stdout); break;
-		case 'd': if (*ino_str) fputs(ino_str, stdout); break;
+		case 'B': fmt = pf_fmt_blocks; break;
+		case 'f': fmt = pf_fmt_counter; break;
+		case 'd': fmt = pf_fmt_inode; break;
 		case 'p': /* fallthrough */
-		case 'n': fputs(perm_str, stdout);
-			if (*xattr_str) fputs(xattr_str, stdout);
-			break;
+		case 'n': fmt = pf_fmt_perms; break;
 		case 'i': /* fallthrough */
-		case 'I': fputs(id_str, stdout); break;
-		case 'l': if (*links_str) fputs(links_str, stdout); break;
+		case 'I': fmt = pf_fmt_ids; break;
+		case 'l': fmt = pf_fmt_links; break;
 		case 'a': /* fallthrough */
 		case 'b': /* fallthrough */
 		case 'm': /* fallthrough */
-		case 'c': fputs(time_str, stdout); break;
+		case 'c': fmt = pf_fmt_time; break;
 		case 's': /* fallthrough */
-		case 'S': fputs(size_str, stdout); break;
-		default: print_space = 0; break;
+		case 'S': fmt = pf_fmt_size; break;
+		default: break;
 		}
 
-		if (print_space == 0)
+		if (!fmt)
+			continue;
+
+		pf_plan[pf_plan_n].fmt = fmt;
+		pf_plan[pf_plan_n].gap_after = prop_fields_str[i + 1] ? 1 : 0;
+		pf_plan_n++;
+	}
+}
+
+int
+print_entry_props(struct fileinfo *props, const struct maxes_t *maxes,
+	const int have_xattr)
+{
+	struct pf_ctx_t ctx;
+	ctx.props = props;
+	ctx.maxes = maxes;
+	ctx.ctype = dn_c; /* Color for file type indicator */
+	ctx.have_xattr = have_xattr;
+	ctx.file_type = 0; /* File type indicator */
+
+	set_file_type_and_color(props, &ctx.file_type, &ctx.ctype);
+	ctx.file_perm = check_file_access(props->mode, props->uid, props->gid);
+
+	construct_and_print_filename(props, maxes->name);
+
+	/* Run the compiled PropFields plan: each formatter composes its
+	 * field (this is specified via the PropFields option in the config
+	 * file) and prints it. */
+	size_t i;
+	for (i = 0; i < pf_plan_n; i++) {
+		pf_plan[i].fmt(&ctx);
+
+		if (pf_plan[i].gap_after == 0)
 			continue;
 
 		if (conf.prop_fields_gap <= 1)
-			putchar(' ');
+			obuf_putc(' ');
 		else
-			MOVE_CURSOR_RIGHT(conf.prop_fields_gap);
+			obuf_printf("\x1b[%dC", conf.prop_fields_gap); /* MOVE_CURSOR_RIGHT */
 	}
-	putchar('\n');
+	obuf_putc('\n');
 
 	return FUNC_SUCCESS;
 }
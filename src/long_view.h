@@ -27,8 +27,9 @@
 
 __BEGIN_DECLS
 
-int print_entry_props(const struct fileinfo *props,
+int print_entry_props(struct fileinfo *props,
 	const struct maxes_t *maxes, const int have_xattr);
+void reset_long_view_memo(void);
 
 __END_DECLS
 
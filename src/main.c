@@ -44,6 +44,7 @@
 #include "exec.h"
 #include "history.h"
 #include "init.h"
+#include "ipc.h" /* ipc_start() */
 #include "jump.h"
 #include "keybinds.h"
 #include "listing.h"
@@ -55,6 +56,7 @@
 #include "properties.h" /* do_stat_and_exit() */
 #include "readline.h"
 #include "remotes.h"
+#include "snapshot.h"
 #ifdef SECURITY_PARANOID
 # include "sanitize.h"
 #endif /* SECURITY_PARANOID */
@@ -517,6 +519,7 @@ const struct cmdslist_t internal_cmds[] = {
 	{"m", 1},
 	{"md", 2},
 	{"media", 5},
+	{"mem", 3},
 	{"mf", 2},
 	{"mm", 2},
 	{"mime", 4},
@@ -539,6 +542,7 @@ const struct cmdslist_t internal_cmds[] = {
 	{"prop", 4},
 	{"path", 4}, // deprecate this one, just as 'cwd'
 	{"paste", 5},
+	{"perf", 4},
 	{"pf", 2},
 	{"prof", 4},
 	{"profile", 7},
@@ -586,6 +590,8 @@ const struct cmdslist_t internal_cmds[] = {
 	{"umask", 5},
 	{"v", 1},
 	{"vv", 2},
+	{"vf", 2},
+	{"verify", 6},
 	{"ver", 3},
 	{"version", 7},
 	{"view", 4},
@@ -729,6 +735,7 @@ const struct cmdslist_t param_str[] = {
 	{"log msg clear", 13},
 	{"m -f", 4},
 	{"m --force", 9},
+	{"mem stats", 9},
 	{"mf unset", 8},
 	{"mm info", 7},
 	{"mm edit", 7},
@@ -743,6 +750,9 @@ const struct cmdslist_t param_str[] = {
 	{"net mount", 9},
 	{"net unmount", 11},
 	{"opener default", 14},
+	{"perf on", 7},
+	{"perf off", 8},
+	{"perf reset", 10},
 	{"pg on", 5},
 	{"pager on", 8},
 	{"pg off", 6},
@@ -884,6 +894,62 @@ run_and_exit(void)
 }
 #endif /* RUN_CMD */
 
+/* Batch mode (--batch): read commands line by line from standard input
+ * and execute them in sequence, bypassing readline (no prompt, no
+ * suggestions, no TAB completion machinery), so that a single clifm
+ * process can serve thousands of scripted commands. Empty lines and
+ * lines starting with '#' are ignored. The process exits, with the
+ * exit code of the last executed command, once stdin is exhausted. */
+__attribute__ ((noreturn))
+static void
+run_batch_loop(void)
+{
+	/* Do not relist the current directory after every command: batch
+	 * consumers want command output only. */
+	conf.autols = 0;
+
+	char *line = (char *)NULL;
+	size_t line_size = 0;
+	ssize_t line_len;
+
+	while ((line_len = getline(&line, &line_size, stdin)) > 0) {
+		if (line[line_len - 1] == '\n')
+			line[line_len - 1] = '\0';
+
+		if (!*line || *line == '#')
+			continue;
+
+		char **cmd = parse_input_str(line);
+		if (!cmd)
+			continue;
+
+		int i;
+		char **alias_cmd = check_for_alias(cmd);
+		if (alias_cmd) {
+			exec_cmd(alias_cmd);
+
+			for (i = 0; alias_cmd[i]; i++)
+				free(alias_cmd[i]);
+			free(alias_cmd);
+		} else {
+			if (!(flags & FAILED_ALIAS))
+				exec_cmd(cmd);
+			flags &= ~FAILED_ALIAS;
+
+			for (i = 0; cmd[i]; i++)
+				free(cmd[i]);
+			free(cmd);
+		}
+
+		/* Let the driving script see each command's output as soon as
+		 * the command is done, even through a pipe. */
+		fflush(stdout);
+	}
+
+	free(line);
+	exit(exit_code);
+}
+
 /* This is the main structure of any basic shell (a REPL)
 	 1 - Grab user input
 	 2 - Parse user input
@@ -900,6 +966,9 @@ run_main_loop(void)
 		run_and_exit();
 #endif /* RUN_CMD */
 
+	if (xargs.batch == 1)
+		run_batch_loop();
+
 	int i;
 	/* 1) Infinite loop to keep the program running */
 	while (1) {
@@ -909,6 +978,13 @@ run_main_loop(void)
 			continue;
 
 		/* 3) Parse input string */
+		/* Fast path for pure-ELN input (e.g. "12"): no parsing needed. */
+		if (eln_fast_open(input) != -1) {
+			free(input);
+			input = (char *)NULL;
+			continue;
+		}
+
 		char **cmd = parse_input_str(input);
 		free(input);
 		input = (char *)NULL;
@@ -958,6 +1034,9 @@ list_files(void)
 		return;
 #endif /* RUN_CMD */
 
+	if (xargs.batch == 1)
+		return;
+
 	if (conf.autols == 1 && isatty(STDIN_FILENO)) {
 		if (xargs.list_and_quit == 1)
 			goto LIST;
@@ -1267,6 +1346,7 @@ main(int argc, char *argv[])
 
 	set_sel_file();
 	create_tmp_files();
+	load_session_snapshot();
 	load_actions();
 	get_aliases();
 
@@ -1302,25 +1382,43 @@ main(int argc, char *argv[])
 	check_working_directory();
 	set_term_win_title();
 	exec_profile();
-	load_dirhist();
-	add_to_dirhist(workspaces[cur_ws].path);
 	get_sel_files();
 
+	/* Started before the first listing so that the initial snapshots are
+	 * published as soon as there is something to serve. */
+	if (xargs.ipc == 1)
+		ipc_start();
+
 	/* Start listing as soon as possible to speed up startup time. */
 	list_files();
 
+	/* Load the directory history, bookmarks, tags, jump database, and
+	 * prompt commands (independent file parses) on worker threads while
+	 * the main thread goes on with shell and readline initialization. */
+	start_init_stages();
+
 	shell = get_sys_shell();
-	create_kbinds_file();
-	load_bookmarks();
-	load_keybinds();
-	load_tags();
-	load_jumpdb();
-	if (!jump_db || xargs.path == 1)
-		add_to_jumpdb(workspaces[cur_ws].path);
+
+	/* Keybindings are only reachable from the interactive prompt, which
+	 * scripted runs never display (initialize_readline() takes the same
+	 * shortcut). */
+	if (xargs.batch != 1 && xargs.list_and_quit != 1
+#ifdef RUN_CMD
+	&& !cmd_line_cmd
+#endif /* RUN_CMD */
+	) {
+		create_kbinds_file();
+		load_keybinds();
+	}
 
 	init_shell();
 	initialize_readline();
-	get_prompt_cmds();
+
+	join_init_stages();
+
+	add_to_dirhist(workspaces[cur_ws].path);
+	if (!jump_db || xargs.path == 1)
+		add_to_jumpdb(workspaces[cur_ws].path);
 
 #ifndef _NO_TRASH
 	init_trash();
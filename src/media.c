@@ -169,25 +169,27 @@ unmount_dev(const size_t i, const int n)
 	return exit_status;
 }
 
-static char *
-get_dev_label(void)
+/* Device labels table: /dev/disk/by-label is scanned (and each symlink
+ * resolved) only once per menu invocation, instead of once per device. */
+struct dev_label_t {
+	char *label;
+	char *dev; /* Resolved device name (ex: /dev/sda1) */
+};
+
+static struct dev_label_t *dev_labels = (struct dev_label_t *)NULL;
+static size_t dev_labels_n = 0;
+
+static void
+load_dev_labels(void)
 {
-	const size_t n = mp_n;
 	struct dirent **labels = (struct dirent **)NULL;
 	const int ln = scandir(DISK_LABELS_PATH, &labels, NULL, alphasort);
 	if (ln == - 1)
-		return (char *)NULL;
+		return;
 
-	char *label = (char *)NULL;
 	int i;
-
 	for (i = 0; i < ln; i++) {
-		if (label) {
-			free(labels[i]);
-			continue;
-		}
-
-		const char *name = labels[i]->d_name;
+		char *name = labels[i]->d_name;
 		char lpath[PATH_MAX + 1];
 		snprintf(lpath, sizeof(lpath), "%s/%s", DISK_LABELS_PATH, name);
 		char *rpath = realpath(lpath, NULL);
@@ -196,25 +198,53 @@ get_dev_label(void)
 			continue;
 		}
 
-		const int ret = strcmp(rpath, media[n].dev);
-		free(rpath);
-		if (ret == 0) {
-			/* Device label is encoded using hex. Let's decode it */
-			char *p = strchr(name, '\\');
-			if (p && *(p + 1) == 'x') {
-				char pp = 0;
-				pp = (char)(from_hex(*(p + 2)) << 4 | from_hex(*(p + 3)));
-				*p = pp;
-				xstrsncpy(p + 1, p + 4, strlen(p + 4) + 1);
-			}
-			label = savestring(name, strlen(name));
+		/* Device label is encoded using hex. Let's decode it */
+		char *p = strchr(name, '\\');
+		if (p && *(p + 1) == 'x') {
+			char pp = 0;
+			pp = (char)(from_hex(*(p + 2)) << 4 | from_hex(*(p + 3)));
+			*p = pp;
+			xstrsncpy(p + 1, p + 4, strlen(p + 4) + 1);
 		}
 
+		dev_labels = xnrealloc(dev_labels, dev_labels_n + 1,
+			sizeof(struct dev_label_t));
+		dev_labels[dev_labels_n].label = savestring(name, strlen(name));
+		dev_labels[dev_labels_n].dev = rpath;
+		dev_labels_n++;
+
 		free(labels[i]);
 	}
 
 	free(labels);
-	return label;
+}
+
+static void
+free_dev_labels(void)
+{
+	size_t i;
+	for (i = 0; i < dev_labels_n; i++) {
+		free(dev_labels[i].label);
+		free(dev_labels[i].dev);
+	}
+	free(dev_labels);
+	dev_labels = (struct dev_label_t *)NULL;
+	dev_labels_n = 0;
+}
+
+/* Return the label of the device DEV (as resolved by load_dev_labels()),
+ * or NULL if the device is unlabeled. */
+static char *
+get_dev_label(const char *dev)
+{
+	size_t i;
+	for (i = 0; i < dev_labels_n; i++) {
+		if (strcmp(dev_labels[i].dev, dev) == 0)
+			return savestring(dev_labels[i].label,
+				strlen(dev_labels[i].label));
+	}
+
+	return (char *)NULL;
 }
 
 static void
@@ -226,6 +256,8 @@ list_unmounted_devs(void)
 	if (!unm_devs)
 		return;
 
+	load_dev_labels();
+
 	printf(_("\n%sUnmounted devices%s\n\n"), BOLD, df_c);
 
 	for (i = 0; unm_devs[i]; i++) {
@@ -246,7 +278,7 @@ list_unmounted_devs(void)
 		media[mp_n].dev = savestring(unm_devs[i], strlen(unm_devs[i]));
 		media[mp_n].mnt = (char *)NULL;
 
-		media[mp_n].label = get_dev_label();
+		media[mp_n].label = get_dev_label(media[mp_n].dev);
 
 		if (media[mp_n].label)
 			printf("%s%zu %s%s [%s%s%s]\n", el_c, mp_n + 1, df_c,
@@ -258,6 +290,7 @@ list_unmounted_devs(void)
 		free(unm_devs[i]);
 	}
 	free(unm_devs);
+	free_dev_labels();
 
 	media[mp_n].dev = (char *)NULL;
 	media[mp_n].mnt = (char *)NULL;
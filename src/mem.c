@@ -27,6 +27,18 @@
 #include <errno.h> /* ENOMEM */
 #include <stdlib.h> /* malloc(), calloc(), realloc() */
 #include <stdio.h> /* fprintf() */
+#include <string.h> /* strcmp() */
+
+#include "mem.h"
+#include "messages.h" /* MEM_USAGE */
+
+#ifdef MEM_STATS
+/* This file implements the real wrappers: drop the accounting macros */
+# undef xnrealloc
+# undef xcalloc
+# undef xnmalloc
+# undef free
+#endif /* MEM_STATS */
 
 #if defined(__has_builtin) && !defined(NO_BUILTIN_MUL_OVERFLOW)
 # if __has_builtin(__builtin_mul_overflow)
@@ -95,3 +107,294 @@ xnmalloc(const size_t nmemb, const size_t size)
 
 	return p;
 }
+
+/* Optional allocation accounting (-DMEM_STATS): every allocation made
+ * through the wrappers above is tagged with the allocating translation
+ * unit (see the macros in mem.h), and free(3) is routed through xfree(),
+ * so that we can keep per-subsystem live byte/count tallies and
+ * high-water marks. The 'mem' command prints the report. Intended as a
+ * debugging aid for tracking down memory growth in long-lived sessions:
+ * the bookkeeping costs a mutex and a pointer-table probe per
+ * allocation, so it is disabled by default. */
+
+#ifdef MEM_STATS
+# include <pthread.h>
+# include <stdint.h> /* uintptr_t */
+
+/* Per-subsystem (translation unit) tallies */
+struct memown_t {
+	const char *file;
+	size_t alive;    /* Currently allocated bytes */
+	size_t alive_n;  /* Currently allocated blocks */
+	size_t peak;     /* High-water mark for ALIVE */
+	size_t total;    /* Cumulative allocated bytes */
+	size_t total_n;  /* Cumulative allocations */
+};
+
+/* One live allocation: pointer, size, and index into MEM_OWNERS */
+struct memptr_t {
+	const void *ptr;
+	size_t size;
+	size_t owner;
+};
+
+#define MEM_PTR_TOMBSTONE ((const void *)-1)
+#define MEM_MAP_INIT_SIZE 4096 /* Must be a power of two */
+
+static struct memown_t *mem_owners;
+static size_t mem_owners_n, mem_owners_cap;
+
+/* Open-addressing pointer table of live allocations */
+static struct memptr_t *mem_map;
+static size_t mem_map_cap, mem_map_n, mem_map_used; /* USED includes tombstones */
+
+static size_t mem_alive, mem_alive_peak;
+
+static pthread_mutex_t mem_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static size_t
+mem_hash_ptr(const void *p)
+{
+	/* Low bits are zero for most allocators: shift them out */
+	return (size_t)(((uintptr_t)p >> 4) * 0x9e3779b97f4a7c15ULL);
+}
+
+/* Return the index into MEM_OWNERS for FILE, creating the entry if needed.
+ * FILE is a __FILE__ literal: compare by address first, falling back to
+ * strcmp(3) (each translation unit gets its own copy of the literal). */
+static size_t
+mem_owner(const char *file)
+{
+	size_t i;
+	for (i = 0; i < mem_owners_n; i++) {
+		if (mem_owners[i].file == file
+		|| strcmp(mem_owners[i].file, file) == 0)
+			return i;
+	}
+
+	if (mem_owners_n == mem_owners_cap) {
+		mem_owners_cap = mem_owners_cap == 0 ? 64 : mem_owners_cap * 2;
+		mem_owners = realloc(mem_owners,
+			mem_owners_cap * sizeof(struct memown_t));
+		if (!mem_owners)
+			exit(ENOMEM);
+	}
+
+	mem_owners[mem_owners_n] = (struct memown_t){0};
+	mem_owners[mem_owners_n].file = file;
+	return mem_owners_n++;
+}
+
+/* Forget the live allocation P, subtracting it from its owner's tallies.
+ * A no-op if P is not tracked (e.g. allocated directly via malloc(3)). */
+static void
+mem_map_del(const void *p)
+{
+	if (mem_map_cap == 0)
+		return;
+
+	size_t i = mem_hash_ptr(p) & (mem_map_cap - 1);
+	while (mem_map[i].ptr != NULL) {
+		if (mem_map[i].ptr == p) {
+			mem_owners[mem_map[i].owner].alive -= mem_map[i].size;
+			mem_owners[mem_map[i].owner].alive_n--;
+			mem_alive -= mem_map[i].size;
+			mem_map[i].ptr = MEM_PTR_TOMBSTONE;
+			mem_map_n--;
+			return;
+		}
+		i = (i + 1) & (mem_map_cap - 1);
+	}
+}
+
+static void
+mem_map_grow(void)
+{
+	const size_t old_cap = mem_map_cap;
+	struct memptr_t *old_map = mem_map;
+
+	mem_map_cap = old_cap == 0 ? MEM_MAP_INIT_SIZE : old_cap * 2;
+	mem_map = calloc(mem_map_cap, sizeof(struct memptr_t));
+	if (!mem_map)
+		exit(ENOMEM);
+
+	mem_map_used = mem_map_n;
+	size_t i;
+	for (i = 0; i < old_cap; i++) {
+		if (old_map[i].ptr == NULL || old_map[i].ptr == MEM_PTR_TOMBSTONE)
+			continue;
+		size_t j = mem_hash_ptr(old_map[i].ptr) & (mem_map_cap - 1);
+		while (mem_map[j].ptr != NULL)
+			j = (j + 1) & (mem_map_cap - 1);
+		mem_map[j] = old_map[i];
+	}
+
+	free(old_map);
+}
+
+/* Record the live allocation P (SIZE bytes, owned by OWNER). If P is
+ * already present (its previous owner freed it behind our back, i.e. not
+ * through xfree(), and the address got reused), reconcile the stale entry
+ * first. */
+static void
+mem_map_add(const void *p, const size_t size, const size_t owner)
+{
+	/* Keep the load factor (including tombstones) below 50% */
+	if (mem_map_used * 2 >= mem_map_cap)
+		mem_map_grow();
+
+	mem_map_del(p);
+
+	size_t i = mem_hash_ptr(p) & (mem_map_cap - 1);
+	while (mem_map[i].ptr != NULL && mem_map[i].ptr != MEM_PTR_TOMBSTONE)
+		i = (i + 1) & (mem_map_cap - 1);
+
+	if (mem_map[i].ptr == NULL)
+		mem_map_used++;
+	mem_map[i].ptr = p;
+	mem_map[i].size = size;
+	mem_map[i].owner = owner;
+	mem_map_n++;
+}
+
+static void
+mem_track(const void *p, const size_t size, const char *file)
+{
+	pthread_mutex_lock(&mem_lock);
+
+	const size_t o = mem_owner(file);
+	mem_map_add(p, size, o);
+
+	mem_owners[o].alive += size;
+	mem_owners[o].alive_n++;
+	mem_owners[o].total += size;
+	mem_owners[o].total_n++;
+	if (mem_owners[o].alive > mem_owners[o].peak)
+		mem_owners[o].peak = mem_owners[o].alive;
+
+	mem_alive += size;
+	if (mem_alive > mem_alive_peak)
+		mem_alive_peak = mem_alive;
+
+	pthread_mutex_unlock(&mem_lock);
+}
+
+void *
+xnmalloc_(const size_t nmemb, const size_t size, const char *file)
+{
+	/* nmemb * size cannot overflow here: xnmalloc() would have exited */
+	void *p = xnmalloc(nmemb, size);
+	mem_track(p, nmemb * size, file);
+	return p;
+}
+
+void *
+xcalloc_(const size_t nmemb, const size_t size, const char *file)
+{
+	void *p = xcalloc(nmemb, size);
+	mem_track(p, nmemb * size, file);
+	return p;
+}
+
+void *
+xnrealloc_(void *ptr, const size_t nmemb, const size_t size, const char *file)
+{
+	if (ptr) {
+		pthread_mutex_lock(&mem_lock);
+		mem_map_del(ptr);
+		pthread_mutex_unlock(&mem_lock);
+	}
+
+	void *p = xnrealloc(ptr, nmemb, size);
+	mem_track(p, nmemb * size, file);
+	return p;
+}
+
+void
+xfree(void *ptr)
+{
+	if (ptr) {
+		pthread_mutex_lock(&mem_lock);
+		mem_map_del(ptr);
+		pthread_mutex_unlock(&mem_lock);
+	}
+
+	free(ptr);
+}
+
+static int
+mem_cmp_alive(const void *a, const void *b)
+{
+	const struct memown_t *oa = (const struct memown_t *)a;
+	const struct memown_t *ob = (const struct memown_t *)b;
+
+	if (oa->alive != ob->alive)
+		return oa->alive < ob->alive ? 1 : -1;
+	return strcmp(oa->file, ob->file);
+}
+
+static int
+print_mem_report(void)
+{
+	pthread_mutex_lock(&mem_lock);
+
+	/* Sort a snapshot by live bytes, descending */
+	struct memown_t *list =
+		malloc(mem_owners_n * sizeof(struct memown_t));
+	if (!list) {
+		pthread_mutex_unlock(&mem_lock);
+		exit(ENOMEM);
+	}
+	memcpy(list, mem_owners, mem_owners_n * sizeof(struct memown_t));
+	const size_t n = mem_owners_n;
+	const size_t alive = mem_alive, peak = mem_alive_peak;
+	const size_t blocks = mem_map_n;
+
+	pthread_mutex_unlock(&mem_lock);
+
+	qsort(list, n, sizeof(struct memown_t), mem_cmp_alive);
+
+	printf(_("%-22s %12s %9s %12s %12s %10s\n"), _("Subsystem"),
+		_("Live (KiB)"), _("Blocks"), _("Peak (KiB)"), _("Total (KiB)"),
+		_("Allocs"));
+
+	size_t i;
+	for (i = 0; i < n; i++) {
+		printf("%-22s %12.1f %9zu %12.1f %12.1f %10zu\n", list[i].file,
+			(double)list[i].alive / 1024.0, list[i].alive_n,
+			(double)list[i].peak / 1024.0,
+			(double)list[i].total / 1024.0, list[i].total_n);
+	}
+
+	printf(_("\nLive: %.1f KiB in %zu blocks (peak: %.1f KiB)\n"),
+		(double)alive / 1024.0, blocks, (double)peak / 1024.0);
+	puts(_("Note: Only memory allocated via the mem.c wrappers is tracked"));
+
+	free(list);
+	return FUNC_SUCCESS;
+}
+#endif /* MEM_STATS */
+
+/* Handle the 'mem' command: print the per-subsystem allocation report
+ * (requires compiling with -DMEM_STATS). */
+int
+mem_function(char **args)
+{
+	if (args && args[0] && IS_HELP(args[0])) {
+		puts(_(MEM_USAGE));
+		return FUNC_SUCCESS;
+	}
+
+#ifdef MEM_STATS
+	if (!args || !args[0] || strcmp(args[0], "stats") == 0)
+		return print_mem_report();
+
+	fprintf(stderr, "%s\n", _(MEM_USAGE));
+	return FUNC_FAILURE;
+#else
+	UNUSED(args);
+	fprintf(stderr, _("%s: mem: Memory accounting not available. "
+		"Recompile with -DMEM_STATS\n"), PROGRAM_NAME);
+	return FUNC_FAILURE;
+#endif /* MEM_STATS */
+}
@@ -32,6 +32,25 @@ __BEGIN_DECLS
 void *xnrealloc(void *ptr, const size_t nmemb, const size_t size);
 void *xcalloc(const size_t nmemb, const size_t size);
 void *xnmalloc(const size_t nmemb, const size_t size);
+int   mem_function(char **args);
+
+#ifdef MEM_STATS
+/* Accounting variants: FILE is the allocating translation unit, used to
+ * attribute allocations to subsystems (see mem.c). */
+void *xnrealloc_(void *ptr, const size_t nmemb, const size_t size,
+	const char *file);
+void *xcalloc_(const size_t nmemb, const size_t size, const char *file);
+void *xnmalloc_(const size_t nmemb, const size_t size, const char *file);
+void  xfree(void *ptr);
+
+# define xnrealloc(p, n, s) xnrealloc_((p), (n), (s), __FILE__)
+# define xcalloc(n, s)      xcalloc_((n), (s), __FILE__)
+# define xnmalloc(n, s)     xnmalloc_((n), (s), __FILE__)
+/* Route free(3) through xfree() to keep live-byte tallies accurate. At
+ * declaration sites (e.g. a libc header included after this one) the
+ * expansion yields a plain, compatible declaration of xfree(). */
+# define free(p) xfree(p)
+#endif /* MEM_STATS */
 
 __END_DECLS
 
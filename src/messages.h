@@ -673,6 +673,14 @@ If mounting a device, CliFM will change automatically to the corresponding\n\
 mountpoint.\n\n\
 To get information about a device, enter iELN. For example: 'i12'."
 
+#define MEM_USAGE "Print a per-subsystem memory allocation report\n\n\
+\x1b[1mUSAGE\x1b[0m\n\
+  mem [stats]\n\n\
+For each subsystem (translation unit) allocating memory through the\n\
+mem.c wrappers, print currently allocated bytes and blocks, the\n\
+high-water mark, and cumulative allocation figures.\n\n\
+Note: Accounting must be enabled at compile time (-DMEM_STATS)."
+
 #define MF_USAGE "Limit the amount of files listed on the screen to NUM \
 (valid range: >= 0). Use 'unset' to remove the files limit.\n\n\
 \x1b[1mUSAGE\x1b[0m\n\
@@ -854,6 +862,17 @@ passed as arguments.\n\n\
 Both symbolic and octal notation for the new permissions set are allowed.\n\n\
 Note: Use the 'oc' command to edit files ownership."
 
+#define PERF_USAGE "Toggle hot-path performance instrumentation\n\n\
+\x1b[1mUSAGE\x1b[0m\n\
+  perf [on | off | reset]\n\n\
+When enabled, lightweight counters measure the time spent in the main\n\
+hot paths: directory scan (stat(2) and per-entry info, including color\n\
+resolution), file list sorting, list printing, suggestions, tab\n\
+completion, and command execution.\n\n\
+Run 'perf' without parameters to print a per-phase breakdown table.\n\
+Counters accumulate until cleared via 'perf reset' (or 'perf on' after\n\
+instrumentation was disabled)."
+
 #define PIN_USAGE "Pin a file or directory\n\n\
 \x1b[1mUSAGE\x1b[0m\n\
   pin FILE/DIR\n\n\
@@ -1148,6 +1167,18 @@ Note: To permanently set the umask, use the Umask option in the config file."
     'u <TAB>' to choose from a list (multi-selection is allowed)\n\n\
 Note: Use the 'trash' command to trash files. Try 'trash --help'."
 
+#define VERIFY_USAGE "Print SHA-256 checksums or compare two directories\n\n\
+\x1b[1mUSAGE\x1b[0m\n\
+  vf, verify ELN/FILE...\n\
+  vf, verify SOURCE_DIR DEST_DIR\n\n\
+\x1b[1mEXAMPLES\x1b[0m\n\
+- Print the SHA-256 checksum of all ISO files in the current directory\n\
+    vf *.iso\n\
+- Verify a copy: compare every file in 'src' against its copy in 'backup'\n\
+    vf src backup\n\n\
+Files are hashed by multiple threads. In compare mode, mismatching and\n\
+missing files are reported, together with the hashing throughput."
+
 #define VV_USAGE "Copy files into a directory and bulk rename them at once\n\n\
 \x1b[1mUSAGE\x1b[0m\n\
   vv FILE... DIR\n\n\
@@ -1259,7 +1290,8 @@ emulator using the TerminalCmd option in the configuration file."
 
 /* Misc messages */
 #define PAGER_HELP "?, h: help\nDown arrow, Enter, Space: Advance one line\n\
-Page Down: Advance one page\nq: Stop paging (without printing remaining files)\n\
+Page Down: Advance one page\nUp arrow, Page Up, b: Go back one page\n\
+q: Stop paging (without printing remaining files)\n\
 c: Stop paging (printing remaining files)\n"
 #define PAGER_LABEL "\x1b[7;97m--Mas--\x1b[0;49m"
 #define NOT_AVAILABLE "This feature has been disabled at compile time"
@@ -1361,6 +1393,8 @@ on an empty line\
 \n  -z, --sort=METHOD\t\t Sort files by METHOD (see the manpage)"
 
 #define LONG_OPTIONS_A "\
+\n      --batch\t\t\t Read commands from standard input and execute them \
+in sequence, bypassing the interactive prompt\
 \n      --bell=STYLE\t\t Set terminal bell style to: 0 (none), 1 (audible), 2 (visible), 3 (flash)\
 \n      --case-sens-dirjump\t Do not ignore case when consulting the jump \
 database (via the 'j' command)\
@@ -1383,6 +1417,8 @@ and paths\
 \n      --icons\t\t\t Enable icons\
 \n      --icons-use-file-color\t Icon colors follow file colors\
 \n      --int-vars\t\t Enable internal variables\
+\n      --ipc\t\t\t Serve listing, selection, and workspace state over a \
+Unix socket (see CLIFM_IPC_SOCKET)\
 \n      --list-and-quit\t\t List files and quit\
 \n      --ls\t\t\t Short for --list-and-quit\
 \n      --lscolors\t\t Read file colors from LS_COLORS\
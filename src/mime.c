@@ -27,6 +27,7 @@
 #include "helpers.h"
 
 #include <errno.h>
+#include <fcntl.h> /* open(2) (preview output cache) */
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
@@ -313,25 +314,97 @@ retrieve_app(char *line)
 	return (char *)NULL; /* No app was found */
 }
 
-/* Get application associated to a given MIME type or file name.
- * Returns the first matching line in the MIME file or NULL if none is
- * found. */
-static char *
-get_app(const char *mime, const char *filename)
+/* A compiled, in-memory copy of the mimelist file.
+ *
+ * Since opening a file requires finding its matching rule, and the naive
+ * procedure (re-open the mimelist file and regcomp(3) every line until one
+ * matches) is run once per open, we compile the file only once into an
+ * array of pre-compiled regexes, and then just regexec(3) against this
+ * array on each open. The cache is transparently rebuilt whenever the
+ * mimelist file changes on disk (say, after 'mm edit' or 'mm import'). */
+struct mime_rule_t {
+	regex_t regex;  /* The pre-compiled rule pattern. */
+	char *cmds;     /* The list of opening applications. */
+	int name_rule;  /* Match file names instead of MIME types (N:/E:). */
+	int valid;      /* Zero if the pattern failed to compile. */
+};
+
+#define MIME_RULES_MIN_CAP 64
+
+static struct mime_rule_t *mime_rules = (struct mime_rule_t *)NULL;
+static size_t mime_rules_n = 0;
+static size_t mime_rules_cap = 0;
+static int    mime_rules_built = 0;
+static int    mime_rules_gui = 0; /* GUI flag at compilation time. */
+static time_t mime_rules_mtime = 0;
+static off_t  mime_rules_fsize = 0;
+
+/* Free the compiled mimelist cache. */
+void
+free_mime_rules(void)
 {
-	if (!mime || !mime_file || !*mime_file)
-		return (char *)NULL;
+	size_t i;
+	for (i = 0; i < mime_rules_n; i++) {
+		if (mime_rules[i].valid == 1)
+			regfree(&mime_rules[i].regex);
+		free(mime_rules[i].cmds);
+	}
+
+	free(mime_rules);
+	mime_rules = (struct mime_rule_t *)NULL;
+	mime_rules_n = mime_rules_cap = 0;
+	mime_rules_built = 0;
+}
+
+/* Compile PATTERN and append it, together with its applications list CMDS,
+ * to the rules array. */
+static void
+mime_rules_add(const char *pattern, const char *cmds)
+{
+	if (mime_rules_n >= mime_rules_cap) {
+		mime_rules_cap = mime_rules_cap == 0
+			? MIME_RULES_MIN_CAP : mime_rules_cap * 2;
+		mime_rules = xnrealloc(mime_rules, mime_rules_cap,
+			sizeof(struct mime_rule_t));
+	}
+
+	struct mime_rule_t *r = &mime_rules[mime_rules_n];
+
+	r->name_rule = ((*pattern == 'N' || *pattern == 'E')
+		&& *(pattern + 1) == ':');
+
+	/* Mirror test_pattern(): file name patterns are matched
+	 * case-insensitively. */
+	const int reg_flags = r->name_rule == 1
+		? (REG_NOSUB | REG_EXTENDED | REG_ICASE) : (REG_NOSUB | REG_EXTENDED);
+
+	r->valid = regcomp(&r->regex,
+		r->name_rule == 1 ? pattern + 2 : pattern, reg_flags) == 0;
+
+	size_t cmds_len = strlen(cmds);
+	if (cmds_len > 0 && cmds[cmds_len - 1] == '\n')
+		cmds_len--;
+
+	r->cmds = savestring(cmds, cmds_len);
+	mime_rules_n++;
+}
+
+/* Compile the mimelist file into the rules array.
+ * ATTR is the current stat(2) information for the mimelist file. */
+static void
+build_mime_rules(const struct stat *attr)
+{
+	free_mime_rules();
 
 	int fd = 0;
 	FILE *fp = open_fread(mime_file, &fd);
 	if (!fp) {
 		xerror("%s: '%s': %s\n", err_name, mime_file, strerror(errno));
-		return (char *)NULL;
+		return;
 	}
 
 	size_t line_size = 0;
 	char *line = (char *)NULL;
-	char *app = (char *)NULL;
 
 	/* Each line has this form: prefix:pattern=cmd;cmd;cmd... */
 	while (getline(&line, &line_size, fp) > 0) {
@@ -340,24 +413,98 @@ get_app(const char *mime, const char *filename)
 
 		if (skip_line(line, &pattern, &cmds) == 1)
 			continue;
-		/* PATTERN points now to the beginning of the null terminated pattern,
-		 * while CMDS points to the beginning of the list of opening cmds. */
 
-		mime_match = 0;
-		/* Global. Are we matching a MIME type? It will be set by test_pattern. */
-		if (test_pattern(pattern, filename, mime) == FUNC_FAILURE)
+		mime_rules_add(pattern, cmds);
+	}
+
+	free(line);
+	fclose(fp);
+
+	mime_rules_built = 1;
+	mime_rules_gui = (flags & GUI) ? 1 : 0;
+	mime_rules_mtime = attr->st_mtime;
+	mime_rules_fsize = attr->st_size;
+}
+
+/* Recompile the mimelist cache if the mimelist file changed on disk (or
+ * was never compiled). Since skip_line_prefix() resolves X:/!X: prefixes
+ * at parse time, a change of the GUI flag invalidates the cache too. */
+static void
+mime_rules_update(void)
+{
+	struct stat attr;
+	if (stat(mime_file, &attr) == -1) {
+		free_mime_rules();
+		return;
+	}
+
+	if (mime_rules_built == 1 && mime_rules_mtime == attr.st_mtime
+	&& mime_rules_fsize == attr.st_size
+	&& mime_rules_gui == ((flags & GUI) ? 1 : 0))
+		return;
+
+	build_mime_rules(&attr);
+}
+
+/* Get application associated to a given MIME type or file name.
+ * Returns the first matching rule in the compiled mimelist cache or NULL
+ * if none is found. */
+static char *
+get_app(const char *mime, const char *filename)
+{
+	if (!mime || !mime_file || !*mime_file)
+		return (char *)NULL;
+
+	mime_rules_update();
+
+	char *app = (char *)NULL;
+	size_t i;
+
+	for (i = 0; i < mime_rules_n; i++) {
+		struct mime_rule_t *r = &mime_rules[i];
+		if (r->valid == 0)
 			continue;
 
-		if ((app = retrieve_app(cmds)))
+		/* The global mime_match tells whether we matched a MIME type or
+		 * a file name. */
+		if (r->name_rule == 1) {
+			if (!filename || regexec(&r->regex, filename, 0, NULL, 0) != 0)
+				continue;
+			mime_match = 0;
+		} else {
+			if (regexec(&r->regex, mime, 0, NULL, 0) != 0)
+				continue;
+			mime_match = 1;
+		}
+
+		if ((app = retrieve_app(r->cmds)))
 			break;
 	}
 
-	free(line);
-	fclose(fp);
 	return app;
 }
 
 #ifndef _NO_MAGIC
+/* Persistent libmagic handles, one per query mode: loading the magic
+ * database is by far the most expensive part of a libmagic query, and
+ * bulk operations (e.g. 'p' over an ELN range) call xmagic() once per
+ * file. The handles are opened and loaded on first use and kept for the
+ * whole session (freed by free_magic_cookies() at exit). */
+static magic_t magic_cookies[2]; /* [0]: MIME type, [1]: description */
+static int magic_cookies_err[2];
+
+void
+free_magic_cookies(void)
+{
+	int i;
+	for (i = 0; i < 2; i++) {
+		if (magic_cookies[i])
+			magic_close(magic_cookies[i]);
+		magic_cookies[i] = (magic_t)NULL;
+		magic_cookies_err[i] = 0;
+	}
+}
+
 /* Get FILE's MIME type using the libmagic library */
 char *
 xmagic(const char *file, const int query_mime)
@@ -365,22 +512,25 @@ xmagic(const char *file, const int query_mime)
 	if (!file || !*file)
 		return (char *)NULL;
 
-	magic_t cookie = magic_open(query_mime ? (MAGIC_MIME_TYPE | MAGIC_ERROR)
-		: MAGIC_ERROR);
-	if (!cookie)
+	const int c = query_mime ? 0 : 1;
+	if (magic_cookies_err[c] == 1)
 		return (char *)NULL;
 
-	magic_load(cookie, NULL);
+	if (!magic_cookies[c]) {
+		magic_cookies[c] = magic_open(query_mime
+			? (MAGIC_MIME_TYPE | MAGIC_ERROR) : MAGIC_ERROR);
+		if (!magic_cookies[c] || magic_load(magic_cookies[c], NULL) == -1) {
+			free_magic_cookies();
+			magic_cookies_err[c] = 1;
+			return (char *)NULL;
+		}
+	}
 
-	const char *mime = magic_file(cookie, file);
-	if (!mime) {
-		magic_close(cookie);
+	const char *mime = magic_file(magic_cookies[c], file);
+	if (!mime)
 		return (char *)NULL;
-	}
 
-	char *str = savestring(mime, strlen(mime));
-	magic_close(cookie);
-	return str;
+	return savestring(mime, strlen(mime));
 }
 
 #else /* _NO_MAGIC */
@@ -788,6 +938,138 @@ expand_app_fields(char ***cmd, size_t *n, char *fpath, int *exec_flags)
 	return f;
 }
 
+/* ---- Preview output cache ----
+ *
+ * When running as the finder's previewer ('clifm --preview FILE' with
+ * stdout read by fzf through a pipe), the previewing application is
+ * spawned once per keypress and its stdout is the whole pane content.
+ * Cache that output on disk, keyed by device, inode, mtime, size, pane
+ * geometry, and the previewing command, so that scrubbing back and
+ * forth over the same files replays the rendered preview instead of
+ * re-running converters. Applications that display out-of-band (e.g.
+ * scripts driving ueberzug) print nothing to stdout; empty output is
+ * never cached, so they are simply re-run each time. */
+
+/* Return the cache file name for previewing FILE with the command CMD,
+ * or NULL if the preview is not cacheable. */
+static char *
+get_preview_cache_file(char **cmd, const char *file)
+{
+	static char cache_file[PATH_MAX + 1];
+	struct stat a;
+
+	if (stat(file, &a) == -1 || !S_ISREG(a.st_mode))
+		return (char *)NULL;
+
+	char dir[PATH_MAX + 1];
+	snprintf(dir, sizeof(dir), "%s/%s-previews-%u",
+		tmp_dir ? tmp_dir : P_tmpdir, PROGRAM_NAME, (unsigned int)getuid());
+
+	struct stat b;
+	if (stat(dir, &b) == -1) {
+		if (xmkdir(dir, S_IRWXU) != FUNC_SUCCESS)
+			return (char *)NULL;
+	} else if (!S_ISDIR(b.st_mode) || b.st_uid != getuid()) {
+		/* Do not trust a directory we do not own. */
+		return (char *)NULL;
+	}
+
+	/* Converters consult the pane geometry exported by fzf. */
+	const char *pcols = getenv("FZF_PREVIEW_COLUMNS");
+	const char *plines = getenv("FZF_PREVIEW_LINES");
+
+	char key[PATH_MAX * 2];
+	size_t klen = (size_t)snprintf(key, sizeof(key), "%ju:%ju:%jd:%jd:%s:%s",
+		(uintmax_t)a.st_dev, (uintmax_t)a.st_ino, (intmax_t)a.st_mtime,
+		(intmax_t)a.st_size, pcols ? pcols : "", plines ? plines : "");
+
+	size_t i;
+	for (i = 0; cmd[i]; i++) {
+		const size_t l = strlen(cmd[i]);
+		if (klen + l + 2 >= sizeof(key))
+			break;
+		key[klen] = '\x1f'; /* Unit separator: args cannot contain it. */
+		memcpy(key + klen + 1, cmd[i], l + 1);
+		klen += l + 1;
+	}
+
+	/* Bound the directory component: 18 bytes are reserved for the
+	 * slash, the hash (at most 16 hex digits), and the terminating
+	 * NUL. DIR always fits (it is itself at most PATH_MAX bytes). */
+	snprintf(cache_file, sizeof(cache_file), "%.*s/%zx",
+		(int)(sizeof(cache_file) - 18), dir, hashme(key, 1));
+	return cache_file;
+}
+
+/* Copy the cached preview FILE to stdout. Returns FUNC_SUCCESS if the
+ * whole file was written, or FUNC_FAILURE otherwise. */
+static int
+dump_preview_cache(const char *file)
+{
+	const int fd = open(file, O_RDONLY);
+	if (fd == -1)
+		return FUNC_FAILURE;
+
+	char buf[PATH_MAX];
+	ssize_t n;
+
+	fflush(stdout);
+	while ((n = read(fd, buf, sizeof(buf))) > 0) {
+		if (write(STDOUT_FILENO, buf, (size_t)n) == -1)
+			break;
+	}
+
+	close(fd);
+	return n == 0 ? FUNC_SUCCESS : FUNC_FAILURE;
+}
+
+/* Run the previewing command CMD with stdout captured into the cache
+ * file CACHE_FILE, then emit the captured output. The capture is
+ * written to a temporary name and renamed only on success, so that
+ * concurrent preview processes never observe partial files. */
+static int
+run_preview_app_cached(char **cmd, const int exec_flags,
+	const char *cache_file)
+{
+	char tmp[PATH_MAX + 32];
+	snprintf(tmp, sizeof(tmp), "%s.%u", cache_file, (unsigned int)getpid());
+
+	const int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	const int stdout_bk = fd != -1 ? dup(STDOUT_FILENO) : -1;
+
+	if (fd == -1 || stdout_bk == -1) {
+		if (fd != -1) {
+			close(fd);
+			unlink(tmp);
+		}
+		return launch_execv(cmd, FOREGROUND, exec_flags);
+	}
+
+	fflush(stdout);
+	dup2(fd, STDOUT_FILENO);
+	close(fd);
+
+	const int ret = launch_execv(cmd, FOREGROUND, exec_flags);
+
+	fflush(stdout);
+	dup2(stdout_bk, STDOUT_FILENO);
+	close(stdout_bk);
+
+	struct stat a;
+	if (ret == FUNC_SUCCESS && stat(tmp, &a) == 0 && a.st_size > 0) {
+		/* Do not cache empty output: the application may display
+		 * out-of-band (see the note above). */
+		if (rename(tmp, cache_file) == 0) {
+			dump_preview_cache(cache_file);
+			return ret;
+		}
+	}
+
+	dump_preview_cache(tmp);
+	unlink(tmp);
+	return ret;
+}
+
 /* Open the file FPATH via the application APP */
 static int
 run_mime_app(char **app, char **fpath)
@@ -814,8 +1096,18 @@ run_mime_app(char **app, char **fpath)
 		n++;
 	}
 
-	const int ret = launch_execv(cmd, (bg_proc && !open_in_foreground)
-		? BACKGROUND : FOREGROUND, exec_flags);
+	int ret;
+	char *cache_file = (xargs.preview == 1 && bg_proc == 0
+		&& isatty(STDOUT_FILENO) == 0)
+		? get_preview_cache_file(cmd, *fpath) : (char *)NULL;
+
+	if (cache_file && dump_preview_cache(cache_file) == FUNC_SUCCESS)
+		ret = FUNC_SUCCESS;
+	else if (cache_file)
+		ret = run_preview_app_cached(cmd, exec_flags, cache_file);
+	else
+		ret = launch_execv(cmd, (bg_proc && !open_in_foreground)
+			? BACKGROUND : FOREGROUND, exec_flags);
 
 	for (i = 0; i < n; i++)
 		free(cmd[i]);
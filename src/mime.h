@@ -27,6 +27,10 @@
 
 __BEGIN_DECLS
 
+void free_mime_rules(void);
+#ifndef _NO_MAGIC
+void free_magic_cookies(void);
+#endif /* !_NO_MAGIC */
 int  mime_open(char **args);
 int  mime_open_url(char *url);
 int  mime_open_with(char *filename, char **args);
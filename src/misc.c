@@ -30,6 +30,8 @@
 #include "helpers.h"
 
 #include <errno.h>
+#include <fcntl.h> /* open(), O_DIRECTORY */
+#include <pthread.h> /* err() may run from startup-stage threads (init.c) */
 #include <signal.h>
 #include <stdarg.h>
 #include <stdio.h>
@@ -62,16 +64,30 @@ typedef char *rl_cpvfunc_t;
 #include "aux.h"
 #include "bookmarks.h"
 #include "checks.h"
+#include "candidates.h" /* candidates_invalidate(), candidates_free() */
 #include "file_operations.h"
 #include "history.h"
 #include "init.h"
+#include "ipc.h" /* ipc_stop() */
 #include "jump.h"
 #include "listing.h"
 #include "messages.h"
+#ifndef _NO_LIRA
+# include "mime.h" /* free_mime_rules() */
+#endif /* !_NO_LIRA */
 #include "navigation.h"
+#include "obuf.h" /* obuf_free() */
+#ifndef _NO_PROFILES
+# include "profiles.h" /* free_profile_states() */
+#endif /* !_NO_PROFILES */
 #include "readline.h"
 #include "remotes.h"
+#include "selection.h" /* free_sel_index() */
+#include "snapshot.h" /* save_session_snapshot() */
 #include "spawn.h"
+#ifndef _NO_TAGS
+# include "tags.h" /* tags_index_invalidate() */
+#endif /* !_NO_TAGS */
 
 char *
 gen_diff_str(const int diff)
@@ -221,10 +237,18 @@ err(const int msg_type, const int prompt_flag, const char *format, ...)
 	if (size < 0 || !buf || !*buf)
 		{free(buf); goto ERROR;}
 
+	/* The messages array is shared with the startup-stage threads
+	 * (see start_init_stages() in init.c). */
+	static pthread_mutex_t msgs_lock = PTHREAD_MUTEX_INITIALIZER;
+	pthread_mutex_lock(&msgs_lock);
+
 	/* If the new message is the same as the last message, skip it. */
 	if (msgs_n > 0 && msg_type != 'f' && *messages[msgs_n - 1] == *buf
-	&& strcmp(messages[msgs_n - 1], buf) == 0)
-		{free(buf); goto ERROR;}
+	&& strcmp(messages[msgs_n - 1], buf) == 0) {
+		pthread_mutex_unlock(&msgs_lock);
+		free(buf);
+		goto ERROR;
+	}
 
 	if (msg_type >= 'e') {
 		switch (msg_type) {
@@ -244,6 +268,7 @@ err(const int msg_type, const int prompt_flag, const char *format, ...)
 	}
 
 	log_msg(buf, prompt_flag, logme, add_to_msgs_list);
+	pthread_mutex_unlock(&msgs_lock);
 
 	free(buf);
 	errno = saved_errno;
@@ -342,6 +367,14 @@ read_inotify(void)
 	int ignore_event = 0;
 	int refresh = 0;
 
+	/* Collect event file names to attempt an incremental refresh of the
+	 * current list (update_dirlist()). Directory-level events and queue
+	 * overflows cannot be mapped to single file names: in these cases
+	 * fall back to a full reload. */
+	char *names[NUM_EVENT_SLOTS];
+	size_t names_n = 0;
+	int incremental = 1;
+
 	for (char *ptr = inotify_buf;
 	ptr + ((struct inotify_event *)ptr)->len < inotify_buf + i;
 	ptr += sizeof(struct inotify_event) + event->len) {
@@ -359,6 +392,13 @@ read_inotify(void)
 			break;
 		}
 
+		if ((event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED
+		| IN_Q_OVERFLOW | IN_UNMOUNT)) || event->len == 0
+		|| names_n >= NUM_EVENT_SLOTS)
+			incremental = 0;
+		else
+			names[names_n++] = savestring(event->name, strlen(event->name));
+
 		if (event->mask & IN_CREATE) {
 # ifdef INOTIFY_DEBUG
 			puts("IN_CREATE");
@@ -418,7 +458,10 @@ read_inotify(void)
 # ifdef INOTIFY_DEBUG
 		puts("INOTIFY_REFRESH");
 # endif /* INOTIFY_DEBUG */
-		reload_dirlist();
+		/* Try to patch the current list in place first: a full reload is
+		 * only performed if the changes cannot be applied incrementally. */
+		if (incremental == 0 || update_dirlist(names, names_n) != FUNC_SUCCESS)
+			reload_dirlist();
 	} else {
 # ifdef INOTIFY_DEBUG
 		puts("INOTIFY_RESET");
@@ -427,6 +470,10 @@ read_inotify(void)
 		reset_inotify();
 	}
 
+	size_t j = names_n;
+	while (j > 0)
+		free(names[--j]);
+
 	return;
 }
 #elif defined(BSD_KQUEUE)
@@ -487,6 +534,76 @@ set_filter_type(const char c)
 		filter.type = FILTER_FILE_NAME;
 }
 
+/* Extract the literal fast path from the current name filter: if
+ * filter.str is a plain substring (anchors and backslash-escaped
+ * metacharacters allowed), store the decoded string in filter.literal so
+ * the listing loop can match it with strncmp(3)/strstr(3) instead of
+ * regexec(3). Any other metacharacter leaves filter.literal unset and
+ * the compiled regex is used as usual. */
+void
+set_filter_literal(void)
+{
+	free(filter.literal);
+	filter.literal = (char *)NULL;
+	filter.literal_len = 0;
+	filter.anchor_start = filter.anchor_end = 0;
+
+	if (!filter.str || !*filter.str || filter.type != FILTER_FILE_NAME)
+		return;
+
+	const char *p = filter.str;
+	int anchor_start = 0;
+	if (*p == '^') {
+		anchor_start = 1;
+		p++;
+	}
+
+	char *lit = xnmalloc(strlen(p) + 1, sizeof(char));
+	size_t n = 0;
+	int anchor_end = 0;
+
+	while (*p) {
+		if (*p == '\\') {
+			p++;
+			/* Only escapes of metacharacters are taken literally:
+			 * anything else (\s, \w, ...) might be an extension. */
+			if (*p && strchr(".[]()*+?{}|^$\\", *p)) {
+				lit[n] = *p;
+				n++;
+				p++;
+				continue;
+			}
+			free(lit);
+			return;
+		}
+
+		if (*p == '$' && !p[1]) {
+			anchor_end = 1;
+			break;
+		}
+
+		if (strchr(".[]()*+?{}|^$", *p)) {
+			free(lit);
+			return;
+		}
+
+		lit[n] = *p;
+		n++;
+		p++;
+	}
+
+	if (n == 0) {
+		free(lit);
+		return;
+	}
+
+	lit[n] = '\0';
+	filter.literal = lit;
+	filter.literal_len = n;
+	filter.anchor_start = anchor_start;
+	filter.anchor_end = anchor_end;
+}
+
 static int
 unset_filter(void)
 {
@@ -500,6 +617,7 @@ unset_filter(void)
 	filter.rev = 0;
 	filter.type = FILTER_NONE;
 	regfree(&regex_exp);
+	set_filter_literal();
 
 	if (conf.autols == 1)
 		reload_dirlist();
@@ -541,6 +659,7 @@ compile_filter(void)
 			regfree(&regex_exp);
 			goto ERR;
 		}
+		set_filter_literal();
 	} else if (filter.type == FILTER_FILE_TYPE) {
 		if (validate_file_type_filter() != FUNC_SUCCESS) {
 			xerror("%s\n", _("ft: Invalid file type filter"));
@@ -563,6 +682,7 @@ ERR:
 	free(filter.str);
 	filter.str = (char *)NULL;
 	filter.type = FILTER_NONE;
+	set_filter_literal();
 	return FUNC_FAILURE;
 }
 
@@ -1036,6 +1156,7 @@ free_autocmds(void)
 	int i = (int)autocmds_n;
 	while (--i >= 0) {
 		free(autocmds[i].pattern);
+		free(autocmds[i].xpattern);
 		free(autocmds[i].cmd);
 		autocmds[i].color_scheme = (char *)NULL;
 	}
@@ -1048,6 +1169,10 @@ free_autocmds(void)
 void
 free_tags(void)
 {
+#ifndef _NO_TAGS
+	tags_index_invalidate();
+	candidates_invalidate(CAND_TAGS);
+#endif /* !_NO_TAGS */
 	int i = (int)tags_n;
 	while (--i >= 0)
 		free(tags[i]);
@@ -1062,6 +1187,8 @@ free_remotes(const int exit)
 	if (exit)
 		autounmount_remotes();
 
+	candidates_invalidate(CAND_REMOTES);
+
 	size_t i;
 	for (i = 0; i < remotes_n; i++) {
 		free(remotes[i].name);
@@ -1121,6 +1248,7 @@ expand_prompt_name(char *name)
 void
 free_prompts(void)
 {
+	candidates_invalidate(CAND_PROMPTS);
 	int i = (int)prompts_n;
 	while (--i >= 0) {
 		free(prompts[i].name);
@@ -1271,6 +1399,8 @@ free_stuff(void)
 {
 	int i = 0;
 
+	ipc_stop();
+
 	free(alt_config_dir);
 	free(alt_trash_dir);
 	free(alt_config_file);
@@ -1303,9 +1433,7 @@ free_stuff(void)
 #endif /* RUN_CMD */
 
 #if !defined(_NO_ICONS)
-	free(name_icons_hashes);
-	free(dir_icons_hashes);
-	free(ext_icons_hashes);
+	free_icons_hashes();
 #endif /* !_NO_ICONS */
 
 	free(conf.time_str);
@@ -1324,6 +1452,8 @@ free_stuff(void)
 		close(kq);
 #endif /* LINUX_INOTIFY */
 
+	save_session_snapshot();
+
 	free_prompts();
 	free(prompts_file);
 	free_autocmds();
@@ -1340,6 +1470,10 @@ free_stuff(void)
 	free(conf.encoded_prompt);
 /*	free(right_prompt); */
 	free_dirlist();
+	free_dircache();
+	stat_cache_free();
+	candidates_free();
+	obuf_free();
 	free(conf.opener);
 	free(conf.wprompt_str);
 	free(conf.fzftab_options);
@@ -1394,6 +1528,14 @@ free_stuff(void)
 		free(sel_elements);
 	}
 	free(sel_devino);
+	free_sel_index();
+	free_cmds_cache();
+#ifndef _NO_LIRA
+	free_mime_rules();
+# ifndef _NO_MAGIC
+	free_magic_cookies();
+# endif /* !_NO_MAGIC */
+#endif /* !_NO_LIRA */
 
 	if (bin_commands) {
 		i = (int)path_progsn;
@@ -1416,12 +1558,11 @@ free_stuff(void)
 		free(cdpaths);
 	}
 
-	if (history) {
-		i = (int)current_hist_n;
-		while (--i >= 0)
-			free(history[i].cmd);
-		free(history);
-	}
+	flush_cmdhist();
+	free_history();
+#ifndef _NO_PROFILES
+	free_profile_states();
+#endif /* !_NO_PROFILES */
 
 	if (dirhist_total_index) {
 		i = (int)dirhist_total_index;
@@ -1500,6 +1641,7 @@ free_stuff(void)
 	free(dirhist_file);
 	free(hist_file);
 	free(kbinds_file);
+	close_log_streams();
 	free(msgs_log_file);
 	free(cmds_log_file);
 	free(mime_file);
@@ -1679,8 +1821,15 @@ construct_name(char *file, const size_t flen)
 	return name;
 }
 
+/* Create, in the virtual directory open at DIRFD, a symlink to FILE
+ * (made absolute against CWD if needed). Return 1 if the link was
+ * created, or 0 otherwise.
+ * Linking via symlinkat(2) against a directory file descriptor opened
+ * once by the caller saves a full path resolution of the virtual
+ * directory per entry, which adds up when reading hundreds of thousands
+ * of file names from standard input. */
 static size_t
-gen_symlink(char *file, const char *cwd)
+gen_symlink(char *file, const char *cwd, const int dirfd)
 {
 	if (SELFORPARENT(file))
 		return 0;
@@ -1713,13 +1862,12 @@ gen_symlink(char *file, const char *cwd)
 		return 0;
 
 	char dest[PATH_MAX + 32];
-	snprintf(dest, sizeof(dest), "%s/%s", stdin_tmp_dir, name);
+	xstrsncpy(dest, name, sizeof(dest));
 
 	errno = 0;
 	int suffix = 1;
-	while (symlink(source, dest) == -1 && errno == EEXIST) {
-		snprintf(dest, sizeof(dest), "%s/%s-%d", stdin_tmp_dir,
-			name, suffix);
+	while (symlinkat(source, dirfd, dest) == -1 && errno == EEXIST) {
+		snprintf(dest, sizeof(dest), "%s-%d", name, suffix);
 		suffix++;
 		errno = 0;
 		if (suffix == INT_MAX) {
@@ -1732,7 +1880,8 @@ gen_symlink(char *file, const char *cwd)
 
 	if (errno != 0) {
 		err('w', PRINT_PROMPT, "%s: Cannot create symbolic "
-			"link '%s': %s\n", PROGRAM_NAME, dest, strerror(errno));
+			"link '%s/%s': %s\n", PROGRAM_NAME, stdin_tmp_dir, dest,
+			strerror(errno));
 		return 0;
 	}
 
@@ -1825,6 +1974,16 @@ handle_stdin(void)
 		goto FREE_N_EXIT;
 	}
 
+	/* Open the virtual directory once: gen_symlink() links against this
+	 * file descriptor instead of resolving the directory path per entry. */
+	const int dirfd = open(stdin_tmp_dir, O_RDONLY | O_DIRECTORY);
+	if (dirfd == -1) {
+		exit_status = errno;
+		xerror("%s: '%s': %s\n", PROGRAM_NAME, stdin_tmp_dir,
+			strerror(errno));
+		goto FREE_N_EXIT;
+	}
+
 	/* Get substrings from buf */
 	char *p = buf, *q = buf;
 	size_t links_counter = 0;
@@ -1834,13 +1993,15 @@ handle_stdin(void)
 			*p = '\0';
 
 			/* Create symlinks (in tmp dir) to each valid file in the buffer */
-			links_counter += gen_symlink(q, cwd);
+			links_counter += gen_symlink(q, cwd, dirfd);
 			q = p + 1;
 		}
 
 		p++;
 	}
 
+	close(dirfd);
+
 	if (links_counter == 0) { /* No symlink was created. Exit */
 		dup2(STDOUT_FILENO, STDIN_FILENO);
 		xerror(_("%s: Empty file names buffer. Nothing to do\n"), PROGRAM_NAME);
@@ -32,6 +32,7 @@
 #include "helpers.h"
 
 #include <stdio.h>
+#include <stdlib.h> /* qsort(3) */
 #include <unistd.h>
 #include <string.h>
 #include <time.h>
@@ -101,6 +102,99 @@ get_utf_8_width(const char c)
 	return 1;
 }
 
+/* Return 1 if NAME needs no cleaning at all, in which case
+ * clean_file_name() would return an identical string. This covers the
+ * vast majority of files on bulk runs with a single pass over the bytes,
+ * skipping the whole translation machinery. */
+static int
+name_is_clean(const char *name)
+{
+	const unsigned char *p = (const unsigned char *)name;
+	size_t len = 0;
+
+	for (; *p; p++, len++) {
+		const unsigned char c = *p;
+		if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')
+		|| (c >= 'A' && c <= 'Z') || c == '.' || c == '_' || c == '-'))
+			return 0;
+	}
+
+	/* Names clean_file_name() rewrites even if made of safe bytes only:
+	 * too short/long names, leading dash, and dot-dot. */
+	if (len < 2 || len > NAME_MAX || *name == '-'
+	|| (len == 2 && name[0] == '.' && name[1] == '.'))
+		return 0;
+
+	return 1;
+}
+
+/* Index into unitable (cleaner_table.h) sorted by codepoint, built on
+ * first use. The table itself is neither sorted nor free of duplicated
+ * keys: sorting is stabilized by original position, and for duplicates
+ * the first entry in table order wins, just as with the linear scan this
+ * index replaces. */
+static size_t *unitable_index = (size_t *)NULL;
+static size_t unitable_index_n = 0;
+
+static int
+cmp_unitable_index(const void *a, const void *b)
+{
+	const size_t ia = *(const size_t *)a;
+	const size_t ib = *(const size_t *)b;
+
+	if (unitable[ia].key != unitable[ib].key)
+		return (unitable[ia].key < unitable[ib].key ? -1 : 1);
+
+	return (ia < ib ? -1 : (ia > ib ? 1 : 0));
+}
+
+static void
+build_unitable_index(void)
+{
+	const size_t n = sizeof(unitable) / sizeof(struct utable_t);
+	unitable_index = xnmalloc(n, sizeof(size_t));
+
+	size_t i;
+	for (i = 0; i < n; i++)
+		unitable_index[i] = i;
+
+	qsort(unitable_index, n, sizeof(size_t), cmp_unitable_index);
+
+	size_t k = 0;
+	for (i = 0; i < n; i++) {
+		if (k > 0 && unitable[unitable_index[k - 1]].key
+		== unitable[unitable_index[i]].key)
+			continue;
+		unitable_index[k] = unitable_index[i];
+		k++;
+	}
+
+	unitable_index_n = k;
+}
+
+/* Return the ASCII translation for the Unicode codepoint KEY, or NULL if
+ * there is none. */
+static char *
+unitable_lookup(const int key)
+{
+	if (!unitable_index)
+		build_unitable_index();
+
+	size_t lo = 0, hi = unitable_index_n;
+	while (lo < hi) {
+		const size_t mid = lo + ((hi - lo) / 2);
+		if (unitable[unitable_index[mid]].key < key)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	if (lo < unitable_index_n && unitable[unitable_index[lo]].key == key)
+		return unitable[unitable_index[lo]].data;
+
+	return (char *)NULL;
+}
+
 /* Replace unsafe characters by safe, portable ones.
  * a-zA-Z0-9._- (Portable Filename Character Set) are kept
  * {[()]} are replaced by a dash (-)
@@ -183,14 +277,17 @@ clean_file_name(char *restrict name)
 	if (!name || !*name)
 		return (char *)NULL;
 
-	char *p = xcalloc(NAME_MAX + 1, sizeof(char));
-	char *q = p;
-
 	size_t i = 0, cur_len = 0, too_long = 0;
 
 	char *s = strrchr(name, '/');
 	i = s ? (size_t)(s - name) + 1 : 0;
 
+	if (name_is_clean(name + i) == 1)
+		return savestring(name + i, strlen(name + i));
+
+	char *p = xcalloc(NAME_MAX + 1, sizeof(char));
+	char *q = p;
+
 	unsigned char n = 0;
 	for (; (n = (unsigned char)name[i]); i++) {
 		if (cur_len > NAME_MAX) {
@@ -266,12 +363,7 @@ clean_file_name(char *restrict name)
 			continue;
 		}
 
-		int j = (int)(sizeof(unitable) / sizeof(struct utable_t));
-		char *t = (char *)NULL;
-		while (--j >= 0) {
-			if (dec_value == unitable[j].key && unitable[j].data)
-				t = unitable[j].data;
-		}
+		char *t = unitable_lookup(dec_value);
 
 		if (!t)
 			continue;
@@ -550,7 +550,7 @@ cd_function(char *new_path, const int cd_flag)
 
 	dir_changed = 1;
 	if (conf.autols == 1)
-		reload_dirlist();
+		switch_dirlist();
 
 	if (skip == 0)
 		add_to_jumpdb(workspaces[cur_ws].path);
@@ -575,6 +575,36 @@ xstrcpbrk(char *str, const char c)
 	return (char *)NULL;
 }
 
+/* Return the ancestor of the current directory LEVELS levels up, as a
+ * newly allocated string. The workspace path is already normalized, so
+ * the ancestor is just a prefix of it: no getcwd(2), stat(2), or
+ * normalize_path() involved. Returns NULL if the current directory is
+ * not available, in which case the caller falls back to
+ * normalize_path(). */
+static char *
+get_cwd_ancestor(const size_t levels)
+{
+	const char *cwd = (workspaces && cur_ws >= 0 && cur_ws < MAX_WS)
+		? workspaces[cur_ws].path : (char *)NULL;
+	if (!cwd || *cwd != '/')
+		return (char *)NULL;
+
+	const char *end = cwd + strlen(cwd);
+	size_t n = levels;
+
+	while (n > 0 && end > cwd) {
+		end--;
+		while (end > cwd && *end != '/')
+			end--;
+		n--;
+	}
+
+	if (end <= cwd) /* At the root directory */
+		return savestring("/", 1);
+
+	return savestring(cwd, (size_t)(end - cwd));
+}
+
 /* Convert "... n" into "../.. n"
  * and "../.. n" into the corresponding path. */
 char *
@@ -597,11 +627,22 @@ fastback(char *str)
 	}
 
 	if (dots <= 2) {
-		if (dots == 2)
-			return normalize_path("..", 2);
+		if (dots == 2) {
+			char *a = get_cwd_ancestor(1);
+			return a ? a : normalize_path("..", 2);
+		}
 		return (char *)NULL;
 	}
 
+	if (!rem) {
+		/* Pure dots: the target is an ancestor of the current directory.
+		 * Suggestions run this once per keystroke, so resolve it from
+		 * the workspace path instead of re-deriving it. */
+		char *a = get_cwd_ancestor(dots - 1);
+		if (a)
+			return a;
+	}
+
 	char q[PATH_MAX];
 	q[0] = '.';
 	q[1] = '.';
@@ -663,6 +704,7 @@ clear_dirhist(void)
 	while (--i >= 0)
 		free(old_pwd[i]);
 	dirhist_cur_index = dirhist_total_index = 0;
+	dirhist_index_invalidate();
 	add_to_dirhist(workspaces[cur_ws].path);
 
 	printf(_("%s: Directory history cleared\n"), PROGRAM_NAME);
@@ -737,7 +779,7 @@ set_path(const char *new_path)
 
 	dir_changed = 1;
 	if (conf.autols == 1)
-		reload_dirlist();
+		switch_dirlist();
 
 	return FUNC_SUCCESS;
 }
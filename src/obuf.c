@@ -0,0 +1,305 @@
+/* obuf.c -- batched output buffer for the files list */
+
+/*
+ * This file is part of CliFM
+ *
+ * Copyright (C) 2016-2024, L. Abramovich <leo.clifm@outlook.com>
+ * All rights reserved.
+
+ * CliFM is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * CliFM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+*/
+
+/* Printing the files list one cell at a time via stdio issues one
+ * write(2) per line on a line-buffered terminal, which is slow and tears
+ * visibly on big directories listed over remote connections. The
+ * listing printers (listing.c and long_view.c) append into the growable
+ * buffer implemented here instead, and flush it with as few writev(2)
+ * calls as possible once the whole list (or the current pager page) has
+ * been composed.
+ *
+ * The buffer is a chain of fixed-size blocks, so appending never copies
+ * what was already composed. obuf_flush() flushes stdout first: anything
+ * printed via stdio before the listing keeps its place in the output. */
+
+#include "helpers.h"
+
+#include <limits.h> /* IOV_MAX */
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/uio.h> /* writev(2) */
+
+#include "aux.h" /* xnmalloc() */
+
+#define OBUF_BLOCK_SIZE (64 * 1024)
+
+#ifndef IOV_MAX
+# define IOV_MAX 1024
+#endif /* !IOV_MAX */
+
+struct obuf_blk_t {
+	char *buf;
+	size_t size;
+	size_t len;
+	struct obuf_blk_t *next;
+};
+
+static struct obuf_blk_t *obuf_head = (struct obuf_blk_t *)NULL;
+static struct obuf_blk_t *obuf_cur = (struct obuf_blk_t *)NULL;
+
+static struct obuf_blk_t *
+obuf_new_blk(const size_t size)
+{
+	struct obuf_blk_t *blk = xnmalloc(1, sizeof(struct obuf_blk_t));
+	blk->buf = xnmalloc(size, sizeof(char));
+	blk->size = size;
+	blk->len = 0;
+	blk->next = (struct obuf_blk_t *)NULL;
+
+	return blk;
+}
+
+/* Return a write position guaranteed to have at least NEED bytes of
+ * room, opening a new block if the current one is too full. */
+static char *
+obuf_reserve(const size_t need)
+{
+	if (!obuf_head)
+		obuf_head = obuf_cur = obuf_new_blk(OBUF_BLOCK_SIZE);
+
+	if (obuf_cur->len + need > obuf_cur->size) {
+		const size_t size = need > OBUF_BLOCK_SIZE ? need : OBUF_BLOCK_SIZE;
+		obuf_cur->next = obuf_new_blk(size);
+		obuf_cur = obuf_cur->next;
+	}
+
+	return obuf_cur->buf + obuf_cur->len;
+}
+
+void
+obuf_putc(const char c)
+{
+	*obuf_reserve(1) = c;
+	obuf_cur->len++;
+}
+
+void
+obuf_puts(const char *s)
+{
+	if (!s || !*s)
+		return;
+
+	const size_t len = strlen(s);
+	memcpy(obuf_reserve(len), s, len);
+	obuf_cur->len += len;
+}
+
+void
+obuf_printf(const char *fmt, ...)
+{
+	va_list args;
+
+	/* Try to format into the room left in the current block. vsnprintf()
+	 * returns the length the output needs: if it did not fit, reserve
+	 * that much room and format again. */
+	char *p = obuf_reserve(1);
+	size_t avail = obuf_cur->size - obuf_cur->len;
+
+	va_start(args, fmt);
+	const int len = vsnprintf(p, avail, fmt, args);
+	va_end(args);
+
+	if (len <= 0)
+		return;
+
+	if ((size_t)len >= avail) {
+		p = obuf_reserve((size_t)len + 1);
+		avail = obuf_cur->size - obuf_cur->len;
+
+		va_start(args, fmt);
+		vsnprintf(p, avail, fmt, args);
+		va_end(args);
+	}
+
+	obuf_cur->len += (size_t)len;
+}
+
+/* ---- Pager row capture ----
+ * While enabled (only during pager sessions), every byte flushed to the
+ * screen is also stored as complete screen lines, so that the pager can
+ * redraw previous pages from memory instead of re-formatting entries
+ * (see pager_back_view() in listing.c). Only lines actually printed are
+ * kept: memory use is bounded by how far the user pages, not by the
+ * size of the listing. */
+
+static int cap_on = 0;
+static char **cap_lines = (char **)NULL;
+static size_t cap_n = 0;
+static size_t cap_alloc = 0;
+/* Bytes of the (incomplete) line after the last newline flushed. */
+static char *cap_pend = (char *)NULL;
+static size_t cap_pend_len = 0;
+
+static void
+obuf_capture(const char *buf, size_t len)
+{
+	while (len > 0) {
+		const char *nl = memchr(buf, '\n', len);
+		const size_t chunk = nl ? (size_t)(nl - buf) : len;
+
+		cap_pend = xnrealloc(cap_pend, cap_pend_len + chunk + 1, sizeof(char));
+		memcpy(cap_pend + cap_pend_len, buf, chunk);
+		cap_pend_len += chunk;
+
+		if (!nl)
+			return;
+
+		cap_pend[cap_pend_len] = '\0';
+		if (cap_n == cap_alloc) {
+			cap_alloc = cap_alloc == 0 ? 256 : cap_alloc * 2;
+			cap_lines = xnrealloc(cap_lines, cap_alloc, sizeof(char *));
+		}
+		cap_lines[cap_n] = cap_pend;
+		cap_n++;
+		cap_pend = (char *)NULL;
+		cap_pend_len = 0;
+
+		buf += chunk + 1;
+		len -= chunk + 1;
+	}
+}
+
+/* Discard the captured lines and disable capturing. */
+void
+obuf_capture_stop(void)
+{
+	size_t i;
+	for (i = 0; i < cap_n; i++)
+		free(cap_lines[i]);
+	free(cap_lines);
+	cap_lines = (char **)NULL;
+	cap_n = cap_alloc = 0;
+
+	free(cap_pend);
+	cap_pend = (char *)NULL;
+	cap_pend_len = 0;
+
+	cap_on = 0;
+}
+
+/* Start capturing flushed lines (dropping any previous capture). */
+void
+obuf_capture_start(void)
+{
+	obuf_capture_stop();
+	cap_on = 1;
+}
+
+size_t
+obuf_capture_lines(void)
+{
+	return cap_n;
+}
+
+const char *
+obuf_capture_line(const size_t n)
+{
+	return n < cap_n ? cap_lines[n] : "";
+}
+
+/* Write the whole buffer to STDOUT and reset it, keeping a single block
+ * allocated for the next listing. */
+void
+obuf_flush(void)
+{
+	if (!obuf_head)
+		return;
+
+	/* Anything printed via stdio up to this point (e.g. the division
+	 * line, or the pager prompt) must reach the terminal first. */
+	fflush(stdout);
+
+	if (cap_on == 1) {
+		struct obuf_blk_t *cb = obuf_head;
+		while (cb) {
+			obuf_capture(cb->buf, cb->len);
+			cb = cb->next;
+		}
+	}
+
+	struct obuf_blk_t *blk = obuf_head;
+	while (blk) {
+		struct iovec iov[IOV_MAX];
+		int iov_n = 0;
+
+		while (blk && iov_n < IOV_MAX) {
+			if (blk->len > 0) {
+				iov[iov_n].iov_base = blk->buf;
+				iov[iov_n].iov_len = blk->len;
+				iov_n++;
+			}
+			blk = blk->next;
+		}
+
+		ssize_t written = 0;
+		int i = 0;
+		while (i < iov_n) {
+			written = writev(STDOUT_FILENO, iov + i, iov_n - i);
+			if (written < 0)
+				break; /* As with stdio, output errors are not reported */
+
+			/* Skip fully written chunks, in case of a partial write */
+			while (i < iov_n && (size_t)written >= iov[i].iov_len) {
+				written -= (ssize_t)iov[i].iov_len;
+				i++;
+			}
+
+			if (i < iov_n && written > 0) {
+				iov[i].iov_base = (char *)iov[i].iov_base + written;
+				iov[i].iov_len -= (size_t)written;
+			}
+		}
+
+		if (written < 0)
+			break;
+	}
+
+	/* Reset: keep the head block, free the rest */
+	blk = obuf_head->next;
+	while (blk) {
+		struct obuf_blk_t *next = blk->next;
+		free(blk->buf);
+		free(blk);
+		blk = next;
+	}
+
+	obuf_head->len = 0;
+	obuf_head->next = (struct obuf_blk_t *)NULL;
+	obuf_cur = obuf_head;
+}
+
+void
+obuf_free(void)
+{
+	obuf_flush();
+
+	if (obuf_head) {
+		free(obuf_head->buf);
+		free(obuf_head);
+		obuf_head = obuf_cur = (struct obuf_blk_t *)NULL;
+	}
+}
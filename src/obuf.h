@@ -0,0 +1,42 @@
+/* obuf.h */
+
+/*
+ * This file is part of CliFM
+ *
+ * Copyright (C) 2016-2024, L. Abramovich <leo.clifm@outlook.com>
+ * All rights reserved.
+
+ * CliFM is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * CliFM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+*/
+
+#ifndef OBUF_H
+#define OBUF_H
+
+__BEGIN_DECLS
+
+void obuf_putc(const char c);
+void obuf_puts(const char *s);
+void obuf_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+void obuf_flush(void);
+void obuf_free(void);
+void obuf_capture_start(void);
+void obuf_capture_stop(void);
+size_t obuf_capture_lines(void);
+const char *obuf_capture_line(const size_t n);
+
+__END_DECLS
+
+#endif /* OBUF_H */
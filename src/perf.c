@@ -0,0 +1,219 @@
+/* perf.c */
+
+/* DESCRIPTION: lightweight hot-path instrumentation, controlled via the
+ * 'perf' command. When enabled, the phases listed in perf.h (directory
+ * scan, sorting, printing, suggestions, tab completion, and command
+ * execution) are timed with monotonic counters, and 'perf' prints a
+ * per-phase breakdown table. When disabled (the default), the probes
+ * amount to a single integer check. */
+
+/*
+ * This file is part of CliFM
+ *
+ * Copyright (C) 2016-2024, L. Abramovich <leo.clifm@outlook.com>
+ * All rights reserved.
+
+ * CliFM is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * CliFM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+*/
+
+#include "helpers.h"
+
+#include <stdio.h>  /* printf, puts */
+#include <string.h> /* strcmp */
+#include <time.h>   /* clock_gettime(2) */
+
+#include "messages.h" /* PERF_USAGE */
+#include "perf.h"
+
+/* 1 if instrumentation is enabled (see perf_function()) */
+static int perf_on = 0;
+
+/* Per-phase accumulated nanoseconds, number of samples, start timestamp,
+ * and nesting depth (e.g. exec_cmd() may re-enter itself via aliases: only
+ * the outermost call is timed). */
+static long long perf_ns[PERF_PHASES_N];
+static size_t perf_calls[PERF_PHASES_N];
+static struct timespec perf_ts[PERF_PHASES_N];
+static int perf_depth[PERF_PHASES_N];
+
+/* Per-phase ring of the most recent individual samples, backing the P50
+ * and P99 columns of the table (see misc/tools/perf-replay.py). 2048
+ * samples cover minutes of interactive work with bounded memory. */
+#define PERF_SAMPLES_N 2048
+static long long perf_samples[PERF_PHASES_N][PERF_SAMPLES_N];
+
+static const char *perf_phase_name[PERF_PHASES_N] = {
+	"Dir scan (stat/entry info)",
+	"File list sorting",
+	"List printing",
+	"Suggestions",
+	"Tab completion",
+	"Command execution",
+};
+
+/* Start timing PHASE. A no-op if instrumentation is disabled or if PHASE
+ * is already being timed (nested call). */
+void
+perf_begin(const int phase)
+{
+	if (perf_on == 0)
+		return;
+
+	perf_depth[phase]++;
+	if (perf_depth[phase] > 1)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &perf_ts[phase]);
+}
+
+/* Stop timing PHASE and accumulate the elapsed time. A no-op if no
+ * matching perf_begin() was issued (e.g. instrumentation was enabled in
+ * the middle of a phase). */
+void
+perf_end(const int phase)
+{
+	if (perf_depth[phase] == 0)
+		return;
+
+	perf_depth[phase]--;
+	if (perf_depth[phase] > 0)
+		return;
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	const long long ns =
+		(now.tv_sec - perf_ts[phase].tv_sec) * 1000000000LL
+		+ (now.tv_nsec - perf_ts[phase].tv_nsec);
+
+	perf_ns[phase] += ns;
+	perf_samples[phase][perf_calls[phase] % PERF_SAMPLES_N] = ns;
+	perf_calls[phase]++;
+}
+
+static int
+cmp_samples(const void *a, const void *b)
+{
+	const long long na = *(const long long *)a;
+	const long long nb = *(const long long *)b;
+	return na < nb ? -1 : (na > nb ? 1 : 0);
+}
+
+/* Return the PCT-th percentile of the first N entries of SORTED
+ * (nearest-rank on a zero-based index). */
+static long long
+perf_percentile(const long long *sorted, const size_t n, const size_t pct)
+{
+	return sorted[(n - 1) * pct / 100];
+}
+
+static void
+perf_reset_counters(void)
+{
+	size_t i;
+	for (i = 0; i < PERF_PHASES_N; i++) {
+		perf_ns[i] = 0;
+		perf_calls[i] = 0;
+		perf_depth[i] = 0;
+	}
+}
+
+/* Print the per-phase breakdown table. Percentages are relative to the
+ * total instrumented time, not to wall-clock time: idle time (waiting for
+ * keyboard input) is not instrumented. */
+static int
+print_perf_table(void)
+{
+	printf(_("Instrumentation is %s\n"),
+		perf_on == 1 ? _("enabled") : _("disabled (run 'perf on')"));
+
+	long long total = 0;
+	size_t i;
+	for (i = 0; i < PERF_PHASES_N; i++)
+		total += perf_ns[i];
+
+	if (total == 0) {
+		puts(_("No samples collected yet"));
+		return FUNC_SUCCESS;
+	}
+
+	printf(_("\n%-27s %8s %12s %10s %10s %10s %6s\n"),
+		_("Phase"), _("Calls"), _("Total (ms)"), _("Mean (us)"),
+		_("P50 (us)"), _("P99 (us)"), "%");
+
+	for (i = 0; i < PERF_PHASES_N; i++) {
+		if (perf_calls[i] == 0)
+			continue;
+
+		/* Percentiles come from the (bounded) ring of most recent
+		 * samples: under sustained load they describe recent behavior,
+		 * not the whole run. */
+		long long sorted[PERF_SAMPLES_N];
+		const size_t n = perf_calls[i] < PERF_SAMPLES_N
+			? perf_calls[i] : PERF_SAMPLES_N;
+		memcpy(sorted, perf_samples[i], n * sizeof(long long));
+		qsort(sorted, n, sizeof(long long), cmp_samples);
+
+		printf("%-27s %8zu %12.3f %10.1f %10.1f %10.1f %6.1f\n",
+			_(perf_phase_name[i]),
+			perf_calls[i], (double)perf_ns[i] / 1000000.0,
+			(double)perf_ns[i] / (double)perf_calls[i] / 1000.0,
+			(double)perf_percentile(sorted, n, 50) / 1000.0,
+			(double)perf_percentile(sorted, n, 99) / 1000.0,
+			(double)perf_ns[i] * 100.0 / (double)total);
+	}
+
+	return FUNC_SUCCESS;
+}
+
+/* Handle the 'perf' command: 'perf on/off' toggles instrumentation,
+ * 'perf reset' clears the counters, and plain 'perf' prints the current
+ * per-phase breakdown. */
+int
+perf_function(char **args)
+{
+	if (args && args[0] && IS_HELP(args[0])) {
+		puts(_(PERF_USAGE));
+		return FUNC_SUCCESS;
+	}
+
+	if (!args || !args[0])
+		return print_perf_table();
+
+	if (strcmp(args[0], "on") == 0) {
+		if (perf_on == 0) {
+			perf_on = 1;
+			perf_reset_counters();
+		}
+		puts(_("perf: Instrumentation enabled"));
+		return FUNC_SUCCESS;
+	}
+
+	if (strcmp(args[0], "off") == 0) {
+		perf_on = 0;
+		puts(_("perf: Instrumentation disabled"));
+		return FUNC_SUCCESS;
+	}
+
+	if (strcmp(args[0], "reset") == 0) {
+		perf_reset_counters();
+		puts(_("perf: Counters cleared"));
+		return FUNC_SUCCESS;
+	}
+
+	fprintf(stderr, "%s\n", _(PERF_USAGE));
+	return FUNC_FAILURE;
+}
@@ -0,0 +1,45 @@
+/* perf.h */
+
+/*
+ * This file is part of CliFM
+ *
+ * Copyright (C) 2016-2024, L. Abramovich <leo.clifm@outlook.com>
+ * All rights reserved.
+
+ * CliFM is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * CliFM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+*/
+
+#ifndef PERF_H
+#define PERF_H
+
+/* Instrumented hot-path phases */
+#define PERF_LIST_SCAN  0 /* Dir scan: readdir(3), stat(2), entry info (listing.c) */
+#define PERF_LIST_SORT  1 /* File list sorting (listing.c) */
+#define PERF_LIST_PRINT 2 /* Columns/long view printing (listing.c) */
+#define PERF_SUGGEST    3 /* Suggestions (suggestions.c) */
+#define PERF_TABCOMP    4 /* Tab completion (tabcomp.c) */
+#define PERF_EXEC       5 /* Command dispatch/execution (exec.c) */
+#define PERF_PHASES_N   6
+
+__BEGIN_DECLS
+
+void perf_begin(const int phase);
+void perf_end(const int phase);
+int  perf_function(char **args);
+
+__END_DECLS
+
+#endif /* PERF_H */
@@ -33,6 +33,7 @@
 #include <readline/history.h>
 
 #include "aux.h"
+#include "candidates.h" /* candidates_invalidate() */
 #include "bookmarks.h"
 #include "checks.h"
 #include "config.h"
@@ -52,6 +53,8 @@
 int
 get_profile_names(void)
 {
+	candidates_invalidate(CAND_PROFILES);
+
 	if (!config_dir_gral)
 		return FUNC_FAILURE;
 
@@ -102,6 +105,126 @@ get_profile_names(void)
 	return FUNC_SUCCESS;
 }
 
+/* Keep the parsed state of recently used profiles resident in memory, so
+ * that switching back to one of them is mostly a pointer swap instead of
+ * a re-read and re-parse of its history, jump database, and directory
+ * history (the heavy part of a switch with large per-profile state).
+ * Config files themselves are still re-parsed: init_config() wires too
+ * many interdependent globals for a safe swap, and they are small. */
+#define PF_CACHE_MAX 4
+
+struct pf_state_t {
+	char *name; /* Profile name ("default" if alt_profile is unset) */
+	struct hist_state_t hist; /* Command history (see history.c) */
+	struct jump_t *jump_db;
+	size_t jump_n;
+	char **old_pwd; /* Directory history */
+	int dirhist_total;
+	size_t tick; /* Last-use stamp (for LRU eviction) */
+};
+
+static struct pf_state_t pf_cache[PF_CACHE_MAX];
+static size_t pf_cache_tick = 0;
+
+static void
+pf_state_free(struct pf_state_t *s)
+{
+	free(s->name);
+	hist_state_free(&s->hist);
+
+	if (s->jump_db) {
+		size_t i;
+		for (i = 0; s->jump_db[i].path; i++)
+			free(s->jump_db[i].path);
+		free(s->jump_db);
+	}
+
+	int i = s->dirhist_total;
+	while (--i >= 0)
+		free(s->old_pwd[i]);
+	free(s->old_pwd);
+
+	memset(s, '\0', sizeof(*s));
+}
+
+/* Free all resident profile states. Used by free_stuff(). */
+void
+free_profile_states(void)
+{
+	int i = PF_CACHE_MAX;
+	while (--i >= 0) {
+		if (pf_cache[i].name)
+			pf_state_free(&pf_cache[i]);
+	}
+}
+
+/* Move the current profile's parsed state into the resident cache,
+ * clearing the corresponding globals, so that the regular teardown and
+ * reload paths find nothing to free. The least recently used slot is
+ * evicted if the cache is full. */
+static void
+pf_state_stash(void)
+{
+	const char *name = alt_profile ? alt_profile : "default";
+	struct pf_state_t *slot = (struct pf_state_t *)NULL;
+	int i = PF_CACHE_MAX;
+
+	while (--i >= 0) {
+		if (!pf_cache[i].name) {
+			slot = &pf_cache[i];
+		} else if (strcmp(pf_cache[i].name, name) == 0) {
+			pf_state_free(&pf_cache[i]); /* Stale entry: reuse the slot */
+			slot = &pf_cache[i];
+			break;
+		}
+	}
+
+	if (!slot) { /* Cache full: evict the least recently used slot */
+		slot = &pf_cache[0];
+		for (i = 1; i < PF_CACHE_MAX; i++) {
+			if (pf_cache[i].tick < slot->tick)
+				slot = &pf_cache[i];
+		}
+		pf_state_free(slot);
+	}
+
+	slot->name = savestring(name, strlen(name));
+	slot->tick = ++pf_cache_tick;
+
+	hist_state_stash(&slot->hist);
+
+	slot->jump_db = jump_db;
+	slot->jump_n = jump_n;
+	jump_db = (struct jump_t *)NULL;
+	jump_n = 0;
+
+	slot->old_pwd = old_pwd;
+	slot->dirhist_total = dirhist_total_index;
+	old_pwd = (char **)NULL;
+	dirhist_total_index = 0;
+	dirhist_index_invalidate();
+}
+
+/* If PROF's state is resident in the cache, move it into *S and empty
+ * the slot. Returns 1 if found, or 0 otherwise. */
+static int
+pf_state_take(const char *prof, struct pf_state_t *s)
+{
+	int i = PF_CACHE_MAX;
+	while (--i >= 0) {
+		if (!pf_cache[i].name || strcmp(pf_cache[i].name, prof) != 0)
+			continue;
+
+		*s = pf_cache[i];
+		memset(&pf_cache[i], '\0', sizeof(pf_cache[i]));
+		free(s->name);
+		s->name = (char *)NULL;
+		return 1;
+	}
+
+	return 0;
+}
+
 /* Check if NAME is an existing profile name.
  * If true, returns the index of the profile in the PROFILE_NAMES array.
  * Otherwise, returns -1. */
@@ -146,6 +269,12 @@ profile_set(const char *prof)
 
 	int i;
 
+	/* Keep the current profile's parsed state resident, and check
+	 * whether the target profile's state is already resident. */
+	struct pf_state_t res;
+	pf_state_stash();
+	const int resident = pf_state_take(prof, &res);
+
 	if (conf.restore_last_path == 1)
 		save_last_path(NULL);
 
@@ -194,36 +323,69 @@ profile_set(const char *prof)
 
 	exec_profile();
 
+	if (resident == 1) {
+		/* Replace the just-reloaded jump database and directory history
+		 * with the resident versions, which also carry whatever was not
+		 * yet written to disk. */
+		if (jump_db) {
+			for (i = 0; jump_db[i].path; i++)
+				free(jump_db[i].path);
+			free(jump_db);
+		}
+		jump_db = res.jump_db;
+		jump_n = res.jump_n;
+
+		i = dirhist_total_index;
+		while (--i >= 0)
+			free(old_pwd[i]);
+		free(old_pwd);
+		old_pwd = res.old_pwd;
+		dirhist_total_index = res.dirhist_total;
+		dirhist_cur_index = dirhist_total_index - 1;
+		dirhist_index_invalidate();
+	}
+
 	if (config_ok == 1) {
 		/* Shrink the log file if needed */
+		close_log_streams();
 		truncate_file(msgs_log_file, conf.max_log, 0);
 		truncate_file(cmds_log_file, conf.max_log, 0);
 
 		/* Reset history */
-		if (access(hist_file, F_OK | W_OK) == 0) {
-			clear_history(); /* This is for readline */
-			read_history(hist_file);
-			history_truncate_file(hist_file, conf.max_hist);
+		if (resident == 1) {
+			/* Fast path: swap in the resident history instead of
+			 * re-reading the history file. */
+			hist_state_restore(&res.hist);
 		} else {
-			int fd = 0;
-			FILE *hist_fp = open_fwrite(hist_file, &fd);
-			if (hist_fp) {
-				fputs("edit\n", hist_fp);
-				fclose(hist_fp);
+			if (access(hist_file, F_OK | W_OK) == 0) {
+				clear_history(); /* This is for readline */
+				read_history(hist_file);
+				history_truncate_file(hist_file, conf.max_hist);
 			} else {
-				err('w', PRINT_PROMPT, _("pf: Error opening the "
-					"history file\n"));
+				int fd = 0;
+				FILE *hist_fp = open_fwrite(hist_file, &fd);
+				if (hist_fp) {
+					fputs("edit\n", hist_fp);
+					fclose(hist_fp);
+				} else {
+					err('w', PRINT_PROMPT, _("pf: Error opening the "
+						"history file\n"));
+				}
 			}
-		}
 
-		get_history(); /* This is only for us */
+			get_history(); /* This is only for us */
+		}
+	} else if (resident == 1) {
+		hist_state_free(&res.hist);
 	}
 
 	free_bookmarks();
 	load_bookmarks();
 	load_actions();
 
-	/* Reload PATH commands (actions are profile specific) */
+	/* Reload PATH commands (actions, as well as the commands cache
+	 * file, are profile specific) */
+	free_cmds_cache();
 	if (bin_commands) {
 		for (i = 0; bin_commands[i]; i++)
 			free(bin_commands[i]);
@@ -27,6 +27,7 @@
 
 __BEGIN_DECLS
 
+void free_profile_states(void);
 int get_profile_names(void);
 int profile_function(char **args);
 int profile_set(const char *prof);
@@ -48,6 +48,7 @@
 #include "prompt.h"
 #include "sanitize.h"
 #include "spawn.h"
+#include "tabcomp.h" /* flush_tab_comp_cache() */
 #ifndef _NO_SUGGESTIONS
 # include "suggestions.h"
 #endif /* !_NO_SUGGESTIONS */
@@ -339,8 +340,39 @@ gen_shell_name(void)
 	return savestring("unknown", 7);
 }
 
+/* Set by prompt() while the prompt string is merely being refreshed
+ * (PROMPT_UPDATE): command substitutions reuse their cached output in
+ * this case (see substitute_cmd()). */
+static int prompt_refreshing = 0;
+
+/* Append SRC (SRC_LEN bytes) to the decoded prompt buffer *RES, keeping
+ * the buffer length *LEN and its allocated capacity *CAP up to date.
+ * The buffer grows geometrically, so that decoding a prompt performs a
+ * couple of allocations instead of one realloc per segment or literal
+ * character. */
+static void
+append_str(const char *src, const size_t src_len, char **res,
+	size_t *len, size_t *cap)
+{
+	const size_t need = *len + src_len + 3 + (wrong_cmd
+		? (MAX_COLOR + 6) : 0);
+
+	if (need > *cap) {
+		if (*cap == 0)
+			*cap = 64;
+		while (*cap < need)
+			*cap <<= 1;
+		*res = xnrealloc(*res, *cap, sizeof(char));
+	}
+
+	memcpy(*res + *len, src, src_len);
+	*len += src_len;
+	(*res)[*len] = '\0';
+}
+
 static inline void
-add_string(char **tmp, const int c, char **line, char **res, size_t *len)
+add_string(char **tmp, const int c, char **line, char **res,
+	size_t *len, size_t *cap)
 {
 	if (!*tmp)
 		return;
@@ -348,17 +380,7 @@ add_string(char **tmp, const int c, char **line, char **res, size_t *len)
 	if (c)
 		(*line)++;
 
-	*len += strlen(*tmp);
-
-	const size_t l = *len + 2 + (wrong_cmd ? (MAX_COLOR + 6) : 0);
-	if (!*res) {
-		*res = xnmalloc(l + 1, sizeof(char));
-		*(*res) = '\0';
-	} else {
-		*res = xnrealloc(*res, l + 1, sizeof(char));
-	}
-
-	xstrncat(*res, strlen(*res), *tmp, l + 1);
+	append_str(*tmp, strlen(*tmp), res, len, cap);
 	free(*tmp);
 }
 
@@ -372,8 +394,24 @@ reset_ifs(const char *value)
 		unsetenv("IFS");
 }
 
+/* Cache of command substitution results: one entry per distinct $(CMD)
+ * occurrence in the prompt line, storing the output produced in CWD.
+ * When the prompt is merely being refreshed (PROMPT_REFRESHING is set by
+ * prompt() for the PROMPT_UPDATE flag), the cached output is reused
+ * instead of forking a shell again, just as run_prompt_cmds() does not
+ * re-run prompt commands for mere refreshes. A regular prompt (i.e.
+ * after a command) always re-runs the substitution. */
+struct subst_cache_t {
+	char *cmd; /* The substitution itself: "$(CMD)" */
+	char *cwd; /* Directory the output was produced in */
+	char *out; /* The produced output */
+};
+
+static struct subst_cache_t *subst_cache = (struct subst_cache_t *)NULL;
+static size_t subst_cache_n = 0;
+
 static inline void
-substitute_cmd(char **line, char **res, size_t *len)
+substitute_cmd(char **line, char **res, size_t *len, size_t *cap)
 {
 	const int tmp = strcntchr(*line, ')');
 	if (tmp == -1) return; /* No ending bracket */
@@ -385,6 +423,25 @@ substitute_cmd(char **line, char **res, size_t *len)
 	tmp_str[tmp + 2] = '\0';
 	*line += tmp + 1;
 
+	const char *cwd = workspaces[cur_ws].path ? workspaces[cur_ws].path : "";
+
+	struct subst_cache_t *sc = (struct subst_cache_t *)NULL;
+	size_t j;
+	for (j = 0; j < subst_cache_n; j++) {
+		if (*tmp_str == *subst_cache[j].cmd
+		&& strcmp(tmp_str, subst_cache[j].cmd) == 0) {
+			sc = &subst_cache[j];
+			break;
+		}
+	}
+
+	if (prompt_refreshing == 1 && sc && sc->out
+	&& strcmp(sc->cwd, cwd) == 0) {
+		append_str(sc->out, strlen(sc->out), res, len, cap);
+		free(tmp_str);
+		return;
+	}
+
 	const char *old_value = getenv("IFS");
 	setenv("IFS", "", 1);
 
@@ -395,22 +452,33 @@ substitute_cmd(char **line, char **res, size_t *len)
 		return;
 	}
 	reset_ifs(old_value);
-	free(tmp_str);
 
+	const size_t out_start = *len;
 	if (wordbuf.we_wordc) {
-		for (size_t j = 0; j < wordbuf.we_wordc; j++) {
-			*len += strlen(wordbuf.we_wordv[j]);
-			if (!*res) {
-				*res = xnmalloc(*len + 2, sizeof(char));
-				*(*res) = '\0';
-			} else {
-				*res = xnrealloc(*res, *len + 2, sizeof(char));
-			}
-			xstrncat(*res, strlen(*res), wordbuf.we_wordv[j], *len + 2);
-		}
+		for (j = 0; j < wordbuf.we_wordc; j++)
+			append_str(wordbuf.we_wordv[j],
+				strlen(wordbuf.we_wordv[j]), res, len, cap);
 	}
 
 	wordfree(&wordbuf);
+
+	/* Store the produced output in the cache */
+	if (!sc) {
+		subst_cache = xnrealloc(subst_cache, subst_cache_n + 1,
+			sizeof(struct subst_cache_t));
+		sc = &subst_cache[subst_cache_n];
+		subst_cache_n++;
+		sc->cmd = tmp_str;
+		tmp_str = (char *)NULL;
+	} else {
+		free(sc->cwd);
+		free(sc->out);
+	}
+
+	sc->cwd = savestring(cwd, strlen(cwd));
+	sc->out = savestring(*res ? *res + out_start : "", *len - out_start);
+
+	free(tmp_str);
 	return;
 }
 #endif /* !__HAIKU__ && !__OpenBSD__ && !__ANDROID__ */
@@ -547,7 +615,7 @@ decode_prompt(char *line)
 
 	char *temp = (char *)NULL;
 	char *result = (char *)NULL;
-	size_t result_len = 0;
+	size_t result_len = 0, result_cap = 0;
 	int c;
 
 	while ((c = *line++)) {
@@ -665,7 +733,8 @@ decode_prompt(char *line)
 				temp[1] = (char)c;
 
 ADD_STRING:
-				add_string(&temp, c, &line, &result, &result_len);
+				add_string(&temp, c, &line, &result, &result_len,
+					&result_cap);
 				break;
 			}
 		}
@@ -680,17 +749,13 @@ ADD_STRING:
 #if !defined(__HAIKU__) && !defined(__OpenBSD__) && !defined(__ANDROID__)
 			/* Command substitution */
 			if (c == '$' && *line == '(') {
-				substitute_cmd(&line, &result, &result_len);
+				substitute_cmd(&line, &result, &result_len, &result_cap);
 				continue;
 			}
 #endif /* !__HAIKU__ && !__OpenBSD__ && !__ANDROID__ */
 
-			const size_t new_len = result_len + 2
-				+ (wrong_cmd ? (MAX_COLOR + 6) : 0);
-			result = xnrealloc(result, new_len, sizeof(char));
-			result[result_len] = (char)c;
-			result_len++;
-			result[result_len] = '\0';
+			const char ch = (char)c;
+			append_str(&ch, 1, &result, &result_len, &result_cap);
 		}
 	}
 
@@ -1049,8 +1114,15 @@ handle_empty_line(void)
 {
 	if (conf.autols == 1 && ((flags & DELAYED_REFRESH)
 	|| xargs.refresh_on_empty_line == 1) && rl_pending_input == 0) {
+		/* A pending DELAYED_REFRESH alone means the terminal was
+		 * resized: the list is up to date and only needs relaying out. */
+		const int resize_only = (flags & DELAYED_REFRESH)
+			&& xargs.refresh_on_empty_line != 1;
 		flags &= ~DELAYED_REFRESH;
-		refresh_screen();
+		if (resize_only)
+			resize_dirlist();
+		else
+			refresh_screen();
 	} else {
 		flags &= ~DELAYED_REFRESH;
 	}
@@ -1068,7 +1140,9 @@ prompt(const int prompt_flag)
 
 	/* Generate the prompt string using the prompt line in the config
 	 * file (stored in encoded_prompt at startup). */
+	prompt_refreshing = (prompt_flag == PROMPT_UPDATE);
 	char *decoded_prompt = decode_prompt(conf.encoded_prompt);
+	prompt_refreshing = 0;
 	char *the_prompt = construct_prompt(decoded_prompt
 		? decoded_prompt : EMERGENCY_PROMPT);
 	free(decoded_prompt);
@@ -1090,6 +1164,10 @@ prompt(const int prompt_flag)
 
 	UNHIDE_CURSOR;
 
+	/* A new input line invalidates the completion cache: any command
+	 * run since the last one may have changed what TAB would return. */
+	flush_tab_comp_cache();
+
 	/* Print the prompt and get user input */
 	char *input = readline(the_prompt);
 	free(the_prompt);
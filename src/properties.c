@@ -33,6 +33,7 @@
 #include "helpers.h"
 
 #include <errno.h>
+#include <pthread.h> /* bulk stat phase (see bulk_stat_run()) */
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
@@ -1853,7 +1854,7 @@ print_dir_info(const char *dir, const int file_perm)
  * instead of just 'p', symbolic links are followed and directories size is
  * calculated recursively. */
 static int
-do_stat(char *filename, const int follow_link)
+do_stat(char *filename, const int follow_link, const struct stat *cached)
 {
 	if (!filename || !*filename)
 		return FUNC_FAILURE;
@@ -1862,9 +1863,16 @@ do_stat(char *filename, const int follow_link)
 	if (*filename == '.' && *(filename + 1) == '/' && *(filename + 2))
 		filename += 2;
 
-	/* Check file existence. */
+	/* Check file existence (CACHED, if set, comes from the bulk stat
+	 * phase: see bulk_stat_run()). */
 	struct stat attr;
-	int ret = lstat(filename, &attr);
+	int ret;
+	if (cached) {
+		attr = *cached;
+		ret = 0;
+	} else {
+		ret = lstat(filename, &attr);
+	}
 
 	char link_target[PATH_MAX + 1]; *link_target = '\0';
 	if (follow_link == 1 && ret != -1 && S_ISLNK(attr.st_mode)) {
@@ -1927,6 +1935,70 @@ do_stat(char *filename, const int follow_link)
 	return FUNC_SUCCESS;
 }
 
+/* Bulk stat phase
+ *
+ * When 'p' is run over a long ELN range, the per-file lstat(2) calls are
+ * performed upfront by a few worker threads (same striding scheme as the
+ * listing's parallel stat phase), and do_stat() then formats from the
+ * pre-fetched buffers. Formatting itself stays serial: it writes to the
+ * terminal in input order. */
+
+#define BULK_STAT_MIN     64 /* Use worker threads for at least this many */
+#define BULK_STAT_THREADS 4
+
+struct bulk_stat_t {
+	char **names;
+	struct stat *attrs;
+	int *errs;
+	size_t n;
+	size_t id;
+	size_t nthreads;
+};
+
+static void *
+bulk_stat_worker(void *arg)
+{
+	struct bulk_stat_t *w = (struct bulk_stat_t *)arg;
+
+	size_t i;
+	for (i = w->id; i < w->n; i += w->nthreads)
+		w->errs[i] = (lstat(w->names[i], &w->attrs[i]) == -1);
+
+	return NULL;
+}
+
+/* Stat the N files in ARGS in parallel, storing results in ATTRS and
+ * per-file error flags in ERRS. */
+static void
+bulk_stat_run(char **args, struct stat *attrs, int *errs, const size_t n)
+{
+	pthread_t threads[BULK_STAT_THREADS];
+	struct bulk_stat_t workers[BULK_STAT_THREADS];
+	size_t nthreads = 0;
+
+	size_t t;
+	for (t = 0; t < BULK_STAT_THREADS; t++) {
+		workers[t] = (struct bulk_stat_t){args, attrs, errs, n, t,
+			BULK_STAT_THREADS};
+		if (pthread_create(&threads[t], NULL, bulk_stat_worker,
+		&workers[t]) != 0)
+			break;
+		nthreads++;
+	}
+
+	if (nthreads < BULK_STAT_THREADS) {
+		/* Some thread could not be created: cover its stripe here. */
+		for (t = nthreads; t < BULK_STAT_THREADS; t++) {
+			struct bulk_stat_t w = {args, attrs, errs, n, t,
+				BULK_STAT_THREADS};
+			bulk_stat_worker(&w);
+		}
+	}
+
+	for (t = 0; t < nthreads; t++)
+		pthread_join(threads[t], NULL);
+}
+
 /* Print file properties (in a stat(1) fashion) for all files passed via ARGS. */
 int
 properties_function(char **args, const int follow_link)
@@ -1935,6 +2007,7 @@ properties_function(char **args, const int follow_link)
 		return FUNC_FAILURE;
 
 	size_t i;
+	size_t n = 0;
 	int exit_status = FUNC_SUCCESS;
 
 	for (i = 0; args[i]; i++) {
@@ -1943,17 +2016,39 @@ properties_function(char **args, const int follow_link)
 			if (!deq_file) {
 				xerror(_("p: '%s': Cannot unescape file name\n"), args[i]);
 				exit_status = FUNC_FAILURE;
+				free(args[i]);
+				args[i] = savestring("", 0); /* Skipped below */
 				continue;
 			}
 
 			free(args[i]);
 			args[i] = deq_file;
 		}
+		n++;
+	}
+	n = i;
 
-		if (do_stat(args[i], follow_link) != 0)
+	struct stat *attrs = (struct stat *)NULL;
+	int *errs = (int *)NULL;
+	if (n >= BULK_STAT_MIN) {
+		attrs = xnmalloc(n, sizeof(struct stat));
+		errs = xnmalloc(n, sizeof(int));
+		bulk_stat_run(args, attrs, errs, n);
+	}
+
+	for (i = 0; args[i]; i++) {
+		if (!*args[i])
+			continue;
+
+		const struct stat *cached =
+			(attrs && errs[i] == 0) ? &attrs[i] : (const struct stat *)NULL;
+		if (do_stat(args[i], follow_link, cached) != 0)
 			exit_status = FUNC_FAILURE;
 	}
 
+	free(attrs);
+	free(errs);
+
 	return exit_status;
 }
 
@@ -2014,7 +2109,8 @@ do_stat_and_exit(const int full_stat)
 			? tilde_expand(argv_bk[i]) : (char *)NULL;
 
 		 const int ret =
-			do_stat(norm_path ? norm_path : argv_bk[i], full_stat);
+			do_stat(norm_path ? norm_path : argv_bk[i], full_stat,
+				(const struct stat *)NULL);
 		if (ret != 0)
 			status = ret;
 
@@ -51,6 +51,7 @@ typedef char *rl_cpvfunc_t;
 #include "aux.h"
 #include "checks.h"
 #include "fuzzy_match.h"
+#include "history.h" /* dirhist_index_latest() */
 #ifndef _NO_HIGHLIGHT
 # include "highlight.h"
 #endif /* !_NO_HIGHLIGHT */
@@ -62,6 +63,7 @@ typedef char *rl_cpvfunc_t;
 #ifndef _NO_SUGGESTIONS
 # include "suggestions.h"
 #endif /* !_NO_SUGGESTIONS */
+#include "candidates.h" /* candidates_next() */
 #include "tabcomp.h"
 #include "tags.h"
 
@@ -896,6 +898,8 @@ my_rl_path_completion(const char *text, int state)
 	static char *dirname = (char *)NULL;
 	static char *users_dirname = (char *)NULL;
 	static size_t filename_len;
+	static size_t dirname_len, users_dirname_len;
+	static int fuzzy_str_type;
 	static int match, ret;
 	struct dirent *ent = (struct dirent *)NULL;
 	static int exec = 0, exec_path = 0;
@@ -953,9 +957,9 @@ my_rl_path_completion(const char *text, int state)
 
 		/* We aren't done yet.  We also support the "~user" syntax. */
 		/* Save the version of the directory that the user typed. */
-		size_t dirname_len = strlen(dirname);
+		users_dirname_len = strlen(dirname);
 
-		users_dirname = savestring(dirname, dirname_len);
+		users_dirname = savestring(dirname, users_dirname_len);
 
 		char *temp_dirname;
 		int replace_dirname;
@@ -972,7 +976,7 @@ my_rl_path_completion(const char *text, int state)
 
 		if (replace_dirname) {
 			free(users_dirname);
-			users_dirname = savestring(dirname, dirname_len);
+			users_dirname = savestring(dirname, users_dirname_len);
 		}
 
 		char *d = dirname;
@@ -991,6 +995,13 @@ my_rl_path_completion(const char *text, int state)
 			free(e);
 
 		filename_len = strlen(filename);
+		/* DIRNAME is not modified after this point: measure it (and the
+		 * filter type of FILENAME) once, instead of on every call (this
+		 * function runs once per candidate). */
+		dirname_len = dirname ? strlen(dirname) : 0;
+		fuzzy_str_type = (conf.fuzzy_match == 1
+			&& contains_utf8(filename) == 1)
+			? FUZZY_FILES_UTF8 : FUZZY_FILES_ASCII;
 
 		rl_filename_completion_desired = 1;
 	}
@@ -1004,10 +1015,6 @@ my_rl_path_completion(const char *text, int state)
 	 * a match among files in dir, break the loop and print the match */
 	match = 0;
 
-	size_t dirname_len = 0;
-	if (dirname)
-		dirname_len = strlen(dirname);
-
 	/* This block is used only in case of "/path/./" to remove the ending "./"
 	 * from dirname and to be able to perform thus the executable check via access() */
 	exec_path = 0;
@@ -1026,8 +1033,6 @@ my_rl_path_completion(const char *text, int state)
 	/* #        This is the heart of the function         #
 	 * #################################################### */
 	mode_t type;
-	int fuzzy_str_type = (conf.fuzzy_match == 1 && contains_utf8(filename) == 1)
-		? FUZZY_FILES_UTF8 : FUZZY_FILES_ASCII;
 	int best_fz_score = 0;
 
 	while (directory && (ent = readdir(directory))) {
@@ -1322,7 +1327,7 @@ my_rl_path_completion(const char *text, int state)
 					temp[dirlen + 1] = '\0';
 				}
 			} else { */
-			size_t temp_len = strlen(users_dirname) + strlen(ent->d_name) + 1;
+			size_t temp_len = users_dirname_len + strlen(ent->d_name) + 1;
 			temp = xnmalloc(temp_len, sizeof(char));
 			snprintf(temp, temp_len, "%s%s", users_dirname, ent->d_name);
 //			strcpy(temp, users_dirname);
@@ -1358,10 +1363,7 @@ my_rl_path_completion(const char *text, int state)
 static char *
 bookmarks_generator(const char *text, int state)
 {
-	if (!bookmarks || bm_n == 0)
-		return (char *)NULL;
-
-	static int i;
+	static size_t i;
 	static size_t len;
 	static int prefix;
 	char *name;
@@ -1376,15 +1378,8 @@ bookmarks_generator(const char *text, int state)
 	}
 
 	/* Look for bookmarks in bookmark names for a match */
-	while ((size_t)i < bm_n) {
-		name = bookmarks[i++].name;
-		if (!name || !*name)
-			continue;
-
-		if ((conf.case_sens_list == 1 ? strncmp(name, text + prefix, len)
-		: strncasecmp(name, text + prefix, len)) != 0)
-			continue;
-
+	while ((name = candidates_next(CAND_BOOKMARKS, text + prefix, len,
+	conf.case_sens_list, &i)) != NULL) {
 		if (prefix == 2) {
 			char t[NAME_MAX + 3];
 			snprintf(t, sizeof(t), "b:%s", name);
@@ -1796,24 +1791,16 @@ jump_generator(const char *text, int state)
 static char *
 cschemes_generator(const char *text, int state)
 {
-	if (!color_schemes)
-		return (char *)NULL;
-
-	static int i;
+	static size_t i;
 	static size_t len;
-	char *name;
 
 	if (!state) {
 		i = 0;
 		len = strlen(text);
 	}
 
-	while ((name = color_schemes[i++]) != NULL) {
-		if (strncmp(name, text, len) == 0)
-			return strdup(name);
-	}
-
-	return (char *)NULL;
+	char *name = candidates_next(CAND_CSCHEMES, text, len, 1, &i);
+	return name ? strdup(name) : (char *)NULL;
 }
 
 #ifndef _NO_PROFILES
@@ -1821,24 +1808,16 @@ cschemes_generator(const char *text, int state)
 static char *
 profiles_generator(const char *text, int state)
 {
-	if (!profile_names)
-		return (char *)NULL;
-
-	static int i;
+	static size_t i;
 	static size_t len;
-	char *name;
 
 	if (!state) {
 		i = 0;
 		len = strlen(text);
 	}
 
-	while ((name = profile_names[i++]) != NULL) {
-		if (strncmp(name, text, len) == 0)
-			return strdup(name);
-	}
-
-	return (char *)NULL;
+	char *name = candidates_next(CAND_PROFILES, text, len, 1, &i);
+	return name ? strdup(name) : (char *)NULL;
 }
 #endif /* !_NO_PROFILES */
 
@@ -1847,11 +1826,24 @@ filenames_gen_text(const char *text, int state)
 {
 	static filesn_t i;
 	static size_t len = 0;
+	static char ftext[NAME_MAX + 1];
+	static int folded = 0;
 	char *name;
 	rl_filename_completion_desired = 1;
 	if (!state) {
 		i = 0;
 		len = strlen(text);
+		/* Case insensitive completion: fold the query once and match it
+		 * against the case-folded names cached by init_sort_keys(), a
+		 * memcmp() per candidate, instead of folding both sides on
+		 * every comparison. */
+		folded = (conf.case_sens_path_comp == 0 && len < sizeof(ftext));
+		if (folded == 1) {
+			size_t f;
+			for (f = 0; f < len; f++)
+				ftext[f] = (char)TOLOWER(text[f]);
+			ftext[len] = '\0';
+		}
 	}
 
 	int fuzzy_str_type = (conf.fuzzy_match == 1 && contains_utf8(text) == 1)
@@ -1873,8 +1865,11 @@ filenames_gen_text(const char *text, int state)
 		&& rl_line_buffer[2] == ' ' && file_info[i - 1].dir == 0)
 			continue;
 
-		if (conf.case_sens_path_comp ? strncmp(name, text, len) == 0
-		: strncasecmp(name, text, len) == 0)
+		if (folded == 1 && file_info[i - 1].fname
+		? (file_info[i - 1].bytes >= len
+		&& memcmp(file_info[i - 1].fname, ftext, len) == 0)
+		: (conf.case_sens_path_comp ? strncmp(name, text, len) == 0
+		: strncasecmp(name, text, len) == 0))
 			return strdup(name);
 		if (conf.fuzzy_match == 0 || tabmode == STD_TAB || rl_point < rl_end)
 			continue;
@@ -1979,6 +1974,11 @@ dirhist_generator(const char *text, int state)
 		if (*name == KEY_ESC)
 			continue;
 
+		/* Complete each unique path only once, at its most recent
+		 * position: repeated visits pile up duplicated entries. */
+		if (dirhist_index_latest(name) > i - 1)
+			continue;
+
 		if (!text || !*text)
 			return strdup(name);
 
@@ -2251,25 +2251,17 @@ sel_entries_generator(const char *text, int state)
 static char *
 prompts_generator(const char *text, int state)
 {
-	if (prompts_n == 0)
-		return (char *)NULL;
-
-	static int i;
+	static size_t i;
 	static size_t len;
-	char *name;
 
 	if (!state) {
 		i = 0;
 		len = strlen(text);
 	}
 
-	while (i < (int)prompts_n && (name = prompts[i++].name) != NULL) {
-		if ((conf.case_sens_list ? strncmp(name, text, len)
-		: strncasecmp(name, text, len)) == 0)
-			return strdup(name);
-	}
-
-	return (char *)NULL;
+	char *name = candidates_next(CAND_PROMPTS, text, len,
+		conf.case_sens_list, &i);
+	return name ? strdup(name) : (char *)NULL;
 }
 
 /* Expand tilde and resolve dot expressions in the glob expression TEXT */
@@ -2561,7 +2553,7 @@ tags_generator(const char *text, int state)
 	if (tags_n == 0 || !tags)
 		return (char *)NULL;
 
-	static int i;
+	static size_t i;
 	static size_t len, p = 0;
 	char *name;
 
@@ -2577,9 +2569,8 @@ tags_generator(const char *text, int state)
 		len = *(text + p) ? strlen(text + p) : 0;
 	}
 
-	while ((name = tags[i++]) != NULL) {
-		if (strncmp(name, text + p, len) != 0)
-			continue;
+	while ((name = candidates_next(CAND_TAGS, text + p, len, 1, &i))
+	!= NULL) {
 		if (cur_comp_type == TCMP_TAGS_C) {
 			char tmp[NAME_MAX];
 			snprintf(tmp, NAME_MAX, ":%s", name);
@@ -4492,6 +4483,23 @@ initialize_readline(void)
 	return FUNC_SUCCESS;
 #endif /* VANILLA_READLINE */
 
+	/* Scripted runs (--batch, --cmd, --ls) never reach the interactive
+	 * prompt: completion, suggestions, syntax highlighting, and custom
+	 * keybindings are dead weight there, and parsing the inputrc and
+	 * keybindings files is a measurable part of startup time. Set only
+	 * QUOTE_CHARS, which the command parser (split_str() and friends)
+	 * consumes, and leave readline itself with its defaults (enough for
+	 * the occasional confirmation prompt). */
+	if (xargs.batch == 1 || xargs.list_and_quit == 1
+#ifdef RUN_CMD
+	|| cmd_line_cmd
+#endif /* RUN_CMD */
+	) {
+		const char *qc = " \t\n\"\\'`@$><=,;|&{[()]}?!*^#";
+		quote_chars = savestring(qc, strlen(qc));
+		return FUNC_SUCCESS;
+	}
+
 	/* Set the name of the program using readline. Mostly used for
 	 * conditional constructs in the inputrc file */
 	if (bin_name && *bin_name)
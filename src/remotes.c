@@ -25,8 +25,10 @@
 #include "helpers.h"
 
 #include <errno.h>
+#include <pthread.h> /* mountpoint probe threads (see rprobe_thread()) */
 #include <stdio.h>
 #include <string.h>
+#include <time.h> /* clock_gettime(2) (probe deadlines) */
 
 #include "aux.h"
 #include "file_operations.h"
@@ -39,10 +41,209 @@
 #include "navigation.h"
 #include "sanitize.h"
 #include "spawn.h"
+#include "strings.h" /* savestring() */
+
+/* Asynchronous mountpoint availability probing
+ *
+ * Deciding whether a remote is mounted requires reading its mountpoint
+ * (count_dir()). When the remote endpoint is down (e.g. an unreachable
+ * sshfs host), that read blocks until the kernel gives up, which may
+ * take tens of seconds. To keep the UI responsive, mountpoints are
+ * probed from detached worker threads instead: callers wait at most
+ * RPROBE_WAIT_MS for an answer and otherwise reuse the last known
+ * state, which is cached for RPROBE_TTL seconds. A probe that outlives
+ * the wait keeps running in the background and refreshes the cache
+ * once the kernel finally answers. */
+
+#define RPROBE_TTL     60  /* Cache lifetime for probe results (seconds) */
+#define RPROBE_WAIT_MS 500 /* Max time a caller blocks on a probe */
+
+struct rprobe_t {
+	char *mountpoint;
+	time_t ts;     /* Time of the last completed probe (0: none yet) */
+	int populated; /* Last known state: 1 if mountpoint is populated */
+	int running;   /* A probe thread for this entry is in flight */
+};
+
+/* Probe entries are appended only and never removed, so that indices
+ * stay valid for in-flight threads even if the array is reallocated. */
+static struct rprobe_t *rprobes = (struct rprobe_t *)NULL;
+static size_t rprobes_n = 0;
+static pthread_mutex_t rprobe_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t rprobe_cond = PTHREAD_COND_INITIALIZER;
+
+struct rprobe_arg_t {
+	char *mountpoint; /* Own copy: remotes[] may be freed under us */
+	size_t idx;
+};
+
+static void *
+rprobe_thread(void *arg)
+{
+	struct rprobe_arg_t *a = (struct rprobe_arg_t *)arg;
+
+	/* This is the call that may block for a long time on a dead mount. */
+	const int populated = count_dir(a->mountpoint, CPOP) > 2;
+
+	pthread_mutex_lock(&rprobe_lock);
+	rprobes[a->idx].populated = populated;
+	rprobes[a->idx].ts = time(NULL);
+	rprobes[a->idx].running = 0;
+	pthread_cond_broadcast(&rprobe_cond);
+	pthread_mutex_unlock(&rprobe_lock);
+
+	free(a->mountpoint);
+	free(a);
+	return NULL;
+}
+
+/* Return the index of the probe cache entry for MOUNTPOINT, creating it
+ * if needed, and launch a probe thread if the cached result is stale.
+ * Must be called with rprobe_lock held. */
+static size_t
+rprobe_get(const char *mountpoint)
+{
+	size_t i;
+	for (i = 0; i < rprobes_n; i++) {
+		if (*mountpoint == *rprobes[i].mountpoint
+		&& strcmp(mountpoint, rprobes[i].mountpoint) == 0)
+			break;
+	}
+
+	if (i == rprobes_n) {
+		rprobes = xnrealloc(rprobes, rprobes_n + 1, sizeof(struct rprobe_t));
+		rprobes[i].mountpoint = savestring(mountpoint, strlen(mountpoint));
+		rprobes[i].ts = 0;
+		rprobes[i].populated = 0;
+		rprobes[i].running = 0;
+		rprobes_n++;
+	}
+
+	if (rprobes[i].running == 1
+	|| (rprobes[i].ts != 0 && time(NULL) - rprobes[i].ts < RPROBE_TTL))
+		return i;
+
+	struct rprobe_arg_t *arg = xnmalloc(1, sizeof(struct rprobe_arg_t));
+	arg->mountpoint = savestring(mountpoint, strlen(mountpoint));
+	arg->idx = i;
+
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+	pthread_t t;
+	if (pthread_create(&t, &attr, rprobe_thread, arg) == 0) {
+		rprobes[i].running = 1;
+	} else { /* Out of threads: keep whatever state we had */
+		free(arg->mountpoint);
+		free(arg);
+	}
+
+	pthread_attr_destroy(&attr);
+	return i;
+}
+
+/* Absolute deadline RPROBE_WAIT_MS from now, for pthread_cond_timedwait(). */
+static void
+rprobe_deadline(struct timespec *ts)
+{
+	clock_gettime(CLOCK_REALTIME, ts);
+	ts->tv_nsec += (RPROBE_WAIT_MS % 1000) * 1000000L;
+	ts->tv_sec += RPROBE_WAIT_MS / 1000;
+	if (ts->tv_nsec >= 1000000000L) {
+		ts->tv_nsec -= 1000000000L;
+		ts->tv_sec++;
+	}
+}
+
+/* Drop the cached probe result for MOUNTPOINT, so that the next query
+ * probes it again (used after mounting/unmounting a remote). */
+static void
+rprobe_invalidate(const char *mountpoint)
+{
+	pthread_mutex_lock(&rprobe_lock);
+	size_t i;
+	for (i = 0; i < rprobes_n; i++) {
+		if (*mountpoint == *rprobes[i].mountpoint
+		&& strcmp(mountpoint, rprobes[i].mountpoint) == 0) {
+			rprobes[i].ts = 0;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&rprobe_lock);
+}
+
+/* Return 1 if MOUNTPOINT is populated (i.e. the remote is mounted) and
+ * 0 otherwise, blocking at most RPROBE_WAIT_MS. If the probe does not
+ * answer in time, the last cached state is returned (0 if none). */
+int
+remote_mountpoint_status(const char *mountpoint)
+{
+	if (!mountpoint || !*mountpoint)
+		return 0;
+
+	struct timespec deadline;
+	rprobe_deadline(&deadline);
+
+	pthread_mutex_lock(&rprobe_lock);
+	const size_t i = rprobe_get(mountpoint);
+
+	int ret = 0;
+	while (rprobes[i].running == 1) {
+		if (pthread_cond_timedwait(&rprobe_cond, &rprobe_lock,
+		&deadline) == ETIMEDOUT)
+			break;
+	}
+
+	ret = rprobes[i].populated;
+	pthread_mutex_unlock(&rprobe_lock);
+	return ret;
+}
+
+/* Refresh the mounted state of all loaded remotes. Probes for all
+ * mountpoints are launched in parallel and collected within a single
+ * RPROBE_WAIT_MS budget; unanswered probes keep their last known state
+ * and update the cache in the background. */
+void
+probe_remotes(void)
+{
+	if (remotes_n == 0)
+		return;
+
+	struct timespec deadline;
+	rprobe_deadline(&deadline);
+
+	pthread_mutex_lock(&rprobe_lock);
+
+	size_t i;
+	for (i = 0; i < remotes_n; i++) { /* Kick off all probes first */
+		if (remotes[i].name && remotes[i].mountpoint)
+			rprobe_get(remotes[i].mountpoint);
+	}
+
+	for (i = 0; i < remotes_n; i++) {
+		if (!remotes[i].name || !remotes[i].mountpoint)
+			continue;
+
+		const size_t p = rprobe_get(remotes[i].mountpoint);
+		int timed_out = 0;
+		while (rprobes[p].running == 1 && timed_out == 0) {
+			if (pthread_cond_timedwait(&rprobe_cond, &rprobe_lock,
+			&deadline) == ETIMEDOUT)
+				timed_out = 1;
+		}
+
+		remotes[i].mounted = rprobes[p].populated;
+	}
+
+	pthread_mutex_unlock(&rprobe_lock);
+}
 
 static int
 remotes_list(void)
 {
+	probe_remotes(); /* Refresh the mounted state of each remote */
+
 	if (remotes_n == 0) {
 		printf(_("%s: No remotes defined. Run 'net edit' to add one.\n"),
 			PROGRAM_NAME);
@@ -190,7 +391,7 @@ remotes_mount(char *name)
 		return FUNC_FAILURE;
 
 	/* Make sure mountpoint is not populated and run the mount command */
-	if (count_dir(remotes[i].mountpoint, CPOP) <= 2
+	if (remote_mountpoint_status(remotes[i].mountpoint) == 0
 	&& launch_execl(remotes[i].mount_cmd) != FUNC_SUCCESS)
 		return FUNC_FAILURE;
 
@@ -206,6 +407,7 @@ remotes_mount(char *name)
 	}
 
 	remotes[i].mounted = 1;
+	rprobe_invalidate(remotes[i].mountpoint);
 	return exit_status;
 }
 
@@ -271,6 +473,7 @@ remotes_unmount(char *name)
 		return FUNC_FAILURE;
 
 	remotes[i].mounted = 0;
+	rprobe_invalidate(remotes[i].mountpoint);
 	return FUNC_SUCCESS;
 }
 
@@ -376,7 +579,7 @@ automount_remotes(void)
 				if (launch_execv(cmd, FOREGROUND, E_NOFLAG) != FUNC_SUCCESS)
 					continue;
 			} else {
-				if (count_dir(remotes[i].mountpoint, CPOP) > 2)
+				if (remote_mountpoint_status(remotes[i].mountpoint) == 1)
 					continue;
 			}
 
@@ -412,7 +615,7 @@ autounmount_remotes(void)
 			&& sanitize_cmd(remotes[i].unmount_cmd, SNT_NET) != FUNC_SUCCESS)
 				continue;
 
-			if (count_dir(remotes[i].mountpoint, CPOP) <= 2)
+			if (remote_mountpoint_status(remotes[i].mountpoint) == 0)
 				continue;
 			int dir_change = 0;
 
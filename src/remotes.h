@@ -30,6 +30,8 @@ __BEGIN_DECLS
 int remotes_function(char **args);
 int automount_remotes(void);
 int autounmount_remotes(void);
+int remote_mountpoint_status(const char *mountpoint);
+void probe_remotes(void);
 
 __END_DECLS
 
@@ -25,6 +25,8 @@
 #include "helpers.h"
 
 #include <errno.h>
+#include <fnmatch.h>
+#include <pthread.h> /* parallel recursive search */
 #include <stdio.h>
 #include <string.h>
 #include <sys/ioctl.h>
@@ -40,20 +42,14 @@
 #include "aux.h"
 #include "checks.h"
 #include "colors.h"
+#include "listing.h"
 #include "messages.h"
 #include "misc.h"
 #include "navigation.h"
 #include "sort.h"
-#include "spawn.h"
 
 #define ERR_SKIP_REGEX 2
 
-#if (defined(__OpenBSD__) || defined(__sun)) && !defined(_BE_POSIX)
-/* OpenBSD/Solaris find(1) has neither -regex nor -iregex. We'll try to use
- * gfind(1) instead.*/
-# define FIND_HAS_NO_REGEX
-#endif /* __OpenBSD__ || __sun */
-
 struct search_t {
 	char *name;
 	size_t len;
@@ -61,86 +57,279 @@ struct search_t {
 	int pad;
 };
 
+/* Recursive search ("/PATTERN -x").
+ *
+ * The directory tree used to be walked by spawning find(1). It is now
+ * walked in-process by a small pool of threads pulling directories from
+ * a shared queue: each worker scans one directory, prints whatever
+ * matches (as soon as it is found), and appends subdirectories to the
+ * queue for any worker to pick up. On large trees this runs several
+ * times faster than the serial walk. */
+
+#define RSEARCH_MAX_THREADS 16
+#define RSEARCH_QUEUE_STEP  64
+
+struct rsearch_dir_t {
+	dev_t dev;
+	ino_t ino;
+};
+
+struct rsearch_t {
+	char **dirs;    /* Queue of directories left to scan. */
+	size_t qhead;   /* Next queue entry to be scanned. */
+	size_t qlen;
+	size_t qcap;
+	size_t pending; /* Queued directories not yet fully scanned. */
+	size_t matches;
+	pthread_mutex_t lock;     /* Protects the queue and visited list. */
+	pthread_cond_t work;
+	pthread_mutex_t out_lock; /* Serializes match output. */
+	const regex_t *regex;  /* Compiled pattern (REGEX_ONLY strategy). */
+	const char *pattern;   /* Glob pattern (otherwise). */
+	int fn_flags;
+	/* Directories already pushed to the queue, to break cycles. Only
+	 * maintained when following symbolic links. */
+	struct rsearch_dir_t *visited;
+	size_t visited_n;
+};
+
+/* Return 1 if the directory identified by A was already queued for
+ * scanning, or record it and return 0 otherwise. Must be called with
+ * RS->lock held. */
 static int
-exec_find(char *name, char *_path, char *method, char *pattern)
+rsearch_visited(struct rsearch_t *rs, const struct stat *a)
 {
-	if (follow_symlinks == 1) {
-		char *cmd[] = {name, "-L", _path, method, pattern, NULL};
-		return launch_execv(cmd, FOREGROUND, E_NOSTDERR);
+	size_t i;
+	for (i = 0; i < rs->visited_n; i++) {
+		if (rs->visited[i].dev == a->st_dev && rs->visited[i].ino == a->st_ino)
+			return 1;
 	}
 
-	char *cmd[] = {name, _path, method, pattern, NULL};
-	return launch_execv(cmd, FOREGROUND, E_NOSTDERR);
+	rs->visited = xnrealloc(rs->visited, rs->visited_n + 1,
+		sizeof(struct rsearch_dir_t));
+	rs->visited[rs->visited_n].dev = a->st_dev;
+	rs->visited[rs->visited_n].ino = a->st_ino;
+	rs->visited_n++;
+
+	return 0;
 }
 
-#ifdef FIND_HAS_NO_REGEX
-static char *
-define_find_name(void)
+static void
+rsearch_push_dir(struct rsearch_t *rs, const char *dir)
 {
-	static int check = 1;
-	static int have_gfind = 0;
-
-	/* Let's run this only once. */
-	if (check == 1) {
-		check = 0;
-		char *p = get_cmd_path("gfind");
-		if (p)
-			have_gfind = 1;
-		free(p);
+	struct stat a;
+	/* When following symlinks the tree may contain cycles: skip any
+	 * directory we have already queued. */
+	if (follow_symlinks == 1 && stat(dir, &a) == -1)
+		return;
+
+	pthread_mutex_lock(&rs->lock);
+
+	if (follow_symlinks == 1 && rsearch_visited(rs, &a) == 1) {
+		pthread_mutex_unlock(&rs->lock);
+		return;
+	}
+
+	if (rs->qlen == rs->qcap) {
+		rs->qcap += RSEARCH_QUEUE_STEP;
+		rs->dirs = xnrealloc(rs->dirs, rs->qcap, sizeof(char *));
 	}
 
-	return (have_gfind == 1 ? "gfind" : "find");
+	rs->dirs[rs->qlen] = savestring(dir, strlen(dir));
+	rs->qlen++;
+	rs->pending++;
+
+	pthread_cond_signal(&rs->work);
+	pthread_mutex_unlock(&rs->lock);
 }
-#endif /* FIND_HAS_NO_REGEX */
 
 static int
-run_find(char *search_path, char *arg)
+rsearch_match(const struct rsearch_t *rs, const char *name)
+{
+	if (rs->regex)
+		return regexec(rs->regex, name, 0, NULL, 0) == 0;
+
+	return fnmatch(rs->pattern, name, rs->fn_flags) == 0;
+}
+
+static void
+rsearch_scan_dir(struct rsearch_t *rs, const char *dir)
+{
+	DIR *p = opendir(dir);
+	if (!p)
+		return;
+
+	struct dirent *ent;
+	char buf[PATH_MAX + 1];
+
+	while ((ent = readdir(p)) != NULL) {
+		if (SELFORPARENT(ent->d_name))
+			continue;
+
+		if (rsearch_match(rs, ent->d_name) == 1) {
+			pthread_mutex_lock(&rs->out_lock);
+			printf("%s/%s\n", dir, ent->d_name);
+			rs->matches++;
+			pthread_mutex_unlock(&rs->out_lock);
+		}
+
+		int is_dir = 0, is_lnk = 0;
+		struct stat a;
+
+		snprintf(buf, sizeof(buf), "%s/%s", dir, ent->d_name);
+
+#ifdef _DIRENT_HAVE_D_TYPE
+		if (ent->d_type == DT_DIR) {
+			is_dir = 1;
+		} else if (ent->d_type == DT_LNK) {
+			is_lnk = 1;
+		} else if (ent->d_type == DT_UNKNOWN)
+#endif /* _DIRENT_HAVE_D_TYPE */
+		{
+			if (lstat(buf, &a) == -1)
+				continue;
+
+			if (S_ISDIR(a.st_mode))
+				is_dir = 1;
+			else if (S_ISLNK(a.st_mode))
+				is_lnk = 1;
+		}
+
+		if (is_lnk == 1) {
+			if (follow_symlinks == 1 && stat(buf, &a) != -1
+			&& S_ISDIR(a.st_mode))
+				rsearch_push_dir(rs, buf);
+			continue;
+		}
+
+		if (is_dir == 1)
+			rsearch_push_dir(rs, buf);
+	}
+
+	closedir(p);
+}
+
+static void *
+rsearch_worker(void *arg)
+{
+	struct rsearch_t *rs = (struct rsearch_t *)arg;
+
+	for (;;) {
+		pthread_mutex_lock(&rs->lock);
+
+		while (rs->qhead == rs->qlen && rs->pending > 0)
+			pthread_cond_wait(&rs->work, &rs->lock);
+
+		if (rs->qhead == rs->qlen) { /* pending == 0: we're done. */
+			pthread_mutex_unlock(&rs->lock);
+			break;
+		}
+
+		char *dir = rs->dirs[rs->qhead];
+		rs->qhead++;
+		pthread_mutex_unlock(&rs->lock);
+
+		rsearch_scan_dir(rs, dir);
+		free(dir);
+
+		pthread_mutex_lock(&rs->lock);
+		rs->pending--;
+		if (rs->pending == 0)
+			/* Wake up everybody waiting for work: there is none left. */
+			pthread_cond_broadcast(&rs->work);
+		pthread_mutex_unlock(&rs->lock);
+	}
+
+	return NULL;
+}
+
+static int
+run_recursive_search(char *search_path, char *arg)
 {
 	char *_path = (search_path && *search_path) ? search_path : ".";
-	char *name = "find";
 
-#if defined(_BE_POSIX)
-	/* POSIX find(1) only supports -name */
-	char *method = "-name";
-#else
-	char *method = conf.search_strategy == REGEX_ONLY
-		? (conf.case_sens_search == 1 ? "-regex" : "-iregex")
-		: (conf.case_sens_search == 1 ? "-name" : "-iname");
-# if defined(FIND_HAS_NO_REGEX)
-	name = define_find_name();
-	if (*name != 'g') /* GNU find (gfind) not found */
-		method = conf.case_sens_search == 1 ? "-name" : "-iname";
-# endif /* FIND_HAS_NO_REGEX */
-#endif /* _BE_POSIX */
-
-	const int glob_char = check_glob_char(arg + 1, GLOB_REGEX);
-	if (glob_char == 1)
-		return exec_find(name, _path, method, arg + 1);
-
-	const size_t pattern_len = strlen(arg + 1) + 5;
-	char *pattern = xnmalloc(pattern_len, sizeof(char));
-
-#if !defined(_BE_POSIX)
-	if (conf.search_strategy == REGEX_ONLY) {
-# if !defined(FIND_HAS_NO_REGEX)
-		snprintf(pattern, pattern_len, ".*%s.*", arg + 1);
-# else
-		if (*name == 'g') /* We have GNU find (gfind) */
-			snprintf(pattern, pattern_len, ".*%s.*", arg + 1);
-		else
-			snprintf(pattern, pattern_len, "*%s*", arg + 1);
-# endif /* FIND_HAS_NO_REGEX */
+	int use_regex = 0;
+#ifndef _BE_POSIX
+	use_regex = (conf.search_strategy == REGEX_ONLY);
+#endif /* !_BE_POSIX */
+
+	char *pattern = (char *)NULL;
+	if (check_glob_char(arg + 1, GLOB_REGEX) == 1) {
+		pattern = savestring(arg + 1, strlen(arg + 1));
 	} else {
-		snprintf(pattern, pattern_len, "*%s*", arg + 1);
+		/* No metacharacters: match any name containing the query. */
+		const size_t pattern_len = strlen(arg + 1) + 5;
+		pattern = xnmalloc(pattern_len, sizeof(char));
+		snprintf(pattern, pattern_len, use_regex == 1
+			? ".*%s.*" : "*%s*", arg + 1);
 	}
-#else
-	snprintf(pattern, pattern_len, "*%s*", arg + 1);
-#endif /* !_BE_POSIX */
 
-	const int ret = exec_find(name, _path, method, pattern);
+	struct rsearch_t rs;
+	memset(&rs, 0, sizeof(rs));
+	pthread_mutex_init(&rs.lock, NULL);
+	pthread_mutex_init(&rs.out_lock, NULL);
+	pthread_cond_init(&rs.work, NULL);
+
+	regex_t regex;
+	if (use_regex == 1) {
+		const int reg_flags = conf.case_sens_search == 1
+			? (REG_NOSUB | REG_EXTENDED)
+			: (REG_NOSUB | REG_EXTENDED | REG_ICASE);
+
+		if (regcomp(&regex, pattern, reg_flags) != FUNC_SUCCESS) {
+			xerror(_("search: '%s': Invalid regular expression\n"), pattern);
+			free(pattern);
+			return FUNC_FAILURE;
+		}
+
+		rs.regex = &regex;
+	} else {
+		rs.pattern = pattern;
+#ifdef FNM_CASEFOLD /* Not POSIX, but both GNU and the BSDs have it. */
+		if (conf.case_sens_search == 0)
+			rs.fn_flags |= FNM_CASEFOLD;
+#endif /* FNM_CASEFOLD */
+	}
+
+	rsearch_push_dir(&rs, _path);
+
+	long nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+	if (nthreads < 1)
+		nthreads = 1;
+	if (nthreads > RSEARCH_MAX_THREADS)
+		nthreads = RSEARCH_MAX_THREADS;
+
+	pthread_t threads[RSEARCH_MAX_THREADS];
+	long started = 0;
+	while (started < nthreads - 1) {
+		if (pthread_create(&threads[started], NULL, rsearch_worker, &rs) != 0)
+			break;
+		started++;
+	}
+
+	rsearch_worker(&rs); /* The current thread works the queue too. */
+
+	long i;
+	for (i = 0; i < started; i++)
+		pthread_join(threads[i], NULL);
+
+	pthread_mutex_destroy(&rs.lock);
+	pthread_mutex_destroy(&rs.out_lock);
+	pthread_cond_destroy(&rs.work);
+	free(rs.dirs);
+	free(rs.visited);
+
+	if (use_regex == 1)
+		regfree(&regex);
 	free(pattern);
 
-	return ret;
+	if (rs.matches == 0) {
+		fputs(_("search: No matches found\n"), stderr);
+		return FUNC_FAILURE;
+	}
+
+	print_reload_msg(_("Matches found: %zu\n"), rs.matches);
+	return FUNC_SUCCESS;
 }
 
 static int
@@ -186,7 +375,7 @@ set_file_type_and_search_path(char **args, mode_t *file_type,
 	case 'l': *file_type = invert == 1 ? DT_LNK : S_IFLNK; break;
 	case 'p': *file_type = invert == 1 ? DT_FIFO : S_IFIFO; break;
 	case 's': *file_type = invert == 1 ? DT_SOCK : S_IFSOCK; break;
-	case 'x': run_find(*search_path, args[0]); return FUNC_SUCCESS;
+	case 'x': run_recursive_search(*search_path, args[0]); return FUNC_SUCCESS;
 	default:
 		fprintf(stderr, _("search: '%c': Unrecognized file "
 			"type\n"), (char)*file_type);
@@ -529,6 +718,9 @@ print_glob_matches(struct search_t *matches, const char *search_path)
 		if (!search_path) {
 			/* Print ELN, file indicator, and icon. */
 			int index = matches[i].eln - 1;
+#ifndef _NO_ICONS
+			resolve_entry_icon((filesn_t)index);
+#endif /* !_NO_ICONS */
 			char ind_chr = file_info[index].sel == 1 ? SELFILE_CHR : ' ';
 			char *ind_chr_color = file_info[index].sel == 1 ? li_cb : "";
 
@@ -576,7 +768,7 @@ search_glob(char **args)
 		return ERR_SKIP_REGEX;
 	}
 
-	if (file_type == 'x') /* Recursive search via find(1) */
+	if (file_type == 'x') /* Recursive search */
 		return FUNC_SUCCESS;
 
 	/* If we have a path ("/str /path"), chdir into it, since glob(3)
@@ -809,6 +1001,9 @@ print_regex_entry(struct search_t list, const int namepad, const int elnpad,
 	if (list.eln != -1) {
 		// Print ELN, file indicator, and icon.
 		int index = list.eln - 1;
+#ifndef _NO_ICONS
+		resolve_entry_icon((filesn_t)index);
+#endif /* !_NO_ICONS */
 		char ind_chr = file_info[index].sel == 1 ? SELFILE_CHR : ' ';
 		char *ind_chr_color = file_info[index].sel == 1 ? li_cb : "";
 
@@ -909,7 +1104,7 @@ search_regex(char **args)
 	&search_path, 1) == FUNC_FAILURE)
 		return FUNC_FAILURE;
 
-	if (file_type == 'x') /* Recursive search via find(1) */
+	if (file_type == 'x') /* Recursive search */
 		return FUNC_SUCCESS;
 
 	struct dirent **reg_dirlist = (struct dirent **)NULL;
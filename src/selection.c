@@ -47,6 +47,7 @@
 #include "colors.h"
 #include "file_operations.h"
 #include "init.h"
+#include "ipc.h" /* ipc_update_sel() */
 #include "listing.h"
 #include "messages.h"
 #include "misc.h"
@@ -57,11 +58,283 @@
 #include "sort.h"
 #include "xdu.h" /* dir_size() */
 
+/* Selections file as an append-only log
+ *
+ * save_sel() used to rewrite the whole selections file on every change:
+ * with multi-thousand-entry selections shared across sessions this is
+ * constant rewrite I/O. Mutations performed through select_file() and
+ * deselect_entries() are now recorded as pending log operations, and
+ * save_sel() just appends them: plain path lines for additions (the
+ * format older versions read), and "#-path" lines for removals (which
+ * older versions skip as comments). get_sel_files() replays removal
+ * records on load (see sel_log_sync()). The file is still rewritten in
+ * full -- compacted -- whenever the pending operations do not account
+ * for the in-memory state (callers that mutate the selection directly),
+ * or once enough removal records have piled up.
+ *
+ * An in-memory hash index over the selection (chained buckets, as the
+ * extension-color and icon tables in colors.c/listing.c) replaces the
+ * linear already-selected/deselect lookups. */
+
+#define SEL_LOG_MAX_DELS 512 /* Removal records triggering compaction */
+
+struct sel_log_op_t {
+	char *name;
+	int del; /* 1: removal record; 0: addition */
+	int pad;
+};
+
+static struct sel_log_op_t *sel_pending = (struct sel_log_op_t *)NULL;
+static size_t sel_pending_n = 0;
+static size_t sel_pending_cap = 0;
+static size_t sel_log_dels = 0; /* Removal records since last rewrite */
+static size_t sel_saved_n = 0;  /* sel_n at the time of the last save/load */
+
+/* Hash index over sel_elements: BUCKETS holds 1-based indices (zero
+ * means empty), chained via NEXT. */
+static size_t *sel_index_buckets = (size_t *)NULL;
+static size_t *sel_index_next = (size_t *)NULL;
+static size_t sel_index_size = 0; /* Number of buckets (power of two) */
+static size_t sel_index_n = 0;    /* Entries indexed (mirrors sel_n) */
+
+/* Same scheme, keyed by (device, inode) over sel_devino: used by the
+ * listing loop to mark selected entries (see is_file_selected()). */
+static size_t *seldev_buckets = (size_t *)NULL;
+static size_t *seldev_next = (size_t *)NULL;
+static size_t seldev_size = 0;
+static size_t seldev_n = 0;
+
+/* Free the selection hash index and any pending log operation. Called
+ * from free_stuff() and whenever the index must be rebuilt from
+ * scratch. */
+void
+free_sel_index(void)
+{
+	free(sel_index_buckets);
+	sel_index_buckets = (size_t *)NULL;
+	free(sel_index_next);
+	sel_index_next = (size_t *)NULL;
+	sel_index_size = sel_index_n = 0;
+
+	free(seldev_buckets);
+	seldev_buckets = (size_t *)NULL;
+	free(seldev_next);
+	seldev_next = (size_t *)NULL;
+	seldev_size = seldev_n = 0;
+
+	size_t i;
+	for (i = 0; i < sel_pending_n; i++)
+		free(sel_pending[i].name);
+	free(sel_pending);
+	sel_pending = (struct sel_log_op_t *)NULL;
+	sel_pending_n = sel_pending_cap = 0;
+}
+
+static void
+sel_index_build(void)
+{
+	free(sel_index_buckets);
+	free(sel_index_next);
+
+	size_t size = 64;
+	while (size < sel_n * 2)
+		size <<= 1;
+
+	sel_index_buckets = xcalloc(size, sizeof(size_t));
+	sel_index_next = xcalloc(size, sizeof(size_t));
+	sel_index_size = size;
+
+	size_t i;
+	for (i = 0; i < sel_n; i++) {
+		const size_t b = hashme(sel_elements[i].name, 1) & (size - 1);
+		sel_index_next[i] = sel_index_buckets[b];
+		sel_index_buckets[b] = i + 1;
+	}
+
+	sel_index_n = sel_n;
+}
+
+/* Insert the entry at index I (just appended to sel_elements) into the
+ * hash index. */
+static void
+sel_index_insert(const size_t i)
+{
+	if (sel_index_size == 0 || sel_n * 2 > sel_index_size) {
+		sel_index_build(); /* Grow (or first build): reindex everything */
+		return;
+	}
+
+	const size_t b = hashme(sel_elements[i].name, 1)
+		& (sel_index_size - 1);
+	sel_index_next[i] = sel_index_buckets[b];
+	sel_index_buckets[b] = i + 1;
+	sel_index_n = sel_n;
+}
+
+/* Return the index in sel_elements of the entry named NAME, or -1 if
+ * not selected. Entries whose name was cleared (mid-deselection) are
+ * skipped. */
+static filesn_t
+sel_index_lookup(const char *name)
+{
+	if (sel_index_n != sel_n) {
+		/* The selection was modified behind our back (e.g. reloaded by
+		 * get_sel_files()): reindex. */
+		sel_index_build();
+	}
+
+	if (sel_n == 0 || sel_index_size == 0)
+		return (filesn_t)-1;
+
+	size_t k = sel_index_buckets[hashme(name, 1) & (sel_index_size - 1)];
+	while (k != 0) {
+		const size_t i = k - 1;
+		if (sel_elements[i].name && *name == *sel_elements[i].name
+		&& strcmp(sel_elements[i].name, name) == 0)
+			return (filesn_t)i;
+		k = sel_index_next[i];
+	}
+
+	return (filesn_t)-1;
+}
+
+static size_t
+seldev_hash(const dev_t dev, const ino_t ino, const size_t size)
+{
+	return ((size_t)ino ^ ((size_t)dev << 16)) & (size - 1);
+}
+
+static void
+seldev_build(void)
+{
+	free(seldev_buckets);
+	free(seldev_next);
+
+	size_t size = 64;
+	while (size < sel_n * 2)
+		size <<= 1;
+
+	seldev_buckets = xcalloc(size, sizeof(size_t));
+	seldev_next = xcalloc(size, sizeof(size_t));
+	seldev_size = size;
+
+	size_t i;
+	for (i = 0; i < sel_n; i++) {
+		const size_t b =
+			seldev_hash(sel_devino[i].dev, sel_devino[i].ino, size);
+		seldev_next[i] = seldev_buckets[b];
+		seldev_buckets[b] = i + 1;
+	}
+
+	seldev_n = sel_n;
+}
+
+/* Return 1 if a file on the device DEV with inode INO is selected, or
+ * zero otherwise. If NAME is not NULL (a regular file with multiple
+ * hardlinks), the matching entry's base name must also match NAME, so
+ * that only the selected link, and not its siblings, gets marked. */
+int
+is_file_selected(const dev_t dev, const ino_t ino, const char *name)
+{
+	if (sel_n == 0 || !sel_devino)
+		return 0;
+
+	if (seldev_n != sel_n) /* The selection changed: reindex */
+		seldev_build();
+
+	size_t k = seldev_buckets[seldev_hash(dev, ino, seldev_size)];
+	while (k != 0) {
+		const size_t j = k - 1;
+		k = seldev_next[j];
+
+		if (sel_devino[j].dev != dev || sel_devino[j].ino != ino)
+			continue;
+
+		if (!name)
+			return 1;
+
+		const char *p = strrchr(sel_elements[j].name, '/');
+		if (p && *(++p) && *p == *name && strcmp(p, name) == 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+/* Record the addition (DEL is zero) or removal (DEL is 1) of NAME as a
+ * pending log operation, to be appended to the selections file by the
+ * next save_sel() call. */
+static void
+sel_log_push(const char *name, const int del)
+{
+	if (sel_pending_n >= sel_pending_cap) {
+		sel_pending_cap = sel_pending_cap == 0 ? 64 : sel_pending_cap * 2;
+		sel_pending = xnrealloc(sel_pending, sel_pending_cap,
+			sizeof(struct sel_log_op_t));
+	}
+
+	sel_pending[sel_pending_n].name = savestring(name, strlen(name));
+	sel_pending[sel_pending_n].del = del;
+	sel_pending_n++;
+}
+
+static void
+sel_log_clear_pending(void)
+{
+	size_t i;
+	for (i = 0; i < sel_pending_n; i++)
+		free(sel_pending[i].name);
+	sel_pending_n = 0;
+}
+
+/* Called by get_sel_files() once the selections file was loaded:
+ * DEL_RECORDS is the number of removal records found in the file. Reset
+ * the log state to the just-loaded view (pending operations, if any,
+ * are already on disk or stale). */
+void
+sel_log_sync(const size_t del_records)
+{
+	sel_log_clear_pending();
+	sel_log_dels = del_records;
+	sel_saved_n = sel_n;
+	/* Entries changed: reindex on next lookup */
+	sel_index_n = (size_t)-1;
+	seldev_n = (size_t)-1;
+}
+
+/* Append the pending operations to the selections file. Returns
+ * FUNC_SUCCESS, or FUNC_FAILURE on error (in which case the caller
+ * falls back to a full rewrite). */
+static int
+sel_log_append(void)
+{
+	FILE *fp = fopen(sel_file, "a");
+	if (!fp)
+		return FUNC_FAILURE;
+
+	size_t i;
+	for (i = 0; i < sel_pending_n; i++) {
+		if (sel_pending[i].del == 1) {
+			fputs("#-", fp);
+			sel_log_dels++;
+		}
+		fputs(sel_pending[i].name, fp);
+		fputc('\n', fp);
+	}
+
+	fclose(fp);
+	return FUNC_SUCCESS;
+}
+
 /* Save selected elements into a tmp file. Returns 1 on success or 0
  * on error. This function allows the user to work with multiple
  * instances of the program: they can select some files in the
  * first instance and then execute a second one to operate on those
- * files as they wish. */
+ * files as they wish.
+ * If the pending log operations account exactly for the selection state
+ * they are appended to the file; otherwise (direct mutations, a missing
+ * file, or too many accumulated removal records) the file is rewritten
+ * in full. */
 int
 save_sel(void)
 {
@@ -69,13 +342,38 @@ save_sel(void)
 		return FUNC_FAILURE;
 
 	if (sel_n == 0) {
+		sel_log_clear_pending();
+		sel_log_dels = 0;
+		sel_saved_n = 0;
 		if (unlink(sel_file) == -1) {
 			xerror("sel: '%s': %s\n", sel_file, strerror(errno));
 			return FUNC_FAILURE;
 		}
+		ipc_update_sel();
+		return FUNC_SUCCESS;
+	}
+
+	size_t adds = 0, dels = 0;
+	size_t i;
+	for (i = 0; i < sel_pending_n; i++) {
+		if (sel_pending[i].del == 1)
+			dels++;
+		else
+			adds++;
+	}
+
+	if (sel_pending_n > 0
+	&& sel_saved_n + adds == sel_n + dels /* Nothing mutated us directly */
+	&& sel_log_dels + dels <= SEL_LOG_MAX_DELS
+	&& access(sel_file, F_OK) == 0
+	&& sel_log_append() == FUNC_SUCCESS) {
+		sel_log_clear_pending();
+		sel_saved_n = sel_n;
+		ipc_update_sel();
 		return FUNC_SUCCESS;
 	}
 
+	/* Full rewrite: this is also what compacts the log */
 	int fd = 0;
 	FILE *fp = open_fwrite(sel_file, &fd);
 	if (!fp) {
@@ -83,13 +381,16 @@ save_sel(void)
 		return FUNC_FAILURE;
 	}
 
-	size_t i;
 	for (i = 0; i < sel_n; i++) {
 		fputs(sel_elements[i].name, fp);
 		fputc('\n', fp);
 	}
 
 	fclose(fp);
+	sel_log_clear_pending();
+	sel_log_dels = 0;
+	sel_saved_n = sel_n;
+	ipc_update_sel();
 	return FUNC_SUCCESS;
 }
 
@@ -127,14 +428,7 @@ select_file(char *file)
 	}
 
 	/* Check if FILE is already in the selection box */
-	filesn_t j = (filesn_t)sel_n;
-	while (--j >= 0) {
-		if (*tfile == *sel_elements[j].name
-		&& strcmp(sel_elements[j].name, tfile) == 0) {
-			exists = 1;
-			break;
-		}
-	}
+	exists = (sel_index_lookup(tfile) != (filesn_t)-1);
 
 	if (exists == 0) {
 		sel_elements = xnrealloc(sel_elements, sel_n + 2, sizeof(struct sel_t));
@@ -144,6 +438,9 @@ select_file(char *file)
 		sel_elements[sel_n].name = (char *)NULL;
 		sel_elements[sel_n].size = (off_t)UNSET;
 
+		sel_index_insert(sel_n - 1);
+		sel_log_push(tfile, 0);
+
 		new_sel++;
 	} else {
 		xerror(_("sel: '%s': Already selected\n"), tfile);
@@ -657,7 +954,10 @@ print_sel_results(const int new_sel, const char *sel_path,
 		return FUNC_FAILURE;
 	}
 
-	if (conf.autols == 1 && error == 0)
+	/* Only selection marks changed: patch them in place if possible,
+	 * falling back to a full reprint. */
+	if (conf.autols == 1 && error == 0
+	&& dirlist_patch_selection() == FUNC_FAILURE)
 		reload_dirlist();
 
 	print_reload_msg(_("%d file(s) selected\n"), new_sel);
@@ -963,27 +1263,19 @@ static int
 deselect_entries(char **desel_path, const size_t desel_n, int *error,
 	const int desel_screen)
 {
-	int dn = (int)desel_n;
+	int dn = 0;
 	int i = (int)desel_n;
 
+	/* Mark the entries to be deselected (clearing their name), then
+	 * compact the sel array in a single pass. The hash index makes each
+	 * lookup O(1) instead of a scan of the whole selection. */
 	while (--i >= 0) {
-		int j, k, desel_index = -1;
-
 		if (!desel_path[i])
 			continue;
 
-		/* Search the sel array for the path of the entry to be deselected and
-		 * store its index. */
-		k = (int)sel_n;
-		while (--k >= 0) {
-			if (strcmp(sel_elements[k].name, desel_path[i]) == 0) {
-				desel_index = k;
-				break;
-			}
-		}
+		const filesn_t desel_index = sel_index_lookup(desel_path[i]);
 
-		if (desel_index == -1) {
-			dn--;
+		if (desel_index == (filesn_t)-1) {
 			*error = 1;
 			if (desel_screen == 0) {
 				xerror(_("%s: '%s': No such selected file\n"),
@@ -992,29 +1284,27 @@ deselect_entries(char **desel_path, const size_t desel_n, int *error,
 			continue;
 		}
 
-		/* Once the index was found, rearrange the sel array removing the
-		 * deselected element (actually, moving each string after it to
-		 * the previous position). */
-		for (j = desel_index; j < (int)(sel_n - 1); j++) {
-			const size_t len = strlen(sel_elements[j + 1].name);
-			sel_elements[j].name =
-				xnrealloc(sel_elements[j].name, len + 1, sizeof(char));
-
-			xstrsncpy(sel_elements[j].name, sel_elements[j + 1].name, len + 1);
-			sel_elements[j].size = sel_elements[j + 1].size;
-		}
+		sel_log_push(desel_path[i], 1);
+		free(sel_elements[desel_index].name);
+		sel_elements[desel_index].name = (char *)NULL;
+		sel_elements[desel_index].size = (off_t)UNSET;
+		dn++;
 	}
 
-	/* Free the last DN entries from the old sel array. They won't
-	 * be used anymore, since they contain the same value as the last
-	 * non-deselected element due to the above array rearrangement. */
-	for (i = 1; i <= dn; i++) {
-		const int sel_index = (int)sel_n - i;
-
-		if (sel_index >= 0 && sel_elements[sel_index].name) {
-			free(sel_elements[sel_index].name);
-			sel_elements[sel_index].size = (off_t)UNSET;
+	if (dn > 0) {
+		/* Compact: move surviving entries down, preserving their order.
+		 * Entries beyond the surviving ones are stale, but the caller
+		 * shrinks the array right after based on the returned count. */
+		size_t j, k = 0;
+		for (j = 0; j < sel_n; j++) {
+			if (!sel_elements[j].name)
+				continue;
+			if (k != j)
+				sel_elements[k] = sel_elements[j];
+			k++;
 		}
+
+		sel_index_n = (size_t)-1; /* Indices changed: reindex on lookup */
 	}
 
 	return dn;
@@ -1234,7 +1524,11 @@ end_deselect(const int err, char ***args)
 	if (err)
 		return FUNC_FAILURE;
 
-	if (conf.autols == 1 && exit_status == FUNC_SUCCESS)
+	/* If the desel screen was shown (no arguments), the files list is
+	 * gone and must be reprinted; otherwise only selection marks
+	 * changed and we can patch them in place. */
+	if (conf.autols == 1 && exit_status == FUNC_SUCCESS
+	&& (argsbk == 0 || dirlist_patch_selection() == FUNC_FAILURE))
 		reload_dirlist();
 
 	if (argsbk > 0) {
@@ -1255,7 +1549,8 @@ handle_desel_args(char **args)
 		const size_t n = sel_n;
 		const int ret = deselect_all();
 
-		if (conf.autols == 1)
+		/* Only selection marks changed: patch them in place if possible */
+		if (conf.autols == 1 && dirlist_patch_selection() == FUNC_FAILURE)
 			reload_dirlist();
 
 		if (ret == FUNC_SUCCESS) {
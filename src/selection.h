@@ -33,10 +33,13 @@
 __BEGIN_DECLS
 
 int  deselect(char **args);
+void free_sel_index(void);
+int  is_file_selected(const dev_t dev, const ino_t ino, const char *name);
 void list_selected_files(void);
 int  sel_function(char **args);
 int  select_file(char *file);
 int  save_sel(void);
+void sel_log_sync(const size_t del_records);
 int  deselect_all(void);
 
 __END_DECLS
@@ -431,6 +431,9 @@ ws2=31:ws3=38;5;228:ws4=32:ws5=36:ws6=38;5;214:ws7=35:ws8=2;37:xf=1;31:xs=32:"
 #define DEF_AUTOCD 1
 #define DEF_AUTO_OPEN 1
 #define DEF_AUTOLS 1
+/* Above this number of entries in a directory, switch the listing to
+ * light mode and disable the files counter and icons (0 = never). */
+#define DEF_BIG_DIR_THRESHOLD 10000
 #define DEF_CASE_SENS_LIST 0
 #define DEF_CASE_SENS_DIRJUMP 0
 #define DEF_CASE_SENS_PATH_COMP 0
@@ -461,6 +464,7 @@ ws2=31:ws3=38;5;228:ws4=32:ws5=36:ws6=38;5;214:ws7=35:ws8=2;37:xf=1;31:xs=32:"
 #define DEF_FILES_COUNTER 1
 #define DEF_FOLLOW_SYMLINKS 1
 #define DEF_FOLLOW_SYMLINKS_LONG 0
+#define DEF_APPROX_DIR_SIZE 0
 #define DEF_FULL_DIR_SIZE 0
 #define DEF_FUZZY_MATCH 0
 #define DEF_FUZZY_MATCH_ALGO 2 /* 1 or 2. 2 is Unicode aware, but slower than 1 */
@@ -0,0 +1,603 @@
+/* snapshot.c -- session state snapshot for warm restarts */
+
+/*
+ * This file is part of CliFM
+ *
+ * Copyright (C) 2016-2024, L. Abramovich <leo.clifm@outlook.com>
+ * All rights reserved.
+
+ * CliFM is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * CliFM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+*/
+
+/* On a clean exit the parsed contents of the startup text files
+ * (actions, bookmarks, keybindings, and prompts) are serialized into a
+ * single versioned binary image (SNAPSHOT_FILE, in the profile
+ * directory). The next start reads the image with one open(2)/read(2)
+ * and restores the in-memory structures directly, skipping the text
+ * parses, provided every source file still matches the identity
+ * (device, inode, mtime, size) it had when it was parsed. On any
+ * mismatch, or on a version change, the snapshot is discarded and the
+ * regular text loaders run as usual.
+ *
+ * The other cold-start costs have their own caches: the jump database
+ * is a binary file (jump.c), the history file is mmap(2)ed
+ * (history.c), and PATH command names are cached per directory
+ * (init.c). */
+
+#include "helpers.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "aux.h" /* open_fread, load_file_to_buf */
+#include "snapshot.h"
+#include "strings.h" /* savestring */
+
+/* Identity of each source file, taken when it was parsed (see
+ * snapshot_stamp()), and written into the snapshot header on exit. */
+static struct snap_stamp_t stamps[SNAP_SECTIONS];
+
+/* Path of each stamped source file (needed at validation time; only
+ * the prompts file path is not a global). */
+static char *stamp_files[SNAP_SECTIONS];
+
+/* Sections restored from the snapshot, consumed by the loaders via
+ * snapshot_restored(). */
+static int restored[SNAP_SECTIONS];
+
+/* Record the current identity of FILE as the source of the section
+ * SECTION. Loaders call this right after parsing FILE, so that a
+ * snapshot saved at exit is tied to the file contents the in-memory
+ * structures were actually built from. */
+void
+snapshot_stamp(const int section, const char *file)
+{
+	struct stat a;
+
+	free(stamp_files[section]);
+	stamp_files[section] = (char *)NULL;
+	memset(&stamps[section], 0, sizeof(stamps[section]));
+
+	if (!file || !*file || stat(file, &a) == -1 || !S_ISREG(a.st_mode))
+		return;
+
+	stamps[section].dev = (uint64_t)a.st_dev;
+	stamps[section].ino = (uint64_t)a.st_ino;
+	stamps[section].mtime = (int64_t)a.st_mtime;
+	stamps[section].size = (int64_t)a.st_size;
+	stamps[section].present = 1;
+	stamp_files[section] = savestring(file, strlen(file));
+}
+
+/* Return 1, once, if the section SECTION was restored from the
+ * snapshot (telling the corresponding loader to skip the text parse).
+ * The flag is consumed so that later reloads parse the text file as
+ * usual. */
+int
+snapshot_restored(const int section)
+{
+	const int ret = restored[section];
+	restored[section] = 0;
+	return ret;
+}
+
+static char *
+get_snapshot_filename(void)
+{
+	if (!config_dir || !*config_dir)
+		return (char *)NULL;
+
+	const size_t len = config_dir_len + sizeof(SNAPSHOT_FILE) + 1;
+	char *name = xnmalloc(len, sizeof(char));
+	snprintf(name, len, "%s/%s", config_dir, SNAPSHOT_FILE);
+
+	return name;
+}
+
+/* ---- Serialization (save) ---- */
+
+struct snap_buf_t {
+	char *data;
+	size_t len;
+	size_t cap;
+};
+
+static void
+buf_put(struct snap_buf_t *b, const void *data, const size_t size)
+{
+	if (b->len + size > b->cap) {
+		b->cap = (b->len + size) * 2;
+		b->data = xnrealloc(b->data, b->cap, sizeof(char));
+	}
+
+	memcpy(b->data + b->len, data, size);
+	b->len += size;
+}
+
+static void
+buf_put_u32(struct snap_buf_t *b, const uint32_t n)
+{
+	buf_put(b, &n, sizeof(n));
+}
+
+/* Append the string STR: a length word (string length plus one, or
+ * zero for a NULL pointer) followed by the bytes, NUL included. */
+static void
+buf_put_str(struct snap_buf_t *b, const char *str)
+{
+	if (!str) {
+		buf_put_u32(b, 0);
+		return;
+	}
+
+	const size_t size = strlen(str) + 1;
+	buf_put_u32(b, (uint32_t)size);
+	buf_put(b, str, size);
+}
+
+static void
+save_actions_section(struct snap_buf_t *b)
+{
+	buf_put_u32(b, (uint32_t)actions_n);
+
+	size_t i;
+	for (i = 0; i < actions_n; i++) {
+		buf_put_str(b, usr_actions[i].name);
+		buf_put_str(b, usr_actions[i].value);
+	}
+}
+
+static void
+save_bookmarks_section(struct snap_buf_t *b)
+{
+	buf_put_u32(b, (uint32_t)bm_n);
+
+	size_t i;
+	for (i = 0; i < bm_n; i++) {
+		buf_put_str(b, bookmarks[i].shortcut);
+		buf_put_str(b, bookmarks[i].name);
+		buf_put_str(b, bookmarks[i].path);
+	}
+}
+
+static void
+save_keybinds_section(struct snap_buf_t *b)
+{
+	buf_put_u32(b, (uint32_t)kbinds_n);
+
+	size_t i;
+	for (i = 0; i < kbinds_n; i++) {
+		buf_put_str(b, kbinds[i].function);
+		buf_put_str(b, kbinds[i].key);
+	}
+}
+
+static void
+save_prompts_section(struct snap_buf_t *b)
+{
+	buf_put_str(b, stamp_files[SNAP_PROMPTS]);
+	buf_put_u32(b, (uint32_t)prompts_n);
+
+	size_t i;
+	for (i = 0; i < prompts_n; i++) {
+		buf_put_str(b, prompts[i].name);
+		buf_put_str(b, prompts[i].regular);
+		buf_put_str(b, prompts[i].warning);
+		buf_put_u32(b, (uint32_t)prompts[i].notifications);
+		buf_put_u32(b, (uint32_t)prompts[i].warning_prompt_enabled);
+	}
+}
+
+/* Serialize the startup structures into the snapshot file. Called on
+ * a clean exit, before the structures are freed. The image is written
+ * to a temporary file and renamed into place, so a crash mid-write
+ * never leaves a truncated snapshot behind. */
+void
+save_session_snapshot(void)
+{
+	if (xargs.stealth_mode == 1 || config_ok == 0)
+		return;
+
+	char *name = get_snapshot_filename();
+	if (!name)
+		return;
+
+	struct snap_buf_t b = {0};
+
+	struct snap_hdr_t hdr = {0};
+	memcpy(hdr.magic, SNAPSHOT_MAGIC, sizeof(hdr.magic));
+	hdr.version = SNAPSHOT_VERSION;
+	buf_put(&b, &hdr, sizeof(hdr));
+	buf_put(&b, stamps, sizeof(stamps));
+
+	save_actions_section(&b);
+	save_bookmarks_section(&b);
+	save_keybinds_section(&b);
+	save_prompts_section(&b);
+
+	const size_t tmp_len = strlen(name) + 32;
+	char *tmp = xnmalloc(tmp_len, sizeof(char));
+	snprintf(tmp, tmp_len, "%s.%u", name, (unsigned int)getpid());
+
+	const int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+	if (fd != -1) {
+		const ssize_t written = write(fd, b.data, b.len);
+		close(fd);
+		if (written == (ssize_t)b.len)
+			rename(tmp, name);
+		else
+			unlink(tmp);
+	}
+
+	free(b.data);
+	free(tmp);
+	free(name);
+}
+
+/* ---- Deserialization (load) ---- */
+
+struct snap_reader_t {
+	const char *p;
+	size_t left;
+};
+
+static int
+rd_get(struct snap_reader_t *r, void *dst, const size_t size)
+{
+	if (r->left < size)
+		return FUNC_FAILURE;
+
+	memcpy(dst, r->p, size);
+	r->p += size;
+	r->left -= size;
+	return FUNC_SUCCESS;
+}
+
+static int
+rd_get_u32(struct snap_reader_t *r, uint32_t *n)
+{
+	return rd_get(r, n, sizeof(*n));
+}
+
+/* Read a string as written by buf_put_str(). *STR is set to a fresh
+ * heap copy, or NULL if a NULL pointer was serialized. */
+static int
+rd_get_str(struct snap_reader_t *r, char **str)
+{
+	*str = (char *)NULL;
+
+	uint32_t size = 0;
+	if (rd_get_u32(r, &size) == FUNC_FAILURE)
+		return FUNC_FAILURE;
+
+	if (size == 0)
+		return FUNC_SUCCESS;
+
+	if (r->left < size || r->p[size - 1] != '\0')
+		return FUNC_FAILURE;
+
+	*str = savestring(r->p, (size_t)size - 1);
+	r->p += size;
+	r->left -= size;
+	return FUNC_SUCCESS;
+}
+
+/* Return 1 if the stamp STAMP still describes the file FILE. */
+static int
+stamp_matches(const struct snap_stamp_t *stamp, const char *file)
+{
+	struct stat a;
+
+	if (stamp->present == 0)
+		/* The section was never parsed: nothing to contradict. */
+		return 1;
+
+	if (!file || !*file || stat(file, &a) == -1 || !S_ISREG(a.st_mode))
+		return 0;
+
+	return (stamp->dev == (uint64_t)a.st_dev
+		&& stamp->ino == (uint64_t)a.st_ino
+		&& stamp->mtime == (int64_t)a.st_mtime
+		&& stamp->size == (int64_t)a.st_size);
+}
+
+static int
+load_actions_section(struct snap_reader_t *r, const int restore)
+{
+	uint32_t count = 0;
+	if (rd_get_u32(r, &count) == FUNC_FAILURE)
+		return FUNC_FAILURE;
+
+	struct actions_t *a = restore && count > 0
+		? xnmalloc(count, sizeof(struct actions_t)) : (struct actions_t *)NULL;
+
+	uint32_t i;
+	for (i = 0; i < count; i++) {
+		char *name = (char *)NULL, *value = (char *)NULL;
+		if (rd_get_str(r, &name) == FUNC_FAILURE
+		|| rd_get_str(r, &value) == FUNC_FAILURE || !name || !value) {
+			free(name); free(value);
+			while (i-- > 0) {
+				if (a) { free(a[i].name); free(a[i].value); }
+			}
+			free(a);
+			return FUNC_FAILURE;
+		}
+
+		if (a) {
+			a[i].name = name;
+			a[i].value = value;
+		} else {
+			free(name); free(value);
+		}
+	}
+
+	if (a) {
+		free(usr_actions);
+		usr_actions = a;
+		actions_n = count;
+		restored[SNAP_ACTIONS] = 1;
+	}
+
+	return FUNC_SUCCESS;
+}
+
+static int
+load_bookmarks_section(struct snap_reader_t *r, const int restore)
+{
+	uint32_t count = 0;
+	if (rd_get_u32(r, &count) == FUNC_FAILURE)
+		return FUNC_FAILURE;
+
+	struct bookmarks_t *bm = restore && count > 0
+		? xnmalloc((size_t)count + 1, sizeof(struct bookmarks_t))
+		: (struct bookmarks_t *)NULL;
+
+	uint32_t i;
+	for (i = 0; i < count; i++) {
+		char *sc = (char *)NULL, *name = (char *)NULL, *path = (char *)NULL;
+		if (rd_get_str(r, &sc) == FUNC_FAILURE
+		|| rd_get_str(r, &name) == FUNC_FAILURE
+		|| rd_get_str(r, &path) == FUNC_FAILURE) {
+			free(sc); free(name); free(path);
+			while (i-- > 0) {
+				if (bm) {
+					free(bm[i].shortcut); free(bm[i].name); free(bm[i].path);
+				}
+			}
+			free(bm);
+			return FUNC_FAILURE;
+		}
+
+		if (bm) {
+			bm[i].shortcut = sc;
+			bm[i].name = name;
+			bm[i].path = path;
+		} else {
+			free(sc); free(name); free(path);
+		}
+	}
+
+	if (bm) {
+		bm[count].shortcut = (char *)NULL;
+		bm[count].name = (char *)NULL;
+		bm[count].path = (char *)NULL;
+		bookmarks = bm;
+		bm_n = count;
+		restored[SNAP_BOOKMARKS] = 1;
+	}
+
+	return FUNC_SUCCESS;
+}
+
+static int
+load_keybinds_section(struct snap_reader_t *r, const int restore)
+{
+	uint32_t count = 0;
+	if (rd_get_u32(r, &count) == FUNC_FAILURE)
+		return FUNC_FAILURE;
+
+	struct kbinds_t *kb = restore && count > 0
+		? xnmalloc(count, sizeof(struct kbinds_t)) : (struct kbinds_t *)NULL;
+
+	uint32_t i;
+	for (i = 0; i < count; i++) {
+		char *function = (char *)NULL, *key = (char *)NULL;
+		if (rd_get_str(r, &function) == FUNC_FAILURE
+		|| rd_get_str(r, &key) == FUNC_FAILURE || !function || !key) {
+			free(function); free(key);
+			while (i-- > 0) {
+				if (kb) { free(kb[i].function); free(kb[i].key); }
+			}
+			free(kb);
+			return FUNC_FAILURE;
+		}
+
+		if (kb) {
+			kb[i].function = function;
+			kb[i].key = key;
+		} else {
+			free(function); free(key);
+		}
+	}
+
+	if (kb) {
+		free(kbinds);
+		kbinds = kb;
+		kbinds_n = count;
+		restored[SNAP_KEYBINDS] = 1;
+	}
+
+	return FUNC_SUCCESS;
+}
+
+static int
+load_prompts_section(struct snap_reader_t *r, const int restore)
+{
+	char *file = (char *)NULL;
+	if (rd_get_str(r, &file) == FUNC_FAILURE)
+		return FUNC_FAILURE;
+
+	uint32_t count = 0;
+	if (rd_get_u32(r, &count) == FUNC_FAILURE) {
+		free(file);
+		return FUNC_FAILURE;
+	}
+
+	struct prompts_t *pm = restore && count > 0
+		? xnmalloc((size_t)count + 1, sizeof(struct prompts_t))
+		: (struct prompts_t *)NULL;
+
+	uint32_t i;
+	for (i = 0; i < count; i++) {
+		char *name = (char *)NULL, *reg = (char *)NULL, *warn = (char *)NULL;
+		uint32_t notif = 0, wp = 0;
+		if (rd_get_str(r, &name) == FUNC_FAILURE
+		|| rd_get_str(r, &reg) == FUNC_FAILURE
+		|| rd_get_str(r, &warn) == FUNC_FAILURE
+		|| rd_get_u32(r, &notif) == FUNC_FAILURE
+		|| rd_get_u32(r, &wp) == FUNC_FAILURE) {
+			free(name); free(reg); free(warn);
+			while (i-- > 0) {
+				if (pm) {
+					free(pm[i].name); free(pm[i].regular); free(pm[i].warning);
+				}
+			}
+			free(pm);
+			free(file);
+			return FUNC_FAILURE;
+		}
+
+		if (pm) {
+			pm[i].name = name;
+			pm[i].regular = reg;
+			pm[i].warning = warn;
+			pm[i].notifications = (int)notif;
+			pm[i].warning_prompt_enabled = (int)wp;
+		} else {
+			free(name); free(reg); free(warn);
+		}
+	}
+
+	if (pm) {
+		pm[count].name = (char *)NULL;
+		pm[count].regular = (char *)NULL;
+		pm[count].warning = (char *)NULL;
+		pm[count].notifications = DEF_PROMPT_NOTIF;
+		pm[count].warning_prompt_enabled = DEF_WARNING_PROMPT;
+		prompts = pm;
+		prompts_n = count;
+
+		free(prompts_file);
+		prompts_file = file ? savestring(file, strlen(file)) : (char *)NULL;
+		free(stamp_files[SNAP_PROMPTS]);
+		stamp_files[SNAP_PROMPTS] = file
+			? savestring(file, strlen(file)) : (char *)NULL;
+		restored[SNAP_PROMPTS] = 1;
+	}
+
+	free(file);
+	return FUNC_SUCCESS;
+}
+
+/* Load the session snapshot, if any, restoring the structures whose
+ * source files are unchanged since the snapshot was written. Called at
+ * startup, after config file names are defined and before the text
+ * loaders run. Returns FUNC_SUCCESS if a valid snapshot was loaded. */
+int
+load_session_snapshot(void)
+{
+	if (xargs.stealth_mode == 1 || config_ok == 0)
+		return FUNC_FAILURE;
+
+	char *name = get_snapshot_filename();
+	if (!name)
+		return FUNC_FAILURE;
+
+	int fd;
+	FILE *fp = open_fread(name, &fd);
+	free(name);
+	if (!fp)
+		return FUNC_FAILURE;
+
+	char *buf = load_file_to_buf(fd);
+	struct stat a;
+	const size_t buf_size = (buf && fstat(fd, &a) != -1) ? (size_t)a.st_size : 0;
+	fclose(fp);
+	if (!buf)
+		return FUNC_FAILURE;
+
+	struct snap_reader_t r = {buf, buf_size};
+	int ret = FUNC_FAILURE;
+
+	struct snap_hdr_t hdr;
+	struct snap_stamp_t file_stamps[SNAP_SECTIONS];
+	if (rd_get(&r, &hdr, sizeof(hdr)) == FUNC_FAILURE
+	|| memcmp(hdr.magic, SNAPSHOT_MAGIC, sizeof(hdr.magic)) != 0
+	|| hdr.version != SNAPSHOT_VERSION
+	|| rd_get(&r, file_stamps, sizeof(file_stamps)) == FUNC_FAILURE)
+		goto END;
+
+	/* The prompts source file path is stored in its section: peek at it
+	 * for validation without disturbing the reader. */
+	struct snap_reader_t peek;
+
+	const int valid =
+		stamp_matches(&file_stamps[SNAP_ACTIONS], actions_file)
+		&& stamp_matches(&file_stamps[SNAP_BOOKMARKS], bm_file)
+		&& stamp_matches(&file_stamps[SNAP_KEYBINDS], kbinds_file);
+
+	if (valid == 0)
+		goto END;
+
+	/* Sections are read in the order they were written. A section whose
+	 * stamp marks it as never parsed is skipped over (restore == 0) so
+	 * the regular loader runs for it. */
+	if (load_actions_section(&r, file_stamps[SNAP_ACTIONS].present)
+	== FUNC_FAILURE)
+		goto END;
+	if (load_bookmarks_section(&r, file_stamps[SNAP_BOOKMARKS].present)
+	== FUNC_FAILURE)
+		goto END;
+	if (load_keybinds_section(&r, file_stamps[SNAP_KEYBINDS].present)
+	== FUNC_FAILURE)
+		goto END;
+
+	/* Validate the prompts source file against the path stored in the
+	 * section itself. */
+	peek = r;
+	char *pfile = (char *)NULL;
+	int prestore = 0;
+	if (rd_get_str(&peek, &pfile) == FUNC_SUCCESS)
+		prestore = file_stamps[SNAP_PROMPTS].present
+			&& stamp_matches(&file_stamps[SNAP_PROMPTS], pfile);
+	free(pfile);
+
+	if (load_prompts_section(&r, prestore) == FUNC_FAILURE)
+		goto END;
+
+	/* Restored sections keep their original stamps, so a snapshot saved
+	 * at the end of this session remains tied to the parsed sources. */
+	memcpy(stamps, file_stamps, sizeof(stamps));
+	ret = FUNC_SUCCESS;
+
+END:
+	free(buf);
+	return ret;
+}
@@ -0,0 +1,71 @@
+/* snapshot.h */
+
+/*
+ * This file is part of CliFM
+ *
+ * Copyright (C) 2016-2024, L. Abramovich <leo.clifm@outlook.com>
+ * All rights reserved.
+
+ * CliFM is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * CliFM is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+*/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+
+#define SNAPSHOT_FILE    "session.clifm.bin"
+#define SNAPSHOT_MAGIC   "CLIFMSNP"
+#define SNAPSHOT_VERSION 1
+
+/* Sections of the session snapshot. Each corresponds to one structure
+ * built from a text file at startup; the enum values index the stamp
+ * array in the snapshot header. */
+enum snap_section {
+	SNAP_ACTIONS,
+	SNAP_BOOKMARKS,
+	SNAP_KEYBINDS,
+	SNAP_PROMPTS,
+	SNAP_SECTIONS /* Number of sections: keep it last */
+};
+
+struct snap_hdr_t {
+	char magic[8];
+	uint32_t version;
+	uint32_t pad0;
+};
+
+/* Identity of a source file at the time it was parsed. A snapshot is
+ * valid only while every stamped source file still matches. */
+struct snap_stamp_t {
+	uint64_t dev;
+	uint64_t ino;
+	int64_t mtime;
+	int64_t size;
+	int32_t present; /* 0: the section was never parsed/saved */
+	int32_t pad0;
+};
+
+__BEGIN_DECLS
+
+int  load_session_snapshot(void);
+void save_session_snapshot(void);
+int  snapshot_restored(const int section);
+void snapshot_stamp(const int section, const char *file);
+
+__END_DECLS
+
+#endif /* SNAPSHOT_H */
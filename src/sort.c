@@ -24,13 +24,16 @@
 
 #include "helpers.h"
 
+#include <pthread.h> /* dirs_first_sort() segment threads */
 #include <stdio.h>
+#include <stdlib.h> /* qsort */
 #include <string.h>
 #include <unistd.h>
 #include <strings.h> /* str(n)casecmp() */
 
 #include "checks.h"
 #include "aux.h" /* xatoi */
+#include "mem.h" /* xnmalloc */
 #include "listing.h"
 #include "messages.h" /* SORT_USAGE */
 
@@ -110,13 +113,17 @@ compare_strings(char **s1, char **s2)
 #endif /* HAVE_STRCOLL */
 }
 
+/* Compare the names of the files PA and PB via the sort keys cached by
+ * init_sort_keys(): SNAME (non-alphanumeric prefix already skipped) or,
+ * for case insensitive sorts, the matching suffix of NAME's case-folded
+ * shadow FNAME, so that no character is re-folded inside the comparison
+ * callback. */
 static int
-namecmp(char *s1, char *s2)
+namecmp(const struct fileinfo *pa, const struct fileinfo *pb)
 {
-	if (conf.skip_non_alnum_prefix == 1) {
-		skip_name_prefixes(&s1);
-		skip_name_prefixes(&s2);
-	}
+	const int ci = (!conf.case_sens_list && pa->fname && pb->fname);
+	char *s1 = ci ? pa->fname + (pa->sname - pa->name) : pa->sname;
+	char *s2 = ci ? pb->fname + (pb->sname - pb->name) : pb->sname;
 
 	/* If both strings start with number, sort them as numbers, not as strings */
 	if (IS_DIGIT(*s1) && IS_DIGIT(*s2)) {
@@ -133,8 +140,8 @@ namecmp(char *s1, char *s2)
 
 	if ((*s1 & 0xc0) != 0xc0 && (*s2 & 0xc0) != 0xc0) {
 	/* None of the strings starts with a unicode char: compare the first
-	 * byte of both strings */
-		if (!conf.case_sens_list) {
+	 * byte of both strings (already folded if the sort ignores case) */
+		if (!conf.case_sens_list && ci == 0) {
 			ac = (char)TOLOWER(*s1);
 			bc = (char)TOLOWER(*s2);
 		}
@@ -146,39 +153,34 @@ namecmp(char *s1, char *s2)
 			return 1;
 	}
 
+	int ret;
 	if (!conf.case_sens_list || (*s1 & 0xc0) == 0xc0 || (*s2 & 0xc0) == 0xc0)
-		return strcoll(s1, s2);
+		ret = strcoll(s1, s2);
+	else
+		ret = strcmp(s1, s2);
+
+	/* Names equal up to case: fall back to the original names to keep
+	 * the order deterministic. */
+	if (ret == 0 && ci == 1)
+		ret = strcmp(pa->sname, pb->sname);
 
-	return strcmp(s1, s2);
+	return ret;
 }
 
+/* Compare the file extensions AEXT and BEXT, as cached by
+ * init_sort_keys() (either may be NULL: no extension). */
 static inline int
-sort_by_extension(const char *n1, const char *n2, const int n1dir,
-	const int n2dir)
+sort_by_extension(const char *aext, const char *bext)
 {
-	int ret = 0;
-	char *aext = (char *)NULL, *bext = (char *)NULL, *val;
-
-	/* If the entry is a directory, we don't take it as having an extension,
-	 * even if it has a dot in its name. */
-	val = n1dir == 0 ? strrchr(n1, '.') : (char *)NULL;
-	if (val && val != n1)
-		aext = val + 1;
-
-	val = n2dir == 0 ? strrchr(n2, '.') : (char *)NULL;
-	if (val && val != n2)
-		bext = val + 1;
-
 	if (aext || bext) {
 		if (!aext)
-			ret = -1;
-		else if (!bext)
-			ret = 1;
-		else
-			ret = strcasecmp(aext, bext);
+			return (-1);
+		if (!bext)
+			return 1;
+		return strcasecmp(aext, bext);
 	}
 
-	return ret;
+	return 0;
 }
 
 static inline int
@@ -297,6 +299,63 @@ sort_dirs(const int a, const int b)
 	return 0;
 }
 
+/* Compute the per-entry sort keys consumed by entrycmp() for the N
+ * entries in LIST: SNAME, the name with its non-alphanumeric prefix
+ * skipped (a pointer into NAME, so it costs no allocation), and, when
+ * sorting by extension, SEXT, the name's extension (or NULL).
+ *
+ * entrycmp() used to recompute both keys on every comparison, i.e.
+ * O(n log n) times per sort. Computing them here, once per entry, makes
+ * re-sorting (e.g. via the 'st' command) a matter of key comparisons. */
+void
+init_sort_keys(struct fileinfo *list, const filesn_t n)
+{
+	int st = conf.sort;
+	if (conf.light_mode == 1 && !ST_IN_LIGHT_MODE(st))
+		st = SNAME;
+
+	filesn_t i;
+	for (i = 0; i < n; i++) {
+		char *name = list[i].name;
+		if (conf.skip_non_alnum_prefix == 1)
+			skip_name_prefixes(&name);
+		list[i].sname = name;
+
+		list[i].fname = (char *)NULL;
+		if (conf.case_sens_list == 0 || conf.case_sens_path_comp == 0) {
+			/* Cache a case-folded shadow of the whole name: case
+			 * insensitive sorts compare it (offset to SNAME) instead of
+			 * re-folding the same bytes on every comparison, and case
+			 * insensitive completion/suggestions match against it with
+			 * a single memcmp() per candidate (see check_filenames()
+			 * in suggestions.c). */
+			char *f = fiarena_savestring(list[i].name,
+				strlen(list[i].name));
+			list[i].fname = f;
+			while (*f) {
+				*f = (char)TOLOWER(*f);
+				f++;
+			}
+		}
+
+		if (st != SEXT) {
+			list[i].sext = (char *)NULL;
+			continue;
+		}
+
+		/* If the entry is a directory, we don't take it as having an
+		 * extension, even if it has a dot in its name. */
+		char *dot = list[i].dir == 0
+			? strrchr(list[i].name, '.') : (char *)NULL;
+		list[i].sext = (dot && dot != list[i].name) ? dot + 1 : (char *)NULL;
+	}
+}
+
+/* Set while dirs_first_sort() runs the per-segment sorts: the list is
+ * already partitioned into directories and files, so entrycmp() can
+ * skip the dirs-first check (it would never fire within a segment). */
+static int dirs_partitioned = 0;
+
 int
 entrycmp(const void *a, const void *b)
 {
@@ -304,7 +363,7 @@ entrycmp(const void *a, const void *b)
 	struct fileinfo *pb = (struct fileinfo *)b;
 	int ret = 0, st = conf.sort;
 
-	if (conf.list_dirs_first == 1) {
+	if (conf.list_dirs_first == 1 && dirs_partitioned == 0) {
 		ret = sort_dirs(pa->dir, pb->dir);
 		if (ret != 0)
 			return ret;
@@ -321,7 +380,7 @@ entrycmp(const void *a, const void *b)
 	case SMTIME: ret = sort_by_time(pa->time, pb->time); break;
 	case SVER: ret = xstrverscmp(pa->name, pb->name); break;
 	case SEXT:
-		ret = sort_by_extension(pa->name, pb->name, pa->dir, pb->dir); break;
+		ret = sort_by_extension(pa->sext, pb->sext); break;
 	case SINO: ret = sort_by_inode(pa->inode, pb->inode); break;
 	case SOWN: ret = sort_by_owner(pa->uid, pb->uid); break;
 	case SGRP: ret = sort_by_group(pa->gid, pb->gid); break;
@@ -331,7 +390,7 @@ entrycmp(const void *a, const void *b)
 	}
 
 	if (!ret)
-		ret = namecmp(pa->name, pb->name);
+		ret = namecmp(pa, pb);
 	if (!conf.sort_reverse)
 		return ret;
 
@@ -339,6 +398,451 @@ entrycmp(const void *a, const void *b)
 	return (-ret);
 }
 
+/* Indirect comparison sort for the file list.
+ *
+ * struct fileinfo is over three cache lines wide, and most of it is
+ * cold as far as sorting goes (colors, icons, ownership, rendered
+ * strings): a qsort(3) over the structs themselves moves all of that
+ * through L1 on every swap, and partition scans stride across it. For
+ * large lists we sort an array of pointers instead -- 8-byte elements,
+ * with entrycmp() touching only the hot fields it actually compares --
+ * and then apply the resulting order to the struct array in a single
+ * O(n) gather pass. Small lists stay on the direct sort, where the
+ * extra pass would cost more than it saves. */
+
+#define PTRSORT_MIN_ENTRIES 512
+
+static int
+entrycmp_ptr(const void *a, const void *b)
+{
+	return entrycmp(*(struct fileinfo *const *)a,
+		*(struct fileinfo *const *)b);
+}
+
+/* Parallel sort for very large listings.
+ *
+ * A single-threaded qsort(3) over a million entries takes noticeable
+ * time even with cheap comparisons. Above PARSORT_MIN_ENTRIES the
+ * pointer array is split into one chunk per available core (the same
+ * count the parallel stat phase uses, see pstat_get_threads()), each
+ * chunk is sorted in its own thread, and the sorted runs are then
+ * merged pairwise, also in parallel, until one run is left. The
+ * comparator is entrycmp(), as everywhere else: it and its helpers
+ * only read shared state. */
+
+#define PARSORT_MIN_ENTRIES (1 << 16)
+#define PARSORT_MAX_CHUNKS  16 /* Power of two, <= PSTAT_MAX_THREADS */
+
+struct parsort_run_t {
+	struct fileinfo **src;
+	struct fileinfo **dst;
+	filesn_t lo;
+	filesn_t mid; /* Unused (0) in the chunk-sort phase */
+	filesn_t hi;
+};
+
+static void *
+parsort_chunk_thread(void *arg)
+{
+	struct parsort_run_t *r = (struct parsort_run_t *)arg;
+	qsort(r->src + r->lo, (size_t)(r->hi - r->lo),
+		sizeof(struct fileinfo *), entrycmp_ptr);
+	return NULL;
+}
+
+static void
+parsort_merge(struct fileinfo **src, struct fileinfo **dst,
+	const filesn_t lo, const filesn_t mid, const filesn_t hi)
+{
+	filesn_t i = lo, j = mid, k = lo;
+
+	while (i < mid && j < hi)
+		dst[k++] = entrycmp(src[i], src[j]) <= 0 ? src[i++] : src[j++];
+	while (i < mid)
+		dst[k++] = src[i++];
+	while (j < hi)
+		dst[k++] = src[j++];
+}
+
+static void *
+parsort_merge_thread(void *arg)
+{
+	struct parsort_run_t *r = (struct parsort_run_t *)arg;
+	parsort_merge(r->src, r->dst, r->lo, r->mid, r->hi);
+	return NULL;
+}
+
+/* Sort the pointer array PTRS (N entries) in parallel. Returns
+ * FUNC_SUCCESS, or FUNC_FAILURE if the list is too small (or only one
+ * core is available), in which case the caller sorts serially. */
+static int
+parsort(struct fileinfo **ptrs, const filesn_t n)
+{
+	const int nthreads = pstat_get_threads();
+	if (n < PARSORT_MIN_ENTRIES || nthreads < 2)
+		return FUNC_FAILURE;
+
+	/* A power-of-two chunk count keeps the merge rounds regular. */
+	int chunks = 2;
+	while (chunks * 2 <= nthreads && chunks * 2 <= PARSORT_MAX_CHUNKS)
+		chunks *= 2;
+
+	filesn_t bounds[PARSORT_MAX_CHUNKS + 1];
+	int c;
+	for (c = 0; c < chunks; c++)
+		bounds[c] = (filesn_t)(((long long)n * c) / chunks);
+	bounds[chunks] = n;
+
+	/* Phase 1: sort each chunk (the current thread takes the last
+	 * one; chunks whose thread could not be created are taken too). */
+	pthread_t threads[PARSORT_MAX_CHUNKS];
+	struct parsort_run_t runs[PARSORT_MAX_CHUNKS];
+	int started[PARSORT_MAX_CHUNKS] = {0};
+
+	for (c = 0; c < chunks; c++)
+		runs[c] = (struct parsort_run_t){ptrs, NULL, bounds[c], 0,
+			bounds[c + 1]};
+
+	for (c = 0; c < chunks - 1; c++)
+		started[c] =
+			(pthread_create(&threads[c], NULL, parsort_chunk_thread,
+				&runs[c]) == 0);
+
+	parsort_chunk_thread(&runs[chunks - 1]);
+
+	for (c = 0; c < chunks - 1; c++) {
+		if (started[c] == 1)
+			pthread_join(threads[c], NULL);
+		else
+			parsort_chunk_thread(&runs[c]);
+	}
+
+	/* Phase 2: merge adjacent runs pairwise, ping-ponging between the
+	 * two buffers, until a single run remains. */
+	struct fileinfo **buf =
+		xnmalloc((size_t)n, sizeof(struct fileinfo *));
+	struct fileinfo **src = ptrs, **dst = buf;
+	int nruns = chunks;
+
+	while (nruns > 1) {
+		const int pairs = nruns / 2;
+		int p;
+
+		for (p = 0; p < pairs; p++)
+			runs[p] = (struct parsort_run_t){src, dst,
+				bounds[p * 2], bounds[(p * 2) + 1], bounds[(p * 2) + 2]};
+
+		for (p = 0; p < pairs - 1; p++)
+			started[p] =
+				(pthread_create(&threads[p], NULL, parsort_merge_thread,
+					&runs[p]) == 0);
+
+		parsort_merge_thread(&runs[pairs - 1]);
+
+		for (p = 0; p < pairs - 1; p++) {
+			if (started[p] == 1)
+				pthread_join(threads[p], NULL);
+			else
+				parsort_merge_thread(&runs[p]);
+		}
+
+		for (p = 0; p <= pairs; p++)
+			bounds[p] = bounds[p * 2];
+
+		nruns = pairs;
+		struct fileinfo **tmp = src;
+		src = dst;
+		dst = tmp;
+	}
+
+	if (src != ptrs)
+		memcpy(ptrs, src, (size_t)n * sizeof(struct fileinfo *));
+	free(buf);
+
+	return FUNC_SUCCESS;
+}
+
+int
+entry_ptr_sort(struct fileinfo *list, const filesn_t n)
+{
+	if (n < PTRSORT_MIN_ENTRIES)
+		return FUNC_FAILURE;
+
+	struct fileinfo **ptrs = xnmalloc((size_t)n, sizeof(struct fileinfo *));
+	filesn_t i;
+	for (i = 0; i < n; i++)
+		ptrs[i] = list + i;
+
+	if (parsort(ptrs, n) == FUNC_FAILURE)
+		qsort(ptrs, (size_t)n, sizeof(struct fileinfo *), entrycmp_ptr);
+
+	struct fileinfo *tmp = xnmalloc((size_t)n, sizeof(struct fileinfo));
+	for (i = 0; i < n; i++)
+		tmp[i] = *ptrs[i];
+
+	memcpy(list, tmp, (size_t)n * sizeof(struct fileinfo));
+	free(tmp);
+	free(ptrs);
+
+	return FUNC_SUCCESS;
+}
+
+/* Bucket pre-pass (an MSD radix step) for name-based sorts.
+ *
+ * For sorts by name and by version, the first decision entrycmp() makes
+ * for most pairs is a plain byte comparison of the first (case-folded)
+ * name characters. Instead of paying a full comparison call per pair, we
+ * distribute entries into buckets keyed by directory/file class plus
+ * first name byte in a single O(n) pass, and run the comparison sort
+ * only inside each bucket, where that first decision is a tie.
+ *
+ * The pass preserves entrycmp() order exactly, and bails out whenever it
+ * could not (non-ASCII first bytes bring locale collation into play, and
+ * all names starting with a digit share one bucket, since numeric names
+ * are compared as numbers). init_sort_keys() must have run on LIST. */
+
+#define RADIX_MIN_ENTRIES 512
+/* Dirs-first bit + first name byte */
+#define RADIX_BUCKETS     512
+
+int
+name_radix_sort(struct fileinfo *list, const filesn_t n)
+{
+	int st = conf.sort;
+	if (conf.light_mode == 1 && !ST_IN_LIGHT_MODE(st))
+		st = SNAME;
+
+	if ((st != SNAME && st != SVER) || n < RADIX_MIN_ENTRIES)
+		return FUNC_FAILURE;
+
+	/* Both namecmp() and xstrverscmp() fold case on demand. */
+	const int fold = (conf.case_sens_list == 0);
+
+	uint16_t *buckets = xnmalloc((size_t)n, sizeof(uint16_t));
+	filesn_t counts[RADIX_BUCKETS] = {0};
+
+	filesn_t i;
+	for (i = 0; i < n; i++) {
+		unsigned char c = (unsigned char)*list[i].sname;
+		if (c >= 0x80) {
+			/* Locale collation takes over: let entrycmp() decide. */
+			free(buckets);
+			return FUNC_FAILURE;
+		}
+
+		if (IS_DIGIT(c))
+			c = '0'; /* Numeric names are compared as numbers. */
+		else if (fold)
+			c = (unsigned char)TOLOWER(c);
+
+		const uint16_t b = (uint16_t)(((conf.list_dirs_first == 1
+			&& list[i].dir != 1) ? 256 : 0) + c);
+
+		buckets[i] = b;
+		counts[b]++;
+	}
+
+	/* Compute each bucket's starting offset. A reversed sort walks the
+	 * byte buckets backwards, but keeps directories first: entrycmp()
+	 * never reverses the dirs-first decision. */
+	filesn_t offsets[RADIX_BUCKETS];
+	filesn_t next[RADIX_BUCKETS];
+	filesn_t start = 0;
+	int b;
+
+	if (conf.sort_reverse == 0) {
+		for (b = 0; b < RADIX_BUCKETS; b++) {
+			offsets[b] = start;
+			start += counts[b];
+		}
+	} else {
+		for (int base = 0; base < RADIX_BUCKETS; base += 256) {
+			for (int c = 255; c >= 0; c--) {
+				b = base + c;
+				offsets[b] = start;
+				start += counts[b];
+			}
+		}
+	}
+
+	memcpy(next, offsets, sizeof(next));
+
+	/* Scatter the entries into bucket order. */
+	struct fileinfo *tmp = xnmalloc((size_t)n, sizeof(struct fileinfo));
+	for (i = 0; i < n; i++) {
+		tmp[next[buckets[i]]] = list[i];
+		next[buckets[i]]++;
+	}
+
+	memcpy(list, tmp, (size_t)n * sizeof(struct fileinfo));
+	free(tmp);
+	free(buckets);
+
+	/* Entries sharing a bucket still need the full comparison (done
+	 * indirectly when the bucket is large enough, see
+	 * entry_ptr_sort()). */
+	for (b = 0; b < RADIX_BUCKETS; b++) {
+		if (counts[b] > 1
+		&& entry_ptr_sort(list + offsets[b], counts[b]) == FUNC_FAILURE) {
+			qsort(list + offsets[b], (size_t)counts[b],
+				sizeof(struct fileinfo), entrycmp);
+		}
+	}
+
+	return FUNC_SUCCESS;
+}
+
+/* Dirs-first grouping as a partition pass.
+ *
+ * With ListDirsFirst enabled (the default), every entrycmp() call
+ * starts by comparing the dir flags of the pair -- a branch that is
+ * only productive O(n) times over a whole sort: once an entry's class
+ * is known, comparisons within its class never take it. Partition the
+ * list into a directories segment followed by a files segment in one
+ * stable O(n) pass instead, then sort each segment independently (in
+ * parallel when both are big enough), with the comparator branch
+ * disabled. */
+
+static void
+sort_segment(struct fileinfo *seg, const filesn_t n)
+{
+	if (n < 2)
+		return;
+
+	if (name_radix_sort(seg, n) == FUNC_FAILURE
+	&& entry_ptr_sort(seg, n) == FUNC_FAILURE)
+		qsort(seg, (size_t)n, sizeof(struct fileinfo), entrycmp);
+}
+
+struct seg_sort_t {
+	struct fileinfo *seg;
+	filesn_t n;
+};
+
+static void *
+sort_segment_thread(void *arg)
+{
+	struct seg_sort_t *s = (struct seg_sort_t *)arg;
+	sort_segment(s->seg, s->n);
+	return NULL;
+}
+
+int
+dirs_first_sort(struct fileinfo *list, const filesn_t n)
+{
+	if (conf.list_dirs_first != 1 || n < 2)
+		return FUNC_FAILURE;
+
+	/* Stable partition: directories to the front, files into a spill
+	 * buffer, both classes keeping their relative order. D only ever
+	 * trails I, so the in-place compaction overwrites nothing unread. */
+	struct fileinfo *spill = xnmalloc((size_t)n, sizeof(struct fileinfo));
+	filesn_t d = 0, f = 0, i;
+
+	for (i = 0; i < n; i++) {
+		if (list[i].dir == 1)
+			list[d++] = list[i];
+		else
+			spill[f++] = list[i];
+	}
+
+	memcpy(list + d, spill, (size_t)f * sizeof(struct fileinfo));
+	free(spill);
+
+	dirs_partitioned = 1;
+
+	/* Both segments big enough to be worth a thread? Sort them
+	 * concurrently (entrycmp() and its helpers only read shared
+	 * state). */
+	struct seg_sort_t dseg = {list, d};
+	pthread_t t;
+
+	if (d >= PTRSORT_MIN_ENTRIES && f >= PTRSORT_MIN_ENTRIES
+	&& pthread_create(&t, NULL, sort_segment_thread, &dseg) == 0) {
+		sort_segment(list + d, f);
+		pthread_join(t, NULL);
+	} else {
+		sort_segment(list, d);
+		sort_segment(list + d, f);
+	}
+
+	dirs_partitioned = 0;
+
+	return FUNC_SUCCESS;
+}
+
+/* Do not bother with top-k selection unless the list is at least this
+ * many times bigger than the cap: for smaller lists a full sort is just
+ * as fast. */
+#define TOPK_MIN_RATIO 4
+
+/* Sift down the entry at index I of the max-heap (per entrycmp() order)
+ * of SIZE entries at the beginning of LIST. */
+static void
+topk_sift_down(struct fileinfo *list, const filesn_t size, filesn_t i)
+{
+	while (1) {
+		filesn_t largest = i * 2 + 1; /* Left child */
+		if (largest >= size)
+			return;
+
+		const filesn_t right = largest + 1;
+		if (right < size && entrycmp(&list[right], &list[largest]) > 0)
+			largest = right;
+
+		if (entrycmp(&list[i], &list[largest]) >= 0)
+			return;
+
+		const struct fileinfo tmp = list[i];
+		list[i] = list[largest];
+		list[largest] = tmp;
+		i = largest;
+	}
+}
+
+/* Top-k selection for capped listings (MaxFiles): instead of sorting all
+ * N entries of LIST just to display the first K, keep a K-entry max-heap
+ * of the best entries seen so far (per entrycmp() order) and sort only
+ * those, turning O(n log n) into O(n log k).
+ * On success the first K entries of LIST are exactly the first K entries
+ * of the fully sorted list; the remaining entries (which are never
+ * displayed) are left in no particular order.
+ * Returns FUNC_FAILURE if the selection is not worth it (the caller
+ * should run a full sort). */
+int
+topk_sort(struct fileinfo *list, const filesn_t n, const filesn_t k)
+{
+	if (k <= 0 || n / TOPK_MIN_RATIO < k)
+		return FUNC_FAILURE;
+
+	/* Build a max-heap over the first K entries. */
+	filesn_t i = k / 2;
+	while (--i >= 0)
+		topk_sift_down(list, k, i);
+
+	/* Scan the rest: whatever beats the heap root (the worst of the
+	 * current top K) takes its place. */
+	for (i = k; i < n; i++) {
+		if (entrycmp(&list[i], &list[0]) >= 0)
+			continue;
+
+		const struct fileinfo tmp = list[0];
+		list[0] = list[i];
+		list[i] = tmp;
+		topk_sift_down(list, k, 0);
+	}
+
+	/* Sort the K survivors (heapsort). */
+	for (i = k - 1; i > 0; i--) {
+		const struct fileinfo tmp = list[0];
+		list[0] = list[i];
+		list[i] = tmp;
+		topk_sift_down(list, i, 0);
+	}
+
+	return FUNC_SUCCESS;
+}
+
 /* Same as alphasort, but is uses strcmp instead of sctroll, which is
  * slower. However, bear in mind that, unlike strcmp(), strcoll() is locale
  * aware. Use only with C and english locales */
@@ -484,6 +988,10 @@ sort_function(char **arg)
 	if (!is_number(arg[1])) {
 		if (*arg[1] == 'r' && strcmp(arg[1], "rev") == 0) {
 			toggle_sort_reverse();
+			/* Reversing the current list is enough: a full re-sort is
+			 * only needed when there is no list to reverse. */
+			if (reverse_dirlist() == FUNC_SUCCESS)
+				return FUNC_SUCCESS;
 			return re_sort_files_list();
 		}
 
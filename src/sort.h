@@ -32,7 +32,12 @@ __BEGIN_DECLS
 
 int  alphasort_insensitive(const struct dirent **a, const struct dirent **b);
 int  compare_strings(char **s1, char **s2);
+int  dirs_first_sort(struct fileinfo *list, const filesn_t n);
 int  entrycmp(const void *a, const void *b);
+void init_sort_keys(struct fileinfo *list, const filesn_t n);
+int  entry_ptr_sort(struct fileinfo *list, const filesn_t n);
+int  name_radix_sort(struct fileinfo *list, const filesn_t n);
+int  topk_sort(struct fileinfo *list, const filesn_t n, const filesn_t k);
 void print_sort_method(void);
 int  skip_nonexec(const struct dirent *ent);
 int  skip_files(const struct dirent *ent);
@@ -32,9 +32,8 @@
 
 #include "helpers.h"
 
-#if defined(__HAIKU__)
-# include <stdint.h>
-#endif /* __HAIKU__ */
+#include <fnmatch.h> /* cwd-relative glob fast path (see glob_cwd()) */
+#include <stdint.h> /* uint64_t, uintptr_t (SWAR scanning) */
 #include <stdio.h>
 #include <string.h>
 #ifndef HAVE_ARC4RANDOM
@@ -400,12 +399,55 @@ xstrverscmp(const char *s1, const char *s2)
 	}
 }
 
+/* Return the number of leading bytes of STR in the printable ASCII range
+ * (0x20-0x7e). If the byte at the returned index is the terminating NUL,
+ * the whole string is printable ASCII: its display width is its length,
+ * and the multi-byte machinery (wc_xstrlen()/u8truncstr()) can be skipped
+ * altogether. This is by far the most common case, and file names are
+ * scanned char by char several times per listing, so the bulk of the
+ * string is processed one word (eight bytes) at a time. */
+size_t
+ascii_printable_prefix(const char *str)
+{
+	const char *s = str;
+
+	/* Align to word size, so that the word reads below never cross a
+	 * page boundary (reading a few bytes past the end of the string is
+	 * harmless as long as the read stays within the string's page). */
+	for (; ((uintptr_t)s % sizeof(uint64_t)) != 0; s++) {
+		if ((unsigned char)*s < 0x20 || (unsigned char)*s >= 0x7f)
+			return (size_t)(s - str);
+	}
+
+	uint64_t w;
+	for (;;) {
+		memcpy(&w, s, sizeof(w)); /* Compiles to a single aligned load */
+		if (SWAR_HASZERO(w) || SWAR_HASLESS(w, 0x20) || SWAR_HASHIGH(w)
+		|| SWAR_HASZERO(w ^ (SWAR_ONES * 0x7f))) /* Any DEL char? */
+			break;
+		s += sizeof(w);
+	}
+
+	/* The last word contains a non-printable/non-ASCII byte (or a SWAR
+	 * false positive): locate it byte by byte. */
+	while ((unsigned char)*s >= 0x20 && (unsigned char)*s < 0x7f)
+		s++;
+
+	return (size_t)(s - str);
+}
+
 /* A strlen implementation able to handle wide chars.
  * Returns the number of columns needed to print the string STR (instead
  * of the number of bytes needed to store STR). */
 size_t
 wc_xstrlen(const char *restrict str)
 {
+	/* Fast path: the display width of a printable ASCII string is just
+	 * its length. */
+	const size_t alen = ascii_printable_prefix(str);
+	if (str[alen] == '\0')
+		return alen;
+
 	/* Convert multi-byte to wide char */
 	/* Most of the time we use this function to get the number of characters
 	 * in names: in this case a buffer of NAME_MAX + 1 is enough. However, we
@@ -441,15 +483,32 @@ wc_xstrlen(const char *restrict str)
 int
 u8truncstr(char *restrict str, const size_t max)
 {
+	int bmax = (int)max;
+	if (bmax < 0)
+		bmax = conf.max_name_len;
+
+	/* Fast path: a printable ASCII string truncates at a byte boundary
+	 * (every char is one column wide). Widen the bytes in place, back to
+	 * front (wchar_t is wider than char), as the caller expects a wide
+	 * string on return. */
+	const size_t alen = ascii_printable_prefix(str);
+	if (str[alen] == '\0') {
+		const int n = (int)alen > bmax ? bmax : (int)alen;
+		wchar_t *ws = (wchar_t *)str;
+		int j;
+		for (j = n - 1; j >= 0; j--)
+			ws[j] = (wchar_t)(unsigned char)str[j];
+		ws[n] = L'\0';
+		return bmax - n;
+	}
+
 	int len = 0;
 	static wchar_t buf[NAME_MAX + 1];
 	*buf = L'\0';
 	if (mbstowcs(buf, str, NAME_MAX + 1) == (size_t)-1)
 		return 0;
 
-	int i, bmax = (int)max;
-	if (bmax < 0)
-		bmax = conf.max_name_len;
+	int i;
 
 	for (i = 0; buf[i]; i++) {
 		int l = wcwidth(buf[i]);
@@ -830,7 +889,12 @@ split_str(char *str, const int update_args)
 	init_quoted_words();
 
 	size_t buf_len = 0, words = 0, str_len = 0;
-	char *buf = xnmalloc(1, sizeof(char));
+	/* Normalization buffer: each input byte expands to at most two bytes
+	 * (an escape plus the byte itself), plus a closing char, a space, and
+	 * the terminating NUL. Sizing it upfront to this worst case makes the
+	 * whole tokenization allocation-free (no realloc per copied byte),
+	 * which matters when dispatching thousands of lines via --cmd. */
+	char *buf = xnmalloc((strlen(str) * 2) + 3, sizeof(char));
 	int close = 0;
 	char **substr = (char **)NULL;
 
@@ -845,7 +909,6 @@ split_str(char *str, const int update_args)
 			if (*str == '$') {
 				/* If escaped, it has no special meaning */
 				if ((str_len && *(str - 1) == '\\') || *(str + 1) != '(') {
-					buf = xnrealloc(buf, buf_len + 1, sizeof(char *));
 					buf[buf_len] = *str;
 					buf_len++;
 					break;
@@ -855,7 +918,6 @@ split_str(char *str, const int update_args)
 			} else {
 				/* If escaped, it has no special meaning */
 				if (str_len && *(str - 1) == '\\') {
-					buf = xnrealloc(buf, buf_len + 1, sizeof(char *));
 					buf[buf_len] = *str;
 					buf_len++;
 					break;
@@ -865,7 +927,6 @@ split_str(char *str, const int update_args)
 					 * what we want */
 					close = *str;
 					str++;
-					buf = xnrealloc(buf, buf_len + 1, sizeof(char *));
 					buf[buf_len] = '`';
 					buf_len++;
 				}
@@ -873,7 +934,6 @@ split_str(char *str, const int update_args)
 
 			/* Copy everything until null byte or closing char */
 			while (*str && *str != close) {
-				buf = xnrealloc(buf, buf_len + 1, sizeof(char *));
 				buf[buf_len] = *str;
 				buf_len++;
 				str++;
@@ -897,7 +957,6 @@ split_str(char *str, const int update_args)
 			/* Copy the closing char and add an space: this function
 			 * takes space as word breaking char, so that everything
 			 * in the buffer will be copied as one single word */
-			buf = xnrealloc(buf, buf_len + 2, sizeof(char *));
 			buf[buf_len] = *str;
 			buf_len++;
 			buf[buf_len] = ' ';
@@ -910,7 +969,6 @@ split_str(char *str, const int update_args)
 				|| (str_len > 0 && *(str - 1) == '\\'));
 			/* If the quote is escaped, keep it. */
 			if (is_quoted == 1) {
-				buf = xnrealloc(buf, buf_len + 1, sizeof(char *));
 				buf[buf_len] = *str;
 				buf_len++;
 			}
@@ -925,12 +983,10 @@ split_str(char *str, const int update_args)
 				if (!(flags & IN_BOOKMARKS_SCREEN) && is_quoted == 0
 				&& (is_quote_char(*str) || *str == '.')) {
 					/* Escape '.' to prevent realpath expansions. */
-					buf = xnrealloc(buf, buf_len + 1, sizeof(char *));
 					buf[buf_len] = '\\';
 					buf_len++;
 				}
 
-				buf = xnrealloc(buf, buf_len + 1, sizeof(char *));
 				buf[buf_len] = *str;
 				buf_len++;
 				str++;
@@ -953,7 +1009,6 @@ split_str(char *str, const int update_args)
 			}
 
 			if (is_quoted == 1) { /* Add closing quote. */
-				buf = xnrealloc(buf, buf_len + 1, sizeof(char *));
 				buf[buf_len] = (char)quote;
 				buf_len++;
 			}
@@ -972,7 +1027,6 @@ split_str(char *str, const int update_args)
 		case ' ':
 			/* If escaped, just copy it into the buffer */
 			if (str_len && *(str - 1) == '\\') {
-				buf = xnrealloc(buf, buf_len + 1, sizeof(char *));
 				buf[buf_len] = *str;
 				buf_len++;
 			} else {
@@ -998,7 +1052,6 @@ split_str(char *str, const int update_args)
 		default:
 			if (*str == '\\' && (flags & IN_BOOKMARKS_SCREEN))
 				break;
-			buf = xnrealloc(buf, buf_len + 1, sizeof(char *));
 			buf[buf_len] = *str;
 			buf_len++;
 			break;
@@ -1949,6 +2002,61 @@ expand_bookmarks(char ***substr)
 	free(bm_array);
 }
 
+static int
+cmp_glob_matches(const void *a, const void *b)
+{
+	return strcoll(*(char **)a, *(char **)b);
+}
+
+/* Expand the glob pattern PATTERN against the current list of files,
+ * instead of hitting the disk via glob(3): for a pattern relative to the
+ * current directory the candidates are exactly the names already loaded
+ * into FILE_INFO, so matching is pure fnmatch(3) plus a sort, with zero
+ * syscalls and no per-match allocation (names are borrowed).
+ *
+ * On success, *PATHV is set to a NULL-terminated array of borrowed
+ * pointers (only the array itself must be freed) and *PATHC to the
+ * number of matches (possibly zero), and 0 is returned. If the pattern
+ * is not a simple cwd-relative one (it contains a slash, a tilde, or a
+ * brace, all handled by glob(3) itself), or the file list cannot stand
+ * for the directory content, -1 is returned and the caller should fall
+ * back to glob(3). */
+static int
+glob_cwd(const char *pattern, char ***pathv, size_t *pathc)
+{
+	if (conf.autols == 0 || !file_info || files <= 0)
+		return (-1);
+
+	if (*pattern == '~' || strchr(pattern, '/') || strchr(pattern, '{'))
+		return (-1);
+
+	/* Hidden files are not in the file list: let glob(3) scan the dir. */
+	if (*pattern == '.' && conf.show_hidden == 0)
+		return (-1);
+
+	char **ret = xnmalloc((size_t)files + 1, sizeof(char *));
+	size_t n = 0;
+	filesn_t i;
+
+	/* FNM_PERIOD: a leading dot is only matched explicitly, just as in
+	 * glob(3). */
+	for (i = 0; i < files; i++) {
+		if (file_info[i].name
+		&& fnmatch(pattern, file_info[i].name, FNM_PERIOD) == 0)
+			ret[n++] = file_info[i].name;
+	}
+
+	ret[n] = (char *)NULL;
+
+	/* glob(3) returns matches sorted as by strcoll(3). */
+	if (n > 1)
+		qsort(ret, n, sizeof(char *), cmp_glob_matches);
+
+	*pathv = ret;
+	*pathc = n;
+	return 0;
+}
+
 static int
 expand_glob(char ***substr, const int *glob_array, const size_t glob_n)
 {
@@ -1958,39 +2066,54 @@ expand_glob(char ***substr, const int *glob_array, const size_t glob_n)
 	size_t g = 0;
 	for (g = 0; g < (size_t)glob_n; g++) {
 		glob_t globbuf;
+		char **pathv = (char **)NULL;
+		size_t pathc = 0;
+		int used_glob = 0;
+
+		if (glob_cwd((*substr)[glob_array[g] + (int)old_pathc],
+		&pathv, &pathc) == -1) {
+			used_glob = 1;
+			if (glob((*substr)[glob_array[g] + (int)old_pathc],
+				GLOB_BRACE | GLOB_TILDE, NULL, &globbuf) != FUNC_SUCCESS) {
+				globfree(&globbuf);
+				continue;
+			}
 
-		if (glob((*substr)[glob_array[g] + (int)old_pathc],
-			GLOB_BRACE | GLOB_TILDE, NULL, &globbuf) != FUNC_SUCCESS) {
-			globfree(&globbuf);
+			pathv = globbuf.gl_pathv;
+			pathc = globbuf.gl_pathc;
+		} else if (pathc == 0) {
+			/* Pattern matched nothing: leave the word untouched, just
+			 * as with glob(3) above. */
+			free(pathv);
 			continue;
 		}
 
-		if (globbuf.gl_pathc == 0)
+		if (pathc == 0)
 			goto CONT;
 
 		size_t j = 0;
 		char **glob_cmd = (char **)NULL;
-		glob_cmd = xcalloc(args_n + globbuf.gl_pathc + 1, sizeof(char *));
+		glob_cmd = xcalloc(args_n + pathc + 1, sizeof(char *));
 
 		for (i = 0; i < ((size_t)glob_array[g] + old_pathc); i++) {
 			glob_cmd[j] = savestring((*substr)[i], strlen((*substr)[i]));
 			j++;
 		}
 
-		for (i = 0; i < globbuf.gl_pathc; i++) {
-			if (SELFORPARENT(globbuf.gl_pathv[i]))
+		for (i = 0; i < pathc; i++) {
+			if (SELFORPARENT(pathv[i]))
 				continue;
 
 			char *esc_str = (char *)NULL;
 			/* Escape the globbed file name and copy it */
-			if (virtual_dir == 1 && is_file_in_cwd(globbuf.gl_pathv[i])) {
+			if (virtual_dir == 1 && is_file_in_cwd(pathv[i])) {
 				char buf[PATH_MAX + 1]; *buf = '\0';
-				if (xreadlink(XAT_FDCWD, globbuf.gl_pathv[i], buf,
+				if (xreadlink(XAT_FDCWD, pathv[i], buf,
 				sizeof(buf)) == -1 || !*buf)
 					continue;
 				esc_str = escape_str(buf);
 			} else {
-				esc_str = escape_str(globbuf.gl_pathv[i]);
+				esc_str = escape_str(pathv[i]);
 			}
 
 			if (esc_str) {
@@ -1998,7 +2121,7 @@ expand_glob(char ***substr, const int *glob_array, const size_t glob_n)
 				j++;
 			} else {
 				xerror(_("%s: '%s': Error quoting file name\n"),
-					PROGRAM_NAME, globbuf.gl_pathv[i]);
+					PROGRAM_NAME, pathv[i]);
 				continue;
 			}
 		}
@@ -2019,8 +2142,11 @@ expand_glob(char ***substr, const int *glob_array, const size_t glob_n)
 		args_n = j - 1;
 
 CONT:
-		old_pathc += (globbuf.gl_pathc - 1);
-		globfree(&globbuf);
+		old_pathc += (pathc - 1);
+		if (used_glob == 1)
+			globfree(&globbuf);
+		else
+			free(pathv); /* Entries are borrowed from FILE_INFO. */
 	}
 
 	return 0;
@@ -2130,13 +2256,15 @@ check_ranges(char ***substr, int **range_array)
 			if ((*substr)[i][j] != '-' && !IS_DIGIT((*substr)[i][j]))
 				break;
 
-			/* If a range is found, store its index. */
+			/* If a range is found, store its index (one entry per word:
+			 * expand_range() will validate the whole word). */
 			if (j > 0 && j < len && (*substr)[i][j] == '-'
 			&& IS_DIGIT((*substr)[i][j - 1])) {
 				if (n >= INT_ARRAY_MAX)
 					break;
 				(*range_array)[n] = (int)i;
 				n++;
+				break;
 			}
 		}
 	}
@@ -2218,63 +2346,101 @@ expand_ranges(char ***substr)
 		return;
 	}
 
-	size_t old_ranges_n = 0;
+	/* First pass: expand every range and compute the size of the final
+	 * array, so that it can be allocated in a single shot instead of
+	 * being rebuilt (copying every word) once per range. */
+	filesn_t **ranges = xnmalloc(ranges_ok, sizeof(filesn_t *));
+	size_t *ranges_n = xnmalloc(ranges_ok, sizeof(size_t));
+	size_t total = 0;
 	size_t r = 0;
 
 	for (r = 0; r < ranges_ok; r++) {
-		size_t ranges_n = 0;
-		filesn_t *ranges = expand_range((*substr)[range_array[r] +
-			(int)old_ranges_n], 1);
+		ranges[r] = expand_range((*substr)[range_array[r]], 1);
+		ranges_n[r] = 0;
 
-		if (ranges) {
-			j = 0;
-			for (ranges_n = 0; ranges[ranges_n]; ranges_n++);
+		if (ranges[r]) {
+			while (ranges[r][ranges_n[r]])
+				ranges_n[r]++;
+			total += ranges_n[r];
+		}
+	}
 
-			update_quoted_words_index((size_t)range_array[r]
-				+ old_ranges_n, ranges_n);
+	if (total == 0) { /* No valid range */
+		free(ranges);
+		free(ranges_n);
+		free(range_array);
+		return;
+	}
 
-			char **ranges_cmd = (char **)NULL;
-			ranges_cmd = xcalloc(args_n + ranges_n + 2, sizeof(char *));
+	/* Second pass: fill the new array, moving words needing no expansion
+	 * instead of copying them. */
+	char **ranges_cmd = xnmalloc(args_n + total + 2, sizeof(char *));
+	size_t old_ranges_n = 0;
+	j = 0;
+	r = 0;
 
-			for (i = 0; i < (size_t)range_array[r] + old_ranges_n; i++) {
-				if (!(*substr)[i])
-					continue;
-				ranges_cmd[j] = savestring((*substr)[i], strlen((*substr)[i]));
-				j++;
-			}
+	for (i = 0; i <= args_n; i++) {
+		if (r < ranges_ok && (size_t)range_array[r] == i) {
+			if (ranges[r]) {
+				update_quoted_words_index((size_t)range_array[r]
+					+ old_ranges_n, ranges_n[r]);
+				old_ranges_n += ranges_n[r] - 1;
+
+				size_t k;
+				for (k = 0; k < ranges_n[r]; k++) {
+					const size_t len = (size_t)DIGINUM(ranges[r][k]) + 1;
+					ranges_cmd[j] = xnmalloc(len, sizeof(int));
+					snprintf(ranges_cmd[j], len, "%zd", ranges[r][k]);
+					j++;
+				}
 
-			for (i = 0; i < ranges_n; i++) {
-				const size_t len = (size_t)DIGINUM(ranges[i]) + 1;
-				ranges_cmd[j] = xnmalloc(len, sizeof(int));
-				snprintf(ranges_cmd[j], len, "%zd", ranges[i]);
+				free((*substr)[i]);
+				free(ranges[r]);
+			} else { /* Invalid range: keep the word as is */
+				ranges_cmd[j] = (*substr)[i];
 				j++;
 			}
 
-			for (i = (size_t)range_array[r] + old_ranges_n + 1;
-			i <= args_n; i++) {
-				if (!(*substr)[i])
-					continue;
-				ranges_cmd[j] = savestring((*substr)[i], strlen((*substr)[i]));
-				j++;
-			}
+			r++;
+			continue;
+		}
 
-			ranges_cmd[j] = (char *)NULL;
-			free(ranges);
+		if (!(*substr)[i])
+			continue;
 
-			for (i = 0; i <= args_n; i++)
-				free((*substr)[i]);
-			free((*substr));
+		ranges_cmd[j] = (*substr)[i];
+		j++;
+	}
 
-			(*substr) = ranges_cmd;
-			args_n = j - 1;
-		}
+	ranges_cmd[j] = (char *)NULL;
+	free((*substr));
 
-		old_ranges_n += (ranges_n - 1);
-	}
+	(*substr) = ranges_cmd;
+	args_n = j - 1;
 
+	free(ranges);
+	free(ranges_n);
 	free(range_array);
 }
 
+/* Match set of the last regex pattern expanded by expand_regex(): a
+ * single entry, since scripted sessions tend to repeat one pattern.
+ * Indices into FILE_INFO, flushed whenever the file list changes (see
+ * update_dirlist()/free_dirlist() in listing.c). */
+static char *rx_cache_pat = (char *)NULL;
+static filesn_t *rx_cache_set = (filesn_t *)NULL;
+static filesn_t rx_cache_n = 0;
+
+void
+flush_regex_cache(void)
+{
+	free(rx_cache_pat);
+	rx_cache_pat = (char *)NULL;
+	free(rx_cache_set);
+	rx_cache_set = (filesn_t *)NULL;
+	rx_cache_n = 0;
+}
+
 static void
 expand_regex(char ***substr)
 {
@@ -2318,12 +2484,52 @@ expand_regex(char ***substr)
 		const size_t l = strlen(t) + 3;
 		char *rstr = xnmalloc(l, sizeof(char));
 		snprintf(rstr, l, "^%s$", t);
+
+		/* Anchored as above, a pattern without regex metacharacters can
+		 * only match a file named exactly T: look it up directly instead
+		 * of compiling and running a regex over the whole file list. */
+		if (!t[strcspn(t, ".[]()*+?{}|^$\\")]) {
+			filesn_t f = -1;
+			for (j = 0; j < files; j++) {
+				if (file_info[j].name && *file_info[j].name == *t
+				&& strcmp(file_info[j].name, t) == 0) {
+					f = j;
+					break;
+				}
+			}
+
+			free(dstr);
+			free(rstr);
+
+			if (f != -1) {
+				filesn_t m = (filesn_t)n;
+				int found = 0;
+				while (--m >= 0) {
+					if (*file_info[f].name == *tmp[m]
+					&& strcmp(file_info[f].name, tmp[m]) == 0)
+						found = 1;
+				}
+
+				if (found == 0) {
+					tmp[n] = file_info[f].name;
+					n++;
+					continue;
+				}
+			}
+
+			tmp[n] = (*substr)[i];
+			n++;
+			continue;
+		}
+
 		free(dstr);
 
-		int ret = check_regex(rstr);
+		const int cache_hit =
+			(rx_cache_pat && strcmp(rstr, rx_cache_pat) == 0);
 
-		if (ret != FUNC_SUCCESS
-		|| regcomp(&regex, rstr, reg_flags) != FUNC_SUCCESS) {
+		int ret = FUNC_FAILURE;
+		if (cache_hit == 0 && ((ret = check_regex(rstr)) != FUNC_SUCCESS
+		|| regcomp(&regex, rstr, reg_flags) != FUNC_SUCCESS)) {
 			if (ret == FUNC_SUCCESS)
 				regfree(&regex);
 			free(rstr);
@@ -2332,12 +2538,30 @@ expand_regex(char ***substr)
 			continue;
 		}
 
-		free(rstr);
 		int reg_found = 0;
+		filesn_t c = 0;
+
+		if (cache_hit == 0) {
+			/* Store the pattern and its match set for reuse. */
+			free(rx_cache_pat);
+			rx_cache_pat = rstr;
+			rx_cache_set =
+				xnrealloc(rx_cache_set, (size_t)files + 1, sizeof(filesn_t));
+			rx_cache_n = 0;
+
+			for (j = 0; j < files; j++) {
+				if (regexec(&regex, file_info[j].name, 0, NULL, 0)
+				== FUNC_SUCCESS)
+					rx_cache_set[rx_cache_n++] = j;
+			}
 
-		for (j = 0; j < files; j++) {
-			if (regexec(&regex, file_info[j].name, 0, NULL, 0) != FUNC_SUCCESS)
-				continue;
+			regfree(&regex);
+		} else {
+			free(rstr);
+		}
+
+		for (c = 0; c < rx_cache_n; c++) {
+			j = rx_cache_set[c];
 
 			/* Make sure the matching file name is not already in the tmp array */
 			filesn_t m = (filesn_t)n, found = 0;
@@ -2359,8 +2583,6 @@ expand_regex(char ***substr)
 			tmp[n] = (*substr)[i];
 			n++;
 		}
-
-		regfree(&regex);
 	}
 
 	if (n > 0) {
@@ -29,10 +29,24 @@
 #define UPDATE_ARGS    1
 #define NO_UPDATE_ARGS 0
 
+/* Word-at-a-time (SWAR) byte scanning, as done by strlen(3) in most libc
+ * implementations: each macro evaluates to non-zero if any byte of the
+ * 8-byte word X is zero / less than N (boolean only: a borrow may flag
+ * the byte following a true match) / has its high bit set. See "Bit
+ * Twiddling Hacks" by Sean E. Anderson. Used by the UTF-8 helpers below
+ * and by is_utf8_name(), in listing.c. */
+#define SWAR_ONES       0x0101010101010101ULL
+#define SWAR_HIGHS      0x8080808080808080ULL
+#define SWAR_HASZERO(x)    ((((x) - SWAR_ONES) & ~(x)) & SWAR_HIGHS)
+#define SWAR_HASLESS(x, n) ((((x) - (SWAR_ONES * (n))) & ~(x)) & SWAR_HIGHS)
+#define SWAR_HASHIGH(x)    ((x) & SWAR_HIGHS)
+
 __BEGIN_DECLS
 
+size_t ascii_printable_prefix(const char *str);
 size_t count_chars(const char *s, const char c);
 char *escape_str(const char *str);
+void flush_regex_cache(void);
 char *gen_rand_str(const size_t len);
 char *get_last_chr(char *str, const char c, const int len);
 char **get_substr(char *str, const char ifs, const int fproc);
@@ -28,6 +28,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <strings.h> /* str(n)casecmp() */
+#include <sys/ioctl.h> /* FIONREAD (see suggest_over_budget()) */
+#include <time.h> /* clock_gettime(2) (see suggest_over_budget()) */
 #include <unistd.h>
 #include <pwd.h>
 
@@ -44,15 +46,19 @@ typedef char *rl_cpvfunc_t;
 
 #include "aux.h"
 #include "builtins.h"
+#include "candidates.h" /* candidates_next() */
 #include "checks.h"
 #include "colors.h"
 #include "fuzzy_match.h"
+#include "history.h" /* dirhist_index_latest() */
 #ifndef _NO_HIGHLIGHT
 # include "highlight.h"
 #endif /* !_NO_HIGHLIGHT */
+#include "init.h" /* alias_lookup() */
 #include "jump.h"
 #include "messages.h"
 #include "navigation.h" /* fastback() */
+#include "perf.h"       /* perf_begin(), perf_end() */
 #include "prompt.h"
 #include "readline.h"
 
@@ -572,6 +578,12 @@ make_suggestion(const char *str, const size_t offset, const char *color)
 	free(wname);
 }
 
+/* Offset and BAEJ mode of the currently displayed suggestion. Used by
+ * print_suggestion() to detect repaints that would reproduce exactly
+ * what is already on the screen. */
+static size_t displayed_offset = 0;
+static int displayed_baej = 0;
+
 /* Clear the line, print the suggestion (STR) at OFFSET in COLOR, and
  * move the cursor back to the original position.
  * OFFSET marks the point in STR that is already typed: the suggestion
@@ -582,10 +594,12 @@ print_suggestion(const char *str, size_t offset, char *color)
 	if (!str || !*str)
 		return;
 
+	int forced = 0; /* The screen was repainted: do not skip the reprint */
 	if (wrong_cmd == 1) {
 		if (words_num > 1)
 			return;
 		recover_from_wrong_cmd();
+		forced = 1;
 	}
 
 	if (words_num == 1 && rl_end > 0 && rl_line_buffer
@@ -600,9 +614,6 @@ print_suggestion(const char *str, size_t offset, char *color)
 
 	HIDE_CURSOR;
 
-	if (suggestion.printed && str != suggestion_buf)
-		clear_suggestion(CS_FREEBUF);
-
 	int baej = 0; /* Bookmark/backdir, alias, ELN, or jump (and fuzzy matches) */
 	flags &= ~BAEJ_SUGGESTION;
 
@@ -631,6 +642,8 @@ print_suggestion(const char *str, size_t offset, char *color)
 	const size_t str_len = wc_xstrlen(str);
 	size_t slines = 0;
 	if (check_conditions(offset, str_len, &baej, &slines) == FUNC_FAILURE) {
+		if (suggestion.printed && str != suggestion_buf)
+			clear_suggestion(CS_FREEBUF);
 		UNHIDE_CURSOR;
 		return;
 	} else {
@@ -640,6 +653,26 @@ print_suggestion(const char *str, size_t offset, char *color)
 		}
 	}
 
+	/* Damage tracking: if this same suggestion is already on the screen
+	 * and the cursor just moved forward over it, whatever follows the
+	 * cursor is still correct: skip the clear/reprint cursor dance
+	 * entirely. This matters over slow (e.g. ssh) connections, where
+	 * repainting the same text on every keystroke floods the terminal. */
+	if (forced == 0 && suggestion.printed == 1 && suggestion_buf
+	&& str != suggestion_buf && baej == 0 && displayed_baej == 0
+	&& slines == 1 && suggestion.nlines <= 1 && rl_point == rl_end
+	&& color == suggestion.color && offset >= displayed_offset
+	&& strcmp(str, suggestion_buf) == 0) {
+		suggestion.nlines = slines;
+		displayed_offset = offset;
+		UNHIDE_CURSOR;
+		return;
+	}
+
+	/* A repaint is needed: remove the previously printed suggestion. */
+	if (suggestion.printed && str != suggestion_buf)
+		clear_suggestion(CS_FREEBUF);
+
 	/* In some cases (accepting first suggested word), we might want to
 	 * reprint the suggestion buffer, in which case it would be already stored */
 	if (str != suggestion_buf) {
@@ -660,12 +693,14 @@ print_suggestion(const char *str, size_t offset, char *color)
 	/* Store the suggestion color, in case we need to reprint it */
 	suggestion.color = color;
 
+	displayed_offset = offset;
+	displayed_baej = baej;
+
 	UNHIDE_CURSOR;
 }
 
 static inline char *
-get_reg_file_color(const char *filename, const struct stat *attr,
-	int *free_color)
+get_reg_file_color(const char *filename, const struct stat *attr)
 {
 	if (conf.light_mode == 1) return fi_c;
 	if (access(filename, R_OK) == -1) return nf_c;
@@ -689,23 +724,19 @@ get_reg_file_color(const char *filename, const struct stat *attr,
 	if (!ext || ext == filename)
 		return fi_c;
 
-	size_t color_len = 0;
-	char *extcolor = get_ext_color(ext, &color_len);
+	char *extcolor = get_ext_color_esc(ext, NULL);
 	if (!extcolor)
 		return fi_c;
 
-	color_len += 4;
-	char *ext_color = xnmalloc(color_len, sizeof(char));
-	snprintf(ext_color, color_len, "\x1b[%sm", extcolor);
-
-	*free_color = 1;
-	return ext_color;
+	/* Interned escape sequence: no copy, nothing for the caller to
+	 * free. */
+	return extcolor;
 }
 
 /* Used by the check_completions function to get file names color
  * according to file type. */
 static char *
-get_comp_color(const char *filename, const struct stat *attr, int *free_color)
+get_comp_color(const char *filename, const struct stat *attr)
 {
 	char *color = (char *)NULL;
 
@@ -718,7 +749,7 @@ get_comp_color(const char *filename, const struct stat *attr, int *free_color)
 		break;
 
 	case S_IFREG:
-		color = get_reg_file_color(filename, attr, free_color);
+		color = get_reg_file_color(filename, attr);
 		break;
 
 	case S_IFLNK: {
@@ -824,7 +855,7 @@ match_print(char *match, const size_t len, char *color, const int append_slash)
 static inline int
 print_match(char *match, const size_t len)
 {
-	int append_slash = 0, free_color = 0;
+	int append_slash = 0;
 
 	char *p = (char *)NULL, *_color = (char *)NULL;
 	char *color = (conf.suggest_filetype_color == 1) ? no_c : sf_c;
@@ -833,7 +864,7 @@ print_match(char *match, const size_t len)
 		p = tilde_expand(match);
 
 	struct stat attr;
-	if (lstat(p ? p : match, &attr) != -1) {
+	if (xlstat_cached(p ? p : match, &attr) != -1) {
 		if (S_ISDIR(attr.st_mode)
 		|| (S_ISLNK(attr.st_mode) && get_link_ref(p ? p : match) == S_IFDIR)) {
 			/* Do not append slash if suggesting the root dir */
@@ -842,11 +873,9 @@ print_match(char *match, const size_t len)
 		}
 
 		if (conf.suggest_filetype_color == 1) {
-			_color = get_comp_color(p ? p : match, &attr, &free_color);
+			_color = get_comp_color(p ? p : match, &attr);
 			if (_color)
 				color = _color;
-			else
-				free_color = 0;
 		}
 	} else {
 		suggestion.filetype = DT_DIR;
@@ -856,8 +885,6 @@ print_match(char *match, const size_t len)
 	suggestion.type = COMP_SUG;
 	match_print(match, len, color, append_slash);
 
-	if (free_color)
-		free(color);
 	return PARTIAL_MATCH;
 }
 
@@ -873,6 +900,39 @@ get_print_status(const char *str, const char *match, const size_t len)
 	return PARTIAL_MATCH;
 }
 
+/* Per-keystroke budget for the expensive checkers
+ *
+ * The check_* chain runs synchronously between keystrokes, and a few of
+ * its members hit the filesystem (check_completions() via readline's
+ * path completer) or scan the whole file list (the fuzzy pass of
+ * check_filenames()): on a slow file system or a huge directory one of
+ * them can stall typing. Before entering such a checker, and
+ * periodically inside its scan loops, we give up if (a) the keystroke
+ * already consumed its time budget, or (b) the next keystroke is
+ * already sitting in the input queue -- in which case whatever we
+ * print would be overwritten right away. Cheap checkers (plain array
+ * and index lookups) are not gated: they always run to completion.
+ * SUG_START is armed once per keystroke by rl_suggestions(). */
+
+#define SUG_BUDGET_MS 50
+
+static struct timespec sug_start;
+
+static int
+suggest_over_budget(void)
+{
+	int pending = 0;
+	if (ioctl(STDIN_FILENO, FIONREAD, &pending) == 0 && pending > 0)
+		return 1;
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	const long long ms = (now.tv_sec - sug_start.tv_sec) * 1000LL
+		+ (now.tv_nsec - sug_start.tv_nsec) / 1000000LL;
+
+	return ms > SUG_BUDGET_MS;
+}
+
 static int
 check_completions(char *str, size_t len, const int print)
 {
@@ -896,13 +956,18 @@ check_completions(char *str, size_t len, const int print)
 	if (print == 0 && words_num == 1) {
 		// First (and only) word followed by a space
 		struct stat a;
-		if (lstat(str, &a) == 0) {
+		if (xlstat_cached(str, &a) == 0) {
 			cur_comp_type = TCMP_PATH;
 			return FULL_MATCH;
 		}
 		return NO_MATCH;
 	}
 
+	/* The completer below walks the filesystem: skip it when this
+	 * keystroke is out of budget. */
+	if (suggest_over_budget() == 1)
+		return NO_MATCH;
+
 	*fz_match = '\0';
 	flags |= STATE_SUGGESTING;
 	char *match = my_rl_path_completion(str, 0);
@@ -988,6 +1053,172 @@ print_reg_file_suggestion(char *str, const filesn_t i, size_t len,
 	print_suggestion(file_info[i].name, len, color);
 }
 
+/* The per-keystroke suggestion checks below used to scan the whole files
+ * list and the whole commands list linearly. The two indexes here keep
+ * the indices of both collections sorted by name, so check_filenames()
+ * and check_cmds() can resolve exact and prefix lookups with a binary
+ * search plus a short scan of the (usually tiny) matching range. */
+
+static filesn_t *fnames_index = (filesn_t *)NULL;
+static filesn_t fnames_index_n = 0;
+static int fnames_index_cs = -1; /* Case sensitivity at build time */
+static int fnames_index_folded = 0; /* Compare via the case-folded FNAME keys */
+static int fnames_index_dirty = 1;
+
+static size_t *cmds_index = (size_t *)NULL;
+static size_t cmds_index_n = 0;
+
+/* Surviving fuzzy-match candidates from the previous keystroke.
+ * Typing a character can only narrow the match set (fuzzy_match()
+ * requires every query character to appear, in order, in the target),
+ * so when the current word extends the previous one only the survivors
+ * are re-scored, instead of the whole files list. Reset on backspace,
+ * word boundary (the prefix check below fails), and list changes. */
+static filesn_t *fz_set = (filesn_t *)NULL;
+static filesn_t fz_set_n = -1; /* -1: no usable set */
+static char fz_word[NAME_MAX + 1];
+static size_t fz_word_len = 0;
+
+/* Flag the files index as stale. Called whenever the files list is
+ * rebuilt or patched in place (see free_dirlist() and update_dirlist()
+ * in listing.c). */
+void
+invalidate_fnames_index(void)
+{
+	fnames_index_dirty = 1;
+	fz_set_n = -1;
+	fz_word_len = 0;
+}
+
+static int
+sort_fnames_index(const void *a, const void *b)
+{
+	const filesn_t ia = *(const filesn_t *)a;
+	const filesn_t ib = *(const filesn_t *)b;
+
+	const int ret = fnames_index_folded == 1
+		? strcmp(file_info[ia].fname, file_info[ib].fname)
+		: (fnames_index_cs == 1
+		? strcmp(file_info[ia].name, file_info[ib].name)
+		: strcasecmp(file_info[ia].name, file_info[ib].name));
+	if (ret != 0)
+		return ret;
+
+	/* Break ties by list position, so that equal names are visited in
+	 * the same order as the old linear scan. */
+	return ia < ib ? -1 : (ia > ib ? 1 : 0);
+}
+
+static void
+build_fnames_index(void)
+{
+	free(fnames_index);
+	fnames_index = (filesn_t *)NULL;
+	fnames_index_n = 0;
+	fnames_index_cs = conf.case_sens_path_comp;
+	fnames_index_dirty = 0;
+	/* Compare via the case-folded shadows built by init_sort_keys()
+	 * whenever every indexed entry has one (it may be missing if the
+	 * option was toggled after the list was loaded). */
+	fnames_index_folded = (fnames_index_cs == 0);
+
+	if (!file_info || files <= 0)
+		return;
+
+	fnames_index = xnmalloc((size_t)files, sizeof(filesn_t));
+
+	filesn_t i;
+	for (i = 0; i < files; i++) {
+		if (!file_info[i].name)
+			continue;
+		if (!file_info[i].fname)
+			fnames_index_folded = 0;
+		fnames_index[fnames_index_n++] = i;
+	}
+
+	qsort(fnames_index, (size_t)fnames_index_n, sizeof(filesn_t),
+		sort_fnames_index);
+}
+
+/* Return the position in FNAMES_INDEX of the first name whose first LEN
+ * bytes do not compare smaller than STR, or FNAMES_INDEX_N if there is
+ * none. Every name with STR as prefix lies in a contiguous range
+ * starting at this position. */
+static filesn_t
+fnames_index_lower_bound(const char *str, const size_t len, const int folded)
+{
+	filesn_t lo = 0, hi = fnames_index_n;
+
+	while (lo < hi) {
+		const filesn_t mid = lo + ((hi - lo) >> 1);
+		const int ret = folded == 1
+			? strncmp(file_info[fnames_index[mid]].fname, str, len)
+			: (fnames_index_cs == 1
+			? strncmp(file_info[fnames_index[mid]].name, str, len)
+			: strncasecmp(file_info[fnames_index[mid]].name, str, len));
+		if (ret < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+static int
+sort_cmds_index(const void *a, const void *b)
+{
+	const size_t ia = *(const size_t *)a;
+	const size_t ib = *(const size_t *)b;
+
+	const int ret = strcmp(bin_commands[ia], bin_commands[ib]);
+	if (ret != 0)
+		return ret;
+
+	return ia < ib ? -1 : (ia > ib ? 1 : 0);
+}
+
+/* (Re)build the sorted index over bin_commands. Called by
+ * get_path_programs() (init.c) every time the commands list is built. */
+void
+update_cmds_index(void)
+{
+	free(cmds_index);
+	cmds_index = (size_t *)NULL;
+	cmds_index_n = 0;
+
+	if (!bin_commands || !bin_commands[0])
+		return;
+
+	size_t n = 0;
+	while (bin_commands[n])
+		n++;
+
+	cmds_index = xnmalloc(n, sizeof(size_t));
+	for (cmds_index_n = 0; cmds_index_n < n; cmds_index_n++)
+		cmds_index[cmds_index_n] = cmds_index_n;
+
+	qsort(cmds_index, cmds_index_n, sizeof(size_t), sort_cmds_index);
+}
+
+/* Just as fnames_index_lower_bound(), but for the commands index
+ * (always case sensitive, as check_cmds() is). */
+static size_t
+cmds_index_lower_bound(const char *str, const size_t len)
+{
+	size_t lo = 0, hi = cmds_index_n;
+
+	while (lo < hi) {
+		const size_t mid = lo + ((hi - lo) >> 1);
+		if (strncmp(bin_commands[cmds_index[mid]], str, len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
 static int
 check_filenames(char *str, size_t len, const int first_word,
 	const size_t full_word)
@@ -1004,61 +1235,157 @@ check_filenames(char *str, size_t len, const int first_word,
 		? FUZZY_FILES_UTF8 : FUZZY_FILES_ASCII;
 	int best_fz_score = 0;
 
-	filesn_t i;
+	filesn_t i = 0;
+
+	/* No fuzzy matching if not at the end of the line */
+	const int use_index = (full_word != 0 || conf.fuzzy_match == 0
+		|| rl_point < rl_end);
+
+	if (use_index == 1 && len > 0) {
+		/* Exact and prefix lookups resolve through the sorted index */
+		if (fnames_index_dirty == 1
+		|| fnames_index_cs != conf.case_sens_path_comp)
+			build_fnames_index();
+
+		/* Case insensitive lookups fold the query once and compare it
+		 * against the cached case-folded names: a memcmp() per
+		 * candidate, instead of folding both sides per comparison. */
+		char fstr[NAME_MAX + 1];
+		const int folded =
+			(fnames_index_folded == 1 && len < sizeof(fstr));
+		const char *key = str;
+		if (folded == 1) {
+			size_t f;
+			for (f = 0; f < len; f++)
+				fstr[f] = (char)TOLOWER(str[f]);
+			fstr[len] = '\0';
+			key = fstr;
+		}
+
+		filesn_t best = -1;
+		filesn_t k = fnames_index_lower_bound(key, len, folded);
+
+		for (; k < fnames_index_n; k++) {
+			i = fnames_index[k];
+			if (!file_info[i].name)
+				continue;
+
+			if ((folded == 1
+			? (file_info[i].bytes < len
+			|| memcmp(key, file_info[i].fname, len) != 0)
+			: (fnames_index_cs == 1
+			? strncmp(key, file_info[i].name, len)
+			: strncasecmp(key, file_info[i].name, len)) != 0))
+				break; /* Past the matching range */
+
+			if (removed_slash == 1 && (file_info[i].dir != 1
+			|| len != file_info[i].len))
+				continue;
+
+			if (full_word) {
+				/* Same prefix and same length: the whole words match */
+				if (!file_info[i].name[len])
+					return FULL_MATCH;
+				continue;
+			}
 
-	for (i = 0; i < files; i++) {
-		if (!file_info[i].name)	continue;
+			if (first_word == 1 && ( (file_info[i].dir == 1
+			&& conf.autocd == 0)
+			|| (file_info[i].dir == 0 && conf.auto_open == 0) ) )
+				continue;
 
-		if (removed_slash == 1 && (file_info[i].dir != 1
-		|| len != file_info[i].len))
-			continue;
+			if (words_num > 1 && rl_line_buffer && *rl_line_buffer == 'c'
+			&& rl_line_buffer[1] == 'd' && rl_line_buffer[2] == ' '
+			&& file_info[i].dir == 0)
+				continue;
 
-		if (full_word) {
-			if ((conf.case_sens_path_comp ? strcmp(str, file_info[i].name)
-			: strcasecmp(str, file_info[i].name)) == 0)
-				return FULL_MATCH;
-			continue;
+			/* Keep the first match in list order, just as the old
+			 * linear scan did. */
+			if (best == -1 || i < best)
+				best = i;
 		}
 
-		if (len == 0) continue;
-		if (first_word == 1 && ( (file_info[i].dir == 1 && conf.autocd == 0)
-		|| (file_info[i].dir == 0 && conf.auto_open == 0) ) )
-			continue;
+		if (best != -1) {
+			if (file_info[best].len == len) return FULL_MATCH;
 
-		if (words_num > 1 && rl_line_buffer && *rl_line_buffer == 'c'
-		&& rl_line_buffer[1] == 'd' && rl_line_buffer[2] == ' '
-		&& file_info[i].dir == 0)
-			continue;
+			suggestion.type = FILE_SUG;
 
-		/* No fuzzy matching if not at the end of the line */
-		if (conf.fuzzy_match == 0 || rl_point < rl_end) {
-			if (conf.case_sens_path_comp ? (*str == *file_info[i].name
-			&& strncmp(str, file_info[i].name, len) == 0)
-			: (TOUPPER(*str) == TOUPPER(*file_info[i].name)
-			&& strncasecmp(str, file_info[i].name, len) == 0)) {
-				if (file_info[i].len == len) return FULL_MATCH;
+			if (file_info[best].dir)
+				print_directory_suggestion(best, len, color);
+			else
+				print_reg_file_suggestion(str, best, len, color, dot_slash);
 
-				suggestion.type = FILE_SUG;
+			return PARTIAL_MATCH;
+		}
+	}
 
-				if (file_info[i].dir)
-					print_directory_suggestion(i, len, color);
-				else
-					print_reg_file_suggestion(str, i, len, color, dot_slash);
+	/* ############### FUZZY MATCHING ################## */
+	else if (use_index == 0) {
+		const int narrow = (fz_set_n >= 0 && fz_word_len > 0
+			&& len > fz_word_len && strncmp(str, fz_word, fz_word_len) == 0);
 
-				return PARTIAL_MATCH;
+		if (narrow == 0)
+			fz_set = xnrealloc(fz_set, files > 0
+				? (size_t)files : 1, sizeof(filesn_t));
+
+		const filesn_t scan_n = narrow == 1 ? fz_set_n : files;
+		filesn_t k, surv_n = 0;
+		int aborted = 0;
+
+		for (k = 0; k < scan_n; k++) {
+			/* Bail out of an over-budget scan: the survivor set is
+			 * incomplete, handled as for an early full match below. */
+			if ((k & 0x3ff) == 0x3ff && suggest_over_budget() == 1) {
+				aborted = 1;
+				break;
 			}
-		}
 
-		/* ############### FUZZY MATCHING ################## */
-		else {
+			i = narrow == 1 ? fz_set[k] : k;
+			if (!file_info[i].name)	continue;
+
+			if (removed_slash == 1 && (file_info[i].dir != 1
+			|| len != file_info[i].len))
+				continue;
+
+			if (len == 0) continue;
+			if (first_word == 1 && ( (file_info[i].dir == 1
+			&& conf.autocd == 0)
+			|| (file_info[i].dir == 0 && conf.auto_open == 0) ) )
+				continue;
+
+			if (words_num > 1 && rl_line_buffer && *rl_line_buffer == 'c'
+			&& rl_line_buffer[1] == 'd' && rl_line_buffer[2] == ' '
+			&& file_info[i].dir == 0)
+				continue;
+
 			int s = fuzzy_match(str, file_info[i].name, len, fuzzy_str_type);
+			if (s > 0) /* Candidate for the next, longer word */
+				fz_set[surv_n++] = i;
+
 			if (s > best_fz_score) {
 				fuzzy_index = i;
-				if (s == TARGET_BEGINNING_BONUS)
+				if (s == TARGET_BEGINNING_BONUS) {
+					/* The scan stops here, so the survivor set is
+					 * incomplete: do not reuse it. */
+					aborted = 1;
 					break;
+				}
 				best_fz_score = s;
 			}
 		}
+
+		if (aborted == 0)
+			i = files; /* As after the plain scan: no early break */
+
+		if (aborted == 1 || len >= sizeof(fz_word)) {
+			fz_set_n = -1;
+			fz_word_len = 0;
+		} else {
+			fz_set_n = surv_n;
+			memcpy(fz_word, str, len);
+			fz_word[len] = '\0';
+			fz_word_len = len;
+		}
 	}
 
 	if (fuzzy_index > -1) { /* We have a fuzzy match */
@@ -1085,35 +1412,41 @@ check_filenames(char *str, size_t len, const int first_word,
 static int
 check_history(const char *str, const size_t len)
 {
-	if (!history || !str || !*str || len == 0)
+	if (!str || !*str || len == 0)
 		return NO_MATCH;
 
-	int i = (int)current_hist_n;
-	while (--i >= 0) {
-		if (!history[i].cmd || TOUPPER(*str) != TOUPPER(*history[i].cmd))
-			continue;
-
-		if (len > 1 && *(history[i].cmd + 1)
-		&& TOUPPER(*(str + 1)) != TOUPPER(*(history[i].cmd + 1)))
-			continue;
+	/* Indexed by the first characters of STR: only history entries
+	 * sharing them are visited (see history_prefix_find()). */
+	const struct history_t *h = history_prefix_find(str, len);
+	if (!h)
+		return NO_MATCH;
 
-		if ((conf.case_sens_path_comp ? strncmp(str, history[i].cmd, len)
-		: strncasecmp(str, history[i].cmd, len)) == 0) {
-			if (history[i].len > len) {
-				suggestion.type = HIST_SUG;
-				print_suggestion(history[i].cmd, len, sh_c);
-				return PARTIAL_MATCH;
-			}
-			return FULL_MATCH;
-		}
+	if (h->len > len) {
+		suggestion.type = HIST_SUG;
+		print_suggestion(h->cmd, len, sh_c);
+		return PARTIAL_MATCH;
 	}
 
-	return NO_MATCH;
+	return FULL_MATCH;
+}
+
+static int
+sort_builtins(const void *a, const void *b)
+{
+	return strcmp(*(char * const *)a, *(char * const *)b);
 }
 
+/* Check STR against the builtins of the current shell (builtins.h) via
+ * a name-sorted view of the list, built once per shell. This runs per
+ * keystroke as part of the wrong-command classification driving the
+ * warning prompt. */
 static int
 check_builtins(const char *str, const size_t len, const int print)
 {
+	static char **sorted = (char **)NULL;
+	static size_t n = 0;
+	static int sorted_shell = -1;
+
 	char **b = (char **)NULL;
 
 	switch (shell) {
@@ -1127,23 +1460,39 @@ check_builtins(const char *str, const size_t len, const int print)
 	default: return NO_MATCH;
 	}
 
+	if (sorted_shell != shell) {
+		for (n = 0; b[n]; n++);
+		sorted = xnrealloc(sorted, n > 0 ? n : 1, sizeof(char *));
+		memcpy(sorted, b, n * sizeof(char *));
+		qsort(sorted, n, sizeof(char *), sort_builtins);
+		sorted_shell = shell;
+	}
+
+	/* Lower bound: the first builtin not smaller than STR's first LEN
+	 * bytes. Every prefix match lies in a contiguous range from here. */
+	size_t lo = 0, hi = n;
+	while (lo < hi) {
+		const size_t mid = lo + ((hi - lo) >> 1);
+		if (strncmp(sorted[mid], str, len) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
 	size_t i;
-	for (i = 0; b[i]; i++) {
-		if (*str != *b[i])
-			continue;
+	for (i = lo; i < n; i++) {
+		if (strncmp(sorted[i], str, len) != 0)
+			break; /* Past the matching range */
 
 		if (!print) {
-			if (strcmp(str, b[i]) == 0)	return FULL_MATCH;
+			if (strcmp(str, sorted[i]) == 0) return FULL_MATCH;
 			continue;
 		}
 
-		if (strncmp(b[i], str, len) != 0)
-			continue;
-
-		const size_t blen = strlen(b[i]);
+		const size_t blen = strlen(sorted[i]);
 		if (blen > len) {
 			suggestion.type = CMD_SUG;
-			print_suggestion(b[i], len, sb_c);
+			print_suggestion(sorted[i], len, sb_c);
 			return PARTIAL_MATCH;
 		}
 		return FULL_MATCH;
@@ -1212,10 +1561,16 @@ check_cmds(char *str, size_t len, const int print)
 		len--;
 	}
 
-	size_t i;
-	for (i = 0; bin_commands[i]; i++) {
-		if (!bin_commands[i] || *cmd != *bin_commands[i])
-			continue;
+	if (!cmds_index) /* In case we run before get_path_programs() */
+		update_cmds_index();
+
+	size_t best = (size_t)-1;
+	size_t k = cmds_index_lower_bound(cmd, len);
+
+	for (; k < cmds_index_n; k++) {
+		const size_t i = cmds_index[k];
+		if (strncmp(cmd, bin_commands[i], len) != 0)
+			break; /* Past the matching range */
 
 		if (!print) {
 			if (strcmp(cmd, bin_commands[i]) == 0)
@@ -1223,18 +1578,19 @@ check_cmds(char *str, size_t len, const int print)
 			continue;
 		}
 
-		/* Let's check the 2nd char as well before calling strcmp() */
-		if (len > 1 && *(bin_commands[i] + 1)
-		&& *(cmd + 1) != *(bin_commands[i] + 1))
+		/* Skip candidates print_cmd_suggestion() would reject, and keep
+		 * the first match in list order, just as the old linear scan did. */
+		if (conf.ext_cmd_ok == 0 && !is_internal_c(bin_commands[i]))
 			continue;
 
-		if (strncmp(cmd, bin_commands[i], len) != 0)
-			continue;
+		if (best == (size_t)-1 || i < best)
+			best = i;
+	}
 
-		int ret = print_cmd_suggestion(i, len);
-		if (ret == NO_MATCH)
-			continue;
-		return ret;
+	if (best != (size_t)-1) {
+		const int ret = print_cmd_suggestion(best, len);
+		if (ret != NO_MATCH)
+			return ret;
 	}
 
 	return print_internal_cmd_suggestion(cmd, len, print);
@@ -1344,6 +1700,10 @@ check_aliases(const char *str, const size_t len, const int print)
 
 	char *color = sc_c;
 
+	if (!print && conf.case_sens_path_comp == 1)
+		/* Exact, case sensitive matches come from the alias hash index. */
+		return alias_lookup(str) != -1 ? FULL_MATCH : NO_MATCH;
+
 	int i = (int)aliases_n;
 	while (--i >= 0) {
 		if (!aliases[i].name)
@@ -1614,16 +1974,14 @@ check_tags(const char *str, const size_t len, const int type)
 	if (!str || !*str || len == 0 || tags_n == 0 || !tags)
 		return NO_MATCH;
 
-	size_t i;
-	for (i = 0; tags[i]; i++) {
-		if (*str != *tags[i] || strncmp(str, tags[i], len) != 0)
-			continue;
-		suggestion.type = type;
-		print_suggestion(tags[i], len, sf_c);
-		return PARTIAL_MATCH;
-	}
+	size_t st = 0;
+	char *name = candidates_next(CAND_TAGS, str, len, 1, &st);
+	if (!name)
+		return NO_MATCH;
 
-	return NO_MATCH;
+	suggestion.type = type;
+	print_suggestion(name, len, sf_c);
+	return PARTIAL_MATCH;
 }
 #endif /* _NO_TAGS */
 
@@ -1652,8 +2010,6 @@ check_sort_methods(const char *str, const size_t len)
 static int
 check_prompts(char *word, const size_t len)
 {
-	int i = (int)prompts_n;
-
 	char *q = (char *)NULL, *w = word;
 	size_t l = len;
 
@@ -1663,17 +2019,16 @@ check_prompts(char *word, const size_t len)
 		l = w == q ? strlen(w) : len;
 	}
 
-	while (--i >= 0) {
-		if (TOUPPER(*w) == TOUPPER(*prompts[i].name)
-		&& (conf.case_sens_list ? strncmp(prompts[i].name, w, l)
-		: strncasecmp(prompts[i].name, w, l)) == 0) {
-			suggestion.type = PROMPT_SUG;
-			char *p = escape_str(prompts[i].name);
-			print_suggestion(p ? p : prompts[i].name, len, sx_c);
-			free(p);
-			free(q);
-			return PARTIAL_MATCH;
-		}
+	size_t st = 0;
+	char *name = candidates_next(CAND_PROMPTS, w, l,
+		conf.case_sens_list, &st);
+	if (name) {
+		suggestion.type = PROMPT_SUG;
+		char *p = escape_str(name);
+		print_suggestion(p ? p : name, len, sx_c);
+		free(p);
+		free(q);
+		return PARTIAL_MATCH;
 	}
 
 	free(q);
@@ -1778,7 +2133,7 @@ check_fastback(char *w)
 static int
 check_profiles(char *word, const size_t len)
 {
-	if (!word || !*word || !profile_names)
+	if (!word || !*word)
 		return NO_MATCH;
 
 	char *q = (char *)NULL, *w = word;
@@ -1790,20 +2145,16 @@ check_profiles(char *word, const size_t len)
 		l = w == q ? strlen(w) : len;
 	}
 
-	size_t i;
-	for (i = 0; profile_names[i]; i++) {
-		if (conf.case_sens_list == 0
-		? (TOUPPER(*w) == TOUPPER(*profile_names[i])
-		&& strncasecmp(w, profile_names[i], l) == 0)
-		: (*w == *profile_names[i]
-		&& strncmp(w, profile_names[i], l) == 0)) {
-			suggestion.type = PROFILE_SUG;
-			char *p = escape_str(profile_names[i]);
-			print_suggestion(p ? p : profile_names[i], len, sx_c);
-			free(p);
-			free(q);
-			return PARTIAL_MATCH;
-		}
+	size_t st = 0;
+	char *name = candidates_next(CAND_PROFILES, w, l,
+		conf.case_sens_list, &st);
+	if (name) {
+		suggestion.type = PROFILE_SUG;
+		char *p = escape_str(name);
+		print_suggestion(p ? p : name, len, sx_c);
+		free(p);
+		free(q);
+		return PARTIAL_MATCH;
 	}
 
 	free(q);
@@ -1814,7 +2165,7 @@ check_profiles(char *word, const size_t len)
 static int
 check_remotes(char *word, const size_t len)
 {
-	if (!word || !*word || !remotes)
+	if (!word || !*word)
 		return NO_MATCH;
 
 	char *q = (char *)NULL, *w = word;
@@ -1826,20 +2177,16 @@ check_remotes(char *word, const size_t len)
 		l = w == q ? strlen(w) : len;
 	}
 
-	size_t i;
-	for (i = 0; remotes[i].name; i++) {
-		if (conf.case_sens_list == 0
-		? (TOUPPER(*w) == TOUPPER(*remotes[i].name)
-		&& strncasecmp(w, remotes[i].name, l) == 0)
-		: (*w == *remotes[i].name
-		&& strncmp(w, remotes[i].name, l) == 0)) {
-			suggestion.type = NET_SUG;
-			char *p = escape_str(remotes[i].name);
-			print_suggestion(p ? p : remotes[i].name, len, sx_c);
-			free(p);
-			free(q);
-			return PARTIAL_MATCH;
-		}
+	size_t st = 0;
+	char *name = candidates_next(CAND_REMOTES, w, l,
+		conf.case_sens_list, &st);
+	if (name) {
+		suggestion.type = NET_SUG;
+		char *p = escape_str(name);
+		print_suggestion(p ? p : name, len, sx_c);
+		free(p);
+		free(q);
+		return PARTIAL_MATCH;
 	}
 
 	free(q);
@@ -1849,7 +2196,7 @@ check_remotes(char *word, const size_t len)
 static int
 check_color_schemes(char *word, const size_t len)
 {
-	if (!word || !*word || !color_schemes)
+	if (!word || !*word)
 		return NO_MATCH;
 
 	char *q = (char *)NULL, *w = word;
@@ -1861,20 +2208,16 @@ check_color_schemes(char *word, const size_t len)
 		l = w == q ? strlen(w) : len;
 	}
 
-	size_t i;
-	for (i = 0; color_schemes[i]; i++) {
-		if (conf.case_sens_list == 0
-		? (TOUPPER(*w) == TOUPPER(*color_schemes[i])
-		&& strncasecmp(w, color_schemes[i], l) == 0)
-		: (*w == *color_schemes[i]
-		&& strncmp(w, color_schemes[i], l) == 0)) {
-			suggestion.type = CSCHEME_SUG;
-			char *p = escape_str(color_schemes[i]);
-			print_suggestion(p ? p : color_schemes[i], len, sx_c);
-			free(p);
-			free(q);
-			return PARTIAL_MATCH;
-		}
+	size_t st = 0;
+	char *name = candidates_next(CAND_CSCHEMES, w, l,
+		conf.case_sens_list, &st);
+	if (name) {
+		suggestion.type = CSCHEME_SUG;
+		char *p = escape_str(name);
+		print_suggestion(p ? p : name, len, sx_c);
+		free(p);
+		free(q);
+		return PARTIAL_MATCH;
 	}
 
 	free(q);
@@ -1884,7 +2227,7 @@ check_color_schemes(char *word, const size_t len)
 static int
 check_bookmark_names(char *word, const size_t len)
 {
-	if (!word || !*word || !bookmarks)
+	if (!word || !*word)
 		return NO_MATCH;
 
 	size_t prefix = (*word == 'b' && *(word + 1) == ':') ? 2 : 0;
@@ -1897,28 +2240,21 @@ check_bookmark_names(char *word, const size_t len)
 		l = w == q ? strlen(w) : len;
 	}
 
-	size_t i;
-	for (i = 0; i < bm_n; i++) {
-		if (!bookmarks[i].name || !*bookmarks[i].name)
-			continue;
-
-		if (conf.case_sens_list == 0
-		? (TOUPPER(*w) == TOUPPER(*bookmarks[i].name)
-		&& strncasecmp(w, bookmarks[i].name, l) == 0)
-		: (*w == *bookmarks[i].name
-		&& strncmp(w, bookmarks[i].name, l) == 0)) {
-			if (prefix == 2 && !*(bookmarks[i].name + l)) // full match
-				break;
+	size_t st = 0;
+	char *name;
+	while ((name = candidates_next(CAND_BOOKMARKS, w, l,
+	conf.case_sens_list, &st)) != NULL) {
+		if (prefix == 2 && !*(name + l)) // full match
+			break;
 
-			char *p = escape_str(bookmarks[i].name);
+		char *p = escape_str(name);
 
-			suggestion.type = prefix == 2 ? BM_PREFIX_SUG : BM_NAME_SUG;
-			print_suggestion(p ? p : bookmarks[i].name, len - prefix, sx_c);
+		suggestion.type = prefix == 2 ? BM_PREFIX_SUG : BM_NAME_SUG;
+		print_suggestion(p ? p : name, len - prefix, sx_c);
 
-			free(p);
-			free(q);
-			return PARTIAL_MATCH;
-		}
+		free(p);
+		free(q);
+		return PARTIAL_MATCH;
 	}
 
 	free(q);
@@ -1976,6 +2312,11 @@ check_dirhist(char *word, const size_t len)
 		if (!old_pwd[i] || !*old_pwd[i] || *old_pwd[i] == KEY_ESC)
 			continue;
 
+		/* Match each unique path only once, at its most recent position:
+		 * repeated visits pile up duplicated entries. */
+		if (dirhist_index_latest(old_pwd[i]) > i)
+			continue;
+
 		if (conf.fuzzy_match == 0 || rl_point < rl_end) {
 			if (strstr(old_pwd[i], word)) {
 				suggestion.type = DIRHIST_SUG;
@@ -2007,8 +2348,8 @@ check_dirhist(char *word, const size_t len)
 /* Check for available suggestions. Returns zero if true, one if not,
  * and -1 if C was inserted before the end of the current line.
  * If a suggestion is found, it will be printed by print_suggestion() */
-int
-rl_suggestions(const unsigned char c)
+static int
+rl_suggestions_int(const unsigned char c)
 {
 	if (*rl_line_buffer == '#' || cur_color == hc_c) {
 		/* No suggestion at all if comment */
@@ -2668,6 +3009,19 @@ FAIL:
 
 	return FUNC_FAILURE;
 }
+
+/* Wrapper around rl_suggestions_int(): account the time taken to compute
+ * the suggestion whenever 'perf' instrumentation is enabled. */
+int
+rl_suggestions(const unsigned char c)
+{
+	clock_gettime(CLOCK_MONOTONIC, &sug_start);
+	perf_begin(PERF_SUGGEST);
+	const int ret = rl_suggestions_int(c);
+	perf_end(PERF_SUGGEST);
+
+	return ret;
+}
 #else
 void *_skip_me_suggestions;
 #endif /* _NO_SUGGESTIONS */
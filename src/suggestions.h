@@ -29,6 +29,8 @@ __BEGIN_DECLS
 
 void clear_suggestion(const int sflag);
 void free_suggestion(void);
+void invalidate_fnames_index(void);
+void update_cmds_index(void);
 void print_suggestion(char *str, size_t offset, char *color);
 void remove_suggestion_not_end(void);
 int  recover_from_wrong_cmd(void);
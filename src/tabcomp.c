@@ -52,16 +52,27 @@ typedef char *rl_cpvfunc_t;
 
 #include <errno.h>
 
+#include <sys/select.h> /* Distinguish ESC from escape sequences */
 #include <termios.h> /* Get cursor position functions */
 
+#if defined(__linux__) && !defined(_BE_POSIX)
+# if !defined(__GLIBC__) || (__GLIBC__ > 2 \
+|| (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+#  define FINDER_MEMFD /* memfd_create(2): glibc >= 2.27 */
+#  include <sys/mman.h> /* memfd_create() */
+# endif /* !__GLIBC__ || __GLIBC__ >= 2.27 */
+#endif /* __linux__ && !_BE_POSIX */
+
 #include "aux.h"
 #include "checks.h"
 #include "colors.h"
+#include "fuzzy_match.h" /* Internal finder */
 #ifndef _NO_HIGHLIGHT
 # include "highlight.h"
 #endif /* !_NO_HIGHLIGHT */
 #include "misc.h"
 #include "navigation.h"
+#include "perf.h" /* perf_begin(), perf_end() */
 #include "readline.h"
 #include "selection.h"
 #include "sort.h"
@@ -83,6 +94,27 @@ typedef char *rl_cpvfunc_t;
 static char finder_in_file[PATH_MAX + 1];
 static char finder_out_file[PATH_MAX + 1];
 
+#ifdef FINDER_MEMFD
+/* Memory-only backing for FINDER_IN_FILE and FINDER_OUT_FILE (see
+ * set_finder_paths()). -1 if memfd_create(2) is unavailable at runtime,
+ * in which case regular temp files are used instead. */
+static int finder_memfd_in = -1;
+static int finder_memfd_out = -1;
+#endif /* FINDER_MEMFD */
+
+/* Remove FILE, one of the finder's exchange files, once used. If the
+ * file is backed by a memfd there is nothing on disk to remove (the
+ * descriptor is kept open and just truncated on the next TAB press). */
+static void
+finder_file_cleanup(const char *file)
+{
+#ifdef FINDER_MEMFD
+	if (finder_memfd_in != -1 && finder_memfd_out != -1)
+		return;
+#endif /* FINDER_MEMFD */
+	unlink(file);
+}
+
 /* We need to know the longest entry (if previewing files) to correctly
  * calculate the width of the preview window. */
 static size_t longest_prev_entry;
@@ -142,7 +174,7 @@ disable_raw_mode(const int fd)
 /* Use the "ESC [6n" escape sequence to query the cursor position (both
  * vertical and horizontal) and store both values into C (columns) and L (lines).
  * Returns 0 on success and 1 on error */
-static int
+int
 get_cursor_position(int *c, int *l)
 {
 	char buf[32];
@@ -196,7 +228,7 @@ stat_char(const char *filename)
 	int r;
 
 #ifdef S_ISLNK
-	r = lstat(filename, &attr);
+	r = xlstat_cached(filename, &attr);
 #else
 	r = stat(filename, &attr);
 #endif /* S_ISLNK */
@@ -440,7 +472,7 @@ get_entry_color(char *entry, const char *norm_prefix)
 		char tmp[PATH_MAX + 1];
 		snprintf(tmp, sizeof(tmp), "%s/%s", norm_prefix,
 			(s && *(++s)) ? s : entry);
-		if (lstat(tmp, &attr) != -1)
+		if (xlstat_cached(tmp, &attr) != -1)
 			return fzftab_color(tmp, &attr);
 		return uf_c;
 	}
@@ -451,7 +483,7 @@ get_entry_color(char *entry, const char *norm_prefix)
 	&& (t == TCMP_PATH || t == TCMP_SEL || t == TCMP_DESEL
 	|| t == TCMP_BM_PATHS || t == TCMP_DIRHIST || t == TCMP_JUMP) ) {
 		char *f = *vt_file ? vt_file : entry;
-		if (lstat(f, &attr) != -1)
+		if (xlstat_cached(f, &attr) != -1)
 			return fzftab_color(f, &attr);
 		return uf_c;
 	}
@@ -462,7 +494,7 @@ get_entry_color(char *entry, const char *norm_prefix)
 		char *exp_path = tilde_expand(entry);
 		if (exp_path) {
 			char *color = uf_c;
-			if (lstat(exp_path, &attr) != -1)
+			if (xlstat_cached(exp_path, &attr) != -1)
 				color = fzftab_color(exp_path, &attr);
 			free(exp_path);
 			return color;
@@ -471,12 +503,12 @@ get_entry_color(char *entry, const char *norm_prefix)
 
 	if (t == TCMP_PATH || t == TCMP_RANGES) {
 		if (*vt_file) {
-			if (lstat(vt_file, &attr) != -1)
+			if (xlstat_cached(vt_file, &attr) != -1)
 				return fzftab_color(vt_file, &attr);
 		} else {
 			char tmp[PATH_MAX + 1];
 			snprintf(tmp, sizeof(tmp), "%s/%s", workspaces[cur_ws].path, entry);
-			if (lstat(tmp, &attr) != -1)
+			if (xlstat_cached(tmp, &attr) != -1)
 				return fzftab_color(tmp, &attr);
 		}
 
@@ -486,7 +518,7 @@ get_entry_color(char *entry, const char *norm_prefix)
 	if (t == TCMP_UNTRASH || t == TCMP_TRASHDEL || t == TCMP_GLOB
 	|| t == TCMP_TAGS_F || t == TCMP_FILE_TYPES_FILES) {
 		char *f = (t == TCMP_GLOB && *vt_file) ? vt_file : entry;
-		if (lstat(f, &attr) != -1)
+		if (xlstat_cached(f, &attr) != -1)
 			return fzftab_color(f, &attr);
 		return uf_c;
 	}
@@ -978,6 +1010,72 @@ get_glob_file_target(char *str, const char *initial_path)
 	return p;
 }
 
+/* Process LINE (LINE_LEN bytes), a single entry picked by the finder,
+ * and append the string to be inserted into the line buffer to *BUF
+ * (resized as needed; *BSIZE keeps track of its allocated size). */
+static void
+append_finder_match(char *line, ssize_t line_len, const int multi,
+	char *initial_path, char **buf, size_t *bsize)
+{
+	if (cur_comp_type == TCMP_FILE_TYPES_OPTS && *line && *(line + 1)) {
+		*(line + 1) = '\0';
+		line_len = 1;
+	}
+
+	if (cur_comp_type == TCMP_CMD_DESC && *line) {
+		char *p = strchr(line, ' ');
+		if (p) {
+			*p = '\0';
+			line_len = (ssize_t)strlen(line);
+		}
+	}
+
+	char *q = line;
+	if (multi == 1) {
+		char *s = line;
+		if ((flags & PREVIEWER) && workspaces[cur_ws].path) {
+			char f[PATH_MAX];
+			snprintf(f, sizeof(f), "%s/%s", workspaces[cur_ws].path, s);
+			select_file(f);
+			return;
+		} else if (cur_comp_type == TCMP_GLOB) {
+			s = get_glob_file_target(line, initial_path);
+		} else if (cur_comp_type == TCMP_TAGS_F && tags_dir && cur_tag) {
+			s = get_tagged_file_target(line);
+		} else if (cur_comp_type == TCMP_BM_PREFIX) {
+			size_t len = strlen(line) + 3;
+			s = xnmalloc(len, sizeof(char));
+			snprintf(s, len, "b:%s", line);
+		} else if (cur_comp_type == TCMP_TAGS_T) {
+			size_t len = strlen(line) + 3;
+			s = xnmalloc(len, sizeof(char));
+			snprintf(s, len, "t:%s", line);
+		}
+		q = escape_str(s);
+		if (s != line)
+			free(s);
+		if (!q)
+			return;
+	}
+
+	/* We don't want to quote the initial tilde */
+	char *r = q;
+	if (*r == '\\' && *(r + 1) == '~')
+		r++;
+
+	size_t qlen = (r != line) ? strlen(r) : (size_t)line_len;
+	*bsize += qlen + 3;
+	*buf = xnrealloc(*buf, *bsize, sizeof(char));
+	xstrncat(*buf, strlen(*buf), r, *bsize);
+
+	if (multi == 1) {
+		size_t l = strlen(*buf);
+		(*buf)[l] = ' ';
+		(*buf)[l + 1] = '\0';
+		free(q);
+	}
+}
+
 /* Recover finder (fzf/fnf/smenu) output from FINDER_OUT_FILE file.
  * Return this output (reformated if needed) or NULL in case of error.
  * FINDER_OUT_FILE is removed immediately after use.  */
@@ -986,7 +1084,7 @@ get_finder_output(const int multi, char *base)
 {
 	FILE *fp = fopen(finder_out_file, "r");
 	if (!fp) {
-		unlink(finder_out_file);
+		finder_file_cleanup(finder_out_file);
 		return print_no_finder_file();
 	}
 
@@ -1002,68 +1100,13 @@ get_finder_output(const int multi, char *base)
 			line[line_len] = '\0';
 		}
 
-		if (cur_comp_type == TCMP_FILE_TYPES_OPTS && *line && *(line + 1)) {
-			*(line + 1) = '\0';
-			line_len = 1;
-		}
-
-		if (cur_comp_type == TCMP_CMD_DESC && *line) {
-			char *p = strchr(line, ' ');
-			if (p) {
-				*p = '\0';
-				line_len = (ssize_t)strlen(line);
-			}
-		}
-
-		char *q = line;
-		if (multi == 1) {
-			char *s = line;
-			if ((flags & PREVIEWER) && workspaces[cur_ws].path) {
-				char f[PATH_MAX];
-				snprintf(f, sizeof(f), "%s/%s", workspaces[cur_ws].path, s);
-				select_file(f);
-				continue;
-			} else if (cur_comp_type == TCMP_GLOB) {
-				s = get_glob_file_target(line, initial_path);
-			} else if (cur_comp_type == TCMP_TAGS_F && tags_dir && cur_tag) {
-				s = get_tagged_file_target(line);
-			} else if (cur_comp_type == TCMP_BM_PREFIX) {
-				size_t len = strlen(line) + 3;
-				s = xnmalloc(len, sizeof(char));
-				snprintf(s, len, "b:%s", line);
-			} else if (cur_comp_type == TCMP_TAGS_T) {
-				size_t len = strlen(line) + 3;
-				s = xnmalloc(len, sizeof(char));
-				snprintf(s, len, "t:%s", line);
-			}
-			q = escape_str(s);
-			if (s != line)
-				free(s);
-			if (!q)
-				continue;
-		}
-
-		/* We don't want to quote the initial tilde */
-		char *r = q;
-		if (*r == '\\' && *(r + 1) == '~')
-			r++;
-
-		size_t qlen = (r != line) ? strlen(r) : (size_t)line_len;
-		bsize += qlen + 3;
-		buf = xnrealloc(buf, bsize, sizeof(char));
-		xstrncat(buf, strlen(buf), r, bsize);
-
-		if (multi == 1) {
-			size_t l = strlen(buf);
-			buf[l] = ' ';
-			buf[l + 1] = '\0';
-			free(q);
-		}
+		append_finder_match(line, line_len, multi, initial_path,
+			&buf, &bsize);
 	}
 
 	free(line);
 	fclose(fp);
-	unlink(finder_out_file);
+	finder_file_cleanup(finder_out_file);
 
 	if (*buf == '\0') {
 		free(buf);
@@ -1088,6 +1131,205 @@ write_comp_to_file(char *entry, const char *color, FILE *fp)
 	fprintf(fp, "%s%s%s%c", color, entry, NC, end_char);
 }
 
+/* The internal finder ('TabCompletionMode=internal'): an in-process
+ * fuzzy picker working directly on the in-memory list of completions,
+ * so that no temp files are written and no process is spawned per TAB
+ * press. Candidates are collected by store_completions() (exactly as
+ * they would have been written to FINDER_IN_FILE), then filtered,
+ * displayed, and picked by run_internal_finder(). */
+
+struct ifinder_entry_t {
+	char *text; /* The entry as displayed (and as returned when picked) */
+	char *color;
+};
+
+static struct ifinder_entry_t *ifinder_entries = (struct ifinder_entry_t *)NULL;
+static size_t ifinder_n = 0;
+static size_t ifinder_cap = 0;
+/* Set by finder_tabcomp() while the internal finder is in use. */
+static int ifinder_active = 0;
+
+static void
+ifinder_free(void)
+{
+	size_t i;
+	for (i = 0; i < ifinder_n; i++) {
+		free(ifinder_entries[i].text);
+		free(ifinder_entries[i].color);
+	}
+
+	free(ifinder_entries);
+	ifinder_entries = (struct ifinder_entry_t *)NULL;
+	ifinder_n = ifinder_cap = 0;
+}
+
+/* Add the completion ENTRY, displayed with COLOR, to the internal
+ * finder's candidates list (the in-memory counterpart of
+ * write_comp_to_file()). */
+static void
+ifinder_add(const char *entry, const char *color)
+{
+	if (ifinder_n == ifinder_cap) {
+		ifinder_cap += 512;
+		ifinder_entries = xnrealloc(ifinder_entries, ifinder_cap,
+			sizeof(struct ifinder_entry_t));
+	}
+
+	char *wname = (wc_xstrlen(entry) == 0)
+		? replace_invalid_chars(entry) : (char *)NULL;
+	const char *text = wname ? wname : entry;
+
+	ifinder_entries[ifinder_n].text = savestring(text, strlen(text));
+	ifinder_entries[ifinder_n].color = savestring(color, strlen(color));
+	ifinder_n++;
+
+	free(wname);
+}
+
+/* Store into IDX the indices of the candidates matching QUERY (fuzzily
+ * if FuzzyMatching is enabled, else as a substring) and return how many
+ * matched. An empty QUERY matches everything. */
+static size_t
+ifinder_filter(char *query, size_t *idx)
+{
+	size_t n = 0, i;
+	const size_t qlen = strlen(query);
+
+	if (qlen == 0) {
+		for (i = 0; i < ifinder_n; i++)
+			idx[n++] = i;
+		return n;
+	}
+
+	const int ftype = contains_utf8(query) == 1
+		? FUZZY_FILES_UTF8 : FUZZY_FILES_ASCII;
+
+	for (i = 0; i < ifinder_n; i++) {
+		char *text = ifinder_entries[i].text;
+		int found;
+
+		if (conf.fuzzy_match == 1) {
+			found = fuzzy_match(query, text, qlen, ftype) > 0;
+		} else {
+			found = conf.case_sens_path_comp == 1
+				? (strstr(text, query) != NULL)
+				: (xstrcasestr(text, query) != NULL);
+		}
+
+		if (found)
+			idx[n++] = i;
+	}
+
+	return n;
+}
+
+/* Print ENTRY (in COLOR), truncated to at most MAX_COLS columns. Byte
+ * truncation is accurate for ASCII names; for multi-byte names it only
+ * errs on the short side (a UTF-8 char takes at least as many bytes as
+ * columns), backing off any split character. */
+static void
+ifinder_print_entry(const char *color, const char *entry, const int max_cols)
+{
+	const size_t len = strlen(entry);
+
+	if (max_cols <= 0 || (int)wc_xstrlen(entry) <= max_cols
+	|| (size_t)max_cols >= len) {
+		printf("%s%s%s", color, entry, NC);
+		return;
+	}
+
+	size_t cut = (size_t)max_cols;
+	while (cut > 0 && (entry[cut] & 0xc0) == 0x80)
+		cut--;
+
+	printf("%s%.*s%s", color, (int)cut, entry, NC);
+}
+
+/* Draw the internal finder: one query line plus HEIGHT - 1 entry rows,
+ * left-padded OFFSET columns. The cursor is expected at the top left
+ * corner of the finder's area, and is left there when done. */
+static void
+ifinder_draw(const size_t height, const int offset, const char *query,
+	const size_t *idx, const size_t vis_n, const size_t cur,
+	const size_t top, const char *sel, const int multi)
+{
+	const int pad = offset > 0 ? offset : 0;
+	const int max_cols = term_cols - pad - (multi == 1 ? 5 : 3);
+	size_t r;
+
+	printf("\r\x1b[K%*s%s>%s %s", pad, "", mi_c, NC, query);
+
+	for (r = 0; r + 1 < height; r++) {
+		const size_t vi = top + r;
+		printf("\n\r\x1b[K");
+
+		if (vi >= vis_n)
+			continue;
+
+		const struct ifinder_entry_t *e = &ifinder_entries[idx[vi]];
+		printf("%*s%s%s%s%s", pad, "",
+			mi_c, vi == cur ? "> " : "  ",
+			(multi == 1 && sel[idx[vi]] == 1) ? "*" : (multi == 1 ? " " : ""),
+			NC);
+		ifinder_print_entry(e->color, e->text, max_cols);
+	}
+
+	if (height > 1)
+		MOVE_CURSOR_UP((int)height - 1);
+	putchar('\r');
+	fflush(stdout);
+}
+
+/* Read a single key from standard input, decoding the escape sequences
+ * we care about. Returns the key itself for regular characters, or one
+ * of the negative IFINDER_KEY_* values for recognized special keys. */
+#define IFINDER_KEY_UP     (-2)
+#define IFINDER_KEY_DOWN   (-3)
+#define IFINDER_KEY_RIGHT  (-4)
+#define IFINDER_KEY_LEFT   (-5)
+#define IFINDER_KEY_ESC    (-6)
+#define IFINDER_KEY_NONE   (-7)
+
+static int
+ifinder_getkey(void)
+{
+	unsigned char c = 0;
+
+	if (read(STDIN_FILENO, &c, 1) != 1) /* flawfinder: ignore */
+		return (errno == EINTR) ? IFINDER_KEY_NONE : IFINDER_KEY_ESC;
+
+	if (c != KEY_ESC)
+		return c;
+
+	/* Lone ESC or start of an escape sequence? Peek for more input. */
+	fd_set fds;
+	struct timeval tv;
+	FD_ZERO(&fds);
+	FD_SET(STDIN_FILENO, &fds);
+	tv.tv_sec = 0;
+	tv.tv_usec = 25000;
+
+	if (select(STDIN_FILENO + 1, &fds, NULL, NULL, &tv) <= 0)
+		return IFINDER_KEY_ESC;
+
+	if (read(STDIN_FILENO, &c, 1) != 1 || c != '[') /* flawfinder: ignore */
+		return IFINDER_KEY_ESC;
+
+	/* Swallow the whole sequence, keeping only its final byte. */
+	while (read(STDIN_FILENO, &c, 1) == 1) { /* flawfinder: ignore */
+		if (c >= 0x40 && c <= 0x7e)
+			break;
+	}
+
+	switch (c) {
+	case 'A': return IFINDER_KEY_UP;
+	case 'B': return IFINDER_KEY_DOWN;
+	case 'C': return IFINDER_KEY_RIGHT;
+	case 'D': return IFINDER_KEY_LEFT;
+	default: return IFINDER_KEY_NONE;
+	}
+}
+
 /* Return a normalized (absolute) path for the query string PREFIX.
  * Ex: "./b<TAB>" -> /parent/dir
  * The partially typed basename, here 'b', is excluded, since it will be added
@@ -1114,11 +1356,18 @@ static size_t
 store_completions(char **matches)
 {
 	int fd = 0;
-	FILE *fp = open_fwrite(finder_in_file, &fd);
-	if (!fp) {
-		err('e', PRINT_PROMPT, "%s: %s: %s\n", PROGRAM_NAME,
-			finder_in_file, strerror(errno));
-		return (size_t)-1;
+	FILE *fp = (FILE *)NULL;
+
+	if (ifinder_active == 1) {
+		/* The internal finder keeps candidates in memory: no temp file. */
+		ifinder_free();
+	} else {
+		fp = open_fwrite(finder_in_file, &fd);
+		if (!fp) {
+			err('e', PRINT_PROMPT, "%s: %s: %s\n", PROGRAM_NAME,
+				finder_in_file, strerror(errno));
+			return (size_t)-1;
+		}
 	}
 
 	int no_file_comp = 0;
@@ -1200,8 +1449,12 @@ store_completions(char **matches)
 			}
 		}
 
-		if (*entry)
-			write_comp_to_file(entry, color, fp);
+		if (*entry) {
+			if (ifinder_active == 1)
+				ifinder_add(entry, color);
+			else
+				write_comp_to_file(entry, color, fp);
+		}
 	}
 
 #ifndef _NO_TRASH
@@ -1211,11 +1464,194 @@ store_completions(char **matches)
 		xchdir(workspaces[cur_ws].path, NO_TITLE);
 #endif /* _NO_TRASH */
 
-	fclose(fp);
+	if (fp)
+		fclose(fp);
 	free(norm_prefix);
 	return i;
 }
 
+/* Run the internal fuzzy finder over the candidates collected by
+ * store_completions(): HEIGHT lines (query line included) are drawn
+ * below the prompt, left-padded OFFSET columns, starting with
+ * INITIAL_QUERY (may be NULL) as query string. Keys: typing narrows the
+ * list; Up/Down (also C-p/C-n) move; Enter/Right accept; ESC/Left
+ * cancel; TAB toggles selection when MULTI is set (else accepts). BASE
+ * is matches[0] (needed to resolve TCMP_GLOB targets).
+ * On success the string(s) to insert are returned in *OUT, built just
+ * as get_finder_output() builds them from fzf's output. */
+static int
+run_internal_finder(size_t height, const int offset, const char *initial_query,
+	const int multi, char *base, char **out)
+{
+	*out = (char *)NULL;
+
+	if (ifinder_n == 0)
+		return FUNC_FAILURE;
+
+	if (height == 0)
+		height = set_fzf_max_win_height();
+	if (height > ifinder_n + 1)
+		height = ifinder_n + 1;
+	if (height < 2)
+		height = 2;
+	if (term_lines > 2 && height > (size_t)term_lines - 1)
+		height = (size_t)term_lines - 1;
+
+	char query[NAME_MAX + 1];
+	xstrsncpy(query, initial_query ? initial_query : "", sizeof(query));
+	size_t qlen = strlen(query);
+
+	size_t *idx = xnmalloc(ifinder_n, sizeof(size_t));
+	char *sel = xcalloc(ifinder_n, sizeof(char));
+
+	size_t vis_n = ifinder_filter(query, idx);
+	size_t cur = 0, top = 0;
+
+	if (enable_raw_mode(STDIN_FILENO) == -1) {
+		free(idx);
+		free(sel);
+		return FUNC_FAILURE;
+	}
+
+	const int dr = (flags & DELAYED_REFRESH) ? 1 : 0;
+	flags &= ~DELAYED_REFRESH;
+
+	/* Move below the prompt line: this is the finder area's top left
+	 * corner, where the cursor is kept between redraws. */
+	fputs("\r\n", stdout);
+
+	int ret = -1;
+	while (ret == -1) {
+		const size_t rows = height - 1;
+		if (cur >= vis_n)
+			cur = vis_n > 0 ? vis_n - 1 : 0;
+		if (cur < top)
+			top = cur;
+		if (cur >= top + rows)
+			top = cur - rows + 1;
+
+		ifinder_draw(height, offset, query, idx, vis_n, cur, top,
+			sel, multi);
+
+		const int key = ifinder_getkey();
+		switch (key) {
+		case '\r': /* fallthrough */
+		case '\n': /* fallthrough */
+		case IFINDER_KEY_RIGHT:
+			ret = FUNC_SUCCESS; break;
+
+		case IFINDER_KEY_ESC: /* fallthrough */
+		case IFINDER_KEY_LEFT: /* fallthrough */
+		case 3: /* C-c */ /* fallthrough */
+		case 7: /* C-g */
+			ret = FUNC_FAILURE; break;
+
+		case IFINDER_KEY_UP: /* fallthrough */
+		case 16: /* C-p */
+			if (cur > 0)
+				cur--;
+			break;
+
+		case IFINDER_KEY_DOWN: /* fallthrough */
+		case 14: /* C-n */
+			if (cur + 1 < vis_n)
+				cur++;
+			break;
+
+		case '\t':
+			if (multi == 0) {
+				ret = FUNC_SUCCESS;
+				break;
+			}
+			if (cur < vis_n) {
+				sel[idx[cur]] = sel[idx[cur]] == 1 ? 0 : 1;
+				if (cur + 1 < vis_n)
+					cur++;
+			}
+			break;
+
+		case 8: /* fallthrough */ /* C-h */
+		case 127: /* Backspace */
+			if (qlen == 0)
+				break;
+			qlen--;
+			/* Remove the whole character, not just the last byte. */
+			while (qlen > 0 && (query[qlen] & 0xc0) == 0x80)
+				qlen--;
+			query[qlen] = '\0';
+			vis_n = ifinder_filter(query, idx);
+			cur = 0;
+			break;
+
+		case IFINDER_KEY_NONE: break;
+
+		default:
+			if (key < 32 || qlen + 1 >= sizeof(query))
+				break;
+			query[qlen] = (char)key;
+			qlen++;
+			query[qlen] = '\0';
+			vis_n = ifinder_filter(query, idx);
+			cur = 0;
+			break;
+		}
+	}
+
+	/* Erase the finder area, leaving the cursor at its top left corner
+	 * (where fzf leaves it too). */
+	putchar('\r');
+	ERASE_TO_RIGHT_AND_BELOW;
+	fflush(stdout);
+
+	disable_raw_mode(STDIN_FILENO);
+
+	if (dr == 1)
+		flags |= DELAYED_REFRESH;
+
+	if (ret == FUNC_SUCCESS) {
+		char *buf = xnmalloc(1, sizeof(char));
+		*buf = '\0';
+		size_t bsize = 0;
+		char *initial_path = (cur_comp_type == TCMP_GLOB)
+			? base : (char *)NULL;
+		size_t picked = 0, i;
+
+		if (multi == 1) {
+			for (i = 0; i < ifinder_n && picked < ifinder_n; i++) {
+				if (sel[i] == 0)
+					continue;
+				char *line = savestring(ifinder_entries[i].text,
+					strlen(ifinder_entries[i].text));
+				append_finder_match(line, (ssize_t)strlen(line), multi,
+					initial_path, &buf, &bsize);
+				free(line);
+				picked++;
+			}
+		}
+
+		if (picked == 0 && cur < vis_n) {
+			char *line = savestring(ifinder_entries[idx[cur]].text,
+				strlen(ifinder_entries[idx[cur]].text));
+			append_finder_match(line, (ssize_t)strlen(line), multi,
+				initial_path, &buf, &bsize);
+			free(line);
+			picked++;
+		}
+
+		if (picked == 0 || !*buf) {
+			free(buf);
+			ret = FUNC_FAILURE;
+		} else {
+			*out = buf;
+		}
+	}
+
+	free(idx);
+	free(sel);
+
+	return ret;
+}
+
 static char *
 get_query_str(char *lw)
 {
@@ -1782,6 +2218,28 @@ move_cursor_up(const int total_line_len)
 static void
 set_finder_paths(void)
 {
+#ifdef FINDER_MEMFD
+	/* Back both files with anonymous, memory-only file descriptors
+	 * whenever possible: nothing is written to disk (TMP_DIR may live
+	 * on a network filesystem), and no random names are needed. The
+	 * descriptors are created once and reused (truncated by the O_TRUNC
+	 * opens) on every TAB press. They are deliberately not close-on-exec:
+	 * the finder application inherits them, so that the /proc/self/fd
+	 * paths in its redirections resolve to the same memory files. */
+	if (finder_memfd_in == -1)
+		finder_memfd_in = memfd_create("clifm.finder.in", 0);
+	if (finder_memfd_in != -1 && finder_memfd_out == -1)
+		finder_memfd_out = memfd_create("clifm.finder.out", 0);
+
+	if (finder_memfd_in != -1 && finder_memfd_out != -1) {
+		snprintf(finder_in_file, sizeof(finder_in_file),
+			"/proc/self/fd/%d", finder_memfd_in);
+		snprintf(finder_out_file, sizeof(finder_out_file),
+			"/proc/self/fd/%d", finder_memfd_out);
+		return;
+	}
+#endif /* FINDER_MEMFD */
+
 	const int sm = (xargs.stealth_mode == 1);
 	const char *p = sm ? P_tmpdir : tmp_dir;
 
@@ -1816,10 +2274,15 @@ set_finder_paths(void)
 static int
 finder_tabcomp(char **matches, const char *text, char *original_query)
 {
+	/* The previewer (the 'view' command) requires fzf. */
+	ifinder_active = (tabmode == INT_TAB && !(flags & PREVIEWER)) ? 1 : 0;
+
 	/* Set random file names for both FINDER_IN_FILE and FINDER_OUT_FILE. */
-	set_finder_paths();
+	if (ifinder_active == 0)
+		set_finder_paths();
 
-	/* Store possible completions in FINDER_IN_FILE to pass them to the finder. */
+	/* Store possible completions (in FINDER_IN_FILE, to pass them to the
+	 * external finder, or in memory if using the internal finder). */
 	size_t num_matches = store_completions(matches);
 	if (num_matches == (size_t)-1)
 		return FUNC_FAILURE;
@@ -1836,7 +2299,7 @@ finder_tabcomp(char **matches, const char *text, char *original_query)
 	 * specifies how many entries will be displayed at once. */
 	size_t height = 0;
 
-	if (fzf_height_set == 0 || tabmode == FNF_TAB) {
+	if (fzf_height_set == 0 || tabmode == FNF_TAB || ifinder_active == 1) {
 		size_t max_height = set_fzf_max_win_height();
 		height = (num_matches + 1 > max_height) ? max_height : num_matches;
 	}
@@ -1858,25 +2321,42 @@ finder_tabcomp(char **matches, const char *text, char *original_query)
 
 	char *deq = q ? (strchr(q, '\\') ? unescape_str(q, 0) : q) : (char *)NULL;
 
-	/* Run the finder application and store the ouput into FINDER_OUT_FILE. */
-	int ret = run_finder(height, finder_offset, deq, multi);
+	/* Run the finder: either in-process, or the external application,
+	 * storing its output into FINDER_OUT_FILE. */
+	int ret;
+	char *ibuf = (char *)NULL;
+	if (ifinder_active == 1)
+		ret = run_internal_finder(height, finder_offset, deq, multi,
+			matches[0], &ibuf);
+	else
+		ret = run_finder(height, finder_offset, deq, multi);
 
 	if (deq && deq != q)
 		free(deq);
 
-	unlink(finder_in_file);
+	if (ifinder_active == 0)
+		finder_file_cleanup(finder_in_file);
 
 	if (!(flags & PREVIEWER))
 		move_cursor_up(total_line_len);
 
 	/* No results (the user pressed ESC or the Left arrow key). */
 	if (ret != FUNC_SUCCESS) {
-		unlink(finder_out_file);
+		if (ifinder_active == 0)
+			finder_file_cleanup(finder_out_file);
+		else
+			ifinder_free();
+		ifinder_active = 0;
 		return clean_rl_buffer(text);
 	}
 
-	/* Retrieve finder's output from FINDER_OUT_FILE. */
-	char *buf = get_finder_output(multi, matches[0]);
+	/* Retrieve the finder's output (from FINDER_OUT_FILE if external). */
+	char *buf = ifinder_active == 1
+		? ibuf : get_finder_output(multi, matches[0]);
+	if (ifinder_active == 1) {
+		ifinder_free();
+		ifinder_active = 0;
+	}
 	if (!buf)
 		return FUNC_FAILURE;
 
@@ -1920,6 +2400,78 @@ gen_quoted_str(const char *str)
 	return quote_str(str);
 }
 
+/* Cache of the last computed completion: the input line it was computed
+ * for, the end of the word being completed, and the matches list. Hitting
+ * TAB again (to cycle or re-display) with the same line reuses the list
+ * instead of re-globbing and re-statting. The cache lives only while the
+ * current input line is being edited: flush_tab_comp_cache() is called on
+ * every new prompt and whenever the files list changes. */
+static char *tab_cache_line = (char *)NULL;
+static int tab_cache_end = -1;
+static char **tab_cache_matches = (char **)NULL;
+static enum comp_type tab_cache_comp_type;
+
+static void
+free_str_array(char **arr)
+{
+	if (!arr)
+		return;
+
+	size_t i;
+	for (i = 0; arr[i]; i++)
+		free(arr[i]);
+	free(arr);
+}
+
+static char **
+dup_str_array(char **arr)
+{
+	size_t n = 0;
+	while (arr[n])
+		n++;
+
+	char **new = xnmalloc(n + 1, sizeof(char *));
+
+	size_t i;
+	for (i = 0; i < n; i++)
+		new[i] = savestring(arr[i], strlen(arr[i]));
+	new[n] = (char *)NULL;
+
+	return new;
+}
+
+void
+flush_tab_comp_cache(void)
+{
+	free(tab_cache_line);
+	tab_cache_line = (char *)NULL;
+	tab_cache_end = -1;
+	free_str_array(tab_cache_matches);
+	tab_cache_matches = (char **)NULL;
+}
+
+static int
+tab_cache_hit(const int end)
+{
+	return (tab_cache_matches != NULL && tab_cache_end == end
+		&& tab_cache_line && rl_line_buffer
+		&& strcmp(tab_cache_line, rl_line_buffer) == 0);
+}
+
+static void
+tab_cache_store(char **matches, const int end)
+{
+	flush_tab_comp_cache();
+
+	if (!matches || !matches[0] || !rl_line_buffer)
+		return;
+
+	tab_cache_line = savestring(rl_line_buffer, strlen(rl_line_buffer));
+	tab_cache_end = end;
+	tab_cache_matches = dup_str_array(matches);
+	tab_cache_comp_type = cur_comp_type;
+}
+
 /* Complete the word at or before point.
    WHAT_TO_DO says what to do with the completion.
    `?' means list the possible completions.
@@ -1927,8 +2479,8 @@ gen_quoted_str(const char *str)
    `*' means insert all of the possible completions.
    `!' means to do standard completion, and list all possible completions
    if there is more than one. */
-int
-tab_complete(const int what_to_do)
+static int
+tab_complete_int(const int what_to_do)
 {
 	if (rl_notab == 1)
 		return FUNC_SUCCESS;
@@ -2030,6 +2582,15 @@ tab_complete(const int what_to_do)
 
 	/* At this point, we know we have an open quote if quote_char != '\0'. */
 
+	/* Reuse the matches computed by the last TAB press if the input
+	 * line is unchanged (cycling or re-displaying the list). */
+	if (tab_cache_hit(end) == 1) {
+		matches = dup_str_array(tab_cache_matches);
+		cur_comp_type = tab_cache_comp_type;
+		our_func = (rl_compentry_func_t *)NULL;
+		goto AFTER_USUAL_COMPLETION;
+	}
+
 	/* If the user wants to TRY to complete, but then wants to give
 	* up and use the default completion function, they set the
 	* variable rl_attempted_completion_function. */
@@ -2038,6 +2599,7 @@ tab_complete(const int what_to_do)
 		if (matches || rl_attempted_completion_over) {
 			rl_attempted_completion_over = 0;
 			our_func = (rl_compentry_func_t *)NULL;
+			tab_cache_store(matches, end);
 			goto AFTER_USUAL_COMPLETION;
 		}
 	}
@@ -2711,3 +3273,15 @@ RESTART:
 
 	return FUNC_SUCCESS;
 }
+
+/* Wrapper around tab_complete_int(): account the time taken to compute
+ * completions whenever 'perf' instrumentation is enabled. */
+int
+tab_complete(const int what_to_do)
+{
+	perf_begin(PERF_TABCOMP);
+	const int ret = tab_complete_int(what_to_do);
+	perf_end(PERF_TABCOMP);
+
+	return ret;
+}
@@ -27,7 +27,9 @@
 
 __BEGIN_DECLS
 
+int  get_cursor_position(int *c, int *l);
 int  tab_complete(const int what_to_do);
+void flush_tab_comp_cache(void);
 void reinsert_slashes(char *str);
 
 __END_DECLS
@@ -81,6 +81,178 @@ print_usage(const int retval)
 	return retval;
 }
 
+/* In-memory index of tagged files: for each tag, the list of symlink
+ * names in the tag directory plus the device ID and inode number of each
+ * link target. Built lazily, one tag at a time, the first time a tag
+ * command needs to inspect tagged files, so that subsequent queries
+ * (e.g. 'tag list FILE1 FILE2') do not re-scan and re-stat the whole
+ * tags directory tree. The tags directory on disk remains the only
+ * authoritative database: the index is discarded whenever the tags list
+ * is reloaded. */
+struct tag_files_t {
+	char **names; /* Symlink names in the tag directory */
+	dev_t *devs;  /* Device IDs of the link targets (0 if broken) */
+	ino_t *inos;  /* Inode numbers of the link targets (0 if broken) */
+	size_t n;
+	int loaded;
+	int pad0;
+};
+
+static struct tag_files_t *tags_idx = (struct tag_files_t *)NULL;
+static size_t tags_idx_n = 0;
+
+/* Discard the entire tags index. It will be rebuilt on demand. */
+void
+tags_index_invalidate(void)
+{
+	size_t i, j;
+	for (i = 0; i < tags_idx_n; i++) {
+		for (j = 0; j < tags_idx[i].n; j++)
+			free(tags_idx[i].names[j]);
+		free(tags_idx[i].names);
+		free(tags_idx[i].devs);
+		free(tags_idx[i].inos);
+	}
+
+	free(tags_idx);
+	tags_idx = (struct tag_files_t *)NULL;
+	tags_idx_n = 0;
+}
+
+/* Return the index entry for the tag number I (in the tags array),
+ * loading it from the tags directory if not loaded yet.
+ * Returns NULL in case of error. */
+static struct tag_files_t *
+get_tag_index(const size_t i)
+{
+	if (!tags_dir || !tags || tags_n == 0)
+		return (struct tag_files_t *)NULL;
+
+	if (!tags_idx) {
+		tags_idx = xcalloc(tags_n, sizeof(struct tag_files_t));
+		tags_idx_n = tags_n;
+	}
+
+	if (i >= tags_idx_n)
+		return (struct tag_files_t *)NULL;
+
+	struct tag_files_t *idx = &tags_idx[i];
+	if (idx->loaded == 1)
+		return idx;
+
+	char dir[PATH_MAX + 1];
+	snprintf(dir, sizeof(dir), "%s/%s", tags_dir, tags[i]);
+
+	struct dirent **t = (struct dirent **)NULL;
+	const int n = scandir(dir, &t, NULL, alphasort);
+	if (n == -1)
+		return (struct tag_files_t *)NULL;
+
+	idx->names = xnmalloc((size_t)n + 1, sizeof(char *));
+	idx->devs = xnmalloc((size_t)n + 1, sizeof(dev_t));
+	idx->inos = xnmalloc((size_t)n + 1, sizeof(ino_t));
+	idx->n = 0;
+
+	int j;
+	for (j = 0; j < n; j++) {
+		if (SELFORPARENT(t[j]->d_name)) {
+			free(t[j]);
+			continue;
+		}
+
+		char full_name[PATH_MAX + NAME_MAX + 2];
+		snprintf(full_name, sizeof(full_name), "%s/%s", dir, t[j]->d_name);
+
+		struct stat a;
+		if (stat(full_name, &a) == -1) /* Broken symlink */
+			a.st_dev = a.st_ino = 0;
+
+		idx->names[idx->n] = savestring(t[j]->d_name, strlen(t[j]->d_name));
+		idx->devs[idx->n] = a.st_dev;
+		idx->inos[idx->n] = a.st_ino;
+		idx->n++;
+		free(t[j]);
+	}
+	free(t);
+
+	idx->names[idx->n] = (char *)NULL;
+	idx->loaded = 1;
+
+	return idx;
+}
+
+/* Record the newly created symlink LINK (a full path in the directory of
+ * the tag TAG) in the index, provided the corresponding entry is already
+ * loaded (otherwise the symlink will be picked up when the entry is). */
+static void
+tag_index_add(const char *tag, const char *link)
+{
+	if (!tags_idx || !tags)
+		return;
+
+	size_t i;
+	for (i = 0; i < tags_idx_n && tags[i]; i++) {
+		if (*tag == *tags[i] && strcmp(tag, tags[i]) == 0)
+			break;
+	}
+
+	if (i >= tags_idx_n || !tags[i] || tags_idx[i].loaded == 0)
+		return;
+
+	struct tag_files_t *idx = &tags_idx[i];
+	const char *name = strrchr(link, '/');
+	name = (name && name[1]) ? name + 1 : link;
+
+	struct stat a;
+	if (stat(link, &a) == -1)
+		a.st_dev = a.st_ino = 0;
+
+	idx->names = xnrealloc(idx->names, idx->n + 2, sizeof(char *));
+	idx->devs = xnrealloc(idx->devs, idx->n + 2, sizeof(dev_t));
+	idx->inos = xnrealloc(idx->inos, idx->n + 2, sizeof(ino_t));
+
+	idx->names[idx->n] = savestring(name, strlen(name));
+	idx->devs[idx->n] = a.st_dev;
+	idx->inos[idx->n] = a.st_ino;
+	idx->n++;
+	idx->names[idx->n] = (char *)NULL;
+}
+
+/* Remove the symlink named NAME from the index entry for the tag TAG,
+ * provided this entry is loaded. */
+static void
+tag_index_del(const char *tag, const char *name)
+{
+	if (!tags_idx || !tags)
+		return;
+
+	size_t i;
+	for (i = 0; i < tags_idx_n && tags[i]; i++) {
+		if (*tag == *tags[i] && strcmp(tag, tags[i]) == 0)
+			break;
+	}
+
+	if (i >= tags_idx_n || !tags[i] || tags_idx[i].loaded == 0)
+		return;
+
+	struct tag_files_t *idx = &tags_idx[i];
+	size_t j;
+	for (j = 0; j < idx->n; j++) {
+		if (*name != *idx->names[j] || strcmp(name, idx->names[j]) != 0)
+			continue;
+
+		free(idx->names[j]);
+		memmove(idx->names + j, idx->names + j + 1,
+			(idx->n - j) * sizeof(char *)); /* Moves the NULL terminator */
+		memmove(idx->devs + j, idx->devs + j + 1,
+			(idx->n - j - 1) * sizeof(dev_t));
+		memmove(idx->inos + j, idx->inos + j + 1,
+			(idx->n - j - 1) * sizeof(ino_t));
+		idx->n--;
+		break;
+	}
+}
+
 #ifndef _DIRENT_HAVE_D_TPYE
 /* Check whether NAME is actually tagged as TAG.
  * Returns 1 if true or 0 otherwise. */
@@ -211,31 +383,18 @@ list_tags_having_file(const dev_t dev, const ino_t ino)
 	if (!tags_dir || !tags)
 		return;
 
-	size_t i;
-	for (i = 0; tags[i]; i++) {
-		char tmp[PATH_MAX + 1];
-		snprintf(tmp, sizeof(tmp), "%s/%s", tags_dir, tags[i]);
-
-		DIR *dir = opendir(tmp);
-		if (dir == NULL)
+	size_t i, j;
+	for (i = 0; i < tags_n && tags[i]; i++) {
+		const struct tag_files_t *idx = get_tag_index(i);
+		if (!idx)
 			continue;
 
-		struct dirent *ent;
-		while ((ent = readdir(dir))) {
-			char full_name[PATH_MAX + NAME_MAX + 2];
-			snprintf(full_name, sizeof(full_name), "%s/%s", tmp, ent->d_name);
-
-			struct stat a;
-			if (stat(full_name, &a) == -1)
-				continue;
-
-			if (a.st_dev == dev && a.st_ino == ino) {
+		for (j = 0; j < idx->n; j++) {
+			if (idx->inos[j] == ino && idx->devs[j] == dev) {
 				printf(" %s%s%s\n", mi_c, tags[i], NC);
 				break;
 			}
 		}
-
-		closedir(dir);
 	}
 }
 
@@ -303,12 +462,10 @@ list_tags(char **args)
 		const int pad = (int)get_longest_tag();
 
 		for (i = 0; tags[i]; i++) {
-			char p[PATH_MAX + 1];
-			snprintf(p, sizeof(p), "%s/%s", tags_dir, tags[i]);
-			const filesn_t n = count_dir(p, NO_CPOP);
-			if (n > 2)
-				printf("%-*s [%s%jd%s]\n", pad, tags[i], mi_c,
-					(intmax_t)n - 2, df_c);
+			const struct tag_files_t *idx = get_tag_index(i);
+			if (idx && idx->n > 0)
+				printf("%-*s [%s%zu%s]\n", pad, tags[i], mi_c,
+					idx->n, df_c);
 			else
 				printf("%-*s  -\n", pad, tags[i]);
 		}
@@ -353,7 +510,7 @@ list_tags(char **args)
 static void
 reload_tags(void)
 {
-	free_tags();
+	free_tags(); /* Also invalidates the tags index */
 	load_tags();
 }
 
@@ -492,6 +649,8 @@ tag_file(char *name, char *tag)
 	if (symlink(*name_path ? name_path : name, link) == -1)
 		return print_symlink_error(name);
 
+	tag_index_add(strrchr(dir, '/') + 1, link);
+
 	return FUNC_SUCCESS;
 }
 
@@ -607,6 +766,7 @@ untag(char **args, const size_t n, size_t *t)
 				exit_status = errno;
 				xerror("tag: '%s': %s\n", args[i], strerror(errno));
 			} else {
+				tag_index_del(strrchr(dir, '/') + 1, strrchr(f, '/') + 1);
 				(*t)++;
 			}
 		} else {
@@ -27,8 +27,9 @@
 
 __BEGIN_DECLS
 
-int is_tag(char *name);
-int tags_function(char **args);
+int  is_tag(char *name);
+int  tags_function(char **args);
+void tags_index_invalidate(void);
 
 __END_DECLS
 
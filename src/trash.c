@@ -27,6 +27,7 @@
 #include "helpers.h"
 
 #include <errno.h>
+#include <pthread.h> /* parallel cross-device phase (see trash_files_bulk()) */
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h> /* access, unlinkat */
@@ -920,17 +921,48 @@ untrash_function(char **args)
 	return exit_status;
 }
 
+/* Cached total size of the trash directory, keyed by its mtime: trashing,
+ * untrashing, and deleting all rename or unlink entries at the top level
+ * of the files dir, so any change to the trash can touches its mtime.
+ * This makes repeated 't list' invocations a single stat(2) instead of a
+ * full recursive disk usage scan. */
+static off_t trashdir_size_cache = -1;
+static time_t trashdir_size_mtime = 0;
+static int trashdir_size_status = 0;
+
 static void
 print_trashdir_size(void)
 {
 	const int base = xargs.si == 1 ? 1000 : 1024;
 	int status = 0;
 
+	struct stat a;
+	const int stat_ok = stat(trash_files_dir, &a) != -1;
+	const int cached = (stat_ok && trashdir_size_cache >= 0
+		&& a.st_mtime == trashdir_size_mtime);
+
 	printf(_("\n%sTotal size: "), df_c);
-	if (term_caps.suggestions == 1)
-		{fputs("Calculating...", stdout); fflush(stdout);}
 
-	const off_t full_size = dir_size(trash_files_dir, 0, &status) * base;
+	off_t full_size;
+	if (cached == 1) {
+		full_size = trashdir_size_cache;
+		status = trashdir_size_status;
+	} else {
+		if (term_caps.suggestions == 1)
+			{fputs("Calculating...", stdout); fflush(stdout);}
+
+		full_size = dir_size(trash_files_dir, 0, &status) * base;
+
+		if (term_caps.suggestions == 1)
+			{MOVE_CURSOR_LEFT(14); ERASE_TO_RIGHT; fflush(stdout);}
+
+		if (stat_ok) {
+			trashdir_size_cache = full_size;
+			trashdir_size_mtime = a.st_mtime;
+			trashdir_size_status = status;
+		}
+	}
+
 	char *human_size = construct_human_size(full_size);
 
 	char err[sizeof(xf_cb) + 6]; *err = '\0';
@@ -941,9 +973,6 @@ print_trashdir_size(void)
 	if (conf.colorize == 1)
 		get_color_size(full_size, s, sizeof(s));
 
-	if (term_caps.suggestions == 1)
-		{MOVE_CURSOR_LEFT(14); ERASE_TO_RIGHT; fflush(stdout);}
-
 	printf(_("%s%s%s%s\n"), err, s, human_size, df_c);
 }
 
@@ -1078,6 +1107,476 @@ list_ok_trashed_files(char **args, const int *trashed, const size_t trashed_n)
 	}
 }
 
+/* Batched trash engine
+ *
+ * Big batches used to go through trash_file() above one file at a time:
+ * one open/write/close cycle per .trashinfo file with freshly built
+ * paths each time, and one mv(1) process per cross-device file. The
+ * engine below collects and validates the whole batch first, writes
+ * every .trashinfo record through a single descriptor on the info
+ * directory (reusing one record buffer), renames same-device files in
+ * one renameat(2) pass, and hands cross-device regular files and
+ * symlinks to a pool of copy+unlink worker threads. Cross-device
+ * directories (and any other file type) still go through mv(1). */
+
+#define TRASH_BULK_MIN_FILES 64
+#define TRASH_MAX_THREADS    16
+#define TRASH_COPY_BUF_SIZE  (1024 * 1024)
+#define TRASH_PROGRESS_NSEC  100000000 /* Progress report interval (100ms) */
+
+struct tre_ent_t {
+	char *path;        /* Absolute path to the file to trash */
+	char *dest;        /* Destination inside the trash files dir */
+	char *suffix_name; /* Basename of DEST (info file: SUFFIX_NAME.trashinfo) */
+	int argi;          /* Index into args[] (see list_ok_trashed_files()) */
+	int status;        /* -1: pending; 0: trashed; >0: error code */
+	mode_t mode;       /* From lstat(2): picks the cross-device strategy */
+	int pad;
+};
+
+struct tre_worker_t {
+	struct tre_ent_t **xdev; /* Cross-device entries only */
+	size_t n;
+	size_t id;
+	size_t nthreads;
+	volatile size_t done;
+	volatile int finished;
+	int pad;
+};
+
+static int
+tre_get_threads(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+	const long p = sysconf(_SC_NPROCESSORS_ONLN);
+	if (p <= 1)
+		return 1;
+	return p > TRASH_MAX_THREADS ? TRASH_MAX_THREADS : (int)p;
+#else
+	return 1;
+#endif /* _SC_NPROCESSORS_ONLN */
+}
+
+/* Write the .trashinfo record for the entry E through INFO_DIRFD,
+ * creating it with O_EXCL. Since nothing has been moved yet, batch
+ * internal name clashes are not visible to gen_dest_file()'s lstat(2)
+ * check: the info file, whose creation fails with EEXIST on a clash, is
+ * what actually reserves the trashed file name, in which case E's name
+ * and destination are regenerated until unique. *BUF (*BUF_CAP bytes)
+ * is the caller's reusable record buffer. */
+static int
+tre_write_info_file(const int info_dirfd, struct tre_ent_t *e,
+	const struct tm *tm, char **buf, size_t *buf_cap)
+{
+	char *url_str = url_encode(e->path);
+	if (!url_str) {
+		xerror(_("trash: '%s': Error encoding path\n"), e->path);
+		return FUNC_FAILURE;
+	}
+
+	const size_t rec_len = strlen(url_str) + 128;
+	if (rec_len > *buf_cap) {
+		*buf_cap = rec_len;
+		*buf = xnrealloc(*buf, *buf_cap, sizeof(char));
+	}
+
+	const int len = snprintf(*buf, *buf_cap,
+		"[Trash Info]\nPath=%s\nDeletionDate=%d-%02d-%02dT%02d:%02d:%02d\n",
+		url_str, tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday,
+		tm->tm_hour, tm->tm_min, tm->tm_sec);
+	free(url_str);
+
+	const size_t sn_cap = strlen(e->suffix_name) + 32;
+	char *orig_name = savestring(e->suffix_name, strlen(e->suffix_name));
+	e->suffix_name = xnrealloc(e->suffix_name, sn_cap, sizeof(char));
+	char iname[NAME_MAX + 1];
+
+	int fd = -1, inc = 1;
+	while (1) {
+		snprintf(iname, sizeof(iname), "%s.trashinfo", e->suffix_name);
+		fd = openat(info_dirfd, iname, O_WRONLY | O_CREAT | O_EXCL,
+			S_IRUSR | S_IWUSR);
+		if (fd != -1 || errno != EEXIST)
+			break;
+		snprintf(e->suffix_name, sn_cap, "%s-%d", orig_name, inc);
+		inc++;
+	}
+
+	if (inc > 1) { /* The name changed: rebuild the destination path */
+		free(e->dest);
+		const size_t dlen = strlen(trash_files_dir)
+			+ strlen(e->suffix_name) + 2;
+		e->dest = xnmalloc(dlen, sizeof(char));
+		snprintf(e->dest, dlen, "%s/%s", trash_files_dir, e->suffix_name);
+	}
+
+	free(orig_name);
+
+	if (fd == -1) {
+		xerror("trash: '%s': %s\n", iname, strerror(errno));
+		return FUNC_FAILURE;
+	}
+
+	const int ret = (len > 0
+		&& write(fd, *buf, (size_t)len) == (ssize_t)len)
+		? FUNC_SUCCESS : FUNC_FAILURE;
+	close(fd);
+
+	return ret;
+}
+
+/* Collect, validate, and reserve (info file included) the files in
+ * ARGS, storing up to NARGS entries into ENTS. Returns the number of
+ * collected entries. CWD and EXIT_STATUS are updated as in the serial
+ * loop of trash_files_args(). */
+static size_t
+tre_collect(char **args, struct tre_ent_t *ents, const int info_dirfd,
+	const char *suffix, const struct tm *tm, int *cwd, int *exit_status)
+{
+	char *buf = (char *)NULL;
+	size_t buf_cap = 0;
+	size_t n = 0;
+	size_t i;
+
+	for (i = 1; args[i]; i++) {
+		if (trash_n + n >= MAX_TRASH) {
+			xerror("%s\n", _("trash: Cannot trash any more files"));
+			*exit_status = FUNC_FAILURE;
+			break;
+		}
+
+		char *deq_file = unescape_str(args[i], 0);
+		if (!deq_file) {
+			xerror(_("trash: '%s': Error unescaping file name\n"), args[i]);
+			continue;
+		}
+
+		struct stat a;
+		if (check_trash_file(deq_file) != FUNC_SUCCESS
+		|| lstat(deq_file, &a) == -1) {
+			*exit_status = FUNC_FAILURE;
+			free(deq_file);
+			continue;
+		}
+
+		if (*cwd == 0)
+			*cwd = is_file_in_cwd(deq_file);
+
+		char full_path[PATH_MAX + 1];
+		char *abs_path = deq_file;
+		if (*deq_file != '/') { /* If relative path, make it absolute. */
+			if (!workspaces[cur_ws].path) {
+				*exit_status = FUNC_FAILURE;
+				free(deq_file);
+				continue;
+			}
+			if (*workspaces[cur_ws].path == '/'
+			&& !workspaces[cur_ws].path[1]) /* We're in the root dir */
+				snprintf(full_path, sizeof(full_path), "/%s", deq_file);
+			else
+				snprintf(full_path, sizeof(full_path), "%s/%s",
+					workspaces[cur_ws].path, deq_file);
+			abs_path = full_path;
+		}
+
+		char *file_suffix = (char *)NULL;
+		char *dest = gen_dest_file(abs_path, suffix, &file_suffix);
+		if (!dest || !file_suffix) {
+			free(dest);
+			free(file_suffix);
+			free(deq_file);
+			*exit_status = FUNC_FAILURE;
+			continue;
+		}
+
+		struct tre_ent_t *e = &ents[n];
+		*e = (struct tre_ent_t){0};
+		e->path = savestring(abs_path, strlen(abs_path));
+		e->dest = dest;
+		e->suffix_name = file_suffix;
+		e->argi = (int)i;
+		e->status = -1;
+		e->mode = a.st_mode;
+		free(deq_file);
+
+		/* As per the FreeDesktop specification, the info file comes first. */
+		if (tre_write_info_file(info_dirfd, e, tm, &buf,
+		&buf_cap) != FUNC_SUCCESS) {
+			free(e->path);
+			free(e->dest);
+			free(e->suffix_name);
+			*exit_status = FUNC_FAILURE;
+			continue;
+		}
+
+		n++;
+	}
+
+	free(buf);
+	return n;
+}
+
+/* Copy the regular file SRC to DST, preserving mode, timestamps, and
+ * (best-effort) ownership, then unlink SRC. BUF is the caller's
+ * TRASH_COPY_BUF_SIZE-byte copy buffer. Returns zero on success or an
+ * error code otherwise. */
+static int
+tre_copy_reg(const char *src, const char *dst, char *buf)
+{
+	struct stat a;
+	const int sfd = open(src, O_RDONLY);
+	if (sfd == -1)
+		return errno;
+
+	if (fstat(sfd, &a) == -1) {
+		const int ret = errno;
+		close(sfd);
+		return ret;
+	}
+
+	const int dfd = open(dst, O_WRONLY | O_CREAT | O_EXCL, a.st_mode & 0777);
+	if (dfd == -1) {
+		const int ret = errno;
+		close(sfd);
+		return ret;
+	}
+
+	int ret = 0;
+	off_t left = a.st_size;
+
+	while (left > 0) {
+		const ssize_t r = read(sfd, buf, TRASH_COPY_BUF_SIZE);
+		if (r <= 0) {
+			ret = errno != 0 ? errno : EIO;
+			break;
+		}
+
+		ssize_t off = 0;
+		while (off < r) {
+			const ssize_t w = write(dfd, buf + off, (size_t)(r - off));
+			if (w <= 0) {
+				ret = errno != 0 ? errno : EIO;
+				break;
+			}
+			off += w;
+		}
+
+		if (off < r)
+			break;
+		left -= (off_t)r;
+	}
+
+	if (ret == 0) {
+		fchmod(dfd, a.st_mode & 07777);
+		if (fchown(dfd, a.st_uid, a.st_gid) == -1) {
+			/* Ownership is best-effort, just as with mv(1) */
+		}
+		const struct timespec ts[2] =
+			{ {a.st_atime, 0}, {a.st_mtime, 0} };
+		futimens(dfd, ts);
+	}
+
+	close(sfd);
+	close(dfd);
+
+	if (ret == 0 && unlink(src) == -1)
+		ret = errno;
+
+	return ret;
+}
+
+/* Recreate the symlink SRC at DST and unlink SRC. Returns zero on
+ * success or an error code otherwise. */
+static int
+tre_copy_lnk(const char *src, const char *dst)
+{
+	char target[PATH_MAX + 1];
+	const ssize_t len = readlink(src, target, sizeof(target) - 1);
+	if (len == -1)
+		return errno;
+
+	target[len] = '\0';
+	if (symlink(target, dst) == -1)
+		return errno;
+
+	return unlink(src) == -1 ? errno : 0;
+}
+
+/* Copy+unlink the cross-device entries at indices ID, ID + NTHREADS, ...
+ * Errors are only recorded here (no stdio from threads): they are
+ * reported once the pool is joined. */
+static void *
+tre_worker(void *arg)
+{
+	struct tre_worker_t *w = (struct tre_worker_t *)arg;
+	char *buf = xnmalloc(TRASH_COPY_BUF_SIZE, sizeof(char));
+
+	for (size_t i = w->id; i < w->n; i += w->nthreads) {
+		struct tre_ent_t *e = w->xdev[i];
+		e->status = S_ISLNK(e->mode)
+			? tre_copy_lnk(e->path, e->dest)
+			: tre_copy_reg(e->path, e->dest, buf);
+		w->done++;
+	}
+
+	free(buf);
+	w->finished = 1;
+	return NULL;
+}
+
+/* Move the cross-device entries in XDEV (N pointers into the batch)
+ * into the trash directory via a pool of worker threads, reporting
+ * progress while they run. */
+static void
+tre_apply_xdev_parallel(struct tre_ent_t **xdev, const size_t n)
+{
+	const int nthreads = tre_get_threads();
+	pthread_t threads[TRASH_MAX_THREADS];
+	struct tre_worker_t workers[TRASH_MAX_THREADS];
+	int started = 0;
+
+	for (int t = 0; t < nthreads; t++) {
+		workers[t] = (struct tre_worker_t){ .xdev = xdev, .n = n,
+			.id = (size_t)t, .nthreads = (size_t)nthreads };
+		if (pthread_create(&threads[t], NULL, tre_worker,
+		&workers[t]) != 0)
+			break;
+		started++;
+	}
+
+	while (started > 0) {
+		int running = 0;
+		size_t done = 0;
+
+		for (int t = 0; t < started; t++) {
+			running += (workers[t].finished == 0);
+			done += workers[t].done;
+		}
+
+		printf(_("\rtrash: Copying files... %zu/%zu"), done, n);
+		fflush(stdout);
+
+		if (running == 0)
+			break;
+
+		struct timespec ts = {0, TRASH_PROGRESS_NSEC};
+		nanosleep(&ts, NULL);
+	}
+
+	for (int t = 0; t < started; t++)
+		pthread_join(threads[t], NULL);
+
+	if (started > 0) {
+		putchar('\r');
+		ERASE_TO_RIGHT;
+		fflush(stdout);
+	} else { /* No worker at all: copy serially */
+		workers[0] = (struct tre_worker_t){ .xdev = xdev, .n = n,
+			.id = 0, .nthreads = 1 };
+		tre_worker(&workers[0]);
+	}
+}
+
+/* Trash the files in ARGS (NARGS names) as a batch. If the info
+ * directory cannot be opened, *ENGAGED is set to zero and nothing is
+ * done: the caller should run the serial loop instead. */
+static int
+trash_files_bulk(char **args, const size_t nargs, const char *suffix,
+	const struct tm *tm, int *engaged)
+{
+	*engaged = 0;
+
+	const int info_dirfd = open(trash_info_dir, O_RDONLY | O_DIRECTORY);
+	if (info_dirfd == -1)
+		return FUNC_FAILURE;
+
+	*engaged = 1;
+
+	struct tre_ent_t *ents = xnmalloc(nargs, sizeof(struct tre_ent_t));
+	int cwd = 0, exit_status = FUNC_SUCCESS;
+	size_t i;
+
+	const size_t n =
+		tre_collect(args, ents, info_dirfd, suffix, tm, &cwd, &exit_status);
+	close(info_dirfd);
+
+	/* Same-device files: a single renameat(2) pass */
+	struct tre_ent_t **xdev = xnmalloc(n + 1, sizeof(struct tre_ent_t *));
+	size_t xdev_n = 0;
+
+	for (i = 0; i < n; i++) {
+		struct tre_ent_t *e = &ents[i];
+		if (renameat(XAT_FDCWD, e->path, XAT_FDCWD, e->dest) == 0) {
+			e->status = 0;
+		} else if (errno == EXDEV && (S_ISREG(e->mode)
+		|| S_ISLNK(e->mode))) {
+			xdev[xdev_n] = e; /* Workers take these */
+			xdev_n++;
+		} else if (errno == EXDEV) {
+			/* Directories and special files: mv(1) handles them */
+			char *cmd[] = {"mv", "--", e->path, e->dest, NULL};
+			e->status = launch_execv(cmd, FOREGROUND, E_NOFLAG);
+		} else {
+			e->status = errno;
+		}
+	}
+
+	if (xdev_n > 0)
+		tre_apply_xdev_parallel(xdev, xdev_n);
+
+	free(xdev);
+
+	size_t trashed_files = 0, ok_n = 0;
+	int *successfully_trashed = xnmalloc(n + 1, sizeof(int));
+
+	for (i = 0; i < n; i++) {
+		struct tre_ent_t *e = &ents[i];
+
+		if (e->status == 0) {
+			trashed_files++;
+			if (print_removed_files == 1) {
+				successfully_trashed[ok_n] = e->argi;
+				ok_n++;
+			}
+		} else {
+			if (e->status > 0 && e->status != FUNC_FAILURE)
+				xerror(_("trash: Cannot trash '%s': %s\n"), e->path,
+					strerror(e->status));
+			remove_trashinfo_file(e->suffix_name);
+			exit_status = FUNC_FAILURE;
+		}
+
+		free(e->path);
+		free(e->dest);
+		free(e->suffix_name);
+	}
+
+	free(ents);
+
+	if (exit_status == FUNC_SUCCESS) {
+		if (conf.autols == 1 && cwd == 1)
+			reload_dirlist();
+	} else if (trashed_files > 0) {
+		/* As in trash_files_args(): pause so that inotify/kqueue does not
+		 * hide the error message behind a screen refresh. */
+		if (conf.autols == 1) {
+			press_any_key_to_continue(0);
+			reload_dirlist();
+		}
+	} else { /* Error and no trashed file. */
+		free(successfully_trashed);
+		return exit_status;
+	}
+
+	list_ok_trashed_files(args, successfully_trashed, ok_n);
+	print_reload_msg(_("%zu file(s) trashed\n"), trashed_files);
+	print_reload_msg(_("%zu total trashed file(s)\n"),
+		trash_n + trashed_files);
+
+	free(successfully_trashed);
+	return exit_status;
+}
+
 /* Trash files passed as arguments to the trash command */
 static int
 trash_files_args(char **args)
@@ -1091,6 +1590,16 @@ trash_files_args(char **args)
 	int exit_status = FUNC_SUCCESS, cwd = 0;
 	size_t i, trashed_files = 0, n = 0;
 	for (i = 1; args[i]; i++);
+
+	if (i - 1 >= TRASH_BULK_MIN_FILES) {
+		int engaged = 0;
+		const int ret = trash_files_bulk(args, i - 1, suffix, &t, &engaged);
+		if (engaged == 1) {
+			free(suffix);
+			return ret;
+		}
+	}
+
 	int *successfully_trashed = xnmalloc(i + 1, sizeof(int));
 
 	for (i = 1; args[i]; i++) {
@@ -32,7 +32,7 @@
 #include "aux.h"        /* xatoi */
 #include "checks.h"     /* is_number */
 #include "colors.h"     /* get_dir_color */
-#include "listing.h"    /* reload_dirlist */
+#include "listing.h"    /* switch_dirlist */
 #include "messages.h"   /* WS_USAGE */
 #include "misc.h"       /* xerror */
 #include "navigation.h" /* xchdir */
@@ -174,6 +174,7 @@ unset_ws_filter(void)
 	filter.rev = 0;
 	filter.type = FILTER_NONE;
 	regfree(&regex_exp);
+	set_filter_literal();
 }
 
 static void
@@ -188,12 +189,16 @@ set_ws_filter(const int n)
 	char *p = workspace_opts[n].filter.str;
 	filter.str = savestring(p, strlen(p));
 
-	if (filter.type != FILTER_FILE_NAME)
+	if (filter.type != FILTER_FILE_NAME) {
+		set_filter_literal();
 		return;
+	}
 
 	if (regcomp(&regex_exp, filter.str, REG_NOSUB | REG_EXTENDED)
 	!= FUNC_SUCCESS)
 		unset_ws_filter();
+	else
+		set_filter_literal();
 }
 
 static void
@@ -274,7 +279,7 @@ switch_workspace(const int tmp_ws)
 		set_workspace_opts(cur_ws);
 
 	if (conf.autols == 1)
-		reload_dirlist();
+		switch_dirlist();
 
 	add_to_dirhist(workspaces[cur_ws].path);
 	return FUNC_SUCCESS;
@@ -25,6 +25,7 @@
 #include "helpers.h"
 
 #include <errno.h>
+#include <pthread.h> /* directory size cache lock */
 #include <stdio.h>   /* snprintf */
 #ifdef USE_DU1
 # include <string.h> /* strchr */
@@ -32,7 +33,8 @@
 #endif /* USE_DU1 */
 
 #ifdef USE_DU1
-# include "aux.h"   /* xnrealloc, open_fread */
+# include "aux.h"   /* open_fread */
+# include "mem.h"   /* xnmalloc, xnrealloc */
 # include "spawn.h" /* launch_execv */
 #else
 # include "mem.h"   /* xnrealloc */
@@ -53,18 +55,24 @@ struct hlink_t {
 	ino_t ino;
 };
 
-static struct hlink_t *xdu_hardlinks = {0};
-static size_t xdu_hardlink_n = 0;
+/* Hardlinks found during a single traversal. Kept per traversal (rather
+ * than in a file-scope global), so that dir_info() can run concurrently
+ * from the worker threads computing directory sizes (listing.c). */
+struct hlinks_t {
+	struct hlink_t *list;
+	size_t n;
+};
 
 static inline int
-check_xdu_hardlinks(const dev_t dev, const ino_t ino)
+check_xdu_hardlinks(const struct hlinks_t *hl, const dev_t dev,
+	const ino_t ino)
 {
-	if (!xdu_hardlinks || xdu_hardlink_n == 0)
+	if (!hl->list || hl->n == 0)
 		return 0;
 
 	size_t i;
-	for (i = 0; i < xdu_hardlink_n; i++) {
-		if (dev == xdu_hardlinks[i].dev && ino == xdu_hardlinks[i].ino)
+	for (i = 0; i < hl->n; i++) {
+		if (dev == hl->list[i].dev && ino == hl->list[i].ino)
 			return 1;
 	}
 
@@ -72,39 +80,93 @@ check_xdu_hardlinks(const dev_t dev, const ino_t ino)
 }
 
 static inline void
-add_xdu_hardlink(const dev_t dev, const ino_t ino)
+add_xdu_hardlink(struct hlinks_t *hl, const dev_t dev, const ino_t ino)
 {
-	xdu_hardlinks = xnrealloc(xdu_hardlinks, xdu_hardlink_n + 1,
-		sizeof(struct hlink_t));
+	hl->list = xnrealloc(hl->list, hl->n + 1, sizeof(struct hlink_t));
 
-	xdu_hardlinks[xdu_hardlink_n].dev = dev;
-	xdu_hardlinks[xdu_hardlink_n].ino = ino;
-	xdu_hardlink_n++;
+	hl->list[hl->n].dev = dev;
+	hl->list[hl->n].ino = ino;
+	hl->n++;
 }
 
-static inline void
-free_xdu_hardlinks(void)
+/* Cache of computed directory full sizes, keyed by device, inode, and
+ * modification time, so that revisiting an unchanged directory costs
+ * nothing. The table is direct-mapped: a colliding key just evicts the
+ * previous entry.
+ * NOTE: A directory's mtime only changes when its direct children do, so
+ * a modification deep down the tree keeps the cached (now stale) size
+ * alive. This is the price for not re-traversing everything: a stale
+ * size is corrected as soon as the directory itself is touched. */
+
+#define XDU_CACHE_SIZE 512 /* Must be a power of two */
+
+struct xdu_cache_t {
+	dev_t dev;
+	ino_t ino;
+	time_t mtime;
+	off_t size;
+	int status;
+	int approx; /* SIZE is a sampling estimate (see dir_size_estimate()) */
+	int used;
+};
+
+static struct xdu_cache_t xdu_cache[XDU_CACHE_SIZE];
+static pthread_mutex_t xdu_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Look up the full size of the directory identified by DEV, INO, and
+ * MTIME. If found, set SIZE and STATUS to the cached values and return
+ * FUNC_SUCCESS. Otherwise, return FUNC_FAILURE. */
+int
+xdu_cache_get(const dev_t dev, const ino_t ino, const time_t mtime,
+	off_t *size, int *status, int *approx)
 {
-	free(xdu_hardlinks);
-	xdu_hardlinks = (struct hlink_t *)NULL;
-	xdu_hardlink_n = 0;
+	struct xdu_cache_t *e =
+		&xdu_cache[((size_t)ino ^ (size_t)dev) & (XDU_CACHE_SIZE - 1)];
+	int found = 0;
+
+	pthread_mutex_lock(&xdu_cache_lock);
+	if (e->used == 1 && e->dev == dev && e->ino == ino
+	&& e->mtime == mtime) {
+		*size = e->size;
+		*status = e->status;
+		*approx = e->approx;
+		found = 1;
+	}
+	pthread_mutex_unlock(&xdu_cache_lock);
+
+	return found == 1 ? FUNC_SUCCESS : FUNC_FAILURE;
 }
 
-/* Trimmed down implementation of du(1) providing only those features
- * required by Clifm.
- *
- * Recursively count files and directories in the directory DIR and store
- * values in the INFO struct.
- * The total size in bytes (apparent size, if conf.apparent_size is set to 1,
- * or disk usage otherwise) is stored in the SIZE field of the struct.
- * The amount of directories, symbolic links, and other file types is stored
- * in the DIRS, LINKS, and FILES fields respectively.
- * FIRST_LEVEL must be always 1 when calling this function (this value will
- * be zero whenever the function calls itself recursively).
- * If a directory cannot be read, or a file cannot be stat'ed, then the
- * STATUS field of the INFO struct is set to the appropriate errno value.*/
+/* Record the computed full size (SIZE, with STATUS as the traversal exit
+ * status) of the directory identified by DEV, INO, and MTIME. */
 void
-dir_info(const char *dir, const int first_level, struct dir_info_t *info)
+xdu_cache_put(const dev_t dev, const ino_t ino, const time_t mtime,
+	const off_t size, const int status, const int approx)
+{
+	struct xdu_cache_t *e =
+		&xdu_cache[((size_t)ino ^ (size_t)dev) & (XDU_CACHE_SIZE - 1)];
+
+	pthread_mutex_lock(&xdu_cache_lock);
+	/* Never let an estimate evict the exact size of the same directory */
+	if (approx == 1 && e->used == 1 && e->approx == 0 && e->dev == dev
+	&& e->ino == ino && e->mtime == mtime) {
+		pthread_mutex_unlock(&xdu_cache_lock);
+		return;
+	}
+
+	e->dev = dev;
+	e->ino = ino;
+	e->mtime = mtime;
+	e->size = size;
+	e->status = status;
+	e->approx = approx;
+	e->used = 1;
+	pthread_mutex_unlock(&xdu_cache_lock);
+}
+
+static void
+dir_info_rec(const char *dir, const int first_level,
+	struct dir_info_t *info, struct hlinks_t *hl)
 {
 	if (!dir || !*dir) {
 		info->status = ENOENT;
@@ -170,7 +232,7 @@ dir_info(const char *dir, const int first_level, struct dir_info_t *info)
 				info->size += (a.st_blocks * S_BLKSIZE);
 
 			info->dirs++;
-			dir_info(buf, 0, info);
+			dir_info_rec(buf, 0, info, hl);
 
 			continue;
 		} else {
@@ -181,10 +243,10 @@ dir_info(const char *dir, const int first_level, struct dir_info_t *info)
 			continue;
 
 		if (a.st_nlink > 1) {
-			if (check_xdu_hardlinks(a.st_dev, a.st_ino) == 1)
+			if (check_xdu_hardlinks(hl, a.st_dev, a.st_ino) == 1)
 				continue;
 			else
-				add_xdu_hardlink(a.st_dev, a.st_ino);
+				add_xdu_hardlink(hl, a.st_dev, a.st_ino);
 		}
 
 		info->size += conf.apparent_size == 1 ? a.st_size
@@ -192,11 +254,152 @@ dir_info(const char *dir, const int first_level, struct dir_info_t *info)
 	}
 
 	closedir(p);
+	return;
+}
 
-	if (first_level == 1)
-		free_xdu_hardlinks();
+/* Trimmed down implementation of du(1) providing only those features
+ * required by Clifm.
+ *
+ * Recursively count files and directories in the directory DIR and store
+ * values in the INFO struct.
+ * The total size in bytes (apparent size, if conf.apparent_size is set to 1,
+ * or disk usage otherwise) is stored in the SIZE field of the struct.
+ * The amount of directories, symbolic links, and other file types is stored
+ * in the DIRS, LINKS, and FILES fields respectively.
+ * FIRST_LEVEL must be always 1 when calling this function (this value will
+ * be zero whenever the function calls itself recursively).
+ * If a directory cannot be read, or a file cannot be stat'ed, then the
+ * STATUS field of the INFO struct is set to the appropriate errno value.
+ * This function is reentrant: it may be called concurrently from the
+ * threads computing directory sizes for the files list (listing.c). */
+void
+dir_info(const char *dir, const int first_level, struct dir_info_t *info)
+{
+	struct hlinks_t hl = {0};
 
-	return;
+	dir_info_rec(dir, first_level, info, &hl);
+
+	free(hl.list);
+}
+
+/* Approximate directory sizes (ApproxDirSize).
+ *
+ * An exact recursive size visits every directory in the tree, which on
+ * rotating storage (or a cold cache) is dominated by seek time. The
+ * sampling traversal below enumerates at most XDU_SAMPLE_DIRS
+ * directories (depth-first, so whole subtrees are measured, not just
+ * their top levels); the contribution of the subtrees left unvisited is
+ * extrapolated from the average size of the visited ones. */
+
+#define XDU_SAMPLE_DIRS 64
+
+struct xdu_sample_t {
+	struct hlinks_t *hl;
+	off_t size;        /* Size accumulated from visited directories */
+	long long visited; /* Directories actually enumerated */
+	long long skipped; /* Directories discovered but not entered */
+	int budget;        /* Remaining opendir(3) budget */
+	int status;
+};
+
+static void
+dir_size_sample_rec(const char *dir, const int first_level,
+	struct xdu_sample_t *s)
+{
+	if (!dir || !*dir) {
+		s->status = ENOENT;
+		return;
+	}
+
+	struct stat a;
+	DIR *p;
+
+	if ((p = opendir(dir)) == NULL) {
+		s->status = errno;
+		return;
+	}
+
+	s->budget--;
+	s->visited++;
+
+	if (first_level == 1 && conf.apparent_size != 1 && stat(dir, &a) != -1)
+		s->size += (a.st_blocks * S_BLKSIZE);
+
+	struct dirent *ent;
+	char buf[PATH_MAX + 1];
+
+	while ((ent = readdir(p)) != NULL) {
+		if (SELFORPARENT(ent->d_name))
+			continue;
+
+		snprintf(buf, sizeof(buf), "%s/%s", dir, ent->d_name);
+
+		if (lstat(buf, &a) == -1) {
+			s->status = errno;
+			continue;
+		}
+
+		if (S_ISDIR(a.st_mode)) {
+			if (conf.apparent_size != 1)
+				s->size += (a.st_blocks * S_BLKSIZE);
+
+			if (s->budget > 0)
+				dir_size_sample_rec(buf, 0, s);
+			else
+				s->skipped++;
+
+			continue;
+		}
+
+		if (S_ISLNK(a.st_mode) == 0 && !USABLE_ST_SIZE(&a))
+			continue;
+
+		if (a.st_nlink > 1) {
+			if (check_xdu_hardlinks(s->hl, a.st_dev, a.st_ino) == 1)
+				continue;
+			else
+				add_xdu_hardlink(s->hl, a.st_dev, a.st_ino);
+		}
+
+		s->size += conf.apparent_size == 1 ? a.st_size
+			: (a.st_blocks * S_BLKSIZE);
+	}
+
+	closedir(p);
+}
+
+/* Approximate the full size of the directory DIR by sampling (see the
+ * note above). STATUS is set as for dir_size(). APPROX is set to 1 if
+ * the returned size is an extrapolation, or 0 if the traversal fit the
+ * sampling budget, in which case the size is exact.
+ * FIRST_LEVEL must always be 1 when calling this function. */
+off_t
+dir_size_estimate(const char *dir, const int first_level, int *status,
+	int *approx)
+{
+	struct hlinks_t hl = {0};
+	struct xdu_sample_t s = {0};
+	s.hl = &hl;
+	s.budget = XDU_SAMPLE_DIRS;
+
+	dir_size_sample_rec(dir, first_level, &s);
+	free(hl.list);
+
+	*status = s.status;
+
+	if (s.skipped == 0) { /* The whole tree fit the budget */
+		*approx = 0;
+		return s.size;
+	}
+
+	*approx = 1;
+	if (s.visited == 0)
+		return s.size;
+
+	/* Assume each unvisited subtree weighs as much as the average
+	 * visited one. */
+	return s.size + (off_t)(((double)s.size / (double)s.visited)
+		* (double)s.skipped);
 }
 
 #ifndef USE_DU1
@@ -292,4 +495,141 @@ END:
 	fclose(fp);
 	return retval;
 }
+
+/* Amount of directories passed to a single du(1) invocation. Bounded to
+ * stay safely below the kernel's argument size limit even with long
+ * file names. */
+#define DU_BATCH_MAX 1024
+
+/* Run du(1) once for the N directories in DIRS, redirecting its output
+ * to FILE and parsing one size per line into SIZES.
+ * Returns the command's exit code. */
+static int
+run_du_batch(char **dirs, const size_t n, off_t *sizes, char *file)
+{
+	const size_t argc_fixed = 6; /* Fixed arguments plus NULL */
+	char **cmd = xnmalloc(n + argc_fixed, sizeof(char *));
+	size_t c = 0;
+
+	if (bin_flags & (GNU_DU_BIN_DU | GNU_DU_BIN_GDU)) {
+		cmd[c++] = (bin_flags & GNU_DU_BIN_DU) ? "du" : "gdu";
+		cmd[c++] = "-s";
+		if (conf.apparent_size == 1)
+			cmd[c++] = "--apparent-size";
+		cmd[c++] = "--block-size=1";
+	} else {
+		cmd[c++] = "du";
+		cmd[c++] = "-ks";
+	}
+	cmd[c++] = "--";
+
+	const size_t names_start = c;
+	size_t i;
+	for (i = 0; i < n; i++)
+		cmd[c++] = dirs[i];
+	cmd[c] = (char *)NULL;
+
+	int fd = 0;
+	FILE *fp = (FILE *)NULL;
+	const int stdout_bk = dup(STDOUT_FILENO); /* Save original stdout */
+	if (stdout_bk == -1) {
+		free(cmd);
+		return FUNC_FAILURE;
+	}
+
+	/* Redirect stdout to the output file */
+	fd = open(file, O_WRONLY | O_TRUNC);
+	if (fd == -1) {
+		close(stdout_bk);
+		free(cmd);
+		return FUNC_FAILURE;
+	}
+	dup2(fd, STDOUT_FILENO);
+	close(fd);
+
+	int status = launch_execv(cmd, FOREGROUND, E_NOSTDERR);
+
+	dup2(stdout_bk, STDOUT_FILENO); /* Restore original stdout */
+	close(stdout_bk);
+
+	fp = open_fread(file, &fd);
+	if (!fp) {
+		free(cmd);
+		return FUNC_FAILURE;
+	}
+
+	/* du(1) prints one line per argument, in argument order:
+	 * "SIZE\tNAME". Match names to guard against missing lines. */
+	char *line = (char *)NULL;
+	size_t line_size = 0;
+	ssize_t line_len = 0;
+	i = 0;
+
+	while (i < n && (line_len = getline(&line, &line_size, fp)) > 0) {
+		if (line_len > 0 && line[line_len - 1] == '\n')
+			line[line_len - 1] = '\0';
+
+		char *p = strchr(line, '\t');
+		if (!p || p == line)
+			continue;
+
+		*p = '\0';
+		while (i < n && strcmp(p + 1, cmd[names_start + i]) != 0)
+			i++; /* No line for this directory: left as -1 */
+
+		if (i < n) {
+			sizes[i] = (off_t)atoll(line);
+			i++;
+		}
+	}
+
+	free(line);
+	fclose(fp);
+	free(cmd);
+	return status;
+}
+
+/* Compute the sizes (in bytes, or KiB with non-GNU du, just as
+ * dir_size()) of the N directories in DIRS with as few du(1) invocations
+ * as possible, storing the results in SIZES (-1 for directories du
+ * reported nothing for).
+ * Returns FUNC_SUCCESS if every du invocation exited successfully and
+ * every directory got a size. Otherwise, FUNC_FAILURE is returned and
+ * the caller should fall back to per-directory dir_size() calls (du's
+ * exit code covers the whole batch: it cannot be attributed to a
+ * specific directory). */
+int
+dir_sizes(char **dirs, const size_t n, off_t *sizes)
+{
+	if (!dirs || n == 0)
+		return FUNC_FAILURE;
+
+	char file[PATH_MAX + 1];
+	snprintf(file, sizeof(file), "%s/%s", xargs.stealth_mode == 1
+		? P_tmpdir : tmp_dir, TMP_FILENAME); /* NOLINT */
+
+	const int fd = mkstemp(file);
+	if (fd == -1)
+		return FUNC_FAILURE;
+	close(fd);
+
+	size_t i;
+	for (i = 0; i < n; i++)
+		sizes[i] = -1;
+
+	int ret = FUNC_SUCCESS;
+	for (i = 0; i < n; i += DU_BATCH_MAX) {
+		const size_t chunk = (n - i) > DU_BATCH_MAX ? DU_BATCH_MAX : n - i;
+		if (run_du_batch(dirs + i, chunk, sizes + i, file) != FUNC_SUCCESS)
+			ret = FUNC_FAILURE;
+	}
+
+	for (i = 0; i < n; i++) {
+		if (sizes[i] == -1)
+			ret = FUNC_FAILURE;
+	}
+
+	unlink(file);
+	return ret;
+}
 #endif /* !USE_DU1 */
@@ -30,9 +30,16 @@ __BEGIN_DECLS
 void dir_info(const char *dir, const int first_level, struct dir_info_t *info);
 #ifdef USE_DU1
 off_t dir_size(char *dir, const int first_level, int *status);
+int  dir_sizes(char **dirs, const size_t n, off_t *sizes);
 #else
 off_t dir_size(const char *dir, const int first_level, int *status);
 #endif /* USE_DU1 */
+off_t dir_size_estimate(const char *dir, const int first_level, int *status,
+	int *approx);
+int  xdu_cache_get(const dev_t dev, const ino_t ino, const time_t mtime,
+	off_t *size, int *status, int *approx);
+void xdu_cache_put(const dev_t dev, const ino_t ino, const time_t mtime,
+	const off_t size, const int status, const int approx);
 
 __END_DECLS
 